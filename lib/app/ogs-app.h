@@ -30,6 +30,9 @@ extern int __ogs_app_domain;
 #include "app/ogs-context.h"
 #include "app/ogs-config.h"
 #include "app/ogs-init.h"
+#include "app/ogs-reload.h"
+#include "app/ogs-worker.h"
+#include "app/ogs-paging.h"
 
 #undef OGS_APP_INSIDE
 
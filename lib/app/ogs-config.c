@@ -423,7 +423,7 @@ static void regenerate_all_timer_duration(void)
 #endif
 }
 
-static int local_conf_prepare(void)
+static void local_time_conf_prepare(void)
 {
     /* <Heartbeat Checking Interval>
      *  Heartbeat Interval(e.g: 10 seconds) + No Heartbeat Margin(1 second) */
@@ -453,11 +453,16 @@ static int local_conf_prepare(void)
      */
     local_conf.time.handover.duration = ogs_time_from_msec(300);
 
+    regenerate_all_timer_duration();
+}
+
+static int local_conf_prepare(void)
+{
+    local_time_conf_prepare();
+
     /* Size of internal metrics pool (amount of ogs_metrics_spec_t) */
     ogs_app()->metrics.max_specs = 512;
 
-    regenerate_all_timer_duration();
-
     return OGS_OK;
 }
 
@@ -475,6 +480,110 @@ static int local_conf_validation(void)
     return OGS_OK;
 }
 
+static int parse_local_time_conf(ogs_yaml_iter_t *local_iter)
+{
+    ogs_yaml_iter_t time_iter;
+
+    ogs_assert(local_iter);
+
+    ogs_yaml_iter_recurse(local_iter, &time_iter);
+    while (ogs_yaml_iter_next(&time_iter)) {
+        const char *time_key = ogs_yaml_iter_key(&time_iter);
+        ogs_assert(time_key);
+        if (!strcmp(time_key, "nf_instance")) {
+            ogs_yaml_iter_t sbi_iter;
+            ogs_yaml_iter_recurse(&time_iter, &sbi_iter);
+
+            while (ogs_yaml_iter_next(&sbi_iter)) {
+                const char *sbi_key = ogs_yaml_iter_key(&sbi_iter);
+                ogs_assert(sbi_key);
+
+                if (!strcmp(sbi_key, "heartbeat")) {
+                    const char *v = ogs_yaml_iter_value(&sbi_iter);
+                    if (v)
+                        local_conf.time.nf_instance.
+                            heartbeat_interval = atoi(v);
+                } else if (!strcmp(sbi_key, "validity")) {
+                    const char *v = ogs_yaml_iter_value(&sbi_iter);
+                    if (v)
+                        local_conf.time.nf_instance.validity_duration = atoi(v);
+                } else
+                    ogs_warn("unknown key `%s`", sbi_key);
+            }
+        } else if (!strcmp(time_key, "subscription")) {
+            ogs_yaml_iter_t sbi_iter;
+            ogs_yaml_iter_recurse(&time_iter, &sbi_iter);
+
+            while (ogs_yaml_iter_next(&sbi_iter)) {
+                const char *sbi_key = ogs_yaml_iter_key(&sbi_iter);
+                ogs_assert(sbi_key);
+
+                if (!strcmp(sbi_key, "validity")) {
+                    const char *v = ogs_yaml_iter_value(&sbi_iter);
+                    if (v)
+                        local_conf.time.subscription.
+                            validity_duration = atoi(v);
+                } else
+                    ogs_warn("unknown key `%s`", sbi_key);
+            }
+        } else if (!strcmp(time_key, "message")) {
+            ogs_yaml_iter_t msg_iter;
+            ogs_yaml_iter_recurse(&time_iter, &msg_iter);
+
+            while (ogs_yaml_iter_next(&msg_iter)) {
+                const char *msg_key = ogs_yaml_iter_key(&msg_iter);
+                ogs_assert(msg_key);
+
+                if (!strcmp(msg_key, "duration")) {
+                    const char *v = ogs_yaml_iter_value(&msg_iter);
+                    if (v && atoll(v) > 0) {
+                        local_conf.time.message.duration =
+                            ogs_time_from_msec(atoll(v));
+                        regenerate_all_timer_duration();
+                    } else if (v) {
+                        ogs_error("Invalid message duration `%s`", v);
+                        return OGS_ERROR;
+                    }
+                } else
+                    ogs_warn("unknown key `%s`", msg_key);
+            }
+        } else if (!strcmp(time_key, "handover")) {
+            ogs_yaml_iter_t msg_iter;
+            ogs_yaml_iter_recurse(&time_iter, &msg_iter);
+
+            while (ogs_yaml_iter_next(&msg_iter)) {
+                const char *msg_key = ogs_yaml_iter_key(&msg_iter);
+                ogs_assert(msg_key);
+
+                if (!strcmp(msg_key, "duration")) {
+                    const char *v = ogs_yaml_iter_value(&msg_iter);
+                    if (v && atoll(v) >= 0) {
+                        local_conf.time.handover.duration =
+                            ogs_time_from_msec(atoll(v));
+                    } else if (v) {
+                        ogs_error("Invalid handover duration `%s`", v);
+                        return OGS_ERROR;
+                    }
+                } else
+                    ogs_warn("unknown key `%s`", msg_key);
+            }
+        } else if (!strcmp(time_key, "t3502")) {
+            /* handle config in amf */
+        } else if (!strcmp(time_key, "t3512")) {
+            /* handle config in amf */
+        } else if (!strcmp(time_key, "t3402")) {
+            /* handle config in mme */
+        } else if (!strcmp(time_key, "t3412")) {
+            /* handle config in mme */
+        } else if (!strcmp(time_key, "t3423")) {
+            /* handle config in mme */
+        } else
+            ogs_warn("unknown key `%s`", time_key);
+    }
+
+    return OGS_OK;
+}
+
 int ogs_app_parse_local_conf(const char *local)
 {
     int rv;
@@ -488,6 +597,8 @@ int ogs_app_parse_local_conf(const char *local)
     rv = local_conf_prepare();
     if (rv != OGS_OK) return rv;
 
+    ogs_app()->local = local;
+
     ogs_yaml_iter_init(&root_iter, document);
     while (ogs_yaml_iter_next(&root_iter)) {
         const char *root_key = ogs_yaml_iter_key(&root_iter);
@@ -547,105 +658,8 @@ int ogs_app_parse_local_conf(const char *local)
                     } while (ogs_yaml_iter_type(&serving_array) ==
                             YAML_SEQUENCE_NODE);
                 } else if (!strcmp(local_key, "time")) {
-                    ogs_yaml_iter_t time_iter;
-                    ogs_yaml_iter_recurse(&local_iter, &time_iter);
-                    while (ogs_yaml_iter_next(&time_iter)) {
-                        const char *time_key = ogs_yaml_iter_key(&time_iter);
-                        ogs_assert(time_key);
-                        if (!strcmp(time_key, "nf_instance")) {
-                            ogs_yaml_iter_t sbi_iter;
-                            ogs_yaml_iter_recurse(&time_iter, &sbi_iter);
-
-                            while (ogs_yaml_iter_next(&sbi_iter)) {
-                                const char *sbi_key =
-                                    ogs_yaml_iter_key(&sbi_iter);
-                                ogs_assert(sbi_key);
-
-                                if (!strcmp(sbi_key, "heartbeat")) {
-                                    const char *v = ogs_yaml_iter_value(
-                                            &sbi_iter);
-                                    if (v)
-                                        local_conf.time.nf_instance.
-                                            heartbeat_interval = atoi(v);
-                                } else if (!strcmp(sbi_key, "validity")) {
-                                    const char *v =
-                                        ogs_yaml_iter_value(&sbi_iter);
-                                    if (v)
-                                        local_conf.time.nf_instance.
-                                            validity_duration = atoi(v);
-                                } else
-                                    ogs_warn("unknown key `%s`", sbi_key);
-                            }
-                        } else if (!strcmp(time_key, "subscription")) {
-                            ogs_yaml_iter_t sbi_iter;
-                            ogs_yaml_iter_recurse(&time_iter, &sbi_iter);
-
-                            while (ogs_yaml_iter_next(&sbi_iter)) {
-                                const char *sbi_key =
-                                    ogs_yaml_iter_key(&sbi_iter);
-                                ogs_assert(sbi_key);
-
-                                if (!strcmp(sbi_key, "validity")) {
-                                    const char *v =
-                                        ogs_yaml_iter_value(&sbi_iter);
-                                    if (v)
-                                        local_conf.time.subscription.
-                                            validity_duration = atoi(v);
-                                } else
-                                    ogs_warn("unknown key `%s`", sbi_key);
-                            }
-                        } else if (!strcmp(time_key, "message")) {
-                            ogs_yaml_iter_t msg_iter;
-                            ogs_yaml_iter_recurse(&time_iter, &msg_iter);
-
-                            while (ogs_yaml_iter_next(&msg_iter)) {
-                                const char *msg_key =
-                                    ogs_yaml_iter_key(&msg_iter);
-                                ogs_assert(msg_key);
-
-                                if (!strcmp(msg_key, "duration")) {
-                                    const char *v =
-                                        ogs_yaml_iter_value(&msg_iter);
-                                    if (v) {
-                                        local_conf.time.message.duration =
-                                            ogs_time_from_msec(atoll(v));
-                                        regenerate_all_timer_duration();
-                                    }
-                                } else
-                                    ogs_warn("unknown key `%s`", msg_key);
-                            }
-                        } else if (!strcmp(time_key, "handover")) {
-                            ogs_yaml_iter_t msg_iter;
-                            ogs_yaml_iter_recurse(&time_iter, &msg_iter);
-
-                            while (ogs_yaml_iter_next(&msg_iter)) {
-                                const char *msg_key =
-                                    ogs_yaml_iter_key(&msg_iter);
-                                ogs_assert(msg_key);
-
-                                if (!strcmp(msg_key, "duration")) {
-                                    const char *v =
-                                        ogs_yaml_iter_value(&msg_iter);
-                                    if (v) {
-                                        local_conf.time.handover.duration =
-                                            ogs_time_from_msec(atoll(v));
-                                    }
-                                } else
-                                    ogs_warn("unknown key `%s`", msg_key);
-                            }
-                        } else if (!strcmp(time_key, "t3502")) {
-                            /* handle config in amf */
-                        } else if (!strcmp(time_key, "t3512")) {
-                            /* handle config in amf */
-                        } else if (!strcmp(time_key, "t3402")) {
-                            /* handle config in mme */
-                        } else if (!strcmp(time_key, "t3412")) {
-                            /* handle config in mme */
-                        } else if (!strcmp(time_key, "t3423")) {
-                            /* handle config in mme */
-                        } else
-                            ogs_warn("unknown key `%s`", time_key);
-                    }
+                    rv = parse_local_time_conf(&local_iter);
+                    if (rv != OGS_OK) return rv;
                 }
             }
         }
@@ -657,6 +671,55 @@ int ogs_app_parse_local_conf(const char *local)
     return OGS_OK;
 }
 
+/*
+ * Re-reads the message, handover and subscription timers of the NF section
+ * on a configuration reload. The NF instance heartbeat and validity are
+ * announced to the NRF at registration, so they are kept as they are.
+ */
+int ogs_app_reload_local_time_conf(const char *local)
+{
+    int rv = OGS_OK;
+    yaml_document_t *document = NULL;
+    ogs_yaml_iter_t root_iter;
+    int idx = 0;
+    ogs_app_local_conf_t saved;
+
+    ogs_assert(local);
+
+    document = ogs_app()->document;
+    ogs_assert(document);
+
+    memcpy(&saved, &local_conf, sizeof(saved));
+
+    local_time_conf_prepare();
+
+    ogs_yaml_iter_init(&root_iter, document);
+    while (ogs_yaml_iter_next(&root_iter)) {
+        const char *root_key = ogs_yaml_iter_key(&root_iter);
+        ogs_assert(root_key);
+        if (!strcmp(root_key, local) &&
+            (idx++ == ogs_app()->config_section_id)) {
+            ogs_yaml_iter_t local_iter;
+            ogs_yaml_iter_recurse(&root_iter, &local_iter);
+            while (ogs_yaml_iter_next(&local_iter)) {
+                const char *local_key = ogs_yaml_iter_key(&local_iter);
+                ogs_assert(local_key);
+                if (!strcmp(local_key, "time")) {
+                    rv = parse_local_time_conf(&local_iter);
+                    if (rv != OGS_OK) {
+                        memcpy(&local_conf, &saved, sizeof(local_conf));
+                        return rv;
+                    }
+                }
+            }
+        }
+    }
+
+    local_conf.time.nf_instance = saved.time.nf_instance;
+
+    return OGS_OK;
+}
+
 int ogs_app_parse_sockopt_config(
         ogs_yaml_iter_t *parent, ogs_sockopt_t *option)
 {
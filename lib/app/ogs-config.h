@@ -177,6 +177,7 @@ int ogs_app_count_nf_conf_sections(const char *conf_section);
 int ogs_app_global_conf_prepare(void);
 int ogs_app_parse_global_conf(ogs_yaml_iter_t *parent);
 int ogs_app_parse_local_conf(const char *local);
+int ogs_app_reload_local_time_conf(const char *local);
 
 int ogs_app_parse_sockopt_config(
         ogs_yaml_iter_t *parent, ogs_sockopt_t *option);
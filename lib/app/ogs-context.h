@@ -45,6 +45,12 @@ typedef struct ogs_app_context_s {
         const char *level;
         const char *domain;
         ogs_log_ts_e timestamp;
+
+        struct {
+            bool enabled;
+            uint64_t size;
+            const char *drop;
+        } async;
     } logger;
 
     ogs_queue_t *queue;
@@ -86,6 +92,7 @@ typedef struct ogs_app_context_s {
     } metrics;
 
     int config_section_id;
+    const char *local;              /* Root key of the NF's own section */
 
 } ogs_app_context_t;
 
@@ -121,6 +121,12 @@ int ogs_app_initialize(
     ogs_log_set_timestamp(ogs_app()->logger_default.timestamp,
                           ogs_app()->logger.timestamp);
 
+    if (ogs_app()->logger.async.enabled) {
+        rv = ogs_log_config_async(
+                ogs_app()->logger.async.size, ogs_app()->logger.async.drop);
+        if (rv != OGS_OK) return rv;
+    }
+
     /**************************************************************************
      * Stage 5 : Setup Database Module
      */
@@ -164,11 +170,20 @@ int ogs_app_initialize(
     ogs_app()->pollset = ogs_pollset_create(ogs_app()->pool.socket);
     ogs_assert(ogs_app()->pollset);
 
+    /* Events pushed from other threads wake up the NF loop */
+    ogs_queue_set_notify(ogs_app()->queue, ogs_app()->pollset);
+
+    /**************************************************************************
+     * Stage 9 : Keep the loaded configuration to compare on reload
+     */
+    rv = ogs_app_reload_init();
+
     return rv;
 }
 
 void ogs_app_terminate(void)
 {
+    ogs_app_reload_final();
     ogs_app_config_final();
     ogs_app_context_final();
 
@@ -179,79 +194,14 @@ void ogs_app_terminate(void)
 
 static int read_config(void)
 {
-    FILE *file;
-    yaml_parser_t parser;
-    yaml_document_t *document = NULL;
-
     ogs_assert(ogs_app()->file);
 
-    file = fopen(ogs_app()->file, "rb");
-    if (!file) {
-        ogs_fatal("cannot open file `%s`", ogs_app()->file);
-        return OGS_ERROR;
-    }
-
-    ogs_assert(yaml_parser_initialize(&parser));
-    yaml_parser_set_input_file(&parser, file);
-
-    document = calloc(1, sizeof(yaml_document_t));
-    if (!yaml_parser_load(&parser, document)) {
-        ogs_fatal("Failed to parse configuration file '%s'", ogs_app()->file);
-        switch (parser.error) {
-        case YAML_MEMORY_ERROR:
-            ogs_error("Memory error: Not enough memory for parsing");
-            break;
-        case YAML_READER_ERROR:
-            if (parser.problem_value != -1)
-                ogs_error("Reader error - %s: #%X at %zd", parser.problem,
-                    parser.problem_value, parser.problem_offset);
-            else
-                ogs_error("Reader error - %s at %zd", parser.problem,
-                    parser.problem_offset);
-            break;
-        case YAML_SCANNER_ERROR:
-            if (parser.context)
-                ogs_error("Scanner error - %s at line %zu, column %zu "
-                        "%s at line %zu, column %zu", parser.context,
-                        parser.context_mark.line+1,
-                        parser.context_mark.column+1,
-                        parser.problem, parser.problem_mark.line+1,
-                        parser.problem_mark.column+1);
-            else
-                ogs_error("Scanner error - %s at line %zu, column %zu",
-                        parser.problem, parser.problem_mark.line+1,
-                        parser.problem_mark.column+1);
-            break;
-        case YAML_PARSER_ERROR:
-            if (parser.context)
-                ogs_error("Parser error - %s at line %zu, column %zu "
-                        "%s at line %zu, column %zu", parser.context,
-                        parser.context_mark.line+1,
-                        parser.context_mark.column+1,
-                        parser.problem, parser.problem_mark.line+1,
-                        parser.problem_mark.column+1);
-            else
-                ogs_error("Parser error - %s at line %zu, column %zu",
-                        parser.problem, parser.problem_mark.line+1,
-                        parser.problem_mark.column+1);
-            break;
-        default:
-            /* Couldn't happen. */
-            ogs_assert_if_reached();
-            break;
-        }
-
-        free(document);
-        yaml_parser_delete(&parser);
-        ogs_assert(!fclose(file));
+    ogs_app()->document = ogs_yaml_document_load(ogs_app()->file);
+    if (!ogs_app()->document) {
+        ogs_fatal("Failed to load configuration file '%s'", ogs_app()->file);
         return OGS_ERROR;
     }
 
-    ogs_app()->document = document;
-
-    yaml_parser_delete(&parser);
-    ogs_assert(!fclose(file));
-
     return OGS_OK;
 }
 
@@ -324,6 +274,32 @@ static void parse_config_logger_file(ogs_yaml_iter_t *logger_iter,
     }
 }
 
+static void parse_config_logger_async(ogs_yaml_iter_t *logger_iter)
+{
+    ogs_yaml_iter_t iter;
+
+    /*
+     *   logger:
+     *     async:
+     *       enabled: true
+     *       size: 1048576
+     *       drop: info */
+    ogs_yaml_iter_recurse(logger_iter, &iter);
+    while (ogs_yaml_iter_next(&iter)) {
+        const char *key = ogs_yaml_iter_key(&iter);
+        ogs_assert(key);
+        if (!strcmp(key, "enabled")) {
+            ogs_app()->logger.async.enabled = ogs_yaml_iter_bool(&iter);
+        } else if (!strcmp(key, "size")) {
+            const char *v = ogs_yaml_iter_value(&iter);
+            if (v) ogs_app()->logger.async.size = atoll(v);
+        } else if (!strcmp(key, "drop")) {
+            ogs_app()->logger.async.drop = ogs_yaml_iter_value(&iter);
+        } else
+            ogs_warn("unknown key `%s`", key);
+    }
+}
+
 static int parse_config(void)
 {
     int rv;
@@ -355,6 +331,8 @@ static int parse_config(void)
                 } else if (!strcmp(logger_key, "domain")) {
                     ogs_app()->logger.domain =
                         ogs_yaml_iter_value(&logger_iter);
+                } else if (!strcmp(logger_key, "async")) {
+                    parse_config_logger_async(&logger_iter);
                 }
             }
         } else if (!strcmp(root_key, "global")) {
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2024 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-app.h"
+
+void ogs_paging_index_init(ogs_paging_index_t *index,
+        ogs_timer_mgr_t *timer_mgr, void (*flush)(void *data))
+{
+    ogs_assert(index);
+    ogs_assert(timer_mgr);
+    ogs_assert(flush);
+
+    memset(index, 0, sizeof(*index));
+
+    index->area_hash = ogs_hash_make();
+    ogs_assert(index->area_hash);
+    ogs_list_init(&index->pending_list);
+    index->t_flush = ogs_timer_add(timer_mgr, flush, NULL);
+    ogs_assert(index->t_flush);
+}
+
+void ogs_paging_index_final(ogs_paging_index_t *index)
+{
+    ogs_assert(index);
+
+    /* The areas are freed as the nodes are removed */
+    ogs_assert(index->area_hash);
+    ogs_hash_destroy(index->area_hash);
+
+    ogs_timer_delete(index->t_flush);
+}
+
+static void paging_member_remove(
+        ogs_paging_index_t *index, ogs_paging_member_t *member)
+{
+    ogs_paging_area_t *area = NULL;
+
+    ogs_assert(member);
+    area = member->area;
+    ogs_assert(area);
+
+    ogs_list_remove(&area->node_list, member);
+    ogs_free(member);
+
+    if (ogs_list_first(&area->node_list))
+        return;
+
+    /* No node serves the TAI any more; queued pages have nowhere to go */
+    while (ogs_paging_ue_pop(area))
+        ;
+    if (area->pending)
+        ogs_list_remove(&index->pending_list, area);
+
+    ogs_hash_set(index->area_hash, area->key, area->key_len, NULL);
+    ogs_free(area);
+}
+
+void ogs_paging_node_add(ogs_paging_index_t *index,
+        ogs_list_t *paging_list, void *node, const void *key, int key_len)
+{
+    ogs_paging_area_t *area = NULL;
+    ogs_paging_member_t *member = NULL;
+
+    ogs_assert(index);
+    ogs_assert(paging_list);
+    ogs_assert(node);
+    ogs_assert(key);
+    ogs_assert(key_len > 0 && key_len <= OGS_PAGING_MAX_KEY_LEN);
+
+    area = ogs_paging_area_find(index, key, key_len);
+    if (!area) {
+        area = ogs_calloc(1, sizeof(*area));
+        ogs_assert(area);
+        memcpy(area->key, key, key_len);
+        area->key_len = key_len;
+        ogs_list_init(&area->node_list);
+        ogs_list_init(&area->ue_list);
+        ogs_hash_set(index->area_hash, area->key, area->key_len, area);
+    } else {
+        /* The same TAI may be listed more than once */
+        ogs_list_for_each(&area->node_list, member)
+            if (member->node == node)
+                return;
+    }
+
+    member = ogs_calloc(1, sizeof(*member));
+    ogs_assert(member);
+    member->area = area;
+    member->node = node;
+    ogs_list_add(&area->node_list, member);
+    ogs_list_add(paging_list, &member->node_lnode);
+}
+
+/* Called when the node is removed or before its TA list is re-indexed */
+void ogs_paging_node_clear(ogs_paging_index_t *index, ogs_list_t *paging_list)
+{
+    ogs_lnode_t *lnode = NULL;
+
+    ogs_assert(index);
+    ogs_assert(paging_list);
+
+    while ((lnode = ogs_list_first(paging_list)) != NULL) {
+        ogs_list_remove(paging_list, lnode);
+        paging_member_remove(index,
+                ogs_container_of(lnode, ogs_paging_member_t, node_lnode));
+    }
+}
+
+ogs_paging_area_t *ogs_paging_area_find(
+        ogs_paging_index_t *index, const void *key, int key_len)
+{
+    ogs_assert(index);
+    ogs_assert(key);
+
+    return ogs_hash_get(index->area_hash, key, key_len);
+}
+
+void ogs_paging_ue_queue(ogs_paging_index_t *index,
+        ogs_paging_area_t *area, ogs_paging_ue_t *ue)
+{
+    ogs_assert(index);
+    ogs_assert(area);
+    ogs_assert(ue);
+
+    /* A UE paged twice in the same iteration is sent only once */
+    if (ue->area)
+        return;
+
+    /*
+     * The flush timer is armed whenever the list is not empty. A zero
+     * duration is refused by ogs_timer_start(); one microsecond has
+     * already elapsed when the timers of this iteration are expired.
+     */
+    if (!ogs_list_first(&index->pending_list))
+        ogs_timer_start(index->t_flush, 1);
+
+    if (!area->pending) {
+        ogs_list_add(&index->pending_list, area);
+        area->pending = true;
+    }
+
+    ogs_list_add(&area->ue_list, &ue->lnode);
+    ue->area = area;
+}
+
+void ogs_paging_ue_dequeue(ogs_paging_ue_t *ue)
+{
+    ogs_assert(ue);
+
+    if (!ue->area)
+        return;
+
+    ogs_list_remove(&ue->area->ue_list, &ue->lnode);
+    ue->area = NULL;
+}
+
+ogs_paging_area_t *ogs_paging_pending_pop(ogs_paging_index_t *index)
+{
+    ogs_paging_area_t *area = NULL;
+
+    ogs_assert(index);
+
+    area = ogs_list_first(&index->pending_list);
+    if (!area)
+        return NULL;
+
+    ogs_list_remove(&index->pending_list, area);
+    area->pending = false;
+
+    return area;
+}
+
+ogs_paging_ue_t *ogs_paging_ue_pop(ogs_paging_area_t *area)
+{
+    ogs_lnode_t *lnode = NULL;
+    ogs_paging_ue_t *ue = NULL;
+
+    ogs_assert(area);
+
+    lnode = ogs_list_first(&area->ue_list);
+    if (!lnode)
+        return NULL;
+
+    ue = ogs_container_of(lnode, ogs_paging_ue_t, lnode);
+    ogs_paging_ue_dequeue(ue);
+
+    return ue;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2024 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_APP_INSIDE) && !defined(OGS_APP_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_APP_PAGING_H
+#define OGS_APP_PAGING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Paging index
+ *
+ * Every TAI announced by a RAN node links the node into the paging area
+ * of that TAI, so paging does not walk all nodes and their Supported TA
+ * Lists. UEs paged during a loop iteration are queued on their area and
+ * the flush callback sends them when the iteration ends.
+ *
+ * The TAI is used as an opaque key. The caller zeroes any padding so
+ * that equal TAIs have equal keys.
+ */
+#define OGS_PAGING_MAX_KEY_LEN 16
+
+typedef struct ogs_paging_area_s {
+    ogs_lnode_t     lnode;          /* A node of ogs_paging_index_t.pending_list */
+    bool            pending;
+
+    uint8_t         key[OGS_PAGING_MAX_KEY_LEN];
+    int             key_len;
+
+    ogs_list_t      node_list;      /* ogs_paging_member_t */
+    ogs_list_t      ue_list;        /* ogs_paging_ue_t paged in this iteration */
+} ogs_paging_area_t;
+
+typedef struct ogs_paging_member_s {
+    ogs_lnode_t     lnode;          /* A node of ogs_paging_area_t.node_list */
+    ogs_lnode_t     node_lnode;     /* A node of the paging list of the node */
+
+    ogs_paging_area_t *area;
+    void            *node;          /* gNB or eNB */
+} ogs_paging_member_t;
+
+/* Embedded in the UE context */
+typedef struct ogs_paging_ue_s {
+    ogs_lnode_t     lnode;          /* A node of ogs_paging_area_t.ue_list */
+    ogs_paging_area_t *area;
+} ogs_paging_ue_t;
+
+typedef struct ogs_paging_index_s {
+    ogs_hash_t      *area_hash;     /* hash table (TAI : ogs_paging_area_t) */
+    ogs_list_t      pending_list;   /* Areas with UEs to be paged */
+    ogs_timer_t     *t_flush;
+} ogs_paging_index_t;
+
+void ogs_paging_index_init(ogs_paging_index_t *index,
+        ogs_timer_mgr_t *timer_mgr, void (*flush)(void *data));
+void ogs_paging_index_final(ogs_paging_index_t *index);
+
+void ogs_paging_node_add(ogs_paging_index_t *index,
+        ogs_list_t *paging_list, void *node, const void *key, int key_len);
+void ogs_paging_node_clear(ogs_paging_index_t *index, ogs_list_t *paging_list);
+
+ogs_paging_area_t *ogs_paging_area_find(
+        ogs_paging_index_t *index, const void *key, int key_len);
+
+void ogs_paging_ue_queue(ogs_paging_index_t *index,
+        ogs_paging_area_t *area, ogs_paging_ue_t *ue);
+void ogs_paging_ue_dequeue(ogs_paging_ue_t *ue);
+
+ogs_paging_area_t *ogs_paging_pending_pop(ogs_paging_index_t *index);
+ogs_paging_ue_t *ogs_paging_ue_pop(ogs_paging_area_t *area);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_APP_PAGING_H */
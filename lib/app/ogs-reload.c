@@ -0,0 +1,577 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-app.h"
+
+#define MAX_NUM_OF_RELOAD 32
+
+typedef struct reload_value_s {
+    ogs_lnode_t lnode;
+
+    char *path;
+    char *value;
+} reload_value_t;
+
+/* Configuration flattened to "path = value" in document order */
+typedef struct reload_snapshot_s {
+    ogs_list_t list;
+    ogs_hash_t *hash;
+} reload_snapshot_t;
+
+static struct {
+    struct {
+        char *path;
+        bool relative;
+        ogs_app_reload_f apply;
+
+        char *match;            /* Full path while reloading */
+        bool pending;
+    } entry[MAX_NUM_OF_RELOAD];
+    int num_of_entry;
+
+    reload_snapshot_t *startup;
+    reload_snapshot_t *current;
+
+    /* Loaded at startup, the values parsed from it still point into it */
+    yaml_document_t *document;
+
+    /* Copies of what reload_logger() applied, the startup ones are kept */
+    struct {
+        const char *level;
+        const char *domain;
+        char *level_copy;
+        char *domain_copy;
+    } logger;
+
+    struct {
+        int applied;
+        int failed;
+        int restart;
+    } result;
+
+    int requested;
+} self;
+
+static int initialized = 0;
+
+static int reload_logger(const char *local);
+
+static reload_snapshot_t *snapshot_create(yaml_document_t *document);
+static void snapshot_free(reload_snapshot_t *snap);
+
+static void add_entry(const char *path, bool relative, ogs_app_reload_f apply)
+{
+    ogs_assert(path);
+    ogs_assert(apply);
+    ogs_assert(self.num_of_entry < MAX_NUM_OF_RELOAD);
+
+    self.entry[self.num_of_entry].path = ogs_strdup(path);
+    ogs_assert(self.entry[self.num_of_entry].path);
+    self.entry[self.num_of_entry].relative = relative;
+    self.entry[self.num_of_entry].apply = apply;
+
+    self.num_of_entry++;
+}
+
+int ogs_app_reload_init(void)
+{
+    ogs_assert(initialized == 0);
+    ogs_assert(ogs_app()->document);
+
+    memset(&self, 0, sizeof(self));
+    self.document = ogs_app()->document;
+    self.logger.level = ogs_app()->logger.level;
+    self.logger.domain = ogs_app()->logger.domain;
+
+    /* Taken before the NF parsers get to the document and split values */
+    self.startup = snapshot_create(ogs_app()->document);
+    self.current = self.startup;
+
+    add_entry("logger.level", false, reload_logger);
+    add_entry("logger.domain", false, reload_logger);
+
+    add_entry("time.message", true, ogs_app_reload_local_time_conf);
+    add_entry("time.handover", true, ogs_app_reload_local_time_conf);
+    add_entry("time.subscription", true, ogs_app_reload_local_time_conf);
+
+    initialized = 1;
+
+    return OGS_OK;
+}
+
+void ogs_app_reload_final(void)
+{
+    int i;
+
+    if (initialized == 0)
+        return;
+
+    for (i = 0; i < self.num_of_entry; i++)
+        ogs_free(self.entry[i].path);
+
+    if (self.current != self.startup)
+        snapshot_free(self.current);
+    snapshot_free(self.startup);
+
+    ogs_app()->logger.level = self.logger.level;
+    ogs_app()->logger.domain = self.logger.domain;
+    if (self.logger.level_copy)
+        ogs_free(self.logger.level_copy);
+    if (self.logger.domain_copy)
+        ogs_free(self.logger.domain_copy);
+
+    /* The startup document is freed last, by ogs_app_context_final() */
+    if (ogs_app()->document != self.document) {
+        ogs_yaml_document_free(ogs_app()->document);
+        ogs_app()->document = self.document;
+    }
+
+    initialized = 0;
+}
+
+int ogs_app_reload_add(const char *path, ogs_app_reload_f apply)
+{
+    ogs_assert(initialized == 1);
+
+    add_entry(path, true, apply);
+
+    return OGS_OK;
+}
+
+/*
+ * May be called from any thread, such as the one catching SIGHUP.
+ * The reload itself runs in the NF thread at ogs_app_reload_check().
+ */
+void ogs_app_reload_request(void)
+{
+    __atomic_store_n(&self.requested, 1, __ATOMIC_RELEASE);
+
+    if (ogs_app()->pollset)
+        ogs_pollset_notify(ogs_app()->pollset);
+}
+
+void ogs_app_reload_check(void)
+{
+    if (!__atomic_load_n(&self.requested, __ATOMIC_ACQUIRE))
+        return;
+    if (!__atomic_exchange_n(&self.requested, 0, __ATOMIC_ACQ_REL))
+        return;
+
+    ogs_app_reload();
+}
+
+static void snapshot_add(
+        reload_snapshot_t *snap, const char *path, const char *value)
+{
+    reload_value_t *v = NULL;
+
+    v = ogs_calloc(1, sizeof(*v));
+    ogs_assert(v);
+    v->path = ogs_strdup(path);
+    ogs_assert(v->path);
+    v->value = ogs_strdup(value ? value : "");
+    ogs_assert(v->value);
+
+    ogs_list_add(&snap->list, v);
+    ogs_hash_set(snap->hash, v->path, OGS_HASH_KEY_STRING, v);
+}
+
+static void snapshot_node(reload_snapshot_t *snap,
+        yaml_document_t *document, yaml_node_t *node, const char *path)
+{
+    char *child = NULL;
+
+    switch (node->type) {
+    case YAML_SCALAR_NODE:
+        snapshot_add(snap, path, (const char *)node->data.scalar.value);
+        break;
+    case YAML_MAPPING_NODE: {
+        yaml_node_pair_t *pair = NULL;
+
+        if (node->data.mapping.pairs.start == node->data.mapping.pairs.top)
+            snapshot_add(snap, path, "{}");
+
+        for (pair = node->data.mapping.pairs.start;
+                pair < node->data.mapping.pairs.top; pair++) {
+            yaml_node_t *key = yaml_document_get_node(document, pair->key);
+            yaml_node_t *value = yaml_document_get_node(document, pair->value);
+
+            if (!key || key->type != YAML_SCALAR_NODE || !value)
+                continue;
+
+            child = ogs_msprintf("%s.%s", path, key->data.scalar.value);
+            ogs_assert(child);
+            snapshot_node(snap, document, value, child);
+            ogs_free(child);
+        }
+        break;
+    }
+    case YAML_SEQUENCE_NODE: {
+        yaml_node_item_t *item = NULL;
+        int i = 0;
+
+        if (node->data.sequence.items.start == node->data.sequence.items.top)
+            snapshot_add(snap, path, "[]");
+
+        for (item = node->data.sequence.items.start;
+                item < node->data.sequence.items.top; item++, i++) {
+            yaml_node_t *value = yaml_document_get_node(document, *item);
+
+            if (!value)
+                continue;
+
+            child = ogs_msprintf("%s[%d]", path, i);
+            ogs_assert(child);
+            snapshot_node(snap, document, value, child);
+            ogs_free(child);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static reload_snapshot_t *snapshot_create(yaml_document_t *document)
+{
+    reload_snapshot_t *snap = NULL;
+    yaml_node_t *root = NULL;
+    yaml_node_pair_t *pair = NULL, *prev = NULL;
+
+    ogs_assert(document);
+
+    snap = ogs_calloc(1, sizeof(*snap));
+    ogs_assert(snap);
+    ogs_list_init(&snap->list);
+    snap->hash = ogs_hash_make();
+    ogs_assert(snap->hash);
+
+    root = yaml_document_get_root_node(document);
+    if (!root || root->type != YAML_MAPPING_NODE)
+        return snap;
+
+    /*
+     * Several NFs of the same kind may share one file and pick their
+     * section with -k, so a repeated root key is numbered: smf, smf[1], ..
+     */
+    for (pair = root->data.mapping.pairs.start;
+            pair < root->data.mapping.pairs.top; pair++) {
+        yaml_node_t *key = yaml_document_get_node(document, pair->key);
+        yaml_node_t *value = yaml_document_get_node(document, pair->value);
+        char *path = NULL;
+        int n = 0;
+
+        if (!key || key->type != YAML_SCALAR_NODE || !value)
+            continue;
+
+        for (prev = root->data.mapping.pairs.start; prev < pair; prev++) {
+            yaml_node_t *k = yaml_document_get_node(document, prev->key);
+            if (k && k->type == YAML_SCALAR_NODE &&
+                !strcmp((char *)k->data.scalar.value,
+                    (char *)key->data.scalar.value))
+                n++;
+        }
+
+        if (n)
+            path = ogs_msprintf("%s[%d]", key->data.scalar.value, n);
+        else
+            path = ogs_msprintf("%s", key->data.scalar.value);
+        ogs_assert(path);
+        snapshot_node(snap, document, value, path);
+        ogs_free(path);
+    }
+
+    return snap;
+}
+
+static void snapshot_free(reload_snapshot_t *snap)
+{
+    reload_value_t *v = NULL, *next_v = NULL;
+
+    ogs_assert(snap);
+
+    ogs_hash_destroy(snap->hash);
+
+    ogs_list_for_each_safe(&snap->list, next_v, v) {
+        ogs_list_remove(&snap->list, v);
+        ogs_free(v->path);
+        ogs_free(v->value);
+        ogs_free(v);
+    }
+
+    ogs_free(snap);
+}
+
+static bool value_changed(reload_snapshot_t *snap, reload_value_t *v)
+{
+    reload_value_t *old = NULL;
+
+    old = ogs_hash_get(snap->hash, v->path, OGS_HASH_KEY_STRING);
+
+    return !old || strcmp(old->value, v->value);
+}
+
+/* "session" covers "session[0].subnet", but not "sessions" */
+static bool path_under(const char *path, const char *prefix)
+{
+    size_t len = strlen(prefix);
+
+    return !strncmp(path, prefix, len) &&
+        (path[len] == '\0' || path[len] == '.' || path[len] == '[');
+}
+
+static int entry_find(const char *path)
+{
+    int i;
+
+    for (i = 0; i < self.num_of_entry; i++) {
+        if (self.entry[i].match && path_under(path, self.entry[i].match))
+            return i;
+    }
+
+    return -1;
+}
+
+static bool needs_restart(const char *path, const char *own)
+{
+    if (entry_find(path) >= 0)
+        return false;
+
+    /* Sections of the other NFs sharing the file are not ours to report */
+    return (own && path_under(path, own)) ||
+        path_under(path, "logger") ||
+        path_under(path, "global") ||
+        path_under(path, "db_uri");
+}
+
+static void mark_pending(const char *path)
+{
+    int i = entry_find(path);
+
+    if (i >= 0)
+        self.entry[i].pending = true;
+}
+
+int ogs_app_reload(void)
+{
+    yaml_document_t *document = NULL;
+    reload_snapshot_t *snap = NULL;
+    reload_value_t *v = NULL;
+    char *own = NULL;
+    int i, j, applied = 0, failed = 0, restart = 0;
+
+    ogs_assert(initialized == 1);
+    ogs_assert(ogs_app()->file);
+
+    ogs_info("Reloading configuration '%s'", ogs_app()->file);
+
+    document = ogs_yaml_document_load(ogs_app()->file);
+    if (!document) {
+        ogs_error("Configuration not reloaded, the running one is kept");
+        return OGS_ERROR;
+    }
+
+    snap = snapshot_create(document);
+
+    if (ogs_app()->local) {
+        if (ogs_app()->config_section_id)
+            own = ogs_msprintf("%s[%d]",
+                    ogs_app()->local, ogs_app()->config_section_id);
+        else
+            own = ogs_msprintf("%s", ogs_app()->local);
+        ogs_assert(own);
+    }
+
+    for (i = 0; i < self.num_of_entry; i++) {
+        self.entry[i].pending = false;
+        self.entry[i].match = NULL;
+        if (!self.entry[i].relative)
+            self.entry[i].match = ogs_strdup(self.entry[i].path);
+        else if (own)
+            self.entry[i].match =
+                ogs_msprintf("%s.%s", own, self.entry[i].path);
+    }
+
+    /* Compared with the startup file, as none of these were taken in */
+    ogs_list_for_each(&snap->list, v) {
+        if (value_changed(self.startup, v) && needs_restart(v->path, own)) {
+            ogs_warn("[%s] changed, needs a restart", v->path);
+            restart++;
+        }
+    }
+    ogs_list_for_each(&self.startup->list, v) {
+        if (!ogs_hash_get(snap->hash, v->path, OGS_HASH_KEY_STRING) &&
+            needs_restart(v->path, own)) {
+            ogs_warn("[%s] removed, needs a restart", v->path);
+            restart++;
+        }
+    }
+
+    /* Compared with what was applied last */
+    ogs_list_for_each(&snap->list, v) {
+        if (value_changed(self.current, v))
+            mark_pending(v->path);
+    }
+    ogs_list_for_each(&self.current->list, v) {
+        if (!ogs_hash_get(snap->hash, v->path, OGS_HASH_KEY_STRING))
+            mark_pending(v->path);
+    }
+
+    for (i = 0; i < self.num_of_entry; i++) {
+        int rv;
+
+        if (!self.entry[i].pending)
+            continue;
+
+        /*
+         * Handlers copy what they keep, so nothing points into the
+         * document of the previous reload any more
+         */
+        if (document) {
+            if (ogs_app()->document != self.document)
+                ogs_yaml_document_free(ogs_app()->document);
+
+            ogs_app()->document = document;
+            document = NULL;
+        }
+
+        /* Several paths may share one handler */
+        for (j = 0; j < i; j++)
+            if (self.entry[j].pending &&
+                self.entry[j].apply == self.entry[i].apply)
+                break;
+        if (j < i)
+            continue;
+
+        rv = self.entry[i].apply(ogs_app()->local);
+        if (rv == OGS_OK) {
+            ogs_info("[%s] applied", self.entry[i].match);
+            applied++;
+        } else {
+            ogs_error("[%s] not applied, the running value is kept",
+                    self.entry[i].match);
+            failed++;
+        }
+    }
+
+    for (i = 0; i < self.num_of_entry; i++) {
+        if (self.entry[i].match)
+            ogs_free(self.entry[i].match);
+        self.entry[i].match = NULL;
+    }
+    if (own)
+        ogs_free(own);
+
+    if (document)
+        ogs_yaml_document_free(document);
+
+    /* A failed handler is tried again on the next reload */
+    if (failed == 0) {
+        if (self.current != self.startup)
+            snapshot_free(self.current);
+        self.current = snap;
+    } else {
+        snapshot_free(snap);
+    }
+
+    self.result.applied = applied;
+    self.result.failed = failed;
+    self.result.restart = restart;
+
+    if (applied || failed || restart)
+        ogs_info("Configuration reloaded "
+                "[%d applied, %d failed, %d need a restart]",
+                applied, failed, restart);
+    else
+        ogs_info("Configuration reloaded [no changes]");
+
+    return failed ? OGS_ERROR : OGS_OK;
+}
+
+void ogs_app_reload_result(int *applied, int *failed, int *restart)
+{
+    if (applied)
+        *applied = self.result.applied;
+    if (failed)
+        *failed = self.result.failed;
+    if (restart)
+        *restart = self.result.restart;
+}
+
+static int reload_logger(const char *local)
+{
+    yaml_document_t *document = NULL;
+    ogs_yaml_iter_t root_iter;
+    const char *level = NULL, *domain = NULL;
+    char *level_copy = NULL, *domain_copy = NULL;
+    int rv;
+
+    document = ogs_app()->document;
+    ogs_assert(document);
+
+    ogs_yaml_iter_init(&root_iter, document);
+    while (ogs_yaml_iter_next(&root_iter)) {
+        const char *root_key = ogs_yaml_iter_key(&root_iter);
+        ogs_assert(root_key);
+        if (!strcmp(root_key, "logger")) {
+            ogs_yaml_iter_t logger_iter;
+            ogs_yaml_iter_recurse(&root_iter, &logger_iter);
+            while (ogs_yaml_iter_next(&logger_iter)) {
+                const char *logger_key = ogs_yaml_iter_key(&logger_iter);
+                ogs_assert(logger_key);
+                if (!strcmp(logger_key, "level"))
+                    level = ogs_yaml_iter_value(&logger_iter);
+                else if (!strcmp(logger_key, "domain"))
+                    domain = ogs_yaml_iter_value(&logger_iter);
+            }
+        }
+    }
+
+    /* A domain dropped from the list goes back to the default level */
+    ogs_log_set_mask_level(NULL, ogs_core()->log.level);
+
+    rv = ogs_log_config_domain(domain, level);
+    if (rv != OGS_OK) {
+        ogs_log_config_domain(
+                ogs_app()->logger.domain, ogs_app()->logger.level);
+        return rv;
+    }
+
+    /* The document is freed by the next reload */
+    if (level) {
+        level_copy = ogs_strdup(level);
+        ogs_assert(level_copy);
+    }
+    if (domain) {
+        domain_copy = ogs_strdup(domain);
+        ogs_assert(domain_copy);
+    }
+
+    if (self.logger.level_copy)
+        ogs_free(self.logger.level_copy);
+    if (self.logger.domain_copy)
+        ogs_free(self.logger.domain_copy);
+    self.logger.level_copy = level_copy;
+    self.logger.domain_copy = domain_copy;
+
+    ogs_app()->logger.level = level_copy;
+    ogs_app()->logger.domain = domain_copy;
+
+    return OGS_OK;
+}
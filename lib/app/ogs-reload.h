@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_APP_INSIDE) && !defined(OGS_APP_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_APP_RELOAD_H
+#define OGS_APP_RELOAD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Configuration reload
+ *
+ * On a reload request the configuration file is read again and compared
+ * with the running one. A changed key is applied by the handler registered
+ * for it with ogs_app_reload_add(), which parses ogs_app()->document again.
+ * Any other change of the NF section, logger, global or db_uri is reported
+ * as needing a restart and left alone.
+ *
+ * The path names a key of the NF section, such as "time.message" or
+ * "session", and covers everything below it. A handler returns OGS_OK once
+ * the new value is in use, or OGS_ERROR leaving the running value as it was.
+ * The document of a reload is freed by the next one, so a handler copies
+ * whatever it keeps from it.
+ */
+typedef int (*ogs_app_reload_f)(const char *local);
+
+int ogs_app_reload_init(void);
+void ogs_app_reload_final(void);
+
+int ogs_app_reload_add(const char *path, ogs_app_reload_f apply);
+
+void ogs_app_reload_request(void);
+void ogs_app_reload_check(void);
+int ogs_app_reload(void);
+
+/* Counts of the last ogs_app_reload(), as it logged them */
+void ogs_app_reload_result(int *applied, int *failed, int *restart);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_APP_RELOAD_H */
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2024 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-app.h"
+
+typedef struct ogs_worker_thread_s {
+    ogs_worker_t    *worker;
+    ogs_thread_t    *thread;
+    ogs_queue_t     *queue;
+} ogs_worker_thread_t;
+
+struct ogs_worker_s {
+    const char *name;
+
+    ogs_worker_handler_f handler;
+    ogs_worker_handler_f dispose;
+
+    int num_of_thread;
+    ogs_worker_thread_t *thread;
+
+    /* Events that could not be passed on to the main loop */
+    ogs_queue_t *returned;
+};
+
+static void worker_main(void *data);
+
+ogs_worker_t *ogs_worker_create(const char *name, int num_of_thread,
+        ogs_worker_handler_f handler, ogs_worker_handler_f dispose)
+{
+    ogs_worker_t *worker = NULL;
+    int i;
+
+    ogs_assert(name);
+    ogs_assert(num_of_thread > 0);
+    ogs_assert(handler);
+    ogs_assert(dispose);
+
+    worker = ogs_calloc(1, sizeof(*worker));
+    if (!worker) {
+        ogs_error("ogs_calloc() failed");
+        return NULL;
+    }
+    worker->name = name;
+    worker->handler = handler;
+    worker->dispose = dispose;
+
+    worker->returned = ogs_queue_create(ogs_app()->pool.event);
+    if (!worker->returned) {
+        ogs_error("ogs_queue_create() failed");
+        ogs_worker_destroy(worker);
+        return NULL;
+    }
+
+    worker->thread = ogs_calloc(num_of_thread, sizeof(ogs_worker_thread_t));
+    if (!worker->thread) {
+        ogs_error("ogs_calloc() failed");
+        ogs_worker_destroy(worker);
+        return NULL;
+    }
+
+    for (i = 0; i < num_of_thread; i++) {
+        ogs_worker_thread_t *t = &worker->thread[i];
+
+        t->worker = worker;
+        t->queue = ogs_queue_create(ogs_app()->pool.event);
+        if (!t->queue) {
+            ogs_error("ogs_queue_create() failed");
+            ogs_worker_destroy(worker);
+            return NULL;
+        }
+        t->thread = ogs_thread_create(worker_main, t);
+        if (!t->thread) {
+            ogs_error("ogs_thread_create() failed");
+            ogs_queue_destroy(t->queue);
+            t->queue = NULL;
+            ogs_worker_destroy(worker);
+            return NULL;
+        }
+        worker->num_of_thread++;
+    }
+
+    ogs_info("%s worker threads: %d", name, worker->num_of_thread);
+
+    return worker;
+}
+
+void ogs_worker_destroy(ogs_worker_t *worker)
+{
+    void *event = NULL;
+    int i, rv;
+
+    ogs_assert(worker);
+
+    /*
+     * A NULL event stops the thread once everything queued before it
+     * has been passed on to the main loop, or returned.
+     */
+    for (i = 0; i < worker->num_of_thread; i++) {
+        rv = ogs_queue_push(worker->thread[i].queue, NULL);
+        ogs_assert(rv == OGS_OK);
+    }
+
+    for (i = 0; i < worker->num_of_thread; i++) {
+        ogs_thread_destroy(worker->thread[i].thread);
+        ogs_queue_destroy(worker->thread[i].queue);
+    }
+
+    if (worker->returned) {
+        while (ogs_queue_trypop(worker->returned, &event) == OGS_OK)
+            worker->dispose(event);
+        ogs_queue_destroy(worker->returned);
+    }
+
+    if (worker->thread)
+        ogs_free(worker->thread);
+    ogs_free(worker);
+}
+
+int ogs_worker_push(ogs_worker_t *worker, unsigned int shard, void *event)
+{
+    ogs_assert(worker);
+    ogs_assert(worker->num_of_thread > 0);
+    ogs_assert(event);
+
+    return ogs_queue_push(
+            worker->thread[shard % worker->num_of_thread].queue, event);
+}
+
+static void worker_main(void *data)
+{
+    ogs_worker_thread_t *self = data;
+    ogs_worker_t *worker = NULL;
+    void *event = NULL;
+    int rv;
+
+    ogs_assert(self);
+    worker = self->worker;
+    ogs_assert(worker);
+
+    for ( ;; ) {
+        rv = ogs_queue_pop(self->queue, &event);
+        if (rv == OGS_DONE)
+            break;
+        if (rv != OGS_OK)
+            continue;
+
+        if (!event)
+            break;
+
+        worker->handler(event);
+
+        rv = ogs_queue_push(ogs_app()->queue, event);
+        if (rv != OGS_OK) {
+            if (rv != OGS_DONE)
+                ogs_error("[%s] ogs_queue_push() failed:%d",
+                        worker->name, (int)rv);
+            /* The main loop releases it in ogs_worker_destroy() */
+            rv = ogs_queue_trypush(worker->returned, event);
+            if (rv != OGS_OK)
+                ogs_error("[%s] Event dropped:%d", worker->name, (int)rv);
+        }
+    }
+}
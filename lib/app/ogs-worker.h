@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2024 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_APP_INSIDE) && !defined(OGS_APP_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_APP_WORKER_H
+#define OGS_APP_WORKER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Sharded worker threads
+ *
+ * Events pushed with the same shard value are handled by the same thread,
+ * in order. Each thread runs the handler on the event and then passes it
+ * on to the NF main loop through ogs_app()->queue.
+ *
+ * Once the main queue has been terminated, events can no longer be passed
+ * on. They are kept and released with the dispose callback by
+ * ogs_worker_destroy(), which must run on the main loop thread, so that
+ * dispose may use the NF context and its non thread-safe pools.
+ */
+typedef struct ogs_worker_s ogs_worker_t;
+typedef void (*ogs_worker_handler_f)(void *event);
+
+ogs_worker_t *ogs_worker_create(const char *name, int num_of_thread,
+        ogs_worker_handler_f handler, ogs_worker_handler_f dispose);
+void ogs_worker_destroy(ogs_worker_t *worker);
+
+int ogs_worker_push(ogs_worker_t *worker, unsigned int shard, void *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_APP_WORKER_H */
@@ -217,3 +217,95 @@ int ogs_yaml_iter_bool(ogs_yaml_iter_t *iter)
 
     return 0;
 }
+
+yaml_document_t *ogs_yaml_document_load(const char *file)
+{
+    FILE *fp;
+    yaml_parser_t parser;
+    yaml_document_t *document = NULL;
+
+    ogs_assert(file);
+
+    fp = fopen(file, "rb");
+    if (!fp) {
+        ogs_error("cannot open file `%s`", file);
+        return NULL;
+    }
+
+    ogs_assert(yaml_parser_initialize(&parser));
+    yaml_parser_set_input_file(&parser, fp);
+
+    document = calloc(1, sizeof(yaml_document_t));
+    ogs_assert(document);
+    if (!yaml_parser_load(&parser, document)) {
+        ogs_error("Failed to parse configuration file '%s'", file);
+        switch (parser.error) {
+        case YAML_MEMORY_ERROR:
+            ogs_error("Memory error: Not enough memory for parsing");
+            break;
+        case YAML_READER_ERROR:
+            if (parser.problem_value != -1)
+                ogs_error("Reader error - %s: #%X at %zd", parser.problem,
+                    parser.problem_value, parser.problem_offset);
+            else
+                ogs_error("Reader error - %s at %zd", parser.problem,
+                    parser.problem_offset);
+            break;
+        case YAML_SCANNER_ERROR:
+            if (parser.context)
+                ogs_error("Scanner error - %s at line %zu, column %zu "
+                        "%s at line %zu, column %zu", parser.context,
+                        parser.context_mark.line+1,
+                        parser.context_mark.column+1,
+                        parser.problem, parser.problem_mark.line+1,
+                        parser.problem_mark.column+1);
+            else
+                ogs_error("Scanner error - %s at line %zu, column %zu",
+                        parser.problem, parser.problem_mark.line+1,
+                        parser.problem_mark.column+1);
+            break;
+        case YAML_PARSER_ERROR:
+            if (parser.context)
+                ogs_error("Parser error - %s at line %zu, column %zu "
+                        "%s at line %zu, column %zu", parser.context,
+                        parser.context_mark.line+1,
+                        parser.context_mark.column+1,
+                        parser.problem, parser.problem_mark.line+1,
+                        parser.problem_mark.column+1);
+            else
+                ogs_error("Parser error - %s at line %zu, column %zu",
+                        parser.problem, parser.problem_mark.line+1,
+                        parser.problem_mark.column+1);
+            break;
+        default:
+            /* Couldn't happen. */
+            ogs_assert_if_reached();
+            break;
+        }
+
+        free(document);
+        yaml_parser_delete(&parser);
+        ogs_assert(!fclose(fp));
+        return NULL;
+    }
+
+    yaml_parser_delete(&parser);
+    ogs_assert(!fclose(fp));
+
+    /* An empty file has no root node to iterate */
+    if (!yaml_document_get_root_node(document)) {
+        ogs_error("Empty configuration file '%s'", file);
+        ogs_yaml_document_free(document);
+        return NULL;
+    }
+
+    return document;
+}
+
+void ogs_yaml_document_free(yaml_document_t *document)
+{
+    ogs_assert(document);
+
+    yaml_document_delete(document);
+    free(document);
+}
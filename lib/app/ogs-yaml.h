@@ -62,6 +62,9 @@ const char *ogs_yaml_iter_value(ogs_yaml_iter_t *iter);
 int ogs_yaml_iter_has_value(ogs_yaml_iter_t *iter);
 int ogs_yaml_iter_bool(ogs_yaml_iter_t *iter);
 
+yaml_document_t *ogs_yaml_document_load(const char *file);
+void ogs_yaml_document_free(yaml_document_t *document);
+
 #ifdef __cplusplus
 }
 #endif
@@ -81,3 +81,210 @@ void ogs_asn_free(const asn_TYPE_descriptor_t *td, void *sptr)
 
     ASN_STRUCT_FREE_CONTENTS_ONLY(*td, sptr);
 }
+
+/*
+ * X.691 #11.9 : Aligned length determinant
+ *
+ * Fragmented encoding (length >= 16K) is not supported.
+ * The caller will fall back to the full decoder in that case.
+ */
+static int lazy_get_length(
+        const uint8_t **pos, const uint8_t *end, size_t *length)
+{
+    const uint8_t *p = *pos;
+
+    if (p >= end)
+        return OGS_ERROR;
+
+    if ((p[0] & 0x80) == 0) {
+        *length = p[0];
+        p += 1;
+    } else if ((p[0] & 0xc0) == 0x80) {
+        if (p + 2 > end)
+            return OGS_ERROR;
+        *length = ((p[0] & 0x3f) << 8) | p[1];
+        p += 2;
+    } else {
+        return OGS_ERROR;
+    }
+
+    if (p + *length > end)
+        return OGS_ERROR;
+
+    *pos = p;
+    return OGS_OK;
+}
+
+int ogs_asn_lazy_decode(ogs_asn_lazy_pdu_t *pdu, ogs_pkbuf_t *pkbuf)
+{
+    const uint8_t *p = NULL, *end = NULL;
+    size_t length;
+    int i, count;
+
+    ogs_assert(pdu);
+    ogs_assert(pkbuf);
+    ogs_assert(pkbuf->data);
+
+    memset(pdu, 0, sizeof(*pdu));
+
+    p = pkbuf->data;
+    end = p + pkbuf->len;
+
+    /*
+     * PDU ::= CHOICE {
+     *     initiatingMessage, successfulOutcome, unsuccessfulOutcome, ... }
+     *
+     * 1 bit extension, 2 bits choice index, then octet-aligned
+     */
+    if (p + 3 > end)
+        return OGS_ERROR;
+    if (p[0] & 0x80)
+        return OGS_ERROR;
+    pdu->present = ((p[0] >> 5) & 0x03) + 1;
+
+    /* procedureCode INTEGER (0..255) */
+    pdu->procedureCode = p[1];
+
+    /* criticality ENUMERATED { reject, ignore, notify } */
+    pdu->criticality = (p[2] >> 6) & 0x03;
+    p += 3;
+
+    /* value : Open Type */
+    if (lazy_get_length(&p, end, &length) != OGS_OK)
+        return OGS_ERROR;
+    end = p + length;
+
+    /*
+     * Message ::= SEQUENCE { protocolIEs ProtocolIE-Container, ... }
+     *
+     * 1 bit extension, then SIZE (0..maxProtocolIEs) in two octets
+     */
+    if (p + 3 > end)
+        return OGS_ERROR;
+    count = (p[1] << 8) | p[2];
+    p += 3;
+
+    if (count > OGS_ASN_MAX_LAZY_IE)
+        return OGS_ERROR;
+
+    for (i = 0; i < count; i++) {
+        ogs_asn_ie_view_t *ie = &pdu->ie[i];
+
+        /* id INTEGER (0..65535), criticality */
+        if (p + 3 > end)
+            return OGS_ERROR;
+        ie->id = (p[0] << 8) | p[1];
+        ie->criticality = (p[2] >> 6) & 0x03;
+        p += 3;
+
+        if (lazy_get_length(&p, end, &length) != OGS_OK)
+            return OGS_ERROR;
+
+        ie->buf = p;
+        ie->size = length;
+        p += length;
+    }
+    pdu->num_of_ie = count;
+
+    return OGS_OK;
+}
+
+ogs_asn_ie_view_t *ogs_asn_lazy_find_ie(ogs_asn_lazy_pdu_t *pdu, long id)
+{
+    int i;
+
+    ogs_assert(pdu);
+
+    for (i = 0; i < pdu->num_of_ie; i++) {
+        if (pdu->ie[i].id == id)
+            return &pdu->ie[i];
+    }
+
+    return NULL;
+}
+
+int ogs_asn_lazy_decode_ie(const asn_TYPE_descriptor_t *td,
+        void *struct_ptr, size_t struct_size, ogs_asn_ie_view_t *ie)
+{
+    asn_dec_rval_t dec_ret = {0};
+
+    ogs_assert(td);
+    ogs_assert(struct_ptr);
+    ogs_assert(struct_size);
+    ogs_assert(ie);
+
+    memset(struct_ptr, 0, struct_size);
+
+    if (!ie->buf || !ie->size) {
+        ogs_warn("Empty IE [id:%ld]", ie->id);
+        return OGS_ERROR;
+    }
+
+    dec_ret = aper_decode(NULL, td, (void **)&struct_ptr,
+            ie->buf, ie->size, 0, 0);
+
+    if (dec_ret.code != RC_OK) {
+        ogs_warn("Failed to decode IE [id:%ld,code:%d,consumed:%d]",
+                ie->id, dec_ret.code, (int)dec_ret.consumed);
+        ogs_asn_free(td, struct_ptr);
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
+/*
+ * The resulting OCTET_STRING points into the receive buffer.
+ * It MUST NOT be freed with ogs_asn_free().
+ */
+int ogs_asn_lazy_get_OCTET_STRING(
+        ogs_asn_ie_view_t *ie, OCTET_STRING_t *octet_string)
+{
+    const uint8_t *p = NULL;
+    size_t length;
+
+    ogs_assert(ie);
+    ogs_assert(octet_string);
+
+    p = ie->buf;
+    if (lazy_get_length(&p, ie->buf + ie->size, &length) != OGS_OK)
+        return OGS_ERROR;
+
+    memset(octet_string, 0, sizeof(*octet_string));
+    octet_string->buf = (uint8_t *)p;
+    octet_string->size = length;
+
+    return OGS_OK;
+}
+
+/*
+ * X.691 #12.2.6 : Constrained whole number with a range over 64K
+ *
+ * INTEGER (0..X) where X needs 'max_bytes' octets
+ * (AMF-UE-NGAP-ID : 5, RAN-UE-NGAP-ID/MME-UE-S1AP-ID : 4,
+ *  ENB-UE-S1AP-ID : 3)
+ */
+int ogs_asn_lazy_get_uint64(
+        ogs_asn_ie_view_t *ie, int max_bytes, uint64_t *value)
+{
+    int bits, length, i;
+
+    ogs_assert(ie);
+    ogs_assert(value);
+    ogs_assert(max_bytes > 1 && max_bytes <= 8);
+
+    if (!ie->buf || !ie->size)
+        return OGS_ERROR;
+
+    for (bits = 1; (1 << bits) < max_bytes; bits++);
+
+    length = (ie->buf[0] >> (8 - bits)) + 1;
+    if (length > max_bytes || (size_t)(length + 1) > ie->size)
+        return OGS_ERROR;
+
+    *value = 0;
+    for (i = 0; i < length; i++)
+        *value = (*value << 8) | ie->buf[1 + i];
+
+    return OGS_OK;
+}
@@ -24,6 +24,7 @@
 
 #include "asn_internal.h"
 #include "constr_TYPE.h"
+#include "OCTET_STRING.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +35,43 @@ int ogs_asn_decode(const asn_TYPE_descriptor_t *td,
         void *struct_ptr, size_t struct_size, ogs_pkbuf_t *pkbuf);
 void ogs_asn_free(const asn_TYPE_descriptor_t *td, void *sptr);
 
+/*
+ * Lazy APER decoding of NGAP/S1AP PDUs
+ *
+ * Only the outer PDU (choice, procedure code, criticality) and
+ * the ProtocolIE-Container are walked. Each IE value is kept as a view
+ * into the receive buffer, so the buffer must outlive the lazy PDU.
+ * The caller decodes only the IEs it actually needs.
+ */
+#define OGS_ASN_MAX_LAZY_IE 32
+
+typedef struct ogs_asn_ie_view_s {
+    long id;
+    long criticality;
+
+    const uint8_t *buf;
+    size_t size;
+} ogs_asn_ie_view_t;
+
+typedef struct ogs_asn_lazy_pdu_s {
+    int present;
+    long procedureCode;
+    long criticality;
+
+    int num_of_ie;
+    ogs_asn_ie_view_t ie[OGS_ASN_MAX_LAZY_IE];
+} ogs_asn_lazy_pdu_t;
+
+int ogs_asn_lazy_decode(ogs_asn_lazy_pdu_t *pdu, ogs_pkbuf_t *pkbuf);
+ogs_asn_ie_view_t *ogs_asn_lazy_find_ie(ogs_asn_lazy_pdu_t *pdu, long id);
+
+int ogs_asn_lazy_decode_ie(const asn_TYPE_descriptor_t *td,
+        void *struct_ptr, size_t struct_size, ogs_asn_ie_view_t *ie);
+int ogs_asn_lazy_get_OCTET_STRING(
+        ogs_asn_ie_view_t *ie, OCTET_STRING_t *octet_string);
+int ogs_asn_lazy_get_uint64(
+        ogs_asn_ie_view_t *ie, int max_bytes, uint64_t *value);
+
 #ifdef __cplusplus
 }
 #endif
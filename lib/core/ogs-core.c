@@ -39,6 +39,8 @@ static ogs_core_context_t self = {
 void ogs_core_initialize(void)
 {
     ogs_mem_init();
+    ogs_pool_elastic_init();
+    ogs_hash_init();
     ogs_log_init();
     ogs_pkbuf_init();
     ogs_socket_init();
@@ -58,6 +60,8 @@ void ogs_core_terminate(void)
     ogs_socket_final();
     ogs_pkbuf_final();
     ogs_log_final();
+    ogs_hash_final();
+    ogs_pool_elastic_final();
     ogs_mem_final();
 }
 
@@ -43,6 +43,8 @@ const ogs_pollset_actions_t ogs_epoll_actions = {
     epoll_process,
 
     ogs_notify_pollset,
+
+    NULL, /* add_recv */
 };
 
 struct epoll_map_s {
@@ -273,10 +275,10 @@ static int epoll_process(ogs_pollset_t *pollset, ogs_time_t timeout)
         if (!map) continue;
 
         if (map->read && map->write && map->read == map->write) {
-            map->read->handler(when, map->read->fd, map->read->data);
+            ogs_poll_dispatch(map->read, when);
         } else {
             if ((when & OGS_POLLIN) && map->read)
-                map->read->handler(when, map->read->fd, map->read->data);
+                ogs_poll_dispatch(map->read, when);
 
             /*
              * map->read->handler() can call ogs_remove_epoll()
@@ -286,7 +288,7 @@ static int epoll_process(ogs_pollset_t *pollset, ogs_time_t timeout)
             if (!map) continue;
 
             if ((when & OGS_POLLOUT) && map->write)
-                map->write->handler(when, map->write->fd, map->write->data);
+                ogs_poll_dispatch(map->write, when);
         }
     }
     
@@ -118,16 +118,46 @@ void ogs_fsm_dispatch(void *fsm, void *event)
     fsm_event_t *e = event;
     ogs_fsm_handler_t tmp = NULL;
 
+    ogs_prof_t *prof = NULL;
+    uint64_t start = 0;
+    int id = 0;
+    const char *name = NULL;
+
     ogs_assert(sm);
 
     tmp = sm->state;
     ogs_assert(tmp);
 
+    prof = ogs_prof_current();
+    if (prof && e) {
+        /* fsm_entry()/fsm_exit() overwrite e->id, so keep it here */
+        id = e->id;
+        if (prof->fsm_depth == 0 && prof->event_name)
+            name = prof->event_name(e);
+        prof->fsm_depth++;
+        start = ogs_prof_now();
+        if (prof->fsm_depth == 1)
+            ogs_time_cache_set((ogs_time_t)(start / 1000));
+    } else {
+        prof = NULL;
+    }
+
     if (e)
         (*tmp)(sm, e);
 
     if (sm->state != tmp)
         fsm_change(fsm, tmp, sm->state, e);
+
+    if (prof) {
+        uint64_t elapsed = ogs_prof_now() - start;
+
+        ogs_prof_entry_add(prof->state, (uintptr_t)tmp, NULL, elapsed);
+
+        prof->fsm_depth--;
+        if (prof->fsm_depth == 0)
+            ogs_prof_entry_add(prof->event,
+                    (uintptr_t)id + 1, name, elapsed);
+    }
 }
 
 void ogs_fsm_fini(void *fsm, void *event)
@@ -50,13 +50,32 @@ struct ogs_hash_index_t {
 };
 
 struct ogs_hash_t {
+    ogs_lnode_t         lnode;  /* registry of named hashes */
+
     ogs_hash_entry_t    **array;
     ogs_hash_index_t    iterator;  /* For ogs_hash_first(NULL, ...) */
     unsigned int        count, max, seed;
     ogs_hashfunc_t      hash_func;
     ogs_hash_entry_t    *free;  /* List of recycled entries */
+
+    const char          *name;  /* Set by ogs_hash_set_name() */
+    uint64_t            lookups, hits, probes, replaced;
 };
 
+static ogs_list_t registry;
+static ogs_thread_mutex_t registry_mutex;
+
+void ogs_hash_init(void)
+{
+    ogs_list_init(&registry);
+    ogs_thread_mutex_init(&registry_mutex);
+}
+
+void ogs_hash_final(void)
+{
+    ogs_thread_mutex_destroy(&registry_mutex);
+}
+
 #define INITIAL_MAX 15 /* tunable == 2^n - 1 */
 
 static ogs_hash_entry_t **alloc_array(ogs_hash_t *ht, unsigned int max)
@@ -85,6 +104,9 @@ ogs_hash_t *ogs_hash_make(void)
     ht->array = alloc_array(ht, ht->max);
     ht->hash_func = NULL;
 
+    ht->name = NULL;
+    ht->lookups = ht->hits = ht->probes = ht->replaced = 0;
+
     return ht;
 }
 
@@ -106,6 +128,12 @@ void ogs_hash_destroy(ogs_hash_t *ht)
     ogs_assert(ht);
     ogs_assert(ht->array);
 
+    if (ht->name) {
+        ogs_thread_mutex_lock(&registry_mutex);
+        ogs_list_remove(&registry, ht);
+        ogs_thread_mutex_unlock(&registry_mutex);
+    }
+
     ogs_hash_clear(ht);
 
     he = ht->free;
@@ -281,6 +309,8 @@ static ogs_hash_entry_t **find_entry(ogs_hash_t *ht,
     /* scan linked list */
     for (hep = &ht->array[hash & ht->max], he = *hep;
          he; hep = &he->next, he = *hep) {
+        if (ht->name)
+            ht->probes++;
         if (he->hash == hash
             && he->klen == klen
             && memcmp(he->key, key, klen) == 0)
@@ -316,6 +346,11 @@ void *ogs_hash_get_debug(ogs_hash_t *ht,
     ogs_assert(klen);
 
     he = *find_entry(ht, key, klen, NULL, file_line);
+    if (ht->name) {
+        ht->lookups++;
+        if (he)
+            ht->hits++;
+    }
     if (he)
         return (void *)he->val;
     else
@@ -342,6 +377,8 @@ void ogs_hash_set_debug(ogs_hash_t *ht,
             --ht->count;
         } else {
             /* replace entry */
+            if (ht->name && (*hep)->val != val)
+                ht->replaced++;
             (*hep)->val = val;
             /* check that the collision rate isn't too high */
             if (ht->count > ht->max) {
@@ -380,6 +417,57 @@ unsigned int ogs_hash_count(ogs_hash_t *ht)
     return ht->count;
 }
 
+/*
+ * Naming a hash makes it keep lookup statistics and lists it
+ * in ogs_hash_stat_all() (e.g. for the metrics server).
+ */
+void ogs_hash_set_name(ogs_hash_t *ht, const char *name)
+{
+    ogs_assert(ht);
+    ogs_assert(name);
+    ogs_assert(!ht->name);
+
+    ht->name = name;
+
+    ogs_thread_mutex_lock(&registry_mutex);
+    ogs_list_add(&registry, ht);
+    ogs_thread_mutex_unlock(&registry_mutex);
+}
+
+void ogs_hash_stat(ogs_hash_t *ht, ogs_hash_stat_t *stat)
+{
+    ogs_assert(ht);
+    ogs_assert(stat);
+
+    stat->name = ht->name;
+    stat->count = __atomic_load_n(&ht->count, __ATOMIC_RELAXED);
+    stat->buckets = __atomic_load_n(&ht->max, __ATOMIC_RELAXED) + 1;
+    stat->lookups = __atomic_load_n(&ht->lookups, __ATOMIC_RELAXED);
+    stat->hits = __atomic_load_n(&ht->hits, __ATOMIC_RELAXED);
+    stat->probes = __atomic_load_n(&ht->probes, __ATOMIC_RELAXED);
+    stat->replaced = __atomic_load_n(&ht->replaced, __ATOMIC_RELAXED);
+}
+
+/*
+ * Can be called from another thread (e.g. the metrics server).
+ * The counters may be slightly stale.
+ */
+void ogs_hash_stat_all(
+        void (*cb)(const ogs_hash_stat_t *stat, void *data), void *data)
+{
+    ogs_hash_t *ht = NULL;
+    ogs_hash_stat_t stat;
+
+    ogs_assert(cb);
+
+    ogs_thread_mutex_lock(&registry_mutex);
+    ogs_list_for_each(&registry, ht) {
+        ogs_hash_stat(ht, &stat);
+        cb(&stat, data);
+    }
+    ogs_thread_mutex_unlock(&registry_mutex);
+}
+
 void ogs_hash_clear(ogs_hash_t *ht)
 {
     ogs_hash_index_t *hi;
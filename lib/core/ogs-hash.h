@@ -84,6 +84,24 @@ typedef int (ogs_hash_do_callback_fn_t)(
 int ogs_hash_do(ogs_hash_do_callback_fn_t *comp,
         void *rec, const ogs_hash_t *ht);
 
+typedef struct ogs_hash_stat_s {
+    const char *name;
+    unsigned int count;     /* entries */
+    unsigned int buckets;
+    uint64_t lookups;       /* ogs_hash_get() calls */
+    uint64_t hits;          /* lookups that found an entry */
+    uint64_t probes;        /* entries compared by get and set */
+    uint64_t replaced;      /* ogs_hash_set() over a different value */
+} ogs_hash_stat_t;
+
+void ogs_hash_set_name(ogs_hash_t *ht, const char *name);
+void ogs_hash_stat(ogs_hash_t *ht, ogs_hash_stat_t *stat);
+void ogs_hash_stat_all(
+        void (*cb)(const ogs_hash_stat_t *stat, void *data), void *data);
+
+void ogs_hash_init(void);
+void ogs_hash_final(void);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,934 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "core-config-private.h"
+
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <poll.h>
+#include <endian.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "ogs-core.h"
+#include "ogs-poll-private.h"
+
+/*
+ * io_uring based pollset.
+ *
+ * Every fd is armed with a one-shot IORING_OP_POLL_ADD and re-armed
+ * after its handler returns, which keeps the level-triggered semantics
+ * the handlers were written for (most of them read only one message
+ * per callback). Arming, re-arming and removal are only queued in the
+ * submission ring, and are flushed together with the wait for
+ * completions in a single io_uring_enter() per loop iteration.
+ *
+ * A stale completion (the fd was removed or re-armed with another mask
+ * in the meantime) is detected by the sequence number carried in
+ * user_data and ignored.
+ *
+ * A datagram socket added with ogs_pollset_add_recv() is not polled.
+ * It gets a multishot IORING_OP_RECVMSG instead, which receives every
+ * datagram into a packet buffer taken from a ring provided to the kernel
+ * (IORING_REGISTER_PBUF_RING), without a system call per packet. The
+ * buffer is handed to the handler and replaced in the ring by a new one.
+ * Kernels without multishot recvmsg (before 6.0) fall back to polling.
+ */
+
+#ifndef POLLRDHUP
+#define POLLRDHUP 0x2000
+#endif
+
+#define IO_URING_MAX_ENTRIES 4096
+#define IO_URING_IGNORE_DATA UINT64_MAX
+
+#define IO_URING_RECV_BUFFERS 256
+
+static void io_uring_init(ogs_pollset_t *pollset);
+static void io_uring_cleanup(ogs_pollset_t *pollset);
+static int io_uring_add(ogs_poll_t *poll);
+static int io_uring_remove(ogs_poll_t *poll);
+static int io_uring_process(ogs_pollset_t *pollset, ogs_time_t timeout);
+static int io_uring_add_recv(ogs_poll_t *poll);
+
+const ogs_pollset_actions_t ogs_io_uring_actions = {
+    io_uring_init,
+    io_uring_cleanup,
+
+    io_uring_add,
+    io_uring_remove,
+    io_uring_process,
+
+    ogs_notify_pollset,
+
+    io_uring_add_recv,
+};
+
+struct io_uring_recv_s {
+    uint16_t bgid;
+
+    struct io_uring_buf_ring *ring;
+    size_t ring_size;
+    uint16_t tail;
+
+    /* Buffer currently provided to the kernel under each buffer ID */
+    ogs_pkbuf_t *pkbuf[IO_URING_RECV_BUFFERS];
+
+    struct msghdr msg;
+    unsigned int payload_offset;
+
+    bool received;
+};
+
+struct io_uring_map_s {
+    ogs_poll_t *read;
+    ogs_poll_t *write;
+
+    struct io_uring_recv_s *recv;
+
+    bool armed;
+    uint64_t user_data;
+};
+
+struct io_uring_context_s {
+    int ring_fd;
+
+    struct {
+        void *ptr;
+        size_t size;
+
+        unsigned *head;
+        unsigned *tail;
+        unsigned *ring_mask;
+        unsigned *array;
+
+        struct io_uring_sqe *sqes;
+        size_t sqes_size;
+
+        unsigned pending;
+    } sq;
+
+    struct {
+        void *ptr;
+        size_t size;
+
+        unsigned *head;
+        unsigned *tail;
+        unsigned *ring_mask;
+
+        struct io_uring_cqe *cqes;
+    } cq;
+
+    uint32_t seq;
+    uint16_t bgid;
+
+    ogs_hash_t *map_hash;
+};
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit,
+        unsigned min_complete, unsigned flags, void *arg, size_t argsz)
+{
+    return (int)syscall(__NR_io_uring_enter,
+            fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+static int sys_io_uring_register(int fd, unsigned opcode,
+        void *arg, unsigned nr_args)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static int ring_setup(unsigned entries, struct io_uring_params *p)
+{
+    int fd;
+
+    memset(p, 0, sizeof(*p));
+    p->flags = IORING_SETUP_CQSIZE;
+    p->cq_entries = entries * 2;
+
+    fd = sys_io_uring_setup(entries, p);
+    if (fd < 0)
+        return fd;
+
+    /*
+     * Timed waits are done with IORING_ENTER_EXT_ARG and
+     * completions must never be dropped on CQ overflow.
+     */
+    if (!(p->features & IORING_FEAT_EXT_ARG) ||
+        !(p->features & IORING_FEAT_NODROP)) {
+        close(fd);
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    return fd;
+}
+
+bool ogs_io_uring_is_supported(void)
+{
+    struct io_uring_params p;
+    int fd;
+
+    fd = ring_setup(1, &p);
+    if (fd < 0) {
+        ogs_log_message(OGS_LOG_WARN, ogs_errno,
+                "io_uring is not available, fallback to epoll");
+        return false;
+    }
+
+    close(fd);
+    return true;
+}
+
+static unsigned ring_entries(unsigned int capacity)
+{
+    unsigned entries = 1;
+
+    while (entries < capacity && entries < IO_URING_MAX_ENTRIES)
+        entries <<= 1;
+
+    return entries;
+}
+
+static void io_uring_init(ogs_pollset_t *pollset)
+{
+    struct io_uring_context_s *context = NULL;
+    struct io_uring_params p;
+    void *ptr = NULL;
+    ogs_assert(pollset);
+
+    context = ogs_calloc(1, sizeof *context);
+    ogs_assert(context);
+    pollset->context = context;
+
+    context->map_hash = ogs_hash_make();
+    ogs_assert(context->map_hash);
+
+    context->ring_fd = ring_setup(ring_entries(pollset->capacity), &p);
+    if (context->ring_fd < 0) {
+        ogs_log_message(OGS_LOG_FATAL, ogs_errno,
+                "io_uring_setup() failed [%d]", pollset->capacity);
+        ogs_assert_if_reached();
+        return;
+    }
+
+    context->sq.size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    context->cq.size =
+        p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (context->cq.size > context->sq.size)
+            context->sq.size = context->cq.size;
+        context->cq.size = context->sq.size;
+    }
+
+    ptr = mmap(NULL, context->sq.size, PROT_READ|PROT_WRITE,
+            MAP_SHARED|MAP_POPULATE, context->ring_fd, IORING_OFF_SQ_RING);
+    ogs_assert(ptr != MAP_FAILED);
+    context->sq.ptr = ptr;
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        context->cq.ptr = context->sq.ptr;
+    } else {
+        ptr = mmap(NULL, context->cq.size, PROT_READ|PROT_WRITE,
+                MAP_SHARED|MAP_POPULATE, context->ring_fd, IORING_OFF_CQ_RING);
+        ogs_assert(ptr != MAP_FAILED);
+        context->cq.ptr = ptr;
+    }
+
+    context->sq.sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    ptr = mmap(NULL, context->sq.sqes_size, PROT_READ|PROT_WRITE,
+            MAP_SHARED|MAP_POPULATE, context->ring_fd, IORING_OFF_SQES);
+    ogs_assert(ptr != MAP_FAILED);
+    context->sq.sqes = ptr;
+
+    context->sq.head = (unsigned *)((char *)context->sq.ptr + p.sq_off.head);
+    context->sq.tail = (unsigned *)((char *)context->sq.ptr + p.sq_off.tail);
+    context->sq.ring_mask =
+        (unsigned *)((char *)context->sq.ptr + p.sq_off.ring_mask);
+    context->sq.array =
+        (unsigned *)((char *)context->sq.ptr + p.sq_off.array);
+
+    context->cq.head = (unsigned *)((char *)context->cq.ptr + p.cq_off.head);
+    context->cq.tail = (unsigned *)((char *)context->cq.ptr + p.cq_off.tail);
+    context->cq.ring_mask =
+        (unsigned *)((char *)context->cq.ptr + p.cq_off.ring_mask);
+    context->cq.cqes = (struct io_uring_cqe *)
+        ((char *)context->cq.ptr + p.cq_off.cqes);
+
+    ogs_notify_init(pollset);
+}
+
+static void io_uring_cleanup(ogs_pollset_t *pollset)
+{
+    struct io_uring_context_s *context = NULL;
+
+    ogs_assert(pollset);
+    context = pollset->context;
+    ogs_assert(context);
+
+    ogs_notify_final(pollset);
+
+    munmap(context->sq.sqes, context->sq.sqes_size);
+    if (context->cq.ptr != context->sq.ptr)
+        munmap(context->cq.ptr, context->cq.size);
+    munmap(context->sq.ptr, context->sq.size);
+    close(context->ring_fd);
+
+    ogs_hash_destroy(context->map_hash);
+
+    ogs_free(context);
+}
+
+static int submit(struct io_uring_context_s *context,
+        unsigned min_complete, unsigned flags, void *arg, size_t argsz)
+{
+    int rv;
+    unsigned to_submit = context->sq.pending;
+
+    context->sq.pending = 0;
+
+    rv = sys_io_uring_enter(context->ring_fd,
+            to_submit, min_complete, flags, arg, argsz);
+    if (rv < 0) {
+        /*
+         * Nothing was consumed (EBUSY, EINTR, ETIME, ...), so the entries
+         * stay queued for the next call.
+         */
+        context->sq.pending = to_submit;
+    } else if ((unsigned)rv < to_submit) {
+        context->sq.pending = to_submit - rv;
+    }
+
+    return rv;
+}
+
+static struct io_uring_sqe *get_sqe(struct io_uring_context_s *context)
+{
+    struct io_uring_sqe *sqe = NULL;
+    unsigned head, tail, index;
+
+    ogs_assert(context);
+
+    tail = *context->sq.tail;
+    head = __atomic_load_n(context->sq.head, __ATOMIC_ACQUIRE);
+
+    if (tail - head > *context->sq.ring_mask) {
+        /* Submission ring is full, hand it over to the kernel now */
+        if (submit(context, 0, 0, NULL, 0) < 0) {
+            ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                    "io_uring_enter() failed");
+            return NULL;
+        }
+        head = __atomic_load_n(context->sq.head, __ATOMIC_ACQUIRE);
+        if (tail - head > *context->sq.ring_mask) {
+            ogs_error("io_uring submission ring is full");
+            return NULL;
+        }
+    }
+
+    index = tail & *context->sq.ring_mask;
+    sqe = &context->sq.sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+
+    context->sq.array[index] = index;
+    __atomic_store_n(context->sq.tail, tail + 1, __ATOMIC_RELEASE);
+    context->sq.pending++;
+
+    return sqe;
+}
+
+static int disarm(struct io_uring_context_s *context,
+        struct io_uring_map_s *map)
+{
+    struct io_uring_sqe *sqe = NULL;
+
+    ogs_assert(context);
+    ogs_assert(map);
+
+    if (map->armed == false)
+        return OGS_OK;
+
+    sqe = get_sqe(context);
+    if (!sqe)
+        return OGS_ERROR;
+
+    /* POLL_REMOVE only finds polls, the multishot recvmsg is cancelled */
+    sqe->opcode = map->recv ? IORING_OP_ASYNC_CANCEL : IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = map->user_data;
+    sqe->user_data = IO_URING_IGNORE_DATA;
+
+    map->armed = false;
+
+    return OGS_OK;
+}
+
+static int arm(struct io_uring_context_s *context,
+        struct io_uring_map_s *map, ogs_socket_t fd)
+{
+    struct io_uring_sqe *sqe = NULL;
+    uint32_t events = 0;
+
+    ogs_assert(context);
+    ogs_assert(map);
+
+    if (map->read)
+        events |= (POLLIN|POLLRDHUP);
+    if (map->write)
+        events |= POLLOUT;
+
+    if (!events)
+        return OGS_OK;
+
+    sqe = get_sqe(context);
+    if (!sqe)
+        return OGS_ERROR;
+
+    if (++context->seq == 0)
+        ++context->seq;
+
+#if __BYTE_ORDER == __BIG_ENDIAN
+    events = (events << 16) | (events >> 16);
+#endif
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = events;
+    sqe->user_data = ((uint64_t)context->seq << 32) | (uint32_t)fd;
+
+    map->user_data = sqe->user_data;
+    map->armed = true;
+
+    return OGS_OK;
+}
+
+#if defined(IORING_RECV_MULTISHOT)
+static bool recv_provide(struct io_uring_recv_s *recv,
+        ogs_poll_t *poll, uint16_t bid, ogs_pkbuf_t *pkbuf)
+{
+    struct io_uring_buf *buf = NULL;
+
+    ogs_assert(recv);
+    ogs_assert(poll);
+
+    if (!pkbuf) {
+        pkbuf = ogs_pkbuf_alloc(poll->recv.pool, poll->recv.size);
+        if (!pkbuf)
+            return false;
+        ogs_pkbuf_reserve(pkbuf, poll->recv.headroom);
+    }
+
+    buf = &recv->ring->bufs[recv->tail & (IO_URING_RECV_BUFFERS - 1)];
+    buf->addr = (uint64_t)(uintptr_t)pkbuf->data;
+    buf->len = ogs_pkbuf_tailroom(pkbuf);
+    buf->bid = bid;
+
+    recv->pkbuf[bid] = pkbuf;
+    recv->tail++;
+
+    __atomic_store_n(&recv->ring->tail, recv->tail, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+static void recv_destroy(struct io_uring_context_s *context,
+        struct io_uring_recv_s *recv)
+{
+    struct io_uring_buf_reg reg;
+    int i;
+
+    ogs_assert(context);
+    ogs_assert(recv);
+
+    if (recv->ring) {
+        /* Let the kernel process a pending cancel before the ring goes */
+        if (context->sq.pending && submit(context, 0, 0, NULL, 0) < 0)
+            ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                    "io_uring_enter() failed");
+
+        memset(&reg, 0, sizeof(reg));
+        reg.bgid = recv->bgid;
+        if (sys_io_uring_register(context->ring_fd,
+                IORING_UNREGISTER_PBUF_RING, &reg, 1) < 0)
+            ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                    "IORING_UNREGISTER_PBUF_RING failed");
+
+        munmap(recv->ring, recv->ring_size);
+    }
+
+    for (i = 0; i < IO_URING_RECV_BUFFERS; i++)
+        if (recv->pkbuf[i])
+            ogs_pkbuf_free(recv->pkbuf[i]);
+
+    ogs_free(recv);
+}
+
+static struct io_uring_recv_s *recv_create(
+        struct io_uring_context_s *context, ogs_poll_t *poll)
+{
+    struct io_uring_recv_s *recv = NULL;
+    struct io_uring_buf_reg reg;
+    void *ptr = NULL;
+    int i;
+
+    ogs_assert(context);
+    ogs_assert(poll);
+
+    recv = ogs_calloc(1, sizeof(*recv));
+    if (!recv) {
+        ogs_error("ogs_calloc() failed");
+        return NULL;
+    }
+
+    /* Each buffer holds io_uring_recvmsg_out, the source address, data */
+    recv->msg.msg_namelen = sizeof(struct sockaddr_in6);
+    recv->payload_offset =
+        sizeof(struct io_uring_recvmsg_out) + recv->msg.msg_namelen;
+    if (poll->recv.size - poll->recv.headroom <= recv->payload_offset) {
+        ogs_error("Receive buffer too small [%d:%d]",
+                poll->recv.size, poll->recv.headroom);
+        recv_destroy(context, recv);
+        return NULL;
+    }
+
+    recv->ring_size = IO_URING_RECV_BUFFERS * sizeof(struct io_uring_buf);
+    ptr = mmap(NULL, recv->ring_size, PROT_READ|PROT_WRITE,
+            MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno, "mmap() failed");
+        recv_destroy(context, recv);
+        return NULL;
+    }
+    recv->ring = ptr;
+
+    recv->bgid = context->bgid++;
+
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)recv->ring;
+    reg.ring_entries = IO_URING_RECV_BUFFERS;
+    reg.bgid = recv->bgid;
+    if (sys_io_uring_register(context->ring_fd,
+            IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        ogs_log_message(OGS_LOG_WARN, ogs_errno,
+                "IORING_REGISTER_PBUF_RING failed, fallback to poll");
+        munmap(recv->ring, recv->ring_size);
+        recv->ring = NULL;
+        recv_destroy(context, recv);
+        return NULL;
+    }
+
+    for (i = 0; i < IO_URING_RECV_BUFFERS; i++) {
+        if (recv_provide(recv, poll, i, NULL) == false) {
+            ogs_error("ogs_pkbuf_alloc() failed");
+            recv_destroy(context, recv);
+            return NULL;
+        }
+    }
+
+    return recv;
+}
+
+static int arm_recv(struct io_uring_context_s *context,
+        struct io_uring_map_s *map, ogs_socket_t fd)
+{
+    struct io_uring_sqe *sqe = NULL;
+
+    ogs_assert(context);
+    ogs_assert(map);
+    ogs_assert(map->recv);
+
+    sqe = get_sqe(context);
+    if (!sqe)
+        return OGS_ERROR;
+
+    if (++context->seq == 0)
+        ++context->seq;
+
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)&map->recv->msg;
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = map->recv->bgid;
+    sqe->user_data = ((uint64_t)context->seq << 32) | (uint32_t)fd;
+
+    map->user_data = sqe->user_data;
+    map->armed = true;
+
+    return OGS_OK;
+}
+#endif
+
+static int io_uring_add_recv(ogs_poll_t *poll)
+{
+#if defined(IORING_RECV_MULTISHOT)
+    ogs_pollset_t *pollset = NULL;
+    struct io_uring_context_s *context = NULL;
+    struct io_uring_map_s *map = NULL;
+
+    ogs_assert(poll);
+    pollset = poll->pollset;
+    ogs_assert(pollset);
+    context = pollset->context;
+    ogs_assert(context);
+
+    /* The socket must not be polled for anything else */
+    ogs_assert(!ogs_hash_get(context->map_hash, &poll->fd, sizeof(poll->fd)));
+
+    map = ogs_calloc(1, sizeof(*map));
+    if (!map) {
+        ogs_error("ogs_calloc() failed");
+        return OGS_ERROR;
+    }
+
+    map->recv = recv_create(context, poll);
+    if (!map->recv) {
+        ogs_free(map);
+        return OGS_ERROR;
+    }
+    map->read = poll;
+
+    if (arm_recv(context, map, poll->fd) != OGS_OK) {
+        ogs_error("io_uring_add_recv() failed");
+        recv_destroy(context, map->recv);
+        ogs_free(map);
+        return OGS_ERROR;
+    }
+
+    ogs_hash_set(context->map_hash, &poll->fd, sizeof(poll->fd), map);
+
+    return OGS_OK;
+#else
+    return OGS_ERROR;
+#endif
+}
+
+static int io_uring_add(ogs_poll_t *poll)
+{
+    ogs_pollset_t *pollset = NULL;
+    struct io_uring_context_s *context = NULL;
+    struct io_uring_map_s *map = NULL;
+
+    ogs_assert(poll);
+    pollset = poll->pollset;
+    ogs_assert(pollset);
+    context = pollset->context;
+    ogs_assert(context);
+
+    map = ogs_hash_get(context->map_hash, &poll->fd, sizeof(poll->fd));
+    if (!map) {
+        map = ogs_calloc(1, sizeof(*map));
+        if (!map) {
+            ogs_error("ogs_calloc() failed");
+            return OGS_ERROR;
+        }
+
+        ogs_hash_set(context->map_hash, &poll->fd, sizeof(poll->fd), map);
+    }
+
+    if (poll->when & OGS_POLLIN)
+        map->read = poll;
+    if (poll->when & OGS_POLLOUT)
+        map->write = poll;
+
+    if (disarm(context, map) != OGS_OK ||
+        arm(context, map, poll->fd) != OGS_OK) {
+        ogs_error("io_uring_add() failed");
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
+static int io_uring_remove(ogs_poll_t *poll)
+{
+    int rv;
+    ogs_pollset_t *pollset = NULL;
+    struct io_uring_context_s *context = NULL;
+    struct io_uring_map_s *map = NULL;
+
+    ogs_assert(poll);
+    pollset = poll->pollset;
+    ogs_assert(pollset);
+    context = pollset->context;
+    ogs_assert(context);
+
+    map = ogs_hash_get(context->map_hash, &poll->fd, sizeof(poll->fd));
+    ogs_assert(map);
+
+#if defined(IORING_RECV_MULTISHOT)
+    if (map->recv) {
+        rv = disarm(context, map);
+
+        recv_destroy(context, map->recv);
+        ogs_hash_set(context->map_hash, &poll->fd, sizeof(poll->fd), NULL);
+        ogs_free(map);
+
+        if (rv != OGS_OK) {
+            ogs_error("io_uring_remove() failed");
+            return OGS_ERROR;
+        }
+
+        return OGS_OK;
+    }
+#endif
+
+    if (poll->when & OGS_POLLIN)
+        map->read = NULL;
+    if (poll->when & OGS_POLLOUT)
+        map->write = NULL;
+
+    rv = disarm(context, map);
+
+    if (map->read || map->write) {
+        if (rv == OGS_OK)
+            rv = arm(context, map, poll->fd);
+    } else {
+        ogs_hash_set(context->map_hash, &poll->fd, sizeof(poll->fd), NULL);
+        ogs_free(map);
+    }
+
+    if (rv != OGS_OK) {
+        ogs_error("io_uring_remove() failed");
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
+#if defined(IORING_RECV_MULTISHOT)
+static bool dispatch_recv(ogs_pollset_t *pollset,
+        struct io_uring_map_s *map, ogs_socket_t fd, int res, uint32_t flags)
+{
+    struct io_uring_context_s *context = NULL;
+    struct io_uring_recv_s *recv = NULL;
+    struct io_uring_recvmsg_out *out = NULL;
+    ogs_poll_t *poll = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+    ogs_sockaddr_t from;
+    uint16_t bid;
+
+    ogs_assert(pollset);
+    context = pollset->context;
+    ogs_assert(context);
+    ogs_assert(map);
+    recv = map->recv;
+    ogs_assert(recv);
+    poll = map->read;
+    ogs_assert(poll);
+
+    /* The kernel stops a multishot request on error or when out of buffers */
+    if (!(flags & IORING_CQE_F_MORE))
+        map->armed = false;
+
+    if (res < 0) {
+        if (res == -EINVAL && recv->received == false) {
+            /* Multishot recvmsg is not supported, fall back to poll */
+            ogs_warn("Multishot recvmsg is not available, fallback to poll");
+            recv_destroy(context, recv);
+            map->recv = NULL;
+            map->armed = false;
+            arm(context, map, fd);
+            return false;
+        }
+        if (res != -ENOBUFS)
+            ogs_log_message(OGS_LOG_ERROR, -res, "io_uring recvmsg failed");
+        if (map->armed == false)
+            arm_recv(context, map, fd);
+        return false;
+    }
+
+    ogs_assert(flags & IORING_CQE_F_BUFFER);
+    bid = flags >> IORING_CQE_BUFFER_SHIFT;
+    ogs_assert(bid < IO_URING_RECV_BUFFERS);
+    pkbuf = recv->pkbuf[bid];
+    ogs_assert(pkbuf);
+
+    recv->received = true;
+
+    out = (struct io_uring_recvmsg_out *)pkbuf->data;
+    if (out->flags & MSG_TRUNC) {
+        ogs_error("[DROP] Datagram truncated [%d]", out->payloadlen);
+        recv_provide(recv, poll, bid, pkbuf);
+        pkbuf = NULL;
+    } else if (recv_provide(recv, poll, bid, NULL) == false) {
+        ogs_error("[DROP] ogs_pkbuf_alloc() failed");
+        recv_provide(recv, poll, bid, pkbuf);
+        pkbuf = NULL;
+    }
+
+    /* The handler may remove the poll, so re-arm before calling it */
+    if (map->armed == false)
+        arm_recv(context, map, fd);
+
+    if (!pkbuf)
+        return false;
+
+    memset(&from, 0, sizeof(from));
+    memcpy(&from.sa, out + 1,
+            ogs_min(out->namelen, recv->msg.msg_namelen));
+
+    ogs_pkbuf_put(pkbuf, recv->payload_offset + out->payloadlen);
+    ogs_pkbuf_pull(pkbuf, recv->payload_offset);
+
+    ogs_poll_dispatch_recv(poll, pkbuf, &from);
+
+    return true;
+}
+#endif
+
+static bool dispatch(ogs_pollset_t *pollset,
+        uint64_t user_data, int res, uint32_t flags)
+{
+    struct io_uring_context_s *context = NULL;
+    struct io_uring_map_s *map = NULL;
+    short when = 0;
+    ogs_socket_t fd;
+
+    ogs_assert(pollset);
+    context = pollset->context;
+    ogs_assert(context);
+
+    if (user_data == IO_URING_IGNORE_DATA)
+        return false;
+
+    fd = (ogs_socket_t)(uint32_t)user_data;
+
+    map = ogs_hash_get(context->map_hash, &fd, sizeof(fd));
+    if (!map || !map->armed || map->user_data != user_data)
+        return false; /* stale completion */
+
+#if defined(IORING_RECV_MULTISHOT)
+    if (map->recv)
+        return dispatch_recv(pollset, map, fd, res, flags);
+#endif
+
+    /* One-shot poll has been consumed */
+    map->armed = false;
+
+    if (res < 0) {
+        ogs_log_message(OGS_LOG_ERROR, -res, "io_uring poll failed");
+        arm(context, map, fd);
+        return false;
+    }
+
+    /* See epoll_process() for the POLLERR/POLLHUP handling */
+    if (res & POLLERR) {
+        when = OGS_POLLIN;
+    } else if ((res & POLLHUP) && !(res & POLLRDHUP)) {
+        when = OGS_POLLIN|OGS_POLLOUT;
+    } else {
+        if (res & POLLIN) {
+            when |= OGS_POLLIN;
+        }
+        if (res & POLLOUT) {
+            when |= OGS_POLLOUT;
+        }
+        if (res & POLLRDHUP) {
+            when |= OGS_POLLIN;
+            when &= ~OGS_POLLOUT;
+        }
+    }
+
+    if (when) {
+        if (map->read && map->write && map->read == map->write) {
+            ogs_poll_dispatch(map->read, when);
+        } else {
+            if ((when & OGS_POLLIN) && map->read)
+                ogs_poll_dispatch(map->read, when);
+
+            /*
+             * map->read->handler() can call ogs_pollset_remove()
+             * So, we need to check map instance
+             */
+            map = ogs_hash_get(context->map_hash, &fd, sizeof(fd));
+            if (!map) return true;
+
+            if ((when & OGS_POLLOUT) && map->write)
+                ogs_poll_dispatch(map->write, when);
+        }
+    }
+
+    /* The handler may have removed or already re-armed the fd */
+    map = ogs_hash_get(context->map_hash, &fd, sizeof(fd));
+    if (map && map->armed == false)
+        arm(context, map, fd);
+
+    return true;
+}
+
+static int io_uring_process(ogs_pollset_t *pollset, ogs_time_t timeout)
+{
+    struct io_uring_context_s *context = NULL;
+    struct io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    unsigned head, tail;
+    int rv, num_of_poll = 0;
+
+    ogs_assert(pollset);
+    context = pollset->context;
+    ogs_assert(context);
+
+    memset(&arg, 0, sizeof(arg));
+    if (timeout != OGS_INFINITE_TIME) {
+        ts.tv_sec = ogs_time_sec(timeout);
+        ts.tv_nsec = ogs_time_usec(timeout) * 1000;
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+    }
+
+    head = *context->cq.head;
+    tail = __atomic_load_n(context->cq.tail, __ATOMIC_ACQUIRE);
+
+    rv = submit(context, head == tail ? 1 : 0,
+            IORING_ENTER_GETEVENTS|IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    if (rv < 0 && errno != ETIME && errno != EBUSY && errno != EINTR) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno, "io_uring_enter() failed");
+        return OGS_ERROR;
+    }
+
+    tail = __atomic_load_n(context->cq.tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        struct io_uring_cqe *cqe =
+            &context->cq.cqes[head & *context->cq.ring_mask];
+        uint64_t user_data = cqe->user_data;
+        int res = cqe->res;
+        uint32_t flags = cqe->flags;
+
+        __atomic_store_n(context->cq.head, ++head, __ATOMIC_RELEASE);
+
+        if (dispatch(pollset, user_data, res, flags) == true)
+            num_of_poll++;
+
+        tail = __atomic_load_n(context->cq.tail, __ATOMIC_ACQUIRE);
+    }
+
+    if (num_of_poll == 0)
+        return OGS_TIMEUP;
+
+    return OGS_OK;
+}
@@ -47,6 +47,8 @@ const ogs_pollset_actions_t ogs_kqueue_actions = {
     kqueue_process,
 
     kqueue_notify_pollset,
+
+    NULL, /* add_recv */
 };
 
 struct kqueue_context_s {
@@ -302,7 +304,7 @@ static int kqueue_process(ogs_pollset_t *pollset, ogs_time_t timeout)
         ogs_assert(poll);
 
         if (poll->handler) {
-            poll->handler(when, poll->fd, poll->data);
+            ogs_poll_dispatch(poll, when);
         }
     }
     
@@ -95,11 +95,89 @@ static OGS_LIST(log_list);
 static OGS_POOL(domain_pool, ogs_log_domain_t);
 static OGS_LIST(domain_list);
 
+#if defined(_WIN32)
+#define OGS_LOG_THREAD_LOCAL __declspec(thread)
+#else
+#define OGS_LOG_THREAD_LOCAL __thread
+#endif
+
+/*
+ * Record in a ring buffer, followed by the NUL-terminated content.
+ * A record with OGS_LOG_NONE level pads the end of the ring.
+ */
+typedef struct log_record_s {
+    uint32_t size;
+    uint8_t level;
+    uint8_t content_only;
+    uint16_t domain_id;
+    int line;
+    int err;
+    ogs_time_t time;
+    const char *file;
+    const char *func;
+} log_record_t;
+
+#define LOG_RECORD_ALIGN(__sIZE) (((__sIZE) + 7) & ~((size_t)7))
+
+/* Single producer (the owning thread), single consumer (the writer) */
+typedef struct log_ring_s {
+    ogs_lnode_t node;
+
+    unsigned int generation;
+
+    uint8_t *buf;
+    uint64_t size;
+    uint64_t head;
+    uint64_t tail;
+
+    uint64_t dropped;
+    uint64_t overflow;
+
+    bool exited;            /* The owning thread is gone */
+} log_ring_t;
+
+static struct {
+    bool running;
+    bool stopping;
+    unsigned int generation;
+
+    uint64_t size;
+    ogs_log_level_e drop_level;
+
+    ogs_thread_t *thread;
+
+    /*
+     * Whoever holds the mutex consumes the rings:
+     * the writer thread, or a thread that needs a synchronous write.
+     */
+    ogs_thread_mutex_t mutex;
+    ogs_thread_cond_t cond;
+    bool sleeping;
+
+    ogs_list_t ring_list;
+#if !defined(_WIN32)
+    pthread_key_t ring_key;
+#endif
+
+    uint64_t written;
+    uint64_t dropped;       /* From the rings already freed */
+    uint64_t overflow;
+    uint64_t reported_dropped;
+} async;
+
+static OGS_LOG_THREAD_LOCAL log_ring_t *thread_ring;
+static OGS_LOG_THREAD_LOCAL unsigned int thread_ring_generation;
+static OGS_LOG_THREAD_LOCAL bool thread_in_writer;
+
 static ogs_log_t *add_log(ogs_log_type_e type);
 static int file_cycle(ogs_log_t *log);
 
+static void log_output(ogs_log_level_e level, ogs_log_domain_t *domain,
+        ogs_err_t err, const char *file, int line, const char *func,
+        int content_only, ogs_time_t time, const char *content);
+
 static char *log_timestamp(char *buf, char *last,
-        int use_color);
+        ogs_time_t time, int use_color);
 static char *log_domain(char *buf, char *last,
         const char *name, int use_color);
 static char *log_content(char *buf, char *last,
@@ -125,6 +203,8 @@ void ogs_log_final(void)
     ogs_log_t *log, *saved_log;
     ogs_log_domain_t *domain, *saved_domain;
 
+    ogs_log_async_stop();
+
     ogs_list_for_each_safe(&log_list, saved_log, log)
         ogs_log_remove(log);
     ogs_pool_final(&log_pool);
@@ -137,6 +217,10 @@ void ogs_log_final(void)
 void ogs_log_cycle(void)
 {
     ogs_log_t *log = NULL;
+    bool running = async.running;
+
+    if (running)
+        ogs_thread_mutex_lock(&async.mutex);
 
     ogs_list_for_each(&log_list, log) {
         switch(log->type) {
@@ -146,6 +230,9 @@ void ogs_log_cycle(void)
             break;
         }
     }
+
+    if (running)
+        ogs_thread_mutex_unlock(&async.mutex);
 }
 
 ogs_log_t *ogs_log_add_stderr(void)
@@ -398,40 +485,493 @@ int ogs_log_config_domain(const char *domain, const char *level)
     return OGS_OK;
 }
 
+static ogs_log_domain_t *find_domain(int id, const char *file, int line)
+{
+    ogs_log_domain_t *domain = NULL;
+
+    domain = ogs_pool_find(&domain_pool, id);
+    if (!domain) {
+        fprintf(stderr, "No LogDomain[id:%d] in %s:%d", id, file, line);
+        ogs_assert_if_reached();
+    }
+
+    return domain;
+}
+
+static log_ring_t *ring_get(void)
+{
+    log_ring_t *ring = NULL;
+
+    if (thread_ring && thread_ring_generation == async.generation)
+        return thread_ring;
+
+    /* Not ogs_calloc(), which may log on its own */
+    ring = calloc(1, sizeof(*ring));
+    if (!ring)
+        return NULL;
+
+    ring->buf = malloc(async.size);
+    if (!ring->buf) {
+        free(ring);
+        return NULL;
+    }
+    ring->size = async.size;
+    ring->generation = async.generation;
+
+    ogs_thread_mutex_lock(&async.mutex);
+    ogs_list_add(&async.ring_list, ring);
+    ogs_thread_mutex_unlock(&async.mutex);
+
+#if !defined(_WIN32)
+    /* ring_exit() hands the ring back when this thread exits */
+    pthread_setspecific(async.ring_key, ring);
+#endif
+
+    thread_ring = ring;
+    thread_ring_generation = ring->generation;
+
+    return ring;
+}
+
+#if !defined(_WIN32)
+static void ring_exit(void *data)
+{
+    log_ring_t *ring = data;
+
+    ogs_assert(ring);
+
+    /* The writer frees the ring once it has drained it */
+    ogs_thread_mutex_lock(&async.mutex);
+    ring->exited = true;
+    ogs_thread_mutex_unlock(&async.mutex);
+}
+#endif
+
+static bool ring_push(log_ring_t *ring, log_record_t *record,
+        const char *content, size_t len)
+{
+    uint64_t head, tail, offset, room, need;
+
+    ogs_assert(ring);
+    ogs_assert(record);
+
+    need = LOG_RECORD_ALIGN(sizeof(*record) + len + 1);
+
+    head = ring->head;
+    tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    offset = head & (ring->size - 1);
+    room = ring->size - offset;
+
+    if ((need > room ? room + need : need) > ring->size - (head - tail))
+        return false;
+
+    if (need > room) {
+        log_record_t *pad = (log_record_t *)(ring->buf + offset);
+        pad->size = room;
+        pad->level = OGS_LOG_NONE;
+        head += room;
+        offset = 0;
+    }
+
+    record->size = need;
+    memcpy(ring->buf + offset, record, sizeof(*record));
+    memcpy(ring->buf + offset + sizeof(*record), content, len);
+    ring->buf[offset + sizeof(*record) + len] = 0;
+
+    __atomic_store_n(&ring->head, head + need, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+static log_record_t *ring_peek(log_ring_t *ring)
+{
+    uint64_t head;
+    log_record_t *record = NULL;
+
+    ogs_assert(ring);
+
+    head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    while (ring->tail != head) {
+        record = (log_record_t *)(ring->buf + (ring->tail & (ring->size - 1)));
+        if (record->level != OGS_LOG_NONE)
+            return record;
+
+        __atomic_store_n(&ring->tail,
+                ring->tail + record->size, __ATOMIC_RELEASE);
+    }
+
+    return NULL;
+}
+
+static void flush_all(void)
+{
+    ogs_log_t *log = NULL;
+
+    ogs_list_for_each(&log_list, log) {
+        if (log->file.out)
+            fflush(log->file.out);
+    }
+    fflush(stderr);
+}
+
+/* Called with async.mutex held */
+static void async_drain(void)
+{
+    log_ring_t *ring = NULL, *next_ring = NULL;
+    uint64_t written = async.written, dropped = 0;
+
+    thread_in_writer = true;
+
+    while (1) {
+        log_ring_t *oldest = NULL;
+        log_record_t *record = NULL, *oldest_record = NULL;
+
+        /* Merge the rings in timestamp order */
+        ogs_list_for_each(&async.ring_list, ring) {
+            record = ring_peek(ring);
+            if (record &&
+                (!oldest_record || record->time < oldest_record->time)) {
+                oldest = ring;
+                oldest_record = record;
+            }
+        }
+
+        if (!oldest)
+            break;
+
+        log_output(oldest_record->level,
+                ogs_pool_find(&domain_pool, oldest_record->domain_id),
+                oldest_record->err,
+                oldest_record->file, oldest_record->line,
+                oldest_record->func, oldest_record->content_only,
+                oldest_record->time, (const char *)(oldest_record + 1));
+        async.written++;
+
+        __atomic_store_n(&oldest->tail,
+                oldest->tail + oldest_record->size, __ATOMIC_RELEASE);
+    }
+
+    /* Free the rings of the threads that have exited */
+    ogs_list_for_each_safe(&async.ring_list, next_ring, ring) {
+        if (!ring->exited || ring_peek(ring))
+            continue;
+
+        async.dropped += ring->dropped;
+        async.overflow += ring->overflow;
+
+        ogs_list_remove(&async.ring_list, ring);
+        free(ring->buf);
+        free(ring);
+    }
+
+    dropped = async.dropped;
+    ogs_list_for_each(&async.ring_list, ring)
+        dropped += __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+
+    if (dropped != async.reported_dropped) {
+        char content[64];
+
+        ogs_snprintf(content, sizeof(content),
+                "%lld log records dropped",
+                (long long)(dropped - async.reported_dropped));
+        log_output(OGS_LOG_WARN, NULL, 0, __FILE__, __LINE__, OGS_FUNC,
+                0, ogs_time_now(), content);
+        async.reported_dropped = dropped;
+        async.written++;
+    }
+
+    if (async.written != written)
+        flush_all();
+
+    thread_in_writer = false;
+}
+
+static void async_main(void *data)
+{
+    ogs_thread_mutex_lock(&async.mutex);
+
+    while (1) {
+        async_drain();
+
+        if (async.stopping)
+            break;
+
+        __atomic_store_n(&async.sleeping, true, __ATOMIC_RELAXED);
+        ogs_thread_cond_timedwait(&async.cond, &async.mutex,
+                ogs_time_from_msec(100));
+        __atomic_store_n(&async.sleeping, false, __ATOMIC_RELAXED);
+    }
+
+    ogs_thread_mutex_unlock(&async.mutex);
+}
+
+static void async_write_sync(ogs_log_level_e level, ogs_log_domain_t *domain,
+        ogs_err_t err, const char *file, int line, const char *func,
+        int content_only, ogs_time_t time, const char *content)
+{
+    if (thread_in_writer) {
+        log_output(level, domain,
+                err, file, line, func, content_only, time, content);
+        return;
+    }
+
+    ogs_thread_mutex_lock(&async.mutex);
+
+    /* Keep the order of the pending records */
+    async_drain();
+
+    thread_in_writer = true;
+    log_output(level, domain,
+            err, file, line, func, content_only, time, content);
+    flush_all();
+    thread_in_writer = false;
+
+    ogs_thread_mutex_unlock(&async.mutex);
+}
+
+int ogs_log_async_start(size_t size, ogs_log_level_e drop_level)
+{
+    uint64_t ring_size = 4096;
+
+    if (async.running) {
+        ogs_warn("Asynchronous logging already running");
+        return OGS_OK;
+    }
+
+    if (!size)
+        size = OGS_LOG_ASYNC_DEFAULT_SIZE;
+
+    /* Round up to a power of two that can hold the largest record */
+    while (ring_size < size ||
+            ring_size < 2 * (sizeof(log_record_t) + OGS_HUGE_LEN))
+        ring_size <<= 1;
+
+    async.size = ring_size;
+    async.drop_level = drop_level;
+    async.generation++;
+    async.stopping = false;
+    async.written = 0;
+    async.dropped = 0;
+    async.overflow = 0;
+    async.reported_dropped = 0;
+    ogs_list_init(&async.ring_list);
+
+    ogs_thread_mutex_init(&async.mutex);
+    ogs_thread_cond_init(&async.cond);
+
+#if !defined(_WIN32)
+    if (pthread_key_create(&async.ring_key, ring_exit) != 0) {
+        ogs_error("pthread_key_create() failed");
+        ogs_thread_cond_destroy(&async.cond);
+        ogs_thread_mutex_destroy(&async.mutex);
+        return OGS_ERROR;
+    }
+#endif
+
+    async.thread = ogs_thread_create(async_main, NULL);
+    if (!async.thread) {
+        ogs_error("ogs_thread_create() failed");
+#if !defined(_WIN32)
+        pthread_key_delete(async.ring_key);
+#endif
+        ogs_thread_cond_destroy(&async.cond);
+        ogs_thread_mutex_destroy(&async.mutex);
+        return OGS_ERROR;
+    }
+
+    ogs_info("Asynchronous logging [%lld bytes per thread, drop:%s]",
+            (long long)async.size, level_strings[drop_level] ?
+                level_strings[drop_level] : "NONE");
+
+    async.running = true;
+
+    return OGS_OK;
+}
+
+/*
+ * Must be called once no other thread is logging,
+ * since the per-thread rings are freed here.
+ */
+void ogs_log_async_stop(void)
+{
+    log_ring_t *ring = NULL, *next_ring = NULL;
+
+    if (!async.running)
+        return;
+
+    /* Anything logged from now on is written synchronously */
+    async.running = false;
+
+    ogs_thread_mutex_lock(&async.mutex);
+    async.stopping = true;
+    ogs_thread_cond_signal(&async.cond);
+    ogs_thread_mutex_unlock(&async.mutex);
+
+    ogs_thread_destroy(async.thread);
+    async.thread = NULL;
+
+#if !defined(_WIN32)
+    pthread_key_delete(async.ring_key);
+#endif
+
+    ogs_thread_mutex_lock(&async.mutex);
+    async_drain();
+    ogs_list_for_each_safe(&async.ring_list, next_ring, ring) {
+        async.dropped += ring->dropped;
+        async.overflow += ring->overflow;
+
+        ogs_list_remove(&async.ring_list, ring);
+        free(ring->buf);
+        free(ring);
+    }
+    ogs_thread_mutex_unlock(&async.mutex);
+
+    ogs_thread_cond_destroy(&async.cond);
+    ogs_thread_mutex_destroy(&async.mutex);
+}
+
+bool ogs_log_async_is_running(void)
+{
+    return async.running;
+}
+
+void ogs_log_async_get_stats(ogs_log_async_stats_t *stats)
+{
+    log_ring_t *ring = NULL;
+
+    ogs_assert(stats);
+
+    if (!async.running) {
+        stats->written = async.written;
+        stats->dropped = async.dropped;
+        stats->overflow = async.overflow;
+        stats->rings = 0;
+        return;
+    }
+
+    ogs_thread_mutex_lock(&async.mutex);
+    stats->written = async.written;
+    stats->dropped = async.dropped;
+    stats->overflow = async.overflow;
+    stats->rings = 0;
+    ogs_list_for_each(&async.ring_list, ring) {
+        stats->rings++;
+        stats->dropped += __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+        stats->overflow += __atomic_load_n(&ring->overflow, __ATOMIC_RELAXED);
+    }
+    ogs_thread_mutex_unlock(&async.mutex);
+}
+
+int ogs_log_config_async(size_t size, const char *drop_level)
+{
+    ogs_log_level_e l = OGS_LOG_INFO;
+
+    if (drop_level) {
+        l = ogs_log_level_from_string(drop_level);
+        if ((int)l == OGS_ERROR) {
+            ogs_error("Invalid LOG-LEVEL "
+                    "[none:fatal|error|warn|info|debug|trace]: %s\n",
+                    drop_level);
+            return OGS_ERROR;
+        }
+    }
+
+    return ogs_log_async_start(size, l);
+}
+
 void ogs_log_vprintf(ogs_log_level_e level, int id,
     ogs_err_t err, const char *file, int line, const char *func,
     int content_only, const char *format, va_list ap)
 {
-    ogs_log_t *log = NULL;
     ogs_log_domain_t *domain = NULL;
 
+    struct timeval tv;
+    ogs_time_t now;
+    char content[OGS_HUGE_LEN];
+    char *p;
+
+    domain = find_domain(id, file, line);
+    if (domain->level < level)
+        return;
+
+    ogs_gettimeofday(&tv);
+    now = ogs_time_from_sec(tv.tv_sec) + tv.tv_usec;
+
+    p = log_content(content, content + OGS_HUGE_LEN, format, ap);
+
+    if (async.running) {
+        log_ring_t *ring = NULL;
+        log_record_t record;
+
+        if (level == OGS_LOG_FATAL) {
+            async_write_sync(level, domain,
+                    err, file, line, func, content_only, now, content);
+            return;
+        }
+
+        ring = ring_get();
+        if (ring) {
+            memset(&record, 0, sizeof(record));
+            record.level = level;
+            record.content_only = content_only;
+            record.domain_id = id;
+            record.line = line;
+            record.err = err;
+            record.time = now;
+            record.file = file;
+            record.func = func;
+
+            if (ring_push(ring, &record, content, p - content)) {
+                /* Wake the writer early once the ring is half full */
+                if (__atomic_load_n(&async.sleeping, __ATOMIC_RELAXED) &&
+                    ring->head - __atomic_load_n(
+                        &ring->tail, __ATOMIC_RELAXED) > ring->size / 2)
+                    ogs_thread_cond_signal(&async.cond);
+                return;
+            }
+
+            if (level >= async.drop_level) {
+                __atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+                return;
+            }
+            __atomic_add_fetch(&ring->overflow, 1, __ATOMIC_RELAXED);
+        }
+
+        async_write_sync(level, domain,
+                err, file, line, func, content_only, now, content);
+        return;
+    }
+
+    log_output(level, domain,
+            err, file, line, func, content_only, now, content);
+}
+
+static void log_output(ogs_log_level_e level, ogs_log_domain_t *domain,
+        ogs_err_t err, const char *file, int line, const char *func,
+        int content_only, ogs_time_t time, const char *content)
+{
+    ogs_log_t *log = NULL;
+
     char logstr[OGS_HUGE_LEN];
     char *p, *last;
 
     int wrote_stderr = 0;
 
     ogs_list_for_each(&log_list, log) {
-        domain = ogs_pool_find(&domain_pool, id);
-        if (!domain) {
-            fprintf(stderr, "No LogDomain[id:%d] in %s:%d", id, file, line);
-            ogs_assert_if_reached();
-        }
-        if (domain->level < level)
-            return;
-
         p = logstr;
         last = logstr + OGS_HUGE_LEN;
 
         if (!content_only) {
             if (log->print.timestamp)
-                p = log_timestamp(p, last, log->print.color);
-            if (log->print.domain)
+                p = log_timestamp(p, last, time, log->print.color);
+            if (log->print.domain && domain)
                 p = log_domain(p, last, domain->name, log->print.color);
             if (log->print.level)
                 p = log_level(p, last, level, log->print.color);
         }
 
-        p = log_content(p, last, format, ap);
+        p = ogs_slprintf(p, last, "%s", content);
 
         if (err) {
             char errbuf[OGS_HUGE_LEN];
@@ -465,10 +1005,10 @@ void ogs_log_vprintf(ogs_log_level_e level, int id,
         last = logstr + OGS_HUGE_LEN;
 
         if (!content_only) {
-            p = log_timestamp(p, last, use_color);
+            p = log_timestamp(p, last, time, use_color);
             p = log_level(p, last, level, use_color);
         }
-        p = log_content(p, last, format, ap);
+        p = ogs_slprintf(p, last, "%s", content);
         if (!content_only) {
             p = ogs_slprintf(p, last, " (%s:%d)", file, line);
             p = ogs_slprintf(p, last, " %s()", func);
@@ -476,7 +1016,8 @@ void ogs_log_vprintf(ogs_log_level_e level, int id,
         }
 
         fprintf(stderr, "%s", logstr);
-        fflush(stderr);
+        if (!thread_in_writer)
+            fflush(stderr);
     }
 }
 
@@ -499,6 +1040,10 @@ void ogs_log_hexdump_func(ogs_log_level_e level, int id,
     char dumpstr[OGS_HUGE_LEN];
     char *p, *last;
 
+    /* Skip the formatting if the level is filtered out anyway */
+    if (find_domain(id, __FILE__, __LINE__)->level < level)
+        return;
+
     last = dumpstr + OGS_HUGE_LEN;
     p = dumpstr;
 
@@ -560,19 +1105,17 @@ static int file_cycle(ogs_log_t *log)
 }
 
 static char *log_timestamp(char *buf, char *last,
-        int use_color)
+        ogs_time_t time, int use_color)
 {
-    struct timeval tv;
     struct tm tm;
     char nowstr[32];
 
-    ogs_gettimeofday(&tv);
-    ogs_localtime(tv.tv_sec, &tm);
+    ogs_localtime(ogs_time_sec(time), &tm);
     strftime(nowstr, sizeof nowstr, "%m/%d %H:%M:%S", &tm);
 
     buf = ogs_slprintf(buf, last, "%s%s.%03d%s: ",
             use_color ? TA_FGC_GREEN : "",
-            nowstr, (int)(tv.tv_usec/1000),
+            nowstr, (int)(ogs_time_usec(time)/1000),
             use_color ? TA_NOR : "");
 
     return buf;
@@ -642,6 +1185,9 @@ static void file_writer(
         ogs_log_t *log, ogs_log_level_e level, const char *string)
 {
     fprintf(log->file.out, "%s", string);
-    fflush(log->file.out);
+
+    /* The asynchronous writer flushes once per batch */
+    if (!thread_in_writer)
+        fflush(log->file.out);
 }
 
@@ -109,6 +109,35 @@ void ogs_log_printf(ogs_log_level_e level, int domain_id,
 void ogs_log_hexdump_func(ogs_log_level_e level, int domain_id,
     const unsigned char *data, size_t len);
 
+/*
+ * Asynchronous logging
+ *
+ * Every thread that logs gets its own ring buffer. The caller only
+ * formats the message and pushes a record with its timestamp, domain
+ * and level. A background thread merges the rings in timestamp order,
+ * renders the prefixes and writes the records in batches.
+ *
+ * When a ring is full, records of 'drop_level' or less severe are
+ * dropped. More severe records are written synchronously instead.
+ * FATAL records are always written synchronously after the pending
+ * records have been flushed.
+ */
+#define OGS_LOG_ASYNC_DEFAULT_SIZE (1024*1024)
+
+typedef struct ogs_log_async_stats_s {
+    uint64_t written;   /* Records written by the writer thread */
+    uint64_t dropped;   /* Records dropped because a ring was full */
+    uint64_t overflow;  /* Records written synchronously on a full ring */
+    unsigned int rings; /* Per-thread rings not freed yet */
+} ogs_log_async_stats_t;
+
+int ogs_log_async_start(size_t size, ogs_log_level_e drop_level);
+void ogs_log_async_stop(void);
+bool ogs_log_async_is_running(void);
+void ogs_log_async_get_stats(ogs_log_async_stats_t *stats);
+
+int ogs_log_config_async(size_t size, const char *drop_level);
+
 #define ogs_assert(expr) \
     do { \
         if (ogs_likely(expr)) ; \
@@ -65,9 +65,11 @@ extern "C" {
 #define OGS_GNUC_PRINTF(f, v) __attribute__ ((format (__printf__, f, v)))
 #endif
 #define OGS_GNUC_NORETURN __attribute__((__noreturn__))
+#define OGS_GNUC_ALIGNED(n) __attribute__((__aligned__(n)))
 #else
 #define OGS_GNUC_PRINTF(f, v) 
 #define OGS_GNUC_NORETURN
+#define OGS_GNUC_ALIGNED(n)
 #endif
 
 #if __GNUC__ > 6
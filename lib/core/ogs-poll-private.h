@@ -37,6 +37,15 @@ typedef struct ogs_poll_s {
     ogs_poll_handler_f handler;
     void *data;
 
+    struct {
+        ogs_poll_recv_handler_f handler;
+        void *data;
+
+        ogs_pkbuf_pool_t *pool;
+        unsigned int size;
+        unsigned int headroom;
+    } recv;
+
     ogs_pollset_t *pollset;
 } ogs_poll_t;
 
@@ -50,8 +59,50 @@ typedef struct ogs_pollset_s {
     } notify;
 
     unsigned int capacity;
+
+    ogs_prof_t *prof;
 } ogs_pollset_t;
 
+/*
+ * Backends call the poll handlers through this wrapper so the time spent
+ * in each handler is accounted. The handler may remove the poll,
+ * so everything needed afterwards is read before the call.
+ */
+static ogs_inline void ogs_poll_dispatch(ogs_poll_t *poll, short when)
+{
+    ogs_prof_t *prof = poll->pollset->prof;
+    ogs_poll_handler_f handler = poll->handler;
+    uint64_t start, elapsed;
+
+    start = ogs_prof_now();
+    ogs_time_cache_set((ogs_time_t)(start / 1000));
+    handler(when, poll->fd, poll->data);
+    elapsed = ogs_prof_now() - start;
+
+    ogs_prof_entry_add(prof->poll, (uintptr_t)handler, NULL, elapsed);
+    prof->poll_dispatched += elapsed;
+}
+
+static ogs_inline void ogs_poll_dispatch_recv(ogs_poll_t *poll,
+        ogs_pkbuf_t *pkbuf, ogs_sockaddr_t *from)
+{
+    ogs_prof_t *prof = poll->pollset->prof;
+    ogs_poll_recv_handler_f handler = poll->recv.handler;
+    uint64_t start, elapsed;
+
+    start = ogs_prof_now();
+    ogs_time_cache_set((ogs_time_t)(start / 1000));
+    handler(poll->fd, pkbuf, from, poll->recv.data);
+    elapsed = ogs_prof_now() - start;
+
+    ogs_prof_entry_add(prof->poll, (uintptr_t)handler, NULL, elapsed);
+    prof->poll_dispatched += elapsed;
+}
+
+#if defined(HAVE_IO_URING)
+bool ogs_io_uring_is_supported(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
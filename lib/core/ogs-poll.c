@@ -25,6 +25,7 @@
 
 extern const ogs_pollset_actions_t ogs_kqueue_actions;
 extern const ogs_pollset_actions_t ogs_epoll_actions;
+extern const ogs_pollset_actions_t ogs_io_uring_actions;
 extern const ogs_pollset_actions_t ogs_select_actions;
 
 static void *self_handler_data = NULL;
@@ -42,11 +43,24 @@ ogs_pollset_t *ogs_pollset_create(unsigned int capacity)
 
     pollset->capacity = capacity;
 
+    pollset->prof = ogs_calloc(1, sizeof *pollset->prof);
+    if (!pollset->prof) {
+        ogs_error("ogs_calloc() failed");
+        ogs_free(pollset);
+        return NULL;
+    }
+
     ogs_pool_init(&pollset->pool, capacity);
 
     if (ogs_pollset_actions_initialized == false) {
 #if defined(HAVE_KQUEUE)
         ogs_pollset_actions = ogs_kqueue_actions;
+#elif defined(HAVE_IO_URING)
+        /* Older kernels and seccomp-restricted containers use epoll */
+        if (ogs_io_uring_is_supported() == true)
+            ogs_pollset_actions = ogs_io_uring_actions;
+        else
+            ogs_pollset_actions = ogs_epoll_actions;
 #elif defined(HAVE_EPOLL)
         ogs_pollset_actions = ogs_epoll_actions;
 #else
@@ -67,6 +81,11 @@ void ogs_pollset_destroy(ogs_pollset_t *pollset)
     ogs_pollset_actions.cleanup(pollset);
 
     ogs_pool_final(&pollset->pool);
+
+    if (ogs_prof_current() == pollset->prof)
+        ogs_prof_set_current(NULL);
+    ogs_free(pollset->prof);
+
     ogs_free(pollset);
 }
 
@@ -92,6 +111,7 @@ ogs_poll_t *ogs_pollset_add(ogs_pollset_t *pollset, short when,
     poll->when = when;
     poll->fd = fd;
     poll->handler = handler;
+    memset(&poll->recv, 0, sizeof(poll->recv));
 
     if (data == &self_handler_data)
         poll->data = poll;
@@ -110,6 +130,84 @@ ogs_poll_t *ogs_pollset_add(ogs_pollset_t *pollset, short when,
     return poll;
 }
 
+static void recv_handler(short when, ogs_socket_t fd, void *data)
+{
+    ogs_poll_t *poll = data;
+    ogs_pkbuf_t *pkbuf = NULL;
+    ogs_sockaddr_t from;
+    ssize_t size;
+
+    ogs_assert(poll);
+
+    pkbuf = ogs_pkbuf_alloc(poll->recv.pool, poll->recv.size);
+    if (!pkbuf) {
+        ogs_error("ogs_pkbuf_alloc() failed");
+        return;
+    }
+    ogs_pkbuf_reserve(pkbuf, poll->recv.headroom);
+    ogs_pkbuf_put(pkbuf, poll->recv.size - poll->recv.headroom);
+
+    size = ogs_recvfrom(fd, pkbuf->data, pkbuf->len, 0, &from);
+    if (size <= 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "ogs_recvfrom() failed");
+        ogs_pkbuf_free(pkbuf);
+        return;
+    }
+
+    ogs_pkbuf_trim(pkbuf, size);
+
+    poll->recv.handler(fd, pkbuf, &from, poll->recv.data);
+}
+
+ogs_poll_t *ogs_pollset_add_recv(ogs_pollset_t *pollset, ogs_socket_t fd,
+        ogs_pkbuf_pool_t *pool, unsigned int size, unsigned int headroom,
+        ogs_poll_recv_handler_f handler, void *data)
+{
+    ogs_poll_t *poll = NULL;
+    int rc;
+
+    ogs_assert(pollset);
+
+    ogs_assert(fd != INVALID_SOCKET);
+    ogs_assert(handler);
+    ogs_assert(size > headroom);
+
+    ogs_pool_alloc(&pollset->pool, &poll);
+    ogs_assert(poll);
+
+    rc = ogs_nonblocking(fd);
+    ogs_assert(rc == OGS_OK);
+    rc = ogs_closeonexec(fd);
+    ogs_assert(rc == OGS_OK);
+
+    poll->when = OGS_POLLIN;
+    poll->fd = fd;
+    poll->handler = recv_handler;
+    poll->data = poll;
+
+    poll->recv.handler = handler;
+    poll->recv.data = data;
+    poll->recv.pool = pool;
+    poll->recv.size = size;
+    poll->recv.headroom = headroom;
+
+    poll->pollset = pollset;
+
+    rc = OGS_ERROR;
+    if (ogs_pollset_actions.add_recv)
+        rc = ogs_pollset_actions.add_recv(poll);
+    if (rc != OGS_OK)
+        rc = ogs_pollset_actions.add(poll);
+    if (rc != OGS_OK) {
+        ogs_error("cannot add poll");
+        ogs_pool_free(&pollset->pool, poll);
+        return NULL;
+    }
+
+    return poll;
+}
+
 void ogs_pollset_remove(ogs_poll_t *poll)
 {
     int rc;
@@ -131,3 +229,42 @@ void *ogs_pollset_self_handler_data(void)
 {
     return &self_handler_data;
 }
+
+/*
+ * The busy time of one loop iteration is everything between the return
+ * of the previous poll and this call, plus the handlers dispatched
+ * inside the previous poll.
+ */
+int ogs_pollset_poll(ogs_pollset_t *pollset, ogs_time_t timeout)
+{
+    ogs_prof_t *prof = NULL;
+    uint64_t now;
+    int rv;
+
+    ogs_assert(pollset);
+    prof = pollset->prof;
+    ogs_assert(prof);
+
+    ogs_prof_set_current(prof);
+
+    now = ogs_prof_now();
+    if (prof->poll_returned)
+        ogs_prof_stat_add(&prof->iteration,
+                now - prof->poll_returned + prof->poll_dispatched);
+    prof->poll_dispatched = 0;
+
+    rv = ogs_pollset_actions.poll(pollset, timeout);
+
+    prof->poll_returned = ogs_prof_now();
+    ogs_time_cache_set((ogs_time_t)(prof->poll_returned / 1000));
+
+    return rv;
+}
+
+ogs_prof_t *ogs_pollset_prof(ogs_pollset_t *pollset)
+{
+    if (!pollset)
+        return NULL;
+
+    return pollset->prof;
+}
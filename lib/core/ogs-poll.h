@@ -40,8 +40,30 @@ ogs_poll_t *ogs_pollset_add(ogs_pollset_t *pollset, short when,
         ogs_socket_t fd, ogs_poll_handler_f handler, void *data);
 void ogs_pollset_remove(ogs_poll_t *poll);
 
+/*
+ * Datagram receive.
+ *
+ * The handler is called once per datagram received on fd, with a packet
+ * buffer that it owns and must free. The buffer is allocated from 'pool'
+ * with 'size' bytes, of which at least 'headroom' are reserved in front
+ * of the payload.
+ *
+ * On io_uring the datagrams are received by a multishot recvmsg directly
+ * into buffers provided to the kernel, so a busy socket costs no system
+ * call per packet. The other backends wait for POLLIN and call recvfrom().
+ */
+typedef void (*ogs_poll_recv_handler_f)(ogs_socket_t fd,
+        ogs_pkbuf_t *pkbuf, ogs_sockaddr_t *from, void *data);
+
+ogs_poll_t *ogs_pollset_add_recv(ogs_pollset_t *pollset, ogs_socket_t fd,
+        ogs_pkbuf_pool_t *pool, unsigned int size, unsigned int headroom,
+        ogs_poll_recv_handler_f handler, void *data);
+
 void *ogs_pollset_self_handler_data(void);
 
+int ogs_pollset_poll(ogs_pollset_t *pollset, ogs_time_t timeout);
+ogs_prof_t *ogs_pollset_prof(ogs_pollset_t *pollset);
+
 typedef struct ogs_pollset_actions_s {
     void (*init)(ogs_pollset_t *pollset);
     void (*cleanup)(ogs_pollset_t *pollset);
@@ -51,11 +73,13 @@ typedef struct ogs_pollset_actions_s {
 
     int (*poll)(ogs_pollset_t *pollset, ogs_time_t timeout);
     int (*notify)(ogs_pollset_t *pollset);
+
+    /* Optional, ogs_pollset_add_recv() falls back to add() */
+    int (*add_recv)(ogs_poll_t *poll);
 } ogs_pollset_actions_t;
 
 extern ogs_pollset_actions_t ogs_pollset_actions;
 
-#define ogs_pollset_poll ogs_pollset_actions.poll
 #define ogs_pollset_notify ogs_pollset_actions.notify
 
 #ifdef __cplusplus
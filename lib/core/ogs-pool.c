@@ -0,0 +1,359 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-core.h"
+
+/*
+ * Objects per slab. Small pools get a single slab; large pools are
+ * split so that there are at most OGS_POOL_MAX_SLAB slabs.
+ */
+#define OGS_POOL_MIN_SLAB_OBJECT    64
+#define OGS_POOL_MAX_SLAB           1024
+
+#define OGS_POOL_ALIGN              16
+
+/*
+ * Every object is preceded by a header giving its 1-based pool index.
+ * The header is padded so that the object keeps the malloc() alignment.
+ */
+typedef union ogs_pool_hdr_u {
+    struct {
+        int index;
+        int used;
+    } h;
+    char pad[OGS_POOL_ALIGN];
+} ogs_pool_hdr_t;
+
+typedef struct ogs_pool_slab_s {
+    ogs_lnode_t lnode;          /* partial list, ordered by slab number */
+
+    int num;                    /* slab number */
+    int used;
+
+    int head, tail, avail;      /* FIFO of free object offsets */
+    int *free;
+
+    char *mem;
+} ogs_pool_slab_t;
+
+struct ogs_pool_elastic_s {
+    ogs_lnode_t lnode;          /* registry */
+
+    const char *name;
+    size_t stride;              /* header + object, aligned */
+    int capacity;
+    int slab_size;              /* objects per slab */
+    int num_of_slab;
+
+    ogs_pool_slab_t **slab;
+    ogs_list_t partial;         /* committed slabs with free room */
+
+    int used;
+    int committed;
+};
+
+static ogs_list_t registry;
+static ogs_thread_mutex_t registry_mutex;
+
+void ogs_pool_elastic_init(void)
+{
+    ogs_list_init(&registry);
+    ogs_thread_mutex_init(&registry_mutex);
+}
+
+void ogs_pool_elastic_final(void)
+{
+    ogs_thread_mutex_destroy(&registry_mutex);
+}
+
+ogs_pool_elastic_t *ogs_pool_elastic_create(
+        const char *name, size_t size, int capacity)
+{
+    ogs_pool_elastic_t *elastic = NULL;
+
+    ogs_assert(name);
+    ogs_assert(size);
+    ogs_assert(capacity > 0);
+
+    elastic = calloc(1, sizeof(*elastic));
+    ogs_assert(elastic);
+
+    elastic->name = name;
+    if (*elastic->name == '&')
+        elastic->name++;
+
+    elastic->stride = sizeof(ogs_pool_hdr_t) +
+        (size + OGS_POOL_ALIGN - 1) / OGS_POOL_ALIGN * OGS_POOL_ALIGN;
+    elastic->capacity = capacity;
+    elastic->slab_size = ogs_max(OGS_POOL_MIN_SLAB_OBJECT,
+            (capacity + OGS_POOL_MAX_SLAB - 1) / OGS_POOL_MAX_SLAB);
+    elastic->slab_size = ogs_min(elastic->slab_size, capacity);
+    elastic->num_of_slab =
+        (capacity + elastic->slab_size - 1) / elastic->slab_size;
+
+    elastic->slab = calloc(elastic->num_of_slab, sizeof(ogs_pool_slab_t *));
+    ogs_assert(elastic->slab);
+
+    ogs_thread_mutex_lock(&registry_mutex);
+    ogs_list_add(&registry, elastic);
+    ogs_thread_mutex_unlock(&registry_mutex);
+
+    return elastic;
+}
+
+static int slab_objects(ogs_pool_elastic_t *elastic, int num)
+{
+    return ogs_min(elastic->slab_size,
+            elastic->capacity - num * elastic->slab_size);
+}
+
+static ogs_pool_slab_t *slab_create(ogs_pool_elastic_t *elastic, int num)
+{
+    ogs_pool_slab_t *slab = NULL;
+    int i, n = slab_objects(elastic, num);
+
+    slab = malloc(sizeof(*slab));
+    if (!slab) {
+        ogs_error("malloc() failed");
+        return NULL;
+    }
+    slab->free = malloc(sizeof(int) * n);
+    slab->mem = malloc(elastic->stride * n);
+    if (!slab->free || !slab->mem) {
+        ogs_error("malloc() failed [%s:%d]", elastic->name, n);
+        free(slab->free);
+        free(slab->mem);
+        free(slab);
+        return NULL;
+    }
+
+    slab->num = num;
+    slab->used = 0;
+    slab->head = slab->tail = 0;
+    slab->avail = n;
+
+    for (i = 0; i < n; i++) {
+        ogs_pool_hdr_t *hdr =
+            (ogs_pool_hdr_t *)(slab->mem + elastic->stride * i);
+        hdr->h.index = num * elastic->slab_size + i + 1;
+        hdr->h.used = 0;
+        slab->free[i] = i;
+    }
+
+    elastic->slab[num] = slab;
+    __atomic_store_n(&elastic->committed,
+            elastic->committed + n, __ATOMIC_RELAXED);
+
+    return slab;
+}
+
+static void slab_destroy(ogs_pool_elastic_t *elastic, ogs_pool_slab_t *slab)
+{
+    elastic->slab[slab->num] = NULL;
+    __atomic_store_n(&elastic->committed,
+            elastic->committed - slab_objects(elastic, slab->num),
+            __ATOMIC_RELAXED);
+
+    free(slab->free);
+    free(slab->mem);
+    free(slab);
+}
+
+static void partial_insert(ogs_pool_elastic_t *elastic, ogs_pool_slab_t *slab)
+{
+    ogs_pool_slab_t *iter = NULL;
+
+    ogs_list_for_each(&elastic->partial, iter) {
+        if (iter->num > slab->num) {
+            ogs_list_insert_prev(&elastic->partial, iter, slab);
+            return;
+        }
+    }
+    ogs_list_add(&elastic->partial, slab);
+}
+
+void ogs_pool_elastic_destroy(ogs_pool_elastic_t *elastic)
+{
+    int i;
+
+    ogs_assert(elastic);
+
+    ogs_thread_mutex_lock(&registry_mutex);
+    ogs_list_remove(&registry, elastic);
+    ogs_thread_mutex_unlock(&registry_mutex);
+
+    for (i = 0; i < elastic->num_of_slab; i++)
+        if (elastic->slab[i])
+            slab_destroy(elastic, elastic->slab[i]);
+
+    free(elastic->slab);
+    free(elastic);
+}
+
+/*
+ * Objects are taken from the lowest-numbered slab with free room, so
+ * that under decreasing load the higher slabs drain and can be released.
+ */
+void *ogs_pool_elastic_alloc(ogs_pool_elastic_t *elastic)
+{
+    ogs_pool_slab_t *slab = NULL;
+    ogs_pool_hdr_t *hdr = NULL;
+    int i;
+
+    ogs_assert(elastic);
+
+    slab = ogs_list_first(&elastic->partial);
+    if (!slab) {
+        for (i = 0; i < elastic->num_of_slab; i++)
+            if (!elastic->slab[i])
+                break;
+        if (i == elastic->num_of_slab)
+            return NULL;
+
+        slab = slab_create(elastic, i);
+        if (!slab)
+            return NULL;
+        partial_insert(elastic, slab);
+    }
+
+    ogs_assert(slab->avail > 0);
+    hdr = (ogs_pool_hdr_t *)
+        (slab->mem + elastic->stride * slab->free[slab->head]);
+    slab->head = (slab->head + 1) % slab_objects(elastic, slab->num);
+    slab->avail--;
+    slab->used++;
+    if (!slab->avail)
+        ogs_list_remove(&elastic->partial, slab);
+
+    ogs_assert(!hdr->h.used);
+    hdr->h.used = 1;
+    __atomic_store_n(&elastic->used, elastic->used + 1, __ATOMIC_RELAXED);
+
+    return hdr + 1;
+}
+
+static ogs_pool_slab_t *slab_of(
+        ogs_pool_elastic_t *elastic, ogs_pool_hdr_t *hdr)
+{
+    int num;
+
+    ogs_assert(hdr->h.index > 0 && hdr->h.index <= elastic->capacity);
+    num = (hdr->h.index - 1) / elastic->slab_size;
+    ogs_assert(elastic->slab[num]);
+
+    return elastic->slab[num];
+}
+
+/*
+ * An empty slab is only released when the other committed slabs still
+ * have a slab's worth of free objects, so a pool hovering around a slab
+ * boundary does not malloc()/free() on every allocation.
+ */
+void ogs_pool_elastic_free(ogs_pool_elastic_t *elastic, void *node)
+{
+    ogs_pool_slab_t *slab = NULL;
+    ogs_pool_hdr_t *hdr = NULL;
+    int n, offset;
+
+    ogs_assert(elastic);
+    ogs_assert(node);
+
+    hdr = (ogs_pool_hdr_t *)node - 1;
+    ogs_assert(hdr->h.used);
+    slab = slab_of(elastic, hdr);
+    n = slab_objects(elastic, slab->num);
+
+    hdr->h.used = 0;
+    __atomic_store_n(&elastic->used, elastic->used - 1, __ATOMIC_RELAXED);
+
+    offset = (hdr->h.index - 1) - slab->num * elastic->slab_size;
+    slab->free[slab->tail] = offset;
+    slab->tail = (slab->tail + 1) % n;
+    if (!slab->avail)
+        partial_insert(elastic, slab);
+    slab->avail++;
+    slab->used--;
+
+    if (!slab->used && elastic->committed - elastic->used - n >=
+            elastic->slab_size) {
+        ogs_list_remove(&elastic->partial, slab);
+        slab_destroy(elastic, slab);
+    }
+}
+
+int ogs_pool_elastic_index(ogs_pool_elastic_t *elastic, const void *node)
+{
+    ogs_assert(elastic);
+    ogs_assert(node);
+
+    return ((const ogs_pool_hdr_t *)node - 1)->h.index;
+}
+
+void *ogs_pool_elastic_find(ogs_pool_elastic_t *elastic, int index)
+{
+    ogs_pool_slab_t *slab = NULL;
+    ogs_pool_hdr_t *hdr = NULL;
+    int offset;
+
+    ogs_assert(elastic);
+
+    if (index <= 0 || index > elastic->capacity)
+        return NULL;
+
+    slab = elastic->slab[(index - 1) / elastic->slab_size];
+    if (!slab)
+        return NULL;
+
+    offset = (index - 1) - slab->num * elastic->slab_size;
+    hdr = (ogs_pool_hdr_t *)(slab->mem + elastic->stride * offset);
+
+    return hdr->h.used ? hdr + 1 : NULL;
+}
+
+void ogs_pool_elastic_stat(ogs_pool_elastic_t *elastic, ogs_pool_stat_t *stat)
+{
+    ogs_assert(elastic);
+    ogs_assert(stat);
+
+    stat->name = elastic->name;
+    stat->object_size = elastic->stride;
+    stat->size = elastic->capacity;
+    stat->used = __atomic_load_n(&elastic->used, __ATOMIC_RELAXED);
+    stat->committed = __atomic_load_n(&elastic->committed, __ATOMIC_RELAXED);
+}
+
+/*
+ * Can be called from another thread (e.g. the metrics server).
+ * The counters may be slightly stale.
+ */
+void ogs_pool_elastic_stat_all(
+        void (*cb)(const ogs_pool_stat_t *stat, void *data), void *data)
+{
+    ogs_pool_elastic_t *elastic = NULL;
+    ogs_pool_stat_t stat;
+
+    ogs_assert(cb);
+
+    ogs_thread_mutex_lock(&registry_mutex);
+    ogs_list_for_each(&registry, elastic) {
+        ogs_pool_elastic_stat(elastic, &stat);
+        cb(&stat, data);
+    }
+    ogs_thread_mutex_unlock(&registry_mutex);
+}
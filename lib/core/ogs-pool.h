@@ -34,6 +34,27 @@ extern "C" {
 
 typedef int32_t ogs_pool_id_t;
 
+/*
+ * Elastic pool
+ *
+ * A flat pool commits all of its objects up front. An elastic pool only
+ * reserves the capacity and commits memory in slabs of a fixed number of
+ * objects as they are needed. Once a slab is empty and the other slabs
+ * have enough free room left, the slab is given back to the system.
+ *
+ * The index of an object is fixed by its slab and its position in the
+ * slab, so ogs_pool_index()/ogs_pool_find() behave as with a flat pool.
+ */
+typedef struct ogs_pool_elastic_s ogs_pool_elastic_t;
+
+typedef struct ogs_pool_stat_s {
+    const char *name;
+    size_t object_size;     /* bytes committed per object */
+    int size;               /* capacity in objects */
+    int used;               /* objects in use */
+    int committed;          /* objects backed by memory */
+} ogs_pool_stat_t;
+
 #define OGS_POOL(pool, type) \
     struct { \
         const char *name; \
@@ -43,6 +64,8 @@ typedef int32_t ogs_pool_id_t;
         \
         ogs_hash_t *id_hash; \
         ogs_pool_id_t id; \
+        \
+        ogs_pool_elastic_t *elastic; \
     } pool
 
 /*
@@ -60,6 +83,7 @@ typedef int32_t ogs_pool_id_t;
     ogs_assert((pool)->index); \
     (pool)->size = (pool)->avail = _size; \
     (pool)->head = (pool)->tail = 0; \
+    (pool)->elastic = NULL; \
     for (i = 0; i < _size; i++) { \
         (pool)->free[i] = &((pool)->array[i]); \
         (pool)->index[i] = NULL; \
@@ -77,6 +101,8 @@ typedef int32_t ogs_pool_id_t;
     if (((pool)->size != (pool)->avail)) \
         ogs_error("%d in '%s[%d]' were not released.", \
                 (pool)->size - (pool)->avail, (pool)->name, (pool)->size); \
+    if ((pool)->elastic) \
+        ogs_pool_elastic_destroy((pool)->elastic); \
     free((pool)->free); \
     free((pool)->array); \
     free((pool)->index); \
@@ -102,6 +128,7 @@ typedef int32_t ogs_pool_id_t;
     ogs_assert((pool)->index); \
     (pool)->size = (pool)->avail = _size; \
     (pool)->head = (pool)->tail = 0; \
+    (pool)->elastic = NULL; \
     for (i = 0; i < _size; i++) { \
         (pool)->free[i] = &((pool)->array[i]); \
         (pool)->index[i] = NULL; \
@@ -121,17 +148,50 @@ typedef int32_t ogs_pool_id_t;
     if (((pool)->size != (pool)->avail)) \
         ogs_error("%d in '%s[%d]' were not released.", \
                 (pool)->size - (pool)->avail, (pool)->name, (pool)->size); \
-    ogs_free((pool)->free); \
-    ogs_free((pool)->array); \
-    ogs_free((pool)->index); \
+    if ((pool)->elastic) { \
+        ogs_pool_elastic_destroy((pool)->elastic); \
+    } else { \
+        ogs_free((pool)->free); \
+        ogs_free((pool)->array); \
+        ogs_free((pool)->index); \
+    } \
     \
     ogs_assert((pool)->id_hash); \
     ogs_hash_destroy((pool)->id_hash); \
 } while (0)
 
+/*
+ * ogs_pool_init_elastic() can replace either ogs_pool_init() or
+ * ogs_pool_create(). The pool is released with the matching
+ * ogs_pool_final() or ogs_pool_destroy().
+ *
+ * Only ogs_pool_alloc/free/index/find and the ogs_pool_id_* variants
+ * are supported. The id generators need a flat pool.
+ */
+#define ogs_pool_init_elastic(pool, _size) do { \
+    (pool)->name = #pool; \
+    (pool)->free = NULL; \
+    (pool)->array = NULL; \
+    (pool)->index = NULL; \
+    (pool)->size = (pool)->avail = _size; \
+    (pool)->head = (pool)->tail = 0; \
+    (pool)->elastic = ogs_pool_elastic_create( \
+            #pool, sizeof(*(pool)->array), _size); \
+    ogs_assert((pool)->elastic); \
+    \
+    (pool)->id_hash = ogs_hash_make(); \
+    ogs_assert((pool)->id_hash); \
+} while (0)
+
 #define ogs_pool_alloc(pool, node) do { \
     *(node) = NULL; \
-    if ((pool)->avail > 0) { \
+    if ((pool)->elastic) { \
+        if ((pool)->avail > 0) { \
+            *(node) = ogs_pool_elastic_alloc((pool)->elastic); \
+            if (*(node)) \
+                (pool)->avail--; \
+        } \
+    } else if ((pool)->avail > 0) { \
         (pool)->avail--; \
         *(node) = (void*)(pool)->free[(pool)->head]; \
         (pool)->free[(pool)->head] = NULL; \
@@ -143,15 +203,24 @@ typedef int32_t ogs_pool_id_t;
 #define ogs_pool_free(pool, node) do { \
     if ((pool)->avail < (pool)->size) { \
         (pool)->avail++; \
-        (pool)->free[(pool)->tail] = (void*)(node); \
-        (pool)->tail = ((pool)->tail + 1) % ((pool)->size); \
-        (pool)->index[ogs_pool_index(pool, node)-1] = NULL; \
+        if ((pool)->elastic) { \
+            ogs_pool_elastic_free((pool)->elastic, node); \
+        } else { \
+            (pool)->free[(pool)->tail] = (void*)(node); \
+            (pool)->tail = ((pool)->tail + 1) % ((pool)->size); \
+            (pool)->index[ogs_pool_index(pool, node)-1] = NULL; \
+        } \
     } \
 } while (0)
 
-#define ogs_pool_index(pool, node) (((node) - (pool)->array)+1)
+#define ogs_pool_index(pool, node) \
+    ((pool)->elastic ? \
+        ogs_pool_elastic_index((pool)->elastic, node) : \
+        (((node) - (pool)->array)+1))
 #define ogs_pool_find(pool, _index) \
-    (_index > 0 && _index <= (pool)->size) ? (pool)->index[_index-1] : NULL
+    ((pool)->elastic ? \
+        ogs_pool_elastic_find((pool)->elastic, _index) : \
+     (_index > 0 && _index <= (pool)->size) ? (pool)->index[_index-1] : NULL)
 
 #define ogs_pool_id_calloc(pool, node) do { \
     ogs_pool_alloc(pool, node); \
@@ -179,6 +248,7 @@ typedef int32_t ogs_pool_id_t;
 
 #define ogs_pool_sequence_id_generate(pool) do { \
     int i; \
+    ogs_assert(!(pool)->elastic); \
     for (i = 0; i < (pool)->size; i++) \
         (pool)->array[i] = i+1; \
 } while (0)
@@ -186,6 +256,7 @@ typedef int32_t ogs_pool_id_t;
 #define ogs_pool_random_id_generate(pool) do { \
     int i, j; \
     ogs_pool_id_t temp; \
+    ogs_assert(!(pool)->elastic); \
     for (i = 0; i < (pool)->size; i++) \
         (pool)->array[i] = i+1; \
     for (i = (pool)->size - 1; i > 0; i--) { \
@@ -197,11 +268,28 @@ typedef int32_t ogs_pool_id_t;
 } while (0)
 #define ogs_pool_assert_if_has_duplicate(pool) do { \
     int i, j; \
+    ogs_assert(!(pool)->elastic); \
     for (i = 0; i < (pool)->size; i++) \
         for (j = i+1; j < (pool)->size; j++) \
             ogs_assert(((pool)->array[i]) != ((pool)->array[j])); \
 } while (0)
 
+ogs_pool_elastic_t *ogs_pool_elastic_create(
+        const char *name, size_t size, int capacity);
+void ogs_pool_elastic_destroy(ogs_pool_elastic_t *elastic);
+
+void *ogs_pool_elastic_alloc(ogs_pool_elastic_t *elastic);
+void ogs_pool_elastic_free(ogs_pool_elastic_t *elastic, void *node);
+int ogs_pool_elastic_index(ogs_pool_elastic_t *elastic, const void *node);
+void *ogs_pool_elastic_find(ogs_pool_elastic_t *elastic, int index);
+
+void ogs_pool_elastic_stat(ogs_pool_elastic_t *elastic, ogs_pool_stat_t *stat);
+void ogs_pool_elastic_stat_all(
+        void (*cb)(const ogs_pool_stat_t *stat, void *data), void *data);
+
+void ogs_pool_elastic_init(void);
+void ogs_pool_elastic_final(void);
+
 #ifdef __cplusplus
 }
 #endif
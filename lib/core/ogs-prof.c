@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "core-config-private.h"
+
+#if HAVE_EXECINFO_H
+#include <execinfo.h>
+#endif
+
+#include "ogs-core.h"
+
+#if defined(_WIN32)
+#define OGS_PROF_THREAD_LOCAL __declspec(thread)
+#else
+#define OGS_PROF_THREAD_LOCAL __thread
+#endif
+
+static OGS_PROF_THREAD_LOCAL ogs_prof_t *current_prof = NULL;
+
+uint64_t ogs_prof_now(void)
+{
+#if HAVE_CLOCK_GETTIME && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+        return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+    return (uint64_t)ogs_get_monotonic_time() * 1000ULL;
+}
+
+void ogs_prof_set_current(ogs_prof_t *prof)
+{
+    current_prof = prof;
+
+    /* The cached clock is only refreshed while a loop is profiled */
+    if (!prof)
+        ogs_time_cache_set(0);
+}
+
+ogs_prof_t *ogs_prof_current(void)
+{
+    return current_prof;
+}
+
+void ogs_prof_set_event_name(ogs_prof_t *prof, ogs_prof_event_name_f cb)
+{
+    ogs_assert(prof);
+    prof->event_name = cb;
+}
+
+/*
+ * The loop thread is the only writer, so a plain read-modify-write is
+ * enough. The relaxed stores only keep the 64-bit values untorn for
+ * readers running on other threads.
+ */
+void ogs_prof_stat_add(ogs_prof_stat_t *stat, uint64_t elapsed)
+{
+    ogs_assert(stat);
+
+    __atomic_store_n(&stat->count, stat->count + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&stat->total, stat->total + elapsed, __ATOMIC_RELAXED);
+    if (elapsed > stat->max)
+        __atomic_store_n(&stat->max, elapsed, __ATOMIC_RELAXED);
+}
+
+void ogs_prof_read(ogs_prof_stat_t *dst, const ogs_prof_stat_t *src)
+{
+    ogs_assert(dst);
+    ogs_assert(src);
+
+    dst->count = __atomic_load_n(&src->count, __ATOMIC_RELAXED);
+    dst->total = __atomic_load_n(&src->total, __ATOMIC_RELAXED);
+    dst->max = __atomic_load_n(&src->max, __ATOMIC_RELAXED);
+}
+
+/*
+ * Open addressing over a fixed table. Keys are handler addresses or
+ * small event ids, so they are mixed before probing. Once the table is
+ * full, new keys are silently not accounted.
+ */
+void ogs_prof_entry_add(ogs_prof_entry_t *table,
+        uintptr_t key, const char *name, uint64_t elapsed)
+{
+    unsigned int i, slot;
+    uintptr_t k;
+
+    ogs_assert(table);
+    ogs_assert(key);
+
+    slot = (unsigned int)((key >> 4) ^ (key >> 12) ^ key);
+
+    for (i = 0; i < OGS_PROF_MAX_ENTRY; i++) {
+        ogs_prof_entry_t *entry = &table[(slot + i) % OGS_PROF_MAX_ENTRY];
+
+        k = __atomic_load_n(&entry->key, __ATOMIC_ACQUIRE);
+        if (k == 0) {
+            entry->name = name;
+            __atomic_store_n(&entry->key, key, __ATOMIC_RELEASE);
+            k = key;
+        }
+        if (k == key) {
+            if (!entry->name && name)
+                entry->name = name;
+            ogs_prof_stat_add(&entry->stat, elapsed);
+            return;
+        }
+    }
+}
+
+const char *ogs_prof_symbol(uintptr_t addr, char *buf, size_t buflen)
+{
+#if HAVE_BACKTRACE
+    void *buffer[1];
+    char **strings;
+#endif
+
+    ogs_assert(buf);
+    ogs_assert(buflen);
+
+    ogs_snprintf(buf, buflen, "%p", (void *)addr);
+
+#if HAVE_BACKTRACE
+    /* "binary(symbol+0x1a) [0x...]" -> "symbol" */
+    buffer[0] = (void *)addr;
+    strings = backtrace_symbols(buffer, 1);
+    if (strings) {
+        char *start = strchr(strings[0], '(');
+        char *end = NULL;
+
+        if (start) {
+            start++;
+            end = strpbrk(start, "+)");
+        }
+        if (start && end && end > start) {
+            size_t len = ogs_min((size_t)(end - start), buflen - 1);
+            memcpy(buf, start, len);
+            buf[len] = 0;
+        }
+
+        free(strings);
+    }
+#endif
+
+    return buf;
+}
+
+const char *ogs_prof_entry_name(ogs_prof_t *prof,
+        ogs_prof_entry_t *entry, char *buf, size_t buflen)
+{
+    ogs_assert(prof);
+    ogs_assert(entry);
+
+    if (entry->name)
+        return entry->name;
+
+    if (entry >= prof->event && entry < prof->event + OGS_PROF_MAX_ENTRY) {
+        ogs_snprintf(buf, buflen, "%d", (int)(entry->key - 1));
+        return buf;
+    }
+
+    return ogs_prof_symbol(entry->key, buf, buflen);
+}
+
+static int entry_compare(const void *a, const void *b)
+{
+    const ogs_prof_entry_t *x = *(const ogs_prof_entry_t **)a;
+    const ogs_prof_entry_t *y = *(const ogs_prof_entry_t **)b;
+    uint64_t xt = __atomic_load_n(&x->stat.total, __ATOMIC_RELAXED);
+    uint64_t yt = __atomic_load_n(&y->stat.total, __ATOMIC_RELAXED);
+
+    if (xt > yt) return -1;
+    if (xt < yt) return 1;
+    return 0;
+}
+
+static void dump_table(ogs_prof_t *prof,
+        const char *title, ogs_prof_entry_t *table)
+{
+    ogs_prof_entry_t *sorted[OGS_PROF_MAX_ENTRY];
+    int i, n = 0;
+
+    for (i = 0; i < OGS_PROF_MAX_ENTRY; i++) {
+        if (__atomic_load_n(&table[i].key, __ATOMIC_ACQUIRE))
+            sorted[n++] = &table[i];
+    }
+    if (!n)
+        return;
+
+    qsort(sorted, n, sizeof(sorted[0]), entry_compare);
+
+    ogs_info("  %s", title);
+    for (i = 0; i < n; i++) {
+        ogs_prof_stat_t stat;
+        char buf[128];
+        const char *name = ogs_prof_entry_name(
+                prof, sorted[i], buf, sizeof(buf));
+
+        ogs_prof_read(&stat, &sorted[i]->stat);
+        ogs_info("    %-40s count:%llu total:%lluus avg:%lluns max:%lluns",
+                name,
+                (unsigned long long)stat.count,
+                (unsigned long long)(stat.total / 1000),
+                (unsigned long long)(stat.count ? stat.total / stat.count : 0),
+                (unsigned long long)stat.max);
+    }
+}
+
+void ogs_prof_dump(ogs_prof_t *prof)
+{
+    ogs_prof_stat_t iteration, timer_lag;
+
+    if (!prof)
+        return;
+
+    ogs_prof_read(&iteration, &prof->iteration);
+    ogs_prof_read(&timer_lag, &prof->timer_lag);
+
+    ogs_info("Event loop profile");
+    ogs_info("  iterations:%llu busy:%lluus max:%lluns",
+            (unsigned long long)iteration.count,
+            (unsigned long long)(iteration.total / 1000),
+            (unsigned long long)iteration.max);
+    ogs_info("  timers expired:%llu lag total:%lluus max:%lluns",
+            (unsigned long long)timer_lag.count,
+            (unsigned long long)(timer_lag.total / 1000),
+            (unsigned long long)timer_lag.max);
+    ogs_info("  queue depth max:%llu",
+            (unsigned long long)__atomic_load_n(
+                &prof->queue_depth_max, __ATOMIC_RELAXED));
+
+    dump_table(prof, "events", prof->event);
+    dump_table(prof, "states", prof->state);
+    dump_table(prof, "poll handlers", prof->poll);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_CORE_INSIDE) && !defined(OGS_CORE_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_PROF_H
+#define OGS_PROF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Event-loop profiler
+ *
+ * Every pollset owns an ogs_prof_t. While ogs_pollset_poll() runs on a
+ * thread, that profile is the thread's current one and the loop
+ * primitives account into it:
+ *
+ *   - ogs_pollset_poll()      : busy time of each loop iteration
+ *   - poll handler dispatch   : count/time per handler function
+ *   - ogs_timer_mgr_expire()  : timer expiry lag
+ *   - ogs_queue_trypop()      : event queue depth high-water mark
+ *   - ogs_fsm_dispatch()      : count/time per event type (outermost
+ *                               dispatch) and per FSM state handler
+ *
+ * Only the loop thread writes to the profile. Readers on other threads
+ * (e.g. the SIGUSR1 dump) may see slightly stale values.
+ * All times are in nanoseconds.
+ */
+
+typedef struct ogs_prof_stat_s {
+    uint64_t count;
+    uint64_t total;
+    uint64_t max;
+} ogs_prof_stat_t;
+
+typedef struct ogs_prof_entry_s {
+    uintptr_t key;          /* 0: empty slot */
+    const char *name;       /* event name, NULL for function pointers */
+    ogs_prof_stat_t stat;
+} ogs_prof_entry_t;
+
+#define OGS_PROF_MAX_ENTRY 64
+
+typedef const char *(*ogs_prof_event_name_f)(void *event);
+
+typedef struct ogs_prof_s {
+    ogs_prof_stat_t iteration;
+    ogs_prof_stat_t timer_lag;
+    uint64_t queue_depth_max;
+
+    ogs_prof_entry_t event[OGS_PROF_MAX_ENTRY];  /* key: event id + 1 */
+    ogs_prof_entry_t state[OGS_PROF_MAX_ENTRY];  /* key: FSM state handler */
+    ogs_prof_entry_t poll[OGS_PROF_MAX_ENTRY];   /* key: poll handler */
+
+    ogs_prof_event_name_f event_name;
+
+    uint64_t poll_returned;
+    uint64_t poll_dispatched;
+    int fsm_depth;
+} ogs_prof_t;
+
+uint64_t ogs_prof_now(void);
+
+void ogs_prof_set_current(ogs_prof_t *prof);
+ogs_prof_t *ogs_prof_current(void);
+
+void ogs_prof_set_event_name(ogs_prof_t *prof, ogs_prof_event_name_f cb);
+
+void ogs_prof_stat_add(ogs_prof_stat_t *stat, uint64_t elapsed);
+void ogs_prof_entry_add(ogs_prof_entry_t *table,
+        uintptr_t key, const char *name, uint64_t elapsed);
+void ogs_prof_read(ogs_prof_stat_t *dst, const ogs_prof_stat_t *src);
+
+const char *ogs_prof_symbol(uintptr_t addr, char *buf, size_t buflen);
+const char *ogs_prof_entry_name(ogs_prof_t *prof,
+        ogs_prof_entry_t *entry, char *buf, size_t buflen);
+void ogs_prof_dump(ogs_prof_t *prof);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_PROF_H */
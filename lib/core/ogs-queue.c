@@ -37,31 +37,43 @@
 #undef OGS_LOG_DOMAIN
 #define OGS_LOG_DOMAIN __ogs_event_domain
 
+/*
+ * Bounded lock-free ring (D. Vyukov's MPMC queue). Each cell carries a
+ * sequence number telling whether it is free for the producer at
+ * position 'pos' (seq == pos) or filled for the consumer (seq == pos+1).
+ * Producers and the consumer only contend on their own position
+ * counters, so pushing from timer callbacks, freeDiameter threads or
+ * SBI workers never takes a lock shared with the NF thread.
+ *
+ * The mutex and condition variables are only used by the blocking
+ * variants, when a caller actually has to sleep on a full or empty
+ * queue.
+ */
+typedef struct ogs_queue_cell_s {
+    uint64_t            seq;
+    void                *data;
+} ogs_queue_cell_t;
+
 typedef struct ogs_queue_s {
-    void              **data;
-    unsigned int        nelts; /**< # elements */
-    unsigned int        in;    /**< next empty location */
-    unsigned int        out;   /**< next filled location */
+    ogs_queue_cell_t    *cell;
     unsigned int        bounds;/**< max size of queue */
+
+    uint64_t            in OGS_GNUC_ALIGNED(64);  /**< next empty position */
+    uint64_t            out OGS_GNUC_ALIGNED(64); /**< next filled position */
+
+    int                 nelts OGS_GNUC_ALIGNED(64); /**< # elements */
+    uint64_t            dropped; /**< # rejected because the queue is full */
+
     unsigned int        full_waiters;
     unsigned int        empty_waiters;
+    unsigned int        interrupts;
     ogs_thread_mutex_t  one_big_mutex;
     ogs_thread_cond_t   not_empty;
     ogs_thread_cond_t   not_full;
     int                 terminated;
-} ogs_queue_t;
 
-/**
- * Detects when the ogs_queue_t is full. This utility function is expected
- * to be called from within critical sections, and is not threadsafe.
- */
-#define ogs_queue_full(queue) ((queue)->nelts == (queue)->bounds)
-
-/**
- * Detects when the ogs_queue_t is empty. This utility function is expected
- * to be called from within critical sections, and is not threadsafe.
- */
-#define ogs_queue_empty(queue) ((queue)->nelts == 0)
+    ogs_pollset_t       *pollset; /**< notified when the queue gets data */
+} ogs_queue_t;
 
 /**
  * Callback routine that is called to destroy this
@@ -69,23 +81,32 @@ typedef struct ogs_queue_s {
  */
 ogs_queue_t *ogs_queue_create(unsigned int capacity)
 {
+    unsigned int i;
     ogs_queue_t *queue = ogs_calloc(1, sizeof *queue);
     if (!queue) {
         ogs_error("ogs_calloc() failed");
         return NULL;
     }
     ogs_assert(queue);
+    ogs_assert(capacity);
 
     ogs_thread_mutex_init(&queue->one_big_mutex);
     ogs_thread_cond_init(&queue->not_empty);
     ogs_thread_cond_init(&queue->not_full);
 
-    queue->data = ogs_calloc(1, capacity * sizeof(void*));
-    if (!queue->data) {
-        ogs_error("ogs_calloc[capacity:%d, sizeof(void*):%d] failed",
-                (int)capacity, (int)sizeof(void*));
+    queue->cell = ogs_calloc(capacity, sizeof(ogs_queue_cell_t));
+    if (!queue->cell) {
+        ogs_error("ogs_calloc[capacity:%d, sizeof(cell):%d] failed",
+                (int)capacity, (int)sizeof(ogs_queue_cell_t));
+        ogs_thread_cond_destroy(&queue->not_empty);
+        ogs_thread_cond_destroy(&queue->not_full);
+        ogs_thread_mutex_destroy(&queue->one_big_mutex);
+        ogs_free(queue);
         return NULL;
     }
+    for (i = 0; i < capacity; i++)
+        queue->cell[i].seq = i;
+
     queue->bounds = capacity;
     queue->nelts = 0;
     queue->in = 0;
@@ -101,7 +122,7 @@ void ogs_queue_destroy(ogs_queue_t *queue)
 {
     ogs_assert(queue);
 
-    ogs_free(queue->data);
+    ogs_free(queue->cell);
 
     ogs_thread_cond_destroy(&queue->not_empty);
     ogs_thread_cond_destroy(&queue->not_full);
@@ -110,63 +131,210 @@ void ogs_queue_destroy(ogs_queue_t *queue)
     ogs_free(queue);
 }
 
-static int queue_push(ogs_queue_t *queue, void *data, ogs_time_t timeout)
+/*
+ * Wake up the consumer through the pollset's eventfd. Only the push
+ * that makes the queue non-empty notifies, since the consumer drains
+ * the queue until ogs_queue_trypop() fails (see also rearm()).
+ */
+void ogs_queue_set_notify(ogs_queue_t *queue, ogs_pollset_t *pollset)
 {
-    int rv;
+    ogs_assert(queue);
+    queue->pollset = pollset;
+}
 
-    if (queue->terminated) {
-        return OGS_DONE; /* no more elements ever again */
+static bool ring_push(ogs_queue_t *queue, void *data)
+{
+    ogs_queue_cell_t *cell;
+    uint64_t pos, seq;
+
+    pos = __atomic_load_n(&queue->in, __ATOMIC_RELAXED);
+    for ( ;; ) {
+        cell = &queue->cell[pos % queue->bounds];
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+
+        if (seq == pos) {
+            if (__atomic_compare_exchange_n(&queue->in, &pos, pos + 1,
+                        true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if ((int64_t)(seq - pos) < 0) {
+            return false; /* full */
+        } else {
+            pos = __atomic_load_n(&queue->in, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->data = data;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+static bool ring_pop(ogs_queue_t *queue, void **data)
+{
+    ogs_queue_cell_t *cell;
+    uint64_t pos, seq;
+
+    pos = __atomic_load_n(&queue->out, __ATOMIC_RELAXED);
+    for ( ;; ) {
+        cell = &queue->cell[pos % queue->bounds];
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+
+        if (seq == pos + 1) {
+            if (__atomic_compare_exchange_n(&queue->out, &pos, pos + 1,
+                        true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if ((int64_t)(seq - (pos + 1)) < 0) {
+            return false; /* empty */
+        } else {
+            pos = __atomic_load_n(&queue->out, __ATOMIC_RELAXED);
+        }
+    }
+
+    *data = cell->data;
+    __atomic_store_n(&cell->seq, pos + queue->bounds, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+static void wakeup(ogs_queue_t *queue,
+        unsigned int *waiters, ogs_thread_cond_t *cond)
+{
+    /* Pairs with the fence in the sleeping thread */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiters, __ATOMIC_RELAXED)) {
+        ogs_thread_mutex_lock(&queue->one_big_mutex);
+        ogs_thread_cond_signal(cond);
+        ogs_thread_mutex_unlock(&queue->one_big_mutex);
     }
+}
+
+static void pushed(ogs_queue_t *queue)
+{
+    int prev = __atomic_fetch_add(&queue->nelts, 1, __ATOMIC_SEQ_CST);
+
+    wakeup(queue, &queue->empty_waiters, &queue->not_empty);
+
+    if (prev == 0 && queue->pollset)
+        ogs_pollset_notify(queue->pollset);
+}
+
+static void popped(ogs_queue_t *queue, unsigned int num)
+{
+    ogs_prof_t *prof = NULL;
+    int depth = __atomic_fetch_sub(&queue->nelts, num, __ATOMIC_SEQ_CST);
+
+    wakeup(queue, &queue->full_waiters, &queue->not_full);
+
+    prof = ogs_prof_current();
+    if (prof && depth > 0 && (uint64_t)depth > prof->queue_depth_max)
+        __atomic_store_n(&prof->queue_depth_max, depth, __ATOMIC_RELAXED);
+}
+
+/*
+ * An item is counted only once it is published, but a producer that
+ * claimed an earlier cell may not have published yet. The consumer then
+ * finds the ring empty although later items were counted, and their
+ * producers did not notify. Wake the loop again so it retries.
+ */
+static void rearm(ogs_queue_t *queue)
+{
+    if (queue->pollset &&
+        __atomic_load_n(&queue->nelts, __ATOMIC_SEQ_CST) > 0)
+        ogs_pollset_notify(queue->pollset);
+}
+
+/*
+ * Sleep until 'ready' succeeds. The waiter count is published before
+ * each attempt, so a thread changing the queue concurrently either
+ * sees the waiter and signals it under the mutex, or the attempt sees
+ * its change. Another thread may take the slot between the signal and
+ * the wakeup, so keep waiting until ogs_queue_interrupt_all() is called.
+ */
+static int queue_wait(ogs_queue_t *queue, unsigned int *waiters,
+        ogs_thread_cond_t *cond, ogs_time_t timeout,
+        bool (*ready)(ogs_queue_t *queue, void **data), void **data)
+{
+    int rv = OGS_OK;
+    unsigned int interrupts;
+    ogs_time_t deadline = 0;
+
+    if (timeout > 0)
+        deadline = ogs_get_monotonic_time() + timeout;
 
     ogs_thread_mutex_lock(&queue->one_big_mutex);
 
-    if (ogs_queue_full(queue)) {
-        if (!timeout) {
-            ogs_thread_mutex_unlock(&queue->one_big_mutex);
-            return OGS_RETRY;
+    __atomic_fetch_add(waiters, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    interrupts = queue->interrupts;
+    for ( ;; ) {
+        if (ready(queue, data)) {
+            rv = OGS_OK;
+            break;
         }
-        if (!queue->terminated) {
-            queue->full_waiters++;
-            if (timeout > 0) {
-                rv = ogs_thread_cond_timedwait(&queue->not_full,
-                                               &queue->one_big_mutex,
-                                               timeout);
-            }
-            else {
-                rv = ogs_thread_cond_wait(&queue->not_full,
-                                          &queue->one_big_mutex);
-            }
-            queue->full_waiters--;
-            if (rv != OGS_OK) {
-                ogs_thread_mutex_unlock(&queue->one_big_mutex);
-                return rv;
-            }
+
+        if (queue->terminated) {
+            rv = OGS_DONE; /* no more elements ever again */
+            break;
         }
-        /* If we wake up and it's still empty, then we were interrupted */
-        if (ogs_queue_full(queue)) {
-            ogs_warn("queue full (intr)");
-            ogs_thread_mutex_unlock(&queue->one_big_mutex);
-            if (queue->terminated) {
-                return OGS_DONE; /* no more elements ever again */
-            }
-            else {
-                return OGS_ERROR;
+
+        /* If we wake up and it's still not ready, we were interrupted */
+        if (interrupts != queue->interrupts) {
+            ogs_warn("queue %s (intr)", cond == &queue->not_full ?
+                    "full" : "empty");
+            rv = OGS_ERROR;
+            break;
+        }
+
+        if (timeout > 0) {
+            ogs_time_t remaining = deadline - ogs_get_monotonic_time();
+            if (remaining <= 0) {
+                rv = OGS_TIMEUP;
+                break;
             }
+            rv = ogs_thread_cond_timedwait(
+                    cond, &queue->one_big_mutex, remaining);
+        } else {
+            rv = ogs_thread_cond_wait(cond, &queue->one_big_mutex);
         }
+        if (rv != OGS_OK)
+            break;
+    }
+
+    __atomic_fetch_sub(waiters, 1, __ATOMIC_RELAXED);
+    ogs_thread_mutex_unlock(&queue->one_big_mutex);
+
+    return rv;
+}
+
+static bool ready_push(ogs_queue_t *queue, void **data)
+{
+    return ring_push(queue, *data);
+}
+
+static int queue_push(ogs_queue_t *queue, void *data, ogs_time_t timeout)
+{
+    int rv;
+
+    if (queue->terminated) {
+        return OGS_DONE; /* no more elements ever again */
     }
 
-    queue->data[queue->in] = data;
-    queue->in++;
-    if (queue->in >= queue->bounds)
-        queue->in -= queue->bounds;
-    queue->nelts++;
+    if (!ring_push(queue, data)) {
+        if (!timeout) {
+            __atomic_fetch_add(&queue->dropped, 1, __ATOMIC_RELAXED);
+            return OGS_RETRY;
+        }
 
-    if (queue->empty_waiters) {
-        ogs_trace("signal !empty");
-        ogs_thread_cond_signal(&queue->not_empty);
+        rv = queue_wait(queue, &queue->full_waiters, &queue->not_full,
+                timeout, ready_push, &data);
+        if (rv != OGS_OK) {
+            __atomic_fetch_add(&queue->dropped, 1, __ATOMIC_RELAXED);
+            return rv;
+        }
     }
 
-    ogs_thread_mutex_unlock(&queue->one_big_mutex);
+    pushed(queue);
     return OGS_OK;
 }
 
@@ -191,10 +359,15 @@ int ogs_queue_timedpush(ogs_queue_t *queue, void *data, ogs_time_t timeout)
 }
 
 /**
- * not thread safe
+ * The result is only a snapshot while other threads push or pop.
  */
 unsigned int ogs_queue_size(ogs_queue_t *queue) {
-    return queue->nelts;
+    int nelts = __atomic_load_n(&queue->nelts, __ATOMIC_RELAXED);
+    return nelts > 0 ? nelts : 0;
+}
+
+uint64_t ogs_queue_dropped(ogs_queue_t *queue) {
+    return __atomic_load_n(&queue->dropped, __ATOMIC_RELAXED);
 }
 
 /**
@@ -212,55 +385,20 @@ static int queue_pop(ogs_queue_t *queue, void **data, ogs_time_t timeout)
         return OGS_DONE; /* no more elements ever again */
     }
 
-    ogs_thread_mutex_lock(&queue->one_big_mutex);
-
-    /* Keep waiting until we wake up and find that the queue is not empty. */
-    if (ogs_queue_empty(queue)) {
+    if (!ring_pop(queue, data)) {
         if (!timeout) {
-            ogs_thread_mutex_unlock(&queue->one_big_mutex);
+            rearm(queue);
             return OGS_RETRY;
         }
-        if (!queue->terminated) {
-            queue->empty_waiters++;
-            if (timeout > 0) {
-                rv = ogs_thread_cond_timedwait(&queue->not_empty,
-                                               &queue->one_big_mutex,
-                                               timeout);
-            }
-            else {
-                rv = ogs_thread_cond_wait(&queue->not_empty,
-                                          &queue->one_big_mutex);
-            }
-            queue->empty_waiters--;
-            if (rv != OGS_OK) {
-                ogs_thread_mutex_unlock(&queue->one_big_mutex);
-                return rv;
-            }
-        }
-        /* If we wake up and it's still empty, then we were interrupted */
-        if (ogs_queue_empty(queue)) {
-            ogs_warn("queue empty (intr)");
-            ogs_thread_mutex_unlock(&queue->one_big_mutex);
-            if (queue->terminated) {
-                return OGS_DONE; /* no more elements ever again */
-            } else {
-                return OGS_ERROR;
-            }
-        }
-    } 
 
-    *data = queue->data[queue->out];
-    queue->nelts--;
-
-    queue->out++;
-    if (queue->out >= queue->bounds)
-        queue->out -= queue->bounds;
-    if (queue->full_waiters) {
-        ogs_trace("signal !full");
-        ogs_thread_cond_signal(&queue->not_full);
+        rv = queue_wait(queue, &queue->empty_waiters, &queue->not_empty,
+                timeout, ring_pop, data);
+        if (rv != OGS_OK) {
+            return rv;
+        }
     }
 
-    ogs_thread_mutex_unlock(&queue->one_big_mutex);
+    popped(queue, 1);
     return OGS_OK;
 }
 
@@ -279,11 +417,42 @@ int ogs_queue_timedpop(ogs_queue_t *queue, void **data, ogs_time_t timeout)
     return queue_pop(queue, data, timeout);
 }
 
+/**
+ * Retrieves up to '*num' items without blocking and stores the number
+ * retrieved in '*num'. Returns OGS_RETRY if the queue is empty.
+ */
+int ogs_queue_trypop_batch(ogs_queue_t *queue, void **data, unsigned int *num)
+{
+    unsigned int i;
+
+    ogs_assert(data);
+    ogs_assert(num);
+
+    if (queue->terminated) {
+        return OGS_DONE; /* no more elements ever again */
+    }
+
+    for (i = 0; i < *num; i++) {
+        if (!ring_pop(queue, &data[i]))
+            break;
+    }
+
+    *num = i;
+    if (!i) {
+        rearm(queue);
+        return OGS_RETRY;
+    }
+
+    popped(queue, i);
+    return OGS_OK;
+}
+
 int ogs_queue_interrupt_all(ogs_queue_t *queue)
 {
     ogs_debug("interrupt all");
     ogs_thread_mutex_lock(&queue->one_big_mutex);
 
+    queue->interrupts++;
     ogs_thread_cond_broadcast(&queue->not_empty);
     ogs_thread_cond_broadcast(&queue->not_full);
 
@@ -305,4 +474,3 @@ int ogs_queue_term(ogs_queue_t *queue)
 
     return ogs_queue_interrupt_all(queue);
 }
-
@@ -45,6 +45,8 @@ extern "C" {
 
 typedef struct ogs_queue_s ogs_queue_t;
 
+#define OGS_QUEUE_MAX_BATCH 32
+
 ogs_queue_t *ogs_queue_create(unsigned int capacity);
 void ogs_queue_destroy(ogs_queue_t *queue);
 
@@ -53,11 +55,15 @@ int ogs_queue_pop(ogs_queue_t *queue, void **data);
 
 int ogs_queue_trypush(ogs_queue_t *queue, void *data);
 int ogs_queue_trypop(ogs_queue_t *queue, void **data);
+int ogs_queue_trypop_batch(ogs_queue_t *queue, void **data, unsigned int *num);
 
 int ogs_queue_timedpush(ogs_queue_t *queue, void *data, ogs_time_t timeout);
 int ogs_queue_timedpop(ogs_queue_t *queue, void **data, ogs_time_t timeout);
 
 unsigned int ogs_queue_size(ogs_queue_t *queue);
+uint64_t ogs_queue_dropped(ogs_queue_t *queue);
+
+void ogs_queue_set_notify(ogs_queue_t *queue, ogs_pollset_t *pollset);
 
 int ogs_queue_interrupt_all(ogs_queue_t *queue);
 int ogs_queue_term(ogs_queue_t *queue);
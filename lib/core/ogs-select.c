@@ -41,6 +41,8 @@ const ogs_pollset_actions_t ogs_select_actions = {
     select_process,
 
     ogs_notify_pollset,
+
+    NULL, /* add_recv */
 };
 
 struct select_context_s {
@@ -194,7 +196,7 @@ static int select_process(ogs_pollset_t *pollset, ogs_time_t timeout)
         }
 
         if (when && poll->handler) {
-            poll->handler(when, poll->fd, poll->data);
+            ogs_poll_dispatch(poll, when);
         }
     }
     
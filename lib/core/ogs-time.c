@@ -272,6 +272,32 @@ ogs_time_t ogs_get_monotonic_time(void)
 #endif
 }
 
+#if defined(_WIN32)
+#define OGS_TIME_THREAD_LOCAL __declspec(thread)
+#else
+#define OGS_TIME_THREAD_LOCAL __thread
+#endif
+
+static OGS_TIME_THREAD_LOCAL ogs_time_t cached_time = 0;
+
+ogs_time_t ogs_time_cached(void)
+{
+    if (cached_time)
+        return cached_time;
+
+    return ogs_get_monotonic_time();
+}
+
+void ogs_time_cache_set(ogs_time_t time)
+{
+    cached_time = time;
+}
+
+ogs_time_t ogs_time_from_monotonic(ogs_time_t time)
+{
+    return ogs_time_now() - (ogs_get_monotonic_time() - time);
+}
+
 void ogs_localtime(time_t s, struct tm *tm)
 {
     ogs_assert(tm);
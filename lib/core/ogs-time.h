@@ -109,6 +109,19 @@ uint32_t ogs_time_to_ntp32(ogs_time_t time);
 
 /** @return number of microseconds since an arbitrary point */
 ogs_time_t ogs_get_monotonic_time(void);
+
+/*
+ * Per-thread cached monotonic clock. While a pollset is running on the
+ * thread, the loop refreshes it from the timestamps the profiler
+ * already takes: when the pollset wakes up, before each poll handler
+ * and before each outermost FSM dispatch. Hot paths of one iteration
+ * then share a reading without another system call.
+ * Without a running pollset, the clock is read directly.
+ */
+ogs_time_t ogs_time_cached(void);
+void ogs_time_cache_set(ogs_time_t time); /* 0 disables the cache */
+/** @return the GMT time of a monotonic timestamp */
+ogs_time_t ogs_time_from_monotonic(ogs_time_t time);
 /** @return the GMT offset in seconds */
 int ogs_timezone(void);
 
@@ -35,7 +35,7 @@ static void add_timer_node(
     ogs_assert(tree);
     ogs_assert(timer);
 
-    timer->timeout = ogs_get_monotonic_time() + duration;
+    timer->timeout = ogs_time_cached() + duration;
 
     new = &tree->root;
     while (*new) {
@@ -165,9 +165,11 @@ void ogs_timer_mgr_expire(ogs_timer_mgr_t *manager)
     ogs_time_t current;
     ogs_rbnode_t *rbnode;
     ogs_timer_t *this;
+    ogs_prof_t *prof = NULL;
     ogs_assert(manager);
 
-    current = ogs_get_monotonic_time();
+    current = ogs_time_cached();
+    prof = ogs_prof_current();
 
     ogs_rbtree_for_each(&manager->tree, rbnode) {
         this = ogs_rb_entry(rbnode, ogs_timer_t, rbnode);
@@ -175,6 +177,10 @@ void ogs_timer_mgr_expire(ogs_timer_mgr_t *manager)
         if (this->timeout > current)
             break;
 
+        if (prof)
+            ogs_prof_stat_add(&prof->timer_lag,
+                    (uint64_t)(current - this->timeout) * 1000);
+
         ogs_list_add(&list, &this->lnode);
     }
 
@@ -17,6 +17,8 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "core-config-private.h"
+
 #include "ogs-core.h"
 
 #undef OGS_LOG_DOMAIN
@@ -143,3 +145,58 @@ int ogs_udp_connect(ogs_sock_t *sock, ogs_sockaddr_t *sa_list)
 
     return OGS_OK;
 }
+
+#define OGS_UDP_MAX_MMSG 64
+
+int ogs_udp_sendmmsg(ogs_socket_t fd, ogs_pkbuf_t **pkbuf, int num,
+        int flags, const ogs_sockaddr_t *to)
+{
+    int sent = 0;
+#if HAVE_SENDMMSG
+    struct mmsghdr msg[OGS_UDP_MAX_MMSG];
+    struct iovec iov[OGS_UDP_MAX_MMSG];
+    socklen_t addrlen;
+    int i, n, rv;
+#endif
+
+    ogs_assert(fd != INVALID_SOCKET);
+    ogs_assert(pkbuf);
+    ogs_assert(to);
+
+#if HAVE_SENDMMSG
+    addrlen = ogs_sockaddr_len(to);
+    ogs_assert(addrlen);
+
+    while (sent < num) {
+        n = ogs_min(num - sent, OGS_UDP_MAX_MMSG);
+
+        memset(msg, 0, sizeof(msg[0]) * n);
+        for (i = 0; i < n; i++) {
+            ogs_assert(pkbuf[sent + i]);
+            iov[i].iov_base = pkbuf[sent + i]->data;
+            iov[i].iov_len = pkbuf[sent + i]->len;
+
+            msg[i].msg_hdr.msg_name = (void *)&to->sa;
+            msg[i].msg_hdr.msg_namelen = addrlen;
+            msg[i].msg_hdr.msg_iov = &iov[i];
+            msg[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        rv = sendmmsg(fd, msg, n, flags);
+        if (rv <= 0)
+            break;
+
+        /* On a short count, the next call reports the error */
+        sent += rv;
+    }
+#else
+    for (sent = 0; sent < num; sent++) {
+        ogs_assert(pkbuf[sent]);
+        if (ogs_sendto(fd, pkbuf[sent]->data, pkbuf[sent]->len,
+                    flags, to) != pkbuf[sent]->len)
+            break;
+    }
+#endif
+
+    return sent;
+}
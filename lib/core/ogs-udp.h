@@ -34,6 +34,15 @@ ogs_sock_t *ogs_udp_client(
         ogs_sockaddr_t *sa_list, ogs_sockopt_t *socket_option);
 int ogs_udp_connect(ogs_sock_t *sock, ogs_sockaddr_t *sa_list);
 
+/*
+ * Send each packet buffer as one datagram to the same peer, using
+ * sendmmsg(2) where available. Returns the number of datagrams sent;
+ * on a short count, ogs_socket_errno holds the error of the first
+ * datagram that was not sent.
+ */
+int ogs_udp_sendmmsg(ogs_socket_t fd, ogs_pkbuf_t **pkbuf, int num,
+        int flags, const ogs_sockaddr_t *to);
+
 #ifdef __cplusplus
 }
 #endif
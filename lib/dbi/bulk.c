@@ -0,0 +1,545 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <ctype.h>
+
+#include "ogs-dbi.h"
+
+static const char *csv_column_name[OGS_DBI_BULK_CSV_MAX_COLUMN] = {
+    "imsi", "k", "opc", "op", "amf", "msisdn",
+    "apn", "sst", "sd", "ipv4", "ipv6",
+};
+
+/*
+ * Splits a CSV line in place. A field may be quoted with '"', and a
+ * quote inside a quoted field is written as '""'.
+ */
+int ogs_dbi_bulk_csv_split(char *line, char **field, int max)
+{
+    char *src = line, *dst = line;
+    int n = 0;
+
+    while (n < max) {
+        field[n++] = dst;
+
+        while (*src == ' ' || *src == '\t')
+            src++;
+        if (*src == '"') {
+            src++;
+            while (*src) {
+                if (*src == '"' && src[1] == '"') {
+                    *dst++ = '"';
+                    src += 2;
+                } else if (*src == '"') {
+                    src++;
+                    break;
+                } else {
+                    *dst++ = *src++;
+                }
+            }
+        }
+        while (*src && *src != ',')
+            *dst++ = *src++;
+
+        if (*src != ',') {
+            *dst = 0;
+            break;
+        }
+        src++;
+        *dst++ = 0;
+    }
+
+    for (max = 0; max < n; max++)
+        field[max] = ogs_trimwhitespace(field[max]);
+
+    return n;
+}
+
+int ogs_dbi_bulk_csv_header(ogs_dbi_bulk_csv_t *csv, char *line)
+{
+    char *field[OGS_DBI_BULK_CSV_MAX_COLUMN*2];
+    int i, j, n;
+
+    for (i = 0; i < OGS_DBI_BULK_CSV_MAX_COLUMN; i++)
+        csv->column[i] = -1;
+
+    n = ogs_dbi_bulk_csv_split(line, field, OGS_ARRAY_SIZE(field));
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < OGS_DBI_BULK_CSV_MAX_COLUMN; j++) {
+            if (!strcasecmp(field[i], csv_column_name[j])) {
+                csv->column[j] = i;
+                break;
+            }
+        }
+        if (j == OGS_DBI_BULK_CSV_MAX_COLUMN)
+            ogs_warn("Unknown column [%s] ignored", field[i]);
+    }
+
+    if (csv->column[OGS_DBI_BULK_CSV_IMSI] < 0 ||
+        csv->column[OGS_DBI_BULK_CSV_K] < 0 ||
+        (csv->column[OGS_DBI_BULK_CSV_OPC] < 0 &&
+         csv->column[OGS_DBI_BULK_CSV_OP] < 0)) {
+        ogs_error("CSV header needs imsi, k and opc or op columns");
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
+static const char *csv_field(ogs_dbi_bulk_csv_t *csv,
+        char **field, int n, ogs_dbi_bulk_csv_column_e column)
+{
+    int i = csv->column[column];
+
+    if (i < 0 || i >= n || !*field[i])
+        return NULL;
+
+    return field[i];
+}
+
+static bool is_hex(const char *s, size_t len)
+{
+    size_t i;
+
+    if (strlen(s) != len)
+        return false;
+    for (i = 0; i < len; i++)
+        if (!isxdigit((unsigned char)s[i]))
+            return false;
+
+    return true;
+}
+
+static void append_ambr(bson_t *parent)
+{
+    bson_t ambr, child;
+
+    BSON_APPEND_DOCUMENT_BEGIN(parent, "ambr", &ambr);
+    BSON_APPEND_DOCUMENT_BEGIN(&ambr, "downlink", &child);
+    BSON_APPEND_INT32(&child, "value", 1000000000);
+    BSON_APPEND_INT32(&child, "unit", 0);
+    bson_append_document_end(&ambr, &child);
+    BSON_APPEND_DOCUMENT_BEGIN(&ambr, "uplink", &child);
+    BSON_APPEND_INT32(&child, "value", 1000000000);
+    BSON_APPEND_INT32(&child, "unit", 0);
+    bson_append_document_end(&ambr, &child);
+    bson_append_document_end(parent, &ambr);
+}
+
+/*
+ * Builds the same document as "open5gs-dbctl add", with one slice and
+ * one session.
+ */
+bson_t *ogs_dbi_bulk_csv_document(ogs_dbi_bulk_csv_t *csv,
+        char *line, char *errmsg, size_t errlen)
+{
+    char *field[OGS_DBI_BULK_CSV_MAX_COLUMN*2];
+    const char *imsi, *k, *opc, *op, *amf, *msisdn, *apn, *sst, *sd;
+    const char *ipv4, *ipv6;
+    bson_t *doc = NULL;
+    bson_t array, slice, session, child, arp;
+    bson_oid_t oid;
+    int n;
+
+    n = ogs_dbi_bulk_csv_split(line, field, OGS_ARRAY_SIZE(field));
+
+    imsi = csv_field(csv, field, n, OGS_DBI_BULK_CSV_IMSI);
+    k = csv_field(csv, field, n, OGS_DBI_BULK_CSV_K);
+    opc = csv_field(csv, field, n, OGS_DBI_BULK_CSV_OPC);
+    op = csv_field(csv, field, n, OGS_DBI_BULK_CSV_OP);
+    amf = csv_field(csv, field, n, OGS_DBI_BULK_CSV_AMF);
+    msisdn = csv_field(csv, field, n, OGS_DBI_BULK_CSV_MSISDN);
+    apn = csv_field(csv, field, n, OGS_DBI_BULK_CSV_APN);
+    sst = csv_field(csv, field, n, OGS_DBI_BULK_CSV_SST);
+    sd = csv_field(csv, field, n, OGS_DBI_BULK_CSV_SD);
+    ipv4 = csv_field(csv, field, n, OGS_DBI_BULK_CSV_IPV4);
+    ipv6 = csv_field(csv, field, n, OGS_DBI_BULK_CSV_IPV6);
+
+    if (!imsi || strlen(imsi) > OGS_MAX_IMSI_BCD_LEN) {
+        ogs_snprintf(errmsg, errlen, "Invalid imsi");
+        return NULL;
+    }
+    if (!k || !is_hex(k, OGS_KEY_LEN*2)) {
+        ogs_snprintf(errmsg, errlen, "Invalid k");
+        return NULL;
+    }
+    if (opc ? !is_hex(opc, OGS_KEY_LEN*2) :
+            (!op || !is_hex(op, OGS_KEY_LEN*2))) {
+        ogs_snprintf(errmsg, errlen, "Invalid opc/op");
+        return NULL;
+    }
+    if (amf && !is_hex(amf, OGS_AMF_LEN*2)) {
+        ogs_snprintf(errmsg, errlen, "Invalid amf");
+        return NULL;
+    }
+    if (sd && !is_hex(sd, 6)) {
+        ogs_snprintf(errmsg, errlen, "Invalid sd");
+        return NULL;
+    }
+
+    doc = bson_new();
+    ogs_assert(doc);
+
+    BSON_APPEND_INT32(doc, "schema_version", 1);
+    BSON_APPEND_UTF8(doc, "imsi", imsi);
+
+    BSON_APPEND_ARRAY_BEGIN(doc, "msisdn", &array);
+    if (msisdn) {
+        char *dup = ogs_strdup(msisdn), *saveptr = NULL, *p = NULL;
+        char key[16];
+        int i = 0;
+
+        ogs_assert(dup);
+        for (p = ogs_strtok_r(dup, ";", &saveptr); p;
+                p = ogs_strtok_r(NULL, ";", &saveptr)) {
+            p = ogs_trimwhitespace(p);
+            if (!*p)
+                continue;
+            ogs_snprintf(key, sizeof(key), "%d", i++);
+            BSON_APPEND_UTF8(&array, key, p);
+        }
+        ogs_free(dup);
+    }
+    bson_append_array_end(doc, &array);
+
+    BSON_APPEND_ARRAY_BEGIN(doc, "imeisv", &array);
+    bson_append_array_end(doc, &array);
+    BSON_APPEND_ARRAY_BEGIN(doc, "mme_host", &array);
+    bson_append_array_end(doc, &array);
+    BSON_APPEND_ARRAY_BEGIN(doc, "mm_realm", &array);
+    bson_append_array_end(doc, &array);
+    BSON_APPEND_ARRAY_BEGIN(doc, "purge_flag", &array);
+    bson_append_array_end(doc, &array);
+
+    BSON_APPEND_ARRAY_BEGIN(doc, "slice", &array);
+    BSON_APPEND_DOCUMENT_BEGIN(&array, "0", &slice);
+    BSON_APPEND_INT32(&slice, "sst", sst ? atoi(sst) : 1);
+    if (sd)
+        BSON_APPEND_UTF8(&slice, "sd", sd);
+    BSON_APPEND_BOOL(&slice, "default_indicator", true);
+
+    BSON_APPEND_ARRAY_BEGIN(&slice, "session", &child);
+    BSON_APPEND_DOCUMENT_BEGIN(&child, "0", &session);
+    BSON_APPEND_UTF8(&session, "name", apn ? apn : "internet");
+    BSON_APPEND_INT32(&session, "type", OGS_PDU_SESSION_TYPE_IPV4V6);
+    {
+        bson_t qos;
+
+        BSON_APPEND_DOCUMENT_BEGIN(&session, "qos", &qos);
+        BSON_APPEND_INT32(&qos, "index", 9);
+        BSON_APPEND_DOCUMENT_BEGIN(&qos, "arp", &arp);
+        BSON_APPEND_INT32(&arp, "priority_level", 8);
+        BSON_APPEND_INT32(&arp, "pre_emption_capability", 1);
+        BSON_APPEND_INT32(&arp, "pre_emption_vulnerability", 2);
+        bson_append_document_end(&qos, &arp);
+        bson_append_document_end(&session, &qos);
+    }
+    append_ambr(&session);
+    if (ipv4 || ipv6) {
+        bson_t ue;
+
+        BSON_APPEND_DOCUMENT_BEGIN(&session, "ue", &ue);
+        if (ipv4)
+            BSON_APPEND_UTF8(&ue, "ipv4", ipv4);
+        if (ipv6)
+            BSON_APPEND_UTF8(&ue, "ipv6", ipv6);
+        bson_append_document_end(&session, &ue);
+    }
+    {
+        bson_t pcc_rule;
+
+        BSON_APPEND_ARRAY_BEGIN(&session, "pcc_rule", &pcc_rule);
+        bson_append_array_end(&session, &pcc_rule);
+    }
+    bson_oid_init(&oid, NULL);
+    BSON_APPEND_OID(&session, "_id", &oid);
+    bson_append_document_end(&child, &session);
+    bson_append_array_end(&slice, &child);
+
+    bson_oid_init(&oid, NULL);
+    BSON_APPEND_OID(&slice, "_id", &oid);
+    bson_append_document_end(&array, &slice);
+    bson_append_array_end(doc, &array);
+
+    BSON_APPEND_DOCUMENT_BEGIN(doc, OGS_SECURITY_STRING, &child);
+    BSON_APPEND_UTF8(&child, OGS_K_STRING, k);
+    if (op)
+        BSON_APPEND_UTF8(&child, OGS_OP_STRING, op);
+    else
+        BSON_APPEND_NULL(&child, OGS_OP_STRING);
+    if (opc)
+        BSON_APPEND_UTF8(&child, OGS_OPC_STRING, opc);
+    else
+        BSON_APPEND_NULL(&child, OGS_OPC_STRING);
+    BSON_APPEND_UTF8(&child, OGS_AMF_STRING, amf ? amf : "8000");
+    bson_append_document_end(doc, &child);
+
+    append_ambr(doc);
+
+    BSON_APPEND_INT32(doc, "access_restriction_data", 32);
+    BSON_APPEND_INT32(doc, "network_access_mode", 0);
+    BSON_APPEND_INT32(doc, "subscriber_status", 0);
+    BSON_APPEND_INT32(doc, "operator_determined_barring", 0);
+    BSON_APPEND_INT32(doc, "subscribed_rau_tau_timer", 12);
+
+    return doc;
+}
+
+/*
+ * Every lookup in lib/dbi selects by "imsi", and the IMS lookups also by
+ * "msisdn". The imsi index has the name and options the WebUI schema
+ * gives it, so this is a no-op on a database provisioned through the
+ * WebUI.
+ */
+int ogs_dbi_subscriber_index_init(void)
+{
+    int rv = OGS_OK;
+    bson_t *command = NULL;
+    bson_t reply;
+    bson_error_t error;
+
+    ogs_assert(ogs_mongoc()->database);
+
+    command = BCON_NEW("createIndexes", BCON_UTF8("subscribers"),
+            "indexes", "[",
+                "{",
+                    "key", "{", "imsi", BCON_INT32(1), "}",
+                    "name", BCON_UTF8("imsi_1"),
+                    "unique", BCON_BOOL(true),
+                "}",
+                "{",
+                    "key", "{", "msisdn", BCON_INT32(1), "}",
+                    "name", BCON_UTF8("msisdn_1"),
+                "}",
+            "]");
+
+#if MONGOC_CHECK_VERSION(1, 5, 0)
+    if (!mongoc_database_write_command_with_opts(
+                ogs_mongoc()->database, command, NULL, &reply, &error)) {
+#else
+    if (!mongoc_database_command_simple(
+                ogs_mongoc()->database, command, NULL, &reply, &error)) {
+#endif
+        ogs_error("createIndexes failed: %s", error.message);
+        rv = OGS_ERROR;
+    }
+
+    bson_destroy(&reply);
+    bson_destroy(command);
+
+    return rv;
+}
+
+static int reply_int32(const bson_t *reply, const char *key)
+{
+    bson_iter_t iter;
+
+    if (bson_iter_init_find(&iter, reply, key) &&
+        BSON_ITER_HOLDS_INT32(&iter))
+        return bson_iter_int32(&iter);
+
+    return 0;
+}
+
+static void add_error(ogs_dbi_bulk_result_t *result,
+        int index, int code, const char *message)
+{
+    int i = result->num_of_error;
+
+    if (i >= OGS_DBI_BULK_MAX_ERROR)
+        return;
+
+    result->error[i].index = index;
+    result->error[i].code = code;
+    ogs_cpystrn(result->error[i].message, message,
+            sizeof(result->error[i].message));
+
+    result->num_of_error++;
+}
+
+/*
+ * The "index" of a write error is the position among the operations
+ * that were queued, op_index maps it back to the caller's batch.
+ */
+static void parse_write_errors(const bson_t *reply,
+        const int *op_index, int num_of_op, ogs_dbi_bulk_result_t *result)
+{
+    bson_iter_t iter, child1_iter, child2_iter;
+
+    if (!bson_iter_init_find(&iter, reply, "writeErrors") ||
+        !BSON_ITER_HOLDS_ARRAY(&iter))
+        return;
+
+    bson_iter_recurse(&iter, &child1_iter);
+    while (bson_iter_next(&child1_iter)) {
+        int index = -1, code = 0;
+        const char *message = "";
+
+        if (!BSON_ITER_HOLDS_DOCUMENT(&child1_iter))
+            continue;
+
+        bson_iter_recurse(&child1_iter, &child2_iter);
+        while (bson_iter_next(&child2_iter)) {
+            const char *key = bson_iter_key(&child2_iter);
+
+            if (!strcmp(key, "index") &&
+                BSON_ITER_HOLDS_INT32(&child2_iter)) {
+                index = bson_iter_int32(&child2_iter);
+            } else if (!strcmp(key, "code") &&
+                BSON_ITER_HOLDS_INT32(&child2_iter)) {
+                code = bson_iter_int32(&child2_iter);
+            } else if (!strcmp(key, "errmsg") &&
+                BSON_ITER_HOLDS_UTF8(&child2_iter)) {
+                message = bson_iter_utf8(&child2_iter, NULL);
+            }
+        }
+
+        if (index >= 0 && index < num_of_op)
+            index = op_index[index];
+        else
+            index = -1;
+
+        add_error(result, index, code, message);
+    }
+}
+
+/*
+ * Writes the documents as one unordered bulk operation, so a failing
+ * document does not stop the others. With upsert, a document replaces
+ * the subscriber with the same "imsi" or is inserted if there is none.
+ *
+ * A document without an "imsi" string is not written and counts as
+ * failed. The "_id" of a replacement is dropped, since the existing
+ * subscriber keeps its own and MongoDB refuses to change it.
+ */
+int ogs_dbi_subscriber_bulk_write(bson_t **document, int num,
+        bool upsert, ogs_dbi_bulk_result_t *result)
+{
+    mongoc_bulk_operation_t *bulk = NULL;
+    bson_t reply;
+    bson_error_t error;
+    bson_iter_t iter;
+    int *op_index = NULL;
+    int i, num_of_op = 0;
+
+    ogs_assert(document);
+    ogs_assert(num > 0);
+    ogs_assert(result);
+
+    memset(result, 0, sizeof(*result));
+
+    op_index = ogs_calloc(num, sizeof(op_index[0]));
+    ogs_assert(op_index);
+
+#if MONGOC_CHECK_VERSION(1, 9, 0)
+    {
+        bson_t *opts = BCON_NEW("ordered", BCON_BOOL(false));
+        bulk = mongoc_collection_create_bulk_operation_with_opts(
+                ogs_dbi_subscriber_collection(), opts);
+        bson_destroy(opts);
+    }
+#else
+    bulk = mongoc_collection_create_bulk_operation(
+            ogs_dbi_subscriber_collection(), false, NULL);
+#endif
+    ogs_assert(bulk);
+
+    for (i = 0; i < num; i++) {
+        const char *imsi = NULL;
+
+        ogs_assert(document[i]);
+
+        if (bson_iter_init_find(&iter, document[i], "imsi") &&
+            BSON_ITER_HOLDS_UTF8(&iter))
+            imsi = bson_iter_utf8(&iter, NULL);
+        if (!imsi || !*imsi) {
+            add_error(result, i, 0, "No imsi");
+            continue;
+        }
+
+        if (upsert) {
+            bson_t *query = NULL;
+            bson_t replacement;
+
+            query = BCON_NEW("imsi", BCON_UTF8(imsi));
+            ogs_assert(query);
+            bson_init(&replacement);
+            bson_copy_to_excluding_noinit(
+                    document[i], &replacement, "_id", NULL);
+#if MONGOC_CHECK_VERSION(1, 7, 0)
+            {
+                bson_t *opts = BCON_NEW("upsert", BCON_BOOL(true));
+                if (!mongoc_bulk_operation_replace_one_with_opts(
+                            bulk, query, &replacement, opts, &error)) {
+                    ogs_error("replace_one failed: %s", error.message);
+                    add_error(result, i, error.code, error.message);
+                    bson_destroy(opts);
+                    bson_destroy(&replacement);
+                    bson_destroy(query);
+                    continue;
+                }
+                bson_destroy(opts);
+            }
+#else
+            mongoc_bulk_operation_replace_one(
+                    bulk, query, &replacement, true);
+#endif
+            bson_destroy(&replacement);
+            bson_destroy(query);
+        } else {
+#if MONGOC_CHECK_VERSION(1, 7, 0)
+            if (!mongoc_bulk_operation_insert_with_opts(
+                        bulk, document[i], NULL, &error)) {
+                ogs_error("insert failed: %s", error.message);
+                add_error(result, i, error.code, error.message);
+                continue;
+            }
+#else
+            mongoc_bulk_operation_insert(bulk, document[i]);
+#endif
+        }
+
+        op_index[num_of_op++] = i;
+    }
+
+    /* mongoc refuses to execute an empty bulk operation */
+    if (num_of_op) {
+        if (!mongoc_bulk_operation_execute(bulk, &reply, &error))
+            ogs_cpystrn(result->message,
+                    error.message, sizeof(result->message));
+
+        result->inserted = reply_int32(&reply, "nInserted");
+        result->upserted = reply_int32(&reply, "nUpserted");
+        result->matched = reply_int32(&reply, "nMatched");
+        parse_write_errors(&reply, op_index, num_of_op, result);
+
+        bson_destroy(&reply);
+    }
+    result->failed =
+        num - result->inserted - result->upserted - result->matched;
+
+    /* Only report the batch-wide error if no document explains it */
+    if (result->num_of_error)
+        result->message[0] = 0;
+
+    mongoc_bulk_operation_destroy(bulk);
+    ogs_free(op_index);
+
+    return result->failed ? OGS_ERROR : OGS_OK;
+}
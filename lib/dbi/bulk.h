@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_DBI_INSIDE) && !defined(OGS_DBI_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_DBI_BULK_H
+#define OGS_DBI_BULK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OGS_DBI_BULK_MAX_ERROR 16
+#define OGS_DBI_BULK_MAX_MESSAGE_LEN 256
+
+typedef struct ogs_dbi_bulk_result_s {
+    int inserted;
+    int upserted;
+    int matched;
+    int failed;
+
+    /* The first write errors; index is the position in the batch */
+    int num_of_error;
+    struct {
+        int index;
+        int code;
+        char message[OGS_DBI_BULK_MAX_MESSAGE_LEN];
+    } error[OGS_DBI_BULK_MAX_ERROR];
+
+    /* Set when the batch could not be executed as a whole */
+    char message[OGS_DBI_BULK_MAX_MESSAGE_LEN];
+} ogs_dbi_bulk_result_t;
+
+typedef enum {
+    OGS_DBI_BULK_CSV_IMSI,
+    OGS_DBI_BULK_CSV_K,
+    OGS_DBI_BULK_CSV_OPC,
+    OGS_DBI_BULK_CSV_OP,
+    OGS_DBI_BULK_CSV_AMF,
+    OGS_DBI_BULK_CSV_MSISDN,
+    OGS_DBI_BULK_CSV_APN,
+    OGS_DBI_BULK_CSV_SST,
+    OGS_DBI_BULK_CSV_SD,
+    OGS_DBI_BULK_CSV_IPV4,
+    OGS_DBI_BULK_CSV_IPV6,
+
+    OGS_DBI_BULK_CSV_MAX_COLUMN,
+} ogs_dbi_bulk_csv_column_e;
+
+typedef struct ogs_dbi_bulk_csv_s {
+    /* Position of each known column, -1 if absent */
+    int column[OGS_DBI_BULK_CSV_MAX_COLUMN];
+} ogs_dbi_bulk_csv_t;
+
+int ogs_dbi_bulk_csv_split(char *line, char **field, int max);
+int ogs_dbi_bulk_csv_header(ogs_dbi_bulk_csv_t *csv, char *line);
+bson_t *ogs_dbi_bulk_csv_document(ogs_dbi_bulk_csv_t *csv,
+        char *line, char *errmsg, size_t errlen);
+
+int ogs_dbi_subscriber_index_init(void);
+
+int ogs_dbi_subscriber_bulk_write(bson_t **document, int num,
+        bool upsert, ogs_dbi_bulk_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_DBI_BULK_H */
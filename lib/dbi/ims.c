@@ -44,9 +44,9 @@ int ogs_dbi_msisdn_data(
             "]");
 #if MONGOC_CHECK_VERSION(1, 5, 0)
     cursor = mongoc_collection_find_with_opts(
-            ogs_mongoc()->collection.subscriber, query, NULL, NULL);
+            ogs_dbi_subscriber_collection(), query, NULL, NULL);
 #else
-    cursor = mongoc_collection_find(ogs_mongoc()->collection.subscriber,
+    cursor = mongoc_collection_find(ogs_dbi_subscriber_collection(),
             MONGOC_QUERY_NONE, 0, 0, 0, query, NULL, NULL);
 #endif
 
@@ -140,9 +140,9 @@ int ogs_dbi_ims_data(char *supi, ogs_ims_data_t *ims_data)
     query = BCON_NEW(supi_type, BCON_UTF8(supi_id));
 #if MONGOC_CHECK_VERSION(1, 5, 0)
     cursor = mongoc_collection_find_with_opts(
-            ogs_mongoc()->collection.subscriber, query, NULL, NULL);
+            ogs_dbi_subscriber_collection(), query, NULL, NULL);
 #else
-    cursor = mongoc_collection_find(ogs_mongoc()->collection.subscriber,
+    cursor = mongoc_collection_find(ogs_dbi_subscriber_collection(),
             MONGOC_QUERY_NONE, 0, 0, 0, query, NULL, NULL);
 #endif
 
@@ -25,6 +25,31 @@ int __ogs_dbi_domain;
 
 static ogs_mongoc_t self;
 
+#if defined(_WIN32)
+#define OGS_DBI_THREAD_LOCAL __declspec(thread)
+#else
+#define OGS_DBI_THREAD_LOCAL __thread
+#endif
+
+/*
+ * A mongoc_client_t must not be used by two threads at once. Each
+ * thread that touches the database (e.g. the freeDiameter workers of
+ * the HSS) checks its own client out of the pool on first use and keeps
+ * it, so DB calls from different threads run in parallel. All of them
+ * are returned to the pool in ogs_dbi_final().
+ */
+typedef struct ogs_dbi_thread_s {
+    ogs_lnode_t lnode;
+    mongoc_client_t *client;
+    mongoc_collection_t *subscriber;
+} ogs_dbi_thread_t;
+
+static OGS_DBI_THREAD_LOCAL ogs_dbi_thread_t *current_thread = NULL;
+static OGS_DBI_THREAD_LOCAL unsigned int current_generation = 0;
+static ogs_list_t thread_list;
+static ogs_thread_mutex_t thread_lock;
+static unsigned int generation;
+
 /*
  * We've added it 
  * Because the following function is deprecated in the mongo-c-driver
@@ -108,6 +133,15 @@ int ogs_mongoc_init(const char *db_uri)
     mongoc_client_set_error_api(self.client, 2);
 #endif
 
+    self.uri = mongoc_uri_new(db_uri);
+    ogs_assert(self.uri);
+    self.pool = mongoc_client_pool_new(self.uri);
+    ogs_assert(self.pool);
+
+#if MONGOC_CHECK_VERSION(1, 4, 0)
+    mongoc_client_pool_set_error_api(self.pool, 2);
+#endif
+
     uri = mongoc_client_get_uri(self.client);
     ogs_assert(uri);
 
@@ -142,6 +176,14 @@ void ogs_mongoc_final(void)
         mongoc_client_destroy(self.client);
         self.client = NULL;
     }
+    if (self.pool) {
+        mongoc_client_pool_destroy(self.pool);
+        self.pool = NULL;
+    }
+    if (self.uri) {
+        mongoc_uri_destroy(self.uri);
+        self.uri = NULL;
+    }
     if (self.masked_db_uri) {
         ogs_free(self.masked_db_uri);
         self.masked_db_uri = NULL;
@@ -164,6 +206,10 @@ int ogs_dbi_init(const char *db_uri)
 
     ogs_assert(db_uri);
 
+    ogs_list_init(&thread_list);
+    ogs_thread_mutex_init(&thread_lock);
+    generation++;
+
     rv = ogs_mongoc_init(db_uri);
     if (rv != OGS_OK) return rv;
 
@@ -178,6 +224,17 @@ int ogs_dbi_init(const char *db_uri)
 
 void ogs_dbi_final(void)
 {
+    ogs_dbi_thread_t *thread = NULL, *next_thread = NULL;
+
+    ogs_list_for_each_safe(&thread_list, next_thread, thread) {
+        ogs_list_remove(&thread_list, thread);
+        mongoc_collection_destroy(thread->subscriber);
+        mongoc_client_pool_push(self.pool, thread->client);
+        ogs_free(thread);
+    }
+    current_thread = NULL;
+    ogs_thread_mutex_destroy(&thread_lock);
+
     if (self.collection.subscriber) {
         mongoc_collection_destroy(self.collection.subscriber);
     }
@@ -191,6 +248,38 @@ void ogs_dbi_final(void)
     ogs_mongoc_final();
 }
 
+mongoc_collection_t *ogs_dbi_subscriber_collection(void)
+{
+    ogs_dbi_thread_t *thread = current_thread;
+
+    if (!self.pool)
+        return self.collection.subscriber;
+
+    /* Already freed by an ogs_dbi_final() since the thread got it */
+    if (current_generation != generation)
+        thread = NULL;
+
+    if (!thread) {
+        thread = ogs_calloc(1, sizeof(*thread));
+        ogs_assert(thread);
+
+        thread->client = mongoc_client_pool_pop(self.pool);
+        ogs_assert(thread->client);
+        thread->subscriber = mongoc_client_get_collection(
+                thread->client, self.name, "subscribers");
+        ogs_assert(thread->subscriber);
+
+        ogs_thread_mutex_lock(&thread_lock);
+        ogs_list_add(&thread_list, thread);
+        ogs_thread_mutex_unlock(&thread_lock);
+
+        current_thread = thread;
+        current_generation = generation;
+    }
+
+    return thread->subscriber;
+}
+
 int ogs_dbi_collection_watch_init(void)
 {
 #if MONGOC_CHECK_VERSION(1, 9, 0)
@@ -35,6 +35,7 @@ typedef struct ogs_mongoc_s {
     const char *name;
     void *uri;
     void *client;
+    void *pool;             /* Clients for threads other than the loop */
     void *database;
 
 #if MONGOC_CHECK_VERSION(1, 9, 0)
@@ -55,6 +56,8 @@ ogs_mongoc_t *ogs_mongoc(void);
 int ogs_dbi_init(const char *db_uri);
 void ogs_dbi_final(void);
 
+mongoc_collection_t *ogs_dbi_subscriber_collection(void);
+
 int ogs_dbi_collection_watch_init(void);
 int ogs_dbi_poll_change_stream(void);
 
@@ -19,6 +19,50 @@
 
 #include "ogs-dbi.h"
 
+static void parse_auth_info(bson_iter_t *iter, ogs_dbi_auth_info_t *auth_info)
+{
+    bson_iter_t inner_iter;
+    char buf[OGS_KEY_LEN];
+    char *utf8 = NULL;
+    uint32_t length = 0;
+
+    memset(auth_info, 0, sizeof(ogs_dbi_auth_info_t));
+    bson_iter_recurse(iter, &inner_iter);
+    while (bson_iter_next(&inner_iter)) {
+        const char *key = bson_iter_key(&inner_iter);
+
+        if (!strcmp(key, OGS_K_STRING) && BSON_ITER_HOLDS_UTF8(&inner_iter)) {
+            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
+            ogs_ascii_to_hex(utf8, length, buf, sizeof(buf));
+            memcpy(auth_info->k, buf, OGS_KEY_LEN);
+        } else if (!strcmp(key, OGS_OPC_STRING) &&
+                BSON_ITER_HOLDS_UTF8(&inner_iter)) {
+            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
+            auth_info->use_opc = 1;
+            ogs_ascii_to_hex(utf8, length, buf, sizeof(buf));
+            memcpy(auth_info->opc, buf, OGS_KEY_LEN);
+        } else if (!strcmp(key, OGS_OP_STRING) &&
+                BSON_ITER_HOLDS_UTF8(&inner_iter)) {
+            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
+            ogs_ascii_to_hex(utf8, length, buf, sizeof(buf));
+            memcpy(auth_info->op, buf, OGS_KEY_LEN);
+        } else if (!strcmp(key, OGS_AMF_STRING) &&
+                BSON_ITER_HOLDS_UTF8(&inner_iter)) {
+            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
+            ogs_ascii_to_hex(utf8, length, buf, sizeof(buf));
+            memcpy(auth_info->amf, buf, OGS_AMF_LEN);
+        } else if (!strcmp(key, OGS_RAND_STRING) &&
+                BSON_ITER_HOLDS_UTF8(&inner_iter)) {
+            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
+            ogs_ascii_to_hex(utf8, length, buf, sizeof(buf));
+            memcpy(auth_info->rand, buf, OGS_RAND_LEN);
+        } else if (!strcmp(key, OGS_SQN_STRING) &&
+                BSON_ITER_HOLDS_INT64(&inner_iter)) {
+            auth_info->sqn = bson_iter_int64(&inner_iter);
+        }
+    }
+}
+
 int ogs_dbi_auth_info(char *supi, ogs_dbi_auth_info_t *auth_info)
 {
     int rv = OGS_OK;
@@ -27,10 +71,6 @@ int ogs_dbi_auth_info(char *supi, ogs_dbi_auth_info_t *auth_info)
     bson_error_t error;
     const bson_t *document;
     bson_iter_t iter;
-    bson_iter_t inner_iter;
-    char buf[OGS_KEY_LEN];
-    char *utf8 = NULL;
-    uint32_t length = 0;
 
     char *supi_type = NULL;
     char *supi_id = NULL;
@@ -46,9 +86,9 @@ int ogs_dbi_auth_info(char *supi, ogs_dbi_auth_info_t *auth_info)
     query = BCON_NEW(supi_type, BCON_UTF8(supi_id));
 #if MONGOC_CHECK_VERSION(1, 5, 0)
     cursor = mongoc_collection_find_with_opts(
-            ogs_mongoc()->collection.subscriber, query, NULL, NULL);
+            ogs_dbi_subscriber_collection(), query, NULL, NULL);
 #else
-    cursor = mongoc_collection_find(ogs_mongoc()->collection.subscriber,
+    cursor = mongoc_collection_find(ogs_dbi_subscriber_collection(),
             MONGOC_QUERY_NONE, 0, 0, 0, query, NULL, NULL);
 #endif
 
@@ -73,41 +113,7 @@ int ogs_dbi_auth_info(char *supi, ogs_dbi_auth_info_t *auth_info)
         goto out;
     }
 
-    memset(auth_info, 0, sizeof(ogs_dbi_auth_info_t));
-    bson_iter_recurse(&iter, &inner_iter);
-    while (bson_iter_next(&inner_iter)) {
-        const char *key = bson_iter_key(&inner_iter);
-
-        if (!strcmp(key, OGS_K_STRING) && BSON_ITER_HOLDS_UTF8(&inner_iter)) {
-            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
-            ogs_ascii_to_hex(utf8, length, buf, sizeof(buf));
-            memcpy(auth_info->k, buf, OGS_KEY_LEN);
-        } else if (!strcmp(key, OGS_OPC_STRING) &&
-                BSON_ITER_HOLDS_UTF8(&inner_iter)) {
-            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
-            auth_info->use_opc = 1;
-            ogs_ascii_to_hex(utf8, length, buf, sizeof(buf));
-            memcpy(auth_info->opc, buf, OGS_KEY_LEN);
-        } else if (!strcmp(key, OGS_OP_STRING) &&
-                BSON_ITER_HOLDS_UTF8(&inner_iter)) {
-            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
-            ogs_ascii_to_hex(utf8, length, buf, sizeof(buf));
-            memcpy(auth_info->op, buf, OGS_KEY_LEN);
-        } else if (!strcmp(key, OGS_AMF_STRING) &&
-                BSON_ITER_HOLDS_UTF8(&inner_iter)) {
-            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
-            ogs_ascii_to_hex(utf8, length, buf, sizeof(buf));
-            memcpy(auth_info->amf, buf, OGS_AMF_LEN);
-        } else if (!strcmp(key, OGS_RAND_STRING) &&
-                BSON_ITER_HOLDS_UTF8(&inner_iter)) {
-            utf8 = (char *)bson_iter_utf8(&inner_iter, &length);
-            ogs_ascii_to_hex(utf8, length, buf, sizeof(buf));
-            memcpy(auth_info->rand, buf, OGS_RAND_LEN);
-        } else if (!strcmp(key, OGS_SQN_STRING) &&
-                BSON_ITER_HOLDS_INT64(&inner_iter)) {
-            auth_info->sqn = bson_iter_int64(&inner_iter);
-        }
-    }
+    parse_auth_info(&iter, auth_info);
 
 out:
     if (query) bson_destroy(query);
@@ -119,38 +125,131 @@ out:
     return rv;
 }
 
-int ogs_dbi_update_sqn(char *supi, uint64_t sqn)
+/*
+ * Reads the authentication data and advances the stored SQN by 32 in one
+ * findAndModify round trip. auth_info->sqn is the value from before the
+ * advance, i.e. the one the new vector is generated with.
+ *
+ * The SQN is 48 bits wide. With mongo-c-driver 1.16 or later the update
+ * is an aggregation pipeline (MongoDB 4.2) that wraps it in the same
+ * atomic step. Older drivers can only $inc; the writer whose increment
+ * crossed the limit then wraps the value with a compare-and-set, which
+ * fails harmlessly if another AIR has advanced it in the meantime.
+ */
+int ogs_dbi_auth_info_increment_sqn(char *supi, ogs_dbi_auth_info_t *auth_info)
 {
     int rv = OGS_OK;
     bson_t *query = NULL;
     bson_t *update = NULL;
+    bson_t *fields = NULL;
+    bson_t reply;
+    bson_t document;
     bson_error_t error;
+    bson_iter_t iter;
+    const uint8_t *data = NULL;
+    uint32_t length = 0;
 
     char *supi_type = NULL;
     char *supi_id = NULL;
 
     ogs_assert(supi);
+    ogs_assert(auth_info);
 
     supi_type = ogs_id_get_type(supi);
     ogs_assert(supi_type);
     supi_id = ogs_id_get_value(supi);
     ogs_assert(supi_id);
 
+    bson_init(&reply);
+
     query = BCON_NEW(supi_type, BCON_UTF8(supi_id));
-    update = BCON_NEW("$set",
+#if MONGOC_CHECK_VERSION(1, 16, 0)
+    update = BCON_NEW("0", "{",
+            "$set", "{",
+                OGS_SECURITY_STRING "." OGS_SQN_STRING, "{",
+                    "$mod", "[",
+                        "{",
+                            "$add", "[",
+                                BCON_UTF8("$" OGS_SECURITY_STRING
+                                        "." OGS_SQN_STRING),
+                                BCON_INT64(32),
+                            "]",
+                        "}",
+                        BCON_INT64(OGS_MAX_SQN + 1),
+                    "]",
+                "}",
+            "}",
+        "}");
+#else
+    update = BCON_NEW("$inc",
             "{",
-                OGS_SECURITY_STRING "." OGS_SQN_STRING, BCON_INT64(sqn),
+                OGS_SECURITY_STRING "." OGS_SQN_STRING, BCON_INT64(32),
             "}");
+#endif
+    fields = BCON_NEW(OGS_SECURITY_STRING, BCON_INT32(1));
 
-    if (!mongoc_collection_update(ogs_mongoc()->collection.subscriber,
-            MONGOC_UPDATE_NONE, query, update, NULL, &error)) {
-        ogs_error("mongoc_collection_update() failure: %s", error.message);
+    if (!mongoc_collection_find_and_modify(ogs_dbi_subscriber_collection(),
+            query, NULL, update, fields, false, false, false,
+            &reply, &error)) {
+        ogs_error("mongoc_collection_find_and_modify() failure: %s",
+                error.message);
+
+        rv = OGS_ERROR;
+        goto out;
+    }
+
+    /* 'value' is null if no document matched */
+    if (!bson_iter_init_find(&iter, &reply, "value") ||
+        !BSON_ITER_HOLDS_DOCUMENT(&iter)) {
+        ogs_info("[%s] Cannot find IMSI in DB", supi);
+
+        rv = OGS_ERROR;
+        goto out;
+    }
+
+    bson_iter_document(&iter, &length, &data);
+    if (!bson_init_static(&document, data, length) ||
+        !bson_iter_init_find(&iter, &document, OGS_SECURITY_STRING)) {
+        ogs_error("No '" OGS_SECURITY_STRING "' field in this document");
 
         rv = OGS_ERROR;
+        goto out;
     }
 
+    parse_auth_info(&iter, auth_info);
+
+#if !MONGOC_CHECK_VERSION(1, 16, 0)
+    if (auth_info->sqn + 32 > OGS_MAX_SQN) {
+        bson_destroy(query);
+        query = BCON_NEW(supi_type, BCON_UTF8(supi_id),
+                OGS_SECURITY_STRING "." OGS_SQN_STRING,
+                    BCON_INT64(auth_info->sqn + 32));
+        bson_destroy(update);
+        update = BCON_NEW("$set",
+                "{",
+                    OGS_SECURITY_STRING "." OGS_SQN_STRING,
+                        BCON_INT64((auth_info->sqn + 32) & OGS_MAX_SQN),
+                "}");
+
+        if (!mongoc_collection_update(ogs_dbi_subscriber_collection(),
+                MONGOC_UPDATE_NONE, query, update, NULL, &error)) {
+            ogs_error("mongoc_collection_update() failure: %s",
+                    error.message);
+
+            rv = OGS_ERROR;
+            goto out;
+        }
+
+        /* A previous writer may have crossed the limit without wrapping */
+        auth_info->sqn &= OGS_MAX_SQN;
+    }
+#endif
+
+out:
     if (query) bson_destroy(query);
     if (update) bson_destroy(update);
+    if (fields) bson_destroy(fields);
+    bson_destroy(&reply);
 
     ogs_free(supi_type);
     ogs_free(supi_id);
@@ -158,7 +257,12 @@ int ogs_dbi_update_sqn(char *supi, uint64_t sqn)
     return rv;
 }
 
-int ogs_dbi_update_imeisv(char *supi, char *imeisv)
+/*
+ * Used for re-synchronization, once AUTS has been verified. The SQN is
+ * set as is: it may go back when the stored one ran ahead of SQN_MS, or
+ * wrap past OGS_MAX_SQN, and the next vector must still be accepted.
+ */
+int ogs_dbi_update_sqn(char *supi, uint64_t sqn)
 {
     int rv = OGS_OK;
     bson_t *query = NULL;
@@ -175,16 +279,14 @@ int ogs_dbi_update_imeisv(char *supi, char *imeisv)
     supi_id = ogs_id_get_value(supi);
     ogs_assert(supi_id);
 
-    ogs_debug("SUPI type: %s, SUPI id: %s, imeisv: %s",
-            supi_type, supi_id, imeisv);
-
     query = BCON_NEW(supi_type, BCON_UTF8(supi_id));
     update = BCON_NEW("$set",
             "{",
-                OGS_IMEISV_STRING, BCON_UTF8(imeisv),
+                OGS_SECURITY_STRING "." OGS_SQN_STRING, BCON_INT64(sqn),
             "}");
-    if (!mongoc_collection_update(ogs_mongoc()->collection.subscriber,
-            MONGOC_UPDATE_UPSERT, query, update, NULL, &error)) {
+
+    if (!mongoc_collection_update(ogs_dbi_subscriber_collection(),
+            MONGOC_UPDATE_NONE, query, update, NULL, &error)) {
         ogs_error("mongoc_collection_update() failure: %s", error.message);
 
         rv = OGS_ERROR;
@@ -199,8 +301,7 @@ int ogs_dbi_update_imeisv(char *supi, char *imeisv)
     return rv;
 }
 
-int ogs_dbi_update_mme(char *supi, char *mme_host, char *mme_realm,
-    bool purge_flag)
+int ogs_dbi_update_imeisv(char *supi, char *imeisv)
 {
     int rv = OGS_OK;
     bson_t *query = NULL;
@@ -217,18 +318,15 @@ int ogs_dbi_update_mme(char *supi, char *mme_host, char *mme_realm,
     supi_id = ogs_id_get_value(supi);
     ogs_assert(supi_id);
 
-    ogs_debug("SUPI type: %s, SUPI id: %s, mme_host: %s, mme_realm: %s",
-            supi_type, supi_id, mme_host, mme_realm);
+    ogs_debug("SUPI type: %s, SUPI id: %s, imeisv: %s",
+            supi_type, supi_id, imeisv);
 
     query = BCON_NEW(supi_type, BCON_UTF8(supi_id));
     update = BCON_NEW("$set",
             "{",
-                OGS_MME_HOST_STRING, BCON_UTF8(mme_host),
-                OGS_MME_REALM_STRING, BCON_UTF8(mme_realm),
-                OGS_MME_TIMESTAMP_STRING, BCON_INT64(ogs_time_now()),
-                OGS_PURGE_FLAG_STRING, BCON_BOOL(purge_flag),
+                OGS_IMEISV_STRING, BCON_UTF8(imeisv),
             "}");
-    if (!mongoc_collection_update(ogs_mongoc()->collection.subscriber,
+    if (!mongoc_collection_update(ogs_dbi_subscriber_collection(),
             MONGOC_UPDATE_UPSERT, query, update, NULL, &error)) {
         ogs_error("mongoc_collection_update() failure: %s", error.message);
 
@@ -244,13 +342,13 @@ int ogs_dbi_update_mme(char *supi, char *mme_host, char *mme_realm,
     return rv;
 }
 
-int ogs_dbi_increment_sqn(char *supi)
+int ogs_dbi_update_mme(char *supi, char *mme_host, char *mme_realm,
+    bool purge_flag)
 {
     int rv = OGS_OK;
     bson_t *query = NULL;
     bson_t *update = NULL;
     bson_error_t error;
-    uint64_t max_sqn = OGS_MAX_SQN;
 
     char *supi_type = NULL;
     char *supi_id = NULL;
@@ -262,33 +360,24 @@ int ogs_dbi_increment_sqn(char *supi)
     supi_id = ogs_id_get_value(supi);
     ogs_assert(supi_id);
 
-    query = BCON_NEW(supi_type, BCON_UTF8(supi_id));
-    update = BCON_NEW("$inc",
-            "{",
-                OGS_SECURITY_STRING "." OGS_SQN_STRING, BCON_INT64(32),
-            "}");
-    if (!mongoc_collection_update(ogs_mongoc()->collection.subscriber,
-            MONGOC_UPDATE_NONE, query, update, NULL, &error)) {
-        ogs_error("mongoc_collection_update() failure: %s", error.message);
-
-        rv = OGS_ERROR;
-        goto out;
-    }
-    bson_destroy(update);
+    ogs_debug("SUPI type: %s, SUPI id: %s, mme_host: %s, mme_realm: %s",
+            supi_type, supi_id, mme_host, mme_realm);
 
-    update = BCON_NEW("$bit",
+    query = BCON_NEW(supi_type, BCON_UTF8(supi_id));
+    update = BCON_NEW("$set",
             "{",
-                OGS_SECURITY_STRING "." OGS_SQN_STRING,
-                "{", "and", BCON_INT64(max_sqn), "}",
+                OGS_MME_HOST_STRING, BCON_UTF8(mme_host),
+                OGS_MME_REALM_STRING, BCON_UTF8(mme_realm),
+                OGS_MME_TIMESTAMP_STRING, BCON_INT64(ogs_time_now()),
+                OGS_PURGE_FLAG_STRING, BCON_BOOL(purge_flag),
             "}");
-    if (!mongoc_collection_update(ogs_mongoc()->collection.subscriber,
-            MONGOC_UPDATE_NONE, query, update, NULL, &error)) {
+    if (!mongoc_collection_update(ogs_dbi_subscriber_collection(),
+            MONGOC_UPDATE_UPSERT, query, update, NULL, &error)) {
         ogs_error("mongoc_collection_update() failure: %s", error.message);
 
         rv = OGS_ERROR;
     }
 
-out:
     if (query) bson_destroy(query);
     if (update) bson_destroy(update);
 
@@ -328,9 +417,9 @@ int ogs_dbi_subscription_data(char *supi,
     query = BCON_NEW(supi_type, BCON_UTF8(supi_id));
 #if MONGOC_CHECK_VERSION(1, 5, 0)
     cursor = mongoc_collection_find_with_opts(
-            ogs_mongoc()->collection.subscriber, query, NULL, NULL);
+            ogs_dbi_subscriber_collection(), query, NULL, NULL);
 #else
-    cursor = mongoc_collection_find(ogs_mongoc()->collection.subscriber,
+    cursor = mongoc_collection_find(ogs_dbi_subscriber_collection(),
             MONGOC_QUERY_NONE, 0, 0, 0, query, NULL, NULL);
 #endif
 
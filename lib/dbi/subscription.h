@@ -39,8 +39,8 @@ typedef struct ogs_dbi_auth_info_s {
 } ogs_dbi_auth_info_t;
 
 int ogs_dbi_auth_info(char *supi, ogs_dbi_auth_info_t *auth_info);
+int ogs_dbi_auth_info_increment_sqn(char *supi, ogs_dbi_auth_info_t *auth_info);
 int ogs_dbi_update_sqn(char *supi, uint64_t sqn);
-int ogs_dbi_increment_sqn(char *supi);
 int ogs_dbi_update_imeisv(char *supi, char *imeisv);
 int ogs_dbi_update_mme(char *supi, char *mme_host, char *mme_realm,
     bool purge_flag);
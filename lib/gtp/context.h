@@ -76,6 +76,14 @@ typedef struct ogs_gtp_node_s {
 
     ogs_list_t      local_list;
     ogs_list_t      remote_list;
+
+    struct {
+        uint32_t    local;          /* Outstanding local transactions */
+        uint32_t    remote;         /* Holding remote transactions */
+        uint64_t    retransmitted;  /* Requests retransmitted on T3 expiry */
+        uint64_t    duplicated;     /* Duplicated requests received */
+    } xact_stats;
+    void            *metrics;       /* Per-peer metrics, set by the app */
 } ogs_gtp_node_t;
 
 typedef struct ogs_gtpu_resource_s {
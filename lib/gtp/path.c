@@ -129,6 +129,35 @@ int ogs_gtp_sendto(ogs_gtp_node_t *gnode, ogs_pkbuf_t *pkbuf)
     return OGS_OK;
 }
 
+int ogs_gtp_sendto_batch(ogs_gtp_node_t *gnode, ogs_pkbuf_t **pkbuf, int num)
+{
+    int sent;
+    ogs_sock_t *sock = NULL;
+    ogs_sockaddr_t *addr = NULL;
+
+    ogs_assert(gnode);
+    ogs_assert(pkbuf);
+    sock = gnode->sock;
+    ogs_assert(sock);
+    addr = &gnode->addr;
+    ogs_assert(addr);
+
+    sent = ogs_udp_sendmmsg(sock->fd, pkbuf, num, 0, addr);
+    if (sent != num) {
+        if (ogs_socket_errno != OGS_EAGAIN) {
+            char buf[OGS_ADDRSTRLEN];
+            int err = ogs_socket_errno;
+            ogs_log_message(OGS_LOG_ERROR, err,
+                    "ogs_gtp_sendto_batch(%u, %d/%d, %s:%u) failed",
+                    sock->fd, sent, num,
+                    OGS_ADDR(addr, buf), OGS_PORT(addr));
+        }
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
 void ogs_gtp_send_error_message(
         ogs_gtp_xact_t *xact, uint32_t teid, uint8_t type, uint8_t cause_value)
 {
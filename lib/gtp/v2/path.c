@@ -19,13 +19,10 @@
 
 #include "ogs-gtp.h"
 
-int ogs_gtp2_send_user_plane(
-        ogs_gtp_node_t *gnode,
-        ogs_gtp2_header_desc_t *header_desc,
-        ogs_pkbuf_t *pkbuf)
+static void fill_header(
+        ogs_gtp2_header_desc_t *header_desc, ogs_pkbuf_t *pkbuf)
 {
-    char buf[OGS_ADDRSTRLEN];
-    int rv, i;
+    int i;
 
     ogs_gtp2_header_t gtp_hdesc;
     ogs_gtp2_extension_header_t ext_hdesc;
@@ -66,6 +63,19 @@ int ogs_gtp2_send_user_plane(
     }
 
     ogs_gtp2_fill_header(&gtp_hdesc, &ext_hdesc, pkbuf);
+}
+
+int ogs_gtp2_send_user_plane(
+        ogs_gtp_node_t *gnode,
+        ogs_gtp2_header_desc_t *header_desc,
+        ogs_pkbuf_t *pkbuf)
+{
+    char buf[OGS_ADDRSTRLEN];
+    int rv;
+
+    ogs_assert(header_desc);
+
+    fill_header(header_desc, pkbuf);
 
     ogs_trace("SEND GTP-U[%d] to Peer[%s] : TEID[0x%x]",
             header_desc->type,
@@ -85,6 +95,118 @@ int ogs_gtp2_send_user_plane(
     return rv;
 }
 
+int ogs_gtp2_build_encap(
+        ogs_gtp2_encap_t *encap, ogs_gtp2_header_desc_t *header_desc)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    ogs_assert(encap);
+    ogs_assert(header_desc);
+
+    /* Per-packet extension headers cannot be precompiled */
+    ogs_assert(header_desc->udp.presence == false);
+    ogs_assert(header_desc->pdcp_number_presence == false);
+
+    memset(encap, 0, sizeof(*encap));
+
+    pkbuf = ogs_pkbuf_alloc(NULL, OGS_GTPV1U_5GC_HEADER_LEN);
+    if (!pkbuf) {
+        ogs_error("ogs_pkbuf_alloc() failed");
+        return OGS_ERROR;
+    }
+    ogs_pkbuf_reserve(pkbuf, OGS_GTPV1U_5GC_HEADER_LEN);
+
+    fill_header(header_desc, pkbuf);
+    ogs_assert(pkbuf->len <= sizeof(encap->header));
+
+    memcpy(encap->header, pkbuf->data, pkbuf->len);
+    encap->len = pkbuf->len;
+
+    encap->type = header_desc->type;
+    encap->qos_flow_identifier = header_desc->qos_flow_identifier;
+    encap->valid = true;
+
+    ogs_pkbuf_free(pkbuf);
+
+    return OGS_OK;
+}
+
+int ogs_gtp2_send_user_plane_encap(
+        ogs_gtp_node_t *gnode,
+        ogs_gtp2_encap_t *encap,
+        ogs_pkbuf_t *pkbuf)
+{
+    char buf[OGS_ADDRSTRLEN];
+    ogs_gtp2_header_t *gtp_h = NULL;
+    int rv;
+
+    ogs_assert(gnode);
+    ogs_assert(encap);
+    ogs_assert(encap->valid == true);
+    ogs_assert(pkbuf);
+
+    ogs_pkbuf_push(pkbuf, encap->len);
+    memcpy(pkbuf->data, encap->header, encap->len);
+
+    /* See ogs_gtp2_fill_header() for the length field */
+    gtp_h = (ogs_gtp2_header_t *)pkbuf->data;
+    gtp_h->length = htobe16(pkbuf->len - OGS_GTPV1U_HEADER_LEN);
+
+    ogs_trace("SEND GTP-U[%d] to Peer[%s] : TEID[0x%x]",
+            encap->type, OGS_ADDR(&gnode->addr, buf), be32toh(gtp_h->teid));
+
+    rv = ogs_gtp_sendto(gnode, pkbuf);
+    if (rv != OGS_OK) {
+        if (ogs_socket_errno != OGS_EAGAIN) {
+            ogs_error("SEND GTP-U[%d] to Peer[%s] : TEID[0x%x]",
+                encap->type,
+                OGS_ADDR(&gnode->addr, buf), be32toh(gtp_h->teid));
+        }
+    }
+
+    ogs_pkbuf_free(pkbuf);
+
+    return rv;
+}
+
+/*
+ * Same as ogs_gtp2_send_user_plane_encap() for a run of packets
+ * towards one peer, sent with a single system call where possible.
+ */
+int ogs_gtp2_send_user_plane_encap_batch(
+        ogs_gtp_node_t *gnode,
+        ogs_gtp2_encap_t *encap,
+        ogs_pkbuf_t **pkbuf, int num)
+{
+    char buf[OGS_ADDRSTRLEN];
+    ogs_gtp2_header_t *gtp_h = NULL;
+    int i, rv;
+
+    ogs_assert(gnode);
+    ogs_assert(encap);
+    ogs_assert(encap->valid == true);
+    ogs_assert(pkbuf);
+
+    for (i = 0; i < num; i++) {
+        ogs_assert(pkbuf[i]);
+        ogs_pkbuf_push(pkbuf[i], encap->len);
+        memcpy(pkbuf[i]->data, encap->header, encap->len);
+
+        gtp_h = (ogs_gtp2_header_t *)pkbuf[i]->data;
+        gtp_h->length = htobe16(pkbuf[i]->len - OGS_GTPV1U_HEADER_LEN);
+    }
+
+    ogs_trace("SEND GTP-U[%d] x %d to Peer[%s]",
+            encap->type, num, OGS_ADDR(&gnode->addr, buf));
+
+    rv = ogs_gtp_sendto_batch(gnode, pkbuf, num);
+
+    for (i = 0; i < num; i++)
+        ogs_pkbuf_free(pkbuf[i]);
+
+    return rv;
+}
+
 ogs_pkbuf_t *ogs_gtp2_handle_echo_req(ogs_pkbuf_t *pkb)
 {
     ogs_gtp2_header_t *gtph = NULL;
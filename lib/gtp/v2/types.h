@@ -95,6 +95,21 @@ typedef struct ogs_gtp2_header_desc_s {
     uint16_t pdcp_number;
 } ogs_gtp2_header_desc_t;
 
+/*
+ * Precompiled GTP-U header (with the PDU Session Container, if any).
+ * Only the length field has to be patched when it is pushed
+ * in front of the payload.
+ */
+typedef struct ogs_gtp2_encap_s {
+    bool valid;
+
+    uint8_t type;
+    uint8_t qos_flow_identifier;
+
+    uint8_t len;
+    uint8_t header[OGS_GTPV1U_5GC_HEADER_LEN];
+} ogs_gtp2_encap_t;
+
 /* 8.4 Cause */
 #define OGS_GTP2_CAUSE_UNDEFINED_VALUE 0
 #define OGS_GTP2_CAUSE_LOCAL_DETACH 2
@@ -31,7 +31,8 @@ typedef enum {
 static int ogs_gtp_xact_initialized = 0;
 static uint32_t g_xact_id = 0;
 
-static OGS_POOL(pool, ogs_gtp_xact_t);
+static OGS_POOL(gtp_xact_pool, ogs_gtp_xact_t);
+static ogs_hash_t *xact_hash;
 
 static ogs_gtp_xact_t *ogs_gtp_xact_remote_create(ogs_gtp_node_t *gnode, uint8_t gtp_version, uint32_t sqn);
 static ogs_gtp_xact_stage_t ogs_gtp2_xact_get_stage(uint8_t type, uint32_t xid);
@@ -39,6 +40,8 @@ static ogs_gtp_xact_stage_t ogs_gtp1_xact_get_stage(uint8_t type, uint32_t xid);
 static int ogs_gtp_xact_delete(ogs_gtp_xact_t *xact);
 static int ogs_gtp_xact_update_rx(ogs_gtp_xact_t *xact, uint8_t type);
 
+static ogs_gtp_xact_rtt_cb_f rtt_cb;
+
 static void response_timeout(void *data);
 static void holding_timeout(void *data);
 static void peer_timeout(void *data);
@@ -47,7 +50,11 @@ int ogs_gtp_xact_init(void)
 {
     ogs_assert(ogs_gtp_xact_initialized == 0);
 
-    ogs_pool_init(&pool, ogs_app()->pool.xact);
+    ogs_pool_init_elastic(&gtp_xact_pool, ogs_app()->pool.xact);
+
+    xact_hash = ogs_hash_make();
+    ogs_assert(xact_hash);
+    ogs_hash_set_name(xact_hash, "gtp_xact");
 
     g_xact_id = 0;
 
@@ -60,11 +67,71 @@ void ogs_gtp_xact_final(void)
 {
     ogs_assert(ogs_gtp_xact_initialized == 1);
 
-    ogs_pool_final(&pool);
+    ogs_hash_destroy(xact_hash);
+
+    ogs_pool_final(&gtp_xact_pool);
 
     ogs_gtp_xact_initialized = 0;
 }
 
+void ogs_gtp_xact_set_rtt_cb(ogs_gtp_xact_rtt_cb_f cb)
+{
+    rtt_cb = cb;
+}
+
+/*
+ * Transactions are indexed by (gnode, originator, version, xid)
+ * so that a response is matched in O(1) instead of walking
+ * gnode->local_list/remote_list.
+ */
+static void xact_hash_add(ogs_gtp_xact_t *xact)
+{
+    ogs_assert(xact);
+    ogs_assert(xact->gnode);
+
+    xact->hash_key.gnode = xact->gnode;
+    xact->hash_key.xid = xact->xid;
+    xact->hash_key.org = xact->org;
+    xact->hash_key.gtp_version = xact->gtp_version;
+
+    ogs_hash_set(xact_hash, &xact->hash_key, sizeof(xact->hash_key), xact);
+
+    if (xact->org == OGS_GTP_LOCAL_ORIGINATOR)
+        xact->gnode->xact_stats.local++;
+    else
+        xact->gnode->xact_stats.remote++;
+}
+
+static void xact_hash_remove(ogs_gtp_xact_t *xact)
+{
+    ogs_assert(xact);
+    ogs_assert(xact->gnode);
+
+    /* The xid may have wrapped around onto a newer transaction */
+    if (ogs_hash_get(xact_hash,
+                &xact->hash_key, sizeof(xact->hash_key)) == xact)
+        ogs_hash_set(xact_hash, &xact->hash_key, sizeof(xact->hash_key), NULL);
+
+    if (xact->org == OGS_GTP_LOCAL_ORIGINATOR)
+        xact->gnode->xact_stats.local--;
+    else
+        xact->gnode->xact_stats.remote--;
+}
+
+static ogs_gtp_xact_t *xact_hash_find(ogs_gtp_node_t *gnode,
+        uint8_t org, uint8_t gtp_version, uint32_t xid)
+{
+    ogs_gtp_xact_t key;
+
+    memset(&key.hash_key, 0, sizeof(key.hash_key));
+    key.hash_key.gnode = gnode;
+    key.hash_key.xid = xid;
+    key.hash_key.org = org;
+    key.hash_key.gtp_version = gtp_version;
+
+    return ogs_hash_get(xact_hash, &key.hash_key, sizeof(key.hash_key));
+}
+
 ogs_gtp_xact_t *ogs_gtp1_xact_local_create(ogs_gtp_node_t *gnode,
         ogs_gtp1_header_t *hdesc, ogs_pkbuf_t *pkbuf,
         void (*cb)(ogs_gtp_xact_t *xact, void *data), void *data)
@@ -76,9 +143,9 @@ ogs_gtp_xact_t *ogs_gtp1_xact_local_create(ogs_gtp_node_t *gnode,
     ogs_assert(gnode);
     ogs_assert(hdesc);
 
-    ogs_pool_id_calloc(&pool, &xact);
+    ogs_pool_id_calloc(&gtp_xact_pool, &xact);
     ogs_assert(xact);
-    xact->index = ogs_pool_index(&pool, xact);
+    xact->index = ogs_pool_index(&gtp_xact_pool, xact);
 
     xact->gtp_version = 1;
     xact->org = OGS_GTP_LOCAL_ORIGINATOR;
@@ -106,6 +173,7 @@ ogs_gtp_xact_t *ogs_gtp1_xact_local_create(ogs_gtp_node_t *gnode,
     xact->holding_rcount = ogs_local_conf()->time.message.gtp.n3_holding_rcount;
 
     ogs_list_add(&xact->gnode->local_list, xact);
+    xact_hash_add(xact);
 
     rv = ogs_gtp1_xact_update_tx(xact, hdesc, pkbuf);
     if (rv != OGS_OK) {
@@ -133,9 +201,9 @@ ogs_gtp_xact_t *ogs_gtp_xact_local_create(ogs_gtp_node_t *gnode,
     ogs_assert(gnode);
     ogs_assert(hdesc);
 
-    ogs_pool_id_calloc(&pool, &xact);
+    ogs_pool_id_calloc(&gtp_xact_pool, &xact);
     ogs_assert(xact);
-    xact->index = ogs_pool_index(&pool, xact);
+    xact->index = ogs_pool_index(&gtp_xact_pool, xact);
 
     xact->gtp_version = 2;
     xact->org = OGS_GTP_LOCAL_ORIGINATOR;
@@ -168,6 +236,7 @@ ogs_gtp_xact_t *ogs_gtp_xact_local_create(ogs_gtp_node_t *gnode,
     ogs_assert(xact->tm_peer);
 
     ogs_list_add(&xact->gnode->local_list, xact);
+    xact_hash_add(xact);
 
     rv = ogs_gtp_xact_update_tx(xact, hdesc, pkbuf);
     if (rv != OGS_OK) {
@@ -191,9 +260,9 @@ static ogs_gtp_xact_t *ogs_gtp_xact_remote_create(ogs_gtp_node_t *gnode, uint8_t
 
     ogs_assert(gnode);
 
-    ogs_pool_id_calloc(&pool, &xact);
+    ogs_pool_id_calloc(&gtp_xact_pool, &xact);
     ogs_assert(xact);
-    xact->index = ogs_pool_index(&pool, xact);
+    xact->index = ogs_pool_index(&gtp_xact_pool, xact);
 
     xact->gtp_version = gtp_version;
     xact->org = OGS_GTP_REMOTE_ORIGINATOR;
@@ -219,6 +288,7 @@ static ogs_gtp_xact_t *ogs_gtp_xact_remote_create(ogs_gtp_node_t *gnode, uint8_t
     ogs_assert(xact->tm_peer);
 
     ogs_list_add(&xact->gnode->remote_list, xact);
+    xact_hash_add(xact);
 
     ogs_debug("[%d] REMOTE Create  peer [%s]:%d",
             xact->xid,
@@ -230,7 +300,7 @@ static ogs_gtp_xact_t *ogs_gtp_xact_remote_create(ogs_gtp_node_t *gnode, uint8_t
 
 ogs_gtp_xact_t *ogs_gtp_xact_find_by_id(ogs_pool_id_t id)
 {
-    return ogs_pool_find_by_id(&pool, id);
+    return ogs_pool_find_by_id(&gtp_xact_pool, id);
 }
 
 void ogs_gtp_xact_delete_all(ogs_gtp_node_t *gnode)
@@ -334,6 +404,9 @@ int ogs_gtp1_xact_update_tx(ogs_gtp_xact_t *xact,
     h->sqn = OGS_GTP1_XID_TO_SQN(xact->xid);
     h->length = htobe16(pkbuf->len - 8);
 
+    if (xact->org == OGS_GTP_LOCAL_ORIGINATOR && xact->step == 0)
+        xact->tx_time = ogs_time_cached();
+
     /* Save Message type and packet of this step */
     xact->seq[xact->step].type = h->type;
     xact->seq[xact->step].pkbuf = pkbuf;
@@ -442,6 +515,9 @@ int ogs_gtp_xact_update_tx(ogs_gtp_xact_t *xact,
     }
     h->length = htobe16(pkbuf->len - 4);
 
+    if (xact->org == OGS_GTP_LOCAL_ORIGINATOR && xact->step == 0)
+        xact->tx_time = ogs_time_cached();
+
     /* Save Message type and packet of this step */
     xact->seq[xact->step].type = h->type;
     xact->seq[xact->step].pkbuf = pkbuf;
@@ -514,6 +590,7 @@ static int ogs_gtp_xact_update_rx(ogs_gtp_xact_t *xact, uint8_t type)
                             OGS_PORT(&xact->gnode->addr));
                 }
 
+                xact->gnode->xact_stats.duplicated++;
                 return OGS_RETRY;
             }
 
@@ -579,6 +656,7 @@ static int ogs_gtp_xact_update_rx(ogs_gtp_xact_t *xact, uint8_t type)
                             OGS_PORT(&xact->gnode->addr));
                 }
 
+                xact->gnode->xact_stats.duplicated++;
                 return OGS_RETRY;
             }
 
@@ -617,6 +695,9 @@ static int ogs_gtp_xact_update_rx(ogs_gtp_xact_t *xact, uint8_t type)
     if (xact->tm_response)
         ogs_timer_stop(xact->tm_response);
 
+    if (xact->org == OGS_GTP_LOCAL_ORIGINATOR && xact->step == 1 && rtt_cb)
+        rtt_cb(xact, ogs_time_cached() - xact->tx_time);
+
     /* Save Message type of this step */
     xact->seq[xact->step].type = type;
 
@@ -779,6 +860,7 @@ static void response_timeout(void *data)
         pkbuf = xact->seq[xact->step-1].pkbuf;
         ogs_assert(pkbuf);
 
+        xact->gnode->xact_stats.retransmitted++;
         ogs_expect(OGS_OK == ogs_gtp_sendto(xact->gnode, pkbuf));
     } else {
         ogs_warn("[%d] %s No Reponse. Give up! "
@@ -875,7 +957,7 @@ int ogs_gtp1_xact_receive(
     uint8_t type;
     uint32_t sqn, xid;
     ogs_gtp_xact_stage_t stage;
-    ogs_list_t *list = NULL;
+    uint8_t org;
     ogs_gtp_xact_t *new = NULL;
 
     ogs_assert(gnode);
@@ -894,19 +976,19 @@ int ogs_gtp1_xact_receive(
 
     switch (stage) {
     case GTP_XACT_INITIAL_STAGE:
-        list = &gnode->remote_list;
+        org = OGS_GTP_REMOTE_ORIGINATOR;
         break;
     case GTP_XACT_INTERMEDIATE_STAGE:
-        list = &gnode->local_list;
+        org = OGS_GTP_LOCAL_ORIGINATOR;
         break;
     case GTP_XACT_FINAL_STAGE:
         /* For types which are replies to replies, the xact is never locally
          * created during transmit, but actually during rx of the initial req, hence
          * it is never placed in the local_list, but in the remote_list. */
         if (type == OGS_GTP1_SGSN_CONTEXT_ACKNOWLEDGE_TYPE)
-            list = &gnode->remote_list;
+            org = OGS_GTP_REMOTE_ORIGINATOR;
         else
-            list = &gnode->local_list;
+            org = OGS_GTP_LOCAL_ORIGINATOR;
         break;
     default:
         ogs_error("[%d] Unexpected type %u from GTPv1 peer [%s]:%d",
@@ -914,17 +996,14 @@ int ogs_gtp1_xact_receive(
         return OGS_ERROR;
     }
 
-    ogs_assert(list);
-    ogs_list_for_each(list, new) {
-        if (new->gtp_version == 1 && new->xid == xid) {
-            ogs_debug("[%d] %s Find GTPv%u peer [%s]:%d",
-                    new->xid,
-                    new->org == OGS_GTP_LOCAL_ORIGINATOR ? "LOCAL " : "REMOTE",
-                    new->gtp_version,
-                    OGS_ADDR(&gnode->addr, buf),
-                    OGS_PORT(&gnode->addr));
-            break;
-        }
+    new = xact_hash_find(gnode, org, 1, xid);
+    if (new) {
+        ogs_debug("[%d] %s Find GTPv%u peer [%s]:%d",
+                new->xid,
+                new->org == OGS_GTP_LOCAL_ORIGINATOR ? "LOCAL " : "REMOTE",
+                new->gtp_version,
+                OGS_ADDR(&gnode->addr, buf),
+                OGS_PORT(&gnode->addr));
     }
 
     if (!new) {
@@ -962,7 +1041,7 @@ int ogs_gtp_xact_receive(
     uint8_t type;
     uint32_t sqn, xid;
     ogs_gtp_xact_stage_t stage;
-    ogs_list_t *list = NULL;
+    uint8_t org;
     ogs_gtp_xact_t *new = NULL;
 
     ogs_assert(gnode);
@@ -978,22 +1057,22 @@ int ogs_gtp_xact_receive(
 
     switch (stage) {
     case GTP_XACT_INITIAL_STAGE:
-        list = &gnode->remote_list;
+        org = OGS_GTP_REMOTE_ORIGINATOR;
         break;
     case GTP_XACT_INTERMEDIATE_STAGE:
-        list = &gnode->local_list;
+        org = OGS_GTP_LOCAL_ORIGINATOR;
         break;
     case GTP_XACT_FINAL_STAGE:
         if (xid & OGS_GTP_CMD_XACT_ID) {
             if (type == OGS_GTP2_MODIFY_BEARER_FAILURE_INDICATION_TYPE ||
                 type == OGS_GTP2_DELETE_BEARER_FAILURE_INDICATION_TYPE ||
                 type == OGS_GTP2_BEARER_RESOURCE_FAILURE_INDICATION_TYPE) {
-                list = &gnode->local_list;
+                org = OGS_GTP_LOCAL_ORIGINATOR;
             } else {
-                list = &gnode->remote_list;
+                org = OGS_GTP_REMOTE_ORIGINATOR;
             }
         } else {
-            list = &gnode->local_list;
+            org = OGS_GTP_LOCAL_ORIGINATOR;
         }
         break;
     default:
@@ -1002,17 +1081,14 @@ int ogs_gtp_xact_receive(
         return OGS_ERROR;
     }
 
-    ogs_assert(list);
-    ogs_list_for_each(list, new) {
-        if (new->gtp_version == 2 && new->xid == xid) {
-            ogs_debug("[%d] %s Find GTPv%u peer [%s]:%d",
-                    new->xid,
-                    new->org == OGS_GTP_LOCAL_ORIGINATOR ? "LOCAL " : "REMOTE",
-                    new->gtp_version,
-                    OGS_ADDR(&gnode->addr, buf),
-                    OGS_PORT(&gnode->addr));
-            break;
-        }
+    new = xact_hash_find(gnode, org, 2, xid);
+    if (new) {
+        ogs_debug("[%d] %s Find GTPv%u peer [%s]:%d",
+                new->xid,
+                new->org == OGS_GTP_LOCAL_ORIGINATOR ? "LOCAL " : "REMOTE",
+                new->gtp_version,
+                OGS_ADDR(&gnode->addr, buf),
+                OGS_PORT(&gnode->addr));
     }
 
     if (!new) {
@@ -1230,9 +1306,10 @@ static int ogs_gtp_xact_delete(ogs_gtp_xact_t *xact)
     if (assoc_xact)
         ogs_gtp_xact_deassociate(xact, assoc_xact);
 
+    xact_hash_remove(xact);
     ogs_list_remove(xact->org == OGS_GTP_LOCAL_ORIGINATOR ?
             &xact->gnode->local_list : &xact->gnode->remote_list, xact);
-    ogs_pool_id_free(&pool, xact);
+    ogs_pool_id_free(&gtp_xact_pool, xact);
 
     return OGS_OK;
 }
@@ -92,6 +92,13 @@ typedef struct ogs_gtp_xact_s {
     uint32_t        xid;            /**< Transaction ID */
     ogs_gtp_node_t  *gnode;         /**< Relevant GTP node context */
 
+    struct {
+        ogs_gtp_node_t *gnode;
+        uint32_t    xid;
+        uint8_t     org;
+        uint8_t     gtp_version;
+    } hash_key;                     /**< Key of the transaction hash */
+
     void (*cb)(ogs_gtp_xact_t *, void *); /**< Local timer expiration handler */
     void            *data;          /**< Transaction Data */
 
@@ -103,6 +110,8 @@ typedef struct ogs_gtp_xact_s {
         uint8_t     type;           /**< Message type history */
         ogs_pkbuf_t *pkbuf;         /**< Packet history */
     } seq[3];                       /**< history for the each step */
+    ogs_time_t      tx_time;        /**< First transmission of the
+                                         locally originated request */
 
     ogs_timer_t     *tm_response;   /**< Timer waiting for next message */
     uint8_t         response_rcount;
@@ -160,6 +169,14 @@ typedef struct ogs_gtp_xact_s {
 int ogs_gtp_xact_init(void);
 void ogs_gtp_xact_final(void);
 
+/*
+ * Called when the reply to a locally originated request arrives, with
+ * the time elapsed since the request was first sent. seq[0].type holds
+ * the request type. Used by the NFs to feed their latency histograms.
+ */
+typedef void (*ogs_gtp_xact_rtt_cb_f)(ogs_gtp_xact_t *xact, ogs_time_t rtt);
+void ogs_gtp_xact_set_rtt_cb(ogs_gtp_xact_rtt_cb_f cb);
+
 ogs_gtp_xact_t *ogs_gtp1_xact_local_create(ogs_gtp_node_t *gnode,
         ogs_gtp1_header_t *hdesc, ogs_pkbuf_t *pkbuf,
         void (*cb)(ogs_gtp_xact_t *xact, void *data), void *data);
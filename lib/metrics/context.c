@@ -26,6 +26,30 @@ int __ogs_metrics_domain;
 static ogs_metrics_context_t self;
 static int context_initialized = 0;
 
+static ogs_metrics_spec_t *peer_hist_spec[_OGS_METRICS_PEER_HIST_MAX];
+
+#define OGS_METRICS_PEER_XACT_SPEC_MAX 4
+static ogs_metrics_spec_t *peer_xact_spec
+    [_OGS_METRICS_PEER_XACT_MAX][OGS_METRICS_PEER_XACT_SPEC_MAX];
+
+#define OGS_METRICS_PEER_HIST_NAME_LEN 64
+typedef struct peer_hist_key_s {
+    uint32_t t;
+    uint32_t id;
+    char name[OGS_METRICS_PEER_HIST_NAME_LEN];
+} peer_hist_key_t;
+
+struct ogs_metrics_peer_s {
+    char *name;
+
+    ogs_hash_t *hist_hash;          /* peer_hist_key_t to instance */
+
+    struct {
+        ogs_metrics_inst_t *inst[OGS_METRICS_PEER_XACT_SPEC_MAX];
+        ogs_metrics_peer_xact_stats_t exported;
+    } xact[_OGS_METRICS_PEER_XACT_MAX];
+};
+
 void ogs_metrics_context_init(void)
 {
     ogs_assert(context_initialized == 0);
@@ -38,6 +62,11 @@ void ogs_metrics_context_init(void)
     ogs_metrics_spec_init(ogs_metrics_self());
     ogs_metrics_server_init(ogs_metrics_self());
 
+    self.inst_hash = ogs_hash_make();
+    ogs_assert(self.inst_hash);
+    self.peer_hash = ogs_hash_make();
+    ogs_assert(self.peer_hash);
+
     context_initialized = 1;
 }
 
@@ -52,8 +81,49 @@ void ogs_metrics_context_close(ogs_metrics_context_t *ctx)
 
 void ogs_metrics_context_final(void)
 {
+    ogs_hash_index_t *hi = NULL;
+
     ogs_assert(context_initialized == 1);
 
+    for (hi = ogs_hash_first(self.inst_hash); hi; hi = ogs_hash_next(hi)) {
+        char *key = (char *)ogs_hash_this_key(hi);
+
+        ogs_hash_set(self.inst_hash, key, OGS_HASH_KEY_STRING, NULL);
+
+        ogs_free(key);
+        /* The instance itself is freed with its spec */
+    }
+    ogs_hash_destroy(self.inst_hash);
+
+    for (hi = ogs_hash_first(self.peer_hash); hi; hi = ogs_hash_next(hi)) {
+        ogs_metrics_peer_t *peer = ogs_hash_this_val(hi);
+
+        ogs_hash_set(self.peer_hash, peer->name, OGS_HASH_KEY_STRING, NULL);
+
+        if (peer->hist_hash) {
+            ogs_hash_index_t *hj = NULL;
+
+            for (hj = ogs_hash_first(peer->hist_hash);
+                    hj; hj = ogs_hash_next(hj)) {
+                const void *key = NULL;
+                int klen;
+
+                ogs_hash_this(hj, &key, &klen, NULL);
+                ogs_hash_set(peer->hist_hash, key, klen, NULL);
+
+                ogs_free((void *)key);
+            }
+            ogs_hash_destroy(peer->hist_hash);
+        }
+
+        ogs_free(peer->name);
+        ogs_free(peer);
+    }
+    ogs_hash_destroy(self.peer_hash);
+
+    memset(peer_hist_spec, 0, sizeof(peer_hist_spec));
+    memset(peer_xact_spec, 0, sizeof(peer_xact_spec));
+
     ogs_metrics_spec_final(ogs_metrics_self());
     ogs_metrics_server_final(ogs_metrics_self());
 
@@ -205,7 +275,12 @@ int ogs_metrics_context_parse_config(const char *local)
                                 for (i = 0; i < num; i++) {
                                     rv = ogs_addaddrinfo(&addr,
                                             family, hostname[i], port, 0);
-                                    ogs_assert(rv == OGS_OK);
+                                    if (rv != OGS_OK) {
+                                        ogs_error("Invalid metrics server "
+                                                "address [%s]", hostname[i]);
+                                        ogs_freeaddrinfo(addr);
+                                        return OGS_ERROR;
+                                    }
                                 }
 
                                 ogs_list_init(&list);
@@ -228,7 +303,13 @@ int ogs_metrics_context_parse_config(const char *local)
                                         ogs_global_conf()->parameter.no_ipv6 ?
                                         NULL : &list6,
                                         dev, port, NULL);
-                                    ogs_assert(rv == OGS_OK);
+                                    if (rv != OGS_OK) {
+                                        ogs_error("Cannot probe metrics "
+                                                "server dev [%s]", dev);
+                                        ogs_socknode_remove_all(&list);
+                                        ogs_socknode_remove_all(&list6);
+                                        return OGS_ERROR;
+                                    }
                                 }
 
                                 node = ogs_list_first(&list);
@@ -263,3 +344,322 @@ int ogs_metrics_context_parse_config(const char *local)
 
     return OGS_OK;
 }
+
+/*
+ * Listens on the servers of the reloaded configuration. The new list is
+ * parsed aside so that a bad address leaves the running servers alone,
+ * and the running ones are listened on again if the new ones fail to bind.
+ */
+int ogs_metrics_context_reload_config(const char *local)
+{
+    int rv;
+    ogs_list_t running, reloaded;
+
+    memcpy(&running, &self.server_list, sizeof(running));
+    ogs_list_init(&self.server_list);
+
+    rv = ogs_metrics_context_parse_config(local);
+    if (rv != OGS_OK) {
+        ogs_metrics_server_remove_all();
+        memcpy(&self.server_list, &running, sizeof(running));
+        return rv;
+    }
+
+    memcpy(&reloaded, &self.server_list, sizeof(reloaded));
+
+    /* The port has to be released before it can be bound again */
+    memcpy(&self.server_list, &running, sizeof(running));
+    ogs_metrics_server_close(&self);
+
+    memcpy(&self.server_list, &reloaded, sizeof(reloaded));
+    rv = ogs_metrics_server_open(&self);
+    if (rv != OGS_OK) {
+        ogs_metrics_server_close(&self);
+        ogs_metrics_server_remove_all();
+
+        memcpy(&self.server_list, &running, sizeof(running));
+        if (ogs_metrics_server_open(&self) != OGS_OK)
+            ogs_error("Cannot reopen the running metrics servers");
+
+        return rv;
+    }
+
+    memcpy(&self.server_list, &running, sizeof(running));
+    ogs_metrics_server_remove_all();
+
+    memcpy(&self.server_list, &reloaded, sizeof(reloaded));
+
+    return OGS_OK;
+}
+
+/*
+ * Returns the instance of the spec with these label values, creating
+ * it the first time they are seen. Only a new combination allocates.
+ */
+ogs_metrics_inst_t *ogs_metrics_inst_find_or_add(ogs_metrics_spec_t *spec,
+        unsigned int num_labels, const char **label_values)
+{
+    ogs_metrics_inst_t *inst = NULL;
+    char key[OGS_HUGE_LEN];
+    char *p = NULL, *last = NULL;
+    unsigned int i;
+
+    ogs_assert(spec);
+    ogs_assert(self.inst_hash);
+
+    p = key;
+    last = key + sizeof(key);
+    p = ogs_slprintf(p, last, "%p", spec);
+    for (i = 0; i < num_labels; i++) {
+        ogs_assert(label_values[i]);
+        p = ogs_slprintf(p, last, "\x1f%s", label_values[i]);
+    }
+
+    inst = ogs_hash_get(self.inst_hash, key, OGS_HASH_KEY_STRING);
+    if (!inst) {
+        char *inst_key = ogs_strdup(key);
+        ogs_assert(inst_key);
+
+        inst = ogs_metrics_inst_new(spec, num_labels, label_values);
+        ogs_assert(inst);
+
+        ogs_hash_set(self.inst_hash, inst_key, OGS_HASH_KEY_STRING, inst);
+    }
+
+    return inst;
+}
+
+static const char *labels_peer[] = {
+    "peer",
+    "procedure"
+};
+
+static const struct {
+    const char *name;
+    const char *description;
+} peer_hist_def[_OGS_METRICS_PEER_HIST_MAX] = {
+    [OGS_METRICS_PEER_HIST_GTP_XACT_TIME] = {
+        "gtp_xact_time",
+        "Time between a GTP-C request and its response in milliseconds" },
+    [OGS_METRICS_PEER_HIST_PFCP_XACT_TIME] = {
+        "pfcp_xact_time",
+        "Time between a PFCP request and its response in milliseconds" },
+    [OGS_METRICS_PEER_HIST_SBI_CLIENT_TIME] = {
+        "sbi_client_time",
+        "Time between an SBI request and its response in milliseconds" },
+};
+
+/*
+ * Declares one of the peer histograms. Only the declared ones show up
+ * in the output of the NF.
+ */
+void ogs_metrics_peer_hist_init(ogs_metrics_peer_hist_t t)
+{
+    ogs_metrics_histogram_params_t params;
+
+    ogs_assert(t < _OGS_METRICS_PEER_HIST_MAX);
+
+    if (peer_hist_spec[t])
+        return;
+
+    memset(&params, 0, sizeof(params));
+    params.type = OGS_METRICS_HISTOGRAM_BUCKET_TYPE_EXPONENTIAL;
+    params.count = 12;
+    params.exp.start = 1;
+    params.exp.factor = 2;
+
+    peer_hist_spec[t] = ogs_metrics_spec_new(ogs_metrics_self(),
+            OGS_METRICS_METRIC_TYPE_HISTOGRAM,
+            peer_hist_def[t].name, peer_hist_def[t].description,
+            0, OGS_ARRAY_SIZE(labels_peer), labels_peer, &params);
+    ogs_assert(peer_hist_spec[t]);
+}
+
+ogs_metrics_peer_t *ogs_metrics_peer_find_or_add(const char *name)
+{
+    ogs_metrics_peer_t *peer = NULL;
+
+    ogs_assert(name);
+    ogs_assert(self.peer_hash);
+
+    peer = ogs_hash_get(self.peer_hash, name, OGS_HASH_KEY_STRING);
+    if (!peer) {
+        peer = ogs_calloc(1, sizeof(*peer));
+        ogs_assert(peer);
+        peer->name = ogs_strdup(name);
+        ogs_assert(peer->name);
+
+        ogs_hash_set(self.peer_hash, peer->name, OGS_HASH_KEY_STRING, peer);
+    }
+
+    return peer;
+}
+
+/* Only the used part of the key is hashed */
+static int peer_hist_key(peer_hist_key_t *key,
+        ogs_metrics_peer_hist_t t, uint32_t id, const char *name)
+{
+    int len = 0;
+
+    key->t = t;
+    key->id = id;
+    if (name) {
+        len = ogs_min(strlen(name), sizeof(key->name));
+        memcpy(key->name, name, len);
+    }
+
+    return offsetof(peer_hist_key_t, name) + len;
+}
+
+ogs_metrics_inst_t *ogs_metrics_peer_hist_find(ogs_metrics_peer_t *peer,
+        ogs_metrics_peer_hist_t t, uint32_t id, const char *name)
+{
+    peer_hist_key_t key;
+    int klen;
+
+    ogs_assert(peer);
+    ogs_assert(t < _OGS_METRICS_PEER_HIST_MAX);
+
+    if (!peer->hist_hash)
+        return NULL;
+
+    klen = peer_hist_key(&key, t, id, name);
+    return ogs_hash_get(peer->hist_hash, &key, klen);
+}
+
+ogs_metrics_inst_t *ogs_metrics_peer_hist_add(ogs_metrics_peer_t *peer,
+        ogs_metrics_peer_hist_t t, uint32_t id, const char *name,
+        const char *procedure)
+{
+    ogs_metrics_inst_t *inst = NULL;
+    peer_hist_key_t key;
+    void *hist_key = NULL;
+    int klen;
+
+    ogs_assert(peer);
+    ogs_assert(t < _OGS_METRICS_PEER_HIST_MAX);
+    ogs_assert(procedure);
+
+    if (!peer_hist_spec[t])
+        return NULL;
+
+    inst = ogs_metrics_peer_hist_find(peer, t, id, name);
+    if (inst)
+        return inst;
+
+    inst = ogs_metrics_inst_find_or_add(peer_hist_spec[t],
+            OGS_ARRAY_SIZE(labels_peer),
+            (const char *[]){ peer->name, procedure });
+    ogs_assert(inst);
+
+    if (!peer->hist_hash) {
+        peer->hist_hash = ogs_hash_make();
+        ogs_assert(peer->hist_hash);
+    }
+
+    klen = peer_hist_key(&key, t, id, name);
+    hist_key = ogs_memdup(&key, klen);
+    ogs_assert(hist_key);
+    ogs_hash_set(peer->hist_hash, hist_key, klen, inst);
+
+    return inst;
+}
+
+static const char *labels_peer_xact[] = {
+    "peer"
+};
+
+static const struct {
+    ogs_metrics_metric_type_t type;
+    const char *name;
+    const char *description;
+} peer_xact_def[_OGS_METRICS_PEER_XACT_MAX][OGS_METRICS_PEER_XACT_SPEC_MAX] = {
+    [OGS_METRICS_PEER_XACT_PFCP] = {
+        { OGS_METRICS_METRIC_TYPE_GAUGE, "pfcp_xact_local",
+            "PFCP requests sent and waiting for a response" },
+        { OGS_METRICS_METRIC_TYPE_GAUGE, "pfcp_xact_remote",
+            "PFCP requests received and held for retransmissions" },
+        { OGS_METRICS_METRIC_TYPE_COUNTER, "pfcp_xact_retransmitted",
+            "PFCP requests retransmitted on T1 expiry" },
+        { OGS_METRICS_METRIC_TYPE_COUNTER, "pfcp_xact_duplicated",
+            "Duplicated PFCP requests received" },
+    },
+    [OGS_METRICS_PEER_XACT_GTP] = {
+        { OGS_METRICS_METRIC_TYPE_GAUGE, "gtp_xact_local",
+            "GTP-C requests sent and waiting for a response" },
+        { OGS_METRICS_METRIC_TYPE_GAUGE, "gtp_xact_remote",
+            "GTP-C requests received and held for retransmissions" },
+        { OGS_METRICS_METRIC_TYPE_COUNTER, "gtp_xact_retransmitted",
+            "GTP-C requests retransmitted on T3 expiry" },
+        { OGS_METRICS_METRIC_TYPE_COUNTER, "gtp_xact_duplicated",
+            "Duplicated GTP-C requests received" },
+    },
+};
+
+/*
+ * Declares the transaction counters of one protocol. Only the declared
+ * ones show up in the output of the NF.
+ */
+void ogs_metrics_peer_xact_init(ogs_metrics_peer_xact_t t)
+{
+    int i;
+
+    ogs_assert(t < _OGS_METRICS_PEER_XACT_MAX);
+
+    if (peer_xact_spec[t][0])
+        return;
+
+    for (i = 0; i < OGS_METRICS_PEER_XACT_SPEC_MAX; i++) {
+        peer_xact_spec[t][i] = ogs_metrics_spec_new(ogs_metrics_self(),
+                peer_xact_def[t][i].type,
+                peer_xact_def[t][i].name, peer_xact_def[t][i].description,
+                0, OGS_ARRAY_SIZE(labels_peer_xact), labels_peer_xact, NULL);
+        ogs_assert(peer_xact_spec[t][i]);
+    }
+}
+
+/*
+ * The counters of a node start from zero when it is added again, which
+ * is taken as a reset; the exported totals keep growing.
+ */
+static void peer_xact_add(ogs_metrics_inst_t *inst,
+        uint64_t *exported, uint64_t value)
+{
+    if (value < *exported)
+        *exported = 0;
+    if (value > *exported)
+        ogs_metrics_inst_add(inst, (int)(value - *exported));
+    *exported = value;
+}
+
+void ogs_metrics_peer_xact_update(ogs_metrics_peer_t *peer,
+        ogs_metrics_peer_xact_t t, const ogs_metrics_peer_xact_stats_t *stats)
+{
+    ogs_metrics_inst_t **inst = NULL;
+    ogs_metrics_peer_xact_stats_t *exported = NULL;
+    int i;
+
+    ogs_assert(peer);
+    ogs_assert(t < _OGS_METRICS_PEER_XACT_MAX);
+    ogs_assert(stats);
+
+    if (!peer_xact_spec[t][0])
+        return;
+
+    inst = peer->xact[t].inst;
+    exported = &peer->xact[t].exported;
+
+    if (!inst[0]) {
+        for (i = 0; i < OGS_METRICS_PEER_XACT_SPEC_MAX; i++) {
+            inst[i] = ogs_metrics_inst_find_or_add(peer_xact_spec[t][i],
+                    OGS_ARRAY_SIZE(labels_peer_xact),
+                    (const char *[]){ peer->name });
+            ogs_assert(inst[i]);
+        }
+    }
+
+    ogs_metrics_inst_set(inst[0], stats->local);
+    ogs_metrics_inst_set(inst[1], stats->remote);
+    peer_xact_add(inst[2], &exported->retransmitted, stats->retransmitted);
+    peer_xact_add(inst[3], &exported->duplicated, stats->duplicated);
+}
@@ -41,6 +41,12 @@ typedef struct ogs_metrics_context_s {
     ogs_list_t  spec_list;
 
     uint16_t    metrics_port;
+
+    /* Refreshes values kept outside of the metrics, right before a scrape */
+    void        (*collect)(void);
+
+    ogs_hash_t  *inst_hash;     /* See ogs_metrics_inst_find_or_add() */
+    ogs_hash_t  *peer_hash;     /* See ogs_metrics_peer_find_or_add() */
 } ogs_metrics_context_t;
 
 typedef enum ogs_metrics_histogram_bucket_type_s  {
@@ -75,9 +81,11 @@ void ogs_metrics_context_close(ogs_metrics_context_t *ctx);
 void ogs_metrics_context_final(void);
 ogs_metrics_context_t *ogs_metrics_self(void);
 int ogs_metrics_context_parse_config(const char *local);
+int ogs_metrics_context_reload_config(const char *local);
+char *ogs_metrics_context_render(void);
 
 void ogs_metrics_server_init(ogs_metrics_context_t *ctx);
-void ogs_metrics_server_open(ogs_metrics_context_t *ctx);
+int ogs_metrics_server_open(ogs_metrics_context_t *ctx);
 void ogs_metrics_server_close(ogs_metrics_context_t *ctx);
 void ogs_metrics_server_final(ogs_metrics_context_t *ctx);
 ogs_metrics_server_t *ogs_metrics_server_add(
@@ -112,6 +120,63 @@ static inline void ogs_metrics_inst_dec(ogs_metrics_inst_t *inst)
     ogs_metrics_inst_add(inst, -1);
 }
 
+ogs_metrics_inst_t *ogs_metrics_inst_find_or_add(ogs_metrics_spec_t *spec,
+        unsigned int num_labels, const char **label_values);
+
+/*
+ * Round-trip histograms of the requests sent to a peer,
+ * labelled by peer and procedure, in milliseconds.
+ */
+typedef enum ogs_metrics_peer_hist_s {
+    OGS_METRICS_PEER_HIST_GTP_XACT_TIME = 0,
+    OGS_METRICS_PEER_HIST_PFCP_XACT_TIME,
+    OGS_METRICS_PEER_HIST_SBI_CLIENT_TIME,
+    _OGS_METRICS_PEER_HIST_MAX,
+} ogs_metrics_peer_hist_t;
+
+void ogs_metrics_peer_hist_init(ogs_metrics_peer_hist_t t);
+
+/*
+ * The metrics of one PFCP, GTP or SBI peer, labelled by peer. Its
+ * instances are resolved once and kept until ogs_metrics_context_final(),
+ * so the caller looks the peer up once and caches it on its node.
+ */
+typedef struct ogs_metrics_peer_s ogs_metrics_peer_t;
+ogs_metrics_peer_t *ogs_metrics_peer_find_or_add(const char *name);
+
+/*
+ * The histogram of a procedure of the peer, cached on the peer by id
+ * and an optional name. The procedure label is only formatted by the
+ * caller when ogs_metrics_peer_hist_find() misses. Both return NULL
+ * if the histogram was not declared.
+ */
+ogs_metrics_inst_t *ogs_metrics_peer_hist_find(ogs_metrics_peer_t *peer,
+        ogs_metrics_peer_hist_t t, uint32_t id, const char *name);
+ogs_metrics_inst_t *ogs_metrics_peer_hist_add(ogs_metrics_peer_t *peer,
+        ogs_metrics_peer_hist_t t, uint32_t id, const char *name,
+        const char *procedure);
+
+/*
+ * Transaction counters of a peer, copied from the node when the
+ * metrics are scraped.
+ */
+typedef enum ogs_metrics_peer_xact_s {
+    OGS_METRICS_PEER_XACT_PFCP = 0,
+    OGS_METRICS_PEER_XACT_GTP,
+    _OGS_METRICS_PEER_XACT_MAX,
+} ogs_metrics_peer_xact_t;
+
+typedef struct ogs_metrics_peer_xact_stats_s {
+    uint32_t local;                 /* Outstanding local transactions */
+    uint32_t remote;                /* Holding remote transactions */
+    uint64_t retransmitted;
+    uint64_t duplicated;
+} ogs_metrics_peer_xact_stats_t;
+
+void ogs_metrics_peer_xact_init(ogs_metrics_peer_xact_t t);
+void ogs_metrics_peer_xact_update(ogs_metrics_peer_t *peer,
+        ogs_metrics_peer_xact_t t, const ogs_metrics_peer_xact_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
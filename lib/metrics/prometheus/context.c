@@ -26,6 +26,21 @@
 
 #define MAX_LABELS 8
 
+/*
+ * Histograms do not go through libprom on the observation path:
+ * prom_histogram_observe() serialises the label values into a key,
+ * looks the sample up in a locked map and then updates each bucket
+ * through another mutex. Instead every instance keeps plain bucket
+ * arrays, one per observing thread, which are merged and rendered
+ * when /metrics is scraped.
+ */
+#define MAX_HIST_SHARDS 16
+
+typedef struct hist_shard_s {
+    uint64_t                    sum;
+    uint64_t                    bucket[]; /* num_buckets + 1 (+Inf) */
+} hist_shard_t;
+
 typedef struct ogs_metrics_server_s {
     ogs_socknode_t node;
     struct MHD_Daemon *mhd;
@@ -42,6 +57,9 @@ typedef struct ogs_metrics_spec_s {
     unsigned int                num_labels;
     char                        *labels[MAX_LABELS];
     prom_metric_t               *prom;
+
+    unsigned int                num_buckets;  /* HISTOGRAM only */
+    double                      *upper_bounds;
 } ogs_metrics_spec_t;
 
 typedef struct ogs_metrics_inst_s {
@@ -49,6 +67,8 @@ typedef struct ogs_metrics_inst_s {
     ogs_list_t              entry; /* included in ogs_metrics_spec_t spec */
     unsigned int            num_labels;
     char                    *label_values[MAX_LABELS];
+
+    hist_shard_t            *shard[MAX_HIST_SHARDS]; /* HISTOGRAM only */
 } ogs_metrics_inst_t;
 
 static OGS_POOL(metrics_spec_pool, ogs_metrics_spec_t);
@@ -57,18 +77,27 @@ static OGS_POOL(metrics_server_pool, ogs_metrics_server_t);
 static int ogs_metrics_context_server_start(ogs_metrics_server_t *server);
 static int ogs_metrics_context_server_stop(ogs_metrics_server_t *server);
 
+static char *hist_render(char *buf);
+static char *prof_render(char *buf);
+static char *pool_render(char *buf);
+static char *hash_render(char *buf);
+
 void ogs_metrics_server_init(ogs_metrics_context_t *ctx)
 {
     ogs_list_init(&ctx->server_list);
     ogs_pool_init(&metrics_server_pool, ogs_app()->pool.nf);
 }
 
-void ogs_metrics_server_open(ogs_metrics_context_t *ctx)
+int ogs_metrics_server_open(ogs_metrics_context_t *ctx)
 {
     ogs_metrics_server_t *server = NULL;
 
-    ogs_list_for_each(&ctx->server_list, server)
-        ogs_metrics_context_server_start(server);
+    ogs_list_for_each(&ctx->server_list, server) {
+        if (ogs_metrics_context_server_start(server) != OGS_OK)
+            return OGS_ERROR;
+    }
+
+    return OGS_OK;
 }
 
 void ogs_metrics_server_close(ogs_metrics_context_t *ctx)
@@ -207,7 +236,7 @@ static _MHD_Result mhd_server_access_handler(void *cls, struct MHD_Connection *c
         return ret;
     }
     if (strcmp(url, "/metrics") == 0) {
-        buf = prom_collector_registry_bridge(PROM_COLLECTOR_REGISTRY_DEFAULT);
+        buf = ogs_metrics_context_render();
         rsp = MHD_create_response_from_buffer(strlen(buf), (void *)buf, MHD_RESPMEM_MUST_FREE);
         ret = MHD_queue_response(connection, MHD_HTTP_OK, rsp);
         MHD_destroy_response(rsp);
@@ -220,6 +249,27 @@ static _MHD_Result mhd_server_access_handler(void *cls, struct MHD_Connection *c
     return ret;
 }
 
+/*
+ * Renders every metric in the text exposition format.
+ * The returned buffer is released with free().
+ */
+char *ogs_metrics_context_render(void)
+{
+    char *buf = NULL;
+
+    if (ogs_metrics_self()->collect)
+        ogs_metrics_self()->collect();
+
+    buf = (char *)prom_collector_registry_bridge(
+            PROM_COLLECTOR_REGISTRY_DEFAULT);
+    buf = hist_render(buf);
+    buf = prof_render(buf);
+    buf = pool_render(buf);
+    buf = hash_render(buf);
+
+    return buf;
+}
+
 static int ogs_metrics_context_server_start(ogs_metrics_server_t *server)
 {
 #define MAX_NUM_OF_MHD_OPTION_ITEM 8
@@ -306,8 +356,10 @@ static int ogs_metrics_context_server_stop(ogs_metrics_server_t *server)
 {
     ogs_assert(server);
 
-    if (server->node.poll)
+    if (server->node.poll) {
         ogs_pollset_remove(server->node.poll);
+        server->node.poll = NULL;
+    }
 
     if (server->mhd) {
         MHD_stop_daemon(server->mhd);
@@ -345,9 +397,6 @@ ogs_metrics_spec_t *ogs_metrics_spec_new(
     ogs_metrics_spec_t *spec;
     unsigned int i;
 
-    prom_histogram_buckets_t *buckets;
-    double *upper_bounds;
-
     ogs_assert(name);
     ogs_assert(description);
     ogs_assert(num_labels <= MAX_LABELS);
@@ -378,42 +427,43 @@ ogs_metrics_spec_t *ogs_metrics_spec_new(
         break;
     case OGS_METRICS_METRIC_TYPE_HISTOGRAM:
         ogs_assert(histogram_params);
+        ogs_assert(histogram_params->count);
+        spec->num_buckets = histogram_params->count;
+        spec->upper_bounds = ogs_calloc(
+                histogram_params->count, sizeof(double));
+        ogs_assert(spec->upper_bounds);
         switch (histogram_params->type) {
         case OGS_METRICS_HISTOGRAM_BUCKET_TYPE_EXPONENTIAL:
-            buckets = prom_histogram_buckets_exponential(histogram_params->exp.start,
-                    histogram_params->exp.factor, histogram_params->count);
-            ogs_assert(buckets);
+            ogs_assert(histogram_params->exp.start > 0);
+            ogs_assert(histogram_params->exp.factor > 1);
+            spec->upper_bounds[0] = histogram_params->exp.start;
+            for (i = 1; i < histogram_params->count; i++)
+                spec->upper_bounds[i] = spec->upper_bounds[i - 1] *
+                    histogram_params->exp.factor;
             break;
         case OGS_METRICS_HISTOGRAM_BUCKET_TYPE_LINEAR:
-            buckets = prom_histogram_buckets_linear(histogram_params->lin.start,
-                    histogram_params->lin.width, histogram_params->count);
-            ogs_assert(buckets);
+            ogs_assert(histogram_params->lin.width > 0);
+            for (i = 0; i < histogram_params->count; i++)
+                spec->upper_bounds[i] = histogram_params->lin.start +
+                    histogram_params->lin.width * i;
             break;
         case OGS_METRICS_HISTOGRAM_BUCKET_TYPE_VARIABLE:
-            buckets = (prom_histogram_buckets_t *)prom_malloc(sizeof(prom_histogram_buckets_t));
-            ogs_assert(buckets);
-
-            ogs_assert(histogram_params->count <= OGS_METRICS_HIST_VAR_BUCKETS_MAX);
-            buckets->count = histogram_params->count;
-
-            upper_bounds = (double *)prom_malloc(
-                    sizeof(double) * histogram_params->count);
-            ogs_assert(upper_bounds);
+            ogs_assert(histogram_params->count <=
+                    OGS_METRICS_HIST_VAR_BUCKETS_MAX);
             for (i = 0; i < histogram_params->count; i++) {
-                upper_bounds[i] = histogram_params->var.buckets[i];
+                spec->upper_bounds[i] = histogram_params->var.buckets[i];
                 if (i > 0)
-                    ogs_assert(upper_bounds[i] > upper_bounds[i - 1]);
+                    ogs_assert(spec->upper_bounds[i] >
+                            spec->upper_bounds[i - 1]);
             }
-            buckets->upper_bounds = upper_bounds;
             break;
         default:
             ogs_assert_if_reached();
             break;
         }
-        spec->prom = prom_histogram_new(spec->name, spec->description,
-                buckets, spec->num_labels, (const char **)spec->labels);
-        ogs_assert(spec->prom);
-        break;
+        /* Rendered by hist_render(), not registered with libprom */
+        ogs_list_add(&ctx->spec_list, &spec->entry);
+        return spec;
     default:
         ogs_assert_if_reached();
         break;
@@ -439,6 +489,8 @@ void ogs_metrics_spec_free(ogs_metrics_spec_t *spec)
     ogs_free(spec->description);
     for (i = 0; i < spec->num_labels; i++)
         ogs_free(spec->labels[i]);
+    if (spec->upper_bounds)
+        ogs_free(spec->upper_bounds);
 
     ogs_pool_free(&metrics_spec_pool, spec);
 }
@@ -475,6 +527,9 @@ void ogs_metrics_inst_free(ogs_metrics_inst_t *inst)
 
     for (i = 0; i < inst->num_labels; i++)
         ogs_free(inst->label_values[i]);
+    for (i = 0; i < MAX_HIST_SHARDS; i++)
+        if (inst->shard[i])
+            free(inst->shard[i]);
 
     ogs_free(inst);
 }
@@ -506,6 +561,434 @@ void ogs_metrics_inst_reset(ogs_metrics_inst_t *inst)
     }
 }
 
+#if defined(_MSC_VER)
+#define HIST_THREAD_LOCAL __declspec(thread)
+#else
+#define HIST_THREAD_LOCAL __thread
+#endif
+
+static int hist_next_shard;
+static HIST_THREAD_LOCAL int hist_shard_id = -1;
+
+/*
+ * Each thread writes to its own shard, so the counters are only ever
+ * contended when more than MAX_HIST_SHARDS threads observe the same
+ * histogram. Relaxed atomics keep that case correct and let the scraper
+ * read the shards without a lock.
+ */
+static void hist_observe(ogs_metrics_inst_t *inst, int val)
+{
+    ogs_metrics_spec_t *spec = inst->spec;
+    hist_shard_t *shard = NULL, *expected = NULL;
+    unsigned int i;
+
+    if (hist_shard_id < 0)
+        hist_shard_id = __atomic_fetch_add(
+                &hist_next_shard, 1, __ATOMIC_RELAXED) % MAX_HIST_SHARDS;
+
+    shard = __atomic_load_n(&inst->shard[hist_shard_id], __ATOMIC_ACQUIRE);
+    if (!shard) {
+        /* Freed with free() in ogs_metrics_inst_free() */
+        shard = calloc(1, sizeof(*shard) +
+                sizeof(uint64_t) * (spec->num_buckets + 1));
+        ogs_assert(shard);
+        if (!__atomic_compare_exchange_n(&inst->shard[hist_shard_id],
+                    &expected, shard, false,
+                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            free(shard);
+            shard = expected;
+        }
+    }
+
+    for (i = 0; i < spec->num_buckets; i++)
+        if ((double)val <= spec->upper_bounds[i])
+            break;
+
+    __atomic_fetch_add(&shard->bucket[i], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&shard->sum, (uint64_t)val, __ATOMIC_RELAXED);
+}
+
+typedef struct render_buf_s {
+    char *data;
+    size_t len;
+    size_t size;
+} render_buf_t;
+
+static void render_printf(render_buf_t *b, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    for (;;) {
+        va_start(ap, fmt);
+        n = vsnprintf(b->data + b->len, b->size - b->len, fmt, ap);
+        va_end(ap);
+        ogs_assert(n >= 0);
+
+        if (b->len + n < b->size)
+            break;
+
+        b->size = ogs_max(b->size * 2, b->len + n + 1);
+        b->data = realloc(b->data, b->size);
+        ogs_assert(b->data);
+    }
+    b->len += n;
+}
+
+static void hist_print_labels(render_buf_t *b,
+        ogs_metrics_inst_t *inst, const char *le)
+{
+    unsigned int i;
+    const char *p;
+    bool first = true;
+
+    if (!inst->num_labels && !le)
+        return;
+
+    render_printf(b, "{");
+    for (i = 0; i < inst->num_labels; i++) {
+        render_printf(b, "%s%s=\"", first ? "" : ",", inst->spec->labels[i]);
+        for (p = inst->label_values[i]; *p; p++) {
+            if (*p == '\\' || *p == '"')
+                render_printf(b, "\\%c", *p);
+            else if (*p == '\n')
+                render_printf(b, "\\n");
+            else
+                render_printf(b, "%c", *p);
+        }
+        render_printf(b, "\"");
+        first = false;
+    }
+    if (le)
+        render_printf(b, "%sle=\"%s\"", first ? "" : ",", le);
+    render_printf(b, "}");
+}
+
+/*
+ * Appends the histograms in the text exposition format to the libprom
+ * output. The returned buffer is released by microhttpd with free().
+ */
+static char *hist_render(char *prom)
+{
+    ogs_metrics_spec_t *spec = NULL;
+    ogs_metrics_inst_t *inst = NULL;
+    render_buf_t b;
+    uint64_t *bucket = NULL;
+    uint64_t count, sum;
+    unsigned int i, j;
+    char le[32];
+
+    ogs_assert(prom);
+    b.len = strlen(prom);
+    b.size = b.len + 1;
+    b.data = prom;
+
+    ogs_list_for_each_entry(&ogs_metrics_self()->spec_list, spec, entry) {
+        if (spec->type != OGS_METRICS_METRIC_TYPE_HISTOGRAM)
+            continue;
+
+        render_printf(&b, "# HELP %s %s\n", spec->name, spec->description);
+        render_printf(&b, "# TYPE %s histogram\n", spec->name);
+
+        bucket = ogs_calloc(spec->num_buckets + 1, sizeof(uint64_t));
+        ogs_assert(bucket);
+
+        ogs_list_for_each_entry(&spec->inst_list, inst, entry) {
+            memset(bucket, 0, sizeof(uint64_t) * (spec->num_buckets + 1));
+            count = sum = 0;
+
+            for (i = 0; i < MAX_HIST_SHARDS; i++) {
+                hist_shard_t *shard = __atomic_load_n(
+                        &inst->shard[i], __ATOMIC_ACQUIRE);
+                if (!shard)
+                    continue;
+                for (j = 0; j <= spec->num_buckets; j++)
+                    bucket[j] += __atomic_load_n(
+                            &shard->bucket[j], __ATOMIC_RELAXED);
+                sum += __atomic_load_n(&shard->sum, __ATOMIC_RELAXED);
+            }
+
+            for (j = 0; j <= spec->num_buckets; j++) {
+                count += bucket[j];
+                if (j < spec->num_buckets)
+                    ogs_snprintf(le, sizeof(le), "%g", spec->upper_bounds[j]);
+                else
+                    ogs_cpystrn(le, "+Inf", sizeof(le));
+
+                render_printf(&b, "%s_bucket", spec->name);
+                hist_print_labels(&b, inst, le);
+                render_printf(&b, " %llu\n", (unsigned long long)count);
+            }
+            render_printf(&b, "%s_sum", spec->name);
+            hist_print_labels(&b, inst, NULL);
+            render_printf(&b, " %llu\n", (unsigned long long)sum);
+            render_printf(&b, "%s_count", spec->name);
+            hist_print_labels(&b, inst, NULL);
+            render_printf(&b, " %llu\n", (unsigned long long)count);
+        }
+
+        ogs_free(bucket);
+    }
+
+    return b.data;
+}
+
+static void prof_print_stat(render_buf_t *b, const char *name,
+        const char *label, const char *value, const ogs_prof_stat_t *src)
+{
+    ogs_prof_stat_t stat;
+    char labels[160];
+
+    ogs_prof_read(&stat, src);
+
+    labels[0] = 0;
+    if (label)
+        ogs_snprintf(labels, sizeof(labels), "{%s=\"%s\"}", label, value);
+
+    render_printf(b, "%s_total%s %llu\n",
+            name, labels, (unsigned long long)stat.count);
+    render_printf(b, "%s_seconds_total%s %.9f\n",
+            name, labels, (double)stat.total / 1e9);
+    render_printf(b, "%s_seconds_max%s %.9f\n",
+            name, labels, (double)stat.max / 1e9);
+}
+
+static void prof_print_table(render_buf_t *b, ogs_prof_t *prof,
+        const char *name, const char *help, const char *label,
+        ogs_prof_entry_t *table)
+{
+    int i;
+    char buf[128];
+    const char *value;
+
+    render_printf(b, "# HELP %s_total Number of %s\n", name, help);
+    render_printf(b, "# TYPE %s_total counter\n", name);
+    render_printf(b, "# HELP %s_seconds_total Time spent in %s\n",
+            name, help);
+    render_printf(b, "# TYPE %s_seconds_total counter\n", name);
+    render_printf(b, "# HELP %s_seconds_max Longest time in one of %s\n",
+            name, help);
+    render_printf(b, "# TYPE %s_seconds_max gauge\n", name);
+
+    for (i = 0; i < OGS_PROF_MAX_ENTRY; i++) {
+        if (!__atomic_load_n(&table[i].key, __ATOMIC_ACQUIRE))
+            continue;
+
+        value = ogs_prof_entry_name(prof, &table[i], buf, sizeof(buf));
+
+        prof_print_stat(b, name, label, value, &table[i].stat);
+    }
+}
+
+/*
+ * Appends the event-loop profile of the NF main loop (see ogs-prof.h).
+ */
+static char *prof_render(char *prom)
+{
+    ogs_prof_t *prof = NULL;
+    render_buf_t b;
+
+    ogs_assert(prom);
+
+    prof = ogs_pollset_prof(ogs_app()->pollset);
+    if (!prof)
+        return prom;
+
+    b.len = strlen(prom);
+    b.size = b.len + 1;
+    b.data = prom;
+
+    render_printf(&b, "# HELP event_loop_iterations_total "
+            "Number of event loop iterations\n");
+    render_printf(&b, "# TYPE event_loop_iterations_total counter\n");
+    render_printf(&b, "# HELP event_loop_iterations_seconds_total "
+            "Time spent processing, excluding the wait in poll\n");
+    render_printf(&b, "# TYPE event_loop_iterations_seconds_total counter\n");
+    render_printf(&b, "# HELP event_loop_iterations_seconds_max "
+            "Longest event loop iteration\n");
+    render_printf(&b, "# TYPE event_loop_iterations_seconds_max gauge\n");
+    prof_print_stat(&b, "event_loop_iterations", NULL, NULL, &prof->iteration);
+
+    render_printf(&b, "# HELP event_loop_timer_lag_total "
+            "Number of expired timers\n");
+    render_printf(&b, "# TYPE event_loop_timer_lag_total counter\n");
+    render_printf(&b, "# HELP event_loop_timer_lag_seconds_total "
+            "Delay between timer expiry and its callback\n");
+    render_printf(&b, "# TYPE event_loop_timer_lag_seconds_total counter\n");
+    render_printf(&b, "# HELP event_loop_timer_lag_seconds_max "
+            "Longest delay between timer expiry and its callback\n");
+    render_printf(&b, "# TYPE event_loop_timer_lag_seconds_max gauge\n");
+    prof_print_stat(&b, "event_loop_timer_lag", NULL, NULL, &prof->timer_lag);
+
+    render_printf(&b, "# HELP event_loop_queue_depth_max "
+            "High-water mark of the event queue\n");
+    render_printf(&b, "# TYPE event_loop_queue_depth_max gauge\n");
+    render_printf(&b, "event_loop_queue_depth_max %llu\n",
+            (unsigned long long)__atomic_load_n(
+                &prof->queue_depth_max, __ATOMIC_RELAXED));
+
+    if (ogs_app()->queue) {
+        render_printf(&b, "# HELP event_loop_queue_depth "
+                "Number of events waiting in the event queue\n");
+        render_printf(&b, "# TYPE event_loop_queue_depth gauge\n");
+        render_printf(&b, "event_loop_queue_depth %u\n",
+                ogs_queue_size(ogs_app()->queue));
+        render_printf(&b, "# HELP event_loop_queue_dropped_total "
+                "Number of events rejected because the queue was full\n");
+        render_printf(&b, "# TYPE event_loop_queue_dropped_total counter\n");
+        render_printf(&b, "event_loop_queue_dropped_total %llu\n",
+                (unsigned long long)ogs_queue_dropped(ogs_app()->queue));
+    }
+
+    prof_print_table(&b, prof, "event_loop_event_dispatch",
+            "dispatched events", "event", prof->event);
+    prof_print_table(&b, prof, "event_loop_state_dispatch",
+            "FSM state handler calls", "state", prof->state);
+    prof_print_table(&b, prof, "event_loop_poll_dispatch",
+            "poll handler calls", "handler", prof->poll);
+
+    return b.data;
+}
+
+typedef struct pool_render_s {
+    render_buf_t *b;
+    const char *name;
+    int which;
+} pool_render_t;
+
+static void pool_print_stat(const ogs_pool_stat_t *stat, void *data)
+{
+    pool_render_t *r = data;
+    unsigned long long value = 0;
+
+    switch (r->which) {
+    case 0:
+        value = stat->used;
+        break;
+    case 1:
+        value = stat->size;
+        break;
+    case 2:
+        value = (unsigned long long)stat->used * stat->object_size;
+        break;
+    case 3:
+        value = (unsigned long long)stat->committed * stat->object_size;
+        break;
+    default:
+        ogs_assert_if_reached();
+    }
+
+    render_printf(r->b, "%s{pool=\"%s\"} %llu\n", r->name, stat->name, value);
+}
+
+/*
+ * Appends the usage of the elastic pools (see ogs-pool.h).
+ */
+static char *pool_render(char *prom)
+{
+    static const char *metric[][2] = {
+        { "pool_objects", "Number of objects in use" },
+        { "pool_objects_max", "Maximum number of objects" },
+        { "pool_used_bytes", "Memory used by the objects in use" },
+        { "pool_committed_bytes", "Memory allocated for the pool" },
+    };
+    render_buf_t b;
+    pool_render_t r;
+    int i;
+
+    ogs_assert(prom);
+    b.len = strlen(prom);
+    b.size = b.len + 1;
+    b.data = prom;
+
+    r.b = &b;
+    for (i = 0; i < (int)OGS_ARRAY_SIZE(metric); i++) {
+        r.name = metric[i][0];
+        r.which = i;
+
+        render_printf(&b, "# HELP %s %s\n", metric[i][0], metric[i][1]);
+        render_printf(&b, "# TYPE %s gauge\n", metric[i][0]);
+        ogs_pool_elastic_stat_all(pool_print_stat, &r);
+    }
+
+    return b.data;
+}
+
+typedef struct hash_render_s {
+    render_buf_t *b;
+    const char *name;
+    int which;
+} hash_render_t;
+
+static void hash_print_stat(const ogs_hash_stat_t *stat, void *data)
+{
+    hash_render_t *r = data;
+    unsigned long long value = 0;
+
+    switch (r->which) {
+    case 0:
+        value = stat->count;
+        break;
+    case 1:
+        value = stat->buckets;
+        break;
+    case 2:
+        value = stat->lookups;
+        break;
+    case 3:
+        value = stat->hits;
+        break;
+    case 4:
+        value = stat->probes;
+        break;
+    case 5:
+        value = stat->replaced;
+        break;
+    default:
+        ogs_assert_if_reached();
+    }
+
+    render_printf(r->b, "%s{hash=\"%s\"} %llu\n", r->name, stat->name, value);
+}
+
+/*
+ * Appends the statistics of the named hash tables (see ogs_hash_set_name()).
+ */
+static char *hash_render(char *prom)
+{
+    static const char *metric[][3] = {
+        { "hash_entries", "gauge", "Number of entries" },
+        { "hash_buckets", "gauge", "Number of buckets" },
+        { "hash_lookups_total", "counter", "Number of lookups" },
+        { "hash_lookup_hits_total", "counter",
+            "Number of lookups that found an entry" },
+        { "hash_probes_total", "counter",
+            "Number of entries compared while searching" },
+        { "hash_replaced_total", "counter",
+            "Number of entries overwritten by a different value" },
+    };
+    render_buf_t b;
+    hash_render_t r;
+    int i;
+
+    ogs_assert(prom);
+    b.len = strlen(prom);
+    b.size = b.len + 1;
+    b.data = prom;
+
+    r.b = &b;
+    for (i = 0; i < (int)OGS_ARRAY_SIZE(metric); i++) {
+        r.name = metric[i][0];
+        r.which = i;
+
+        render_printf(&b, "# HELP %s %s\n", metric[i][0], metric[i][2]);
+        render_printf(&b, "# TYPE %s %s\n", metric[i][0], metric[i][1]);
+        ogs_hash_stat_all(hash_print_stat, &r);
+    }
+
+    return b.data;
+}
+
 void ogs_metrics_inst_add(ogs_metrics_inst_t *inst, int val)
 {
     switch (inst->spec->type) {
@@ -521,7 +1004,7 @@ void ogs_metrics_inst_add(ogs_metrics_inst_t *inst, int val)
         break;
     case OGS_METRICS_METRIC_TYPE_HISTOGRAM:
         ogs_assert(val >= 0);
-        prom_histogram_observe(inst->spec->prom, (double)val, (const char **)inst->label_values);
+        hist_observe(inst, val);
         break;
     default:
         ogs_assert_if_reached();
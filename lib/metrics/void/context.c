@@ -33,8 +33,9 @@ void ogs_metrics_server_init(ogs_metrics_context_t *ctx)
 {
 }
 
-void ogs_metrics_server_open(ogs_metrics_context_t *ctx)
+int ogs_metrics_server_open(ogs_metrics_context_t *ctx)
 {
+    return OGS_OK;
 }
 
 void ogs_metrics_server_close(ogs_metrics_context_t *ctx)
@@ -59,6 +60,11 @@ void ogs_metrics_server_remove_all(void)
 {
 }
 
+char *ogs_metrics_context_render(void)
+{
+    return NULL;
+}
+
 void ogs_metrics_spec_init(ogs_metrics_context_t *ctx)
 {
 }
@@ -65,3 +65,76 @@ void ogs_ngap_free(ogs_ngap_message_t *message)
     ogs_assert(message);
     ogs_asn_free(&asn_DEF_NGAP_NGAP_PDU, message);
 }
+
+int ogs_ngap_lazy_decode(ogs_ngap_lazy_message_t *message, ogs_pkbuf_t *pkbuf)
+{
+    int rv;
+    ogs_asn_ie_view_t *ie = NULL;
+
+    ogs_assert(message);
+    ogs_assert(pkbuf);
+    ogs_assert(pkbuf->data);
+    ogs_assert(pkbuf->len);
+
+    memset(message, 0, sizeof(*message));
+
+    rv = ogs_asn_lazy_decode(&message->h, pkbuf);
+    if (rv != OGS_OK) {
+        ogs_debug("Cannot peek NGAP-PDU");
+        return rv;
+    }
+
+    ie = ogs_asn_lazy_find_ie(&message->h, NGAP_ProtocolIE_ID_id_RAN_UE_NGAP_ID);
+    if (ie) {
+        /* RAN-UE-NGAP-ID ::= INTEGER (0..4294967295) */
+        rv = ogs_asn_lazy_get_uint64(ie, 4, &message->ran_ue_ngap_id);
+        if (rv != OGS_OK) {
+            ogs_warn("Invalid RAN_UE_NGAP_ID");
+            return rv;
+        }
+        message->ran_ue_ngap_id_presence = true;
+    }
+
+    ie = ogs_asn_lazy_find_ie(&message->h, NGAP_ProtocolIE_ID_id_AMF_UE_NGAP_ID);
+    if (ie) {
+        /* AMF-UE-NGAP-ID ::= INTEGER (0..1099511627775) */
+        rv = ogs_asn_lazy_get_uint64(ie, 5, &message->amf_ue_ngap_id);
+        if (rv != OGS_OK) {
+            ogs_warn("Invalid AMF_UE_NGAP_ID");
+            return rv;
+        }
+        message->amf_ue_ngap_id_presence = true;
+    }
+
+    ogs_debug("NGAP-PDU [present:%d,proc:%ld,IEs:%d]",
+            message->h.present, message->h.procedureCode,
+            message->h.num_of_ie);
+
+    return OGS_OK;
+}
+
+ogs_asn_ie_view_t *ogs_ngap_lazy_find_ie(
+        ogs_ngap_lazy_message_t *message, NGAP_ProtocolIE_ID_t id)
+{
+    ogs_assert(message);
+    return ogs_asn_lazy_find_ie(&message->h, id);
+}
+
+int ogs_ngap_lazy_decode_ie(ogs_ngap_lazy_message_t *message,
+        NGAP_ProtocolIE_ID_t id, const asn_TYPE_descriptor_t *td,
+        void *struct_ptr, size_t struct_size)
+{
+    ogs_asn_ie_view_t *ie = NULL;
+
+    ogs_assert(message);
+    ogs_assert(td);
+    ogs_assert(struct_ptr);
+
+    ie = ogs_asn_lazy_find_ie(&message->h, id);
+    if (!ie) {
+        memset(struct_ptr, 0, struct_size);
+        return OGS_ERROR;
+    }
+
+    return ogs_asn_lazy_decode_ie(td, struct_ptr, struct_size, ie);
+}
@@ -34,6 +34,22 @@ int ogs_ngap_decode(ogs_ngap_message_t *message, ogs_pkbuf_t *pkbuf);
 ogs_pkbuf_t *ogs_ngap_encode(ogs_ngap_message_t *message);
 void ogs_ngap_free(ogs_ngap_message_t *message);
 
+typedef struct ogs_ngap_lazy_message_s {
+    ogs_asn_lazy_pdu_t h;
+
+    bool ran_ue_ngap_id_presence;
+    uint64_t ran_ue_ngap_id;
+    bool amf_ue_ngap_id_presence;
+    uint64_t amf_ue_ngap_id;
+} ogs_ngap_lazy_message_t;
+
+int ogs_ngap_lazy_decode(ogs_ngap_lazy_message_t *message, ogs_pkbuf_t *pkbuf);
+ogs_asn_ie_view_t *ogs_ngap_lazy_find_ie(
+        ogs_ngap_lazy_message_t *message, NGAP_ProtocolIE_ID_t id);
+int ogs_ngap_lazy_decode_ie(ogs_ngap_lazy_message_t *message,
+        NGAP_ProtocolIE_ID_t id, const asn_TYPE_descriptor_t *td,
+        void *struct_ptr, size_t struct_size);
+
 #ifdef __cplusplus
 }
 #endif
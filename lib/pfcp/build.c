@@ -925,12 +925,93 @@ void ogs_pfcp_build_create_bar(
     message->bar_id.u8 = bar->id;
 }
 
+static struct {
+    uint32_t sequence;
+    uint8_t metric;
+} lcibuf;
+
+/*
+ * The UP function includes its Load Control Information only when
+ * the peer supports the LOAD feature and has not seen the current
+ * sequence number yet.
+ */
+void ogs_pfcp_build_load_control_information(
+    ogs_pfcp_tlv_load_control_information_t *message, ogs_pfcp_node_t *node)
+{
+    ogs_assert(message);
+    ogs_assert(node);
+
+    if (!ogs_pfcp_self()->cp_function_features.load)
+        return;
+    if (!ogs_pfcp_self()->load.sequence ||
+        node->load.sequence == ogs_pfcp_self()->load.sequence)
+        return;
+
+    node->load.sequence = ogs_pfcp_self()->load.sequence;
+    node->load.metric = ogs_pfcp_self()->load.metric;
+
+    lcibuf.sequence = htobe32(node->load.sequence);
+    lcibuf.metric = node->load.metric;
+
+    message->presence = 1;
+    message->load_control_sequence_number.presence = 1;
+    message->load_control_sequence_number.data = &lcibuf.sequence;
+    message->load_control_sequence_number.len = sizeof(lcibuf.sequence);
+    message->load_metric.presence = 1;
+    message->load_metric.data = &lcibuf.metric;
+    message->load_metric.len = sizeof(lcibuf.metric);
+}
+
+static struct {
+    uint32_t sequence;
+    uint8_t reduction;
+    uint8_t validity;
+    uint8_t flags;
+} ocibuf;
+
+void ogs_pfcp_build_overload_control_information(
+    ogs_pfcp_tlv_overload_control_information_t *message,
+    ogs_pfcp_node_t *node)
+{
+    ogs_assert(message);
+    ogs_assert(node);
+
+    if (!ogs_pfcp_self()->cp_function_features.ovrl)
+        return;
+    if (!ogs_pfcp_self()->overload.sequence ||
+        node->overload.sequence == ogs_pfcp_self()->overload.sequence)
+        return;
+
+    node->overload.sequence = ogs_pfcp_self()->overload.sequence;
+    node->overload.reduction = ogs_pfcp_self()->overload.reduction;
+
+    ocibuf.sequence = htobe32(node->overload.sequence);
+    ocibuf.reduction = node->overload.reduction;
+    ocibuf.validity = ogs_pfcp_timer_from_sec(
+            ogs_time_sec(ogs_pfcp_self()->overload.validity));
+    ocibuf.flags = OGS_PFCP_OCI_FLAGS_AOCI;
+
+    message->presence = 1;
+    message->overload_control_sequence_number.presence = 1;
+    message->overload_control_sequence_number.data = &ocibuf.sequence;
+    message->overload_control_sequence_number.len = sizeof(ocibuf.sequence);
+    message->overload_reduction_metric.presence = 1;
+    message->overload_reduction_metric.data = &ocibuf.reduction;
+    message->overload_reduction_metric.len = sizeof(ocibuf.reduction);
+    message->period_of_validity.presence = 1;
+    message->period_of_validity.data = &ocibuf.validity;
+    message->period_of_validity.len = sizeof(ocibuf.validity);
+    message->overload_control_information_flags.presence = 1;
+    message->overload_control_information_flags.data = &ocibuf.flags;
+    message->overload_control_information_flags.len = sizeof(ocibuf.flags);
+}
+
 static struct {
     ogs_pfcp_volume_measurement_t vol_meas;
 } usage_report_buf;
 
-ogs_pkbuf_t *ogs_pfcp_build_session_report_request(
-        uint8_t type, ogs_pfcp_user_plane_report_t *report)
+ogs_pkbuf_t *ogs_pfcp_build_session_report_request(uint8_t type,
+        ogs_pfcp_node_t *node, ogs_pfcp_user_plane_report_t *report)
 {
     ogs_pfcp_message_t *pfcp_message = NULL;
     ogs_pfcp_session_report_request_t *req = NULL;
@@ -1059,6 +1140,13 @@ ogs_pkbuf_t *ogs_pfcp_build_session_report_request(
             report->error_indication.remote_f_teid_len;
     }
 
+    if (node) {
+        ogs_pfcp_build_load_control_information(
+                &req->load_control_information, node);
+        ogs_pfcp_build_overload_control_information(
+                &req->overload_control_information, node);
+    }
+
     pfcp_message->h.type = type;
     pkbuf = ogs_pfcp_build_msg(pfcp_message);
     ogs_expect(pkbuf);
@@ -1097,8 +1185,121 @@ ogs_pkbuf_t *ogs_pfcp_build_session_report_response(
     return pkbuf;
 }
 
+ogs_pkbuf_t *ogs_pfcp_cp_build_session_set_deletion_request(
+        uint8_t type, uint16_t *csid, int num_of_csid)
+{
+    ogs_pfcp_message_t *pfcp_message = NULL;
+    ogs_pfcp_session_set_deletion_request_t *req = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    ogs_pfcp_node_id_t node_id;
+    ogs_pfcp_fq_csid_t fq_csid;
+    char fq_csid_buf[OGS_PFCP_MAX_FQ_CSID_LEN];
+    int node_id_len = 0, rv, i;
+
+    ogs_debug("PFCP session set deletion request");
+
+    pfcp_message = ogs_calloc(1, sizeof(*pfcp_message));
+    if (!pfcp_message) {
+        ogs_error("ogs_calloc() failed");
+        return NULL;
+    }
+
+    req = &pfcp_message->pfcp_session_set_deletion_request;
+
+    rv = ogs_pfcp_sockaddr_to_node_id(&node_id, &node_id_len);
+    if (rv != OGS_OK) {
+        ogs_error("ogs_pfcp_sockaddr_to_node_id() failed");
+        ogs_free(pfcp_message);
+        return NULL;
+    }
+    req->node_id.presence = 1;
+    req->node_id.data = &node_id;
+    req->node_id.len = node_id_len;
+
+    ogs_assert(csid);
+    ogs_assert(num_of_csid > 0 && num_of_csid <= OGS_PFCP_MAX_NUM_OF_CSID);
+    rv = ogs_pfcp_sockaddr_to_fq_csid(&fq_csid, csid[0]);
+    if (rv != OGS_OK) {
+        ogs_error("ogs_pfcp_sockaddr_to_fq_csid() failed");
+        ogs_free(pfcp_message);
+        return NULL;
+    }
+    for (i = 1; i < num_of_csid; i++)
+        fq_csid.csid[fq_csid.num_of_csid++] = csid[i];
+    req->pgw_c_smf_fq_csid.presence = 1;
+    ogs_pfcp_build_fq_csid(&req->pgw_c_smf_fq_csid,
+            &fq_csid, fq_csid_buf, sizeof(fq_csid_buf));
+
+    pfcp_message->h.type = type;
+    pkbuf = ogs_pfcp_build_msg(pfcp_message);
+    ogs_expect(pkbuf);
+
+    ogs_free(pfcp_message);
+
+    return pkbuf;
+}
+
+/* Builds either a Session Set Deletion or Modification Response */
+ogs_pkbuf_t *ogs_pfcp_build_session_set_response(uint8_t type, uint8_t cause)
+{
+    ogs_pfcp_message_t *pfcp_message = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    ogs_pfcp_node_id_t node_id;
+    int node_id_len = 0, rv;
+
+    ogs_debug("PFCP session set response");
+
+    pfcp_message = ogs_calloc(1, sizeof(*pfcp_message));
+    if (!pfcp_message) {
+        ogs_error("ogs_calloc() failed");
+        return NULL;
+    }
+
+    rv = ogs_pfcp_sockaddr_to_node_id(&node_id, &node_id_len);
+    if (rv != OGS_OK) {
+        ogs_error("ogs_pfcp_sockaddr_to_node_id() failed");
+        ogs_free(pfcp_message);
+        return NULL;
+    }
+
+    if (type == OGS_PFCP_SESSION_SET_DELETION_RESPONSE_TYPE) {
+        ogs_pfcp_session_set_deletion_response_t *rsp =
+            &pfcp_message->pfcp_session_set_deletion_response;
+
+        rsp->node_id.presence = 1;
+        rsp->node_id.data = &node_id;
+        rsp->node_id.len = node_id_len;
+
+        rsp->cause.presence = 1;
+        rsp->cause.u8 = cause;
+    } else if (type == OGS_PFCP_SESSION_SET_MODIFICATION_RESPONSE_TYPE) {
+        ogs_pfcp_session_set_modification_response_t *rsp =
+            &pfcp_message->pfcp_session_set_modification_response;
+
+        rsp->node_id.presence = 1;
+        rsp->node_id.data = &node_id;
+        rsp->node_id.len = node_id_len;
+
+        rsp->cause.presence = 1;
+        rsp->cause.u8 = cause;
+    } else {
+        ogs_fatal("Invalid type[%d]", type);
+        ogs_assert_if_reached();
+    }
+
+    pfcp_message->h.type = type;
+    pkbuf = ogs_pfcp_build_msg(pfcp_message);
+    ogs_expect(pkbuf);
+
+    ogs_free(pfcp_message);
+
+    return pkbuf;
+}
+
 ogs_pkbuf_t *ogs_pfcp_build_session_deletion_response( uint8_t type, uint8_t cause,
-        ogs_pfcp_user_plane_report_t *report)
+        ogs_pfcp_node_t *node, ogs_pfcp_user_plane_report_t *report)
 {
     ogs_pfcp_message_t *pfcp_message = NULL;
     ogs_pfcp_session_deletion_response_t *rsp = NULL;
@@ -1168,6 +1369,14 @@ ogs_pkbuf_t *ogs_pfcp_build_session_deletion_response( uint8_t type, uint8_t cau
             }
         }
     }
+
+    if (node) {
+        ogs_pfcp_build_load_control_information(
+                &rsp->load_control_information, node);
+        ogs_pfcp_build_overload_control_information(
+                &rsp->overload_control_information, node);
+    }
+
     pfcp_message->h.type = type;
     pkbuf = ogs_pfcp_build_msg(pfcp_message);
     ogs_expect(pkbuf);
@@ -66,13 +66,23 @@ void ogs_pfcp_build_update_urr(
 void ogs_pfcp_build_create_bar(
     ogs_pfcp_tlv_create_bar_t *message, ogs_pfcp_bar_t *bar);
 
-ogs_pkbuf_t *ogs_pfcp_build_session_report_request(
-        uint8_t type, ogs_pfcp_user_plane_report_t *report);
+void ogs_pfcp_build_load_control_information(
+    ogs_pfcp_tlv_load_control_information_t *message, ogs_pfcp_node_t *node);
+void ogs_pfcp_build_overload_control_information(
+    ogs_pfcp_tlv_overload_control_information_t *message,
+    ogs_pfcp_node_t *node);
+
+ogs_pkbuf_t *ogs_pfcp_build_session_report_request(uint8_t type,
+        ogs_pfcp_node_t *node, ogs_pfcp_user_plane_report_t *report);
 ogs_pkbuf_t *ogs_pfcp_build_session_report_response(
         uint8_t type, uint8_t cause);
 
+ogs_pkbuf_t *ogs_pfcp_cp_build_session_set_deletion_request(
+        uint8_t type, uint16_t *csid, int num_of_csid);
+ogs_pkbuf_t *ogs_pfcp_build_session_set_response(uint8_t type, uint8_t cause);
+
 ogs_pkbuf_t *ogs_pfcp_build_session_deletion_response( uint8_t type, uint8_t cause,
-        ogs_pfcp_user_plane_report_t *report);
+        ogs_pfcp_node_t *node, ogs_pfcp_user_plane_report_t *report);
 
 
 #ifdef __cplusplus
@@ -41,6 +41,9 @@ static OGS_POOL(ogs_pfcp_rule_pool, ogs_pfcp_rule_t);
 static OGS_POOL(ogs_pfcp_dev_pool, ogs_pfcp_dev_t);
 static OGS_POOL(ogs_pfcp_subnet_pool, ogs_pfcp_subnet_t);
 
+static void ue_ip_pool_generate(ogs_pfcp_subnet_t *subnet);
+static void ue_ip_pool_final(ogs_pfcp_ue_ip_pool_t *pool);
+
 void ogs_pfcp_context_init(void)
 {
     int i;
@@ -55,18 +58,18 @@ void ogs_pfcp_context_init(void)
 
     ogs_pool_init(&ogs_pfcp_node_pool, ogs_app()->pool.nf);
 
-    ogs_pool_init(&ogs_pfcp_sess_pool, ogs_app()->pool.sess);
+    ogs_pool_init_elastic(&ogs_pfcp_sess_pool, ogs_app()->pool.sess);
 
-    ogs_pool_init(&ogs_pfcp_far_pool,
+    ogs_pool_init_elastic(&ogs_pfcp_far_pool,
             ogs_app()->pool.sess * OGS_MAX_NUM_OF_FAR);
-    ogs_pool_init(&ogs_pfcp_urr_pool,
+    ogs_pool_init_elastic(&ogs_pfcp_urr_pool,
             ogs_app()->pool.sess * OGS_MAX_NUM_OF_URR);
-    ogs_pool_init(&ogs_pfcp_qer_pool,
+    ogs_pool_init_elastic(&ogs_pfcp_qer_pool,
             ogs_app()->pool.sess * OGS_MAX_NUM_OF_QER);
-    ogs_pool_init(&ogs_pfcp_bar_pool,
+    ogs_pool_init_elastic(&ogs_pfcp_bar_pool,
             ogs_app()->pool.sess * OGS_MAX_NUM_OF_BAR);
 
-    ogs_pool_init(&ogs_pfcp_pdr_pool,
+    ogs_pool_init_elastic(&ogs_pfcp_pdr_pool,
             ogs_app()->pool.sess * OGS_MAX_NUM_OF_PDR);
     ogs_pool_init(&ogs_pfcp_pdr_teid_pool, ogs_pfcp_pdr_pool.size);
     ogs_pool_random_id_generate(&ogs_pfcp_pdr_teid_pool);
@@ -77,7 +80,7 @@ void ogs_pfcp_context_init(void)
     for (i = 0; i < ogs_pfcp_pdr_pool.size; i++)
         pdr_random_to_index[ogs_pfcp_pdr_teid_pool.array[i]] = i;
 
-    ogs_pool_init(&ogs_pfcp_rule_pool,
+    ogs_pool_init_elastic(&ogs_pfcp_rule_pool,
             ogs_app()->pool.sess *
             OGS_MAX_NUM_OF_PDR * OGS_MAX_NUM_OF_FLOW_IN_PDR);
 
@@ -140,6 +143,11 @@ static int ogs_pfcp_context_prepare(void)
 
     self.tun_ifname = "ogstun";
 
+    self.buffer.max_bytes = OGS_PFCP_DEFAULT_BUFFER_BYTES;
+    self.buffer.session_bytes = OGS_PFCP_DEFAULT_BUFFER_SESSION_BYTES;
+    self.buffer.session_packets = OGS_MAX_NUM_OF_PACKET_BUFFER;
+    self.buffer.duration = OGS_PFCP_DEFAULT_BUFFER_DURATION;
+
     return OGS_OK;
 }
 
@@ -214,6 +222,132 @@ static int ogs_pfcp_context_validation(const char *local)
     return OGS_OK;
 }
 
+static int parse_session_conf(ogs_yaml_iter_t *local_iter)
+{
+    ogs_yaml_iter_t subnet_array, subnet_iter;
+
+    ogs_assert(local_iter);
+
+    ogs_yaml_iter_recurse(local_iter, &subnet_array);
+    do {
+        ogs_pfcp_subnet_t *subnet = NULL;
+        const char *ipstr = NULL;
+        const char *gateway = NULL;
+        const char *mask_or_numbits = NULL;
+        const char *dnn = NULL;
+        const char *dev = self.tun_ifname;
+        const char *low[OGS_MAX_NUM_OF_SUBNET_RANGE];
+        const char *high[OGS_MAX_NUM_OF_SUBNET_RANGE];
+        int i, num = 0;
+        ogs_ipsubnet_t check;
+
+        memset(low, 0, sizeof(low));
+        memset(high, 0, sizeof(high));
+
+        if (ogs_yaml_iter_type(&subnet_array) == YAML_MAPPING_NODE) {
+            memcpy(&subnet_iter, &subnet_array, sizeof(ogs_yaml_iter_t));
+        } else if (ogs_yaml_iter_type(&subnet_array) == YAML_SEQUENCE_NODE) {
+            if (!ogs_yaml_iter_next(&subnet_array))
+                break;
+            ogs_yaml_iter_recurse(&subnet_array, &subnet_iter);
+        } else if (ogs_yaml_iter_type(&subnet_array) == YAML_SCALAR_NODE) {
+            break;
+        } else
+            ogs_assert_if_reached();
+
+        while (ogs_yaml_iter_next(&subnet_iter)) {
+            const char *subnet_key = ogs_yaml_iter_key(&subnet_iter);
+            ogs_assert(subnet_key);
+            if (!strcmp(subnet_key, "subnet")) {
+                char *v = (char *)ogs_yaml_iter_value(&subnet_iter);
+                if (v) {
+                    ipstr = (const char *)strsep(&v, "/");
+                    if (ipstr) {
+                        mask_or_numbits = (const char *)v;
+                    }
+                }
+            } else if (!strcmp(subnet_key, "gateway")) {
+                gateway = ogs_yaml_iter_value(&subnet_iter);
+            } else if (!strcmp(subnet_key, "apn") ||
+                        !strcmp(subnet_key, "dnn")) {
+                dnn = ogs_yaml_iter_value(&subnet_iter);
+            } else if (!strcmp(subnet_key, "dev")) {
+                dev = ogs_yaml_iter_value(&subnet_iter);
+            } else if (!strcmp(subnet_key, "range")) {
+                ogs_yaml_iter_t range_iter;
+                ogs_yaml_iter_recurse(&subnet_iter, &range_iter);
+                ogs_assert(ogs_yaml_iter_type(&range_iter) !=
+                    YAML_MAPPING_NODE);
+                do {
+                    char *v = NULL;
+
+                    if (ogs_yaml_iter_type(&range_iter) == YAML_SEQUENCE_NODE) {
+                        if (!ogs_yaml_iter_next(&range_iter))
+                            break;
+                    }
+
+                    v = (char *)ogs_yaml_iter_value(&range_iter);
+                    if (v) {
+                        ogs_assert(num < OGS_MAX_NUM_OF_SUBNET_RANGE);
+                        low[num] = (const char *)strsep(&v, "-");
+                        if (low[num] && strlen(low[num]) == 0)
+                            low[num] = NULL;
+
+                        high[num] = (const char *)v;
+                        if (high[num] && strlen(high[num]) == 0)
+                            high[num] = NULL;
+                    }
+
+                    if (low[num] || high[num]) num++;
+                } while (ogs_yaml_iter_type(&range_iter) ==
+                    YAML_SEQUENCE_NODE);
+            } else
+                ogs_warn("unknown key `%s`", subnet_key);
+        }
+
+        /* Checked here, as the file may be re-read while running */
+        if (ipstr && mask_or_numbits &&
+            ogs_ipsubnet(&check, ipstr, mask_or_numbits) != OGS_OK) {
+            ogs_error("Invalid subnet [%s/%s]", ipstr, mask_or_numbits);
+            return OGS_ERROR;
+        }
+        if (gateway && ogs_ipsubnet(&check, gateway, NULL) != OGS_OK) {
+            ogs_error("Invalid gateway [%s]", gateway);
+            return OGS_ERROR;
+        }
+        for (i = 0; i < num; i++) {
+            if ((low[i] && ogs_ipsubnet(&check, low[i], NULL) != OGS_OK) ||
+                (high[i] && ogs_ipsubnet(&check, high[i], NULL) != OGS_OK)) {
+                ogs_error("Invalid range [%s-%s]",
+                        low[i] ? low[i] : "", high[i] ? high[i] : "");
+                return OGS_ERROR;
+            }
+        }
+        if (!dev) {
+            ogs_error("No dev for subnet [%s]", ipstr ? ipstr : "");
+            return OGS_ERROR;
+        }
+        if (!ogs_pool_avail(&ogs_pfcp_subnet_pool) ||
+            (!ogs_pfcp_dev_find_by_ifname(dev) &&
+             !ogs_pool_avail(&ogs_pfcp_dev_pool))) {
+            ogs_error("Too many subnets [%s]", ipstr ? ipstr : "");
+            return OGS_ERROR;
+        }
+
+        subnet = ogs_pfcp_subnet_add(ipstr, mask_or_numbits, gateway, dnn, dev);
+        ogs_assert(subnet);
+
+        subnet->num_of_range = num;
+        for (i = 0; i < subnet->num_of_range; i++) {
+            subnet->range[i].low = low[i];
+            subnet->range[i].high = high[i];
+        }
+
+    } while (ogs_yaml_iter_type(&subnet_array) == YAML_SEQUENCE_NODE);
+
+    return OGS_OK;
+}
+
 int ogs_pfcp_context_parse_config(const char *local, const char *remote)
 {
     int rv;
@@ -464,6 +598,8 @@ int ogs_pfcp_context_parse_config(const char *local, const char *remote)
                                         uint64_t nr_cell_id[
                                             OGS_MAX_NUM_OF_CELL_ID] = {0,};
                                         int num_of_nr_cell_id = 0;
+                                        uint16_t capacity =
+                                            OGS_PFCP_DEFAULT_CAPACITY;
 
                                         if (ogs_yaml_iter_type(&remote_array) ==
                                                 YAML_MAPPING_NODE) {
@@ -681,6 +817,12 @@ int ogs_pfcp_context_parse_config(const char *local, const char *remote)
                                                 } while (ogs_yaml_iter_type(
                                                         &nr_cell_id_iter) ==
                                                         YAML_SEQUENCE_NODE);
+                                            } else if (!strcmp(remote_key,
+                                                        "capacity")) {
+                                                const char *v =
+                                                    ogs_yaml_iter_value(
+                                                            &remote_iter);
+                                                if (v) capacity = atoi(v);
                                             } else
                                                 ogs_warn("unknown key `%s`",
                                                         remote_key);
@@ -730,6 +872,8 @@ int ogs_pfcp_context_parse_config(const char *local, const char *remote)
                                             memcpy(node->nr_cell_id, nr_cell_id,
                                                     sizeof(node->nr_cell_id));
 
+                                        node->capacity = capacity;
+
                                     } while (ogs_yaml_iter_type(
                                                 &remote_array) ==
                                             YAML_SEQUENCE_NODE);
@@ -739,108 +883,32 @@ int ogs_pfcp_context_parse_config(const char *local, const char *remote)
                             ogs_warn("unknown key `%s`", pfcp_key);
                     }
                 } else if (!strcmp(local_key, "session")) {
-                    ogs_yaml_iter_t subnet_array, subnet_iter;
-                    ogs_yaml_iter_recurse(&local_iter, &subnet_array);
-
-                    do {
-                        ogs_pfcp_subnet_t *subnet = NULL;
-                        const char *ipstr = NULL;
-                        const char *gateway = NULL;
-                        const char *mask_or_numbits = NULL;
-                        const char *dnn = NULL;
-                        const char *dev = self.tun_ifname;
-                        const char *low[OGS_MAX_NUM_OF_SUBNET_RANGE];
-                        const char *high[OGS_MAX_NUM_OF_SUBNET_RANGE];
-                        int i, num = 0;
-
-                        memset(low, 0, sizeof(low));
-                        memset(high, 0, sizeof(high));
-
-                        if (ogs_yaml_iter_type(&subnet_array) ==
-                                YAML_MAPPING_NODE) {
-                            memcpy(&subnet_iter, &subnet_array,
-                                    sizeof(ogs_yaml_iter_t));
-                        } else if (ogs_yaml_iter_type(&subnet_array) ==
-                                YAML_SEQUENCE_NODE) {
-                            if (!ogs_yaml_iter_next(&subnet_array))
-                                break;
-                            ogs_yaml_iter_recurse(&subnet_array, &subnet_iter);
-                        } else if (ogs_yaml_iter_type(&subnet_array) ==
-                                YAML_SCALAR_NODE) {
-                            break;
+                    rv = parse_session_conf(&local_iter);
+                    if (rv != OGS_OK) return rv;
+                } else if (!strcmp(local_key, "buffer")) {
+                    ogs_yaml_iter_t buffer_iter;
+                    ogs_yaml_iter_recurse(&local_iter, &buffer_iter);
+
+                    while (ogs_yaml_iter_next(&buffer_iter)) {
+                        const char *buffer_key =
+                            ogs_yaml_iter_key(&buffer_iter);
+                        const char *v = ogs_yaml_iter_value(&buffer_iter);
+                        ogs_assert(buffer_key);
+
+                        if (!v) {
+                            /* Nothing */
+                        } else if (!strcmp(buffer_key, "bytes")) {
+                            self.buffer.max_bytes = atoll(v);
+                        } else if (!strcmp(buffer_key, "session_bytes")) {
+                            self.buffer.session_bytes = atoi(v);
+                        } else if (!strcmp(buffer_key, "session_packets")) {
+                            self.buffer.session_packets = atoi(v);
+                        } else if (!strcmp(buffer_key, "duration")) {
+                            self.buffer.duration =
+                                ogs_time_from_msec(atoll(v));
                         } else
-                            ogs_assert_if_reached();
-
-                        while (ogs_yaml_iter_next(&subnet_iter)) {
-                            const char *subnet_key =
-                                ogs_yaml_iter_key(&subnet_iter);
-                            ogs_assert(subnet_key);
-                            if (!strcmp(subnet_key, "subnet")) {
-                                char *v =
-                                    (char *)ogs_yaml_iter_value(&subnet_iter);
-                                if (v) {
-                                    ipstr = (const char *)strsep(&v, "/");
-                                    if (ipstr) {
-                                        mask_or_numbits = (const char *)v;
-                                    }
-                                }
-                            } else if (!strcmp(subnet_key, "gateway")) {
-                                gateway = ogs_yaml_iter_value(&subnet_iter);
-                            } else if (!strcmp(subnet_key, "apn") ||
-                                        !strcmp(subnet_key, "dnn")) {
-                                dnn = ogs_yaml_iter_value(&subnet_iter);
-                            } else if (!strcmp(subnet_key, "dev")) {
-                                dev = ogs_yaml_iter_value(&subnet_iter);
-                            } else if (!strcmp(subnet_key, "range")) {
-                                ogs_yaml_iter_t range_iter;
-                                ogs_yaml_iter_recurse(
-                                        &subnet_iter, &range_iter);
-                                ogs_assert(ogs_yaml_iter_type(&range_iter) !=
-                                    YAML_MAPPING_NODE);
-                                do {
-                                    char *v = NULL;
-
-                                    if (ogs_yaml_iter_type(&range_iter) ==
-                                            YAML_SEQUENCE_NODE) {
-                                        if (!ogs_yaml_iter_next(&range_iter))
-                                            break;
-                                    }
-
-                                    v = (char *)
-                                        ogs_yaml_iter_value(&range_iter);
-                                    if (v) {
-                                        ogs_assert(num <
-                                                OGS_MAX_NUM_OF_SUBNET_RANGE);
-                                        low[num] =
-                                            (const char *)strsep(&v, "-");
-                                        if (low[num] && strlen(low[num]) == 0)
-                                            low[num] = NULL;
-
-                                        high[num] = (const char *)v;
-                                        if (high[num] && strlen(high[num]) == 0)
-                                            high[num] = NULL;
-                                    }
-
-                                    if (low[num] || high[num]) num++;
-                                } while (
-                                    ogs_yaml_iter_type(&range_iter) ==
-                                    YAML_SEQUENCE_NODE);
-                            } else
-                                ogs_warn("unknown key `%s`", subnet_key);
-                        }
-
-                        subnet = ogs_pfcp_subnet_add(
-                                ipstr, mask_or_numbits, gateway, dnn, dev);
-                        ogs_assert(subnet);
-
-                        subnet->num_of_range = num;
-                        for (i = 0; i < subnet->num_of_range; i++) {
-                            subnet->range[i].low = low[i];
-                            subnet->range[i].high = high[i];
-                        }
-
-                    } while (ogs_yaml_iter_type(&subnet_array) ==
-                            YAML_SEQUENCE_NODE);
+                            ogs_warn("unknown key `%s`", buffer_key);
+                    }
                 }
             }
         }
@@ -852,6 +920,162 @@ int ogs_pfcp_context_parse_config(const char *local, const char *remote)
     return OGS_OK;
 }
 
+static bool subnet_range_same(const char *a, const char *b)
+{
+    if (!a || !b)
+        return a == b;
+    return !strcmp(a, b);
+}
+
+static bool subnet_same(ogs_pfcp_subnet_t *a, ogs_pfcp_subnet_t *b)
+{
+    int i;
+
+    if (a->family != b->family || a->prefixlen != b->prefixlen ||
+        a->dev != b->dev || strcmp(a->dnn, b->dnn) ||
+        memcmp(&a->sub, &b->sub, sizeof(a->sub)) ||
+        memcmp(&a->gw, &b->gw, sizeof(a->gw)) ||
+        a->num_of_range != b->num_of_range)
+        return false;
+
+    for (i = 0; i < a->num_of_range; i++) {
+        if (!subnet_range_same(a->range[i].low, b->range[i].low) ||
+            !subnet_range_same(a->range[i].high, b->range[i].high))
+            return false;
+    }
+
+    return true;
+}
+
+static ogs_pfcp_subnet_t *subnet_find_same(
+        ogs_list_t *list, ogs_pfcp_subnet_t *subnet)
+{
+    ogs_pfcp_subnet_t *iter = NULL;
+
+    ogs_list_for_each(list, iter) {
+        if (subnet_same(iter, subnet))
+            return iter;
+    }
+
+    return NULL;
+}
+
+/*
+ * Re-reads the "session" subnets of the NF section on a configuration
+ * reload. A subnet that is configured as before keeps its UE IP pool and
+ * the addresses handed out from it. A new subnet gets a fresh pool after
+ * setup() accepts it, and a subnet that is no longer configured is only
+ * dropped once none of its addresses are in use.
+ */
+int ogs_pfcp_context_reload_subnet(
+        const char *local, int (*setup)(ogs_pfcp_subnet_t *subnet))
+{
+    int rv = OGS_OK;
+    yaml_document_t *document = NULL;
+    ogs_yaml_iter_t root_iter;
+    int idx = 0;
+    ogs_list_t running;
+    ogs_pfcp_dev_t *last_dev = NULL, *dev = NULL;
+    ogs_pfcp_subnet_t *subnet = NULL, *next_subnet = NULL, *old = NULL;
+
+    ogs_assert(local);
+
+    document = ogs_app()->document;
+    ogs_assert(document);
+
+    /* Parsed into an empty list, the running one is set aside */
+    memcpy(&running, &self.subnet_list, sizeof(running));
+    ogs_list_init(&self.subnet_list);
+    last_dev = ogs_list_last(&self.dev_list);
+
+    ogs_yaml_iter_init(&root_iter, document);
+    while (ogs_yaml_iter_next(&root_iter)) {
+        const char *root_key = ogs_yaml_iter_key(&root_iter);
+        ogs_assert(root_key);
+        if ((!strcmp(root_key, local)) &&
+            idx++ == ogs_app()->config_section_id) {
+            ogs_yaml_iter_t local_iter;
+            ogs_yaml_iter_recurse(&root_iter, &local_iter);
+            while (ogs_yaml_iter_next(&local_iter)) {
+                const char *local_key = ogs_yaml_iter_key(&local_iter);
+                ogs_assert(local_key);
+                if (!strcmp(local_key, "session")) {
+                    rv = parse_session_conf(&local_iter);
+                    if (rv != OGS_OK) goto cleanup;
+                }
+            }
+        }
+    }
+
+    if (!ogs_list_first(&self.subnet_list) && ogs_list_first(&running)) {
+        ogs_error("No session subnet left in '%s'", ogs_app()->file);
+        rv = OGS_ERROR;
+        goto cleanup;
+    }
+
+    ogs_list_for_each(&running, old) {
+        uint32_t in_use = old->pool.capacity - old->pool.avail +
+            old->pool.num_of_static;
+
+        if (in_use && !subnet_find_same(&self.subnet_list, old)) {
+            ogs_error("Subnet [%s] of dev [%s] still has %d UE IPs in use",
+                    old->dnn, old->dev->ifname, in_use);
+            rv = OGS_ERROR;
+            goto cleanup;
+        }
+    }
+
+    ogs_list_for_each(&self.subnet_list, subnet) {
+        if (subnet_find_same(&running, subnet))
+            continue;
+        if (setup && setup(subnet) != OGS_OK) {
+            rv = OGS_ERROR;
+            goto cleanup;
+        }
+    }
+
+    /* Nothing can fail from here on */
+    ogs_list_for_each_safe(&self.subnet_list, next_subnet, subnet) {
+        old = subnet_find_same(&running, subnet);
+        if (old) {
+            ogs_list_remove(&running, old);
+            ogs_list_insert_prev(&self.subnet_list, subnet, old);
+            ogs_pfcp_subnet_remove(subnet);
+        } else if (subnet->family == AF_INET || subnet->family == AF_INET6) {
+            ue_ip_pool_generate(subnet);
+        }
+    }
+
+    ogs_list_for_each_safe(&running, next_subnet, old) {
+        ogs_list_remove(&running, old);
+        ue_ip_pool_final(&old->pool);
+        ogs_pool_free(&ogs_pfcp_subnet_pool, old);
+    }
+
+    return OGS_OK;
+
+cleanup:
+    ogs_pfcp_subnet_remove_all();
+    memcpy(&self.subnet_list, &running, sizeof(running));
+
+    while ((dev = last_dev ? ogs_list_next(last_dev) :
+                ogs_list_first(&self.dev_list)))
+        ogs_pfcp_dev_remove(dev);
+
+    return rv;
+}
+
+uint16_t ogs_pfcp_csid_next(void)
+{
+    static uint16_t csid = 0;
+
+    /* CSID 0 is kept to mean none */
+    if (++csid == 0)
+        csid++;
+
+    return csid;
+}
+
 ogs_pfcp_node_t *ogs_pfcp_node_new(ogs_sockaddr_t *sa_list)
 {
     ogs_pfcp_node_t *node = NULL;
@@ -866,6 +1090,8 @@ ogs_pfcp_node_t *ogs_pfcp_node_new(ogs_sockaddr_t *sa_list)
     memset(node, 0, sizeof(ogs_pfcp_node_t));
 
     node->sa_list = sa_list;
+    node->capacity = OGS_PFCP_DEFAULT_CAPACITY;
+    node->csid = ogs_pfcp_csid_next();
 
     ogs_list_init(&node->local_list);
     ogs_list_init(&node->remote_list);
@@ -947,6 +1173,63 @@ void ogs_pfcp_node_remove_all(ogs_list_t *list)
         ogs_pfcp_node_remove(list, node);
 }
 
+bool ogs_pfcp_node_overloaded(ogs_pfcp_node_t *node)
+{
+    ogs_assert(node);
+
+    if (!node->overload.expires || !node->overload.reduction)
+        return false;
+
+    if (node->overload.expires != OGS_INFINITE_TIME &&
+        node->overload.expires <= ogs_get_monotonic_time()) {
+        node->overload.expires = 0;
+        return false;
+    }
+
+    return true;
+}
+
+/* An overloaded node turns away its Overload Reduction Metric share */
+bool ogs_pfcp_node_throttled(ogs_pfcp_node_t *node)
+{
+    ogs_assert(node);
+
+    if (!ogs_pfcp_node_overloaded(node))
+        return false;
+
+    return ogs_random32() % 100 < node->overload.reduction;
+}
+
+/*
+ * Smooth weighted round-robin. A node's weight is its configured
+ * capacity scaled by the headroom left by its last reported Load
+ * Metric, so equally loaded nodes are still visited in turn.
+ */
+void ogs_pfcp_node_rr_offer(ogs_pfcp_node_rr_t *rr, ogs_pfcp_node_t *node)
+{
+    int weight;
+
+    ogs_assert(rr);
+    ogs_assert(node);
+
+    weight = node->capacity * (101 - node->load.metric);
+    node->weight += weight;
+    rr->total += weight;
+
+    if (!rr->selected || node->weight > rr->selected->weight)
+        rr->selected = node;
+}
+
+ogs_pfcp_node_t *ogs_pfcp_node_rr_select(ogs_pfcp_node_rr_t *rr)
+{
+    ogs_assert(rr);
+
+    if (rr->selected)
+        rr->selected->weight -= rr->total;
+
+    return rr->selected;
+}
+
 ogs_gtpu_resource_t *ogs_pfcp_find_gtpu_resource(ogs_list_t *list,
         char *dnn, ogs_pfcp_interface_t source_interface)
 {
@@ -1070,6 +1353,33 @@ static int precedence_compare(ogs_pfcp_pdr_t *pdr1, ogs_pfcp_pdr_t *pdr2)
         return 1;
 }
 
+static uint8_t id_map_alloc(ogs_pfcp_id_map_t *map, int max)
+{
+    int i, id;
+
+    ogs_assert(map);
+    ogs_assert(max > 0 && max <= 32);
+
+    for (i = 0; i < max; i++) {
+        id = (map->last + i) % max + 1;
+        if (!(map->used & (1u << (id - 1)))) {
+            map->used |= 1u << (id - 1);
+            map->last = id;
+            return id;
+        }
+    }
+
+    return 0;
+}
+
+static void id_map_free(ogs_pfcp_id_map_t *map, uint8_t id)
+{
+    ogs_assert(map);
+    ogs_assert(id > 0 && id <= 32);
+
+    map->used &= ~(1u << (id - 1));
+}
+
 ogs_pfcp_pdr_t *ogs_pfcp_pdr_add(ogs_pfcp_sess_t *sess)
 {
     ogs_pfcp_pdr_t *pdr = NULL;
@@ -1093,14 +1403,15 @@ ogs_pfcp_pdr_t *ogs_pfcp_pdr_add(ogs_pfcp_sess_t *sess)
     pdr->teid = *(pdr->teid_node);
 
     /* Set PDR-ID */
-    ogs_pool_alloc(&sess->pdr_id_pool, &pdr->id_node);
-    if (pdr->id_node == NULL) {
-        ogs_error("pdr_id_pool() failed");
+    pdr->local_id = id_map_alloc(&sess->pdr_id, OGS_MAX_NUM_OF_PDR);
+    if (!pdr->local_id) {
+        ogs_error("id_map_alloc() failed");
+        ogs_pool_free(&ogs_pfcp_pdr_teid_pool, pdr->teid_node);
         ogs_pool_free(&ogs_pfcp_pdr_pool, pdr);
         return NULL;
     }
 
-    pdr->id = *(pdr->id_node);
+    pdr->id = pdr->local_id;
     ogs_assert(pdr->id > 0 && pdr->id <= OGS_MAX_NUM_OF_PDR);
 
     pdr->sess = sess;
@@ -1109,6 +1420,29 @@ ogs_pfcp_pdr_t *ogs_pfcp_pdr_add(ogs_pfcp_sess_t *sess)
     return pdr;
 }
 
+/*
+ * SDF filters are only needed by the CP-Function to build the PDI,
+ * so the array is allocated when the first one is added.
+ */
+ogs_pfcp_pdr_flow_t *ogs_pfcp_pdr_flow_add(ogs_pfcp_pdr_t *pdr)
+{
+    ogs_pfcp_pdr_flow_t *flow = NULL;
+
+    ogs_assert(pdr);
+
+    if (!pdr->flow) {
+        pdr->flow = ogs_calloc(
+                OGS_MAX_NUM_OF_FLOW_IN_PDR, sizeof(ogs_pfcp_pdr_flow_t));
+        ogs_assert(pdr->flow);
+    }
+
+    ogs_assert(pdr->num_of_flow < OGS_MAX_NUM_OF_FLOW_IN_PDR);
+    flow = &pdr->flow[pdr->num_of_flow++];
+    memset(flow, 0, sizeof(*flow));
+
+    return flow;
+}
+
 ogs_pfcp_pdr_t *ogs_pfcp_pdr_find(
         ogs_pfcp_sess_t *sess, ogs_pfcp_pdr_id_t id)
 {
@@ -1353,8 +1687,11 @@ void ogs_pfcp_pdr_remove(ogs_pfcp_pdr_t *pdr)
     if (pdr->dnn)
         ogs_free(pdr->dnn);
 
-    if (pdr->id_node)
-        ogs_pool_free(&pdr->sess->pdr_id_pool, pdr->id_node);
+    if (pdr->local_id)
+        id_map_free(&pdr->sess->pdr_id, pdr->local_id);
+
+    if (pdr->flow)
+        ogs_free(pdr->flow);
 
     if (pdr->ipv4_framed_routes) {
         for (i = 0; i < OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI; i++) {
@@ -1400,14 +1737,14 @@ ogs_pfcp_far_t *ogs_pfcp_far_add(ogs_pfcp_sess_t *sess)
     }
     memset(far, 0, sizeof *far);
 
-    ogs_pool_alloc(&sess->far_id_pool, &far->id_node);
-    if (far->id_node == NULL) {
-        ogs_error("far_id_pool() failed");
+    far->local_id = id_map_alloc(&sess->far_id, OGS_MAX_NUM_OF_FAR);
+    if (!far->local_id) {
+        ogs_error("id_map_alloc() failed");
         ogs_pool_free(&ogs_pfcp_far_pool, far);
         return NULL;
     }
 
-    far->id = *(far->id_node);
+    far->id = far->local_id;
     ogs_assert(far->id > 0 && far->id <= OGS_MAX_NUM_OF_FAR);
 
     far->dst_if = OGS_PFCP_INTERFACE_UNKNOWN;
@@ -1628,7 +1965,6 @@ ogs_pfcp_far_t *ogs_pfcp_far_find_by_teid(uint32_t teid)
 
 void ogs_pfcp_far_remove(ogs_pfcp_far_t *far)
 {
-    int i;
     ogs_pfcp_sess_t *sess = NULL;
 
     ogs_assert(far);
@@ -1648,11 +1984,10 @@ void ogs_pfcp_far_remove(ogs_pfcp_far_t *far)
     if (far->dnn)
         ogs_free(far->dnn);
 
-    for (i = 0; i < far->num_of_buffered_packet; i++)
-        ogs_pkbuf_free(far->buffered_packet[i]);
+    ogs_pfcp_far_buffer_clear(far);
 
-    if (far->id_node)
-        ogs_pool_free(&far->sess->far_id_pool, far->id_node);
+    if (far->local_id)
+        id_map_free(&far->sess->far_id, far->local_id);
 
     ogs_pool_free(&ogs_pfcp_far_pool, far);
 }
@@ -1667,6 +2002,118 @@ void ogs_pfcp_far_remove_all(ogs_pfcp_sess_t *sess)
         ogs_pfcp_far_remove(far);
 }
 
+/*
+ * Downlink data buffering
+ *
+ * A packet is refused once the session holds the BAR's Suggested
+ * Buffering Packets Count (or buffer.session_packets without it),
+ * buffer.session_bytes, or the shared buffer.max_bytes would be exceeded.
+ * The receive path hands over packets in large clusters, so a packet
+ * that fits a smaller cluster is copied into one with just enough
+ * headroom for the GTP-U header added on the flush.
+ */
+bool ogs_pfcp_far_buffer_push(ogs_pfcp_far_t *far, ogs_pkbuf_t *pkbuf)
+{
+    ogs_pfcp_sess_t *sess = NULL;
+    ogs_pkbuf_t *compact = NULL;
+    uint32_t max_packets;
+    unsigned int size;
+    ogs_time_t now;
+
+    ogs_assert(far);
+    sess = far->sess;
+    ogs_assert(sess);
+    ogs_assert(pkbuf);
+
+    now = ogs_time_cached();
+    ogs_pfcp_far_buffer_expire(far, now);
+
+    max_packets = self.buffer.session_packets;
+    if (sess->bar && sess->bar->suggested_buffering_packets_count)
+        max_packets = sess->bar->suggested_buffering_packets_count;
+
+    if (sess->buffer.packets >= max_packets ||
+        sess->buffer.bytes + pkbuf->len > self.buffer.session_bytes ||
+        self.buffer.bytes + pkbuf->len > self.buffer.max_bytes) {
+        self.buffer.dropped++;
+        ogs_pkbuf_free(pkbuf);
+        return false;
+    }
+
+    size = OGS_GTPV1U_5GC_HEADER_LEN + pkbuf->len;
+    if (pkbuf->cluster && size <= pkbuf->cluster->size / 2) {
+        compact = ogs_pkbuf_alloc(NULL, size);
+        if (compact) {
+            ogs_pkbuf_reserve(compact, OGS_GTPV1U_5GC_HEADER_LEN);
+            ogs_pkbuf_put_data(compact, pkbuf->data, pkbuf->len);
+            ogs_pkbuf_free(pkbuf);
+            pkbuf = compact;
+        }
+    }
+
+    pkbuf->param[0] = now;
+    ogs_list_add(&far->buffered_list, pkbuf);
+
+    far->num_of_buffered_packet++;
+    far->buffered_bytes += pkbuf->len;
+    sess->buffer.packets++;
+    sess->buffer.bytes += pkbuf->len;
+    self.buffer.packets++;
+    self.buffer.bytes += pkbuf->len;
+
+    return true;
+}
+
+ogs_pkbuf_t *ogs_pfcp_far_buffer_pop(ogs_pfcp_far_t *far)
+{
+    ogs_pfcp_sess_t *sess = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    ogs_assert(far);
+    sess = far->sess;
+    ogs_assert(sess);
+
+    pkbuf = ogs_list_first(&far->buffered_list);
+    if (!pkbuf)
+        return NULL;
+
+    ogs_list_remove(&far->buffered_list, pkbuf);
+
+    far->num_of_buffered_packet--;
+    far->buffered_bytes -= pkbuf->len;
+    sess->buffer.packets--;
+    sess->buffer.bytes -= pkbuf->len;
+    self.buffer.packets--;
+    self.buffer.bytes -= pkbuf->len;
+
+    return pkbuf;
+}
+
+void ogs_pfcp_far_buffer_expire(ogs_pfcp_far_t *far, ogs_time_t now)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    ogs_assert(far);
+
+    while ((pkbuf = ogs_list_first(&far->buffered_list)) &&
+            now - (ogs_time_t)pkbuf->param[0] > self.buffer.duration) {
+        pkbuf = ogs_pfcp_far_buffer_pop(far);
+        ogs_assert(pkbuf);
+        ogs_pkbuf_free(pkbuf);
+        self.buffer.expired++;
+    }
+}
+
+void ogs_pfcp_far_buffer_clear(ogs_pfcp_far_t *far)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    ogs_assert(far);
+
+    while ((pkbuf = ogs_pfcp_far_buffer_pop(far)))
+        ogs_pkbuf_free(pkbuf);
+}
+
 ogs_pfcp_urr_t *ogs_pfcp_urr_add(ogs_pfcp_sess_t *sess)
 {
     ogs_pfcp_urr_t *urr = NULL;
@@ -1680,14 +2127,14 @@ ogs_pfcp_urr_t *ogs_pfcp_urr_add(ogs_pfcp_sess_t *sess)
     }
     memset(urr, 0, sizeof *urr);
 
-    ogs_pool_alloc(&sess->urr_id_pool, &urr->id_node);
-    if (urr->id_node == NULL) {
-        ogs_error("urr_id_pool() failed");
+    urr->local_id = id_map_alloc(&sess->urr_id, OGS_MAX_NUM_OF_URR);
+    if (!urr->local_id) {
+        ogs_error("id_map_alloc() failed");
         ogs_pool_free(&ogs_pfcp_urr_pool, urr);
         return NULL;
     }
 
-    urr->id = *(urr->id_node);
+    urr->id = urr->local_id;
     ogs_assert(urr->id > 0 && urr->id <= OGS_MAX_NUM_OF_URR);
 
     urr->sess = sess;
@@ -1736,8 +2183,8 @@ void ogs_pfcp_urr_remove(ogs_pfcp_urr_t *urr)
 
     ogs_list_remove(&sess->urr_list, urr);
 
-    if (urr->id_node)
-        ogs_pool_free(&urr->sess->urr_id_pool, urr->id_node);
+    if (urr->local_id)
+        id_map_free(&urr->sess->urr_id, urr->local_id);
 
     ogs_pool_free(&ogs_pfcp_urr_pool, urr);
 }
@@ -1765,14 +2212,14 @@ ogs_pfcp_qer_t *ogs_pfcp_qer_add(ogs_pfcp_sess_t *sess)
     }
     memset(qer, 0, sizeof *qer);
 
-    ogs_pool_alloc(&sess->qer_id_pool, &qer->id_node);
-    if (qer->id_node == NULL) {
-        ogs_error("qer_id_pool() failed");
+    qer->local_id = id_map_alloc(&sess->qer_id, OGS_MAX_NUM_OF_QER);
+    if (!qer->local_id) {
+        ogs_error("id_map_alloc() failed");
         ogs_pool_free(&ogs_pfcp_qer_pool, qer);
         return NULL;
     }
 
-    qer->id = *(qer->id_node);
+    qer->id = qer->local_id;
     ogs_assert(qer->id > 0 && qer->id <= OGS_MAX_NUM_OF_QER);
 
     qer->sess = sess;
@@ -1821,8 +2268,8 @@ void ogs_pfcp_qer_remove(ogs_pfcp_qer_t *qer)
 
     ogs_list_remove(&sess->qer_list, qer);
 
-    if (qer->id_node)
-        ogs_pool_free(&qer->sess->qer_id_pool, qer->id_node);
+    if (qer->local_id)
+        id_map_free(&qer->sess->qer_id, qer->local_id);
 
     ogs_pool_free(&ogs_pfcp_qer_pool, qer);
 }
@@ -1848,10 +2295,10 @@ ogs_pfcp_bar_t *ogs_pfcp_bar_new(ogs_pfcp_sess_t *sess)
     ogs_assert(bar);
     memset(bar, 0, sizeof *bar);
 
-    ogs_pool_alloc(&sess->bar_id_pool, &bar->id_node);
-    ogs_assert(bar->id_node);
+    bar->local_id = id_map_alloc(&sess->bar_id, OGS_MAX_NUM_OF_BAR);
+    ogs_assert(bar->local_id);
 
-    bar->id = *(bar->id_node);
+    bar->id = bar->local_id;
     ogs_assert(bar->id > 0 && bar->id <= OGS_MAX_NUM_OF_BAR);
 
     bar->sess = sess;
@@ -1868,13 +2315,12 @@ void ogs_pfcp_bar_delete(ogs_pfcp_bar_t *bar)
     sess = bar->sess;
     ogs_assert(sess);
 
-    if (bar->id_node)
-        ogs_pool_free(&bar->sess->bar_id_pool, bar->id_node);
+    if (bar->local_id)
+        id_map_free(&bar->sess->bar_id, bar->local_id);
 
-    ogs_pool_free(&ogs_pfcp_bar_pool, bar);
-
-    bar->sess = NULL;
     sess->bar = NULL;
+
+    ogs_pool_free(&ogs_pfcp_bar_pool, bar);
 }
 
 ogs_pfcp_rule_t *ogs_pfcp_rule_add(ogs_pfcp_pdr_t *pdr)
@@ -1933,108 +2379,410 @@ void ogs_pfcp_rule_remove_all(ogs_pfcp_pdr_t *pdr)
         ogs_pfcp_rule_remove(rule);
 }
 
-int ogs_pfcp_ue_pool_generate(void)
+/* Static addresses are keyed by IPv4 address or IPv6 /64 prefix */
+#define UE_IP_KEY_LEN(__fAMILY) \
+    ((__fAMILY) == AF_INET ? OGS_IPV4_LEN : OGS_IPV6_DEFAULT_PREFIX_LEN >> 3)
+
+static ogs_pfcp_subnet_t *find_subnet(
+        int family, const char *dnn, bool dynamic);
+
+static uint32_t ue_ip_pool_chunk_bits(ogs_pfcp_ue_ip_pool_t *pool, uint32_t c)
 {
-    int i, rv;
-    ogs_pfcp_subnet_t *subnet = NULL;
+    ogs_assert(pool);
+    ogs_assert(c < pool->num_of_chunk);
 
-    ogs_list_for_each(&self.subnet_list, subnet) {
-        int maxbytes = 0;
-        int lastindex = 0;
-        uint32_t start[4], end[4], broadcast[4];
-        int rangeindex, num_of_range;
-        int poolindex;
-        int inc;
-
-        if (subnet->family == AF_INET) {
-            maxbytes = 4;
-            lastindex = 0;
-        } else if (subnet->family == AF_INET6) {
-            maxbytes = 8; /* Default Prefixlen 64bits */
-            lastindex = 1;
-        } else {
-            /* subnet->family might be AF_UNSPEC. So, skip it */
+    if (c == pool->num_of_chunk - 1)
+        return pool->size - c * OGS_PFCP_UE_IP_CHUNK_BITS;
+
+    return OGS_PFCP_UE_IP_CHUNK_BITS;
+}
+
+static bool ue_ip_pool_test(ogs_pfcp_ue_ip_pool_t *pool, uint32_t index)
+{
+    uint64_t *chunk = NULL;
+
+    ogs_assert(pool);
+    ogs_assert(index < pool->size);
+
+    chunk = pool->chunk[index / OGS_PFCP_UE_IP_CHUNK_BITS];
+    if (!chunk)
+        return false;
+
+    index %= OGS_PFCP_UE_IP_CHUNK_BITS;
+    return (chunk[index / 64] & (1ULL << (index % 64))) != 0;
+}
+
+static void ue_ip_pool_set(ogs_pfcp_ue_ip_pool_t *pool, uint32_t index)
+{
+    uint32_t c;
+
+    ogs_assert(pool);
+    ogs_assert(index < pool->size);
+
+    c = index / OGS_PFCP_UE_IP_CHUNK_BITS;
+    if (!pool->chunk[c]) {
+        pool->chunk[c] = ogs_calloc(
+                OGS_PFCP_UE_IP_CHUNK_BITS / 64, sizeof(uint64_t));
+        ogs_assert(pool->chunk[c]);
+    }
+
+    index %= OGS_PFCP_UE_IP_CHUNK_BITS;
+    ogs_assert((pool->chunk[c][index / 64] & (1ULL << (index % 64))) == 0);
+    pool->chunk[c][index / 64] |= 1ULL << (index % 64);
+
+    pool->chunk_used[c]++;
+    if (pool->chunk_used[c] == ue_ip_pool_chunk_bits(pool, c))
+        pool->chunk_full[c / 64] |= 1ULL << (c % 64);
+}
+
+static void ue_ip_pool_clear(ogs_pfcp_ue_ip_pool_t *pool, uint32_t index)
+{
+    uint32_t c;
+
+    ogs_assert(pool);
+    ogs_assert(index < pool->size);
+
+    c = index / OGS_PFCP_UE_IP_CHUNK_BITS;
+    ogs_assert(pool->chunk[c]);
+
+    index %= OGS_PFCP_UE_IP_CHUNK_BITS;
+    ogs_assert(pool->chunk[c][index / 64] & (1ULL << (index % 64)));
+    pool->chunk[c][index / 64] &= ~(1ULL << (index % 64));
+
+    pool->chunk_full[c / 64] &= ~(1ULL << (c % 64));
+
+    ogs_assert(pool->chunk_used[c]);
+    pool->chunk_used[c]--;
+    if (pool->chunk_used[c] == 0) {
+        ogs_free(pool->chunk[c]);
+        pool->chunk[c] = NULL;
+    }
+}
+
+/*
+ * Returns the first clear bit of chunk 'c' at or after 'from',
+ * or OGS_PFCP_UE_IP_NO_INDEX if there is none.
+ */
+static uint32_t ue_ip_pool_find_in_chunk(
+        ogs_pfcp_ue_ip_pool_t *pool, uint32_t c, uint32_t from)
+{
+    uint64_t *chunk = NULL;
+    uint32_t bits, w;
+
+    ogs_assert(pool);
+
+    bits = ue_ip_pool_chunk_bits(pool, c);
+    if (from >= bits)
+        return OGS_PFCP_UE_IP_NO_INDEX;
+
+    chunk = pool->chunk[c];
+    if (!chunk)
+        return c * OGS_PFCP_UE_IP_CHUNK_BITS + from;
+
+    for (w = from / 64; w * 64 < bits; w++) {
+        uint64_t free_bits = ~chunk[w];
+        uint32_t bit;
+
+        if (w == from / 64)
+            free_bits &= ~0ULL << (from % 64);
+        if (!free_bits)
+            continue;
+
+        bit = w * 64 + __builtin_ctzll(free_bits);
+        if (bit >= bits)
+            break;
+
+        return c * OGS_PFCP_UE_IP_CHUNK_BITS + bit;
+    }
+
+    return OGS_PFCP_UE_IP_NO_INDEX;
+}
+
+/*
+ * Next-fit search starting at the hint, so that a released address
+ * is not handed out again right away.
+ */
+static uint32_t ue_ip_pool_find(ogs_pfcp_ue_ip_pool_t *pool)
+{
+    uint32_t c, first, i, index;
+
+    ogs_assert(pool);
+
+    if (!pool->avail)
+        return OGS_PFCP_UE_IP_NO_INDEX;
+
+    if (pool->hint >= pool->size)
+        pool->hint = 0;
+
+    first = pool->hint / OGS_PFCP_UE_IP_CHUNK_BITS;
+    for (i = 0; i <= pool->num_of_chunk; i++) {
+        c = (first + i) % pool->num_of_chunk;
+
+        if (pool->chunk_full[c / 64] & (1ULL << (c % 64))) {
+            /* Skip a whole word of full chunks at once */
+            if (c % 64 == 0 && pool->chunk_full[c / 64] == UINT64_MAX &&
+                i + 64 <= pool->num_of_chunk)
+                i += 63;
             continue;
         }
 
-        for (i = 0; i < 4; i++) {
-            broadcast[i] = subnet->sub.sub[i] + ~subnet->sub.mask[i];
+        index = ue_ip_pool_find_in_chunk(pool, c,
+                i == 0 ? pool->hint % OGS_PFCP_UE_IP_CHUNK_BITS : 0);
+        if (index != OGS_PFCP_UE_IP_NO_INDEX)
+            return index;
+    }
+
+    return OGS_PFCP_UE_IP_NO_INDEX;
+}
+
+static void ue_ip_pool_index_to_addr(ogs_pfcp_subnet_t *subnet,
+        uint32_t index, uint32_t *addr)
+{
+    ogs_pfcp_ue_ip_pool_t *pool = NULL;
+    uint32_t offset;
+    int i;
+
+    ogs_assert(subnet);
+    ogs_assert(addr);
+    pool = &subnet->pool;
+
+    for (i = 0; i < pool->num_of_segment; i++) {
+        if (index >= pool->segment[i].base &&
+            index < pool->segment[i].base + pool->segment[i].len)
+            break;
+    }
+    ogs_assert(i < pool->num_of_segment);
+
+    offset = index - pool->segment[i].base;
+    memset(addr, 0, sizeof(uint32_t) * 4);
+
+    if (subnet->family == AF_INET) {
+        addr[0] = htobe32(be32toh(pool->segment[i].start[0]) + offset);
+    } else {
+        uint64_t prefix = ((uint64_t)be32toh(pool->segment[i].start[0]) << 32 |
+                be32toh(pool->segment[i].start[1])) + offset;
+
+        addr[0] = htobe32(prefix >> 32);
+        addr[1] = htobe32(prefix & 0xffffffff);
+
+        /* Allocate Full IPv6 Address */
+        addr[3] = htobe32(offset + 1);
+    }
+}
+
+static uint32_t ue_ip_pool_addr_to_index(ogs_pfcp_subnet_t *subnet,
+        int family, uint32_t *addr)
+{
+    ogs_pfcp_ue_ip_pool_t *pool = NULL;
+    int i;
+
+    ogs_assert(subnet);
+    ogs_assert(addr);
+    pool = &subnet->pool;
+
+    if (family != subnet->family)
+        return OGS_PFCP_UE_IP_NO_INDEX;
+
+    for (i = 0; i < pool->num_of_segment; i++) {
+        uint64_t start, value;
+
+        if (family == AF_INET) {
+            start = be32toh(pool->segment[i].start[0]);
+            value = be32toh(addr[0]);
+        } else {
+            start = (uint64_t)be32toh(pool->segment[i].start[0]) << 32 |
+                be32toh(pool->segment[i].start[1]);
+            value = (uint64_t)be32toh(addr[0]) << 32 | be32toh(addr[1]);
         }
 
-        num_of_range = subnet->num_of_range;
-        if (!num_of_range) num_of_range = 1;
+        if (value >= start && value - start < pool->segment[i].len)
+            return pool->segment[i].base + (uint32_t)(value - start);
+    }
 
-        poolindex = 0;
-        for (rangeindex = 0; rangeindex < num_of_range; rangeindex++) {
+    return OGS_PFCP_UE_IP_NO_INDEX;
+}
 
-            if (subnet->num_of_range &&
-                subnet->range[rangeindex].low) {
-                ogs_ipsubnet_t low;
-                rv = ogs_ipsubnet(&low, subnet->range[rangeindex].low, NULL);
-                ogs_assert(rv == OGS_OK);
-                memcpy(start, low.sub, maxbytes);
-            } else {
-                memcpy(start, subnet->sub.sub, maxbytes);
-            }
+static uint64_t ue_ip_pool_addr_value(int family, uint32_t *addr)
+{
+    ogs_assert(addr);
 
-            if (subnet->num_of_range &&
-                subnet->range[rangeindex].high) {
-                ogs_ipsubnet_t high;
-                rv = ogs_ipsubnet(&high, subnet->range[rangeindex].high, NULL);
-                ogs_assert(rv == OGS_OK);
-                high.sub[lastindex] += htobe32(1);
-                memcpy(end, high.sub, maxbytes);
-            } else {
-                memcpy(end, broadcast, maxbytes);
-            }
+    if (family == AF_INET)
+        return be32toh(addr[0]);
 
-            inc = 0;
-            while(poolindex < ogs_app()->pool.sess) {
-                ogs_pfcp_ue_ip_t *ue_ip = NULL;
+    return (uint64_t)be32toh(addr[0]) << 32 | be32toh(addr[1]);
+}
 
-                ue_ip = &subnet->pool.array[poolindex];
-                ogs_assert(ue_ip);
-                memset(ue_ip, 0, sizeof *ue_ip);
-                ue_ip->subnet = subnet;
+static void ue_ip_pool_generate(ogs_pfcp_subnet_t *subnet)
+{
+    int i, rv;
+    ogs_pfcp_ue_ip_pool_t *pool = NULL;
+    int maxbytes = 0;
+    int rangeindex, num_of_range;
+    uint64_t broadcast, network, gateway, want;
+    uint32_t broadcast_addr[4];
 
-                memcpy(ue_ip->addr, start, maxbytes);
-                ue_ip->addr[lastindex] += htobe32(inc);
-                inc++;
+    ogs_assert(subnet);
+    pool = &subnet->pool;
 
-                if (memcmp(ue_ip->addr, end, maxbytes) == 0)
-                    break;
+    if (subnet->family == AF_INET)
+        maxbytes = 4;
+    else
+        maxbytes = 8; /* Default Prefixlen 64bits */
 
-                /* Exclude Network Address */
-                if (memcmp(ue_ip->addr, subnet->sub.sub, maxbytes) == 0)
-                    continue;
+    for (i = 0; i < 4; i++)
+        broadcast_addr[i] = subnet->sub.sub[i] + ~subnet->sub.mask[i];
 
-                /* Exclude TUN IP Address */
-                if (memcmp(ue_ip->addr, subnet->gw.sub, maxbytes) == 0)
-                    continue;
+    broadcast = ue_ip_pool_addr_value(subnet->family, broadcast_addr);
+    network = ue_ip_pool_addr_value(subnet->family, subnet->sub.sub);
+    gateway = ue_ip_pool_addr_value(subnet->family, subnet->gw.sub);
 
-                /* Allocate Full IPv6 Address */
-                if (lastindex == 1)
-                    ue_ip->addr[3] += htobe32(inc);
+    num_of_range = subnet->num_of_range;
+    if (!num_of_range) num_of_range = 1;
 
-                ogs_trace("[%d] - %x:%x:%x:%x",
-                        poolindex,
-                        ue_ip->addr[0], ue_ip->addr[1],
-                        ue_ip->addr[2], ue_ip->addr[3]);
+    for (rangeindex = 0; rangeindex < num_of_range; rangeindex++) {
+        uint32_t start[4];
+        uint64_t low, high, len, reserved[2];
+        int num_of_reserved = 0;
 
-                poolindex++;
-            }
+        want = ogs_app()->pool.sess - pool->capacity;
+        if (!want)
+            break;
+
+        memset(start, 0, sizeof(start));
+        if (subnet->num_of_range &&
+            subnet->range[rangeindex].low) {
+            ogs_ipsubnet_t range;
+            rv = ogs_ipsubnet(&range, subnet->range[rangeindex].low, NULL);
+            ogs_assert(rv == OGS_OK);
+            memcpy(start, range.sub, maxbytes);
+        } else {
+            memcpy(start, subnet->sub.sub, maxbytes);
+        }
+        low = ue_ip_pool_addr_value(subnet->family, start);
+
+        /* 'high' is exclusive */
+        if (subnet->num_of_range &&
+            subnet->range[rangeindex].high) {
+            ogs_ipsubnet_t range;
+            rv = ogs_ipsubnet(&range, subnet->range[rangeindex].high, NULL);
+            ogs_assert(rv == OGS_OK);
+            high = ue_ip_pool_addr_value(subnet->family, range.sub) + 1;
+        } else {
+            high = broadcast;
+        }
+
+        if (high <= low)
+            continue;
+
+        /* Exclude Network Address and TUN IP Address */
+        if (network >= low && network < high)
+            reserved[num_of_reserved++] = network - low;
+        if (gateway != network && gateway >= low && gateway < high)
+            reserved[num_of_reserved++] = gateway - low;
+        if (num_of_reserved == 2 && reserved[1] < reserved[0]) {
+            uint64_t tmp = reserved[0];
+            reserved[0] = reserved[1];
+            reserved[1] = tmp;
         }
-        subnet->pool.size = subnet->pool.avail = poolindex;
+
+        len = want;
+        for (i = 0; i < num_of_reserved; i++)
+            if (reserved[i] < len)
+                len++;
+        if (len > high - low)
+            len = high - low;
+
+        ogs_assert(pool->num_of_segment < OGS_MAX_NUM_OF_SUBNET_RANGE);
+        memcpy(pool->segment[pool->num_of_segment].start, start,
+                sizeof(start));
+        pool->segment[pool->num_of_segment].base = pool->size;
+        pool->segment[pool->num_of_segment].len = len;
+        pool->num_of_segment++;
+
+        pool->size += len;
+        pool->capacity += len;
+        for (i = 0; i < num_of_reserved; i++)
+            if (reserved[i] < len)
+                pool->capacity--;
+    }
+
+    pool->num_of_chunk = (pool->size + OGS_PFCP_UE_IP_CHUNK_BITS - 1) /
+        OGS_PFCP_UE_IP_CHUNK_BITS;
+    if (pool->num_of_chunk) {
+        pool->chunk = ogs_calloc(pool->num_of_chunk, sizeof(uint64_t *));
+        ogs_assert(pool->chunk);
+        pool->chunk_used = ogs_calloc(pool->num_of_chunk, sizeof(uint32_t));
+        ogs_assert(pool->chunk_used);
+        pool->chunk_full = ogs_calloc(
+                (pool->num_of_chunk + 63) / 64, sizeof(uint64_t));
+        ogs_assert(pool->chunk_full);
+    }
+
+    /* Reserve Network Address and TUN IP Address */
+    for (i = 0; i < pool->num_of_segment; i++) {
+        uint64_t start = ue_ip_pool_addr_value(
+                subnet->family, pool->segment[i].start);
+
+        if (network >= start && network - start < pool->segment[i].len)
+            ue_ip_pool_set(pool,
+                    pool->segment[i].base + (uint32_t)(network - start));
+        if (gateway != network &&
+            gateway >= start && gateway - start < pool->segment[i].len)
+            ue_ip_pool_set(pool,
+                    pool->segment[i].base + (uint32_t)(gateway - start));
+    }
+
+    pool->avail = pool->capacity;
+
+    ogs_debug("UE IP pool [%s] %d addresses in %d ranges",
+            subnet->dnn, pool->capacity, pool->num_of_segment);
+}
+
+int ogs_pfcp_ue_pool_generate(void)
+{
+    ogs_pfcp_subnet_t *subnet = NULL;
+
+    ogs_list_for_each(&self.subnet_list, subnet) {
+        /* subnet->family might be AF_UNSPEC. So, skip it */
+        if (subnet->family != AF_INET && subnet->family != AF_INET6)
+            continue;
+
+        ue_ip_pool_generate(subnet);
     }
 
     return OGS_OK;
 }
 
+static void ue_ip_pool_final(ogs_pfcp_ue_ip_pool_t *pool)
+{
+    uint32_t c;
+
+    ogs_assert(pool);
+
+    if (pool->chunk) {
+        for (c = 0; c < pool->num_of_chunk; c++)
+            if (pool->chunk[c])
+                ogs_free(pool->chunk[c]);
+        ogs_free(pool->chunk);
+    }
+    if (pool->chunk_used)
+        ogs_free(pool->chunk_used);
+    if (pool->chunk_full)
+        ogs_free(pool->chunk_full);
+
+    if (pool->static_hash)
+        ogs_hash_destroy(pool->static_hash);
+
+    memset(pool, 0, sizeof(*pool));
+}
+
 ogs_pfcp_ue_ip_t *ogs_pfcp_ue_ip_alloc(
         uint8_t *cause_value, int family, const char *dnn, uint8_t *addr)
 {
     ogs_pfcp_subnet_t *subnet = NULL;
+    ogs_pfcp_ue_ip_pool_t *pool = NULL;
     ogs_pfcp_ue_ip_t *ue_ip = NULL;
+    uint32_t index;
 
     uint8_t zero[16];
     size_t maxbytes = 0;
@@ -2050,19 +2798,20 @@ ogs_pfcp_ue_ip_t *ogs_pfcp_ue_ip_alloc(
         return NULL;
     }
 
-    if (dnn)
-        subnet = ogs_pfcp_find_subnet_by_dnn(family, dnn);
-    else
-        subnet = ogs_pfcp_find_subnet(family);
-
-    if (subnet == NULL) {
-        ogs_error("All IP addresses in all subnets are occupied");
-        *cause_value = OGS_PFCP_CAUSE_NO_RESOURCES_AVAILABLE;
-        return NULL;
-    }
-
     /* if assigning a static IP, do so. If not, assign dynamically! */
     if (memcmp(addr, zero, maxbytes) != 0) {
+        /*
+         * A static address does not need a free dynamic address,
+         * so the subnet is chosen regardless of its utilisation.
+         */
+        subnet = find_subnet(family, dnn, false);
+        if (subnet == NULL) {
+            ogs_error("No subnet for static IP address");
+            *cause_value = OGS_PFCP_CAUSE_NO_RESOURCES_AVAILABLE;
+            return NULL;
+        }
+        pool = &subnet->pool;
+
         ue_ip = ogs_calloc(1, sizeof(ogs_pfcp_ue_ip_t));
         if (!ue_ip) {
             ogs_error("All dynamic addresses are occupied");
@@ -2072,14 +2821,69 @@ ogs_pfcp_ue_ip_t *ogs_pfcp_ue_ip_alloc(
 
         ue_ip->subnet = subnet;
         ue_ip->static_ip = true;
+        ue_ip->family = family;
         memcpy(ue_ip->addr, addr, maxbytes);
+
+        index = ue_ip_pool_addr_to_index(subnet, family, ue_ip->addr);
+        if (index != OGS_PFCP_UE_IP_NO_INDEX) {
+            if (ue_ip_pool_test(pool, index)) {
+                ogs_error("Static IP address already in use");
+                ogs_free(ue_ip);
+                *cause_value = OGS_PFCP_CAUSE_REQUEST_REJECTED;
+                return NULL;
+            }
+            ue_ip_pool_set(pool, index);
+            ogs_assert(pool->avail);
+            pool->avail--;
+        } else {
+            if (!pool->static_hash) {
+                pool->static_hash = ogs_hash_make();
+                ogs_assert(pool->static_hash);
+            }
+            if (ogs_hash_get(pool->static_hash,
+                        ue_ip->addr, UE_IP_KEY_LEN(family))) {
+                ogs_error("Static IP address already in use");
+                ogs_free(ue_ip);
+                *cause_value = OGS_PFCP_CAUSE_REQUEST_REJECTED;
+                return NULL;
+            }
+            ogs_hash_set(pool->static_hash,
+                    ue_ip->addr, UE_IP_KEY_LEN(family), ue_ip);
+            pool->num_of_static++;
+        }
+        ue_ip->index = index;
     } else {
-        ogs_pool_alloc(&subnet->pool, &ue_ip);
+        subnet = find_subnet(family, dnn, true);
+        if (subnet == NULL || subnet->family == AF_UNSPEC) {
+            ogs_error("All IP addresses in all subnets are occupied");
+            *cause_value = OGS_PFCP_CAUSE_NO_RESOURCES_AVAILABLE;
+            return NULL;
+        }
+        pool = &subnet->pool;
+
+        index = ue_ip_pool_find(pool);
+        if (index == OGS_PFCP_UE_IP_NO_INDEX) {
+            ogs_error("No resources available");
+            *cause_value = OGS_PFCP_CAUSE_NO_RESOURCES_AVAILABLE;
+            return NULL;
+        }
+
+        ue_ip = ogs_calloc(1, sizeof(ogs_pfcp_ue_ip_t));
         if (!ue_ip) {
             ogs_error("No resources available");
             *cause_value = OGS_PFCP_CAUSE_NO_RESOURCES_AVAILABLE;
             return NULL;
         }
+
+        ue_ip_pool_set(pool, index);
+        ogs_assert(pool->avail);
+        pool->avail--;
+        pool->hint = index + 1;
+
+        ue_ip->subnet = subnet;
+        ue_ip->family = family;
+        ue_ip->index = index;
+        ue_ip_pool_index_to_addr(subnet, index, ue_ip->addr);
     }
 
     return ue_ip;
@@ -2088,17 +2892,27 @@ ogs_pfcp_ue_ip_t *ogs_pfcp_ue_ip_alloc(
 void ogs_pfcp_ue_ip_free(ogs_pfcp_ue_ip_t *ue_ip)
 {
     ogs_pfcp_subnet_t *subnet = NULL;
+    ogs_pfcp_ue_ip_pool_t *pool = NULL;
 
     ogs_assert(ue_ip);
     subnet = ue_ip->subnet;
 
     ogs_assert(subnet);
+    pool = &subnet->pool;
 
-    if (ue_ip->static_ip) {
-        ogs_free(ue_ip);
+    if (ue_ip->index != OGS_PFCP_UE_IP_NO_INDEX) {
+        ue_ip_pool_clear(pool, ue_ip->index);
+        pool->avail++;
     } else {
-        ogs_pool_free(&subnet->pool, ue_ip);
+        ogs_assert(ue_ip->static_ip);
+        ogs_assert(pool->static_hash);
+        ogs_hash_set(pool->static_hash,
+                ue_ip->addr, UE_IP_KEY_LEN(ue_ip->family), NULL);
+        ogs_assert(pool->num_of_static);
+        pool->num_of_static--;
     }
+
+    ogs_free(ue_ip);
 }
 
 ogs_pfcp_dev_t *ogs_pfcp_dev_add(const char *ifname)
@@ -2219,8 +3033,6 @@ ogs_pfcp_subnet_t *ogs_pfcp_subnet_add(
     if (dnn)
         strcpy(subnet->dnn, dnn);
 
-    ogs_pool_init(&subnet->pool, ogs_app()->pool.sess);
-
     ogs_list_add(&self.subnet_list, subnet);
 
     return subnet;
@@ -2232,7 +3044,7 @@ void ogs_pfcp_subnet_remove(ogs_pfcp_subnet_t *subnet)
 
     ogs_list_remove(&self.subnet_list, subnet);
 
-    ogs_pool_final(&subnet->pool);
+    ue_ip_pool_final(&subnet->pool);
 
     ogs_pool_free(&ogs_pfcp_subnet_pool, subnet);
 }
@@ -2245,38 +3057,36 @@ void ogs_pfcp_subnet_remove_all(void)
         ogs_pfcp_subnet_remove(subnet);
 }
 
-ogs_pfcp_subnet_t *ogs_pfcp_find_subnet(int family)
+static ogs_pfcp_subnet_t *find_subnet(
+        int family, const char *dnn, bool dynamic)
 {
     ogs_pfcp_subnet_t *subnet = NULL;
 
     ogs_assert(family == AF_INET || family == AF_INET6);
 
     ogs_list_for_each(&self.subnet_list, subnet) {
-        if ((subnet->family == AF_UNSPEC || subnet->family == family) &&
-            (strlen(subnet->dnn) == 0) &&
-            subnet->pool.avail)
-            break;
+        if (subnet->family != AF_UNSPEC && subnet->family != family)
+            continue;
+        if (strlen(subnet->dnn) &&
+            (!dnn || ogs_strcasecmp(subnet->dnn, dnn) != 0))
+            continue;
+        if (dynamic && subnet->family != AF_UNSPEC && !subnet->pool.avail)
+            continue;
+        break;
     }
 
     return subnet;
 }
 
-ogs_pfcp_subnet_t *ogs_pfcp_find_subnet_by_dnn(int family, const char *dnn)
+ogs_pfcp_subnet_t *ogs_pfcp_find_subnet(int family)
 {
-    ogs_pfcp_subnet_t *subnet = NULL;
+    return find_subnet(family, NULL, true);
+}
 
+ogs_pfcp_subnet_t *ogs_pfcp_find_subnet_by_dnn(int family, const char *dnn)
+{
     ogs_assert(dnn);
-    ogs_assert(family == AF_INET || family == AF_INET6);
-
-    ogs_list_for_each(&self.subnet_list, subnet) {
-        if ((subnet->family == AF_UNSPEC || subnet->family == family) &&
-            (strlen(subnet->dnn) == 0 ||
-                (strlen(subnet->dnn) && ogs_strcasecmp(subnet->dnn, dnn) == 0)) &&
-            subnet->pool.avail)
-            break;
-    }
-
-    return subnet;
+    return find_subnet(family, dnn, true);
 }
 
 void ogs_pfcp_pool_init(ogs_pfcp_sess_t *sess)
@@ -2285,25 +3095,20 @@ void ogs_pfcp_pool_init(ogs_pfcp_sess_t *sess)
 
     sess->obj.type = OGS_PFCP_OBJ_SESS_TYPE;
 
-    ogs_pool_create(&sess->pdr_id_pool, OGS_MAX_NUM_OF_PDR);
-    ogs_pool_create(&sess->far_id_pool, OGS_MAX_NUM_OF_FAR);
-    ogs_pool_create(&sess->urr_id_pool, OGS_MAX_NUM_OF_URR);
-    ogs_pool_create(&sess->qer_id_pool, OGS_MAX_NUM_OF_QER);
-    ogs_pool_create(&sess->bar_id_pool, OGS_MAX_NUM_OF_BAR);
-
-    ogs_pool_sequence_id_generate(&sess->pdr_id_pool);
-    ogs_pool_sequence_id_generate(&sess->far_id_pool);
-    ogs_pool_sequence_id_generate(&sess->urr_id_pool);
-    ogs_pool_sequence_id_generate(&sess->qer_id_pool);
-    ogs_pool_sequence_id_generate(&sess->bar_id_pool);
+    memset(&sess->pdr_id, 0, sizeof(sess->pdr_id));
+    memset(&sess->far_id, 0, sizeof(sess->far_id));
+    memset(&sess->urr_id, 0, sizeof(sess->urr_id));
+    memset(&sess->qer_id, 0, sizeof(sess->qer_id));
+    memset(&sess->bar_id, 0, sizeof(sess->bar_id));
 }
 void ogs_pfcp_pool_final(ogs_pfcp_sess_t *sess)
 {
     ogs_assert(sess);
 
-    ogs_pool_destroy(&sess->pdr_id_pool);
-    ogs_pool_destroy(&sess->far_id_pool);
-    ogs_pool_destroy(&sess->urr_id_pool);
-    ogs_pool_destroy(&sess->qer_id_pool);
-    ogs_pool_destroy(&sess->bar_id_pool);
+    if (sess->pdr_id.used || sess->far_id.used || sess->urr_id.used ||
+        sess->qer_id.used || sess->bar_id.used)
+        ogs_error("Rule IDs were not released [PDR:0x%x FAR:0x%x URR:0x%x "
+                "QER:0x%x BAR:0x%x]",
+                sess->pdr_id.used, sess->far_id.used, sess->urr_id.used,
+                sess->qer_id.used, sess->bar_id.used);
 }
@@ -39,6 +39,10 @@ extern "C" {
 #define OGS_MAX_NUM_OF_DEV      16
 #define OGS_MAX_NUM_OF_SUBNET   16
 
+#define OGS_PFCP_DEFAULT_BUFFER_BYTES           (32*1024*1024)
+#define OGS_PFCP_DEFAULT_BUFFER_SESSION_BYTES   (128*1024)
+#define OGS_PFCP_DEFAULT_BUFFER_DURATION        ogs_time_from_sec(30)
+
 typedef struct ogs_pfcp_node_s ogs_pfcp_node_t;
 
 typedef struct ogs_pfcp_context_s {
@@ -72,6 +76,34 @@ typedef struct ogs_pfcp_context_s {
     ogs_hash_t      *object_teid_hash; /* hash table for PFCP OBJ(TEID) */
     ogs_hash_t      *far_f_teid_hash;  /* hash table for FAR(TEID+ADDR) */
     ogs_hash_t      *far_teid_hash; /* hash table for FAR(TEID) */
+
+    /* Downlink data buffering in the UP function */
+    struct {
+        uint64_t    max_bytes;      /* Budget shared by all sessions */
+        uint32_t    session_bytes;  /* Per-session byte limit */
+        uint32_t    session_packets; /* Per-session limit without BAR */
+        ogs_time_t  duration;       /* Maximum time a packet is kept */
+
+        uint64_t    bytes;          /* Current occupancy */
+        uint64_t    packets;
+        uint64_t    dropped;        /* Refused by one of the limits */
+        uint64_t    expired;        /* Discarded after 'duration' */
+    } buffer;
+
+    /*
+     * Load and Overload Control Information advertised by the UP function
+     * (TS 29.244 6.2.8, 6.2.9). The sequence numbers are bumped whenever
+     * the information changes; zero means nothing has been advertised.
+     */
+    struct {
+        uint32_t    sequence;
+        uint8_t     metric;         /* Load Metric, 0..100 */
+    } load;
+    struct {
+        uint32_t    sequence;
+        uint8_t     reduction;      /* Overload Reduction Metric, 0..100 */
+        ogs_time_t  validity;       /* Period-Of-Validity */
+    } overload;
 } ogs_pfcp_context_t;
 
 #define OGS_SETUP_PFCP_NODE(__cTX, __pNODE) \
@@ -92,6 +124,14 @@ typedef struct ogs_pfcp_node_s {
     ogs_list_t      local_list;
     ogs_list_t      remote_list;
 
+    struct {
+        uint32_t    local;          /* Outstanding local transactions */
+        uint32_t    remote;         /* Holding remote transactions */
+        uint64_t    retransmitted;  /* Requests retransmitted on T1 expiry */
+        uint64_t    duplicated;     /* Duplicated requests received */
+    } xact_stats;
+    void            *metrics;       /* Per-peer metrics, set by the app */
+
     ogs_fsm_t       sm;             /* A state machine */
     ogs_timer_t     *t_association; /* timer to retry to associate peer node */
     ogs_timer_t     *t_no_heartbeat; /* heartbeat timer to check aliveness */
@@ -108,10 +148,45 @@ typedef struct ogs_pfcp_node_s {
     uint32_t        remote_recovery; /* UTC time */
     bool            restoration_required;
 
+    /*
+     * PDN Connection Set Identifier given to the sessions with this peer.
+     * When the sessions are released locally without telling the peer,
+     * the CSID is retired as stale so that the peer can be cleaned up
+     * later with a single PFCP Session Set Deletion.
+     */
+    uint16_t        csid;
+    uint16_t        stale_csid[OGS_PFCP_MAX_NUM_OF_CSID];
+    int             num_of_stale_csid;
+
+    struct {
+        ogs_time_t  started;
+        uint32_t    total;
+        uint32_t    pending;        /* Sessions not yet re-established */
+        uint32_t    failed;
+    } restoration;
+
     ogs_list_t      gtpu_resource_list; /* User Plane IP Resource Information */
 
     ogs_pfcp_up_function_features_t up_function_features;
     int up_function_features_len;
+
+#define OGS_PFCP_DEFAULT_CAPACITY 100
+    uint16_t        capacity;       /* Relative capacity of the UP function */
+    int             weight;         /* Smooth weighted round-robin state */
+
+    /*
+     * In the CP function, the latest information reported by the peer.
+     * In the UP function, the information last sent to the peer.
+     */
+    struct {
+        uint32_t    sequence;
+        uint8_t     metric;
+    } load;
+    struct {
+        uint32_t    sequence;
+        uint8_t     reduction;
+        ogs_time_t  expires;        /* Reported Period-Of-Validity runs out */
+    } overload;
 } ogs_pfcp_node_t;
 
 typedef enum {
@@ -135,11 +210,59 @@ typedef struct ogs_pfcp_urr_s ogs_pfcp_urr_t;
 typedef struct ogs_pfcp_qer_s ogs_pfcp_qer_t;
 typedef struct ogs_pfcp_bar_s ogs_pfcp_bar_t;
 
+typedef struct ogs_pfcp_pdr_flow_s {
+    union {
+        struct {
+    ED6(uint8_t     spare1:3;,
+        uint8_t     bid:1;,
+        uint8_t     fl:1;,
+        uint8_t     spi:1;,
+        uint8_t     ttc:1;,
+        uint8_t     fd:1;)
+        };
+        uint8_t flags;
+    };
+    char *description;
+    uint32_t sdf_filter_id;
+} ogs_pfcp_pdr_flow_t;
+
+/*
+ * The fields looked at for every packet come first so that they share
+ * the first cache lines. The rest is only used while N4 sets up or
+ * changes the rule.
+ */
 typedef struct ogs_pfcp_pdr_s {
     ogs_pfcp_object_t       obj;
 
-    ogs_pool_id_t           *teid_node;  /* A node of TEID */
+    ogs_pfcp_pdr_id_t       id;
+    ogs_pfcp_precedence_t   precedence;
+    ogs_pfcp_interface_t    src_if;
+    uint8_t                 qfi;
+
+    ogs_pfcp_far_t          *far;
+    ogs_pfcp_qer_t          *qer;
+
+    int                     num_of_urr;
+    ogs_pfcp_urr_t          *urr[OGS_MAX_NUM_OF_URR];
+
+    ogs_list_t              rule_list;      /* Rule List */
+
     ogs_pool_id_t           teid;
+    ogs_pfcp_f_teid_t       f_teid;
+    int                     f_teid_len;
+
+    ogs_pfcp_ue_ip_addr_t   ue_ip_addr;
+    int                     ue_ip_addr_len;
+
+    ogs_pfcp_outer_header_removal_t outer_header_removal;
+    int                     outer_header_removal_len;
+
+    /* Related Context */
+    ogs_pfcp_sess_t         *sess;
+    void                    *gnode;         /* For CP-Function */
+
+    ogs_pool_id_t           *teid_node;  /* A node of TEID */
+    uint8_t                 local_id;    /* Taken from sess->pdr_id */
 
     ogs_lnode_t             to_create_node;
     ogs_lnode_t             to_modify_node;
@@ -151,11 +274,6 @@ typedef struct ogs_pfcp_pdr_s {
         } teid;
     } hash;
 
-    uint8_t                 *id_node;      /* Pool-Node for ID */
-    ogs_pfcp_pdr_id_t       id;
-    ogs_pfcp_precedence_t   precedence;
-    ogs_pfcp_interface_t    src_if;
-
     bool src_if_type_presence;
     ogs_pfcp_3gpp_interface_type_t src_if_type;
 
@@ -164,52 +282,15 @@ typedef struct ogs_pfcp_pdr_s {
         char *dnn;
     };
 
-    ogs_pfcp_ue_ip_addr_t   ue_ip_addr;
-    int                     ue_ip_addr_len;
-
     char                    **ipv4_framed_routes;
     char                    **ipv6_framed_routes;
 
-    ogs_pfcp_f_teid_t       f_teid;
-    int                     f_teid_len;
-
     bool                    chid;
     uint8_t                 choose_id;
 
-    ogs_pfcp_outer_header_removal_t outer_header_removal;
-    int                     outer_header_removal_len;
-
-    uint8_t                 qfi;
-
-    ogs_pfcp_far_t          *far;
-
-    int                     num_of_urr;
-    ogs_pfcp_urr_t          *urr[OGS_MAX_NUM_OF_URR];
-
-    ogs_pfcp_qer_t          *qer;
-
+    /* SDF filters sent by the CP-Function, see ogs_pfcp_pdr_flow_add() */
     int                     num_of_flow;
-    struct {
-        union {
-            struct {
-    ED6(uint8_t     spare1:3;,
-        uint8_t     bid:1;,
-        uint8_t     fl:1;,
-        uint8_t     spi:1;,
-        uint8_t     ttc:1;,
-        uint8_t     fd:1;)
-            };
-            uint8_t flags;
-        };
-        char *description;
-        uint32_t sdf_filter_id;
-    } flow[OGS_MAX_NUM_OF_FLOW_IN_PDR];;
-
-    ogs_list_t              rule_list;      /* Rule List */
-
-    /* Related Context */
-    ogs_pfcp_sess_t         *sess;
-    void                    *gnode;         /* For CP-Function */
+    ogs_pfcp_pdr_flow_t     *flow;
 } ogs_pfcp_pdr_t;
 
 typedef struct ogs_pfcp_far_hash_f_teid_s {
@@ -220,6 +301,30 @@ typedef struct ogs_pfcp_far_hash_f_teid_s {
 typedef struct ogs_pfcp_far_s {
     ogs_lnode_t             lnode;
 
+    ogs_pfcp_far_id_t       id;
+    ogs_pfcp_apply_action_t apply_action;
+    ogs_pfcp_interface_t    dst_if;
+
+    ogs_pfcp_outer_header_creation_t outer_header_creation;
+    int                     outer_header_creation_len;
+
+    /* Rebuilt on the next G-PDU after N4 changes the FAR */
+    ogs_gtp2_encap_t        encap;
+
+    /*
+     * Buffered downlink packets, oldest first. Each one is linked by
+     * its lnode and carries its arrival time in param[0].
+     */
+    ogs_list_t              buffered_list;
+    uint32_t                num_of_buffered_packet;
+    uint32_t                buffered_bytes;
+
+    /* Related Context */
+    ogs_pfcp_sess_t         *sess;
+    void                    *gnode;
+
+    uint8_t                 local_id;       /* Taken from sess->far_id */
+
     struct {
         struct {
             int len;
@@ -237,35 +342,20 @@ typedef struct ogs_pfcp_far_s {
         char *dnn;
     };
 
-    uint8_t                 *id_node;      /* Pool-Node for ID */
-    ogs_pfcp_far_id_t       id;
-    ogs_pfcp_apply_action_t apply_action;
-    ogs_pfcp_interface_t    dst_if;
-
     bool dst_if_type_presence;
     ogs_pfcp_3gpp_interface_type_t dst_if_type;
 
-    ogs_pfcp_outer_header_creation_t outer_header_creation;
-    int                     outer_header_creation_len;
-
     ogs_pfcp_smreq_flags_t  smreq_flags;
 
-    uint32_t                num_of_buffered_packet;
-    ogs_pkbuf_t             *buffered_packet[OGS_MAX_NUM_OF_PACKET_BUFFER];
-
     struct {
         bool prepared;
     } handover; /* Saved from N2-Handover Request Acknowledge */
-
-    /* Related Context */
-    ogs_pfcp_sess_t         *sess;
-    void                    *gnode;
 } ogs_pfcp_far_t;
 
 typedef struct ogs_pfcp_urr_s {
     ogs_lnode_t             lnode;
 
-    uint8_t                 *id_node;      /* Pool-Node for ID */
+    uint8_t                 local_id;       /* Taken from sess->urr_id */
     ogs_pfcp_urr_id_t       id;
 
     ogs_pfcp_measurement_method_t meas_method;
@@ -294,7 +384,7 @@ typedef struct ogs_pfcp_urr_s {
 typedef struct ogs_pfcp_qer_s {
     ogs_lnode_t             lnode;
 
-    uint8_t                 *id_node;      /* Pool-Node for ID */
+    uint8_t                 local_id;       /* Taken from sess->qer_id */
     ogs_pfcp_qer_id_t       id;
 
     ogs_pfcp_gate_status_t  gate_status;
@@ -309,12 +399,23 @@ typedef struct ogs_pfcp_qer_s {
 typedef struct ogs_pfcp_bar_s {
     ogs_lnode_t             lnode;
 
-    uint8_t                 *id_node;      /* Pool-Node for ID */
+    uint8_t                 local_id;       /* Taken from sess->bar_id */
     ogs_pfcp_bar_id_t       id;
 
+    uint8_t                 suggested_buffering_packets_count; /* 0: unset */
+
     ogs_pfcp_sess_t         *sess;
 } ogs_pfcp_bar_t;
 
+/*
+ * One bit per rule ID. IDs are handed out round-robin so that a freed
+ * ID is not reused right away.
+ */
+typedef struct ogs_pfcp_id_map_s {
+    uint32_t            used;
+    uint8_t             last;
+} ogs_pfcp_id_map_t;
+
 typedef struct ogs_pfcp_sess_s {
     ogs_pfcp_object_t   obj;
 
@@ -324,17 +425,33 @@ typedef struct ogs_pfcp_sess_s {
     ogs_list_t          qer_list;       /* QER List */
     ogs_pfcp_bar_t      *bar;           /* BAR Item */
 
-    OGS_POOL(pdr_id_pool, uint8_t);
-    OGS_POOL(far_id_pool, uint8_t);
-    OGS_POOL(urr_id_pool, uint8_t);
-    OGS_POOL(qer_id_pool, uint8_t);
-    OGS_POOL(bar_id_pool, uint8_t);
+    struct {
+        uint32_t        packets;        /* Buffered in all FARs */
+        uint32_t        bytes;
+    } buffer;
+
+    /* Rule IDs assigned by this node */
+    ogs_pfcp_id_map_t   pdr_id;
+    ogs_pfcp_id_map_t   far_id;
+    ogs_pfcp_id_map_t   urr_id;
+    ogs_pfcp_id_map_t   qer_id;
+    ogs_pfcp_id_map_t   bar_id;
+
+    /* PDN Connection Set Identifiers, 0 if not known */
+    struct {
+        uint16_t        local;
+        uint16_t        remote;
+    } csid;
 } ogs_pfcp_sess_t;
 
 typedef struct ogs_pfcp_subnet_s ogs_pfcp_subnet_t;
 typedef struct ogs_pfcp_ue_ip_s {
     uint32_t        addr[4];
     bool            static_ip;
+    int             family;
+
+#define OGS_PFCP_UE_IP_NO_INDEX UINT32_MAX
+    uint32_t        index;          /* Bit in the subnet's address bitmap */
 
     /* Related Context */
     ogs_pfcp_subnet_t    *subnet;
@@ -351,6 +468,38 @@ typedef struct ogs_pfcp_dev_s {
     uint8_t         mac_addr[6];
 } ogs_pfcp_dev_t;
 
+/*
+ * UE IP address pool of a subnet.
+ *
+ * Every address of the configured ranges is a bit in a two-level bitmap.
+ * The leaf chunks are only allocated while one of their addresses is
+ * in use, and a summary bitmap of the full chunks lets allocation skip
+ * over them.
+ */
+#define OGS_PFCP_UE_IP_CHUNK_BITS 4096
+#define OGS_MAX_NUM_OF_SUBNET_RANGE 16
+typedef struct ogs_pfcp_ue_ip_pool_s {
+    struct {
+        uint32_t    start[4];       /* First address of the segment */
+        uint32_t    base;           /* Bit index of the first address */
+        uint32_t    len;
+    } segment[OGS_MAX_NUM_OF_SUBNET_RANGE];
+    int             num_of_segment;
+
+    uint32_t        size;           /* Number of bits */
+    uint32_t        capacity;       /* Number of assignable addresses */
+    uint32_t        avail;
+    uint32_t        num_of_static;  /* Static/framed addresses in use */
+    uint32_t        hint;           /* Next-fit search position */
+
+    uint32_t        num_of_chunk;
+    uint64_t        **chunk;        /* NULL if no address is in use */
+    uint32_t        *chunk_used;
+    uint64_t        *chunk_full;    /* Summary bitmap of full chunks */
+
+    ogs_hash_t      *static_hash;   /* Static addresses out of the ranges */
+} ogs_pfcp_ue_ip_pool_t;
+
 typedef struct ogs_pfcp_subnet_s {
     ogs_lnode_t     lnode;
 
@@ -358,7 +507,6 @@ typedef struct ogs_pfcp_subnet_s {
     ogs_ipsubnet_t  gw;                     /* Gateway : 2001:db8:cafe::1 */
     char            dnn[OGS_MAX_DNN_LEN+1]; /* DNN : "internet", "volte", .. */
 
-#define OGS_MAX_NUM_OF_SUBNET_RANGE 16
     struct {
         const char *low;
         const char *high;
@@ -367,7 +515,7 @@ typedef struct ogs_pfcp_subnet_s {
 
     int             family;         /* AF_INET or AF_INET6 */
     uint8_t         prefixlen;      /* prefixlen */
-    OGS_POOL(pool, ogs_pfcp_ue_ip_t);
+    ogs_pfcp_ue_ip_pool_t pool;
 
     ogs_pfcp_dev_t  *dev;           /* Related Context */
 } ogs_pfcp_subnet_t;
@@ -398,7 +546,10 @@ void ogs_pfcp_context_init(void);
 void ogs_pfcp_context_final(void);
 ogs_pfcp_context_t *ogs_pfcp_self(void);
 int ogs_pfcp_context_parse_config(const char *local, const char *remote);
+int ogs_pfcp_context_reload_subnet(
+        const char *local, int (*setup)(ogs_pfcp_subnet_t *subnet));
 
+uint16_t ogs_pfcp_csid_next(void);
 ogs_pfcp_node_t *ogs_pfcp_node_new(ogs_sockaddr_t *sa_list);
 void ogs_pfcp_node_free(ogs_pfcp_node_t *node);
 
@@ -409,6 +560,17 @@ ogs_pfcp_node_t *ogs_pfcp_node_find(
 void ogs_pfcp_node_remove(ogs_list_t *list, ogs_pfcp_node_t *node);
 void ogs_pfcp_node_remove_all(ogs_list_t *list);
 
+bool ogs_pfcp_node_overloaded(ogs_pfcp_node_t *node);
+bool ogs_pfcp_node_throttled(ogs_pfcp_node_t *node);
+
+typedef struct ogs_pfcp_node_rr_s {
+    ogs_pfcp_node_t *selected;
+    int             total;          /* Sum of the weights offered */
+} ogs_pfcp_node_rr_t;
+
+void ogs_pfcp_node_rr_offer(ogs_pfcp_node_rr_t *rr, ogs_pfcp_node_t *node);
+ogs_pfcp_node_t *ogs_pfcp_node_rr_select(ogs_pfcp_node_rr_t *rr);
+
 ogs_gtpu_resource_t *ogs_pfcp_find_gtpu_resource(ogs_list_t *list,
         char *dnn, ogs_pfcp_interface_t source_interface);
 int ogs_pfcp_setup_far_gtpu_node(ogs_pfcp_far_t *far);
@@ -417,6 +579,7 @@ int ogs_pfcp_setup_pdr_gtpu_node(ogs_pfcp_pdr_t *pdr);
 void ogs_pfcp_sess_clear(ogs_pfcp_sess_t *sess);
 
 ogs_pfcp_pdr_t *ogs_pfcp_pdr_add(ogs_pfcp_sess_t *sess);
+ogs_pfcp_pdr_flow_t *ogs_pfcp_pdr_flow_add(ogs_pfcp_pdr_t *pdr);
 ogs_pfcp_pdr_t *ogs_pfcp_pdr_find(
         ogs_pfcp_sess_t *sess, ogs_pfcp_pdr_id_t id);
 ogs_pfcp_pdr_t *ogs_pfcp_pdr_find_or_add(
@@ -460,6 +623,11 @@ ogs_pfcp_far_t *ogs_pfcp_far_find_by_teid(uint32_t teid);
 void ogs_pfcp_far_remove(ogs_pfcp_far_t *far);
 void ogs_pfcp_far_remove_all(ogs_pfcp_sess_t *sess);
 
+bool ogs_pfcp_far_buffer_push(ogs_pfcp_far_t *far, ogs_pkbuf_t *pkbuf);
+ogs_pkbuf_t *ogs_pfcp_far_buffer_pop(ogs_pfcp_far_t *far);
+void ogs_pfcp_far_buffer_expire(ogs_pfcp_far_t *far, ogs_time_t now);
+void ogs_pfcp_far_buffer_clear(ogs_pfcp_far_t *far);
+
 ogs_pfcp_urr_t *ogs_pfcp_urr_add(ogs_pfcp_sess_t *sess);
 ogs_pfcp_urr_t *ogs_pfcp_urr_find(
         ogs_pfcp_sess_t *sess, ogs_pfcp_urr_id_t id);
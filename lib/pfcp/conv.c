@@ -188,6 +188,33 @@ int ogs_pfcp_sockaddr_to_f_seid(ogs_pfcp_f_seid_t *f_seid, int *len)
     return OGS_OK;
 }
 
+int ogs_pfcp_sockaddr_to_fq_csid(ogs_pfcp_fq_csid_t *fq_csid, uint16_t csid)
+{
+    ogs_sockaddr_t *advertise = ogs_pfcp_self()->pfcp_advertise;
+    ogs_sockaddr_t *advertise6 = ogs_pfcp_self()->pfcp_advertise6;
+    ogs_sockaddr_t *addr = advertise ? advertise : ogs_pfcp_self()->pfcp_addr;
+    ogs_sockaddr_t *addr6 = advertise6 ? advertise6 : ogs_pfcp_self()->pfcp_addr6;
+
+    ogs_assert(fq_csid);
+
+    memset(fq_csid, 0, sizeof *fq_csid);
+
+    if (addr) {
+        fq_csid->node_id_type = OGS_PFCP_FQ_CSID_NODE_ID_IPV4;
+        fq_csid->addr = addr->sin.sin_addr.s_addr;
+    } else if (addr6) {
+        fq_csid->node_id_type = OGS_PFCP_FQ_CSID_NODE_ID_IPV6;
+        memcpy(fq_csid->addr6, addr6->sin6.sin6_addr.s6_addr, OGS_IPV6_LEN);
+    } else {
+        ogs_error("No IPv4 or IPv6");
+        return OGS_ERROR;
+    }
+
+    fq_csid->csid[fq_csid->num_of_csid++] = csid;
+
+    return OGS_OK;
+}
+
 int ogs_pfcp_f_seid_to_ip(ogs_pfcp_f_seid_t *f_seid, ogs_ip_t *ip)
 {
     ogs_assert(ip);
@@ -35,6 +35,8 @@ int ogs_pfcp_f_seid_to_sockaddr(
 int ogs_pfcp_sockaddr_to_f_seid(ogs_pfcp_f_seid_t *f_seid, int *len);
 int ogs_pfcp_f_seid_to_ip(ogs_pfcp_f_seid_t *f_seid, ogs_ip_t *ip);
 
+int ogs_pfcp_sockaddr_to_fq_csid(ogs_pfcp_fq_csid_t *fq_csid, uint16_t csid);
+
 int ogs_pfcp_sockaddr_to_f_teid(
     ogs_sockaddr_t *addr, ogs_sockaddr_t *addr6,
     ogs_pfcp_f_teid_t *f_teid, int *len);
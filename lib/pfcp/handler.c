@@ -105,6 +105,10 @@ bool ogs_pfcp_cp_handle_association_setup_request(
 
     ogs_gtpu_resource_remove_all(&node->gtpu_resource_list);
 
+    /* Sequence numbers restart with the peer's association */
+    memset(&node->load, 0, sizeof(node->load));
+    memset(&node->overload, 0, sizeof(node->overload));
+
     for (i = 0; i < OGS_MAX_NUM_OF_GTPU_RESOURCE; i++) {
         ogs_pfcp_tlv_user_plane_ip_resource_information_t *message =
             &req->user_plane_ip_resource_information[i];
@@ -157,6 +161,10 @@ bool ogs_pfcp_cp_handle_association_setup_response(
 
     ogs_gtpu_resource_remove_all(&node->gtpu_resource_list);
 
+    /* Sequence numbers restart with the peer's association */
+    memset(&node->load, 0, sizeof(node->load));
+    memset(&node->overload, 0, sizeof(node->overload));
+
     for (i = 0; i < OGS_MAX_NUM_OF_GTPU_RESOURCE; i++) {
         ogs_pfcp_tlv_user_plane_ip_resource_information_t *message =
             &rsp->user_plane_ip_resource_information[i];
@@ -199,6 +207,7 @@ bool ogs_pfcp_up_handle_association_setup_request(
         ogs_pfcp_association_setup_request_t *req)
 {
     ogs_assert(xact);
+    ogs_assert(node);
     ogs_pfcp_up_send_association_setup_response(
             xact, OGS_PFCP_CAUSE_REQUEST_ACCEPTED);
 
@@ -207,6 +216,10 @@ bool ogs_pfcp_up_handle_association_setup_request(
             req->cp_function_features.u8;
     }
 
+    /* Advertise the current load to the newly associated peer */
+    memset(&node->load, 0, sizeof(node->load));
+    memset(&node->overload, 0, sizeof(node->overload));
+
     return true;
 }
 
@@ -215,6 +228,7 @@ bool ogs_pfcp_up_handle_association_setup_response(
         ogs_pfcp_association_setup_response_t *rsp)
 {
     ogs_assert(xact);
+    ogs_assert(node);
     ogs_pfcp_xact_commit(xact);
 
     if (rsp->cp_function_features.presence) {
@@ -222,9 +236,135 @@ bool ogs_pfcp_up_handle_association_setup_response(
             rsp->cp_function_features.u8;
     }
 
+    /* Advertise the current load to the newly associated peer */
+    memset(&node->load, 0, sizeof(node->load));
+    memset(&node->overload, 0, sizeof(node->overload));
+
     return true;
 }
 
+void ogs_pfcp_cp_handle_load_control_information(ogs_pfcp_node_t *node,
+        ogs_pfcp_tlv_load_control_information_t *message)
+{
+    uint32_t sequence;
+    uint8_t metric;
+
+    ogs_assert(node);
+    ogs_assert(message);
+
+    if (message->presence == 0)
+        return;
+
+    if (message->load_control_sequence_number.len != sizeof(sequence) ||
+        message->load_metric.len != sizeof(metric)) {
+        ogs_error("Invalid Load Control Information");
+        return;
+    }
+
+    memcpy(&sequence,
+            message->load_control_sequence_number.data, sizeof(sequence));
+    sequence = be32toh(sequence);
+    memcpy(&metric, message->load_metric.data, sizeof(metric));
+
+    /* Information older than what was already received is discarded */
+    if (node->load.sequence && (int32_t)(sequence - node->load.sequence) <= 0)
+        return;
+
+    node->load.sequence = sequence;
+    node->load.metric = ogs_min(metric, 100);
+}
+
+void ogs_pfcp_cp_handle_overload_control_information(ogs_pfcp_node_t *node,
+        ogs_pfcp_tlv_overload_control_information_t *message)
+{
+    uint32_t sequence, validity;
+    uint8_t reduction, timer;
+
+    ogs_assert(node);
+    ogs_assert(message);
+
+    if (message->presence == 0)
+        return;
+
+    if (message->overload_control_sequence_number.len != sizeof(sequence) ||
+        message->overload_reduction_metric.len != sizeof(reduction) ||
+        message->period_of_validity.len != sizeof(timer)) {
+        ogs_error("Invalid Overload Control Information");
+        return;
+    }
+
+    memcpy(&sequence,
+            message->overload_control_sequence_number.data, sizeof(sequence));
+    sequence = be32toh(sequence);
+    memcpy(&reduction,
+            message->overload_reduction_metric.data, sizeof(reduction));
+    memcpy(&timer, message->period_of_validity.data, sizeof(timer));
+
+    if (node->overload.sequence &&
+        (int32_t)(sequence - node->overload.sequence) <= 0)
+        return;
+
+    node->overload.sequence = sequence;
+    node->overload.reduction = ogs_min(reduction, 100);
+
+    /* A zero metric or validity stops the overload control */
+    validity = ogs_pfcp_timer_to_sec(timer);
+    if (node->overload.reduction == 0 || validity == 0)
+        node->overload.expires = 0;
+    else if (validity == OGS_PFCP_TIMER_INFINITE)
+        node->overload.expires = OGS_INFINITE_TIME;
+    else
+        node->overload.expires =
+            ogs_get_monotonic_time() + ogs_time_from_sec(validity);
+}
+
+/*
+ * The FQ-CSIDs of a Session Set Deletion Request are told apart only by
+ * their order, so they are collected from all the IE slots.
+ */
+uint8_t ogs_pfcp_handle_session_set_deletion_request(
+        ogs_pfcp_session_set_deletion_request_t *req,
+        ogs_pfcp_fq_csid_t *fq_csid, int *num_of_fq_csid)
+{
+    ogs_pfcp_tlv_fq_csid_t *slot[OGS_PFCP_MAX_NUM_OF_FQ_CSID];
+    int i;
+
+    ogs_assert(req);
+    ogs_assert(fq_csid);
+    ogs_assert(num_of_fq_csid);
+
+    *num_of_fq_csid = 0;
+
+    if (req->node_id.presence == 0) {
+        ogs_error("No Node ID");
+        return OGS_PFCP_CAUSE_MANDATORY_IE_MISSING;
+    }
+
+    slot[0] = &req->sgw_c_fq_csid;
+    slot[1] = &req->pgw_c_smf_fq_csid;
+    slot[2] = &req->pgw_u_sgw_u__upf_fq_csid;
+    slot[3] = &req->twan_fq_csid;
+    slot[4] = &req->epdg_fq_csid;
+    slot[5] = &req->mme_fq_csid;
+
+    for (i = 0; i < OGS_PFCP_MAX_NUM_OF_FQ_CSID; i++) {
+        if (slot[i]->presence == 0)
+            continue;
+
+        if (ogs_pfcp_parse_fq_csid(&fq_csid[*num_of_fq_csid], slot[i]) == 0)
+            return OGS_PFCP_CAUSE_MANDATORY_IE_INCORRECT;
+
+        (*num_of_fq_csid)++;
+    }
+
+    if (*num_of_fq_csid == 0) {
+        ogs_error("No FQ-CSID");
+        return OGS_PFCP_CAUSE_CONDITIONAL_IE_MISSING;
+    }
+
+    return OGS_PFCP_CAUSE_REQUEST_ACCEPTED;
+}
+
 bool ogs_pfcp_up_handle_pdr(
         ogs_pfcp_pdr_t *pdr, uint8_t type,
         ogs_gtp2_header_desc_t *recvhdr, ogs_pkbuf_t *sendbuf,
@@ -284,17 +424,12 @@ bool ogs_pfcp_up_handle_pdr(
 
     if (buffering == true) {
 
-        if (far->num_of_buffered_packet == 0) {
+        if (ogs_pfcp_far_buffer_push(far, sendbuf) == true &&
+            far->num_of_buffered_packet == 1) {
             /* Only the first time a packet is buffered,
              * it reports downlink notifications. */
             report->type.downlink_data_report = 1;
         }
-
-        if (far->num_of_buffered_packet < OGS_MAX_NUM_OF_PACKET_BUFFER) {
-            far->buffered_packet[far->num_of_buffered_packet++] = sendbuf;
-        } else {
-            ogs_pkbuf_free(sendbuf);
-        }
     }
 
     return true;
@@ -969,6 +1104,8 @@ ogs_pfcp_far_t *ogs_pfcp_handle_create_far(ogs_pfcp_sess_t *sess,
 
     far->dst_if = 0;
     memset(&far->outer_header_creation, 0, sizeof(far->outer_header_creation));
+    far->outer_header_creation_len = 0;
+    far->encap.valid = false;
 
     if (far->dnn) {
         ogs_free(far->dnn);
@@ -1012,6 +1149,9 @@ ogs_pfcp_far_t *ogs_pfcp_handle_create_far(ogs_pfcp_sess_t *sess,
             memcpy(&far->outer_header_creation, outer_header_creation->data,
                     ogs_min(sizeof(far->outer_header_creation),
                             outer_header_creation->len));
+            far->outer_header_creation_len =
+                    ogs_min(sizeof(far->outer_header_creation),
+                            outer_header_creation->len);
             far->outer_header_creation.teid =
                     be32toh(far->outer_header_creation.teid);
         }
@@ -1130,8 +1270,12 @@ ogs_pfcp_far_t *ogs_pfcp_handle_update_far(ogs_pfcp_sess_t *sess,
             memcpy(&far->outer_header_creation, outer_header_creation->data,
                     ogs_min(sizeof(far->outer_header_creation),
                             outer_header_creation->len));
+            far->outer_header_creation_len =
+                    ogs_min(sizeof(far->outer_header_creation),
+                            outer_header_creation->len);
             far->outer_header_creation.teid =
                     be32toh(far->outer_header_creation.teid);
+            far->encap.valid = false;
         }
     }
 
@@ -1312,6 +1456,42 @@ ogs_pfcp_bar_t *ogs_pfcp_handle_create_bar(ogs_pfcp_sess_t *sess,
 
     sess->bar->id = message->bar_id.u8;
 
+    if (message->suggested_buffering_packets_count.presence &&
+        message->suggested_buffering_packets_count.len)
+        sess->bar->suggested_buffering_packets_count =
+            *(uint8_t *)message->suggested_buffering_packets_count.data;
+
+    return sess->bar;
+}
+
+ogs_pfcp_bar_t *ogs_pfcp_handle_update_bar(ogs_pfcp_sess_t *sess,
+        ogs_pfcp_tlv_update_bar_session_modification_request_t *message,
+        uint8_t *cause_value, uint8_t *offending_ie_value)
+{
+    ogs_assert(message);
+    ogs_assert(sess);
+
+    if (message->presence == 0)
+        return NULL;
+
+    if (message->bar_id.presence == 0) {
+        ogs_error("No BAR-ID");
+        *cause_value = OGS_PFCP_CAUSE_MANDATORY_IE_MISSING;
+        *offending_ie_value = OGS_PFCP_BAR_ID_TYPE;
+        return NULL;
+    }
+
+    if (!sess->bar || sess->bar->id != message->bar_id.u8) {
+        ogs_error("Unknown BAR-ID[%d]", message->bar_id.u8);
+        *cause_value = OGS_PFCP_CAUSE_SESSION_CONTEXT_NOT_FOUND;
+        return NULL;
+    }
+
+    if (message->suggested_buffering_packets_count.presence &&
+        message->suggested_buffering_packets_count.len)
+        sess->bar->suggested_buffering_packets_count =
+            *(uint8_t *)message->suggested_buffering_packets_count.data;
+
     return sess->bar;
 }
 
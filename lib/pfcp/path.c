@@ -343,6 +343,131 @@ int ogs_pfcp_up_send_association_setup_response(ogs_pfcp_xact_t *xact,
     return rv;
 }
 
+int ogs_pfcp_cp_send_session_set_deletion_request(ogs_pfcp_node_t *node,
+        void (*cb)(ogs_pfcp_xact_t *xact, void *data))
+{
+    int rv;
+    ogs_pkbuf_t *pkbuf = NULL;
+    ogs_pfcp_header_t h;
+    ogs_pfcp_xact_t *xact = NULL;
+
+    ogs_assert(node);
+    ogs_assert(node->num_of_stale_csid);
+
+    memset(&h, 0, sizeof(ogs_pfcp_header_t));
+    h.type = OGS_PFCP_SESSION_SET_DELETION_REQUEST_TYPE;
+    h.seid = 0;
+
+    xact = ogs_pfcp_xact_local_create(node, cb, node);
+    if (!xact) {
+        ogs_error("ogs_pfcp_xact_local_create() failed");
+        return OGS_ERROR;
+    }
+
+    pkbuf = ogs_pfcp_cp_build_session_set_deletion_request(h.type,
+            node->stale_csid, node->num_of_stale_csid);
+    if (!pkbuf) {
+        ogs_error("ogs_pfcp_cp_build_session_set_deletion_request() failed");
+        return OGS_ERROR;
+    }
+
+    rv = ogs_pfcp_xact_update_tx(xact, &h, pkbuf);
+    if (rv != OGS_OK) {
+        ogs_error("ogs_pfcp_xact_update_tx() failed");
+        return OGS_ERROR;
+    }
+
+    rv = ogs_pfcp_xact_commit(xact);
+    ogs_expect(rv == OGS_OK);
+
+    return rv;
+}
+
+int ogs_pfcp_send_session_set_response(ogs_pfcp_xact_t *xact,
+        uint8_t type, uint8_t cause)
+{
+    int rv;
+    ogs_pkbuf_t *pkbuf = NULL;
+    ogs_pfcp_header_t h;
+
+    ogs_assert(xact);
+
+    memset(&h, 0, sizeof(ogs_pfcp_header_t));
+    h.type = type;
+    h.seid = 0;
+
+    pkbuf = ogs_pfcp_build_session_set_response(h.type, cause);
+    if (!pkbuf) {
+        ogs_error("ogs_pfcp_build_session_set_response() failed");
+        return OGS_ERROR;
+    }
+
+    rv = ogs_pfcp_xact_update_tx(xact, &h, pkbuf);
+    if (rv != OGS_OK) {
+        ogs_error("ogs_pfcp_xact_update_tx() failed");
+        return OGS_ERROR;
+    }
+
+    rv = ogs_pfcp_xact_commit(xact);
+    ogs_expect(rv == OGS_OK);
+
+    return rv;
+}
+
+/*
+ * Fills the GTP-U header sent on behalf of the PDR: the TEID of its FAR
+ * and, when a QER carries a QFI, the PDU session container.
+ */
+static void pfcp_g_pdu_header(ogs_pfcp_pdr_t *pdr,
+        uint8_t type, ogs_gtp2_header_desc_t *header_desc)
+{
+    ogs_pfcp_far_t *far = NULL;
+    uint8_t qfi = 0;
+
+    ogs_assert(pdr);
+    far = pdr->far;
+    ogs_assert(far);
+    ogs_assert(header_desc);
+
+    if (pdr->qer)
+        qfi = pdr->qer->qfi;
+
+    memset(header_desc, 0, sizeof(*header_desc));
+
+    header_desc->type = type;
+    header_desc->teid = far->outer_header_creation.teid;
+
+    if (qfi) {
+        header_desc->pdu_type =
+            OGS_GTP2_EXTENSION_HEADER_PDU_TYPE_DL_PDU_SESSION_INFORMATION;
+        header_desc->qos_flow_identifier = qfi;
+    }
+}
+
+/*
+ * The FAR keeps the whole GTP-U header precompiled. It is rebuilt only
+ * if N4 has changed the FAR or the QFI/message type differs from the
+ * cached one.
+ */
+static int pfcp_g_pdu_encap(
+        ogs_pfcp_far_t *far, ogs_gtp2_header_desc_t *header_desc)
+{
+    ogs_assert(far);
+    ogs_assert(header_desc);
+
+    if (far->encap.valid == true &&
+        far->encap.type == header_desc->type &&
+        far->encap.qos_flow_identifier == header_desc->qos_flow_identifier)
+        return OGS_OK;
+
+    if (ogs_gtp2_build_encap(&far->encap, header_desc) != OGS_OK) {
+        ogs_error("ogs_gtp2_build_encap() failed");
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
 void ogs_pfcp_send_g_pdu(
         ogs_pfcp_pdr_t *pdr,
         ogs_gtp2_header_desc_t *sendhdr, ogs_pkbuf_t *sendbuf)
@@ -373,15 +498,18 @@ void ogs_pfcp_send_g_pdu(
     ogs_assert(gnode);
     ogs_assert(gnode->sock);
 
-    memset(&header_desc, 0, sizeof(header_desc));
+    pfcp_g_pdu_header(pdr, sendhdr->type, &header_desc);
 
-    header_desc.type = sendhdr->type;
-    header_desc.teid = far->outer_header_creation.teid;
+    if (sendhdr->udp.presence == false &&
+        sendhdr->pdcp_number_presence == false) {
+        /* Fast path : send with the header cached in the FAR */
+        if (pfcp_g_pdu_encap(far, &header_desc) != OGS_OK) {
+            ogs_pkbuf_free(sendbuf);
+            return;
+        }
 
-    if (pdr->qer && pdr->qer->qfi) {
-        header_desc.pdu_type =
-            OGS_GTP2_EXTENSION_HEADER_PDU_TYPE_DL_PDU_SESSION_INFORMATION;
-        header_desc.qos_flow_identifier = pdr->qer->qfi;
+        ogs_gtp2_send_user_plane_encap(gnode, &far->encap, sendbuf);
+        return;
     }
 
     if (sendhdr->udp.presence == true) {
@@ -443,28 +571,58 @@ int ogs_pfcp_send_end_marker(ogs_pfcp_pdr_t *pdr)
     return OGS_OK;
 }
 
+#define OGS_PFCP_MAX_FLUSH_BATCH 32
+
+/*
+ * Buffered packets all take the G-PDU fast path of ogs_pfcp_send_g_pdu()
+ * towards the same peer, so they are flushed in batches with one
+ * system call each.
+ */
 void ogs_pfcp_send_buffered_packet(ogs_pfcp_pdr_t *pdr)
 {
     ogs_pfcp_far_t *far = NULL;
-    int i;
+    ogs_gtp_node_t *gnode = NULL;
+    ogs_gtp2_header_desc_t header_desc;
+    ogs_pkbuf_t *pkbuf[OGS_PFCP_MAX_FLUSH_BATCH];
+    int num;
 
     ogs_assert(pdr);
     far = pdr->far;
 
-    if (far && far->gnode) {
-        if (far->apply_action & OGS_PFCP_APPLY_ACTION_FORW) {
-            for (i = 0; i < far->num_of_buffered_packet; i++) {
-                ogs_gtp2_header_desc_t sendhdr;
+    if (!far || !far->gnode)
+        return;
+    if ((far->apply_action & OGS_PFCP_APPLY_ACTION_FORW) == 0)
+        return;
 
-                memset(&sendhdr, 0, sizeof(sendhdr));
-                sendhdr.type = OGS_GTPU_MSGTYPE_GPDU;
+    ogs_pfcp_far_buffer_expire(far, ogs_time_cached());
+    if (!far->num_of_buffered_packet)
+        return;
 
-                ogs_pfcp_send_g_pdu(
-                        pdr, &sendhdr, far->buffered_packet[i]);
-            }
-            far->num_of_buffered_packet = 0;
-        }
+    if (far->dst_if == OGS_PFCP_INTERFACE_UNKNOWN) {
+        ogs_error("No Destination Interface");
+        ogs_pfcp_far_buffer_clear(far);
+        return;
+    }
+
+    gnode = far->gnode;
+    ogs_assert(gnode->sock);
+
+    pfcp_g_pdu_header(pdr, OGS_GTPU_MSGTYPE_GPDU, &header_desc);
+    if (pfcp_g_pdu_encap(far, &header_desc) != OGS_OK) {
+        ogs_pfcp_far_buffer_clear(far);
+        return;
     }
+
+    do {
+        for (num = 0; num < OGS_PFCP_MAX_FLUSH_BATCH; num++) {
+            pkbuf[num] = ogs_pfcp_far_buffer_pop(far);
+            if (!pkbuf[num])
+                break;
+        }
+        if (num)
+            ogs_gtp2_send_user_plane_encap_batch(
+                    gnode, &far->encap, pkbuf, num);
+    } while (num == OGS_PFCP_MAX_FLUSH_BATCH);
 }
 
 void ogs_pfcp_send_error_message(
@@ -505,6 +663,11 @@ void ogs_pfcp_send_error_message(
         cause = &errmsg.pfcp_session_set_deletion_response.cause;
         offending_ie = &errmsg.pfcp_session_set_deletion_response.offending_ie;
         break;
+    case OGS_PFCP_SESSION_SET_MODIFICATION_RESPONSE_TYPE:
+        cause = &errmsg.pfcp_session_set_modification_response.cause;
+        offending_ie =
+            &errmsg.pfcp_session_set_modification_response.offending_ie;
+        break;
     case OGS_PFCP_SESSION_ESTABLISHMENT_RESPONSE_TYPE:
         cause = &errmsg.pfcp_session_establishment_response.cause;
         offending_ie = &errmsg.pfcp_session_establishment_response.offending_ie;
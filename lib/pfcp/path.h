@@ -78,6 +78,11 @@ int ogs_pfcp_up_send_association_setup_request(ogs_pfcp_node_t *node,
 int ogs_pfcp_up_send_association_setup_response(ogs_pfcp_xact_t *xact,
         uint8_t cause);
 
+int ogs_pfcp_cp_send_session_set_deletion_request(ogs_pfcp_node_t *node,
+        void (*cb)(ogs_pfcp_xact_t *xact, void *data));
+int ogs_pfcp_send_session_set_response(ogs_pfcp_xact_t *xact,
+        uint8_t type, uint8_t cause);
+
 void ogs_pfcp_send_g_pdu(
         ogs_pfcp_pdr_t *pdr,
         ogs_gtp2_header_desc_t *sendhdr, ogs_pkbuf_t *sendbuf);
@@ -833,3 +833,145 @@ int16_t ogs_pfcp_build_user_id(
 
     return octet->len;
 }
+
+int16_t ogs_pfcp_build_fq_csid(ogs_tlv_octet_t *octet,
+        ogs_pfcp_fq_csid_t *fq_csid, void *data, int data_len)
+{
+    unsigned char *p = data;
+    int16_t size = 0;
+    int i;
+
+    ogs_assert(fq_csid);
+    ogs_assert(octet);
+    ogs_assert(data);
+    ogs_assert(fq_csid->num_of_csid > 0 &&
+            fq_csid->num_of_csid <= OGS_PFCP_MAX_NUM_OF_CSID);
+    ogs_assert(data_len >= 1 + OGS_IPV6_LEN +
+            fq_csid->num_of_csid * sizeof(uint16_t));
+
+    octet->data = data;
+
+    p[size++] = (fq_csid->node_id_type << 4) | fq_csid->num_of_csid;
+
+    if (fq_csid->node_id_type == OGS_PFCP_FQ_CSID_NODE_ID_IPV6) {
+        memcpy(p + size, fq_csid->addr6, OGS_IPV6_LEN);
+        size += OGS_IPV6_LEN;
+    } else {
+        memcpy(p + size, &fq_csid->addr, OGS_IPV4_LEN);
+        size += OGS_IPV4_LEN;
+    }
+
+    for (i = 0; i < fq_csid->num_of_csid; i++) {
+        p[size++] = fq_csid->csid[i] >> 8;
+        p[size++] = fq_csid->csid[i] & 0xff;
+    }
+
+    octet->len = size;
+
+    return octet->len;
+}
+
+int16_t ogs_pfcp_parse_fq_csid(
+        ogs_pfcp_fq_csid_t *fq_csid, ogs_tlv_octet_t *octet)
+{
+    unsigned char *p = NULL;
+    int16_t size = 0;
+    int addr_len, i;
+
+    ogs_assert(fq_csid);
+    ogs_assert(octet);
+
+    memset(fq_csid, 0, sizeof(ogs_pfcp_fq_csid_t));
+
+    p = octet->data;
+    if (octet->len < 1) {
+        ogs_error("Invalid FQ-CSID length [%d]", octet->len);
+        return 0;
+    }
+
+    fq_csid->node_id_type = p[size] >> 4;
+    fq_csid->num_of_csid = p[size] & 0x0f;
+    size++;
+
+    addr_len = fq_csid->node_id_type == OGS_PFCP_FQ_CSID_NODE_ID_IPV6 ?
+        OGS_IPV6_LEN : OGS_IPV4_LEN;
+    if (octet->len < size + addr_len +
+            fq_csid->num_of_csid * (int)sizeof(uint16_t)) {
+        ogs_error("Invalid FQ-CSID length [%d:%d]",
+                octet->len, fq_csid->num_of_csid);
+        fq_csid->num_of_csid = 0;
+        return 0;
+    }
+
+    if (fq_csid->node_id_type == OGS_PFCP_FQ_CSID_NODE_ID_IPV6)
+        memcpy(fq_csid->addr6, p + size, OGS_IPV6_LEN);
+    else
+        memcpy(&fq_csid->addr, p + size, OGS_IPV4_LEN);
+    size += addr_len;
+
+    for (i = 0; i < fq_csid->num_of_csid; i++) {
+        fq_csid->csid[i] = (p[size] << 8) | p[size+1];
+        size += 2;
+    }
+
+    if (size != octet->len)
+        ogs_error("Mismatch IE Length[%d] != Decoded[%d]", octet->len, size);
+
+    return size;
+}
+
+bool ogs_pfcp_fq_csid_match(ogs_pfcp_fq_csid_t *fq_csid, uint16_t csid)
+{
+    int i;
+
+    ogs_assert(fq_csid);
+
+    for (i = 0; i < fq_csid->num_of_csid; i++)
+        if (fq_csid->csid[i] == csid)
+            return true;
+
+    return false;
+}
+
+uint8_t ogs_pfcp_timer_from_sec(uint32_t sec)
+{
+    static const struct {
+        uint8_t unit;
+        uint32_t sec;
+    } units[] = {
+        { 0, 2 }, { 1, 60 }, { 2, 600 }, { 3, 3600 }, { 4, 36000 },
+    };
+    int i;
+
+    if (sec == OGS_PFCP_TIMER_INFINITE)
+        return 7 << 5;
+
+    /* Pick the finest unit the value fits in, rounding up */
+    for (i = 0; i < OGS_ARRAY_SIZE(units); i++) {
+        uint32_t value = (sec + units[i].sec - 1) / units[i].sec;
+        if (value <= 0x1f)
+            return (units[i].unit << 5) | value;
+    }
+
+    return (4 << 5) | 0x1f;
+}
+
+uint32_t ogs_pfcp_timer_to_sec(uint8_t timer)
+{
+    uint32_t value = timer & 0x1f;
+
+    switch (timer >> 5) {
+    case 0:
+        return value * 2;
+    case 2:
+        return value * 600;
+    case 3:
+        return value * 3600;
+    case 4:
+        return value * 36000;
+    case 7:
+        return OGS_PFCP_TIMER_INFINITE;
+    default:
+        return value * 60;
+    }
+}
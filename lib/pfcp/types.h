@@ -1719,6 +1719,57 @@ ED3(uint8_t     spare:6;,
     };
 } __attribute__ ((packed)) ogs_pfcp_sereq_flags_t;
 
+/*
+ * Timer
+ *
+ * Bits 6 to 8 of octet 5 define the timer value unit:
+ * 000 - 2 seconds, 001 - 1 minute, 010 - 10 minutes, 011 - 1 hour,
+ * 100 - 10 hours, 111 - infinite. Other values shall be interpreted
+ * as multiples of 1 minute. Bits 1 to 5 hold the binary timer value.
+ */
+#define OGS_PFCP_TIMER_INFINITE                 0xffffffff
+uint8_t ogs_pfcp_timer_from_sec(uint32_t sec);
+uint32_t ogs_pfcp_timer_to_sec(uint8_t timer);
+
+/*
+ * OCI Flags
+ *
+ * - Bit 1 – AOCI (Associate OCI with Node ID): if this bit is set to "1",
+ *   the Overload Control Information applies to the node reporting it
+ *   rather than to the PFCP session only.
+ */
+#define OGS_PFCP_OCI_FLAGS_AOCI                 1
+
+/*
+ * 8.2.46 FQ-CSID
+ *
+ * Bits 5 to 8 of octet 5 hold the Node-ID Type (0: IPv4, 1: IPv6,
+ * 2: MCC/MNC-based 4 octets) and bits 1 to 4 the Number of CSIDs,
+ * followed by the Node-Address and each PDN Connection Set Identifier
+ * as 2 octets.
+ */
+#define OGS_PFCP_FQ_CSID_NODE_ID_IPV4           0
+#define OGS_PFCP_FQ_CSID_NODE_ID_IPV6           1
+#define OGS_PFCP_FQ_CSID_NODE_ID_OTHER          2
+#define OGS_PFCP_MAX_NUM_OF_CSID                15
+#define OGS_PFCP_MAX_FQ_CSID_LEN \
+    (1 + OGS_IPV6_LEN + OGS_PFCP_MAX_NUM_OF_CSID * 2)
+typedef struct ogs_pfcp_fq_csid_s {
+    uint8_t     node_id_type;
+    union {
+        uint32_t addr;
+        uint8_t addr6[OGS_IPV6_LEN];
+    };
+    int         num_of_csid;
+    uint16_t    csid[OGS_PFCP_MAX_NUM_OF_CSID];
+} ogs_pfcp_fq_csid_t;
+
+int16_t ogs_pfcp_build_fq_csid(ogs_tlv_octet_t *octet,
+        ogs_pfcp_fq_csid_t *fq_csid, void *data, int data_len);
+int16_t ogs_pfcp_parse_fq_csid(
+        ogs_pfcp_fq_csid_t *fq_csid, ogs_tlv_octet_t *octet);
+bool ogs_pfcp_fq_csid_match(ogs_pfcp_fq_csid_t *fq_csid, uint16_t csid);
+
 #ifdef __cplusplus
 }
 #endif
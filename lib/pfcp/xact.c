@@ -33,7 +33,8 @@ typedef enum {
 static int ogs_pfcp_xact_initialized = 0;
 static uint32_t g_xact_id = 0;
 
-static OGS_POOL(pool, ogs_pfcp_xact_t);
+static OGS_POOL(pfcp_xact_pool, ogs_pfcp_xact_t);
+static ogs_hash_t *xact_hash;
 
 static ogs_pfcp_xact_t *ogs_pfcp_xact_remote_create(
         ogs_pfcp_node_t *node, uint32_t sqn);
@@ -41,6 +42,8 @@ static ogs_pfcp_xact_stage_t ogs_pfcp_xact_get_stage(
         uint8_t type, uint32_t xid);
 static int ogs_pfcp_xact_update_rx(ogs_pfcp_xact_t *xact, uint8_t type);
 
+static ogs_pfcp_xact_rtt_cb_f rtt_cb;
+
 static void response_timeout(void *data);
 static void holding_timeout(void *data);
 static void delayed_commit_timeout(void *data);
@@ -49,7 +52,11 @@ int ogs_pfcp_xact_init(void)
 {
     ogs_assert(ogs_pfcp_xact_initialized == 0);
 
-    ogs_pool_init(&pool, ogs_app()->pool.xact);
+    ogs_pool_init_elastic(&pfcp_xact_pool, ogs_app()->pool.xact);
+
+    xact_hash = ogs_hash_make();
+    ogs_assert(xact_hash);
+    ogs_hash_set_name(xact_hash, "pfcp_xact");
 
     g_xact_id = 0;
 
@@ -62,11 +69,69 @@ void ogs_pfcp_xact_final(void)
 {
     ogs_assert(ogs_pfcp_xact_initialized == 1);
 
-    ogs_pool_final(&pool);
+    ogs_hash_destroy(xact_hash);
+
+    ogs_pool_final(&pfcp_xact_pool);
 
     ogs_pfcp_xact_initialized = 0;
 }
 
+void ogs_pfcp_xact_set_rtt_cb(ogs_pfcp_xact_rtt_cb_f cb)
+{
+    rtt_cb = cb;
+}
+
+/*
+ * Transactions are indexed by (node, originator, xid)
+ * so that a response is matched in O(1) instead of walking
+ * node->local_list/remote_list.
+ */
+static void xact_hash_add(ogs_pfcp_xact_t *xact)
+{
+    ogs_assert(xact);
+    ogs_assert(xact->node);
+
+    xact->hash_key.node = xact->node;
+    xact->hash_key.xid = xact->xid;
+    xact->hash_key.org = xact->org;
+
+    ogs_hash_set(xact_hash, &xact->hash_key, sizeof(xact->hash_key), xact);
+
+    if (xact->org == OGS_PFCP_LOCAL_ORIGINATOR)
+        xact->node->xact_stats.local++;
+    else
+        xact->node->xact_stats.remote++;
+}
+
+static void xact_hash_remove(ogs_pfcp_xact_t *xact)
+{
+    ogs_assert(xact);
+    ogs_assert(xact->node);
+
+    /* The xid may have wrapped around onto a newer transaction */
+    if (ogs_hash_get(xact_hash,
+                &xact->hash_key, sizeof(xact->hash_key)) == xact)
+        ogs_hash_set(xact_hash, &xact->hash_key, sizeof(xact->hash_key), NULL);
+
+    if (xact->org == OGS_PFCP_LOCAL_ORIGINATOR)
+        xact->node->xact_stats.local--;
+    else
+        xact->node->xact_stats.remote--;
+}
+
+static ogs_pfcp_xact_t *xact_hash_find(
+        ogs_pfcp_node_t *node, uint8_t org, uint32_t xid)
+{
+    ogs_pfcp_xact_t key;
+
+    memset(&key.hash_key, 0, sizeof(key.hash_key));
+    key.hash_key.node = node;
+    key.hash_key.xid = xid;
+    key.hash_key.org = org;
+
+    return ogs_hash_get(xact_hash, &key.hash_key, sizeof(key.hash_key));
+}
+
 ogs_pfcp_xact_t *ogs_pfcp_xact_local_create(ogs_pfcp_node_t *node,
         void (*cb)(ogs_pfcp_xact_t *xact, void *data), void *data)
 {
@@ -75,9 +140,9 @@ ogs_pfcp_xact_t *ogs_pfcp_xact_local_create(ogs_pfcp_node_t *node,
 
     ogs_assert(node);
 
-    ogs_pool_id_calloc(&pool, &xact);
+    ogs_pool_id_calloc(&pfcp_xact_pool, &xact);
     ogs_assert(xact);
-    xact->index = ogs_pool_index(&pool, xact);
+    xact->index = ogs_pool_index(&pfcp_xact_pool, xact);
 
     xact->org = OGS_PFCP_LOCAL_ORIGINATOR;
     xact->xid = OGS_NEXT_ID(g_xact_id, PFCP_MIN_XACT_ID, PFCP_MAX_XACT_ID);
@@ -106,6 +171,7 @@ ogs_pfcp_xact_t *ogs_pfcp_xact_local_create(ogs_pfcp_node_t *node,
 
     ogs_list_add(xact->org == OGS_PFCP_LOCAL_ORIGINATOR ?
             &xact->node->local_list : &xact->node->remote_list, xact);
+    xact_hash_add(xact);
 
     ogs_list_init(&xact->pdr_to_create_list);
 
@@ -126,9 +192,9 @@ static ogs_pfcp_xact_t *ogs_pfcp_xact_remote_create(
 
     ogs_assert(node);
 
-    ogs_pool_id_calloc(&pool, &xact);
+    ogs_pool_id_calloc(&pfcp_xact_pool, &xact);
     ogs_assert(xact);
-    xact->index = ogs_pool_index(&pool, xact);
+    xact->index = ogs_pool_index(&pfcp_xact_pool, xact);
 
     xact->org = OGS_PFCP_REMOTE_ORIGINATOR;
     xact->xid = OGS_PFCP_SQN_TO_XID(sqn);
@@ -155,6 +221,7 @@ static ogs_pfcp_xact_t *ogs_pfcp_xact_remote_create(
 
     ogs_list_add(xact->org == OGS_PFCP_LOCAL_ORIGINATOR ?
             &xact->node->local_list : &xact->node->remote_list, xact);
+    xact_hash_add(xact);
 
     ogs_debug("[%d] %s Create  peer [%s]:%d",
             xact->xid,
@@ -177,7 +244,7 @@ void ogs_pfcp_xact_delete_all(ogs_pfcp_node_t *node)
 
 ogs_pfcp_xact_t *ogs_pfcp_xact_find_by_id(ogs_pool_id_t id)
 {
-    return ogs_pool_find_by_id(&pool, id);
+    return ogs_pool_find_by_id(&pfcp_xact_pool, id);
 }
 
 int ogs_pfcp_xact_update_tx(ogs_pfcp_xact_t *xact,
@@ -278,6 +345,9 @@ int ogs_pfcp_xact_update_tx(ogs_pfcp_xact_t *xact,
     }
     h->length = htobe16(pkbuf->len - 4);
 
+    if (xact->org == OGS_PFCP_LOCAL_ORIGINATOR && xact->step == 0)
+        xact->tx_time = ogs_time_cached();
+
     /* Save Message type and packet of this step */
     xact->seq[xact->step].type = h->type;
     xact->seq[xact->step].pkbuf = pkbuf;
@@ -346,6 +416,7 @@ static int ogs_pfcp_xact_update_rx(ogs_pfcp_xact_t *xact, uint8_t type)
                             OGS_PORT(&xact->node->addr));
                 }
 
+                xact->node->xact_stats.duplicated++;
                 return OGS_RETRY;
             }
 
@@ -412,6 +483,7 @@ static int ogs_pfcp_xact_update_rx(ogs_pfcp_xact_t *xact, uint8_t type)
                             OGS_PORT(&xact->node->addr));
                 }
 
+                xact->node->xact_stats.duplicated++;
                 return OGS_RETRY;
             }
 
@@ -451,6 +523,9 @@ static int ogs_pfcp_xact_update_rx(ogs_pfcp_xact_t *xact, uint8_t type)
     if (xact->tm_response)
         ogs_timer_stop(xact->tm_response);
 
+    if (xact->org == OGS_PFCP_LOCAL_ORIGINATOR && xact->step == 1 && rtt_cb)
+        rtt_cb(xact, ogs_time_cached() - xact->tx_time);
+
     /* Save Message type of this step */
     xact->seq[xact->step].type = type;
 
@@ -614,6 +689,7 @@ static void response_timeout(void *data)
         pkbuf = xact->seq[xact->step-1].pkbuf;
         ogs_assert(pkbuf);
 
+        xact->node->xact_stats.retransmitted++;
         ogs_expect(OGS_OK == ogs_pfcp_sendto(xact->node, pkbuf));
     } else {
         ogs_warn("[%d] %s No Reponse. Give up! "
@@ -709,7 +785,7 @@ int ogs_pfcp_xact_receive(
     uint8_t type;
     uint32_t sqn, xid;
     ogs_pfcp_xact_stage_t stage;
-    ogs_list_t *list = NULL;
+    uint8_t org;
     ogs_pfcp_xact_t *new = NULL;
 
     ogs_assert(node);
@@ -722,13 +798,13 @@ int ogs_pfcp_xact_receive(
 
     switch (stage) {
     case PFCP_XACT_INITIAL_STAGE:
-        list = &node->remote_list;
+        org = OGS_PFCP_REMOTE_ORIGINATOR;
         break;
     case PFCP_XACT_INTERMEDIATE_STAGE:
-        list = &node->local_list;
+        org = OGS_PFCP_LOCAL_ORIGINATOR;
         break;
     case PFCP_XACT_FINAL_STAGE:
-        list = &node->local_list;
+        org = OGS_PFCP_LOCAL_ORIGINATOR;
         break;
     default:
         ogs_error("[%d] Unexpected type %u from PFCP peer [%s]:%d",
@@ -736,16 +812,13 @@ int ogs_pfcp_xact_receive(
         return OGS_ERROR;
     }
 
-    ogs_assert(list);
-    ogs_list_for_each(list, new) {
-        if (new->xid == xid) {
-            ogs_debug("[%d] %s Find    peer [%s]:%d",
-                new->xid,
-                new->org == OGS_PFCP_LOCAL_ORIGINATOR ? "LOCAL " : "REMOTE",
-                OGS_ADDR(&node->addr, buf),
-                OGS_PORT(&node->addr));
-            break;
-        }
+    new = xact_hash_find(node, org, xid);
+    if (new) {
+        ogs_debug("[%d] %s Find    peer [%s]:%d",
+            new->xid,
+            new->org == OGS_PFCP_LOCAL_ORIGINATOR ? "LOCAL " : "REMOTE",
+            OGS_ADDR(&node->addr, buf),
+            OGS_PORT(&node->addr));
     }
 
     if (!new) {
@@ -783,6 +856,8 @@ static ogs_pfcp_xact_stage_t ogs_pfcp_xact_get_stage(uint8_t type, uint32_t xid)
     case OGS_PFCP_ASSOCIATION_SETUP_REQUEST_TYPE:
     case OGS_PFCP_ASSOCIATION_UPDATE_REQUEST_TYPE:
     case OGS_PFCP_ASSOCIATION_RELEASE_REQUEST_TYPE:
+    case OGS_PFCP_SESSION_SET_DELETION_REQUEST_TYPE:
+    case OGS_PFCP_SESSION_SET_MODIFICATION_REQUEST_TYPE:
     case OGS_PFCP_SESSION_ESTABLISHMENT_REQUEST_TYPE:
     case OGS_PFCP_SESSION_MODIFICATION_REQUEST_TYPE:
     case OGS_PFCP_SESSION_DELETION_REQUEST_TYPE:
@@ -794,6 +869,8 @@ static ogs_pfcp_xact_stage_t ogs_pfcp_xact_get_stage(uint8_t type, uint32_t xid)
     case OGS_PFCP_ASSOCIATION_UPDATE_RESPONSE_TYPE:
     case OGS_PFCP_ASSOCIATION_RELEASE_RESPONSE_TYPE:
     case OGS_PFCP_VERSION_NOT_SUPPORTED_RESPONSE_TYPE:
+    case OGS_PFCP_SESSION_SET_DELETION_RESPONSE_TYPE:
+    case OGS_PFCP_SESSION_SET_MODIFICATION_RESPONSE_TYPE:
     case OGS_PFCP_SESSION_ESTABLISHMENT_RESPONSE_TYPE:
     case OGS_PFCP_SESSION_MODIFICATION_RESPONSE_TYPE:
     case OGS_PFCP_SESSION_DELETION_RESPONSE_TYPE:
@@ -836,9 +913,10 @@ int ogs_pfcp_xact_delete(ogs_pfcp_xact_t *xact)
     if (xact->tm_delayed_commit)
         ogs_timer_delete(xact->tm_delayed_commit);
 
+    xact_hash_remove(xact);
     ogs_list_remove(xact->org == OGS_PFCP_LOCAL_ORIGINATOR ?
             &xact->node->local_list : &xact->node->remote_list, xact);
-    ogs_pool_id_free(&pool, xact);
+    ogs_pool_id_free(&pfcp_xact_pool, xact);
 
     return OGS_OK;
 }
@@ -47,6 +47,12 @@ typedef struct ogs_pfcp_xact_s {
     uint32_t        xid;            /**< Transaction ID */
     ogs_pfcp_node_t *node;          /**< Relevant PFCP node context */
 
+    struct {
+        ogs_pfcp_node_t *node;
+        uint32_t    xid;
+        uint8_t     org;
+    } hash_key;                     /**< Key of the transaction hash */
+
     /**< Local timer expiration handler & Data*/
     void (*cb)(ogs_pfcp_xact_t *, void *);
     void            *data;
@@ -59,6 +65,8 @@ typedef struct ogs_pfcp_xact_s {
         uint8_t     type;           /**< Message type history */
         ogs_pkbuf_t *pkbuf;         /**< Packet history */
     } seq[3];                       /**< history for the each step */
+    ogs_time_t      tx_time;        /**< First transmission of the
+                                         locally originated request */
 
     ogs_timer_t     *tm_response;   /**< Timer waiting for next message */
     uint8_t         response_rcount;
@@ -135,6 +143,14 @@ typedef struct ogs_pfcp_xact_s {
 int ogs_pfcp_xact_init(void);
 void ogs_pfcp_xact_final(void);
 
+/*
+ * Called when the reply to a locally originated request arrives, with
+ * the time elapsed since the request was first sent. seq[0].type holds
+ * the request type. Used by the NFs to feed their latency histograms.
+ */
+typedef void (*ogs_pfcp_xact_rtt_cb_f)(ogs_pfcp_xact_t *xact, ogs_time_t rtt);
+void ogs_pfcp_xact_set_rtt_cb(ogs_pfcp_xact_rtt_cb_f cb);
+
 ogs_pfcp_xact_t *ogs_pfcp_xact_local_create(ogs_pfcp_node_t *node,
         void (*cb)(ogs_pfcp_xact_t *xact, void *data), void *data);
 void ogs_pfcp_xact_delete_all(ogs_pfcp_node_t *node);
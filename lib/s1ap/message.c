@@ -65,3 +65,79 @@ void ogs_s1ap_free(ogs_s1ap_message_t *message)
     ogs_assert(message);
     ogs_asn_free(&asn_DEF_S1AP_S1AP_PDU, message);
 }
+
+int ogs_s1ap_lazy_decode(ogs_s1ap_lazy_message_t *message, ogs_pkbuf_t *pkbuf)
+{
+    int rv;
+    uint64_t value;
+    ogs_asn_ie_view_t *ie = NULL;
+
+    ogs_assert(message);
+    ogs_assert(pkbuf);
+    ogs_assert(pkbuf->data);
+    ogs_assert(pkbuf->len);
+
+    memset(message, 0, sizeof(*message));
+
+    rv = ogs_asn_lazy_decode(&message->h, pkbuf);
+    if (rv != OGS_OK) {
+        ogs_debug("Cannot peek S1AP-PDU");
+        return rv;
+    }
+
+    ie = ogs_asn_lazy_find_ie(&message->h, S1AP_ProtocolIE_ID_id_eNB_UE_S1AP_ID);
+    if (ie) {
+        /* ENB-UE-S1AP-ID ::= INTEGER (0..16777215) */
+        rv = ogs_asn_lazy_get_uint64(ie, 3, &value);
+        if (rv != OGS_OK) {
+            ogs_warn("Invalid ENB_UE_S1AP_ID");
+            return rv;
+        }
+        message->enb_ue_s1ap_id = value;
+        message->enb_ue_s1ap_id_presence = true;
+    }
+
+    ie = ogs_asn_lazy_find_ie(&message->h, S1AP_ProtocolIE_ID_id_MME_UE_S1AP_ID);
+    if (ie) {
+        /* MME-UE-S1AP-ID ::= INTEGER (0..4294967295) */
+        rv = ogs_asn_lazy_get_uint64(ie, 4, &value);
+        if (rv != OGS_OK) {
+            ogs_warn("Invalid MME_UE_S1AP_ID");
+            return rv;
+        }
+        message->mme_ue_s1ap_id = value;
+        message->mme_ue_s1ap_id_presence = true;
+    }
+
+    ogs_debug("S1AP-PDU [present:%d,proc:%ld,IEs:%d]",
+            message->h.present, message->h.procedureCode,
+            message->h.num_of_ie);
+
+    return OGS_OK;
+}
+
+ogs_asn_ie_view_t *ogs_s1ap_lazy_find_ie(
+        ogs_s1ap_lazy_message_t *message, S1AP_ProtocolIE_ID_t id)
+{
+    ogs_assert(message);
+    return ogs_asn_lazy_find_ie(&message->h, id);
+}
+
+int ogs_s1ap_lazy_decode_ie(ogs_s1ap_lazy_message_t *message,
+        S1AP_ProtocolIE_ID_t id, const asn_TYPE_descriptor_t *td,
+        void *struct_ptr, size_t struct_size)
+{
+    ogs_asn_ie_view_t *ie = NULL;
+
+    ogs_assert(message);
+    ogs_assert(td);
+    ogs_assert(struct_ptr);
+
+    ie = ogs_asn_lazy_find_ie(&message->h, id);
+    if (!ie) {
+        memset(struct_ptr, 0, struct_size);
+        return OGS_ERROR;
+    }
+
+    return ogs_asn_lazy_decode_ie(td, struct_ptr, struct_size, ie);
+}
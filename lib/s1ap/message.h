@@ -34,6 +34,22 @@ int ogs_s1ap_decode(ogs_s1ap_message_t *message, ogs_pkbuf_t *pkbuf);
 ogs_pkbuf_t *ogs_s1ap_encode(ogs_s1ap_message_t *message);
 void ogs_s1ap_free(ogs_s1ap_message_t *message);
 
+typedef struct ogs_s1ap_lazy_message_s {
+    ogs_asn_lazy_pdu_t h;
+
+    bool enb_ue_s1ap_id_presence;
+    uint32_t enb_ue_s1ap_id;
+    bool mme_ue_s1ap_id_presence;
+    uint32_t mme_ue_s1ap_id;
+} ogs_s1ap_lazy_message_t;
+
+int ogs_s1ap_lazy_decode(ogs_s1ap_lazy_message_t *message, ogs_pkbuf_t *pkbuf);
+ogs_asn_ie_view_t *ogs_s1ap_lazy_find_ie(
+        ogs_s1ap_lazy_message_t *message, S1AP_ProtocolIE_ID_t id);
+int ogs_s1ap_lazy_decode_ie(ogs_s1ap_lazy_message_t *message,
+        S1AP_ProtocolIE_ID_t id, const asn_TYPE_descriptor_t *td,
+        void *struct_ptr, size_t struct_size);
+
 #ifdef __cplusplus
 }
 #endif
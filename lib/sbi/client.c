@@ -35,6 +35,8 @@ typedef struct connection_s {
     void *data;
 
     char *method;
+    char *service;
+    ogs_time_t tx_time;
 
     int num_of_header;
     char **headers;
@@ -63,6 +65,8 @@ static OGS_POOL(client_pool, ogs_sbi_client_t);
 static OGS_POOL(sockinfo_pool, sockinfo_t);
 static OGS_POOL(connection_pool, connection_t);
 
+static ogs_sbi_client_rtt_cb_f rtt_cb;
+
 static size_t write_cb(void *contents, size_t size, size_t nmemb, void *data);
 static size_t header_cb(void *ptr, size_t size, size_t nmemb, void *data);
 static int sock_cb(CURL *e, curl_socket_t s, int what, void *cbp, void *sockp);
@@ -99,6 +103,11 @@ void ogs_sbi_client_final(void)
     curl_global_cleanup();
 }
 
+void ogs_sbi_client_set_rtt_cb(ogs_sbi_client_rtt_cb_f cb)
+{
+    rtt_cb = cb;
+}
+
 ogs_sbi_client_t *ogs_sbi_client_add(
         OpenAPI_uri_scheme_e scheme,
         char *fqdn, uint16_t fqdn_port,
@@ -401,6 +410,16 @@ static connection_t *connection_add(
         return NULL;
     }
 
+    if (request->h.service.name) {
+        conn->service = ogs_strdup(request->h.service.name);
+        if (!conn->service) {
+            ogs_error("conn->service is NULL");
+            connection_free(conn);
+            return NULL;
+        }
+    }
+    conn->tx_time = ogs_time_cached();
+
     conn->num_of_header = ogs_hash_count(request->http.headers);
     if (conn->num_of_header) {
         conn->headers = ogs_calloc(conn->num_of_header, sizeof(char *));
@@ -587,6 +606,8 @@ static void connection_free(connection_t *conn)
 
     if (conn->method)
         ogs_free(conn->method);
+    if (conn->service)
+        ogs_free(conn->service);
 
     ogs_pool_free(&connection_pool, conn);
 }
@@ -652,6 +673,10 @@ static void check_multi_info(ogs_sbi_client_t *client)
             if (res == CURLE_OK) {
                 ogs_log_level_e level = OGS_LOG_DEBUG;
 
+                if (rtt_cb)
+                    rtt_cb(conn->client, conn->service, conn->method,
+                            ogs_time_cached() - conn->tx_time);
+
                 response = ogs_sbi_response_new();
                 ogs_assert(response);
 
@@ -96,6 +96,8 @@ typedef struct ogs_sbi_client_s {
     int             still_running;      /* number of running CURL handle */
 
     unsigned int    reference_count;    /* reference count for memory free */
+
+    void            *metrics;           /* Per-peer metrics, set by the app */
 } ogs_sbi_client_t;
 
 typedef struct ogs_sbi_nf_instance_s ogs_sbi_nf_instance_t;
@@ -103,6 +105,15 @@ typedef struct ogs_sbi_nf_instance_s ogs_sbi_nf_instance_t;
 void ogs_sbi_client_init(int num_of_sockinfo_pool, int num_of_connection_pool);
 void ogs_sbi_client_final(void);
 
+/*
+ * Called for every answered request with the time elapsed since
+ * ogs_sbi_client_send_request(). service is NULL when the request
+ * was built without a service name.
+ */
+typedef void (*ogs_sbi_client_rtt_cb_f)(ogs_sbi_client_t *client,
+        const char *service, const char *method, ogs_time_t rtt);
+void ogs_sbi_client_set_rtt_cb(ogs_sbi_client_rtt_cb_f cb);
+
 ogs_sbi_client_t *ogs_sbi_client_add(
         OpenAPI_uri_scheme_e scheme,
         char *fqdn, uint16_t fqdn_port,
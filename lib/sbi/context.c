@@ -25,7 +25,7 @@ static int context_initialized = 0;
 
 static OGS_POOL(nf_instance_pool, ogs_sbi_nf_instance_t);
 static OGS_POOL(nf_service_pool, ogs_sbi_nf_service_t);
-static OGS_POOL(xact_pool, ogs_sbi_xact_t);
+static OGS_POOL(sbi_xact_pool, ogs_sbi_xact_t);
 static OGS_POOL(subscription_spec_pool, ogs_sbi_subscription_spec_t);
 static OGS_POOL(subscription_data_pool, ogs_sbi_subscription_data_t);
 static OGS_POOL(smf_info_pool, ogs_sbi_smf_info_t);
@@ -53,7 +53,7 @@ void ogs_sbi_context_init(OpenAPI_nf_type_e nf_type)
     ogs_pool_init(&nf_instance_pool, ogs_app()->pool.nf);
     ogs_pool_init(&nf_service_pool, ogs_app()->pool.nf_service);
 
-    ogs_pool_init(&xact_pool, ogs_app()->pool.xact);
+    ogs_pool_init_elastic(&sbi_xact_pool, ogs_app()->pool.xact);
 
     ogs_list_init(&self.subscription_spec_list);
     ogs_pool_init(&subscription_spec_pool, ogs_app()->pool.subscription);
@@ -102,7 +102,7 @@ void ogs_sbi_context_final(void)
     ogs_sbi_subscription_spec_remove_all();
     ogs_pool_final(&subscription_spec_pool);
 
-    ogs_pool_final(&xact_pool);
+    ogs_pool_final(&sbi_xact_pool);
 
     ogs_sbi_nf_instance_remove_all();
 
@@ -2271,7 +2271,7 @@ ogs_sbi_xact_t *ogs_sbi_xact_add(
 
     ogs_assert(sbi_object);
 
-    ogs_pool_id_calloc(&xact_pool, &xact);
+    ogs_pool_id_calloc(&sbi_xact_pool, &xact);
     if (!xact) {
         ogs_error("ogs_pool_id_calloc() failed");
         return NULL;
@@ -2313,7 +2313,7 @@ ogs_sbi_xact_t *ogs_sbi_xact_add(
 
         if (xact->discovery_option)
             ogs_sbi_discovery_option_free(xact->discovery_option);
-        ogs_pool_id_free(&xact_pool, xact);
+        ogs_pool_id_free(&sbi_xact_pool, xact);
 
         return NULL;
     }
@@ -2330,7 +2330,7 @@ ogs_sbi_xact_t *ogs_sbi_xact_add(
                 ogs_sbi_discovery_option_free(xact->discovery_option);
 
             ogs_timer_delete(xact->t_response);
-            ogs_pool_id_free(&xact_pool, xact);
+            ogs_pool_id_free(&sbi_xact_pool, xact);
 
             return NULL;
         }
@@ -2389,7 +2389,7 @@ void ogs_sbi_xact_remove(ogs_sbi_xact_t *xact)
         ogs_free(xact->target_apiroot);
 
     ogs_list_remove(&sbi_object->xact_list, xact);
-    ogs_pool_id_free(&xact_pool, xact);
+    ogs_pool_id_free(&sbi_xact_pool, xact);
 }
 
 void ogs_sbi_xact_remove_all(ogs_sbi_object_t *sbi_object)
@@ -2404,7 +2404,7 @@ void ogs_sbi_xact_remove_all(ogs_sbi_object_t *sbi_object)
 
 ogs_sbi_xact_t *ogs_sbi_xact_find_by_id(ogs_pool_id_t id)
 {
-    return ogs_pool_find_by_id(&xact_pool, id);
+    return ogs_pool_find_by_id(&sbi_xact_pool, id);
 }
 
 ogs_sbi_subscription_spec_t *ogs_sbi_subscription_spec_add(
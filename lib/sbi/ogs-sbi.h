@@ -113,6 +113,7 @@
 #include "sbi/nnrf-path.h"
 
 #include "sbi/path.h"
+#include "sbi/worker.h"
 
 #undef OGS_SBI_INSIDE
 
@@ -27,6 +27,14 @@ static void build_default_discovery_parameter(
         ogs_sbi_service_type_e service_type,
         ogs_sbi_discovery_option_t *discovery_option);
 
+static int sbi_event_push(ogs_event_t *e)
+{
+    if (ogs_sbi_worker_enabled())
+        return ogs_sbi_worker_push(e);
+
+    return ogs_queue_push(ogs_app()->queue, e);
+}
+
 int ogs_sbi_server_handler(ogs_sbi_request_t *request, void *data)
 {
     ogs_event_t *e = NULL;
@@ -41,7 +49,7 @@ int ogs_sbi_server_handler(ogs_sbi_request_t *request, void *data)
     e->sbi.request = request;
     e->sbi.data = data;
 
-    rv = ogs_queue_push(ogs_app()->queue, e);
+    rv = sbi_event_push(e);
     if (rv != OGS_OK) {
         ogs_error("ogs_queue_push() failed:%d", (int)rv);
         ogs_sbi_request_free(request);
@@ -72,7 +80,7 @@ int ogs_sbi_client_handler(
     e->sbi.response = response;
     e->sbi.data = data;
 
-    rv = ogs_queue_push(ogs_app()->queue, e);
+    rv = sbi_event_push(e);
     if (rv != OGS_OK) {
         ogs_error("ogs_queue_push() failed:%d", (int)rv);
         ogs_sbi_response_free(response);
@@ -233,7 +241,7 @@ static int client_discover_cb(
     e->sbi.response = response;
     e->sbi.data = data;
 
-    rv = ogs_queue_push(ogs_app()->queue, e);
+    rv = sbi_event_push(e);
     if (rv != OGS_OK) {
         ogs_error("ogs_queue_push() failed:%d", (int)rv);
         ogs_sbi_response_free(response);
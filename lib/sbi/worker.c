@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2024 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-sbi.h"
+
+static ogs_worker_t *worker = NULL;
+
+static void worker_parse(void *data);
+static void worker_event_free(void *data);
+static unsigned int worker_shard(ogs_event_t *e);
+
+int ogs_sbi_worker_open(int num)
+{
+    ogs_assert(worker == NULL);
+
+    if (num <= 0)
+        return OGS_OK;
+
+    worker = ogs_worker_create("SBI", num, worker_parse, worker_event_free);
+    if (!worker)
+        return OGS_ERROR;
+
+    return OGS_OK;
+}
+
+void ogs_sbi_worker_close(void)
+{
+    if (!worker)
+        return;
+
+    ogs_worker_destroy(worker);
+    worker = NULL;
+}
+
+bool ogs_sbi_worker_enabled(void)
+{
+    return worker != NULL;
+}
+
+int ogs_sbi_worker_push(ogs_event_t *e)
+{
+    ogs_assert(e);
+    ogs_assert(e->id == OGS_EVENT_SBI_SERVER ||
+                e->id == OGS_EVENT_SBI_CLIENT);
+    ogs_assert(worker);
+
+    return ogs_worker_push(worker, worker_shard(e), e);
+}
+
+static unsigned int worker_shard(ogs_event_t *e)
+{
+    const char *uri = NULL;
+    int len = 0, segments = 0;
+
+    ogs_assert(e);
+
+    if (e->id == OGS_EVENT_SBI_CLIENT)
+        return OGS_POINTER_TO_UINT(e->sbi.data);
+
+    ogs_assert(e->sbi.request);
+    uri = e->sbi.request->h.uri;
+    if (!uri)
+        return 0;
+
+    if (uri[0] != '/') {
+        /* Skip scheme and authority of an absolute URI */
+        const char *p = strstr(uri, "://");
+        if (p)
+            p = strchr(p + 3, '/');
+        if (!p) {
+            len = OGS_HASH_KEY_STRING;
+            return ogs_hashfunc_default(uri, &len);
+        }
+        uri = p;
+    }
+
+    while (uri[len] && uri[len] != '?') {
+        if (uri[len] == '/' && ++segments > 4)
+            break;
+        len++;
+    }
+
+    return ogs_hashfunc_default(uri, &len);
+}
+
+static void worker_parse(void *data)
+{
+    ogs_event_t *e = data;
+    ogs_sbi_message_t *message = NULL;
+    int rv;
+
+    ogs_assert(e);
+
+    message = ogs_calloc(1, sizeof(*message));
+    ogs_assert(message);
+
+    if (e->id == OGS_EVENT_SBI_SERVER) {
+        ogs_assert(e->sbi.request);
+        rv = ogs_sbi_parse_request(message, e->sbi.request);
+        if (rv != OGS_OK) {
+            /* 'message' buffer is released in ogs_sbi_parse_request() */
+            ogs_free(message);
+            return;
+        }
+    } else {
+        ogs_assert(e->sbi.response);
+        rv = ogs_sbi_parse_response(message, e->sbi.response);
+        if (rv != OGS_OK) {
+            ogs_sbi_message_free(message);
+            ogs_free(message);
+            return;
+        }
+    }
+
+    e->sbi.message = message;
+}
+
+/*
+ * Runs on the main loop thread from ogs_worker_destroy(), for events that
+ * were parsed after the main queue had been terminated. The request and
+ * response pools are not thread-safe, and the peer of a server request
+ * is still waiting for an answer.
+ */
+static void worker_event_free(void *data)
+{
+    ogs_event_t *e = data;
+    ogs_sbi_stream_t *stream = NULL;
+
+    ogs_assert(e);
+
+    if (e->id == OGS_EVENT_SBI_SERVER) {
+        stream = ogs_sbi_stream_find_by_id(OGS_POINTER_TO_UINT(e->sbi.data));
+        if (stream)
+            ogs_expect(true == ogs_sbi_server_send_error(stream,
+                    OGS_SBI_HTTP_STATUS_SERVICE_UNAVAILABLE, e->sbi.message,
+                    "Shutting down", NULL, NULL));
+    }
+
+    if (e->sbi.message) {
+        ogs_sbi_message_free(e->sbi.message);
+        ogs_free(e->sbi.message);
+    }
+    if (e->sbi.request)
+        ogs_sbi_request_free(e->sbi.request);
+    if (e->sbi.response)
+        ogs_sbi_response_free(e->sbi.response);
+    ogs_event_free(e);
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2024 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_SBI_INSIDE) && !defined(OGS_SBI_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_SBI_WORKER_H
+#define OGS_SBI_WORKER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * SBI worker threads parse HTTP requests and responses before they reach
+ * the NF main loop. The parsed message is handed over in e->sbi.message
+ * (allocated with ogs_calloc) and the NF state machine must take it
+ * over instead of calling ogs_sbi_parse_request()/ogs_sbi_parse_response()
+ * again. If parsing fails, e->sbi.message is left NULL.
+ *
+ * Requests are sharded by resource instance (the first four path segments,
+ * e.g. /nsmf-pdusession/v1/sm-contexts/{smContextRef}), so requests on
+ * the same resource stay in order. Responses are sharded by transaction.
+ *
+ * Requests still in the workers at shutdown are answered with
+ * 503 Service Unavailable by ogs_sbi_worker_close(), so it has to be called
+ * before the SBI servers are closed.
+ *
+ * Only NFs that handle pre-parsed messages may call ogs_sbi_worker_open().
+ */
+int ogs_sbi_worker_open(int num_of_worker);
+void ogs_sbi_worker_close(void);
+
+bool ogs_sbi_worker_enabled(void);
+int ogs_sbi_worker_push(ogs_event_t *e);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_SBI_WORKER_H */
@@ -82,6 +82,10 @@ void ogs_sctp_write_to_buffer(ogs_sctp_sock_t *sctp, ogs_pkbuf_t *pkbuf)
 
     ogs_list_add(&sctp->write_queue, pkbuf);
 
+    sctp->stats.queued++;
+    if (sctp->stats.queued > sctp->stats.max_queued)
+        sctp->stats.max_queued = sctp->stats.queued;
+
     if (!sctp->poll.write) {
         ogs_assert(sctp->sock);
         sctp->poll.write = ogs_pollset_add(ogs_app()->pollset,
@@ -90,25 +94,49 @@ void ogs_sctp_write_to_buffer(ogs_sctp_sock_t *sctp, ogs_pkbuf_t *pkbuf)
     }
 }
 
+/*
+ * Everything queued during one loop iteration is flushed from a single
+ * POLLOUT wakeup. The queue is kept in order, so per-stream ordering
+ * is preserved. On EAGAIN the head of the queue stays where it is and
+ * the write poll remains armed until the association becomes writable.
+ */
 static void sctp_write_callback(short when, ogs_socket_t fd, void *data)
 {
     ogs_sctp_sock_t *sctp = data;
     ogs_pkbuf_t *pkbuf = NULL;
+    int sent;
 
     ogs_assert(sctp);
-    if (ogs_list_empty(&sctp->write_queue) == true) {
-        ogs_assert(sctp->poll.write);
-        ogs_pollset_remove(sctp->poll.write);
-        sctp->poll.write = NULL;
-        return;
-    }
+    ogs_assert(sctp->sock);
 
-    pkbuf = ogs_list_first(&sctp->write_queue);
-    ogs_assert(pkbuf);
-    ogs_list_remove(&sctp->write_queue, pkbuf);
+    while ((pkbuf = ogs_list_first(&sctp->write_queue)) != NULL) {
+        sent = ogs_sctp_sendmsg(sctp->sock, pkbuf->data, pkbuf->len, NULL,
+                ogs_sctp_ppid_in_pkbuf(pkbuf),
+                ogs_sctp_stream_no_in_pkbuf(pkbuf));
+        if (sent < 0 && ogs_socket_errno == OGS_EAGAIN) {
+            sctp->stats.eagain++;
+            return;
+        }
 
-    ogs_assert(sctp->sock);
-    ogs_sctp_senddata(sctp->sock, pkbuf, NULL);
+        ogs_list_remove(&sctp->write_queue, pkbuf);
+        ogs_assert(sctp->stats.queued);
+        sctp->stats.queued--;
+
+        if (sent < 0 || sent != pkbuf->len) {
+            ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                    "ogs_sctp_sendmsg(len:%d,ssn:%d)",
+                    pkbuf->len, (int)ogs_sctp_stream_no_in_pkbuf(pkbuf));
+            sctp->stats.dropped++;
+        } else {
+            sctp->stats.sent++;
+        }
+
+        ogs_pkbuf_free(pkbuf);
+    }
+
+    ogs_assert(sctp->poll.write);
+    ogs_pollset_remove(sctp->poll.write);
+    sctp->poll.write = NULL;
 }
 
 void ogs_sctp_flush_and_destroy(ogs_sctp_sock_t *sctp)
@@ -133,5 +161,6 @@ void ogs_sctp_flush_and_destroy(ogs_sctp_sock_t *sctp)
             ogs_list_remove(&sctp->write_queue, pkbuf);
             ogs_pkbuf_free(pkbuf);
         }
+        sctp->stats.queued = 0;
     }
 }
@@ -48,6 +48,9 @@ extern int __ogs_sctp_domain;
 #define OGS_SCTP_SGSAP_PPID             0
 #define OGS_SCTP_NGAP_PPID              60
 
+/* Maximum number of messages drained from one association per wakeup */
+#define OGS_SCTP_MAX_RECV_BATCH         32
+
 #define ogs_sctp_ppid_in_pkbuf(__pkBUF)         (__pkBUF)->param[0]
 #define ogs_sctp_stream_no_in_pkbuf(__pkBUF)    (__pkBUF)->param[1]
 
@@ -80,6 +83,14 @@ ogs_sock_t *ogs_sctp_accept(ogs_sock_t *sock);
 
 #endif
 
+typedef struct ogs_sctp_stats_s {
+    unsigned int    queued;         /* Current depth of write_queue */
+    unsigned int    max_queued;     /* High-water mark of write_queue */
+    uint64_t        sent;           /* Messages written to the socket */
+    uint64_t        eagain;         /* Flushes stopped by EAGAIN */
+    uint64_t        dropped;        /* Messages discarded on send error */
+} ogs_sctp_stats_t;
+
 typedef struct ogs_sctp_sock_s {
     int             type;           /* SOCK_STREAM or SOCK_SEQPACKET */
 
@@ -92,6 +103,7 @@ typedef struct ogs_sctp_sock_s {
     } poll;
 
     ogs_list_t      write_queue;    /* Write Queue for Sending S1AP message */
+    ogs_sctp_stats_t stats;         /* Write Queue statistics */
 } ogs_sctp_sock_t;
 
 typedef struct ogs_sctp_info_s {
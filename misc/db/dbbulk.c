@@ -0,0 +1,594 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * open5gs-dbbulk: bulk subscriber import/export
+ *
+ * import reads a stream of subscribers, one per line, either as
+ * MongoDB extended JSON documents (JSONL, e.g. the output of export) or
+ * as CSV with a header line naming the columns:
+ *
+ *   imsi,k,opc,op,amf,msisdn,apn,sst,sd,ipv4,ipv6
+ *
+ * imsi and k and one of opc/op are required. The other columns are
+ * optional and default to the values open5gs-dbctl uses. msisdn may
+ * hold several numbers separated by ';'.
+ *
+ * The reader hands batches of lines to a pool of workers. Each worker
+ * parses its batch and writes it with one unordered bulk operation on
+ * its own pooled connection.
+ */
+
+#include "ogs-dbi.h"
+
+#define DEFAULT_DB_URI          "mongodb://localhost/open5gs"
+#define DEFAULT_NUM_OF_WORKER   4
+#define DEFAULT_BATCH_SIZE      1000
+
+#define MAX_NUM_OF_WORKER       64
+#define MAX_BATCH_SIZE          100000
+
+#define MAX_LINE_LEN            (64*1024)
+
+typedef enum {
+    FORMAT_JSONL,
+    FORMAT_CSV,
+} format_e;
+
+typedef struct batch_s {
+    uint64_t seq;
+    int num;
+    uint64_t *lineno;
+    char **line;
+} batch_t;
+
+static struct {
+    format_e format;
+    bool upsert;
+    int batch_size;
+
+    ogs_dbi_bulk_csv_t csv;
+
+    ogs_queue_t *queue;
+    int running;
+
+    uint64_t read;
+    uint64_t written;
+    uint64_t failed;
+} self;
+
+static void show_help(const char *name)
+{
+    printf("Usage: %s [options] command [file]\n"
+        "Commands:\n"
+        "   import [file]  : import subscribers (default: stdin)\n"
+        "   export [file]  : export subscribers as JSON lines "
+                            "(default: stdout)\n"
+        "   index          : create the indexes used by the NFs\n"
+        "Options:\n"
+        "   -d db_uri      : set database URI (default:%s)\n"
+        "   -f format      : input format, csv or jsonl "
+                            "(default: by file extension, else jsonl)\n"
+        "   -j workers     : number of import workers (default:%d)\n"
+        "   -b size        : documents per batch (default:%d)\n"
+        "   -u             : replace the subscriber with the same imsi "
+                            "instead of failing\n"
+        "   -e level       : set log-level (default:info)\n"
+        "   -h             : show this message and exit\n"
+        "\n", name, DEFAULT_DB_URI, DEFAULT_NUM_OF_WORKER,
+        DEFAULT_BATCH_SIZE);
+}
+
+static void progress(ogs_time_t start, bool done)
+{
+    uint64_t read = __atomic_load_n(&self.read, __ATOMIC_RELAXED);
+    uint64_t written = __atomic_load_n(&self.written, __ATOMIC_RELAXED);
+    uint64_t failed = __atomic_load_n(&self.failed, __ATOMIC_RELAXED);
+    ogs_time_t elapsed = ogs_get_monotonic_time() - start;
+    uint64_t rate = 0;
+
+    if (elapsed > 0)
+        rate = written * OGS_USEC_PER_SEC / elapsed;
+
+    ogs_info("%s read:%llu written:%llu failed:%llu "
+            "(%llu/s, %lld.%03llds)",
+            done ? "Done" : "Progress",
+            (unsigned long long)read, (unsigned long long)written,
+            (unsigned long long)failed, (unsigned long long)rate,
+            (long long)(elapsed / OGS_USEC_PER_SEC),
+            (long long)(elapsed % OGS_USEC_PER_SEC / 1000));
+}
+
+static bson_t *jsonl_document(char *line, char *errmsg, size_t errlen)
+{
+    bson_t *doc = NULL;
+    bson_error_t error;
+    bson_iter_t iter;
+
+    doc = bson_new_from_json((const uint8_t *)line, -1, &error);
+    if (!doc) {
+        ogs_snprintf(errmsg, errlen, "%s", error.message);
+        return NULL;
+    }
+
+    if (!bson_iter_init_find(&iter, doc, "imsi") ||
+        !BSON_ITER_HOLDS_UTF8(&iter)) {
+        ogs_snprintf(errmsg, errlen, "No imsi");
+        bson_destroy(doc);
+        return NULL;
+    }
+
+    return doc;
+}
+
+static batch_t *batch_new(void)
+{
+    batch_t *batch = ogs_calloc(1, sizeof(*batch));
+    ogs_assert(batch);
+
+    batch->lineno = ogs_calloc(self.batch_size, sizeof(batch->lineno[0]));
+    ogs_assert(batch->lineno);
+    batch->line = ogs_calloc(self.batch_size, sizeof(batch->line[0]));
+    ogs_assert(batch->line);
+
+    return batch;
+}
+
+static void batch_free(batch_t *batch)
+{
+    int i;
+
+    for (i = 0; i < batch->num; i++)
+        ogs_free(batch->line[i]);
+    ogs_free(batch->lineno);
+    ogs_free(batch->line);
+    ogs_free(batch);
+}
+
+static void batch_write(batch_t *batch)
+{
+    bson_t **doc = NULL;
+    uint64_t *lineno = NULL;
+    char errmsg[OGS_DBI_BULK_MAX_MESSAGE_LEN];
+    ogs_dbi_bulk_result_t *result = NULL;
+    int i, n = 0, failed = 0;
+
+    doc = ogs_calloc(batch->num, sizeof(doc[0]));
+    ogs_assert(doc);
+    lineno = ogs_calloc(batch->num, sizeof(lineno[0]));
+    ogs_assert(lineno);
+
+    for (i = 0; i < batch->num; i++) {
+        if (self.format == FORMAT_CSV)
+            doc[n] = ogs_dbi_bulk_csv_document(&self.csv,
+                    batch->line[i], errmsg, sizeof(errmsg));
+        else
+            doc[n] = jsonl_document(batch->line[i], errmsg, sizeof(errmsg));
+
+        if (!doc[n]) {
+            ogs_error("line %llu: %s",
+                    (unsigned long long)batch->lineno[i], errmsg);
+            failed++;
+            continue;
+        }
+        lineno[n++] = batch->lineno[i];
+    }
+
+    if (n) {
+        result = ogs_malloc(sizeof(*result));
+        ogs_assert(result);
+
+        ogs_dbi_subscriber_bulk_write(doc, n, self.upsert, result);
+
+        for (i = 0; i < result->num_of_error; i++) {
+            int index = result->error[i].index;
+
+            if (index >= 0 && index < n)
+                ogs_error("line %llu: [%d] %s",
+                        (unsigned long long)lineno[index],
+                        result->error[i].code, result->error[i].message);
+        }
+        if (result->message[0])
+            ogs_error("%s", result->message);
+
+        failed += result->failed;
+        __atomic_fetch_add(&self.written,
+                result->inserted + result->upserted + result->matched,
+                __ATOMIC_RELAXED);
+
+        ogs_free(result);
+    }
+
+    if (failed)
+        ogs_error("batch %llu (lines %llu-%llu): %d of %d failed",
+                (unsigned long long)batch->seq,
+                (unsigned long long)batch->lineno[0],
+                (unsigned long long)batch->lineno[batch->num-1],
+                failed, batch->num);
+    __atomic_fetch_add(&self.failed, failed, __ATOMIC_RELAXED);
+
+    for (i = 0; i < n; i++)
+        bson_destroy(doc[i]);
+    ogs_free(doc);
+    ogs_free(lineno);
+}
+
+static void worker_main(void *data)
+{
+    void *batch = NULL;
+    int rv;
+
+    for ( ;; ) {
+        rv = ogs_queue_pop(self.queue, &batch);
+        if (rv != OGS_OK) {
+            ogs_error("ogs_queue_pop() failed [%d]", rv);
+            break;
+        }
+
+        /* The reader pushes one NULL per worker at the end */
+        if (!batch)
+            break;
+
+        batch_write(batch);
+        batch_free(batch);
+    }
+
+    __atomic_fetch_sub(&self.running, 1, __ATOMIC_RELAXED);
+}
+
+static int import(FILE *fp, int num_of_worker)
+{
+    ogs_thread_t *worker[MAX_NUM_OF_WORKER];
+    char *buf = NULL, *line = NULL;
+    batch_t *batch = NULL;
+    uint64_t lineno = 0, seq = 0;
+    ogs_time_t start, last;
+    int i, rv = OGS_OK;
+
+    buf = ogs_malloc(MAX_LINE_LEN);
+    ogs_assert(buf);
+
+    if (self.format == FORMAT_CSV) {
+        while (fgets(buf, MAX_LINE_LEN, fp)) {
+            lineno++;
+            line = ogs_trimwhitespace(buf);
+            if (*line && *line != '#')
+                break;
+            line = NULL;
+        }
+        if (!line || ogs_dbi_bulk_csv_header(&self.csv, line) != OGS_OK) {
+            ogs_free(buf);
+            return OGS_ERROR;
+        }
+    }
+
+    self.queue = ogs_queue_create(num_of_worker * 2);
+    ogs_assert(self.queue);
+
+    self.running = num_of_worker;
+    for (i = 0; i < num_of_worker; i++) {
+        worker[i] = ogs_thread_create(worker_main, NULL);
+        ogs_assert(worker[i]);
+    }
+
+    start = last = ogs_get_monotonic_time();
+
+    while (fgets(buf, MAX_LINE_LEN, fp)) {
+        lineno++;
+
+        if (!strchr(buf, '\n') && !feof(fp)) {
+            int c;
+
+            ogs_error("line %llu: longer than %d bytes",
+                    (unsigned long long)lineno, MAX_LINE_LEN);
+            while ((c = fgetc(fp)) != EOF && c != '\n');
+            __atomic_fetch_add(&self.read, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&self.failed, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        line = ogs_trimwhitespace(buf);
+        if (!*line || *line == '#')
+            continue;
+
+        if (!batch) {
+            batch = batch_new();
+            batch->seq = ++seq;
+        }
+        batch->lineno[batch->num] = lineno;
+        batch->line[batch->num] = ogs_strdup(line);
+        ogs_assert(batch->line[batch->num]);
+        batch->num++;
+        __atomic_fetch_add(&self.read, 1, __ATOMIC_RELAXED);
+
+        if (batch->num == self.batch_size) {
+            ogs_assert(ogs_queue_push(self.queue, batch) == OGS_OK);
+            batch = NULL;
+        }
+
+        if (ogs_get_monotonic_time() - last >= ogs_time_from_sec(1)) {
+            last = ogs_get_monotonic_time();
+            progress(start, false);
+        }
+    }
+    if (ferror(fp)) {
+        ogs_error("Read failed at line %llu", (unsigned long long)lineno);
+        rv = OGS_ERROR;
+    }
+
+    if (batch)
+        ogs_assert(ogs_queue_push(self.queue, batch) == OGS_OK);
+    for (i = 0; i < num_of_worker; i++)
+        ogs_assert(ogs_queue_push(self.queue, NULL) == OGS_OK);
+
+    /*
+     * ogs_thread_destroy() gives a thread only a few seconds,
+     * so wait here until the last batches are written.
+     */
+    while (__atomic_load_n(&self.running, __ATOMIC_RELAXED)) {
+        ogs_msleep(10);
+        if (ogs_get_monotonic_time() - last >= ogs_time_from_sec(1)) {
+            last = ogs_get_monotonic_time();
+            progress(start, false);
+        }
+    }
+    for (i = 0; i < num_of_worker; i++)
+        ogs_thread_destroy(worker[i]);
+    ogs_queue_destroy(self.queue);
+
+    progress(start, true);
+
+    ogs_free(buf);
+
+    if (self.failed)
+        rv = OGS_ERROR;
+
+    return rv;
+}
+
+/*
+ * Canonical extended JSON keeps the BSON types (e.g. the int64 SQN), so
+ * the output can be imported again as it is.
+ */
+static int export(FILE *fp, int batch_size)
+{
+    mongoc_cursor_t *cursor = NULL;
+    bson_t *query = NULL, *opts = NULL;
+    bson_error_t error;
+    const bson_t *document;
+    ogs_time_t start, last;
+    int rv = OGS_OK;
+
+    query = bson_new();
+    ogs_assert(query);
+    opts = BCON_NEW("batchSize", BCON_INT32(batch_size));
+    ogs_assert(opts);
+
+    start = last = ogs_get_monotonic_time();
+
+#if MONGOC_CHECK_VERSION(1, 5, 0)
+    cursor = mongoc_collection_find_with_opts(
+            ogs_dbi_subscriber_collection(), query, opts, NULL);
+#else
+    cursor = mongoc_collection_find(ogs_dbi_subscriber_collection(),
+            MONGOC_QUERY_NONE, 0, 0, batch_size, query, NULL, NULL);
+#endif
+    ogs_assert(cursor);
+
+    while (mongoc_cursor_next(cursor, &document)) {
+        char *json = NULL;
+
+#if MONGOC_CHECK_VERSION(1, 7, 0)
+        json = bson_as_canonical_extended_json(document, NULL);
+#else
+        json = bson_as_json(document, NULL);
+#endif
+        __atomic_fetch_add(&self.read, 1, __ATOMIC_RELAXED);
+
+        if (!json) {
+            __atomic_fetch_add(&self.failed, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (fprintf(fp, "%s\n", json) < 0) {
+            ogs_error("Write failed");
+            bson_free(json);
+            rv = OGS_ERROR;
+            break;
+        }
+        bson_free(json);
+        __atomic_fetch_add(&self.written, 1, __ATOMIC_RELAXED);
+
+        if (ogs_get_monotonic_time() - last >= ogs_time_from_sec(1)) {
+            last = ogs_get_monotonic_time();
+            progress(start, false);
+        }
+    }
+
+    if (mongoc_cursor_error(cursor, &error)) {
+        ogs_error("Cursor Failure: %s", error.message);
+        rv = OGS_ERROR;
+    }
+    if (fflush(fp) != 0) {
+        ogs_error("Write failed");
+        rv = OGS_ERROR;
+    }
+
+    progress(start, true);
+
+    mongoc_cursor_destroy(cursor);
+    bson_destroy(opts);
+    bson_destroy(query);
+
+    return rv;
+}
+
+int main(int argc, const char *const argv[])
+{
+    int rv, opt;
+    ogs_getopt_t options;
+    struct {
+        char *db_uri;
+        char *format;
+        char *log_level;
+        int num_of_worker;
+        int batch_size;
+        bool upsert;
+    } optarg;
+    char *command = NULL, *file = NULL;
+    FILE *fp = NULL;
+
+    memset(&optarg, 0, sizeof(optarg));
+    optarg.db_uri = (char *)DEFAULT_DB_URI;
+    optarg.num_of_worker = DEFAULT_NUM_OF_WORKER;
+    optarg.batch_size = DEFAULT_BATCH_SIZE;
+
+    ogs_getopt_init(&options, (char**)argv);
+    while ((opt = ogs_getopt(&options, "hd:f:j:b:ue:")) != -1) {
+        switch (opt) {
+        case 'h':
+            show_help(argv[0]);
+            return EXIT_SUCCESS;
+        case 'd':
+            optarg.db_uri = options.optarg;
+            break;
+        case 'f':
+            optarg.format = options.optarg;
+            break;
+        case 'j':
+            optarg.num_of_worker = atoi(options.optarg);
+            break;
+        case 'b':
+            optarg.batch_size = atoi(options.optarg);
+            break;
+        case 'u':
+            optarg.upsert = true;
+            break;
+        case 'e':
+            optarg.log_level = options.optarg;
+            break;
+        case '?':
+            fprintf(stderr, "%s: %s\n", argv[0], options.errmsg);
+            show_help(argv[0]);
+            return EXIT_FAILURE;
+        default:
+            fprintf(stderr, "%s: should not be reached\n", OGS_FUNC);
+            return EXIT_FAILURE;
+        }
+    }
+
+    command = ogs_getopt_arg(&options);
+    if (command)
+        file = ogs_getopt_arg(&options);
+
+    if (!command ||
+        (strcmp(command, "import") && strcmp(command, "export") &&
+         strcmp(command, "index"))) {
+        show_help(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (optarg.num_of_worker < 1 ||
+        optarg.num_of_worker > MAX_NUM_OF_WORKER) {
+        fprintf(stderr, "%s: workers must be 1..%d\n",
+                argv[0], MAX_NUM_OF_WORKER);
+        return EXIT_FAILURE;
+    }
+    if (optarg.batch_size < 1 || optarg.batch_size > MAX_BATCH_SIZE) {
+        fprintf(stderr, "%s: batch size must be 1..%d\n",
+                argv[0], MAX_BATCH_SIZE);
+        return EXIT_FAILURE;
+    }
+
+    memset(&self, 0, sizeof(self));
+    self.upsert = optarg.upsert;
+    self.batch_size = optarg.batch_size;
+    self.format = FORMAT_JSONL;
+    if (optarg.format) {
+        if (!strcasecmp(optarg.format, "csv")) {
+            self.format = FORMAT_CSV;
+        } else if (strcasecmp(optarg.format, "jsonl") &&
+                strcasecmp(optarg.format, "json")) {
+            fprintf(stderr, "%s: unknown format [%s]\n",
+                    argv[0], optarg.format);
+            return EXIT_FAILURE;
+        }
+    } else if (file && strlen(file) > 4 &&
+            !strcasecmp(file + strlen(file) - 4, ".csv")) {
+        self.format = FORMAT_CSV;
+    }
+
+    ogs_core_initialize();
+    ogs_log_install_domain(&__ogs_dbi_domain, "dbi", ogs_core()->log.level);
+
+    if (optarg.log_level) {
+        rv = ogs_log_config_domain(NULL, optarg.log_level);
+        if (rv != OGS_OK) {
+            ogs_core_terminate();
+            return EXIT_FAILURE;
+        }
+    }
+
+    rv = ogs_dbi_init(optarg.db_uri);
+    if (rv != OGS_OK) {
+        ogs_error("Failed to connect to [%s]", optarg.db_uri);
+        goto out;
+    }
+
+    /*
+     * import also needs the imsi index for upserts and duplicates,
+     * export only reads and must not need write access.
+     */
+    if (strcmp(command, "export")) {
+        rv = ogs_dbi_subscriber_index_init();
+        if (rv != OGS_OK || !strcmp(command, "index"))
+            goto out;
+    }
+
+    if (!strcmp(command, "import")) {
+        fp = stdin;
+        if (file && strcmp(file, "-")) {
+            fp = fopen(file, "r");
+            if (!fp) {
+                ogs_error("Cannot open [%s]: %s", file, strerror(errno));
+                rv = OGS_ERROR;
+                goto out;
+            }
+        }
+        rv = import(fp, optarg.num_of_worker);
+    } else {
+        fp = stdout;
+        if (file && strcmp(file, "-")) {
+            fp = fopen(file, "w");
+            if (!fp) {
+                ogs_error("Cannot open [%s]: %s", file, strerror(errno));
+                rv = OGS_ERROR;
+                goto out;
+            }
+        }
+        rv = export(fp, optarg.batch_size);
+    }
+
+    if (fp != stdin && fp != stdout)
+        fclose(fp);
+
+out:
+    ogs_dbi_final();
+    ogs_core_terminate();
+
+    return rv == OGS_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+}
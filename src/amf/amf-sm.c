@@ -55,6 +55,7 @@ void amf_state_operational(ogs_fsm_t *s, amf_event_t *e)
     uint16_t max_num_of_ostreams = 0;
 
     ogs_ngap_message_t ngap_message;
+    ogs_ngap_lazy_message_t ngap_lazy_message;
     ogs_pkbuf_t *pkbuf = NULL;
     int rc;
 
@@ -894,6 +895,42 @@ void amf_state_operational(ogs_fsm_t *s, amf_event_t *e)
         ogs_assert(gnb);
         ogs_assert(OGS_FSM_STATE(&gnb->sm));
 
+        amf_metrics_inst_by_gnb_sctp_update(gnb->metrics.inst,
+                &gnb->metrics.sctp, &gnb->sctp.stats);
+
+        if (e->ngap.message) {
+            /* Already decoded by an NGAP worker thread */
+            ogs_ngap_message_t *message = e->ngap.message;
+
+            e->gnb_id = gnb->id;
+            ogs_fsm_dispatch(&gnb->sm, e);
+
+            ogs_ngap_free(message);
+            ogs_free(message);
+            ogs_pkbuf_free(pkbuf);
+            break;
+        }
+
+        /*
+         * High-volume UE-associated messages are dispatched
+         * without decoding the whole NGAP-PDU.
+         */
+        rc = ogs_ngap_lazy_decode(&ngap_lazy_message, pkbuf);
+        if (rc == OGS_OK && gnb->state.ng_setup_success &&
+            ngap_lazy_message.h.present ==
+                NGAP_NGAP_PDU_PR_initiatingMessage &&
+            (ngap_lazy_message.h.procedureCode ==
+                NGAP_ProcedureCode_id_UplinkNASTransport ||
+             ngap_lazy_message.h.procedureCode ==
+                NGAP_ProcedureCode_id_UEContextReleaseRequest)) {
+            e->gnb_id = gnb->id;
+            e->ngap.lazy = &ngap_lazy_message;
+            ogs_fsm_dispatch(&gnb->sm, e);
+
+            ogs_pkbuf_free(pkbuf);
+            break;
+        }
+
         rc = ogs_ngap_decode(&ngap_message, pkbuf);
         if (rc == OGS_OK) {
             e->gnb_id = gnb->id;
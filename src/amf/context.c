@@ -60,9 +60,9 @@ void amf_context_init(void)
 
     /* Allocate TWICE the pool to check if maximum number of gNBs is reached */
     ogs_pool_init(&amf_gnb_pool, ogs_global_conf()->max.peer*2);
-    ogs_pool_init(&amf_ue_pool, ogs_global_conf()->max.ue);
-    ogs_pool_init(&ran_ue_pool, ogs_global_conf()->max.ue);
-    ogs_pool_init(&amf_sess_pool, ogs_app()->pool.sess);
+    ogs_pool_init_elastic(&amf_ue_pool, ogs_global_conf()->max.ue);
+    ogs_pool_init_elastic(&ran_ue_pool, ogs_global_conf()->max.ue);
+    ogs_pool_init_elastic(&amf_sess_pool, ogs_app()->pool.sess);
     /* Increase size of TMSI pool (#1827) */
     ogs_pool_init(&m_tmsi_pool, ogs_global_conf()->max.ue*2);
     ogs_pool_random_id_generate(&m_tmsi_pool);
@@ -84,6 +84,9 @@ void amf_context_init(void)
     self.supi_hash = ogs_hash_make();
     ogs_assert(self.supi_hash);
 
+    ogs_paging_index_init(&self.paging,
+            ogs_app()->timer_mgr, ngap_paging_flush);
+
     context_initialized = 1;
 }
 
@@ -106,6 +109,8 @@ void amf_context_final(void)
     ogs_assert(self.supi_hash);
     ogs_hash_destroy(self.supi_hash);
 
+    ogs_paging_index_final(&self.paging);
+
     ogs_pool_final(&m_tmsi_pool);
     ogs_pool_final(&amf_sess_pool);
     ogs_pool_final(&amf_ue_pool);
@@ -364,6 +369,9 @@ int amf_context_parse_config(void)
 
                             } while (ogs_yaml_iter_type(&server_array) ==
                                     YAML_SEQUENCE_NODE);
+                        } else if (!strcmp(ngap_key, "worker")) {
+                            const char *v = ogs_yaml_iter_value(&ngap_iter);
+                            if (v) self.ngap.num_of_worker = atoi(v);
                         } else
                             ogs_warn("unknown key `%s`", ngap_key);
                     }
@@ -1226,6 +1234,7 @@ amf_gnb_t *amf_gnb_add(ogs_sock_t *sock, ogs_sockaddr_t *addr)
     gnb->ostream_id = 0;
 
     ogs_list_init(&gnb->ran_ue_list);
+    ogs_list_init(&gnb->paging_list);
 
     ogs_hash_set(self.gnb_addr_hash,
             gnb->sctp.addr, sizeof(ogs_sockaddr_t), gnb);
@@ -1234,6 +1243,8 @@ amf_gnb_t *amf_gnb_add(ogs_sock_t *sock, ogs_sockaddr_t *addr)
     e.gnb_id = gnb->id;
     ogs_fsm_init(&gnb->sm, ngap_state_initial, ngap_state_final, &e);
 
+    amf_metrics_init_inst_by_gnb(gnb->metrics.inst, gnb->sctp.addr);
+
     ogs_list_add(&self.gnb_list, gnb);
     amf_metrics_inst_global_inc(AMF_METR_GLOB_GAUGE_GNB);
 
@@ -1251,6 +1262,7 @@ void amf_gnb_remove(amf_gnb_t *gnb)
     ogs_assert(gnb->sctp.sock);
 
     ogs_list_remove(&self.gnb_list, gnb);
+    ogs_paging_node_clear(&self.paging, &gnb->paging_list);
 
     memset(&e, 0, sizeof(e));
     e.gnb_id = gnb->id;
@@ -1263,6 +1275,8 @@ void amf_gnb_remove(amf_gnb_t *gnb)
 
     ogs_sctp_flush_and_destroy(&gnb->sctp);
 
+    amf_metrics_free_inst_by_gnb(gnb->metrics.inst);
+
     ogs_pool_id_free(&amf_gnb_pool, gnb);
     amf_metrics_inst_global_dec(AMF_METR_GLOB_GAUGE_GNB);
     ogs_info("[Removed] Number of gNBs is now %d",
@@ -1306,6 +1320,44 @@ int amf_gnb_set_gnb_id(amf_gnb_t *gnb, uint32_t gnb_id)
     return OGS_OK;
 }
 
+/* Called whenever the Supported TA List of the gNB has been rewritten */
+void amf_gnb_paging_update(amf_gnb_t *gnb)
+{
+    int i, j;
+
+    ogs_assert(gnb);
+
+    ogs_paging_node_clear(&self.paging, &gnb->paging_list);
+
+    for (i = 0; i < gnb->num_of_supported_ta_list; i++) {
+        for (j = 0; j < gnb->supported_ta_list[i].num_of_bplmn_list; j++) {
+            ogs_5gs_tai_t tai;
+
+            memset(&tai, 0, sizeof(tai));
+            memcpy(&tai.plmn_id,
+                    &gnb->supported_ta_list[i].bplmn_list[j].plmn_id,
+                    OGS_PLMN_ID_LEN);
+            tai.tac.v = gnb->supported_ta_list[i].tac.v;
+
+            ogs_paging_node_add(&self.paging,
+                    &gnb->paging_list, gnb, &tai, sizeof(tai));
+        }
+    }
+}
+
+ogs_paging_area_t *amf_paging_area_find(ogs_5gs_tai_t *tai)
+{
+    ogs_5gs_tai_t key;
+
+    ogs_assert(tai);
+
+    memset(&key, 0, sizeof(key));
+    memcpy(&key.plmn_id, &tai->plmn_id, OGS_PLMN_ID_LEN);
+    key.tac.v = tai->tac.v;
+
+    return ogs_paging_area_find(&self.paging, &key, sizeof(key));
+}
+
 int amf_gnb_sock_type(ogs_sock_t *sock)
 {
     ogs_socknode_t *snode = NULL;
@@ -1660,6 +1712,7 @@ void amf_ue_remove(amf_ue_t *amf_ue)
 
     /* Clear Paging Info */
     AMF_UE_CLEAR_PAGING_INFO(amf_ue);
+    ogs_paging_ue_dequeue(&amf_ue->paging_ue);
 
     /* Clear N2 Transfer */
     AMF_UE_CLEAR_N2_TRANSFER(amf_ue, pdu_session_resource_setup_request);
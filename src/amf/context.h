@@ -119,11 +119,17 @@ typedef struct amf_context_s {
     ogs_hash_t      *suci_hash;     /* hash table (SUCI) */
     ogs_hash_t      *supi_hash;     /* hash table (SUPI) */
 
+    ogs_paging_index_t paging;      /* 5GS-TAI : gNBs */
+
     uint16_t        ngap_port;      /* Default NGAP Port */
 
     ogs_list_t      ngap_list;      /* AMF NGAP IPv4 Server List */
     ogs_list_t      ngap_list6;     /* AMF NGAP IPv6 Server List */
 
+    struct {
+        int         num_of_worker;  /* NGAP Decoding Threads */
+    } ngap;
+
     struct {
         struct {
             ogs_time_t value;       /* Timer Value(Seconds) */
@@ -144,6 +150,11 @@ typedef struct amf_gnb_s {
     ogs_plmn_id_t   plmn_id;    /* gNB PLMN-ID received from gNB */
     ogs_sctp_sock_t sctp;       /* SCTP socket */
 
+    struct {
+        ogs_metrics_inst_t *inst[_AMF_METR_BY_GNB_MAX];
+        ogs_sctp_stats_t sctp;  /* SCTP stats last exported to metrics */
+    } metrics;
+
     struct {
         bool ng_setup_success;  /* gNB NGAP Setup complete successfuly */
     } state;
@@ -168,6 +179,8 @@ typedef struct amf_gnb_s {
 
     ogs_list_t      ran_ue_list;
 
+    ogs_list_t      paging_list;    /* ogs_paging_member_t */
+
 } amf_gnb_t;
 
 struct ran_ue_s {
@@ -265,6 +278,9 @@ struct amf_ue_s {
 
     } __attribute__ ((packed)) nas;
 
+    /* Start of the registration procedure (fivegs_amffunction_rm_regtime) */
+    ogs_time_t      registration_start;
+
     /* UE identity */
 #define AMF_UE_HAVE_SUCI(__aMF) \
     ((__aMF) && ((__aMF)->suci))
@@ -531,6 +547,9 @@ struct amf_ue_s {
         uint32_t        retry_count;;
     } t3513, t3522, t3550, t3555, t3560, t3570, mobile_reachable, implicit_deregistration;
 
+    /* Queued on a paging area until the end of the loop iteration */
+    ogs_paging_ue_t paging_ue;
+
     /* UE Radio Capability */
     OCTET_STRING_t  ueRadioCapability;
 
@@ -540,6 +559,9 @@ struct amf_ue_s {
         OCTET_STRING_t container;
         NGAP_Cause_PR group;
         long cause;
+
+        /* Start of the procedure (amf_handover_time) */
+        ogs_time_t start;
     } handover;
 
     /* SubscriptionId of Subscription to Data Change Notification to UDM */
@@ -851,6 +873,9 @@ void amf_gnb_remove_all(void);
 amf_gnb_t *amf_gnb_find_by_addr(ogs_sockaddr_t *addr);
 amf_gnb_t *amf_gnb_find_by_gnb_id(uint32_t gnb_id);
 int amf_gnb_set_gnb_id(amf_gnb_t *gnb, uint32_t gnb_id);
+
+void amf_gnb_paging_update(amf_gnb_t *gnb);
+ogs_paging_area_t *amf_paging_area_find(ogs_5gs_tai_t *tai);
 int amf_gnb_sock_type(ogs_sock_t *sock);
 amf_gnb_t *amf_gnb_find_by_id(ogs_pool_id_t id);
 
@@ -19,6 +19,7 @@
 
 #include "event.h"
 #include "context.h"
+#include "ngap-worker.h"
 
 amf_event_t *amf_event_new(int id)
 {
@@ -100,7 +101,10 @@ void amf_sctp_event_push(int id,
     e->ngap.max_num_of_istreams = max_num_of_istreams;
     e->ngap.max_num_of_ostreams = max_num_of_ostreams;
 
-    rv = ogs_queue_push(ogs_app()->queue, e);
+    if (ngap_worker_enabled())
+        rv = ngap_worker_push(e);
+    else
+        rv = ogs_queue_push(ogs_app()->queue, e);
     if (rv != OGS_OK) {
         ogs_error("ogs_queue_push() failed:%d", (int)rv);
         ogs_free(e->ngap.addr);
@@ -108,9 +112,4 @@ void amf_sctp_event_push(int id,
             ogs_pkbuf_free(e->pkbuf);
         ogs_event_free(e);
     }
-#if HAVE_USRSCTP
-    else {
-        ogs_pollset_notify(ogs_app()->pollset);
-    }
-#endif
 }
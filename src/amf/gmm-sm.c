@@ -1222,6 +1222,7 @@ static void common_register_state(ogs_fsm_t *s, amf_event_t *e,
         switch (nas_message->gmm.h.message_type) {
         case OGS_NAS_5GS_REGISTRATION_REQUEST:
             ogs_info("Registration request");
+            amf_ue->registration_start = ogs_get_monotonic_time();
             gmm_cause = gmm_handle_registration_request(
                     amf_ue, h, e->ngap.code,
                     &nas_message->gmm.registration_request);
@@ -2486,6 +2487,12 @@ void gmm_state_initial_context_setup(ogs_fsm_t *s, amf_event_t *e)
                 ogs_error("Unknown reg_type[%d]",
                         amf_ue->nas.registration.value);
             }
+            if (amf_ue->registration_start) {
+                amf_metrics_inst_global_add(AMF_METR_GLOB_HIST_REG_TIME,
+                        ogs_time_to_msec(ogs_get_monotonic_time() -
+                            amf_ue->registration_start));
+                amf_ue->registration_start = 0;
+            }
             OGS_FSM_TRAN(s, &gmm_state_registered);
             break;
 
@@ -2703,6 +2710,7 @@ void gmm_state_exception(ogs_fsm_t *s, amf_event_t *e)
         switch (nas_message->gmm.h.message_type) {
         case OGS_NAS_5GS_REGISTRATION_REQUEST:
             ogs_info("Registration request");
+            amf_ue->registration_start = ogs_get_monotonic_time();
             gmm_cause = gmm_handle_registration_request(
                     amf_ue, h, e->ngap.code,
                     &nas_message->gmm.registration_request);
@@ -19,6 +19,7 @@
 
 #include "sbi-path.h"
 #include "ngap-path.h"
+#include "ngap-worker.h"
 #include "metrics.h"
 
 static ogs_thread_t *thread;
@@ -48,6 +49,9 @@ int amf_initialize(void)
     rv = ogs_metrics_context_parse_config(APP_NAME);
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_app_reload_add("metrics", ogs_metrics_context_reload_config);
+    if (rv != OGS_OK) return rv;
+
     rv = amf_context_parse_config();
     if (rv != OGS_OK) return rv;
 
@@ -59,6 +63,9 @@ int amf_initialize(void)
     rv = amf_sbi_open();
     if (rv != OGS_OK) return rv;
 
+    rv = ngap_worker_open(amf_self()->ngap.num_of_worker);
+    if (rv != OGS_OK) return rv;
+
     rv = ngap_open();
     if (rv != OGS_OK) return rv;
 
@@ -101,6 +108,7 @@ void amf_terminate(void)
     ogs_timer_delete(t_termination_holding);
 
     ngap_close();
+    ngap_worker_close();
     amf_sbi_close();
 
     ogs_metrics_context_close(ogs_metrics_self());
@@ -111,11 +119,18 @@ void amf_terminate(void)
     amf_metrics_final();
 }
 
+static const char *amf_prof_event_name(void *event)
+{
+    return amf_event_get_name(event);
+}
+
 static void amf_main(void *data)
 {
     ogs_fsm_t amf_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            amf_prof_event_name);
     ogs_fsm_init(&amf_sm, amf_state_initial, amf_state_final, 0);
 
     for ( ;; ) {
@@ -135,10 +150,14 @@ static void amf_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            amf_event_t *e = NULL;
+            amf_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -147,9 +166,11 @@ static void amf_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&amf_sm, e);
-            ogs_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&amf_sm, e[i]);
+                ogs_event_free(e[i]);
+            }
         }
     }
 done:
@@ -150,6 +150,17 @@ amf_metrics_spec_def_t amf_metrics_spec_def_global[_AMF_METR_GLOB_MAX] = {
         .exp.factor = 2,
     },
 },
+[AMF_METR_GLOB_HIST_HANDOVER_TIME] = {
+    .type = OGS_METRICS_METRIC_TYPE_HISTOGRAM,
+    .name = "amf_handover_time",
+    .description = "Time of N2 handover procedure",
+    .histogram_params = {
+        .type = OGS_METRICS_HISTOGRAM_BUCKET_TYPE_EXPONENTIAL,
+        .count = 8,
+        .exp.start = 10,
+        .exp.factor = 2,
+    },
+},
 };
 int amf_metrics_init_inst_global(void)
 {
@@ -348,6 +359,168 @@ int amf_metrics_free_inst_by_cause(ogs_metrics_inst_t **inst)
     return amf_metrics_free_inst(inst, _AMF_METR_BY_CAUSE_MAX);
 }
 
+/* BY GNB */
+const char *labels_gnb[] = {
+    "addr"
+};
+
+#define AMF_METR_BY_GNB_ENTRY(_id, _type, _name, _desc) \
+    [_id] = { \
+        .type = _type, \
+        .name = _name, \
+        .description = _desc, \
+        .num_labels = OGS_ARRAY_SIZE(labels_gnb), \
+        .labels = labels_gnb, \
+    },
+ogs_metrics_spec_t *amf_metrics_spec_by_gnb[_AMF_METR_BY_GNB_MAX];
+amf_metrics_spec_def_t amf_metrics_spec_def_by_gnb[_AMF_METR_BY_GNB_MAX] = {
+/* Gauges: */
+AMF_METR_BY_GNB_ENTRY(
+    AMF_METR_GAUGE_NGAP_SCTP_TX_QUEUE,
+    OGS_METRICS_METRIC_TYPE_GAUGE,
+    "ngap_sctp_tx_queue",
+    "NGAP messages waiting in the SCTP send queue")
+AMF_METR_BY_GNB_ENTRY(
+    AMF_METR_GAUGE_NGAP_SCTP_TX_QUEUE_MAX,
+    OGS_METRICS_METRIC_TYPE_GAUGE,
+    "ngap_sctp_tx_queue_max",
+    "High-water mark of the SCTP send queue")
+/* Counters: */
+AMF_METR_BY_GNB_ENTRY(
+    AMF_METR_CTR_NGAP_SCTP_TX_SENT,
+    OGS_METRICS_METRIC_TYPE_COUNTER,
+    "ngap_sctp_tx_sent",
+    "NGAP messages written to the SCTP association")
+AMF_METR_BY_GNB_ENTRY(
+    AMF_METR_CTR_NGAP_SCTP_TX_EAGAIN,
+    OGS_METRICS_METRIC_TYPE_COUNTER,
+    "ngap_sctp_tx_eagain",
+    "SCTP send queue flushes deferred by EAGAIN")
+AMF_METR_BY_GNB_ENTRY(
+    AMF_METR_CTR_NGAP_SCTP_TX_DROPPED,
+    OGS_METRICS_METRIC_TYPE_COUNTER,
+    "ngap_sctp_tx_dropped",
+    "NGAP messages dropped on SCTP send error")
+};
+
+void amf_metrics_init_inst_by_gnb(
+        ogs_metrics_inst_t **inst, ogs_sockaddr_t *addr)
+{
+    char buf[OGS_ADDRSTRLEN];
+    char addr_str[OGS_ADDRSTRLEN+8];
+
+    ogs_assert(inst);
+    ogs_assert(addr);
+
+    ogs_snprintf(addr_str, sizeof(addr_str), "[%s]:%d",
+            OGS_ADDR(addr, buf), OGS_PORT(addr));
+
+    amf_metrics_init_inst(inst, amf_metrics_spec_by_gnb,
+            _AMF_METR_BY_GNB_MAX, OGS_ARRAY_SIZE(labels_gnb),
+            (const char *[]){ addr_str });
+}
+
+void amf_metrics_free_inst_by_gnb(ogs_metrics_inst_t **inst)
+{
+    amf_metrics_free_inst(inst, _AMF_METR_BY_GNB_MAX);
+}
+
+/*
+ * The SCTP layer only keeps raw counters; they are pushed to the
+ * metrics instances here, and only when something has changed.
+ */
+void amf_metrics_inst_by_gnb_sctp_update(ogs_metrics_inst_t **inst,
+        ogs_sctp_stats_t *exported, const ogs_sctp_stats_t *stats)
+{
+    ogs_assert(inst);
+    ogs_assert(exported);
+    ogs_assert(stats);
+
+    if (memcmp(exported, stats, sizeof(*stats)) == 0)
+        return;
+
+    ogs_metrics_inst_set(inst[AMF_METR_GAUGE_NGAP_SCTP_TX_QUEUE],
+            stats->queued);
+    ogs_metrics_inst_set(inst[AMF_METR_GAUGE_NGAP_SCTP_TX_QUEUE_MAX],
+            stats->max_queued);
+    ogs_metrics_inst_add(inst[AMF_METR_CTR_NGAP_SCTP_TX_SENT],
+            (int)(stats->sent - exported->sent));
+    ogs_metrics_inst_add(inst[AMF_METR_CTR_NGAP_SCTP_TX_EAGAIN],
+            (int)(stats->eagain - exported->eagain));
+    ogs_metrics_inst_add(inst[AMF_METR_CTR_NGAP_SCTP_TX_DROPPED],
+            (int)(stats->dropped - exported->dropped));
+
+    memcpy(exported, stats, sizeof(*stats));
+}
+
+static ogs_metrics_peer_t *amf_metrics_sbi_peer(ogs_sbi_client_t *client)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_assert(client);
+
+    if (!client->metrics) {
+        if (client->fqdn)
+            client->metrics = ogs_metrics_peer_find_or_add(client->fqdn);
+        else if (client->addr)
+            client->metrics = ogs_metrics_peer_find_or_add(
+                    OGS_ADDR(client->addr, buf));
+        else if (client->addr6)
+            client->metrics = ogs_metrics_peer_find_or_add(
+                    OGS_ADDR(client->addr6, buf));
+    }
+
+    return client->metrics;
+}
+
+static uint32_t amf_metrics_sbi_method_id(const char *method)
+{
+    static const char *methods[] = {
+        OGS_SBI_HTTP_METHOD_DELETE,
+        OGS_SBI_HTTP_METHOD_GET,
+        OGS_SBI_HTTP_METHOD_PATCH,
+        OGS_SBI_HTTP_METHOD_POST,
+        OGS_SBI_HTTP_METHOD_PUT,
+        OGS_SBI_HTTP_METHOD_OPTIONS,
+    };
+    uint32_t i;
+
+    for (i = 0; i < OGS_ARRAY_SIZE(methods); i++)
+        if (strcmp(method, methods[i]) == 0)
+            return i + 1;
+
+    return 0;
+}
+
+static void amf_metrics_sbi_client_rtt(ogs_sbi_client_t *client,
+        const char *service, const char *method, ogs_time_t rtt)
+{
+    ogs_metrics_peer_t *peer = NULL;
+    ogs_metrics_inst_t *inst = NULL;
+    uint32_t id;
+
+    ogs_assert(client);
+    ogs_assert(method);
+
+    peer = amf_metrics_sbi_peer(client);
+    if (!peer)
+        return;
+
+    id = amf_metrics_sbi_method_id(method);
+    inst = ogs_metrics_peer_hist_find(peer,
+            OGS_METRICS_PEER_HIST_SBI_CLIENT_TIME, id, service);
+    if (!inst) {
+        char procedure[64];
+
+        ogs_snprintf(procedure, sizeof(procedure), "%s %s",
+                method, service ? service : "unknown");
+        inst = ogs_metrics_peer_hist_add(peer,
+                OGS_METRICS_PEER_HIST_SBI_CLIENT_TIME, id, service, procedure);
+    }
+    if (inst)
+        ogs_metrics_inst_add(inst, ogs_time_to_msec(rtt));
+}
+
 void amf_metrics_init(void)
 {
     ogs_metrics_context_t *ctx = ogs_metrics_self();
@@ -361,16 +534,24 @@ void amf_metrics_init(void)
     amf_metrics_init_spec(ctx, amf_metrics_spec_by_cause,
             amf_metrics_spec_def_by_cause, _AMF_METR_BY_CAUSE_MAX);
 
+    amf_metrics_init_spec(ctx, amf_metrics_spec_by_gnb,
+            amf_metrics_spec_def_by_gnb, _AMF_METR_BY_GNB_MAX);
+
     amf_metrics_init_inst_global();
 
     amf_metrics_init_by_slice();
     amf_metrics_init_by_cause();
+
+    ogs_metrics_peer_hist_init(OGS_METRICS_PEER_HIST_SBI_CLIENT_TIME);
+    ogs_sbi_client_set_rtt_cb(amf_metrics_sbi_client_rtt);
 }
 
 void amf_metrics_final(void)
 {
     ogs_hash_index_t *hi;
 
+    ogs_sbi_client_set_rtt_cb(NULL);
+
     if (metrics_hash_by_slice) {
         for (hi = ogs_hash_first(metrics_hash_by_slice); hi; hi = ogs_hash_next(hi)) {
             amf_metric_key_by_slice_t *key =
@@ -2,6 +2,7 @@
 #define AMF_METRICS_H
 
 #include "ogs-metrics.h"
+#include "ogs-sctp.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,6 +27,7 @@ typedef enum amf_metric_type_global_s {
     AMF_METR_GLOB_CTR_MM_CONF_UPDATE,
     AMF_METR_GLOB_CTR_MM_CONF_UPDATE_SUCC,
     AMF_METR_GLOB_HIST_REG_TIME,
+    AMF_METR_GLOB_HIST_HANDOVER_TIME,
     _AMF_METR_GLOB_MAX,
 } amf_metric_type_global_t;
 extern ogs_metrics_inst_t *amf_metrics_inst_global[_AMF_METR_GLOB_MAX];
@@ -65,6 +67,22 @@ typedef enum amf_metric_type_by_cause_s {
 void amf_metrics_inst_by_cause_add(
     uint8_t cause, amf_metric_type_by_cause_t t, int val);
 
+/* BY GNB */
+typedef enum amf_metric_type_by_gnb_s {
+    AMF_METR_GAUGE_NGAP_SCTP_TX_QUEUE = 0,
+    AMF_METR_GAUGE_NGAP_SCTP_TX_QUEUE_MAX,
+    AMF_METR_CTR_NGAP_SCTP_TX_SENT,
+    AMF_METR_CTR_NGAP_SCTP_TX_EAGAIN,
+    AMF_METR_CTR_NGAP_SCTP_TX_DROPPED,
+    _AMF_METR_BY_GNB_MAX,
+} amf_metric_type_by_gnb_t;
+
+void amf_metrics_init_inst_by_gnb(
+        ogs_metrics_inst_t **inst, ogs_sockaddr_t *addr);
+void amf_metrics_free_inst_by_gnb(ogs_metrics_inst_t **inst);
+void amf_metrics_inst_by_gnb_sctp_update(ogs_metrics_inst_t **inst,
+        ogs_sctp_stats_t *exported, const ogs_sctp_stats_t *stats);
+
 void amf_metrics_init(void);
 void amf_metrics_final(void);
 
@@ -342,6 +342,8 @@ void ngap_handle_ng_setup_request(amf_gnb_t *gnb, ogs_ngap_message_t *message)
         gnb->num_of_supported_ta_list++;
     }
 
+    amf_gnb_paging_update(gnb);
+
     if (maximum_number_of_gnbs_is_reached()) {
         ogs_warn("NG-Setup failure:");
         ogs_warn("    Maximum number of gNBs reached");
@@ -610,87 +612,31 @@ void ngap_handle_initial_ue_message(amf_gnb_t *gnb, ogs_ngap_message_t *message)
                 ran_ue, NGAP_ProcedureCode_id_InitialUEMessage, NAS_PDU));
 }
 
-void ngap_handle_uplink_nas_transport(
-        amf_gnb_t *gnb, ogs_ngap_message_t *message)
+static void handle_uplink_nas_transport(amf_gnb_t *gnb,
+        uint64_t *ran_ue_ngap_id, uint64_t amf_ue_ngap_id,
+        NGAP_NAS_PDU_t *NAS_PDU,
+        NGAP_UserLocationInformation_t *UserLocationInformation)
 {
     char buf[OGS_ADDRSTRLEN];
-    int i, r;
+    int r;
 
     amf_ue_t *amf_ue = NULL;
     ran_ue_t *ran_ue = NULL;
-    uint64_t amf_ue_ngap_id;
 
-    NGAP_InitiatingMessage_t *initiatingMessage = NULL;
-    NGAP_UplinkNASTransport_t *UplinkNASTransport = NULL;
-
-    NGAP_UplinkNASTransport_IEs_t *ie = NULL;
-    NGAP_RAN_UE_NGAP_ID_t *RAN_UE_NGAP_ID = NULL;
-    NGAP_AMF_UE_NGAP_ID_t *AMF_UE_NGAP_ID = NULL;
-    NGAP_NAS_PDU_t *NAS_PDU = NULL;
-    NGAP_UserLocationInformation_t *UserLocationInformation = NULL;
     NGAP_UserLocationInformationNR_t *UserLocationInformationNR = NULL;
 
     ogs_5gs_tai_t nr_tai;
     int served_tai_index = 0;
 
-    ogs_assert(gnb);
-    ogs_assert(gnb->sctp.sock);
-
-    ogs_assert(message);
-    initiatingMessage = message->choice.initiatingMessage;
-    ogs_assert(initiatingMessage);
-    UplinkNASTransport = &initiatingMessage->value.choice.UplinkNASTransport;
-    ogs_assert(UplinkNASTransport);
-
-    ogs_debug("UplinkNASTransport");
-
-    for (i = 0; i < UplinkNASTransport->protocolIEs.list.count; i++) {
-        ie = UplinkNASTransport->protocolIEs.list.array[i];
-        switch (ie->id) {
-        case NGAP_ProtocolIE_ID_id_RAN_UE_NGAP_ID:
-            RAN_UE_NGAP_ID = &ie->value.choice.RAN_UE_NGAP_ID;
-            break;
-        case NGAP_ProtocolIE_ID_id_AMF_UE_NGAP_ID:
-            AMF_UE_NGAP_ID = &ie->value.choice.AMF_UE_NGAP_ID;
-            break;
-        case NGAP_ProtocolIE_ID_id_NAS_PDU:
-            NAS_PDU = &ie->value.choice.NAS_PDU;
-            break;
-        case NGAP_ProtocolIE_ID_id_UserLocationInformation:
-            UserLocationInformation = &ie->value.choice.UserLocationInformation;
-            break;
-        default:
-            break;
-        }
-    }
-
     ogs_debug("    IP[%s] RAN_ID[%d]",
             OGS_ADDR(gnb->sctp.addr, buf), gnb->gnb_id);
 
-    if (!AMF_UE_NGAP_ID) {
-        ogs_error("No AMF_UE_NGAP_ID");
-        r = ngap_send_error_indication(gnb, (uint64_t *)RAN_UE_NGAP_ID, NULL,
-                NGAP_Cause_PR_protocol, NGAP_CauseProtocol_semantic_error);
-        ogs_expect(r == OGS_OK);
-        ogs_assert(r != OGS_ERROR);
-        return;
-    }
-
-    if (asn_INTEGER2uint64(AMF_UE_NGAP_ID, &amf_ue_ngap_id) != 0) {
-        ogs_error("Invalid AMF_UE_NGAP_ID");
-        r = ngap_send_error_indication(gnb, (uint64_t *)RAN_UE_NGAP_ID, NULL,
-                NGAP_Cause_PR_protocol, NGAP_CauseProtocol_semantic_error);
-        ogs_expect(r == OGS_OK);
-        ogs_assert(r != OGS_ERROR);
-        return;
-    }
-
     ran_ue = ran_ue_find_by_amf_ue_ngap_id(amf_ue_ngap_id);
     if (!ran_ue) {
         ogs_error("No RAN UE Context : AMF_UE_NGAP_ID[%lld]",
                 (long long)amf_ue_ngap_id);
         r = ngap_send_error_indication(
-                gnb, (uint64_t *)RAN_UE_NGAP_ID, &amf_ue_ngap_id,
+                gnb, ran_ue_ngap_id, &amf_ue_ngap_id,
                 NGAP_Cause_PR_radioNetwork,
                 NGAP_CauseRadioNetwork_unknown_local_UE_NGAP_ID);
         ogs_expect(r == OGS_OK);
@@ -778,6 +724,126 @@ void ngap_handle_uplink_nas_transport(
                 ran_ue, NGAP_ProcedureCode_id_UplinkNASTransport, NAS_PDU));
 }
 
+void ngap_handle_uplink_nas_transport(
+        amf_gnb_t *gnb, ogs_ngap_message_t *message)
+{
+    int i, r;
+
+    uint64_t amf_ue_ngap_id;
+
+    NGAP_InitiatingMessage_t *initiatingMessage = NULL;
+    NGAP_UplinkNASTransport_t *UplinkNASTransport = NULL;
+
+    NGAP_UplinkNASTransport_IEs_t *ie = NULL;
+    NGAP_RAN_UE_NGAP_ID_t *RAN_UE_NGAP_ID = NULL;
+    NGAP_AMF_UE_NGAP_ID_t *AMF_UE_NGAP_ID = NULL;
+    NGAP_NAS_PDU_t *NAS_PDU = NULL;
+    NGAP_UserLocationInformation_t *UserLocationInformation = NULL;
+
+    ogs_assert(gnb);
+    ogs_assert(gnb->sctp.sock);
+
+    ogs_assert(message);
+    initiatingMessage = message->choice.initiatingMessage;
+    ogs_assert(initiatingMessage);
+    UplinkNASTransport = &initiatingMessage->value.choice.UplinkNASTransport;
+    ogs_assert(UplinkNASTransport);
+
+    ogs_debug("UplinkNASTransport");
+
+    for (i = 0; i < UplinkNASTransport->protocolIEs.list.count; i++) {
+        ie = UplinkNASTransport->protocolIEs.list.array[i];
+        switch (ie->id) {
+        case NGAP_ProtocolIE_ID_id_RAN_UE_NGAP_ID:
+            RAN_UE_NGAP_ID = &ie->value.choice.RAN_UE_NGAP_ID;
+            break;
+        case NGAP_ProtocolIE_ID_id_AMF_UE_NGAP_ID:
+            AMF_UE_NGAP_ID = &ie->value.choice.AMF_UE_NGAP_ID;
+            break;
+        case NGAP_ProtocolIE_ID_id_NAS_PDU:
+            NAS_PDU = &ie->value.choice.NAS_PDU;
+            break;
+        case NGAP_ProtocolIE_ID_id_UserLocationInformation:
+            UserLocationInformation = &ie->value.choice.UserLocationInformation;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (!AMF_UE_NGAP_ID) {
+        ogs_error("No AMF_UE_NGAP_ID");
+        r = ngap_send_error_indication(gnb, (uint64_t *)RAN_UE_NGAP_ID, NULL,
+                NGAP_Cause_PR_protocol, NGAP_CauseProtocol_semantic_error);
+        ogs_expect(r == OGS_OK);
+        ogs_assert(r != OGS_ERROR);
+        return;
+    }
+
+    if (asn_INTEGER2uint64(AMF_UE_NGAP_ID, &amf_ue_ngap_id) != 0) {
+        ogs_error("Invalid AMF_UE_NGAP_ID");
+        r = ngap_send_error_indication(gnb, (uint64_t *)RAN_UE_NGAP_ID, NULL,
+                NGAP_Cause_PR_protocol, NGAP_CauseProtocol_semantic_error);
+        ogs_expect(r == OGS_OK);
+        ogs_assert(r != OGS_ERROR);
+        return;
+    }
+
+    handle_uplink_nas_transport(gnb, (uint64_t *)RAN_UE_NGAP_ID,
+            amf_ue_ngap_id, NAS_PDU, UserLocationInformation);
+}
+
+void ngap_handle_uplink_nas_transport_lazy(
+        amf_gnb_t *gnb, ogs_ngap_lazy_message_t *message)
+{
+    int r;
+
+    ogs_asn_ie_view_t *ie = NULL;
+    uint64_t *ran_ue_ngap_id = NULL;
+
+    NGAP_NAS_PDU_t NAS_PDU, *nas_pdu = NULL;
+    NGAP_UserLocationInformation_t UserLocationInformation;
+    NGAP_UserLocationInformation_t *user_location_information = NULL;
+
+    ogs_assert(gnb);
+    ogs_assert(gnb->sctp.sock);
+
+    ogs_assert(message);
+
+    ogs_debug("UplinkNASTransport");
+
+    if (message->ran_ue_ngap_id_presence)
+        ran_ue_ngap_id = &message->ran_ue_ngap_id;
+
+    if (!message->amf_ue_ngap_id_presence) {
+        ogs_error("No AMF_UE_NGAP_ID");
+        r = ngap_send_error_indication(gnb, ran_ue_ngap_id, NULL,
+                NGAP_Cause_PR_protocol, NGAP_CauseProtocol_semantic_error);
+        ogs_expect(r == OGS_OK);
+        ogs_assert(r != OGS_ERROR);
+        return;
+    }
+
+    /* NAS-PDU is not copied : it points into the received SCTP buffer */
+    ie = ogs_ngap_lazy_find_ie(message, NGAP_ProtocolIE_ID_id_NAS_PDU);
+    if (ie && ogs_asn_lazy_get_OCTET_STRING(ie, &NAS_PDU) == OGS_OK)
+        nas_pdu = &NAS_PDU;
+
+    if (ogs_ngap_lazy_decode_ie(message,
+                NGAP_ProtocolIE_ID_id_UserLocationInformation,
+                &asn_DEF_NGAP_UserLocationInformation,
+                &UserLocationInformation,
+                sizeof(UserLocationInformation)) == OGS_OK)
+        user_location_information = &UserLocationInformation;
+
+    handle_uplink_nas_transport(gnb, ran_ue_ngap_id,
+            message->amf_ue_ngap_id, nas_pdu, user_location_information);
+
+    if (user_location_information)
+        ogs_asn_free(&asn_DEF_NGAP_UserLocationInformation,
+                user_location_information);
+}
+
 void ngap_handle_ue_radio_capability_info_indication(
         amf_gnb_t *gnb, ogs_ngap_message_t *message)
 {
@@ -1454,86 +1520,29 @@ void ngap_handle_ue_context_modification_failure(
 }
 
 
-void ngap_handle_ue_context_release_request(
-        amf_gnb_t *gnb, ogs_ngap_message_t *message)
+static void handle_ue_context_release_request(amf_gnb_t *gnb,
+        uint64_t *ran_ue_ngap_id, uint64_t amf_ue_ngap_id,
+        NGAP_PDUSessionResourceListCxtRelReq_t *PDUSessionList,
+        NGAP_Cause_t *Cause)
 {
     int i, r;
     char buf[OGS_ADDRSTRLEN];
-    uint64_t amf_ue_ngap_id;
 
     ran_ue_t *ran_ue = NULL;
     amf_ue_t *amf_ue = NULL;
     amf_sess_t *sess = NULL;
 
-    NGAP_InitiatingMessage_t *initiatingMessage = NULL;
-    NGAP_UEContextReleaseRequest_t *UEContextReleaseRequest = NULL;
-
-    NGAP_UEContextReleaseRequest_IEs_t *ie = NULL;
-    NGAP_RAN_UE_NGAP_ID_t *RAN_UE_NGAP_ID = NULL;
-    NGAP_AMF_UE_NGAP_ID_t *AMF_UE_NGAP_ID = NULL;
-    NGAP_PDUSessionResourceListCxtRelReq_t *PDUSessionList = NULL;
     NGAP_PDUSessionResourceItemCxtRelReq_t *PDUSessionItem = NULL;
-    NGAP_Cause_t *Cause = NULL;
-
-    ogs_assert(gnb);
-    ogs_assert(gnb->sctp.sock);
-
-    ogs_assert(message);
-    initiatingMessage = message->choice.initiatingMessage;
-    ogs_assert(initiatingMessage);
-    UEContextReleaseRequest =
-        &initiatingMessage->value.choice.UEContextReleaseRequest;
-    ogs_assert(UEContextReleaseRequest);
-
-    ogs_debug("UEContextReleaseRequest");
-
-    for (i = 0; i < UEContextReleaseRequest->protocolIEs.list.count; i++) {
-        ie = UEContextReleaseRequest->protocolIEs.list.array[i];
-        switch (ie->id) {
-        case NGAP_ProtocolIE_ID_id_RAN_UE_NGAP_ID:
-            RAN_UE_NGAP_ID = &ie->value.choice.RAN_UE_NGAP_ID;
-            break;
-        case NGAP_ProtocolIE_ID_id_AMF_UE_NGAP_ID:
-            AMF_UE_NGAP_ID = &ie->value.choice.AMF_UE_NGAP_ID;
-            break;
-        case NGAP_ProtocolIE_ID_id_PDUSessionResourceListCxtRelReq:
-            PDUSessionList = &ie->value.choice.PDUSessionResourceListCxtRelReq;
-            break;
-        case NGAP_ProtocolIE_ID_id_Cause:
-            Cause = &ie->value.choice.Cause;
-            break;
-        default:
-            break;
-        }
-    }
 
     ogs_debug("    IP[%s] RAN_ID[%d]",
             OGS_ADDR(gnb->sctp.addr, buf), gnb->gnb_id);
 
-    if (!AMF_UE_NGAP_ID) {
-        ogs_error("No AMF_UE_NGAP_ID");
-        r = ngap_send_error_indication(gnb, (uint64_t *)RAN_UE_NGAP_ID, NULL,
-                NGAP_Cause_PR_protocol, NGAP_CauseProtocol_semantic_error);
-        ogs_expect(r == OGS_OK);
-        ogs_assert(r != OGS_ERROR);
-        return;
-    }
-
-    if (asn_INTEGER2uint64(AMF_UE_NGAP_ID, &amf_ue_ngap_id) != 0) {
-        ogs_error("Invalid AMF_UE_NGAP_ID");
-        r = ngap_send_error_indication(gnb, (uint64_t *)RAN_UE_NGAP_ID, NULL,
-                NGAP_Cause_PR_protocol, NGAP_CauseProtocol_semantic_error);
-        ogs_expect(r == OGS_OK);
-        ogs_assert(r != OGS_ERROR);
-        return;
-    }
-
     ran_ue = ran_ue_find_by_amf_ue_ngap_id(amf_ue_ngap_id);
     if (!ran_ue) {
         ogs_warn("No RAN UE Context : AMF_UE_NGAP_ID[%lld]",
                 (long long)amf_ue_ngap_id);
         r = ngap_send_error_indication(
-                gnb, (uint64_t *)RAN_UE_NGAP_ID, &amf_ue_ngap_id,
+                gnb, ran_ue_ngap_id, &amf_ue_ngap_id,
                 NGAP_Cause_PR_radioNetwork,
                 NGAP_CauseRadioNetwork_unknown_local_UE_NGAP_ID);
         ogs_expect(r == OGS_OK);
@@ -1642,6 +1651,126 @@ void ngap_handle_ue_context_release_request(
     }
 }
 
+void ngap_handle_ue_context_release_request(
+        amf_gnb_t *gnb, ogs_ngap_message_t *message)
+{
+    int i, r;
+    uint64_t amf_ue_ngap_id;
+
+    NGAP_InitiatingMessage_t *initiatingMessage = NULL;
+    NGAP_UEContextReleaseRequest_t *UEContextReleaseRequest = NULL;
+
+    NGAP_UEContextReleaseRequest_IEs_t *ie = NULL;
+    NGAP_RAN_UE_NGAP_ID_t *RAN_UE_NGAP_ID = NULL;
+    NGAP_AMF_UE_NGAP_ID_t *AMF_UE_NGAP_ID = NULL;
+    NGAP_PDUSessionResourceListCxtRelReq_t *PDUSessionList = NULL;
+    NGAP_Cause_t *Cause = NULL;
+
+    ogs_assert(gnb);
+    ogs_assert(gnb->sctp.sock);
+
+    ogs_assert(message);
+    initiatingMessage = message->choice.initiatingMessage;
+    ogs_assert(initiatingMessage);
+    UEContextReleaseRequest =
+        &initiatingMessage->value.choice.UEContextReleaseRequest;
+    ogs_assert(UEContextReleaseRequest);
+
+    ogs_debug("UEContextReleaseRequest");
+
+    for (i = 0; i < UEContextReleaseRequest->protocolIEs.list.count; i++) {
+        ie = UEContextReleaseRequest->protocolIEs.list.array[i];
+        switch (ie->id) {
+        case NGAP_ProtocolIE_ID_id_RAN_UE_NGAP_ID:
+            RAN_UE_NGAP_ID = &ie->value.choice.RAN_UE_NGAP_ID;
+            break;
+        case NGAP_ProtocolIE_ID_id_AMF_UE_NGAP_ID:
+            AMF_UE_NGAP_ID = &ie->value.choice.AMF_UE_NGAP_ID;
+            break;
+        case NGAP_ProtocolIE_ID_id_PDUSessionResourceListCxtRelReq:
+            PDUSessionList = &ie->value.choice.PDUSessionResourceListCxtRelReq;
+            break;
+        case NGAP_ProtocolIE_ID_id_Cause:
+            Cause = &ie->value.choice.Cause;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (!AMF_UE_NGAP_ID) {
+        ogs_error("No AMF_UE_NGAP_ID");
+        r = ngap_send_error_indication(gnb, (uint64_t *)RAN_UE_NGAP_ID, NULL,
+                NGAP_Cause_PR_protocol, NGAP_CauseProtocol_semantic_error);
+        ogs_expect(r == OGS_OK);
+        ogs_assert(r != OGS_ERROR);
+        return;
+    }
+
+    if (asn_INTEGER2uint64(AMF_UE_NGAP_ID, &amf_ue_ngap_id) != 0) {
+        ogs_error("Invalid AMF_UE_NGAP_ID");
+        r = ngap_send_error_indication(gnb, (uint64_t *)RAN_UE_NGAP_ID, NULL,
+                NGAP_Cause_PR_protocol, NGAP_CauseProtocol_semantic_error);
+        ogs_expect(r == OGS_OK);
+        ogs_assert(r != OGS_ERROR);
+        return;
+    }
+
+    handle_ue_context_release_request(gnb, (uint64_t *)RAN_UE_NGAP_ID,
+            amf_ue_ngap_id, PDUSessionList, Cause);
+}
+
+void ngap_handle_ue_context_release_request_lazy(
+        amf_gnb_t *gnb, ogs_ngap_lazy_message_t *message)
+{
+    int r;
+
+    uint64_t *ran_ue_ngap_id = NULL;
+
+    NGAP_PDUSessionResourceListCxtRelReq_t PDUSessionList;
+    NGAP_PDUSessionResourceListCxtRelReq_t *pdu_session_list = NULL;
+    NGAP_Cause_t Cause, *cause = NULL;
+
+    ogs_assert(gnb);
+    ogs_assert(gnb->sctp.sock);
+
+    ogs_assert(message);
+
+    ogs_debug("UEContextReleaseRequest");
+
+    if (message->ran_ue_ngap_id_presence)
+        ran_ue_ngap_id = &message->ran_ue_ngap_id;
+
+    if (!message->amf_ue_ngap_id_presence) {
+        ogs_error("No AMF_UE_NGAP_ID");
+        r = ngap_send_error_indication(gnb, ran_ue_ngap_id, NULL,
+                NGAP_Cause_PR_protocol, NGAP_CauseProtocol_semantic_error);
+        ogs_expect(r == OGS_OK);
+        ogs_assert(r != OGS_ERROR);
+        return;
+    }
+
+    if (ogs_ngap_lazy_decode_ie(message,
+                NGAP_ProtocolIE_ID_id_Cause,
+                &asn_DEF_NGAP_Cause, &Cause, sizeof(Cause)) == OGS_OK)
+        cause = &Cause;
+
+    if (ogs_ngap_lazy_decode_ie(message,
+                NGAP_ProtocolIE_ID_id_PDUSessionResourceListCxtRelReq,
+                &asn_DEF_NGAP_PDUSessionResourceListCxtRelReq,
+                &PDUSessionList, sizeof(PDUSessionList)) == OGS_OK)
+        pdu_session_list = &PDUSessionList;
+
+    handle_ue_context_release_request(gnb, ran_ue_ngap_id,
+            message->amf_ue_ngap_id, pdu_session_list, cause);
+
+    if (cause)
+        ogs_asn_free(&asn_DEF_NGAP_Cause, cause);
+    if (pdu_session_list)
+        ogs_asn_free(&asn_DEF_NGAP_PDUSessionResourceListCxtRelReq,
+                pdu_session_list);
+}
+
 void ngap_handle_ue_context_release_complete(
         amf_gnb_t *gnb, ogs_ngap_message_t *message)
 {
@@ -3337,6 +3466,8 @@ void ngap_handle_handover_required(
     OGS_ASN_STORE_DATA(&amf_ue->handover.container,
             SourceToTarget_TransparentContainer);
 
+    amf_ue->handover.start = ogs_get_monotonic_time();
+
     for (i = 0; i < PDUSessionList->list.count; i++) {
         amf_sess_t *sess = NULL;
         PDUSessionItem = (NGAP_PDUSessionResourceItemHORqd_t *)
@@ -4205,6 +4336,13 @@ void ngap_handle_handover_notification(
     memcpy(&amf_ue->nr_tai, &target_ue->saved.nr_tai, sizeof(ogs_5gs_tai_t));
     memcpy(&amf_ue->nr_cgi, &target_ue->saved.nr_cgi, sizeof(ogs_nr_cgi_t));
 
+    if (amf_ue->handover.start) {
+        amf_metrics_inst_global_add(AMF_METR_GLOB_HIST_HANDOVER_TIME,
+                ogs_time_to_msec(ogs_get_monotonic_time() -
+                    amf_ue->handover.start));
+        amf_ue->handover.start = 0;
+    }
+
     r = ngap_send_ran_ue_context_release_command(source_ue,
             NGAP_Cause_PR_radioNetwork,
             NGAP_CauseRadioNetwork_successful_handover,
@@ -4449,6 +4587,8 @@ void ngap_handle_ran_configuration_update(
             gnb->num_of_supported_ta_list++;
         }
 
+        amf_gnb_paging_update(gnb);
+
         if (gnb->num_of_supported_ta_list == 0) {
             ogs_warn("RANConfigurationUpdate failure:");
             ogs_warn("    No supported TA exist in request");
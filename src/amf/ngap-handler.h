@@ -32,6 +32,8 @@ void ngap_handle_initial_ue_message(
         amf_gnb_t *gnb, ogs_ngap_message_t *message);
 void ngap_handle_uplink_nas_transport(
         amf_gnb_t *gnb, ogs_ngap_message_t *message);
+void ngap_handle_uplink_nas_transport_lazy(
+        amf_gnb_t *gnb, ogs_ngap_lazy_message_t *message);
 void ngap_handle_ue_radio_capability_info_indication(
         amf_gnb_t *gnb, ogs_ngap_message_t *message);
 void ngap_handle_initial_context_setup_response(
@@ -53,6 +55,8 @@ void ngap_handle_ue_context_modification_failure(
 
 void ngap_handle_ue_context_release_request(
         amf_gnb_t *gnb, ogs_ngap_message_t *message);
+void ngap_handle_ue_context_release_request_lazy(
+        amf_gnb_t *gnb, ogs_ngap_lazy_message_t *message);
 void ngap_handle_ue_context_release_complete(
         amf_gnb_t *gnb, ogs_ngap_message_t *message);
 void ngap_handle_ue_context_release_action(ran_ue_t *ran_ue);
@@ -415,12 +415,15 @@ int ngap_send_ran_ue_context_release_command(
     return rv;
 }
 
+/*
+ * NG-Paging is queued on the paging area of the UE's TAI and sent when
+ * the loop iteration ends, so the gNBs of an area are looked up once
+ * for every UE paged there and a UE paged twice is sent only once.
+ * All gNBs get a reference to the same encoded PDU.
+ */
 int ngap_send_paging(amf_ue_t *amf_ue)
 {
-    ogs_pkbuf_t *ngapbuf = NULL;
-    amf_gnb_t *gnb = NULL;
-    int i, j;
-    int rv;
+    ogs_paging_area_t *area = NULL;
 
     ogs_debug("NG-Paging");
 
@@ -429,40 +432,17 @@ int ngap_send_paging(amf_ue_t *amf_ue)
         return OGS_NOTFOUND;
     }
 
-    ogs_list_for_each(&amf_self()->gnb_list, gnb) {
-        for (i = 0; i < gnb->num_of_supported_ta_list; i++) {
-            for (j = 0; j < gnb->supported_ta_list[i].num_of_bplmn_list; j++) {
-                if (memcmp(&gnb->supported_ta_list[i].bplmn_list[j].plmn_id,
-                            &amf_ue->nr_tai.plmn_id, OGS_PLMN_ID_LEN) == 0 &&
-                    gnb->supported_ta_list[i].tac.v == amf_ue->nr_tai.tac.v) {
-
-                    if (amf_ue->t3513.pkbuf) {
-                        ngapbuf = amf_ue->t3513.pkbuf;
-                    } else {
-                        ngapbuf = ngap_build_paging(amf_ue);
-                        if (!ngapbuf) {
-                            ogs_error("ngap_build_paging() failed");
-                            return OGS_ERROR;
-                        }
-                    }
-
-                    amf_ue->t3513.pkbuf = ogs_pkbuf_copy(ngapbuf);
-                    if (!amf_ue->t3513.pkbuf) {
-                        ogs_error("ogs_pkbuf_copy() failed");
-                        ogs_pkbuf_free(ngapbuf);
-                        return OGS_ERROR;
-                    }
-
-                    amf_metrics_inst_global_inc(AMF_METR_GLOB_CTR_MM_PAGING_5G_REQ);
-
-                    rv = ngap_send_to_gnb(gnb, ngapbuf, NGAP_NON_UE_SIGNALLING);
-                    if (rv != OGS_OK) {
-                        ogs_error("ngap_send_to_gnb() failed");
-                        return rv;
-                    }
-                }
+    area = amf_paging_area_find(&amf_ue->nr_tai);
+    if (area) {
+        if (!amf_ue->t3513.pkbuf) {
+            amf_ue->t3513.pkbuf = ngap_build_paging(amf_ue);
+            if (!amf_ue->t3513.pkbuf) {
+                ogs_error("ngap_build_paging() failed");
+                return OGS_ERROR;
             }
         }
+
+        ogs_paging_ue_queue(&amf_self()->paging, area, &amf_ue->paging_ue);
     }
 
     /* Start T3513 */
@@ -472,6 +452,44 @@ int ngap_send_paging(amf_ue_t *amf_ue)
     return OGS_OK;
 }
 
+void ngap_paging_flush(void *data)
+{
+    ogs_paging_area_t *area = NULL;
+    ogs_paging_member_t *member = NULL;
+    ogs_paging_ue_t *ue = NULL;
+    ogs_pkbuf_t *ngapbuf = NULL;
+    int rv;
+
+    while ((area = ogs_paging_pending_pop(&amf_self()->paging))) {
+        while ((ue = ogs_paging_ue_pop(area))) {
+            amf_ue_t *amf_ue = ogs_container_of(ue, amf_ue_t, paging_ue);
+
+            /* Paging was stopped before the end of the iteration */
+            if (!amf_ue->t3513.pkbuf)
+                continue;
+
+            ogs_list_for_each(&area->node_list, member) {
+                amf_gnb_t *gnb = member->node;
+
+                ngapbuf = ogs_pkbuf_copy(amf_ue->t3513.pkbuf);
+                if (!ngapbuf) {
+                    ogs_error("ogs_pkbuf_copy() failed");
+                    break;
+                }
+
+                rv = ngap_send_to_gnb(gnb, ngapbuf, NGAP_NON_UE_SIGNALLING);
+                if (rv != OGS_OK) {
+                    ogs_error("[%s] ngap_send_to_gnb() failed [gNB-ID:0x%x]",
+                            amf_ue->supi, gnb->gnb_id);
+                    continue;
+                }
+
+                amf_metrics_inst_global_inc(AMF_METR_GLOB_CTR_MM_PAGING_5G_REQ);
+            }
+        }
+    }
+}
+
 int ngap_send_downlink_ran_configuration_transfer(
         amf_gnb_t *target_gnb, NGAP_SONConfigurationTransfer_t *transfer)
 {
@@ -57,6 +57,7 @@ int ngap_send_ran_ue_context_release_command(
     uint8_t action, ogs_time_t duration);
 
 int ngap_send_paging(amf_ue_t *amf_ue);
+void ngap_paging_flush(void *data);
 
 int ngap_send_downlink_ran_configuration_transfer(
         amf_gnb_t *target_gnb, NGAP_SONConfigurationTransfer_t *transfer);
@@ -45,6 +45,7 @@ void ngap_state_operational(ogs_fsm_t *s, amf_event_t *e)
     ogs_pkbuf_t *pkbuf = NULL;
 
     NGAP_NGAP_PDU_t *pdu = NULL;
+    ogs_ngap_lazy_message_t *lazy = NULL;
     NGAP_InitiatingMessage_t *initiatingMessage = NULL;
     NGAP_SuccessfulOutcome_t *successfulOutcome = NULL;
     NGAP_UnsuccessfulOutcome_t *unsuccessfulOutcome = NULL;
@@ -63,6 +64,27 @@ void ngap_state_operational(ogs_fsm_t *s, amf_event_t *e)
     case OGS_FSM_EXIT_SIG:
         break;
     case AMF_EVENT_NGAP_MESSAGE:
+        lazy = e->ngap.lazy;
+        if (lazy) {
+            /* Only sent by amf_state_operational() after NG Setup */
+            ogs_assert(gnb->state.ng_setup_success);
+            ogs_assert(lazy->h.present == NGAP_NGAP_PDU_PR_initiatingMessage);
+
+            switch (lazy->h.procedureCode) {
+            case NGAP_ProcedureCode_id_UplinkNASTransport:
+                ngap_handle_uplink_nas_transport_lazy(gnb, lazy);
+                break;
+            case NGAP_ProcedureCode_id_UEContextReleaseRequest:
+                ngap_handle_ue_context_release_request_lazy(gnb, lazy);
+                break;
+            default:
+                ogs_error("Not implemented(lazy, proc:%d)",
+                        (int)lazy->h.procedureCode);
+                break;
+            }
+            break;
+        }
+
         pdu = e->ngap.message;
         ogs_assert(pdu);
             
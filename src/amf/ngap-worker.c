@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2024 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "context.h"
+#include "ngap-worker.h"
+
+static ogs_worker_t *worker = NULL;
+
+static void ngap_worker_decode(void *data);
+static void ngap_worker_event_free(void *data);
+
+int ngap_worker_open(int num_of_worker)
+{
+    ogs_assert(worker == NULL);
+
+    if (num_of_worker <= 0)
+        return OGS_OK;
+
+    worker = ogs_worker_create("NGAP", num_of_worker,
+            ngap_worker_decode, ngap_worker_event_free);
+    if (!worker)
+        return OGS_ERROR;
+
+    return OGS_OK;
+}
+
+void ngap_worker_close(void)
+{
+    if (!worker)
+        return;
+
+    ogs_worker_destroy(worker);
+    worker = NULL;
+}
+
+bool ngap_worker_enabled(void)
+{
+    return worker != NULL;
+}
+
+int ngap_worker_push(amf_event_t *e)
+{
+    int klen = sizeof(ogs_sockaddr_t);
+
+    ogs_assert(e);
+    ogs_assert(e->ngap.addr);
+    ogs_assert(worker);
+
+    return ogs_worker_push(worker,
+            ogs_hashfunc_default((const char *)e->ngap.addr, &klen), e);
+}
+
+/*
+ * On success, e->ngap.message holds the decoded PDU, which the main loop
+ * releases after dispatching. Messages that the main loop handles with
+ * ogs_ngap_lazy_decode() are passed through untouched, as are messages
+ * that fail to decode so that the main loop can report the error.
+ */
+static void ngap_worker_decode(void *data)
+{
+    amf_event_t *e = data;
+    ogs_ngap_lazy_message_t lazy;
+    ogs_ngap_message_t *message = NULL;
+    int rv;
+
+    ogs_assert(e);
+
+    if (e->h.id != AMF_EVENT_NGAP_MESSAGE)
+        return;
+
+    ogs_assert(e->pkbuf);
+
+    rv = ogs_ngap_lazy_decode(&lazy, e->pkbuf);
+    if (rv == OGS_OK &&
+        lazy.h.present == NGAP_NGAP_PDU_PR_initiatingMessage &&
+        (lazy.h.procedureCode == NGAP_ProcedureCode_id_UplinkNASTransport ||
+         lazy.h.procedureCode ==
+            NGAP_ProcedureCode_id_UEContextReleaseRequest))
+        return;
+
+    message = ogs_calloc(1, sizeof(*message));
+    ogs_assert(message);
+
+    rv = ogs_ngap_decode(message, e->pkbuf);
+    if (rv != OGS_OK) {
+        ogs_ngap_free(message);
+        ogs_free(message);
+        return;
+    }
+
+    e->ngap.message = message;
+}
+
+static void ngap_worker_event_free(void *data)
+{
+    amf_event_t *e = data;
+
+    ogs_assert(e);
+
+    if (e->ngap.message) {
+        ogs_ngap_free(e->ngap.message);
+        ogs_free(e->ngap.message);
+    }
+    if (e->ngap.addr)
+        ogs_free(e->ngap.addr);
+    if (e->pkbuf)
+        ogs_pkbuf_free(e->pkbuf);
+    ogs_event_free(e);
+}
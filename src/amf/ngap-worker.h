@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2024 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef NGAP_WORKER_H
+#define NGAP_WORKER_H
+
+#include "event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * NGAP worker threads take the ASN.1 decoding of incoming NGAP-PDUs off
+ * the AMF main loop. SCTP events are sharded by gNB association, so all
+ * messages of one gNB (and therefore of every UE served by it) are
+ * handled by the same worker and reach the main loop in arrival order.
+ * All AMF context (gNB, RAN-UE, AMF-UE) stays owned by the main loop.
+ */
+int ngap_worker_open(int num_of_worker);
+void ngap_worker_close(void);
+
+bool ngap_worker_enabled(void);
+int ngap_worker_push(amf_event_t *e);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NGAP_WORKER_H */
@@ -91,11 +91,18 @@ void ausf_terminate(void)
     ogs_sbi_context_final();
 }
 
+static const char *ausf_prof_event_name(void *event)
+{
+    return ausf_event_get_name(event);
+}
+
 static void ausf_main(void *data)
 {
     ogs_fsm_t ausf_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            ausf_prof_event_name);
     ogs_fsm_init(&ausf_sm, ausf_state_initial, ausf_state_final, 0);
 
     for ( ;; ) {
@@ -115,10 +122,14 @@ static void ausf_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            ausf_event_t *e = NULL;
+            ausf_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -127,9 +138,11 @@ static void ausf_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&ausf_sm, e);
-            ogs_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&ausf_sm, e[i]);
+                ogs_event_free(e[i]);
+            }
         }
     }
 done:
@@ -0,0 +1,1213 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "binding-store.h"
+#include "replication.h"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/*
+ * The store keeps the bindings of the in-memory context on disk:
+ *
+ *   binding.snapshot       every binding at the start of a generation
+ *   binding.<generation>.log
+ *                          records appended while the generation is current
+ *
+ * Records are buffered and written out by a timer, so a NBSF request
+ * never waits for the disk. Once enough records are logged, the store
+ * moves to a new generation and a forked child writes the snapshot from
+ * its copy-on-write view of the context; the logs it covers are removed
+ * when the child succeeds. At startup the snapshot is loaded and the
+ * logs from its generation on are replayed.
+ *
+ * Every record carries the stamp of the binding, a Lamport clock and
+ * the instance that wrote it. A record only replaces or removes a
+ * binding with an older stamp, so the instances sharing the bindings
+ * end up with the same one whatever order the records arrive in.
+ *
+ * While replication is enabled, a deleted binding leaves a tombstone
+ * with the stamp of the delete. Tombstones are written to the snapshot
+ * as delete records and sent to a peer when it is synchronized, and they
+ * expire after bsf.binding.replication.tombstone_retention.
+ */
+
+#define SNAPSHOT_MAGIC          "OGSBSF01"
+#define SNAPSHOT_MAGIC_LEN      8
+#define SNAPSHOT_HEADER_LEN     (SNAPSHOT_MAGIC_LEN + 8)
+
+#define WRITE_BUFFER_SIZE       (1024*1024)
+
+#define MAX_BINDING_ID_LEN      64
+
+typedef enum {
+    BINDING_TAG_BINDING_ID = 1,
+    BINDING_TAG_SUPI,
+    BINDING_TAG_GPSI,
+    BINDING_TAG_IPV4ADDR,
+    BINDING_TAG_IPV6PREFIX,
+    BINDING_TAG_IPV4_FRAME_ROUTE,
+    BINDING_TAG_IPV6_FRAME_ROUTE,
+    BINDING_TAG_S_NSSAI,
+    BINDING_TAG_DNN,
+    BINDING_TAG_PCF_FQDN,
+    BINDING_TAG_PCF_IP,
+    BINDING_TAG_PCF_IP_ADDR,
+    BINDING_TAG_PCF_IP_ADDR6,
+    BINDING_TAG_PCF_IP_PORT,
+    BINDING_TAG_MANAGEMENT_FEATURES,
+    BINDING_TAG_STAMP,
+} binding_tag_e;
+
+typedef struct buffer_s {
+    uint8_t *data;
+    size_t len;
+    size_t size;
+} buffer_t;
+
+static struct {
+    bool opened;
+
+    int log_fd;
+    uint64_t generation;
+
+    /* Records logged since the last snapshot */
+    uint64_t num_of_record;
+
+    /* Highest stamp generation written or seen */
+    uint64_t clock;
+    uint32_t origin;
+
+    ogs_timer_t *t_flush;
+
+    buffer_t log;
+    buffer_t ship;
+
+    /* Oldest first, hashed by Binding ID. No hash if not replicating */
+    ogs_list_t tombstone_list;
+    ogs_hash_t *tombstone_hash;
+
+    pid_t snapshot_pid;
+    uint64_t snapshot_generation;
+    /* Prepared before fork(), the child must not allocate */
+    char snapshot_path[OGS_MAX_FILEPATH_LEN];
+    char snapshot_tmp_path[OGS_MAX_FILEPATH_LEN];
+    uint8_t *snapshot_buf;
+} store = { .log_fd = -1 };
+
+static uint8_t record_buf[BSF_BINDING_RECORD_MAX_LEN];
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v >> 8;
+    p[1] = v;
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static void put_u64(uint8_t *p, uint64_t v)
+{
+    put_u32(p, v >> 32);
+    put_u32(p + 4, v);
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (p[0] << 8) | p[1];
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static uint64_t get_u64(const uint8_t *p)
+{
+    return ((uint64_t)get_u32(p) << 32) | get_u32(p + 4);
+}
+
+static uint32_t checksum(const uint8_t *body, size_t len)
+{
+    int klen = len;
+    return ogs_hashfunc_default((const char *)body, &klen);
+}
+
+/* Returns NULL once the record does not fit, and keeps returning it */
+static uint8_t *put_tlv(uint8_t *p, uint8_t *end,
+        uint8_t tag, const void *value, size_t len)
+{
+    if (!p || len > 0xffff || end - p < (ptrdiff_t)(3 + len))
+        return NULL;
+
+    p[0] = tag;
+    put_u16(p + 1, len);
+    if (len)
+        memcpy(p + 3, value, len);
+
+    return p + 3 + len;
+}
+
+static uint8_t *put_string(uint8_t *p, uint8_t *end,
+        uint8_t tag, const char *value)
+{
+    if (!value)
+        return p;
+    return put_tlv(p, end, tag, value, strlen(value));
+}
+
+/*
+ * Must be safe to call from the snapshot child:
+ * no allocation, no logging.
+ */
+size_t bsf_binding_record_build(uint8_t op,
+        bsf_sess_t *sess, uint8_t *buf, size_t size)
+{
+    uint8_t *p, *end, *body;
+    OpenAPI_lnode_t *node = NULL;
+    uint8_t v[12];
+    int i;
+
+    if (size < BSF_BINDING_RECORD_HEADER_LEN + 1)
+        return 0;
+    if (size > BSF_BINDING_RECORD_MAX_LEN)
+        size = BSF_BINDING_RECORD_MAX_LEN;
+
+    body = buf + BSF_BINDING_RECORD_HEADER_LEN;
+    end = buf + size;
+
+    p = body;
+    *p++ = op;
+
+    if (sess) {
+        p = put_string(p, end, BINDING_TAG_BINDING_ID, sess->binding_id);
+
+        put_u64(v, sess->stamp.generation);
+        put_u32(v + 8, sess->stamp.origin);
+        p = put_tlv(p, end, BINDING_TAG_STAMP, v, 12);
+    }
+
+    if (op == BSF_BINDING_RECORD_PUT) {
+        ogs_assert(sess);
+
+        p = put_string(p, end, BINDING_TAG_SUPI, sess->supi);
+        p = put_string(p, end, BINDING_TAG_GPSI, sess->gpsi);
+        p = put_string(p, end, BINDING_TAG_IPV4ADDR, sess->ipv4addr_string);
+        p = put_string(p, end,
+                BINDING_TAG_IPV6PREFIX, sess->ipv6prefix_string);
+
+        if (sess->ipv4_frame_route_list)
+            OpenAPI_list_for_each(sess->ipv4_frame_route_list, node)
+                p = put_string(p, end,
+                        BINDING_TAG_IPV4_FRAME_ROUTE, node->data);
+        if (sess->ipv6_frame_route_list)
+            OpenAPI_list_for_each(sess->ipv6_frame_route_list, node)
+                p = put_string(p, end,
+                        BINDING_TAG_IPV6_FRAME_ROUTE, node->data);
+
+        v[0] = sess->s_nssai.sst;
+        v[1] = sess->s_nssai.sd.v >> 16;
+        v[2] = sess->s_nssai.sd.v >> 8;
+        v[3] = sess->s_nssai.sd.v;
+        p = put_tlv(p, end, BINDING_TAG_S_NSSAI, v, 4);
+        p = put_string(p, end, BINDING_TAG_DNN, sess->dnn);
+
+        p = put_string(p, end, BINDING_TAG_PCF_FQDN, sess->pcf_fqdn);
+        for (i = 0; i < sess->num_of_pcf_ip; i++) {
+            p = put_tlv(p, end, BINDING_TAG_PCF_IP, NULL, 0);
+            p = put_string(p, end,
+                    BINDING_TAG_PCF_IP_ADDR, sess->pcf_ip[i].addr);
+            p = put_string(p, end,
+                    BINDING_TAG_PCF_IP_ADDR6, sess->pcf_ip[i].addr6);
+            if (sess->pcf_ip[i].is_port) {
+                put_u16(v, sess->pcf_ip[i].port);
+                p = put_tlv(p, end, BINDING_TAG_PCF_IP_PORT, v, 2);
+            }
+        }
+
+        put_u64(v, sess->management_features);
+        p = put_tlv(p, end, BINDING_TAG_MANAGEMENT_FEATURES, v, 8);
+    }
+
+    if (!p)
+        return 0;
+
+    put_u32(buf, p - body);
+    put_u32(buf + 4, checksum(body, p - body));
+
+    return p - buf;
+}
+
+/* Must be safe to call from the snapshot child, as above */
+size_t bsf_binding_tombstone_record_build(
+        bsf_binding_tombstone_t *tombstone, uint8_t *buf, size_t size)
+{
+    bsf_sess_t sess;
+
+    ogs_assert(tombstone);
+
+    memset(&sess, 0, sizeof(sess));
+    sess.binding_id = tombstone->binding_id;
+    sess.stamp.generation = tombstone->stamp.generation;
+    sess.stamp.origin = tombstone->stamp.origin;
+
+    return bsf_binding_record_build(
+            BSF_BINDING_RECORD_DEL, &sess, buf, size);
+}
+
+/*
+ * Returns 1 and the length of the record at buf, 0 if more data is
+ * needed, or -1 if buf does not start with a valid record.
+ */
+int bsf_binding_record_parse(
+        const uint8_t *buf, size_t len, size_t *record_len)
+{
+    uint32_t body_len;
+
+    ogs_assert(buf);
+    ogs_assert(record_len);
+
+    if (len < BSF_BINDING_RECORD_HEADER_LEN)
+        return 0;
+
+    body_len = get_u32(buf);
+    if (body_len == 0 ||
+        body_len > BSF_BINDING_RECORD_MAX_LEN - BSF_BINDING_RECORD_HEADER_LEN)
+        return -1;
+
+    if (len < BSF_BINDING_RECORD_HEADER_LEN + body_len)
+        return 0;
+
+    if (checksum(buf + BSF_BINDING_RECORD_HEADER_LEN, body_len) !=
+            get_u32(buf + 4))
+        return -1;
+
+    *record_len = BSF_BINDING_RECORD_HEADER_LEN + body_len;
+    return 1;
+}
+
+typedef struct tlv_iter_s {
+    const uint8_t *p, *end;
+
+    uint8_t tag;
+    const uint8_t *value;
+    uint16_t len;
+} tlv_iter_t;
+
+static void tlv_iter_init(tlv_iter_t *iter, const uint8_t *record, size_t len)
+{
+    /* Skip the header and the op */
+    iter->p = record + BSF_BINDING_RECORD_HEADER_LEN + 1;
+    iter->end = record + len;
+}
+
+static bool tlv_iter_next(tlv_iter_t *iter)
+{
+    if (iter->end - iter->p < 3)
+        return false;
+
+    iter->tag = iter->p[0];
+    iter->len = get_u16(iter->p + 1);
+    if (iter->end - iter->p < 3 + iter->len)
+        return false;
+
+    iter->value = iter->p + 3;
+    iter->p += 3 + iter->len;
+
+    return true;
+}
+
+static bool tlv_string(tlv_iter_t *iter, char *buf, size_t size)
+{
+    if (iter->len >= size)
+        return false;
+
+    memcpy(buf, iter->value, iter->len);
+    buf[iter->len] = 0;
+
+    return true;
+}
+
+static char *tlv_strdup(tlv_iter_t *iter)
+{
+    char *s = ogs_strndup((const char *)iter->value, iter->len);
+    ogs_assert(s);
+    return s;
+}
+
+static void apply_fields(bsf_sess_t *sess, const uint8_t *record, size_t len)
+{
+    tlv_iter_t iter;
+    int pcf_ip = -1;
+
+    tlv_iter_init(&iter, record, len);
+    while (tlv_iter_next(&iter)) {
+        switch (iter.tag) {
+        case BINDING_TAG_SUPI:
+            if (!sess->supi)
+                sess->supi = tlv_strdup(&iter);
+            break;
+        case BINDING_TAG_GPSI:
+            if (!sess->gpsi)
+                sess->gpsi = tlv_strdup(&iter);
+            break;
+        case BINDING_TAG_IPV4_FRAME_ROUTE:
+            if (!sess->ipv4_frame_route_list) {
+                sess->ipv4_frame_route_list = OpenAPI_list_create();
+                ogs_assert(sess->ipv4_frame_route_list);
+            }
+            OpenAPI_list_add(sess->ipv4_frame_route_list, tlv_strdup(&iter));
+            break;
+        case BINDING_TAG_IPV6_FRAME_ROUTE:
+            if (!sess->ipv6_frame_route_list) {
+                sess->ipv6_frame_route_list = OpenAPI_list_create();
+                ogs_assert(sess->ipv6_frame_route_list);
+            }
+            OpenAPI_list_add(sess->ipv6_frame_route_list, tlv_strdup(&iter));
+            break;
+        case BINDING_TAG_S_NSSAI:
+            if (iter.len == 4) {
+                sess->s_nssai.sst = iter.value[0];
+                sess->s_nssai.sd.v = (iter.value[1] << 16) |
+                    (iter.value[2] << 8) | iter.value[3];
+            }
+            break;
+        case BINDING_TAG_DNN:
+            if (!sess->dnn)
+                sess->dnn = tlv_strdup(&iter);
+            break;
+        case BINDING_TAG_PCF_FQDN:
+            if (!sess->pcf_fqdn)
+                sess->pcf_fqdn = tlv_strdup(&iter);
+            break;
+        case BINDING_TAG_PCF_IP:
+            if (sess->num_of_pcf_ip < OGS_SBI_MAX_NUM_OF_IP_ADDRESS)
+                pcf_ip = sess->num_of_pcf_ip++;
+            else
+                pcf_ip = -1;
+            break;
+        case BINDING_TAG_PCF_IP_ADDR:
+            if (pcf_ip >= 0 && !sess->pcf_ip[pcf_ip].addr)
+                sess->pcf_ip[pcf_ip].addr = tlv_strdup(&iter);
+            break;
+        case BINDING_TAG_PCF_IP_ADDR6:
+            if (pcf_ip >= 0 && !sess->pcf_ip[pcf_ip].addr6)
+                sess->pcf_ip[pcf_ip].addr6 = tlv_strdup(&iter);
+            break;
+        case BINDING_TAG_PCF_IP_PORT:
+            if (pcf_ip >= 0 && iter.len == 2) {
+                sess->pcf_ip[pcf_ip].is_port = true;
+                sess->pcf_ip[pcf_ip].port = get_u16(iter.value);
+            }
+            break;
+        case BINDING_TAG_MANAGEMENT_FEATURES:
+            if (iter.len == 8)
+                sess->management_features = get_u64(iter.value);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static bool stamp_after(uint64_t generation, uint32_t origin,
+        uint64_t than_generation, uint32_t than_origin)
+{
+    if (generation != than_generation)
+        return generation > than_generation;
+    return origin > than_origin;
+}
+
+static bool stamp_newer(
+        uint64_t generation, uint32_t origin, bsf_sess_t *sess)
+{
+    return stamp_after(generation, origin,
+            sess->stamp.generation, sess->stamp.origin);
+}
+
+static bsf_binding_tombstone_t *tombstone_find(const char *binding_id)
+{
+    if (!store.tombstone_hash)
+        return NULL;
+
+    return ogs_hash_get(store.tombstone_hash,
+            binding_id, OGS_HASH_KEY_STRING);
+}
+
+static void tombstone_remove(bsf_binding_tombstone_t *tombstone)
+{
+    ogs_assert(tombstone);
+
+    bsf_replication_tombstone_remove(tombstone);
+
+    ogs_list_remove(&store.tombstone_list, tombstone);
+    ogs_hash_set(store.tombstone_hash,
+            tombstone->binding_id, OGS_HASH_KEY_STRING, NULL);
+
+    ogs_free(tombstone->binding_id);
+    ogs_free(tombstone);
+}
+
+/* Records a delete with the given stamp, unless a newer one is known */
+static void tombstone_set(
+        const char *binding_id, uint64_t generation, uint32_t origin)
+{
+    bsf_binding_tombstone_t *tombstone = NULL;
+
+    if (!store.tombstone_hash)
+        return;
+
+    tombstone = tombstone_find(binding_id);
+    if (tombstone) {
+        if (!stamp_after(generation, origin,
+                    tombstone->stamp.generation, tombstone->stamp.origin))
+            return;
+        tombstone_remove(tombstone);
+    }
+
+    tombstone = ogs_calloc(1, sizeof(*tombstone));
+    ogs_assert(tombstone);
+    tombstone->binding_id = ogs_strdup(binding_id);
+    ogs_assert(tombstone->binding_id);
+    tombstone->stamp.generation = generation;
+    tombstone->stamp.origin = origin;
+    tombstone->removed = ogs_get_monotonic_time();
+
+    ogs_list_add(&store.tombstone_list, tombstone);
+    ogs_hash_set(store.tombstone_hash,
+            tombstone->binding_id, OGS_HASH_KEY_STRING, tombstone);
+}
+
+static void tombstone_expire(void)
+{
+    bsf_binding_tombstone_t *tombstone = NULL, *next_tombstone = NULL;
+    ogs_time_t now = ogs_get_monotonic_time();
+
+    ogs_list_for_each_safe(&store.tombstone_list, next_tombstone, tombstone) {
+        if (now - tombstone->removed <
+                bsf_self()->replication.tombstone_retention)
+            break;
+        tombstone_remove(tombstone);
+    }
+}
+
+ogs_list_t *bsf_binding_tombstone_list(void)
+{
+    return &store.tombstone_list;
+}
+
+/*
+ * Applies a record that was parsed successfully. A binding replaces any
+ * binding with the same Binding ID or UE address, which is what the
+ * NBSF request that created it did on the instance that logged it.
+ *
+ * Returns OGS_DONE without changing anything if one of those bindings
+ * has the same or a newer stamp.
+ */
+static int apply_record(const uint8_t *record, size_t len)
+{
+    tlv_iter_t iter;
+    uint8_t op;
+    char binding_id[MAX_BINDING_ID_LEN];
+    char ipv4addr[OGS_ADDRSTRLEN];
+    char ipv6prefix[OGS_ADDRSTRLEN+8];
+    bool has_binding_id = false, has_ipv4addr = false, has_ipv6prefix = false;
+    bool has_dnn = false;
+    uint64_t generation = 0;
+    uint32_t origin = 0;
+    bsf_sess_t *sess = NULL, *ipv4_sess = NULL, *ipv6_sess = NULL;
+    bsf_binding_tombstone_t *tombstone = NULL;
+
+    op = record[BSF_BINDING_RECORD_HEADER_LEN];
+
+    tlv_iter_init(&iter, record, len);
+    while (tlv_iter_next(&iter)) {
+        if (iter.tag == BINDING_TAG_BINDING_ID)
+            has_binding_id = tlv_string(&iter, binding_id, sizeof(binding_id));
+        else if (iter.tag == BINDING_TAG_IPV4ADDR)
+            has_ipv4addr = tlv_string(&iter, ipv4addr, sizeof(ipv4addr));
+        else if (iter.tag == BINDING_TAG_IPV6PREFIX)
+            has_ipv6prefix = tlv_string(&iter, ipv6prefix, sizeof(ipv6prefix));
+        else if (iter.tag == BINDING_TAG_DNN)
+            has_dnn = true;
+        else if (iter.tag == BINDING_TAG_STAMP && iter.len == 12) {
+            generation = get_u64(iter.value);
+            origin = get_u32(iter.value + 8);
+        }
+    }
+
+    /* Lamport clock: the next local stamp is newer than any seen */
+    if (generation > store.clock)
+        store.clock = generation;
+
+    if (op == BSF_BINDING_RECORD_END)
+        return OGS_OK;
+
+    if (!has_binding_id) {
+        ogs_error("No Binding ID in binding record");
+        return OGS_ERROR;
+    }
+
+    sess = bsf_sess_find_by_binding_id(binding_id);
+    tombstone = tombstone_find(binding_id);
+
+    /* Already deleted with the same or a newer stamp */
+    if (tombstone && !stamp_after(generation, origin,
+                tombstone->stamp.generation, tombstone->stamp.origin))
+        return OGS_DONE;
+
+    if (op == BSF_BINDING_RECORD_DEL) {
+        if (sess) {
+            if (!stamp_newer(generation, origin, sess))
+                return OGS_DONE;
+            bsf_sess_remove(sess);
+        }
+        tombstone_set(binding_id, generation, origin);
+        return OGS_OK;
+    }
+
+    if (op != BSF_BINDING_RECORD_PUT) {
+        ogs_error("Unknown binding record [%d]", op);
+        return OGS_ERROR;
+    }
+
+    if (has_ipv6prefix) {
+        uint8_t addr6[OGS_IPV6_LEN];
+        uint8_t prefixlen;
+
+        /* bsf_sess_set_ipv6prefix() asserts on anything but a /128 */
+        if (ogs_ipv6prefix_from_string(addr6, &prefixlen, ipv6prefix) !=
+                OGS_OK || prefixlen != OGS_IPV6_128_PREFIX_LEN) {
+            ogs_error("Invalid IPv6 prefix [%s] in binding [%s]",
+                    ipv6prefix, binding_id);
+            return OGS_ERROR;
+        }
+    }
+    if (!has_ipv4addr && !has_ipv6prefix) {
+        ogs_error("No UE address in binding [%s]", binding_id);
+        return OGS_ERROR;
+    }
+    if (!has_dnn) {
+        ogs_error("No DNN in binding [%s]", binding_id);
+        return OGS_ERROR;
+    }
+
+    if (has_ipv4addr)
+        ipv4_sess = bsf_sess_find_by_ipv4addr(ipv4addr);
+    if (has_ipv6prefix)
+        ipv6_sess = bsf_sess_find_by_ipv6prefix(ipv6prefix);
+
+    if ((sess && !stamp_newer(generation, origin, sess)) ||
+        (ipv4_sess && !stamp_newer(generation, origin, ipv4_sess)) ||
+        (ipv6_sess && !stamp_newer(generation, origin, ipv6_sess)))
+        return OGS_DONE;
+
+    if (sess)
+        bsf_sess_remove(sess);
+    if (has_ipv4addr && (sess = bsf_sess_find_by_ipv4addr(ipv4addr)))
+        bsf_sess_remove(sess);
+    if (has_ipv6prefix && (sess = bsf_sess_find_by_ipv6prefix(ipv6prefix)))
+        bsf_sess_remove(sess);
+
+    sess = bsf_sess_add_by_binding_id(binding_id,
+            has_ipv4addr ? ipv4addr : NULL,
+            has_ipv6prefix ? ipv6prefix : NULL);
+    if (!sess)
+        return OGS_ERROR;
+
+    apply_fields(sess, record, len);
+    sess->stamp.generation = generation;
+    sess->stamp.origin = origin;
+
+    if (tombstone)
+        tombstone_remove(tombstone);
+
+    return OGS_OK;
+}
+
+static void buffer_append(buffer_t *buffer, const uint8_t *data, size_t len)
+{
+    if (buffer->len + len > buffer->size) {
+        size_t size = ogs_max(buffer->size * 2, buffer->len + len);
+
+        buffer->data = ogs_realloc(buffer->data, size);
+        ogs_assert(buffer->data);
+        buffer->size = size;
+    }
+
+    memcpy(buffer->data + buffer->len, data, len);
+    buffer->len += len;
+}
+
+static void buffer_free(buffer_t *buffer)
+{
+    if (buffer->data)
+        ogs_free(buffer->data);
+    memset(buffer, 0, sizeof(*buffer));
+}
+
+static int write_all(int fd, const uint8_t *buf, size_t len)
+{
+    ssize_t n;
+
+    while (len) {
+        n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return OGS_ERROR;
+        }
+        buf += n;
+        len -= n;
+    }
+
+    return OGS_OK;
+}
+
+static void log_path(char *buf, size_t size, uint64_t generation)
+{
+    ogs_snprintf(buf, size, "%s/binding.%llu.log",
+            bsf_self()->store.path, (unsigned long long)generation);
+}
+
+static bool log_generation(const char *name, uint64_t *generation)
+{
+    char *end = NULL;
+
+    if (strncmp(name, "binding.", 8) != 0 || !isdigit((int)name[8]))
+        return false;
+
+    *generation = strtoull(name + 8, &end, 10);
+
+    return strcmp(end, ".log") == 0;
+}
+
+static int compare_generation(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Returns the generations of the logs in ascending order */
+static int list_logs(uint64_t **generation)
+{
+    DIR *dir = NULL;
+    struct dirent *entry = NULL;
+    int num = 0, size = 0;
+
+    *generation = NULL;
+
+    dir = opendir(bsf_self()->store.path);
+    if (!dir) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                "opendir(%s) failed", bsf_self()->store.path);
+        return 0;
+    }
+
+    while ((entry = readdir(dir))) {
+        uint64_t v;
+
+        if (!log_generation(entry->d_name, &v))
+            continue;
+
+        if (num == size) {
+            size = size ? size * 2 : 16;
+            *generation = ogs_realloc(*generation, size * sizeof(uint64_t));
+            ogs_assert(*generation);
+        }
+        (*generation)[num++] = v;
+    }
+    closedir(dir);
+
+    if (num)
+        qsort(*generation, num, sizeof(uint64_t), compare_generation);
+
+    return num;
+}
+
+static void remove_logs_before(uint64_t generation)
+{
+    char path[OGS_MAX_FILEPATH_LEN];
+    uint64_t *logs = NULL;
+    int i, num;
+
+    num = list_logs(&logs);
+    for (i = 0; i < num && logs[i] < generation; i++) {
+        log_path(path, sizeof(path), logs[i]);
+        if (unlink(path) != 0)
+            ogs_log_message(OGS_LOG_WARN, ogs_errno,
+                    "unlink(%s) failed", path);
+    }
+    if (logs)
+        ogs_free(logs);
+}
+
+/*
+ * Applies the records in a file and returns how many were applied.
+ * A torn record ends the file: it is the tail that was being written
+ * when the BSF stopped.
+ */
+static int64_t load_file(const char *path, uint64_t *generation)
+{
+    int fd;
+    struct stat st;
+    const uint8_t *data = NULL, *p, *end;
+    size_t len;
+    int64_t num = 0;
+    bool completed = false;
+    int rv;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        if (errno != ENOENT)
+            ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                    "open(%s) failed", path);
+        return -1;
+    }
+
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno, "mmap(%s) failed", path);
+        return -1;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise((void *)data, st.st_size, MADV_SEQUENTIAL);
+#endif
+
+    p = data;
+    end = data + st.st_size;
+
+    if (generation) {
+        if (end - p < SNAPSHOT_HEADER_LEN ||
+            memcmp(p, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN) != 0) {
+            ogs_error("Invalid binding snapshot [%s]", path);
+            munmap((void *)data, st.st_size);
+            return -1;
+        }
+        *generation = get_u64(p + SNAPSHOT_MAGIC_LEN);
+        p += SNAPSHOT_HEADER_LEN;
+    }
+
+    while (p < end) {
+        rv = bsf_binding_record_parse(p, end - p, &len);
+        if (rv != 1) {
+            ogs_warn("[%s] truncated at offset %lld",
+                    path, (long long)(p - data));
+            break;
+        }
+        if (p[BSF_BINDING_RECORD_HEADER_LEN] == BSF_BINDING_RECORD_END) {
+            completed = true;
+            break;
+        }
+        if (apply_record(p, len) == OGS_OK)
+            num++;
+        p += len;
+    }
+
+    if (generation && !completed)
+        ogs_error("Binding snapshot [%s] is incomplete", path);
+
+    munmap((void *)data, st.st_size);
+
+    return num;
+}
+
+static int open_log(uint64_t generation)
+{
+    char path[OGS_MAX_FILEPATH_LEN];
+    int fd;
+
+    log_path(path, sizeof(path), generation);
+    fd = open(path, O_WRONLY|O_CREAT|O_APPEND, 0600);
+    if (fd < 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno, "open(%s) failed", path);
+        return OGS_ERROR;
+    }
+
+    if (store.log_fd >= 0)
+        close(store.log_fd);
+    store.log_fd = fd;
+    store.generation = generation;
+
+    return OGS_OK;
+}
+
+static void flush(void)
+{
+    if (store.log.len) {
+        ogs_assert(store.log_fd >= 0);
+        if (write_all(store.log_fd, store.log.data, store.log.len) != OGS_OK)
+            ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                    "Cannot write %d bytes of bindings", (int)store.log.len);
+        else if (bsf_self()->store.fsync)
+            fsync(store.log_fd);
+        store.log.len = 0;
+    }
+
+    if (store.ship.len) {
+        bsf_replication_ship(store.ship.data, store.ship.len);
+        store.ship.len = 0;
+    }
+}
+
+/*
+ * Runs in the snapshot child. It owns a copy-on-write image of the
+ * context, so it walks the sessions without locking, but it must not
+ * allocate or log since another thread of the parent may have held a
+ * lock at fork().
+ */
+static int snapshot_append(int fd, size_t *used, uint8_t op,
+        bsf_sess_t *sess, bsf_binding_tombstone_t *tombstone)
+{
+    uint8_t *buf = store.snapshot_buf;
+    size_t len;
+
+    len = tombstone ?
+        bsf_binding_tombstone_record_build(tombstone,
+                buf + *used, WRITE_BUFFER_SIZE - *used) :
+        bsf_binding_record_build(op,
+                sess, buf + *used, WRITE_BUFFER_SIZE - *used);
+    if (!len) {
+        if (write_all(fd, buf, *used) != OGS_OK)
+            return OGS_ERROR;
+        *used = 0;
+        len = tombstone ?
+            bsf_binding_tombstone_record_build(tombstone,
+                    buf, WRITE_BUFFER_SIZE) :
+            bsf_binding_record_build(op, sess, buf, WRITE_BUFFER_SIZE);
+    }
+    *used += len;
+
+    return OGS_OK;
+}
+
+static int write_snapshot(uint64_t generation)
+{
+    bsf_sess_t *sess = NULL;
+    bsf_binding_tombstone_t *tombstone = NULL;
+    uint8_t *buf = store.snapshot_buf;
+    size_t used = 0;
+    int fd, dir;
+
+    fd = open(store.snapshot_tmp_path, O_WRONLY|O_CREAT|O_TRUNC, 0600);
+    if (fd < 0)
+        return OGS_ERROR;
+
+    memcpy(buf, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN);
+    put_u64(buf + SNAPSHOT_MAGIC_LEN, generation);
+    used = SNAPSHOT_HEADER_LEN;
+
+    ogs_list_for_each(&bsf_self()->sess_list, sess)
+        if (snapshot_append(fd, &used,
+                    BSF_BINDING_RECORD_PUT, sess, NULL) != OGS_OK)
+            goto error;
+
+    ogs_list_for_each(&store.tombstone_list, tombstone)
+        if (snapshot_append(fd, &used, 0, NULL, tombstone) != OGS_OK)
+            goto error;
+
+    if (snapshot_append(fd, &used,
+                BSF_BINDING_RECORD_END, NULL, NULL) != OGS_OK)
+        goto error;
+
+    if (write_all(fd, buf, used) != OGS_OK || fsync(fd) != 0)
+        goto error;
+    close(fd);
+
+    if (rename(store.snapshot_tmp_path, store.snapshot_path) != 0)
+        return OGS_ERROR;
+
+    dir = open(bsf_self()->store.path, O_RDONLY);
+    if (dir >= 0) {
+        fsync(dir);
+        close(dir);
+    }
+
+    return OGS_OK;
+
+error:
+    close(fd);
+    unlink(store.snapshot_tmp_path);
+    return OGS_ERROR;
+}
+
+static void start_snapshot(void)
+{
+    pid_t pid;
+
+    flush();
+
+    if (open_log(store.generation + 1) != OGS_OK)
+        return;
+
+    pid = fork();
+    if (pid < 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno, "fork() failed");
+        return;
+    }
+    if (pid == 0)
+        _exit(write_snapshot(store.generation) == OGS_OK ? 0 : 1);
+
+    store.snapshot_pid = pid;
+    store.snapshot_generation = store.generation;
+    store.num_of_record = 0;
+}
+
+static void reap_snapshot(bool wait)
+{
+    pid_t pid;
+    int status = 0;
+
+    if (!store.snapshot_pid)
+        return;
+
+    pid = waitpid(store.snapshot_pid, &status, wait ? 0 : WNOHANG);
+    if (pid == 0)
+        return;
+
+    store.snapshot_pid = 0;
+
+    if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        ogs_error("Binding snapshot [generation:%llu] failed",
+                (unsigned long long)store.snapshot_generation);
+        return;
+    }
+
+    ogs_debug("Binding snapshot [generation:%llu] written",
+            (unsigned long long)store.snapshot_generation);
+    remove_logs_before(store.snapshot_generation);
+}
+
+static void flush_timeout(void *data)
+{
+    flush();
+    reap_snapshot(false);
+    tombstone_expire();
+
+    if (store.log_fd >= 0 && !store.snapshot_pid &&
+        bsf_self()->store.snapshot_threshold &&
+        store.num_of_record >= bsf_self()->store.snapshot_threshold)
+        start_snapshot();
+
+    ogs_timer_start(store.t_flush, bsf_self()->store.flush_interval);
+}
+
+static int restore(void)
+{
+    char path[OGS_MAX_FILEPATH_LEN];
+    uint64_t generation = 0, *logs = NULL;
+    int64_t num;
+    int i, num_of_log;
+    ogs_time_t started = ogs_get_monotonic_time();
+
+    if (mkdir(bsf_self()->store.path, 0700) != 0 && errno != EEXIST) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                "mkdir(%s) failed", bsf_self()->store.path);
+        return OGS_ERROR;
+    }
+
+    ogs_snprintf(store.snapshot_path, sizeof(store.snapshot_path),
+            "%s/binding.snapshot", bsf_self()->store.path);
+    ogs_snprintf(store.snapshot_tmp_path, sizeof(store.snapshot_tmp_path),
+            "%s/binding.snapshot.tmp", bsf_self()->store.path);
+
+    load_file(store.snapshot_path, &generation);
+
+    num_of_log = list_logs(&logs);
+    for (i = 0; i < num_of_log; i++) {
+        if (logs[i] < generation)
+            continue;
+
+        log_path(path, sizeof(path), logs[i]);
+        num = load_file(path, NULL);
+        if (num > 0)
+            store.num_of_record += num;
+        generation = logs[i] + 1;
+    }
+    if (logs)
+        ogs_free(logs);
+
+    if (open_log(generation) != OGS_OK)
+        return OGS_ERROR;
+
+    ogs_info("Restored %d bindings in %lld ms",
+            ogs_list_count(&bsf_self()->sess_list),
+            (long long)ogs_time_to_msec(ogs_get_monotonic_time() - started));
+
+    return OGS_OK;
+}
+
+int bsf_binding_store_open(void)
+{
+    int rv;
+
+    if (!bsf_self()->store.path && !bsf_replication_is_enabled())
+        return OGS_OK;
+
+    do {
+        store.origin = ogs_random32();
+    } while (!store.origin);
+
+    ogs_list_init(&store.tombstone_list);
+    if (bsf_replication_is_enabled()) {
+        store.tombstone_hash = ogs_hash_make();
+        ogs_assert(store.tombstone_hash);
+    }
+
+    if (bsf_self()->store.path) {
+        store.snapshot_buf = ogs_malloc(WRITE_BUFFER_SIZE);
+        ogs_assert(store.snapshot_buf);
+
+        rv = restore();
+        if (rv != OGS_OK)
+            return rv;
+    }
+
+    store.t_flush = ogs_timer_add(ogs_app()->timer_mgr, flush_timeout, NULL);
+    ogs_assert(store.t_flush);
+    ogs_timer_start(store.t_flush, bsf_self()->store.flush_interval);
+
+    store.opened = true;
+
+    return OGS_OK;
+}
+
+void bsf_binding_store_close(void)
+{
+    if (!store.opened)
+        return;
+
+    ogs_timer_delete(store.t_flush);
+
+    flush();
+    reap_snapshot(true);
+
+    if (store.log_fd >= 0) {
+        fsync(store.log_fd);
+        close(store.log_fd);
+        store.log_fd = -1;
+    }
+
+    buffer_free(&store.log);
+    buffer_free(&store.ship);
+
+    if (store.tombstone_hash) {
+        bsf_binding_tombstone_t *tombstone = NULL, *next_tombstone = NULL;
+
+        ogs_list_for_each_safe(&store.tombstone_list,
+                next_tombstone, tombstone)
+            tombstone_remove(tombstone);
+        ogs_hash_destroy(store.tombstone_hash);
+        store.tombstone_hash = NULL;
+    }
+
+    if (store.snapshot_buf)
+        ogs_free(store.snapshot_buf);
+    store.snapshot_buf = NULL;
+
+    store.opened = false;
+}
+
+static void append(const uint8_t *record, size_t len, bool local)
+{
+    if (store.log_fd >= 0) {
+        buffer_append(&store.log, record, len);
+        store.num_of_record++;
+    }
+    if (local && bsf_replication_is_enabled())
+        buffer_append(&store.ship, record, len);
+
+    if (store.log.len >= WRITE_BUFFER_SIZE ||
+        store.ship.len >= WRITE_BUFFER_SIZE)
+        flush();
+}
+
+static void store_local(uint8_t op, bsf_sess_t *sess)
+{
+    size_t len;
+
+    ogs_assert(sess);
+
+    if (!store.opened)
+        return;
+
+    sess->stamp.generation = ++store.clock;
+    sess->stamp.origin = store.origin;
+
+    len = bsf_binding_record_build(op, sess, record_buf, sizeof(record_buf));
+    if (!len) {
+        ogs_error("Binding [%s] does not fit in a record", sess->binding_id);
+        return;
+    }
+
+    append(record_buf, len, true);
+}
+
+void bsf_binding_store_put(bsf_sess_t *sess)
+{
+    store_local(BSF_BINDING_RECORD_PUT, sess);
+}
+
+void bsf_binding_store_del(bsf_sess_t *sess)
+{
+    store_local(BSF_BINDING_RECORD_DEL, sess);
+
+    if (store.opened)
+        tombstone_set(sess->binding_id,
+                sess->stamp.generation, sess->stamp.origin);
+}
+
+/*
+ * Applies a record received from a replication peer. It is logged so
+ * that it survives a restart, but not shipped again. A record that
+ * lost against a newer stamp returns OGS_DONE and is dropped.
+ */
+int bsf_binding_store_apply(const uint8_t *record, size_t len)
+{
+    int rv;
+
+    ogs_assert(record);
+    ogs_assert(len > BSF_BINDING_RECORD_HEADER_LEN);
+
+    rv = apply_record(record, len);
+    if (rv != OGS_OK)
+        return rv;
+
+    if (store.opened &&
+        record[BSF_BINDING_RECORD_HEADER_LEN] != BSF_BINDING_RECORD_END)
+        append(record, len, false);
+
+    return OGS_OK;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BSF_BINDING_STORE_H
+#define BSF_BINDING_STORE_H
+
+#include "context.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A binding is stored as one self-delimiting record:
+ *
+ *   length(4) | checksum(4) | op(1) | TLV...
+ *
+ * length and checksum cover everything after the checksum. The same
+ * records make up the snapshot, the write-behind logs and the stream
+ * sent to replication peers.
+ */
+#define BSF_BINDING_RECORD_HEADER_LEN   8
+#define BSF_BINDING_RECORD_MAX_LEN      65536
+
+typedef enum {
+    BSF_BINDING_RECORD_PUT = 1,
+    BSF_BINDING_RECORD_DEL,
+    BSF_BINDING_RECORD_END,
+} bsf_binding_record_op_e;
+
+/*
+ * A deleted binding, kept for the tombstone_retention of the
+ * replication so that a peer that missed the delete learns of it when it
+ * is synchronized, and an older record cannot bring the binding back.
+ */
+typedef struct bsf_binding_tombstone_s {
+    ogs_lnode_t lnode;
+
+    char *binding_id;
+    struct {
+        uint64_t generation;
+        uint32_t origin;
+    } stamp;
+
+    ogs_time_t removed;
+} bsf_binding_tombstone_t;
+
+size_t bsf_binding_record_build(uint8_t op,
+        bsf_sess_t *sess, uint8_t *buf, size_t size);
+size_t bsf_binding_tombstone_record_build(
+        bsf_binding_tombstone_t *tombstone, uint8_t *buf, size_t size);
+int bsf_binding_record_parse(
+        const uint8_t *buf, size_t len, size_t *record_len);
+
+int bsf_binding_store_open(void);
+void bsf_binding_store_close(void);
+
+void bsf_binding_store_put(bsf_sess_t *sess);
+void bsf_binding_store_del(bsf_sess_t *sess);
+int bsf_binding_store_apply(const uint8_t *record, size_t len);
+
+ogs_list_t *bsf_binding_tombstone_list(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BSF_BINDING_STORE_H */
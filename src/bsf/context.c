@@ -18,6 +18,7 @@
  */
 
 #include "context.h"
+#include "replication.h"
 
 static bsf_context_t self;
 
@@ -27,6 +28,32 @@ static OGS_POOL(bsf_sess_pool, bsf_sess_t);
 
 static int context_initialized = 0;
 
+static uint32_t binding_id_prefix;
+static uint32_t binding_id_counter;
+
+/*
+ * UE addresses and Binding IDs of neighbouring bindings differ only in
+ * their last bytes, which the default times-33 hash folds into a few
+ * thousand buckets once there are millions of bindings. FNV-1a spreads
+ * them over the whole table.
+ */
+static unsigned int binding_hashfunc(const char *key, int *klen)
+{
+    const unsigned char *p = (const unsigned char *)key;
+    unsigned int hash = 2166136261U;
+    int i;
+
+    if (*klen == OGS_HASH_KEY_STRING)
+        *klen = strlen(key);
+
+    for (i = 0; i < *klen; i++) {
+        hash ^= p[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
 void bsf_context_init(void)
 {
     ogs_assert(context_initialized == 0);
@@ -36,11 +63,20 @@ void bsf_context_init(void)
 
     ogs_log_install_domain(&__bsf_log_domain, "bsf", ogs_core()->log.level);
 
-    ogs_pool_init(&bsf_sess_pool, ogs_app()->pool.sess);
+    ogs_pool_init_elastic(&bsf_sess_pool, ogs_app()->pool.sess);
+
+    /*
+     * The prefix keeps the Binding IDs of BSF instances that share their
+     * bindings, and of restarts of one instance, from colliding.
+     */
+    binding_id_prefix = ogs_random32();
+    binding_id_counter = 0;
 
-    self.ipv4addr_hash = ogs_hash_make();
+    self.binding_id_hash = ogs_hash_make_custom(binding_hashfunc);
+    ogs_assert(self.binding_id_hash);
+    self.ipv4addr_hash = ogs_hash_make_custom(binding_hashfunc);
     ogs_assert(self.ipv4addr_hash);
-    self.ipv6prefix_hash = ogs_hash_make();
+    self.ipv6prefix_hash = ogs_hash_make_custom(binding_hashfunc);
     ogs_assert(self.ipv6prefix_hash);
 
     context_initialized = 1;
@@ -48,10 +84,14 @@ void bsf_context_init(void)
 
 void bsf_context_final(void)
 {
+    int i;
+
     ogs_assert(context_initialized == 1);
 
     bsf_sess_remove_all();
 
+    ogs_assert(self.binding_id_hash);
+    ogs_hash_destroy(self.binding_id_hash);
     ogs_assert(self.ipv4addr_hash);
     ogs_hash_destroy(self.ipv4addr_hash);
     ogs_assert(self.ipv6prefix_hash);
@@ -59,6 +99,13 @@ void bsf_context_final(void)
 
     ogs_pool_final(&bsf_sess_pool);
 
+    if (self.store.path)
+        ogs_free(self.store.path);
+    if (self.replication.server)
+        ogs_freeaddrinfo(self.replication.server);
+    for (i = 0; i < self.replication.num_of_peer; i++)
+        ogs_freeaddrinfo(self.replication.peer[i]);
+
     context_initialized = 0;
 }
 
@@ -69,14 +116,90 @@ bsf_context_t *bsf_self(void)
 
 static int bsf_context_prepare(void)
 {
+    self.store.flush_interval = ogs_time_from_msec(100);
+    self.store.snapshot_threshold = 100000;
+    self.replication.tombstone_retention = ogs_time_from_sec(86400);
+
     return OGS_OK;
 }
 
 static int bsf_context_validation(void)
 {
+    if (self.store.flush_interval <= 0) {
+        ogs_error("Invalid bsf.binding.store.flush_interval in '%s'",
+                ogs_app()->file);
+        return OGS_ERROR;
+    }
+    if (self.replication.tombstone_retention <= 0) {
+        ogs_error("Invalid bsf.binding.replication.tombstone_retention "
+                "in '%s'", ogs_app()->file);
+        return OGS_ERROR;
+    }
+
     return OGS_OK;
 }
 
+#define BSF_DEFAULT_REPLICATION_PORT 7790
+
+/*
+ * Accepts a single {address, port} mapping or a sequence of them and
+ * stores each one as its own address list.
+ */
+static int parse_replication_address(
+        ogs_yaml_iter_t *parent, ogs_sockaddr_t **addr, int max)
+{
+    int rv, num = 0;
+    ogs_yaml_iter_t array_iter, iter;
+
+    ogs_yaml_iter_recurse(parent, &array_iter);
+    do {
+        const char *hostname = NULL;
+        uint16_t port = BSF_DEFAULT_REPLICATION_PORT;
+
+        if (ogs_yaml_iter_type(&array_iter) == YAML_MAPPING_NODE) {
+            memcpy(&iter, &array_iter, sizeof(ogs_yaml_iter_t));
+        } else if (ogs_yaml_iter_type(&array_iter) == YAML_SEQUENCE_NODE) {
+            if (!ogs_yaml_iter_next(&array_iter))
+                break;
+            ogs_yaml_iter_recurse(&array_iter, &iter);
+        } else if (ogs_yaml_iter_type(&array_iter) == YAML_SCALAR_NODE) {
+            break;
+        } else
+            ogs_assert_if_reached();
+
+        while (ogs_yaml_iter_next(&iter)) {
+            const char *key = ogs_yaml_iter_key(&iter);
+            ogs_assert(key);
+            if (!strcmp(key, "address")) {
+                hostname = ogs_yaml_iter_value(&iter);
+            } else if (!strcmp(key, "port")) {
+                const char *v = ogs_yaml_iter_value(&iter);
+                if (v) port = atoi(v);
+            } else
+                ogs_warn("unknown key `%s`", key);
+        }
+
+        if (!hostname) {
+            ogs_error("No replication address");
+            return OGS_ERROR;
+        }
+        if (num >= max) {
+            ogs_error("Too many replication addresses [%d]", max);
+            return OGS_ERROR;
+        }
+
+        rv = ogs_addaddrinfo(&addr[num], AF_UNSPEC, hostname, port, 0);
+        if (rv != OGS_OK) {
+            ogs_error("ogs_addaddrinfo(%s) failed", hostname);
+            return rv;
+        }
+        num++;
+
+    } while (ogs_yaml_iter_type(&array_iter) == YAML_SEQUENCE_NODE);
+
+    return num;
+}
+
 int bsf_context_parse_config(void)
 {
     int rv;
@@ -113,6 +236,79 @@ int bsf_context_parse_config(void)
                     /* handle config in sbi library */
                 } else if (!strcmp(bsf_key, "discovery")) {
                     /* handle config in sbi library */
+                } else if (!strcmp(bsf_key, "binding")) {
+                    ogs_yaml_iter_t binding_iter;
+                    ogs_yaml_iter_recurse(&bsf_iter, &binding_iter);
+                    while (ogs_yaml_iter_next(&binding_iter)) {
+                        const char *binding_key =
+                            ogs_yaml_iter_key(&binding_iter);
+                        ogs_assert(binding_key);
+                        if (!strcmp(binding_key, "store")) {
+                            ogs_yaml_iter_t store_iter;
+                            ogs_yaml_iter_recurse(&binding_iter, &store_iter);
+                            while (ogs_yaml_iter_next(&store_iter)) {
+                                const char *store_key =
+                                    ogs_yaml_iter_key(&store_iter);
+                                const char *v =
+                                    ogs_yaml_iter_value(&store_iter);
+                                ogs_assert(store_key);
+                                if (!strcmp(store_key, "path")) {
+                                    if (v) {
+                                        if (self.store.path)
+                                            ogs_free(self.store.path);
+                                        self.store.path = ogs_strdup(v);
+                                        ogs_assert(self.store.path);
+                                    }
+                                } else if (!strcmp(store_key,
+                                            "flush_interval")) {
+                                    if (v)
+                                        self.store.flush_interval =
+                                            ogs_time_from_msec(atoll(v));
+                                } else if (!strcmp(store_key, "fsync")) {
+                                    self.store.fsync =
+                                        ogs_yaml_iter_bool(&store_iter);
+                                } else if (!strcmp(store_key,
+                                            "snapshot_threshold")) {
+                                    if (v)
+                                        self.store.snapshot_threshold =
+                                            atoll(v);
+                                } else
+                                    ogs_warn("unknown key `%s`", store_key);
+                            }
+                        } else if (!strcmp(binding_key, "replication")) {
+                            ogs_yaml_iter_t replication_iter;
+                            ogs_yaml_iter_recurse(
+                                    &binding_iter, &replication_iter);
+                            while (ogs_yaml_iter_next(&replication_iter)) {
+                                const char *replication_key =
+                                    ogs_yaml_iter_key(&replication_iter);
+                                ogs_assert(replication_key);
+                                if (!strcmp(replication_key, "server")) {
+                                    rv = parse_replication_address(
+                                            &replication_iter,
+                                            &self.replication.server, 1);
+                                    if (rv < 0) return rv;
+                                } else if (!strcmp(replication_key, "peer")) {
+                                    rv = parse_replication_address(
+                                            &replication_iter,
+                                            self.replication.peer,
+                                            BSF_MAX_NUM_OF_REPLICATION_PEER);
+                                    if (rv < 0) return rv;
+                                    self.replication.num_of_peer = rv;
+                                } else if (!strcmp(replication_key,
+                                            "tombstone_retention")) {
+                                    const char *v = ogs_yaml_iter_value(
+                                            &replication_iter);
+                                    if (v)
+                                        self.replication.tombstone_retention =
+                                            ogs_time_from_sec(atoll(v));
+                                } else
+                                    ogs_warn("unknown key `%s`",
+                                            replication_key);
+                            }
+                        } else
+                            ogs_warn("unknown key `%s`", binding_key);
+                    }
                 } else
                     ogs_warn("unknown key `%s`", bsf_key);
             }
@@ -125,7 +321,7 @@ int bsf_context_parse_config(void)
     return OGS_OK;
 }
 
-bsf_sess_t *bsf_sess_add_by_ip_address(
+static bsf_sess_t *sess_add(char *binding_id,
             char *ipv4addr_string, char *ipv6prefix_string)
 {
     bsf_sess_t *sess = NULL;
@@ -157,27 +353,56 @@ bsf_sess_t *bsf_sess_add_by_ip_address(
     OGS_SBI_FEATURES_SET(sess->management_features,
             OGS_SBI_NBSF_MANAGEMENT_BINDING_UPDATE);
 
-    sess->binding_id = ogs_msprintf("%d",
-            (int)ogs_pool_index(&bsf_sess_pool, sess));
+    if (binding_id)
+        sess->binding_id = ogs_strdup(binding_id);
+    else
+        sess->binding_id = ogs_msprintf("%08x%08x",
+                binding_id_prefix, ++binding_id_counter);
     ogs_assert(sess->binding_id);
 
+    ogs_hash_set(self.binding_id_hash,
+            sess->binding_id, OGS_HASH_KEY_STRING, sess);
+
     ogs_list_add(&self.sess_list, sess);
 
     return sess;
 }
 
+bsf_sess_t *bsf_sess_add_by_ip_address(
+            char *ipv4addr_string, char *ipv6prefix_string)
+{
+    return sess_add(NULL, ipv4addr_string, ipv6prefix_string);
+}
+
+/*
+ * Adds a binding that was created earlier, by this instance before a
+ * restart or by a replication peer, under its original Binding ID.
+ */
+bsf_sess_t *bsf_sess_add_by_binding_id(char *binding_id,
+            char *ipv4addr_string, char *ipv6prefix_string)
+{
+    ogs_assert(binding_id);
+    ogs_assert(!ogs_hash_get(self.binding_id_hash,
+                binding_id, OGS_HASH_KEY_STRING));
+
+    return sess_add(binding_id, ipv4addr_string, ipv6prefix_string);
+}
+
 void bsf_sess_remove(bsf_sess_t *sess)
 {
     int i;
 
     ogs_assert(sess);
 
+    bsf_replication_sess_remove(sess);
     ogs_list_remove(&self.sess_list, sess);
 
     /* Free SBI object memory */
     ogs_sbi_object_free(&sess->sbi);
 
     ogs_assert(sess->binding_id);
+    ogs_hash_set(self.binding_id_hash,
+            sess->binding_id, OGS_HASH_KEY_STRING, NULL);
     ogs_free(sess->binding_id);
 
     if (sess->supi)
@@ -310,7 +535,7 @@ bsf_sess_t *bsf_sess_find_by_snssai_and_dnn(ogs_s_nssai_t *s_nssai, char *dnn)
 bsf_sess_t *bsf_sess_find_by_binding_id(char *binding_id)
 {
     ogs_assert(binding_id);
-    return bsf_sess_find(atoll(binding_id));
+    return ogs_hash_get(self.binding_id_hash, binding_id, OGS_HASH_KEY_STRING);
 }
 
 bsf_sess_t *bsf_sess_find_by_ipv4addr(char *ipv4addr_string)
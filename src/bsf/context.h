@@ -34,11 +34,32 @@ extern int __bsf_log_domain;
 #undef OGS_LOG_DOMAIN
 #define OGS_LOG_DOMAIN __bsf_log_domain
 
+#define BSF_MAX_NUM_OF_REPLICATION_PEER 8
+
 typedef struct bsf_context_s {
+    ogs_hash_t          *binding_id_hash;
     ogs_hash_t          *ipv4addr_hash;
     ogs_hash_t          *ipv6prefix_hash;
 
     ogs_list_t          sess_list;
+
+    struct {
+        /* Directory of the snapshot and the logs, NULL if not persisted */
+        char            *path;
+        ogs_time_t      flush_interval;
+        bool            fsync;
+        uint64_t        snapshot_threshold;
+    } store;
+
+    struct {
+        ogs_sockaddr_t  *server;
+
+        int             num_of_peer;
+        ogs_sockaddr_t  *peer[BSF_MAX_NUM_OF_REPLICATION_PEER];
+
+        /* How long a deleted binding is remembered for the peers */
+        ogs_time_t      tombstone_retention;
+    } replication;
 } bsf_context_t;
 
 typedef struct bsf_sess_s {
@@ -78,6 +99,15 @@ typedef struct bsf_sess_s {
     /* SBI Features */
     uint64_t management_features;
 
+    /*
+     * Version of the binding across the BSF instances sharing it:
+     * a Lamport clock and the instance that wrote it last.
+     */
+    struct {
+        uint64_t generation;
+        uint32_t origin;
+    } stamp;
+
 } bsf_sess_t;
 
 void bsf_context_init(void);
@@ -88,6 +118,8 @@ int bsf_context_parse_config(void);
 
 bsf_sess_t *bsf_sess_add_by_ip_address(
             char *ipv4addr_string, char *ipv6prefix_string);
+bsf_sess_t *bsf_sess_add_by_binding_id(char *binding_id,
+            char *ipv4addr_string, char *ipv6prefix_string);
 void bsf_sess_remove(bsf_sess_t *sess);
 void bsf_sess_remove_all(void);
 
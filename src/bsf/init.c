@@ -19,6 +19,8 @@
 
 #include "context.h"
 #include "sbi-path.h"
+#include "binding-store.h"
+#include "replication.h"
 
 static ogs_thread_t *thread;
 static void bsf_main(void *data);
@@ -46,6 +48,12 @@ int bsf_initialize(void)
     rv = bsf_context_parse_config();
     if (rv != OGS_OK) return rv;
 
+    rv = bsf_binding_store_open();
+    if (rv != OGS_OK) return rv;
+
+    rv = bsf_replication_open();
+    if (rv != OGS_OK) return rv;
+
     rv = bsf_sbi_open();
     if (rv != 0) return OGS_ERROR;
 
@@ -89,16 +97,26 @@ void bsf_terminate(void)
 
     bsf_sbi_close();
 
+    bsf_binding_store_close();
+    bsf_replication_close();
+
     bsf_context_final();
 
     ogs_sbi_context_final();
 }
 
+static const char *bsf_prof_event_name(void *event)
+{
+    return bsf_event_get_name(event);
+}
+
 static void bsf_main(void *data)
 {
     ogs_fsm_t bsf_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            bsf_prof_event_name);
     ogs_fsm_init(&bsf_sm, bsf_state_initial, bsf_state_final, 0);
 
     for ( ;; ) {
@@ -118,10 +136,14 @@ static void bsf_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            bsf_event_t *e = NULL;
+            bsf_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -130,9 +152,11 @@ static void bsf_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&bsf_sm, e);
-            ogs_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&bsf_sm, e[i]);
+                ogs_event_free(e[i]);
+            }
         }
     }
 done:
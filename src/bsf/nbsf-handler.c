@@ -19,6 +19,7 @@
 
 #include "sbi-path.h"
 #include "nbsf-handler.h"
+#include "binding-store.h"
 
 bool bsf_nbsf_management_handle_pcf_binding(
         bsf_sess_t *sess, ogs_sbi_stream_t *stream, ogs_sbi_message_t *recvmsg)
@@ -52,6 +53,7 @@ bool bsf_nbsf_management_handle_pcf_binding(
 
             ogs_free(sendmsg.http.location);
 
+            bsf_binding_store_del(sess);
             bsf_sess_remove(sess);
             break;
 
@@ -218,6 +220,8 @@ bool bsf_nbsf_management_handle_pcf_binding(
             ogs_assert(true == ogs_sbi_server_send_response(stream, response));
 
             ogs_free(sendmsg.http.location);
+
+            bsf_binding_store_put(sess);
             break;
 
         CASE(OGS_SBI_HTTP_METHOD_GET)
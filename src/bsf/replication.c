@@ -0,0 +1,564 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "replication.h"
+#include "binding-store.h"
+
+/*
+ * Log shipping between BSF instances that serve the same UEs.
+ *
+ * Every instance connects to the peers it is configured with and sends
+ * them the records of the bindings it created or deleted itself; its
+ * server accepts the same stream from the configured peers only. When
+ * a connection is (re)established, the tombstones of the deleted
+ * bindings and the full set of bindings are sent first, so a peer that
+ * was down catches up without a separate transfer. Records received from a peer are applied and logged but
+ * never shipped on, so every instance must list all the others.
+ *
+ * The sockets are non-blocking. Records wait in a per-peer send queue
+ * that is written when the socket polls writable, and the full set is
+ * queued a chunk at a time as the queue drains. A peer whose queue
+ * grows past MAX_SEND_QUEUE_SIZE is disconnected and synchronized from
+ * scratch when it is reconnected.
+ */
+
+#define CONNECT_DELAY           ogs_time_from_msec(10)
+#define RECONNECT_INTERVAL      ogs_time_from_sec(3)
+#define SYNC_CHUNK_SIZE         (256*1024)
+#define MAX_SEND_QUEUE_SIZE     (64*1024*1024)
+
+typedef struct replication_peer_s {
+    ogs_sockaddr_t *addr;
+
+    ogs_sock_t *sock;
+    bool connected;
+    struct {
+        ogs_poll_t *read;
+        ogs_poll_t *write;
+    } poll;
+
+    struct {
+        uint8_t *data;
+        size_t len;
+        size_t size;
+        size_t sent;
+    } queue;
+
+    /* Next record of the full set to queue, NULL once all are queued */
+    bsf_binding_tombstone_t *sync_tombstone;
+    bsf_sess_t *sync;
+
+    ogs_timer_t *t_connect;
+} replication_peer_t;
+
+typedef struct replication_conn_s {
+    ogs_lnode_t lnode;
+
+    ogs_sock_t *sock;
+    ogs_poll_t *poll;
+
+    size_t len;
+    uint8_t buf[2*BSF_BINDING_RECORD_MAX_LEN];
+} replication_conn_t;
+
+static ogs_sock_t *server;
+static ogs_poll_t *server_poll;
+
+static ogs_list_t conn_list;
+
+static int num_of_peer;
+static replication_peer_t peer[BSF_MAX_NUM_OF_REPLICATION_PEER];
+
+static uint8_t record_buf[BSF_BINDING_RECORD_MAX_LEN];
+
+static void peer_send(short when, ogs_socket_t fd, void *data);
+
+static bool queue_append(replication_peer_t *p, const uint8_t *buf, size_t len)
+{
+    if (p->queue.sent) {
+        p->queue.len -= p->queue.sent;
+        memmove(p->queue.data, p->queue.data + p->queue.sent, p->queue.len);
+        p->queue.sent = 0;
+    }
+
+    if (p->queue.len + len > MAX_SEND_QUEUE_SIZE)
+        return false;
+
+    if (p->queue.len + len > p->queue.size) {
+        size_t size = ogs_max(p->queue.size * 2, p->queue.len + len);
+
+        p->queue.data = ogs_realloc(p->queue.data, size);
+        ogs_assert(p->queue.data);
+        p->queue.size = size;
+    }
+
+    memcpy(p->queue.data + p->queue.len, buf, len);
+    p->queue.len += len;
+
+    return true;
+}
+
+static void queue_free(replication_peer_t *p)
+{
+    if (p->queue.data)
+        ogs_free(p->queue.data);
+    memset(&p->queue, 0, sizeof(p->queue));
+}
+
+static void write_arm(replication_peer_t *p)
+{
+    ogs_assert(p->sock);
+
+    if (!p->poll.write) {
+        p->poll.write = ogs_pollset_add(ogs_app()->pollset,
+                OGS_POLLOUT, p->sock->fd, peer_send, p);
+        ogs_assert(p->poll.write);
+    }
+}
+
+static void peer_close(replication_peer_t *p)
+{
+    if (p->poll.read)
+        ogs_pollset_remove(p->poll.read);
+    if (p->poll.write)
+        ogs_pollset_remove(p->poll.write);
+    p->poll.read = p->poll.write = NULL;
+
+    if (p->sock)
+        ogs_sock_destroy(p->sock);
+    p->sock = NULL;
+    p->connected = false;
+    p->sync_tombstone = NULL;
+    p->sync = NULL;
+
+    queue_free(p);
+}
+
+static void peer_disconnect(replication_peer_t *p)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_assert(p);
+
+    if (!p->sock)
+        return;
+
+    ogs_warn("Replication peer [%s]:%d disconnected",
+            OGS_ADDR(p->addr, buf), OGS_PORT(p->addr));
+
+    peer_close(p);
+
+    ogs_timer_start(p->t_connect, RECONNECT_INTERVAL);
+}
+
+/* Queues the next chunk of the tombstones, then of the bindings */
+static void peer_sync(replication_peer_t *p)
+{
+    char buf[OGS_ADDRSTRLEN];
+    size_t len;
+
+    while ((p->sync_tombstone || p->sync) &&
+            p->queue.len - p->queue.sent < SYNC_CHUNK_SIZE) {
+        if (p->sync_tombstone) {
+            len = bsf_binding_tombstone_record_build(p->sync_tombstone,
+                    record_buf, sizeof(record_buf));
+            if (!len)
+                ogs_error("Tombstone [%s] does not fit in a record",
+                        p->sync_tombstone->binding_id);
+            else
+                ogs_assert(queue_append(p, record_buf, len) == true);
+
+            p->sync_tombstone = ogs_list_next(p->sync_tombstone);
+        } else {
+            len = bsf_binding_record_build(BSF_BINDING_RECORD_PUT,
+                    p->sync, record_buf, sizeof(record_buf));
+            if (!len)
+                ogs_error("Binding [%s] does not fit in a record",
+                        p->sync->binding_id);
+            else
+                ogs_assert(queue_append(p, record_buf, len) == true);
+
+            p->sync = ogs_list_next(p->sync);
+        }
+
+        if (!p->sync_tombstone && !p->sync)
+            ogs_info("Replication peer [%s]:%d synchronized",
+                    OGS_ADDR(p->addr, buf), OGS_PORT(p->addr));
+    }
+}
+
+/* The peer never sends anything, so readable means closed */
+static void peer_recv(short when, ogs_socket_t fd, void *data)
+{
+    replication_peer_t *p = data;
+    uint8_t buf[256];
+    ssize_t n;
+
+    ogs_assert(p);
+
+    n = ogs_recv(fd, buf, sizeof(buf), 0);
+    if (n < 0 && (errno == EINTR || ogs_socket_errno == OGS_EAGAIN))
+        return;
+    if (n <= 0)
+        peer_disconnect(p);
+}
+
+static void peer_connected(replication_peer_t *p)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    p->connected = true;
+
+    p->poll.read = ogs_pollset_add(ogs_app()->pollset,
+            OGS_POLLIN, p->sock->fd, peer_recv, p);
+    ogs_assert(p->poll.read);
+
+    ogs_info("Replication peer [%s]:%d connected",
+            OGS_ADDR(p->addr, buf), OGS_PORT(p->addr));
+
+    p->sync_tombstone = ogs_list_first(bsf_binding_tombstone_list());
+    p->sync = ogs_list_first(&bsf_self()->sess_list);
+    peer_sync(p);
+}
+
+static void peer_send(short when, ogs_socket_t fd, void *data)
+{
+    replication_peer_t *p = data;
+    ssize_t n;
+    int flags = 0;
+
+    ogs_assert(p);
+
+#ifdef MSG_NOSIGNAL
+    flags |= MSG_NOSIGNAL;
+#endif
+
+    if (!p->connected) {
+        int err = 0;
+        socklen_t errlen = sizeof(err);
+
+        /* Writable after a non-blocking connect() means it completed */
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errlen) != 0 ||
+            err != 0) {
+            char buf[OGS_ADDRSTRLEN];
+
+            ogs_debug("Replication peer [%s]:%d connect failed [%d]",
+                    OGS_ADDR(p->addr, buf), OGS_PORT(p->addr), err);
+            peer_close(p);
+            ogs_timer_start(p->t_connect, RECONNECT_INTERVAL);
+            return;
+        }
+        peer_connected(p);
+    }
+
+    while (p->queue.sent < p->queue.len) {
+        n = ogs_send(fd, p->queue.data + p->queue.sent,
+                p->queue.len - p->queue.sent, flags);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (ogs_socket_errno == OGS_EAGAIN)
+                return;
+            peer_disconnect(p);
+            return;
+        }
+        p->queue.sent += n;
+
+        if (p->queue.sent == p->queue.len) {
+            p->queue.len = p->queue.sent = 0;
+            peer_sync(p);
+        }
+    }
+
+    ogs_assert(p->poll.write);
+    ogs_pollset_remove(p->poll.write);
+    p->poll.write = NULL;
+}
+
+static void peer_connect(void *data)
+{
+    replication_peer_t *p = data;
+    char buf[OGS_ADDRSTRLEN];
+    int rv;
+
+    ogs_assert(p);
+    ogs_assert(!p->sock);
+
+    p->sock = ogs_sock_socket(p->addr->ogs_sa_family,
+            SOCK_STREAM, IPPROTO_TCP);
+    if (!p->sock)
+        goto retry;
+
+    rv = ogs_nonblocking(p->sock->fd);
+    ogs_assert(rv == OGS_OK);
+    rv = ogs_tcp_nodelay(p->sock->fd, true);
+    ogs_assert(rv == OGS_OK);
+
+    memcpy(&p->sock->remote_addr, p->addr, sizeof(p->sock->remote_addr));
+
+    /* Completion, or failure, is reported by the socket polling writable */
+    if (connect(p->sock->fd, &p->addr->sa, ogs_sockaddr_len(p->addr)) != 0 &&
+        errno != EINPROGRESS) {
+        ogs_log_message(OGS_LOG_DEBUG, ogs_socket_errno,
+                "Replication peer [%s]:%d connect failed",
+                OGS_ADDR(p->addr, buf), OGS_PORT(p->addr));
+        goto retry;
+    }
+
+    write_arm(p);
+    return;
+
+retry:
+    peer_close(p);
+    ogs_timer_start(p->t_connect, RECONNECT_INTERVAL);
+}
+
+static void conn_remove(replication_conn_t *conn)
+{
+    ogs_assert(conn);
+
+    ogs_list_remove(&conn_list, conn);
+
+    ogs_pollset_remove(conn->poll);
+    ogs_sock_destroy(conn->sock);
+    ogs_free(conn);
+}
+
+static void conn_recv(short when, ogs_socket_t fd, void *data)
+{
+    replication_conn_t *conn = data;
+    size_t offset = 0, len;
+    ssize_t n;
+    int rv;
+
+    ogs_assert(conn);
+
+    n = ogs_recv(fd, conn->buf + conn->len,
+            sizeof(conn->buf) - conn->len, 0);
+    if (n <= 0) {
+        if (n < 0 && errno == EINTR)
+            return;
+        conn_remove(conn);
+        return;
+    }
+    conn->len += n;
+
+    while ((rv = bsf_binding_record_parse(conn->buf + offset,
+                    conn->len - offset, &len)) == 1) {
+        bsf_binding_store_apply(conn->buf + offset, len);
+        offset += len;
+    }
+
+    if (rv < 0) {
+        ogs_error("Invalid binding record from replication peer");
+        conn_remove(conn);
+        return;
+    }
+
+    conn->len -= offset;
+    if (conn->len && offset)
+        memmove(conn->buf, conn->buf + offset, conn->len);
+}
+
+static bool is_same_host(ogs_sockaddr_t *a, ogs_sockaddr_t *b)
+{
+    if (a->ogs_sa_family != b->ogs_sa_family)
+        return false;
+
+    if (a->ogs_sa_family == AF_INET)
+        return memcmp(&a->sin.sin_addr, &b->sin.sin_addr,
+                sizeof(struct in_addr)) == 0;
+    if (a->ogs_sa_family == AF_INET6)
+        return memcmp(&a->sin6.sin6_addr, &b->sin6.sin6_addr,
+                sizeof(struct in6_addr)) == 0;
+
+    return false;
+}
+
+/* Only the configured peers may replicate to this instance */
+static bool is_peer(ogs_sockaddr_t *remote)
+{
+    ogs_sockaddr_t *addr = NULL;
+    int i;
+
+    for (i = 0; i < num_of_peer; i++)
+        for (addr = peer[i].addr; addr; addr = addr->next)
+            if (is_same_host(addr, remote))
+                return true;
+
+    return false;
+}
+
+static void server_accept(short when, ogs_socket_t fd, void *data)
+{
+    replication_conn_t *conn = NULL;
+    ogs_sock_t *sock = NULL;
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_assert(data);
+
+    sock = ogs_sock_accept(data);
+    if (!sock) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "ogs_sock_accept() failed");
+        return;
+    }
+
+    if (!is_peer(&sock->remote_addr)) {
+        ogs_warn("Replication from [%s]:%d refused, not a peer",
+                OGS_ADDR(&sock->remote_addr, buf),
+                OGS_PORT(&sock->remote_addr));
+        ogs_sock_destroy(sock);
+        return;
+    }
+
+    conn = ogs_calloc(1, sizeof(*conn));
+    ogs_assert(conn);
+    conn->sock = sock;
+    conn->poll = ogs_pollset_add(ogs_app()->pollset,
+            OGS_POLLIN, sock->fd, conn_recv, conn);
+    ogs_assert(conn->poll);
+
+    ogs_list_add(&conn_list, conn);
+
+    ogs_info("Replication from [%s]:%d",
+            OGS_ADDR(&sock->remote_addr, buf), OGS_PORT(&sock->remote_addr));
+}
+
+bool bsf_replication_is_enabled(void)
+{
+    return bsf_self()->replication.num_of_peer > 0;
+}
+
+int bsf_replication_open(void)
+{
+    char buf[OGS_ADDRSTRLEN];
+    int i;
+
+    ogs_list_init(&conn_list);
+
+    num_of_peer = bsf_self()->replication.num_of_peer;
+    for (i = 0; i < num_of_peer; i++)
+        peer[i].addr = bsf_self()->replication.peer[i];
+
+    if (bsf_self()->replication.server) {
+        if (!num_of_peer)
+            ogs_warn("Replication server without peers refuses everyone");
+
+        server = ogs_tcp_server(bsf_self()->replication.server, NULL);
+        if (!server)
+            return OGS_ERROR;
+
+        server_poll = ogs_pollset_add(ogs_app()->pollset,
+                OGS_POLLIN, server->fd, server_accept, server);
+        ogs_assert(server_poll);
+
+        ogs_info("replication_server() [%s]:%d",
+                OGS_ADDR(bsf_self()->replication.server, buf),
+                OGS_PORT(bsf_self()->replication.server));
+    }
+
+    /* Connect from the BSF thread once it runs */
+    for (i = 0; i < num_of_peer; i++) {
+        peer[i].t_connect = ogs_timer_add(
+                ogs_app()->timer_mgr, peer_connect, &peer[i]);
+        ogs_assert(peer[i].t_connect);
+        ogs_timer_start(peer[i].t_connect, CONNECT_DELAY);
+    }
+
+    return OGS_OK;
+}
+
+void bsf_replication_close(void)
+{
+    replication_conn_t *conn = NULL, *next_conn = NULL;
+    int i;
+
+    for (i = 0; i < num_of_peer; i++) {
+        peer_close(&peer[i]);
+        if (peer[i].t_connect)
+            ogs_timer_delete(peer[i].t_connect);
+        memset(&peer[i], 0, sizeof(peer[i]));
+    }
+    num_of_peer = 0;
+
+    ogs_list_for_each_safe(&conn_list, next_conn, conn)
+        conn_remove(conn);
+
+    if (server) {
+        ogs_pollset_remove(server_poll);
+        ogs_sock_destroy(server);
+        server = NULL;
+    }
+}
+
+/*
+ * Queues the records for every peer that is connected or connecting.
+ * Records queued while connecting go out ahead of the full set, which
+ * the stamps make harmless.
+ */
+void bsf_replication_ship(const uint8_t *buf, size_t len)
+{
+    char addr[OGS_ADDRSTRLEN];
+    int i;
+
+    ogs_assert(buf);
+
+    for (i = 0; i < num_of_peer; i++) {
+        replication_peer_t *p = &peer[i];
+
+        if (!p->sock)
+            continue;
+
+        if (queue_append(p, buf, len) == false) {
+            ogs_warn("Replication peer [%s]:%d is too slow",
+                    OGS_ADDR(p->addr, addr), OGS_PORT(p->addr));
+            peer_disconnect(p);
+            continue;
+        }
+
+        if (p->connected)
+            write_arm(p);
+    }
+}
+
+/* Keeps the full set being queued from visiting a removed binding */
+void bsf_replication_sess_remove(bsf_sess_t *sess)
+{
+    int i;
+
+    ogs_assert(sess);
+
+    for (i = 0; i < num_of_peer; i++)
+        if (peer[i].sync == sess)
+            peer[i].sync = ogs_list_next(sess);
+}
+
+/* Likewise for an expired or superseded tombstone */
+void bsf_replication_tombstone_remove(bsf_binding_tombstone_t *tombstone)
+{
+    int i;
+
+    ogs_assert(tombstone);
+
+    for (i = 0; i < num_of_peer; i++)
+        if (peer[i].sync_tombstone == tombstone)
+            peer[i].sync_tombstone = ogs_list_next(tombstone);
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BSF_REPLICATION_H
+#define BSF_REPLICATION_H
+
+#include "binding-store.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int bsf_replication_open(void);
+void bsf_replication_close(void);
+
+bool bsf_replication_is_enabled(void);
+void bsf_replication_ship(const uint8_t *buf, size_t len);
+void bsf_replication_sess_remove(bsf_sess_t *sess);
+void bsf_replication_tombstone_remove(bsf_binding_tombstone_t *tombstone);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BSF_REPLICATION_H */
@@ -111,7 +111,6 @@ void hss_context_init(void)
     self.impu_hash = ogs_hash_make();
     ogs_assert(self.impu_hash);
 
-    ogs_thread_mutex_init(&self.db_lock);
     ogs_thread_mutex_init(&self.cx_lock);
 
     context_initialized = 1;
@@ -135,7 +134,6 @@ void hss_context_final(void)
     ogs_pool_final(&impi_pool);
     ogs_pool_final(&impu_pool);
 
-    ogs_thread_mutex_destroy(&self.db_lock);
     ogs_thread_mutex_destroy(&self.cx_lock);
 
     context_initialized = 0;
@@ -367,7 +365,9 @@ int hss_context_parse_config(void)
     return OGS_OK;
 }
 
-int hss_db_auth_info(char *imsi_bcd, ogs_dbi_auth_info_t *auth_info)
+/* The stored SQN is advanced in the same round trip */
+int hss_db_auth_info_increment_sqn(
+        char *imsi_bcd, ogs_dbi_auth_info_t *auth_info)
 {
     int rv;
     char *supi = NULL;
@@ -375,14 +375,12 @@ int hss_db_auth_info(char *imsi_bcd, ogs_dbi_auth_info_t *auth_info)
     ogs_assert(imsi_bcd);
     ogs_assert(auth_info);
 
-    ogs_thread_mutex_lock(&self.db_lock);
     supi = ogs_msprintf("%s-%s", OGS_ID_SUPI_TYPE_IMSI, imsi_bcd);
     ogs_assert(supi);
 
-    rv = ogs_dbi_auth_info(supi, auth_info);
+    rv = ogs_dbi_auth_info_increment_sqn(supi, auth_info);
 
     ogs_free(supi);
-    ogs_thread_mutex_unlock(&self.db_lock);
 
     return rv;
 }
@@ -394,14 +392,12 @@ int hss_db_update_sqn(char *imsi_bcd, uint8_t *rand, uint64_t sqn)
 
     ogs_assert(imsi_bcd);
 
-    ogs_thread_mutex_lock(&self.db_lock);
     supi = ogs_msprintf("%s-%s", OGS_ID_SUPI_TYPE_IMSI, imsi_bcd);
     ogs_assert(supi);
 
     rv = ogs_dbi_update_sqn(supi, sqn);
 
     ogs_free(supi);
-    ogs_thread_mutex_unlock(&self.db_lock);
 
     return rv;
 }
@@ -413,14 +409,12 @@ int hss_db_update_imeisv(char *imsi_bcd, char *imeisv)
 
     ogs_assert(imsi_bcd);
 
-    ogs_thread_mutex_lock(&self.db_lock);
     supi = ogs_msprintf("%s-%s", OGS_ID_SUPI_TYPE_IMSI, imsi_bcd);
     ogs_assert(supi);
 
     rv = ogs_dbi_update_imeisv(supi, imeisv);
 
     ogs_free(supi);
-    ogs_thread_mutex_unlock(&self.db_lock);
 
     return rv;
 }
@@ -433,33 +427,12 @@ int hss_db_update_mme(char *imsi_bcd, char *mme_host, char *mme_realm,
 
     ogs_assert(imsi_bcd);
 
-    ogs_thread_mutex_lock(&self.db_lock);
     supi = ogs_msprintf("%s-%s", OGS_ID_SUPI_TYPE_IMSI, imsi_bcd);
     ogs_assert(supi);
 
     rv = ogs_dbi_update_mme(supi, mme_host, mme_realm, purge_flag);
 
     ogs_free(supi);
-    ogs_thread_mutex_unlock(&self.db_lock);
-
-    return rv;
-}
-
-int hss_db_increment_sqn(char *imsi_bcd)
-{
-    int rv;
-    char *supi = NULL;
-
-    ogs_assert(imsi_bcd);
-
-    ogs_thread_mutex_lock(&self.db_lock);
-    supi = ogs_msprintf("%s-%s", OGS_ID_SUPI_TYPE_IMSI, imsi_bcd);
-    ogs_assert(supi);
-
-    rv = ogs_dbi_increment_sqn(supi);
-
-    ogs_free(supi);
-    ogs_thread_mutex_unlock(&self.db_lock);
 
     return rv;
 }
@@ -473,14 +446,12 @@ int hss_db_subscription_data(
     ogs_assert(imsi_bcd);
     ogs_assert(subscription_data);
 
-    ogs_thread_mutex_lock(&self.db_lock);
     supi = ogs_msprintf("%s-%s", OGS_ID_SUPI_TYPE_IMSI, imsi_bcd);
     ogs_assert(supi);
 
     rv = ogs_dbi_subscription_data(supi, subscription_data);
 
     ogs_free(supi);
-    ogs_thread_mutex_unlock(&self.db_lock);
 
     return rv;
 }
@@ -492,12 +463,8 @@ int hss_db_msisdn_data(char *imsi_or_msisdn_bcd, ogs_msisdn_data_t *msisdn_data)
     ogs_assert(imsi_or_msisdn_bcd);
     ogs_assert(msisdn_data);
 
-    ogs_thread_mutex_lock(&self.db_lock);
-
     rv = ogs_dbi_msisdn_data(imsi_or_msisdn_bcd, msisdn_data);
 
-    ogs_thread_mutex_unlock(&self.db_lock);
-
     return rv;
 }
 
@@ -509,14 +476,12 @@ int hss_db_ims_data(char *imsi_bcd, ogs_ims_data_t *ims_data)
     ogs_assert(imsi_bcd);
     ogs_assert(ims_data);
 
-    ogs_thread_mutex_lock(&self.db_lock);
     supi = ogs_msprintf("%s-%s", OGS_ID_SUPI_TYPE_IMSI, imsi_bcd);
     ogs_assert(supi);
 
     rv = ogs_dbi_ims_data(supi, ims_data);
 
     ogs_free(supi);
-    ogs_thread_mutex_unlock(&self.db_lock);
 
     return rv;
 }
@@ -1213,15 +1178,7 @@ static int process_change_stream(const bson_t *document);
 
 int hss_db_poll_change_stream(void)
 {
-    int rv;
-
-    ogs_thread_mutex_lock(&self.db_lock);
-
-    rv = poll_change_stream();
-
-    ogs_thread_mutex_unlock(&self.db_lock);
-
-    return rv;
+    return poll_change_stream();
 }
 
 static int poll_change_stream(void)
@@ -1269,8 +1226,6 @@ static int process_change_stream(const bson_t *document)
         ogs_error("ogs_queue_push() failed:%d", (int)rv);
         bson_destroy(e->dbi.document);
         hss_event_free(e);
-    } else {
-        ogs_pollset_notify(ogs_app()->pollset);
     }
 
     return OGS_OK;
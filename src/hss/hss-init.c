@@ -48,6 +48,9 @@ int hss_initialize(void)
     rv = ogs_metrics_context_parse_config(APP_NAME);
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_app_reload_add("metrics", ogs_metrics_context_reload_config);
+    if (rv != OGS_OK) return rv;
+
     rv = hss_context_parse_config();
     if (rv != OGS_OK) return rv;
 
@@ -85,11 +88,18 @@ void hss_terminate(void)
     return;
 }
 
+static const char *hss_prof_event_name(void *event)
+{
+    return hss_event_get_name(event);
+}
+
 static void hss_main(void *data)
 {
     ogs_fsm_t hss_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            hss_prof_event_name);
     ogs_fsm_init(&hss_sm, hss_state_initial, hss_state_final, 0);
 
     for ( ;; ) {
@@ -109,10 +119,14 @@ static void hss_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            hss_event_t *e = NULL;
+            hss_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -121,9 +135,11 @@ static void hss_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&hss_sm, e);
-            hss_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&hss_sm, e[i]);
+                hss_event_free(e[i]);
+            }
         }
     }
 done:
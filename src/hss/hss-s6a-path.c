@@ -96,6 +96,7 @@ static int hss_ogs_diam_s6a_air_cb( struct msg **msg, struct avp *avp,
     uint8_t mac_s[OGS_MAC_S_LEN];
 
     ogs_dbi_auth_info_t auth_info;
+    bool resync = false;
     uint8_t zero[OGS_RAND_LEN];
     int rv;
     uint32_t result_code = 0;
@@ -119,7 +120,7 @@ static int hss_ogs_diam_s6a_air_cb( struct msg **msg, struct avp *avp,
     ogs_cpystrn(imsi_bcd, (char*)hdr->avp_value->os.data,
         ogs_min(hdr->avp_value->os.len, OGS_MAX_IMSI_BCD_LEN)+1);
 
-    rv = hss_db_auth_info(imsi_bcd, &auth_info);
+    rv = hss_db_auth_info_increment_sqn(imsi_bcd, &auth_info);
     if (rv != OGS_OK) {
         result_code = OGS_DIAM_S6A_ERROR_USER_UNKNOWN;
         goto out;
@@ -154,6 +155,7 @@ static int hss_ogs_diam_s6a_air_cb( struct msg **msg, struct avp *avp,
                 auth_info.sqn = ogs_buffer_to_uint64(sqn, OGS_SQN_LEN);
                 /* 33.102 C.3.4 Guide : IND + 1 */
                 auth_info.sqn = (auth_info.sqn + 32 + 1) & OGS_MAX_SQN;
+                resync = true;
             } else {
                 ogs_error("Re-synch MAC failed for IMSI:`%s`", imsi_bcd);
                 ogs_log_print(OGS_LOG_ERROR, "MAC_S: ");
@@ -170,18 +172,19 @@ static int hss_ogs_diam_s6a_air_cb( struct msg **msg, struct avp *avp,
         }
     }
 
-    rv = hss_db_update_sqn(imsi_bcd, auth_info.rand, auth_info.sqn);
-    if (rv != OGS_OK) {
-        ogs_error("Cannot update rand and sqn for IMSI:'%s'", imsi_bcd);
-        result_code = OGS_DIAM_S6A_AUTHENTICATION_DATA_UNAVAILABLE;
-        goto out;
-    }
-
-    rv = hss_db_increment_sqn(imsi_bcd);
-    if (rv != OGS_OK) {
-        ogs_error("Cannot increment sqn for IMSI:'%s'", imsi_bcd);
-        result_code = OGS_DIAM_S6A_AUTHENTICATION_DATA_UNAVAILABLE;
-        goto out;
+    /*
+     * The stored SQN was already advanced when Auth-Info was read; only a
+     * re-synchronization has to move it again, to SQN_MS + 32 as verified
+     * from AUTS.
+     */
+    if (resync) {
+        rv = hss_db_update_sqn(imsi_bcd, auth_info.rand,
+                (auth_info.sqn + 32) & OGS_MAX_SQN);
+        if (rv != OGS_OK) {
+            ogs_error("Cannot update rand and sqn for IMSI:'%s'", imsi_bcd);
+            result_code = OGS_DIAM_S6A_AUTHENTICATION_DATA_UNAVAILABLE;
+            goto out;
+        }
     }
 
     ret = fd_msg_search_avp(qry, ogs_diam_visited_plmn_id, &avp);
@@ -65,6 +65,7 @@ static int hss_ogs_diam_swx_mar_cb( struct msg **msg, struct avp *avp,
     char imsi_bcd[OGS_MAX_IMSI_BCD_LEN+1];
 
     ogs_dbi_auth_info_t auth_info;
+    bool resync = false;
     uint8_t zero[OGS_RAND_LEN];
 
     uint8_t authenticate[OGS_KEY_LEN*2];
@@ -134,7 +135,7 @@ static int hss_ogs_diam_swx_mar_cb( struct msg **msg, struct avp *avp,
     }
 
     /* DB : HSS Auth-Info */
-    rv = hss_db_auth_info(imsi_bcd, &auth_info);
+    rv = hss_db_auth_info_increment_sqn(imsi_bcd, &auth_info);
     if (rv != OGS_OK) {
         ogs_error("Cannot get IMS-Data for IMSI:'%s'", imsi_bcd);
         result_code = OGS_DIAM_CX_ERROR_USER_UNKNOWN;
@@ -169,6 +170,7 @@ static int hss_ogs_diam_swx_mar_cb( struct msg **msg, struct avp *avp,
             auth_info.sqn = ogs_buffer_to_uint64(sqn, OGS_SQN_LEN);
             /* 33.102 C.3.4 Guide : IND + 1 */
             auth_info.sqn = (auth_info.sqn + 32 + 1) & OGS_MAX_SQN;
+            resync = true;
         } else {
             ogs_error("Re-synch MAC failed for IMSI:`%s`", imsi_bcd);
             ogs_log_print(OGS_LOG_ERROR, "MAC_S: ");
@@ -184,18 +186,19 @@ static int hss_ogs_diam_swx_mar_cb( struct msg **msg, struct avp *avp,
         }
     }
 
-    rv = hss_db_update_sqn(imsi_bcd, auth_info.rand, auth_info.sqn);
-    if (rv != OGS_OK) {
-        ogs_error("Cannot update rand and sqn for IMSI:'%s'", imsi_bcd);
-        result_code = OGS_DIAM_CX_ERROR_IN_ASSIGNMENT_TYPE;
-        goto out;
-    }
-
-    rv = hss_db_increment_sqn(imsi_bcd);
-    if (rv != OGS_OK) {
-        ogs_error("Cannot increment sqn for IMSI:'%s'", imsi_bcd);
-        result_code = OGS_DIAM_CX_ERROR_IN_ASSIGNMENT_TYPE;
-        goto out;
+    /*
+     * The stored SQN was already advanced when Auth-Info was read; only a
+     * re-synchronization has to move it again, to SQN_MS + 32 as verified
+     * from AUTS.
+     */
+    if (resync) {
+        rv = hss_db_update_sqn(imsi_bcd, auth_info.rand,
+                (auth_info.sqn + 32) & OGS_MAX_SQN);
+        if (rv != OGS_OK) {
+            ogs_error("Cannot update rand and sqn for IMSI:'%s'", imsi_bcd);
+            result_code = OGS_DIAM_CX_ERROR_IN_ASSIGNMENT_TYPE;
+            goto out;
+        }
     }
 
     milenage_generate(opc, auth_info.amf, auth_info.k,
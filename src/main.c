@@ -58,8 +58,14 @@ static int check_signal(int signum)
     case SIGHUP:
         ogs_info("SIGHUP received");
         ogs_log_cycle();
+        ogs_app_reload_request();
 
         break;
+#ifdef SIGCHLD
+    case SIGCHLD:
+        /* The child is reaped by whoever forked it */
+        break;
+#endif
     case SIGWINCH:
         ogs_info("Signal-NUM[%d] received (%s)",
                 signum, ogs_signal_description_get(signum));
@@ -72,6 +78,7 @@ static int check_signal(int signum)
                 (unsigned long)talloc_total_blocks(__ogs_talloc_core),
                 (int)talloc_reference_count(__ogs_talloc_core),
                 __ogs_talloc_core);
+        ogs_prof_dump(ogs_pollset_prof(ogs_app()->pollset));
         break;
 
     case SIGUSR2:
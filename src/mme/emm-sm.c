@@ -436,6 +436,7 @@ static void common_register_state(ogs_fsm_t *s, mme_event_t *e,
 
         case OGS_NAS_EPS_ATTACH_REQUEST:
             ogs_info("[%s] Attach request", mme_ue->imsi_bcd);
+            mme_ue->attach_start = ogs_get_monotonic_time();
             rv = emm_handle_attach_request(
                     enb_ue, mme_ue, &message->emm.attach_request, e->pkbuf);
             if (rv != OGS_OK) {
@@ -1602,6 +1603,13 @@ void emm_state_initial_context_setup(ogs_fsm_t *s, mme_event_t *e)
                     sgsap_send_tmsi_reallocation_complete(mme_ue));
             }
 
+            if (mme_ue->attach_start) {
+                mme_metrics_inst_global_add(MME_METR_GLOB_HIST_ATTACH_TIME,
+                        ogs_time_to_msec(ogs_get_monotonic_time() -
+                            mme_ue->attach_start));
+                mme_ue->attach_start = 0;
+            }
+
             OGS_FSM_TRAN(s, &emm_state_registered);
             break;
 
@@ -1828,6 +1836,7 @@ void emm_state_exception(ogs_fsm_t *s, mme_event_t *e)
         switch (message->emm.h.message_type) {
         case OGS_NAS_EPS_ATTACH_REQUEST:
             ogs_warn("[%s] Attach request", mme_ue->imsi_bcd);
+            mme_ue->attach_start = ogs_get_monotonic_time();
             rv = emm_handle_attach_request(
                     enb_ue, mme_ue, &message->emm.attach_request, e->pkbuf);
             if (rv != OGS_OK) {
@@ -10,6 +10,7 @@ typedef struct mme_metrics_spec_def_s {
     int initial_val;
     unsigned int num_labels;
     const char **labels;
+    ogs_metrics_histogram_params_t histogram_params;
 } mme_metrics_spec_def_t;
 
 /* Helper generic functions: */
@@ -40,7 +41,7 @@ static int mme_metrics_init_spec(ogs_metrics_context_t *ctx,
         dst[i] = ogs_metrics_spec_new(ctx, src[i].type,
                 src[i].name, src[i].description,
                 src[i].initial_val, src[i].num_labels, src[i].labels,
-                NULL);
+                &src[i].histogram_params);
     }
     return OGS_OK;
 }
@@ -65,6 +66,29 @@ mme_metrics_spec_def_t mme_metrics_spec_def_global[_MME_METR_GLOB_MAX] = {
     .name = "enb",
     .description = "eNodeBs",
 },
+/* Global Histograms: */
+[MME_METR_GLOB_HIST_ATTACH_TIME] = {
+    .type = OGS_METRICS_METRIC_TYPE_HISTOGRAM,
+    .name = "mme_attach_time",
+    .description = "Time of attach procedure",
+    .histogram_params = {
+        .type = OGS_METRICS_HISTOGRAM_BUCKET_TYPE_EXPONENTIAL,
+        .count = 8,
+        .exp.start = 20,
+        .exp.factor = 2,
+    },
+},
+[MME_METR_GLOB_HIST_HANDOVER_TIME] = {
+    .type = OGS_METRICS_METRIC_TYPE_HISTOGRAM,
+    .name = "mme_handover_time",
+    .description = "Time of S1 handover procedure",
+    .histogram_params = {
+        .type = OGS_METRICS_HISTOGRAM_BUCKET_TYPE_EXPONENTIAL,
+        .count = 8,
+        .exp.start = 10,
+        .exp.factor = 2,
+    },
+},
 };
 int mme_metrics_init_inst_global(void)
 {
@@ -76,6 +100,169 @@ int mme_metrics_free_inst_global(void)
     return mme_metrics_free_inst(mme_metrics_inst_global, _MME_METR_GLOB_MAX);
 }
 
+/* BY ENB */
+const char *labels_enb[] = {
+    "addr"
+};
+
+#define MME_METR_BY_ENB_ENTRY(_id, _type, _name, _desc) \
+    [_id] = { \
+        .type = _type, \
+        .name = _name, \
+        .description = _desc, \
+        .num_labels = OGS_ARRAY_SIZE(labels_enb), \
+        .labels = labels_enb, \
+    },
+ogs_metrics_spec_t *mme_metrics_spec_by_enb[_MME_METR_BY_ENB_MAX];
+mme_metrics_spec_def_t mme_metrics_spec_def_by_enb[_MME_METR_BY_ENB_MAX] = {
+/* Gauges: */
+MME_METR_BY_ENB_ENTRY(
+    MME_METR_GAUGE_S1AP_SCTP_TX_QUEUE,
+    OGS_METRICS_METRIC_TYPE_GAUGE,
+    "s1ap_sctp_tx_queue",
+    "S1AP messages waiting in the SCTP send queue")
+MME_METR_BY_ENB_ENTRY(
+    MME_METR_GAUGE_S1AP_SCTP_TX_QUEUE_MAX,
+    OGS_METRICS_METRIC_TYPE_GAUGE,
+    "s1ap_sctp_tx_queue_max",
+    "High-water mark of the SCTP send queue")
+/* Counters: */
+MME_METR_BY_ENB_ENTRY(
+    MME_METR_CTR_S1AP_SCTP_TX_SENT,
+    OGS_METRICS_METRIC_TYPE_COUNTER,
+    "s1ap_sctp_tx_sent",
+    "S1AP messages written to the SCTP association")
+MME_METR_BY_ENB_ENTRY(
+    MME_METR_CTR_S1AP_SCTP_TX_EAGAIN,
+    OGS_METRICS_METRIC_TYPE_COUNTER,
+    "s1ap_sctp_tx_eagain",
+    "SCTP send queue flushes deferred by EAGAIN")
+MME_METR_BY_ENB_ENTRY(
+    MME_METR_CTR_S1AP_SCTP_TX_DROPPED,
+    OGS_METRICS_METRIC_TYPE_COUNTER,
+    "s1ap_sctp_tx_dropped",
+    "S1AP messages dropped on SCTP send error")
+};
+
+void mme_metrics_init_inst_by_enb(
+        ogs_metrics_inst_t **inst, ogs_sockaddr_t *addr)
+{
+    char buf[OGS_ADDRSTRLEN];
+    char addr_str[OGS_ADDRSTRLEN+8];
+
+    ogs_assert(inst);
+    ogs_assert(addr);
+
+    ogs_snprintf(addr_str, sizeof(addr_str), "[%s]:%d",
+            OGS_ADDR(addr, buf), OGS_PORT(addr));
+
+    mme_metrics_init_inst(inst, mme_metrics_spec_by_enb,
+            _MME_METR_BY_ENB_MAX, OGS_ARRAY_SIZE(labels_enb),
+            (const char *[]){ addr_str });
+}
+
+void mme_metrics_free_inst_by_enb(ogs_metrics_inst_t **inst)
+{
+    mme_metrics_free_inst(inst, _MME_METR_BY_ENB_MAX);
+}
+
+/*
+ * The SCTP layer only keeps raw counters; they are pushed to the
+ * metrics instances here, and only when something has changed.
+ */
+void mme_metrics_inst_by_enb_sctp_update(ogs_metrics_inst_t **inst,
+        ogs_sctp_stats_t *exported, const ogs_sctp_stats_t *stats)
+{
+    ogs_assert(inst);
+    ogs_assert(exported);
+    ogs_assert(stats);
+
+    if (memcmp(exported, stats, sizeof(*stats)) == 0)
+        return;
+
+    ogs_metrics_inst_set(inst[MME_METR_GAUGE_S1AP_SCTP_TX_QUEUE],
+            stats->queued);
+    ogs_metrics_inst_set(inst[MME_METR_GAUGE_S1AP_SCTP_TX_QUEUE_MAX],
+            stats->max_queued);
+    ogs_metrics_inst_add(inst[MME_METR_CTR_S1AP_SCTP_TX_SENT],
+            (int)(stats->sent - exported->sent));
+    ogs_metrics_inst_add(inst[MME_METR_CTR_S1AP_SCTP_TX_EAGAIN],
+            (int)(stats->eagain - exported->eagain));
+    ogs_metrics_inst_add(inst[MME_METR_CTR_S1AP_SCTP_TX_DROPPED],
+            (int)(stats->dropped - exported->dropped));
+
+    memcpy(exported, stats, sizeof(*stats));
+}
+
+static ogs_metrics_peer_t *mme_metrics_gtp_peer(ogs_gtp_node_t *gnode)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_assert(gnode);
+
+    if (!gnode->metrics)
+        gnode->metrics = ogs_metrics_peer_find_or_add(
+                OGS_ADDR(&gnode->addr, buf));
+
+    return gnode->metrics;
+}
+
+static void mme_metrics_gtp_node_collect(ogs_gtp_node_t *gnode)
+{
+    ogs_metrics_peer_xact_stats_t stats;
+
+    ogs_assert(gnode);
+
+    stats.local = gnode->xact_stats.local;
+    stats.remote = gnode->xact_stats.remote;
+    stats.retransmitted = gnode->xact_stats.retransmitted;
+    stats.duplicated = gnode->xact_stats.duplicated;
+
+    ogs_metrics_peer_xact_update(mme_metrics_gtp_peer(gnode),
+            OGS_METRICS_PEER_XACT_GTP, &stats);
+}
+
+/*
+ * The transaction counters live in the nodes and are only copied here
+ * when the metrics are scraped.
+ */
+static void mme_metrics_collect(void)
+{
+    mme_sgw_t *sgw = NULL;
+    mme_sgsn_t *sgsn = NULL;
+
+    ogs_list_for_each(&mme_self()->sgw_list, sgw)
+        mme_metrics_gtp_node_collect(&sgw->gnode);
+    ogs_list_for_each(&mme_self()->sgsn_list, sgsn)
+        mme_metrics_gtp_node_collect(&sgsn->gnode);
+}
+
+static void mme_metrics_gtp_xact_rtt(ogs_gtp_xact_t *xact, ogs_time_t rtt)
+{
+    ogs_metrics_peer_t *peer = NULL;
+    ogs_metrics_inst_t *inst = NULL;
+    uint32_t id;
+
+    ogs_assert(xact);
+    ogs_assert(xact->gnode);
+
+    peer = mme_metrics_gtp_peer(xact->gnode);
+    id = (xact->gtp_version << 8) | xact->seq[0].type;
+
+    inst = ogs_metrics_peer_hist_find(peer,
+            OGS_METRICS_PEER_HIST_GTP_XACT_TIME, id, NULL);
+    if (!inst) {
+        char type[8];
+
+        ogs_snprintf(type, sizeof(type), "v%d/%d",
+                xact->gtp_version, xact->seq[0].type);
+        inst = ogs_metrics_peer_hist_add(peer,
+                OGS_METRICS_PEER_HIST_GTP_XACT_TIME, id, NULL, type);
+    }
+    if (inst)
+        ogs_metrics_inst_add(inst, ogs_time_to_msec(rtt));
+}
+
 void mme_metrics_init(void)
 {
     ogs_metrics_context_t *ctx = ogs_metrics_self();
@@ -84,10 +271,21 @@ void mme_metrics_init(void)
     mme_metrics_init_spec(ctx, mme_metrics_spec_global, mme_metrics_spec_def_global,
             _MME_METR_GLOB_MAX);
 
+    mme_metrics_init_spec(ctx, mme_metrics_spec_by_enb,
+            mme_metrics_spec_def_by_enb, _MME_METR_BY_ENB_MAX);
+
     mme_metrics_init_inst_global();
+
+    ogs_metrics_peer_hist_init(OGS_METRICS_PEER_HIST_GTP_XACT_TIME);
+    ogs_gtp_xact_set_rtt_cb(mme_metrics_gtp_xact_rtt);
+
+    ogs_metrics_peer_xact_init(OGS_METRICS_PEER_XACT_GTP);
+    ctx->collect = mme_metrics_collect;
 }
 
 void mme_metrics_final(void)
 {
+    ogs_gtp_xact_set_rtt_cb(NULL);
+
     ogs_metrics_context_final();
 }
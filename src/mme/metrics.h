@@ -2,6 +2,7 @@
 #define MME_METRICS_H
 
 #include "ogs-metrics.h"
+#include "ogs-sctp.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -12,6 +13,8 @@ typedef enum mme_metric_type_global_s {
     MME_METR_GLOB_GAUGE_ENB_UE,
     MME_METR_GLOB_GAUGE_MME_SESS,
     MME_METR_GLOB_GAUGE_ENB,
+    MME_METR_GLOB_HIST_ATTACH_TIME,
+    MME_METR_GLOB_HIST_HANDOVER_TIME,
     _MME_METR_GLOB_MAX,
 } mme_metric_type_global_t;
 extern ogs_metrics_inst_t *mme_metrics_inst_global[_MME_METR_GLOB_MAX];
@@ -28,6 +31,22 @@ static inline void mme_metrics_inst_global_inc(mme_metric_type_global_t t)
 static inline void mme_metrics_inst_global_dec(mme_metric_type_global_t t)
 { ogs_metrics_inst_dec(mme_metrics_inst_global[t]); }
 
+/* BY ENB */
+typedef enum mme_metric_type_by_enb_s {
+    MME_METR_GAUGE_S1AP_SCTP_TX_QUEUE = 0,
+    MME_METR_GAUGE_S1AP_SCTP_TX_QUEUE_MAX,
+    MME_METR_CTR_S1AP_SCTP_TX_SENT,
+    MME_METR_CTR_S1AP_SCTP_TX_EAGAIN,
+    MME_METR_CTR_S1AP_SCTP_TX_DROPPED,
+    _MME_METR_BY_ENB_MAX,
+} mme_metric_type_by_enb_t;
+
+void mme_metrics_init_inst_by_enb(
+        ogs_metrics_inst_t **inst, ogs_sockaddr_t *addr);
+void mme_metrics_free_inst_by_enb(ogs_metrics_inst_t **inst);
+void mme_metrics_inst_by_enb_sctp_update(ogs_metrics_inst_t **inst,
+        ogs_sctp_stats_t *exported, const ogs_sctp_stats_t *stats);
+
 void mme_metrics_init(void);
 void mme_metrics_final(void);
 
@@ -111,16 +111,16 @@ void mme_context_init(void)
     /* Allocate TWICE the pool to check if maximum number of eNBs is reached */
     ogs_pool_init(&mme_enb_pool, ogs_global_conf()->max.peer*2);
 
-    ogs_pool_init(&mme_ue_pool, ogs_global_conf()->max.ue);
+    ogs_pool_init_elastic(&mme_ue_pool, ogs_global_conf()->max.ue);
     ogs_pool_init(&mme_s11_teid_pool, ogs_global_conf()->max.ue);
     ogs_pool_random_id_generate(&mme_s11_teid_pool);
     ogs_pool_init(&mme_gn_teid_pool, ogs_global_conf()->max.ue);
     ogs_pool_random_id_generate(&mme_gn_teid_pool);
 
-    ogs_pool_init(&enb_ue_pool, ogs_global_conf()->max.ue);
-    ogs_pool_init(&sgw_ue_pool, ogs_global_conf()->max.ue);
-    ogs_pool_init(&mme_sess_pool, ogs_app()->pool.sess);
-    ogs_pool_init(&mme_bearer_pool, ogs_app()->pool.bearer);
+    ogs_pool_init_elastic(&enb_ue_pool, ogs_global_conf()->max.ue);
+    ogs_pool_init_elastic(&sgw_ue_pool, ogs_global_conf()->max.ue);
+    ogs_pool_init_elastic(&mme_sess_pool, ogs_app()->pool.sess);
+    ogs_pool_init_elastic(&mme_bearer_pool, ogs_app()->pool.bearer);
     /* Increase size of TMSI pool (#1827) */
     ogs_pool_init(&m_tmsi_pool, ogs_global_conf()->max.ue*2);
     ogs_pool_random_id_generate(&m_tmsi_pool);
@@ -141,6 +141,9 @@ void mme_context_init(void)
     self.mme_gn_teid_hash = ogs_hash_make();
     ogs_assert(self.mme_gn_teid_hash);
 
+    ogs_paging_index_init(&self.paging,
+            ogs_app()->timer_mgr, s1ap_paging_flush);
+
     ogs_list_init(&self.mme_ue_list);
 
     context_initialized = 1;
@@ -174,6 +177,8 @@ void mme_context_final(void)
     ogs_assert(self.mme_gn_teid_hash);
     ogs_hash_destroy(self.mme_gn_teid_hash);
 
+    ogs_paging_index_final(&self.paging);
+
     ogs_pool_final(&m_tmsi_pool);
     ogs_pool_final(&mme_bearer_pool);
     ogs_pool_final(&mme_sess_pool);
@@ -717,6 +722,9 @@ int mme_context_parse_config(void)
 
                             } while (ogs_yaml_iter_type(&server_array) ==
                                     YAML_SEQUENCE_NODE);
+                        } else if (!strcmp(s1ap_key, "worker")) {
+                            const char *v = ogs_yaml_iter_value(&s1ap_iter);
+                            if (v) self.s1ap.num_of_worker = atoi(v);
                         } else
                             ogs_warn("unknown key `%s`", s1ap_key);
                     }
@@ -2967,6 +2975,7 @@ mme_enb_t *mme_enb_add(ogs_sock_t *sock, ogs_sockaddr_t *addr)
     enb->ostream_id = 0;
 
     ogs_list_init(&enb->enb_ue_list);
+    ogs_list_init(&enb->paging_list);
 
     ogs_hash_set(self.enb_addr_hash,
             enb->sctp.addr, sizeof(ogs_sockaddr_t), enb);
@@ -2975,6 +2984,8 @@ mme_enb_t *mme_enb_add(ogs_sock_t *sock, ogs_sockaddr_t *addr)
     e.enb_id = enb->id;
     ogs_fsm_init(&enb->sm, s1ap_state_initial, s1ap_state_final, &e);
 
+    mme_metrics_init_inst_by_enb(enb->metrics.inst, enb->sctp.addr);
+
     ogs_list_add(&self.enb_list, enb);
     mme_metrics_inst_global_inc(MME_METR_GLOB_GAUGE_ENB);
 
@@ -2992,6 +3003,7 @@ int mme_enb_remove(mme_enb_t *enb)
     ogs_assert(enb->sctp.sock);
 
     ogs_list_remove(&self.enb_list, enb);
+    ogs_paging_node_clear(&self.paging, &enb->paging_list);
 
     memset(&e, 0, sizeof(e));
     e.enb_id = enb->id;
@@ -3011,6 +3023,8 @@ int mme_enb_remove(mme_enb_t *enb)
 
     ogs_sctp_flush_and_destroy(&enb->sctp);
 
+    mme_metrics_free_inst_by_enb(enb->metrics.inst);
+
     ogs_pool_id_free(&mme_enb_pool, enb);
     mme_metrics_inst_global_dec(MME_METR_GLOB_GAUGE_ENB);
     ogs_info("[Removed] Number of eNBs is now %d",
@@ -3058,6 +3072,26 @@ int mme_enb_set_enb_id(mme_enb_t *enb, uint32_t enb_id)
     return OGS_OK;
 }
 
+/* Called whenever the Supported TA List of the eNB has been rewritten */
+void mme_enb_paging_update(mme_enb_t *enb)
+{
+    int i;
+
+    ogs_assert(enb);
+
+    ogs_paging_node_clear(&self.paging, &enb->paging_list);
+
+    for (i = 0; i < enb->num_of_supported_ta_list; i++)
+        ogs_paging_node_add(&self.paging, &enb->paging_list, enb,
+                &enb->supported_ta_list[i], sizeof(ogs_eps_tai_t));
+}
+
+ogs_paging_area_t *mme_paging_area_find(ogs_eps_tai_t *tai)
+{
+    ogs_assert(tai);
+    return ogs_paging_area_find(&self.paging, tai, sizeof(*tai));
+}
+
 int mme_enb_sock_type(ogs_sock_t *sock)
 {
     ogs_socknode_t *snode = NULL;
@@ -3590,6 +3624,8 @@ void mme_ue_remove(mme_ue_t *mme_ue)
 
     mme_ue_fsm_fini(mme_ue);
 
+    ogs_paging_ue_dequeue(&mme_ue->paging_ue);
+
     ogs_hash_set(self.mme_s11_teid_hash,
             &mme_ue->mme_s11_teid, sizeof(mme_ue->mme_s11_teid), NULL);
     ogs_hash_set(self.mme_gn_teid_hash,
@@ -4103,8 +4139,7 @@ int mme_ue_xact_count(mme_ue_t *mme_ue, uint8_t org)
     if (!gnode) return 0;
 
     return org == OGS_GTP_LOCAL_ORIGINATOR ?
-            ogs_list_count(&gnode->local_list) :
-                ogs_list_count(&gnode->remote_list);
+            gnode->xact_stats.local : gnode->xact_stats.remote;
 }
 
 void enb_ue_associate_mme_ue(enb_ue_t *enb_ue, mme_ue_t *mme_ue)
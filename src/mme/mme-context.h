@@ -85,6 +85,10 @@ typedef struct mme_context_s {
     ogs_list_t      s1ap_list;      /* MME S1AP IPv4 Server List */
     ogs_list_t      s1ap_list6;     /* MME S1AP IPv6 Server List */
 
+    struct {
+        int         num_of_worker;  /* S1AP Decoding Threads */
+    } s1ap;
+
     ogs_list_t      sgw_list;       /* SGW GTPv2C Client List */
     mme_sgw_t       *sgw;           /* Iterator for SGW round-robin */
 
@@ -158,6 +162,8 @@ typedef struct mme_context_s {
     ogs_hash_t *mme_s11_teid_hash;  /* hash table (MME-S11-TEID : MME_UE) */
     ogs_hash_t *mme_gn_teid_hash;  /* hash table (MME-GN-TEID : MME_UE) */
 
+    ogs_paging_index_t paging;      /* EPS-TAI : eNBs */
+
     struct {
         struct {
             ogs_time_t value;       /* Timer Value(Seconds) */
@@ -251,6 +257,11 @@ typedef struct mme_enb_s {
     ogs_plmn_id_t   plmn_id;    /* eNB PLMN-ID received from eNB */
     ogs_sctp_sock_t sctp;       /* SCTP socket */
 
+    struct {
+        ogs_metrics_inst_t *inst[_MME_METR_BY_ENB_MAX];
+        ogs_sctp_stats_t sctp;  /* SCTP stats last exported to metrics */
+    } metrics;
+
     struct {
         bool s1_setup_success;  /* eNB S1AP Setup complete successfuly */
     } state;
@@ -265,6 +276,8 @@ typedef struct mme_enb_s {
 
     ogs_list_t      enb_ue_list;
 
+    ogs_list_t      paging_list;    /* ogs_paging_member_t */
+
 } mme_enb_t;
 
 struct enb_ue_s {
@@ -362,6 +375,11 @@ struct mme_ue_s {
         ogs_nas_detach_type_t detach;
     } nas_eps;
 
+    /* Start of the attach procedure (mme_attach_time) */
+    ogs_time_t      attach_start;
+    /* Start of the S1 handover procedure (mme_handover_time) */
+    ogs_time_t      handover_start;
+
 #define MME_TAU_TYPE_INITIAL_UE_MESSAGE    1
 #define MME_TAU_TYPE_UPLINK_NAS_TRANPORT   2
 #define MME_TAU_TYPE_UNPROTECTED_INGERITY  3
@@ -662,6 +680,9 @@ struct mme_ue_s {
     } t3413, t3422, t3450, t3460, t3470, t_mobile_reachable,
         t_implicit_detach;
 
+    /* Queued on a paging area until the end of the loop iteration */
+    ogs_paging_ue_t paging_ue;
+
 #define CLEAR_SERVICE_INDICATOR(__mME) \
     do { \
         ogs_assert((__mME)); \
@@ -964,6 +985,9 @@ int mme_enb_remove_all(void);
 mme_enb_t *mme_enb_find_by_addr(const ogs_sockaddr_t *addr);
 mme_enb_t *mme_enb_find_by_enb_id(uint32_t enb_id);
 int mme_enb_set_enb_id(mme_enb_t *enb, uint32_t enb_id);
+
+void mme_enb_paging_update(mme_enb_t *enb);
+ogs_paging_area_t *mme_paging_area_find(ogs_eps_tai_t *tai);
 int mme_enb_sock_type(ogs_sock_t *sock);
 mme_enb_t *mme_enb_find_by_id(ogs_pool_id_t id);
 
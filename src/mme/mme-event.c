@@ -23,6 +23,7 @@
 #include "mme-context.h"
 
 #include "s1ap-path.h"
+#include "s1ap-worker.h"
 
 void mme_event_term(void)
 {
@@ -127,7 +128,15 @@ void mme_sctp_event_push(mme_event_e id,
     e->max_num_of_istreams = max_num_of_istreams;
     e->max_num_of_ostreams = max_num_of_ostreams;
 
-    rv = ogs_queue_push(ogs_app()->queue, e);
+    /* SGsAP events share this path but are never sent to S1AP workers */
+    if (s1ap_worker_enabled() &&
+        (id == MME_EVENT_S1AP_MESSAGE ||
+         id == MME_EVENT_S1AP_LO_ACCEPT ||
+         id == MME_EVENT_S1AP_LO_SCTP_COMM_UP ||
+         id == MME_EVENT_S1AP_LO_CONNREFUSED))
+        rv = s1ap_worker_push(e);
+    else
+        rv = ogs_queue_push(ogs_app()->queue, e);
     if (rv != OGS_OK) {
         ogs_error("ogs_queue_push() failed:%d", (int)rv);
         ogs_free(e->addr);
@@ -135,9 +144,4 @@ void mme_sctp_event_push(mme_event_e id,
             ogs_pkbuf_free(e->pkbuf);
         mme_event_free(e);
     }
-#if HAVE_USRSCTP
-    else {
-        ogs_pollset_notify(ogs_app()->pollset);
-    }
-#endif
 }
@@ -59,6 +59,7 @@ typedef enum {
 
 typedef long S1AP_ProcedureCode_t;
 typedef struct S1AP_S1AP_PDU ogs_s1ap_message_t;
+typedef struct ogs_s1ap_lazy_message_s ogs_s1ap_lazy_message_t;
 typedef struct ogs_nas_eps_message_s ogs_nas_eps_message_t;
 typedef struct ogs_diam_s6a_message_s ogs_diam_s6a_message_t;
 typedef struct mme_vlr_s mme_vlr_t;
@@ -84,6 +85,7 @@ typedef struct mme_event_s {
 
     S1AP_ProcedureCode_t s1ap_code;
     ogs_s1ap_message_t *s1ap_message;
+    ogs_s1ap_lazy_message_t *s1ap_lazy_message;
 
     ogs_gtp_node_t *gnode;
 
@@ -1112,8 +1112,6 @@ out:
             ogs_error("ogs_queue_push() failed:%d", (int)rv);
             ogs_free(s6a_message);
             mme_event_free(e);
-        } else {
-            ogs_pollset_notify(ogs_app()->pollset);
         }
     }
 
@@ -1534,8 +1532,6 @@ static void mme_s6a_ula_cb(void *data, struct msg **msg)
             ogs_subscription_data_free(subscription_data);
             ogs_free(s6a_message);
             mme_event_free(e);
-        } else {
-            ogs_pollset_notify(ogs_app()->pollset);
         }
     } else {
         ogs_subscription_data_free(subscription_data);
@@ -1847,8 +1843,6 @@ static void mme_s6a_pua_cb(void *data, struct msg **msg)
             ogs_error("ogs_queue_push() failed:%d", (int)rv);
             ogs_free(s6a_message);
             mme_event_free(e);
-        } else {
-            ogs_pollset_notify(ogs_app()->pollset);
         }
     } else {
         ogs_free(s6a_message);
@@ -2004,8 +1998,6 @@ static int mme_ogs_diam_s6a_clr_cb( struct msg **msg, struct avp *avp,
         ogs_error("ogs_queue_push() failed:%d", (int)rv);
         ogs_free(s6a_message);
         mme_event_free(e);
-    } else {
-        ogs_pollset_notify(ogs_app()->pollset);
     }
 
     return 0;
@@ -2299,8 +2291,6 @@ static int mme_ogs_diam_s6a_idr_cb( struct msg **msg, struct avp *avp,
         ogs_subscription_data_free(subscription_data);
         ogs_free(s6a_message);
         mme_event_free(e);
-    } else {
-        ogs_pollset_notify(ogs_app()->pollset);
     }
 
     return 0;
@@ -27,6 +27,7 @@
 
 #include "mme-fd-path.h"
 #include "s1ap-path.h"
+#include "s1ap-worker.h"
 #include "sgsap-path.h"
 #include "mme-gtp-path.h"
 #include "metrics.h"
@@ -62,6 +63,9 @@ int mme_initialize(void)
     rv = ogs_metrics_context_parse_config(APP_NAME);
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_app_reload_add("metrics", ogs_metrics_context_reload_config);
+    if (rv != OGS_OK) return rv;
+
     rv = mme_context_parse_config();
     if (rv != OGS_OK) return rv;
 
@@ -76,6 +80,9 @@ int mme_initialize(void)
     rv = sgsap_open();
     if (rv != OGS_OK) return OGS_ERROR;
 
+    rv = s1ap_worker_open(mme_self()->s1ap.num_of_worker);
+    if (rv != OGS_OK) return OGS_ERROR;
+
     rv = s1ap_open();
     if (rv != OGS_OK) return OGS_ERROR;
 
@@ -98,6 +105,7 @@ void mme_terminate(void)
     mme_gtp_close();
     sgsap_close();
     s1ap_close();
+    s1ap_worker_close();
 
     ogs_metrics_context_close(ogs_metrics_self());
 
@@ -112,11 +120,18 @@ void mme_terminate(void)
     mme_metrics_final();
 }
 
+static const char *mme_prof_event_name(void *event)
+{
+    return mme_event_get_name(event);
+}
+
 static void mme_main(void *data)
 {
     ogs_fsm_t mme_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            mme_prof_event_name);
     ogs_fsm_init(&mme_sm, mme_state_initial, mme_state_final, 0);
 
     for ( ;; ) {
@@ -136,10 +151,14 @@ static void mme_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            mme_event_t *e = NULL;
+            mme_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -148,9 +167,11 @@ static void mme_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&mme_sm, e);
-            mme_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&mme_sm, e[i]);
+                mme_event_free(e[i]);
+            }
         }
     }
 done:
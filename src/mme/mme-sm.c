@@ -62,6 +62,7 @@ void mme_state_operational(ogs_fsm_t *s, mme_event_t *e)
     uint16_t max_num_of_ostreams = 0;
 
     ogs_s1ap_message_t s1ap_message;
+    ogs_s1ap_lazy_message_t s1ap_lazy_message;
     ogs_pkbuf_t *pkbuf = NULL;
     int rc, r;
 
@@ -198,6 +199,42 @@ void mme_state_operational(ogs_fsm_t *s, mme_event_t *e)
         ogs_assert(enb);
         ogs_assert(OGS_FSM_STATE(&enb->sm));
 
+        mme_metrics_inst_by_enb_sctp_update(enb->metrics.inst,
+                &enb->metrics.sctp, &enb->sctp.stats);
+
+        if (e->s1ap_message) {
+            /* Already decoded by an S1AP worker thread */
+            ogs_s1ap_message_t *message = e->s1ap_message;
+
+            e->enb_id = enb->id;
+            ogs_fsm_dispatch(&enb->sm, e);
+
+            ogs_s1ap_free(message);
+            ogs_free(message);
+            ogs_pkbuf_free(pkbuf);
+            break;
+        }
+
+        /*
+         * High-volume UE-associated messages are dispatched
+         * without decoding the whole S1AP-PDU.
+         */
+        rc = ogs_s1ap_lazy_decode(&s1ap_lazy_message, pkbuf);
+        if (rc == OGS_OK && enb->state.s1_setup_success &&
+            s1ap_lazy_message.h.present ==
+                S1AP_S1AP_PDU_PR_initiatingMessage &&
+            (s1ap_lazy_message.h.procedureCode ==
+                S1AP_ProcedureCode_id_uplinkNASTransport ||
+             s1ap_lazy_message.h.procedureCode ==
+                S1AP_ProcedureCode_id_UEContextReleaseRequest)) {
+            e->enb_id = enb->id;
+            e->s1ap_lazy_message = &s1ap_lazy_message;
+            ogs_fsm_dispatch(&enb->sm, e);
+
+            ogs_pkbuf_free(pkbuf);
+            break;
+        }
+
         rc = ogs_s1ap_decode(&s1ap_message, pkbuf);
         if (rc == OGS_OK) {
             e->enb_id = enb->id;
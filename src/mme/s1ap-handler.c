@@ -211,6 +211,8 @@ void s1ap_handle_s1_setup_request(mme_enb_t *enb, ogs_s1ap_message_t *message)
         }
     }
 
+    mme_enb_paging_update(enb);
+
     if (maximum_number_of_enbs_is_reached()) {
         ogs_warn("S1-Setup failure:");
         ogs_warn("    Maximum number of eNBs reached");
@@ -354,6 +356,8 @@ void s1ap_handle_enb_configuration_update(
             }
         }
 
+        mme_enb_paging_update(enb);
+
         /*
          * TS36.413
          * Section 8.7.3.4 Abnormal Conditions
@@ -612,21 +616,14 @@ void s1ap_handle_initial_ue_message(mme_enb_t *enb, ogs_s1ap_message_t *message)
                 enb_ue, S1AP_ProcedureCode_id_initialUEMessage, NAS_PDU));
 }
 
-void s1ap_handle_uplink_nas_transport(
-        mme_enb_t *enb, ogs_s1ap_message_t *message)
+static void handle_uplink_nas_transport(mme_enb_t *enb,
+        S1AP_MME_UE_S1AP_ID_t *MME_UE_S1AP_ID,
+        S1AP_ENB_UE_S1AP_ID_t *ENB_UE_S1AP_ID,
+        S1AP_NAS_PDU_t *NAS_PDU, S1AP_EUTRAN_CGI_t *EUTRAN_CGI,
+        S1AP_TAI_t *TAI)
 {
     char buf[OGS_ADDRSTRLEN];
-    int i, r;
-
-    S1AP_InitiatingMessage_t *initiatingMessage = NULL;
-    S1AP_UplinkNASTransport_t *UplinkNASTransport = NULL;
-
-    S1AP_UplinkNASTransport_IEs_t *ie = NULL;
-    S1AP_MME_UE_S1AP_ID_t *MME_UE_S1AP_ID = NULL;
-    S1AP_ENB_UE_S1AP_ID_t *ENB_UE_S1AP_ID = NULL;
-    S1AP_NAS_PDU_t *NAS_PDU = NULL;
-    S1AP_EUTRAN_CGI_t *EUTRAN_CGI = NULL;
-    S1AP_TAI_t *TAI = NULL;
+    int r;
 
     S1AP_PLMNidentity_t *pLMNidentity = NULL;
     S1AP_TAC_t *tAC = NULL;
@@ -638,40 +635,6 @@ void s1ap_handle_uplink_nas_transport(
     ogs_eps_tai_t tai;
     int served_tai_index = 0;
 
-    ogs_assert(enb);
-    ogs_assert(enb->sctp.sock);
-
-    ogs_assert(message);
-    initiatingMessage = message->choice.initiatingMessage;
-    ogs_assert(initiatingMessage);
-    UplinkNASTransport = &initiatingMessage->value.choice.UplinkNASTransport;
-    ogs_assert(UplinkNASTransport);
-
-    ogs_debug("UplinkNASTransport");
-
-    for (i = 0; i < UplinkNASTransport->protocolIEs.list.count; i++) {
-        ie = UplinkNASTransport->protocolIEs.list.array[i];
-        switch (ie->id) {
-        case S1AP_ProtocolIE_ID_id_MME_UE_S1AP_ID:
-            MME_UE_S1AP_ID = &ie->value.choice.MME_UE_S1AP_ID;
-            break;
-        case S1AP_ProtocolIE_ID_id_eNB_UE_S1AP_ID:
-            ENB_UE_S1AP_ID = &ie->value.choice.ENB_UE_S1AP_ID;
-            break;
-        case S1AP_ProtocolIE_ID_id_NAS_PDU:
-            NAS_PDU = &ie->value.choice.NAS_PDU;
-            break;
-        case S1AP_ProtocolIE_ID_id_EUTRAN_CGI:
-            EUTRAN_CGI = &ie->value.choice.EUTRAN_CGI;
-            break;
-        case S1AP_ProtocolIE_ID_id_TAI:
-            TAI = &ie->value.choice.TAI;
-            break;
-        default:
-            break;
-        }
-    }
-
     ogs_debug("    IP[%s] ENB_ID[%d]",
             OGS_ADDR(enb->sctp.addr, buf), enb->enb_id);
 
@@ -803,6 +766,108 @@ void s1ap_handle_uplink_nas_transport(
                 enb_ue, S1AP_ProcedureCode_id_uplinkNASTransport, NAS_PDU));
 }
 
+void s1ap_handle_uplink_nas_transport(
+        mme_enb_t *enb, ogs_s1ap_message_t *message)
+{
+    int i;
+
+    S1AP_InitiatingMessage_t *initiatingMessage = NULL;
+    S1AP_UplinkNASTransport_t *UplinkNASTransport = NULL;
+
+    S1AP_UplinkNASTransport_IEs_t *ie = NULL;
+    S1AP_MME_UE_S1AP_ID_t *MME_UE_S1AP_ID = NULL;
+    S1AP_ENB_UE_S1AP_ID_t *ENB_UE_S1AP_ID = NULL;
+    S1AP_NAS_PDU_t *NAS_PDU = NULL;
+    S1AP_EUTRAN_CGI_t *EUTRAN_CGI = NULL;
+    S1AP_TAI_t *TAI = NULL;
+
+    ogs_assert(enb);
+    ogs_assert(enb->sctp.sock);
+
+    ogs_assert(message);
+    initiatingMessage = message->choice.initiatingMessage;
+    ogs_assert(initiatingMessage);
+    UplinkNASTransport = &initiatingMessage->value.choice.UplinkNASTransport;
+    ogs_assert(UplinkNASTransport);
+
+    ogs_debug("UplinkNASTransport");
+
+    for (i = 0; i < UplinkNASTransport->protocolIEs.list.count; i++) {
+        ie = UplinkNASTransport->protocolIEs.list.array[i];
+        switch (ie->id) {
+        case S1AP_ProtocolIE_ID_id_MME_UE_S1AP_ID:
+            MME_UE_S1AP_ID = &ie->value.choice.MME_UE_S1AP_ID;
+            break;
+        case S1AP_ProtocolIE_ID_id_eNB_UE_S1AP_ID:
+            ENB_UE_S1AP_ID = &ie->value.choice.ENB_UE_S1AP_ID;
+            break;
+        case S1AP_ProtocolIE_ID_id_NAS_PDU:
+            NAS_PDU = &ie->value.choice.NAS_PDU;
+            break;
+        case S1AP_ProtocolIE_ID_id_EUTRAN_CGI:
+            EUTRAN_CGI = &ie->value.choice.EUTRAN_CGI;
+            break;
+        case S1AP_ProtocolIE_ID_id_TAI:
+            TAI = &ie->value.choice.TAI;
+            break;
+        default:
+            break;
+        }
+    }
+
+    handle_uplink_nas_transport(enb,
+            MME_UE_S1AP_ID, ENB_UE_S1AP_ID, NAS_PDU, EUTRAN_CGI, TAI);
+}
+
+void s1ap_handle_uplink_nas_transport_lazy(
+        mme_enb_t *enb, ogs_s1ap_lazy_message_t *message)
+{
+    ogs_asn_ie_view_t *ie = NULL;
+
+    S1AP_MME_UE_S1AP_ID_t MME_UE_S1AP_ID, *mme_ue_s1ap_id = NULL;
+    S1AP_ENB_UE_S1AP_ID_t ENB_UE_S1AP_ID, *enb_ue_s1ap_id = NULL;
+    S1AP_NAS_PDU_t NAS_PDU, *nas_pdu = NULL;
+    S1AP_EUTRAN_CGI_t EUTRAN_CGI, *eutran_cgi = NULL;
+    S1AP_TAI_t TAI, *tai = NULL;
+
+    ogs_assert(enb);
+    ogs_assert(enb->sctp.sock);
+
+    ogs_assert(message);
+
+    ogs_debug("UplinkNASTransport");
+
+    if (message->mme_ue_s1ap_id_presence) {
+        MME_UE_S1AP_ID = message->mme_ue_s1ap_id;
+        mme_ue_s1ap_id = &MME_UE_S1AP_ID;
+    }
+    if (message->enb_ue_s1ap_id_presence) {
+        ENB_UE_S1AP_ID = message->enb_ue_s1ap_id;
+        enb_ue_s1ap_id = &ENB_UE_S1AP_ID;
+    }
+
+    /* NAS-PDU is not copied : it points into the received SCTP buffer */
+    ie = ogs_s1ap_lazy_find_ie(message, S1AP_ProtocolIE_ID_id_NAS_PDU);
+    if (ie && ogs_asn_lazy_get_OCTET_STRING(ie, &NAS_PDU) == OGS_OK)
+        nas_pdu = &NAS_PDU;
+
+    if (ogs_s1ap_lazy_decode_ie(message, S1AP_ProtocolIE_ID_id_EUTRAN_CGI,
+                &asn_DEF_S1AP_EUTRAN_CGI,
+                &EUTRAN_CGI, sizeof(EUTRAN_CGI)) == OGS_OK)
+        eutran_cgi = &EUTRAN_CGI;
+    if (ogs_s1ap_lazy_decode_ie(message, S1AP_ProtocolIE_ID_id_TAI,
+                &asn_DEF_S1AP_TAI, &TAI, sizeof(TAI)) == OGS_OK)
+        tai = &TAI;
+
+    handle_uplink_nas_transport(enb,
+            mme_ue_s1ap_id, enb_ue_s1ap_id, nas_pdu, eutran_cgi, tai);
+
+    if (eutran_cgi)
+        ogs_asn_free(&asn_DEF_S1AP_EUTRAN_CGI, eutran_cgi);
+    if (tai)
+        ogs_asn_free(&asn_DEF_S1AP_TAI, tai);
+}
+
 void s1ap_handle_ue_capability_info_indication(
         mme_enb_t *enb, ogs_s1ap_message_t *message)
 {
@@ -1655,51 +1720,15 @@ void s1ap_handle_e_rab_setup_response(
     }
 }
 
-void s1ap_handle_ue_context_release_request(
-        mme_enb_t *enb, ogs_s1ap_message_t *message)
+static void handle_ue_context_release_request(mme_enb_t *enb,
+        S1AP_MME_UE_S1AP_ID_t *MME_UE_S1AP_ID,
+        S1AP_ENB_UE_S1AP_ID_t *ENB_UE_S1AP_ID, S1AP_Cause_t *Cause)
 {
     char buf[OGS_ADDRSTRLEN];
-    int i, r;
-
-    S1AP_InitiatingMessage_t *initiatingMessage = NULL;
-    S1AP_UEContextReleaseRequest_t *UEContextReleaseRequest = NULL;
-
-    S1AP_UEContextReleaseRequest_IEs_t *ie = NULL;
-    S1AP_MME_UE_S1AP_ID_t *MME_UE_S1AP_ID = NULL;
-    S1AP_ENB_UE_S1AP_ID_t *ENB_UE_S1AP_ID = NULL;
-    S1AP_Cause_t *Cause = NULL;
+    int r;
 
     enb_ue_t *enb_ue = NULL;
 
-    ogs_assert(enb);
-    ogs_assert(enb->sctp.sock);
-
-    ogs_assert(message);
-    initiatingMessage = message->choice.initiatingMessage;
-    ogs_assert(initiatingMessage);
-    UEContextReleaseRequest =
-        &initiatingMessage->value.choice.UEContextReleaseRequest;
-    ogs_assert(UEContextReleaseRequest);
-
-    ogs_debug("UEContextReleaseRequest");
-
-    for (i = 0; i < UEContextReleaseRequest->protocolIEs.list.count; i++) {
-        ie = UEContextReleaseRequest->protocolIEs.list.array[i];
-        switch (ie->id) {
-        case S1AP_ProtocolIE_ID_id_MME_UE_S1AP_ID:
-            MME_UE_S1AP_ID = &ie->value.choice.MME_UE_S1AP_ID;
-            break;
-        case S1AP_ProtocolIE_ID_id_eNB_UE_S1AP_ID:
-            ENB_UE_S1AP_ID = &ie->value.choice.ENB_UE_S1AP_ID;
-            break;
-        case S1AP_ProtocolIE_ID_id_Cause:
-            Cause = &ie->value.choice.Cause;
-            break;
-        default:
-            break;
-        }
-    }
-
     ogs_debug("    IP[%s] ENB_ID[%d]",
             OGS_ADDR(enb->sctp.addr, buf), enb->enb_id);
 
@@ -1780,6 +1809,86 @@ void s1ap_handle_ue_context_release_request(
     mme_send_release_access_bearer_or_ue_context_release(enb_ue);
 }
 
+void s1ap_handle_ue_context_release_request(
+        mme_enb_t *enb, ogs_s1ap_message_t *message)
+{
+    int i;
+
+    S1AP_InitiatingMessage_t *initiatingMessage = NULL;
+    S1AP_UEContextReleaseRequest_t *UEContextReleaseRequest = NULL;
+
+    S1AP_UEContextReleaseRequest_IEs_t *ie = NULL;
+    S1AP_MME_UE_S1AP_ID_t *MME_UE_S1AP_ID = NULL;
+    S1AP_ENB_UE_S1AP_ID_t *ENB_UE_S1AP_ID = NULL;
+    S1AP_Cause_t *Cause = NULL;
+
+    ogs_assert(enb);
+    ogs_assert(enb->sctp.sock);
+
+    ogs_assert(message);
+    initiatingMessage = message->choice.initiatingMessage;
+    ogs_assert(initiatingMessage);
+    UEContextReleaseRequest =
+        &initiatingMessage->value.choice.UEContextReleaseRequest;
+    ogs_assert(UEContextReleaseRequest);
+
+    ogs_debug("UEContextReleaseRequest");
+
+    for (i = 0; i < UEContextReleaseRequest->protocolIEs.list.count; i++) {
+        ie = UEContextReleaseRequest->protocolIEs.list.array[i];
+        switch (ie->id) {
+        case S1AP_ProtocolIE_ID_id_MME_UE_S1AP_ID:
+            MME_UE_S1AP_ID = &ie->value.choice.MME_UE_S1AP_ID;
+            break;
+        case S1AP_ProtocolIE_ID_id_eNB_UE_S1AP_ID:
+            ENB_UE_S1AP_ID = &ie->value.choice.ENB_UE_S1AP_ID;
+            break;
+        case S1AP_ProtocolIE_ID_id_Cause:
+            Cause = &ie->value.choice.Cause;
+            break;
+        default:
+            break;
+        }
+    }
+
+    handle_ue_context_release_request(enb,
+            MME_UE_S1AP_ID, ENB_UE_S1AP_ID, Cause);
+}
+
+void s1ap_handle_ue_context_release_request_lazy(
+        mme_enb_t *enb, ogs_s1ap_lazy_message_t *message)
+{
+    S1AP_MME_UE_S1AP_ID_t MME_UE_S1AP_ID, *mme_ue_s1ap_id = NULL;
+    S1AP_ENB_UE_S1AP_ID_t ENB_UE_S1AP_ID, *enb_ue_s1ap_id = NULL;
+    S1AP_Cause_t Cause, *cause = NULL;
+
+    ogs_assert(enb);
+    ogs_assert(enb->sctp.sock);
+
+    ogs_assert(message);
+
+    ogs_debug("UEContextReleaseRequest");
+
+    if (message->mme_ue_s1ap_id_presence) {
+        MME_UE_S1AP_ID = message->mme_ue_s1ap_id;
+        mme_ue_s1ap_id = &MME_UE_S1AP_ID;
+    }
+    if (message->enb_ue_s1ap_id_presence) {
+        ENB_UE_S1AP_ID = message->enb_ue_s1ap_id;
+        enb_ue_s1ap_id = &ENB_UE_S1AP_ID;
+    }
+
+    if (ogs_s1ap_lazy_decode_ie(message, S1AP_ProtocolIE_ID_id_Cause,
+                &asn_DEF_S1AP_Cause, &Cause, sizeof(Cause)) == OGS_OK)
+        cause = &Cause;
+
+    handle_ue_context_release_request(enb,
+            mme_ue_s1ap_id, enb_ue_s1ap_id, cause);
+
+    if (cause)
+        ogs_asn_free(&asn_DEF_S1AP_Cause, cause);
+}
+
 void s1ap_handle_ue_context_release_complete(
         mme_enb_t *enb, ogs_s1ap_message_t *message)
 {
@@ -2853,6 +2962,8 @@ static void s1ap_handle_handover_required_intralte(enb_ue_t *source_ue,
     mme_ue->nhcc++;
     ogs_kdf_nh_enb(mme_ue->kasme, mme_ue->nh, mme_ue->nh);
 
+    mme_ue->handover_start = ogs_get_monotonic_time();
+
     r = s1ap_send_handover_request(
             source_ue, target_enb, &source_ue->handover_type, Cause,
             Source_ToTarget_TransparentContainer);
@@ -3783,6 +3894,13 @@ void s1ap_handle_handover_notification(
     memcpy(&mme_ue->e_cgi, &target_ue->saved.e_cgi, sizeof(ogs_e_cgi_t));
     mme_ue->ue_location_timestamp = ogs_time_now();
 
+    if (mme_ue->handover_start) {
+        mme_metrics_inst_global_add(MME_METR_GLOB_HIST_HANDOVER_TIME,
+                ogs_time_to_msec(ogs_get_monotonic_time() -
+                    mme_ue->handover_start));
+        mme_ue->handover_start = 0;
+    }
+
     r = s1ap_send_ue_context_release_command(source_ue,
             S1AP_Cause_PR_radioNetwork,
             S1AP_CauseRadioNetwork_successful_handover,
@@ -34,6 +34,8 @@ void s1ap_handle_initial_ue_message(
         mme_enb_t *enb, ogs_s1ap_message_t *message);
 void s1ap_handle_uplink_nas_transport(
         mme_enb_t *enb, ogs_s1ap_message_t *message);
+void s1ap_handle_uplink_nas_transport_lazy(
+        mme_enb_t *enb, ogs_s1ap_lazy_message_t *message);
 void s1ap_handle_ue_capability_info_indication(
         mme_enb_t *enb, ogs_s1ap_message_t *message);
 void s1ap_handle_initial_context_setup_response(
@@ -48,6 +50,8 @@ void s1ap_handle_ue_context_modification_failure(
 
 void s1ap_handle_ue_context_release_request(
         mme_enb_t *enb, ogs_s1ap_message_t *message);
+void s1ap_handle_ue_context_release_request_lazy(
+        mme_enb_t *enb, ogs_s1ap_lazy_message_t *message);
 void s1ap_handle_ue_context_release_complete(
         mme_enb_t *enb, ogs_s1ap_message_t *message);
 void s1ap_handle_ue_context_release_action(enb_ue_t *enb_ue);
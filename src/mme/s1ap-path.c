@@ -484,12 +484,15 @@ int s1ap_send_ue_context_release_command(
     return rv;
 }
 
+/*
+ * S1-Paging is queued on the paging area of the UE's TAI and sent when
+ * the loop iteration ends, so the eNBs of an area are looked up once
+ * for every UE paged there and a UE paged twice is sent only once.
+ * All eNBs get a reference to the same encoded PDU.
+ */
 int s1ap_send_paging(mme_ue_t *mme_ue, S1AP_CNDomain_t cn_domain)
 {
-    ogs_pkbuf_t *s1apbuf = NULL;
-    mme_enb_t *enb = NULL;
-    int i;
-    int rv;
+    ogs_paging_area_t *area = NULL;
 
     ogs_debug("S1-Paging");
 
@@ -498,44 +501,58 @@ int s1ap_send_paging(mme_ue_t *mme_ue, S1AP_CNDomain_t cn_domain)
         return OGS_NOTFOUND;
     }
 
-    /* Find enB with matched TAI */
-    ogs_list_for_each(&mme_self()->enb_list, enb) {
-        for (i = 0; i < enb->num_of_supported_ta_list; i++) {
+    area = mme_paging_area_find(&mme_ue->tai);
+    if (area) {
+        if (!mme_ue->t3413.pkbuf) {
+            mme_ue->t3413.pkbuf = s1ap_build_paging(mme_ue, cn_domain);
+            if (!mme_ue->t3413.pkbuf) {
+                ogs_error("s1ap_build_paging() failed");
+                return OGS_ERROR;
+            }
+        }
 
-            if (memcmp(&enb->supported_ta_list[i], &mme_ue->tai,
-                        sizeof(ogs_eps_tai_t)) == 0) {
+        ogs_paging_ue_queue(&mme_self()->paging, area, &mme_ue->paging_ue);
+    }
 
-                if (mme_ue->t3413.pkbuf) {
-                    s1apbuf = mme_ue->t3413.pkbuf;
-                } else {
-                    s1apbuf = s1ap_build_paging(mme_ue, cn_domain);
-                    if (!s1apbuf) {
-                        ogs_error("s1ap_build_paging() failed");
-                        return OGS_ERROR;
-                    }
-                }
+    /* Start T3413 */
+    ogs_timer_start(mme_ue->t3413.timer,
+            mme_timer_cfg(MME_TIMER_T3413)->duration);
+
+    return OGS_OK;
+}
 
-                mme_ue->t3413.pkbuf = ogs_pkbuf_copy(s1apbuf);
-                if (!mme_ue->t3413.pkbuf) {
+void s1ap_paging_flush(void *data)
+{
+    ogs_paging_area_t *area = NULL;
+    ogs_paging_member_t *member = NULL;
+    ogs_paging_ue_t *ue = NULL;
+    ogs_pkbuf_t *s1apbuf = NULL;
+    int rv;
+
+    while ((area = ogs_paging_pending_pop(&mme_self()->paging))) {
+        while ((ue = ogs_paging_ue_pop(area))) {
+            mme_ue_t *mme_ue = ogs_container_of(ue, mme_ue_t, paging_ue);
+
+            /* Paging was stopped before the end of the iteration */
+            if (!mme_ue->t3413.pkbuf)
+                continue;
+
+            ogs_list_for_each(&area->node_list, member) {
+                mme_enb_t *enb = member->node;
+
+                s1apbuf = ogs_pkbuf_copy(mme_ue->t3413.pkbuf);
+                if (!s1apbuf) {
                     ogs_error("ogs_pkbuf_copy() failed");
-                    ogs_pkbuf_free(s1apbuf);
-                    return OGS_ERROR;
+                    break;
                 }
 
                 rv = s1ap_send_to_enb(enb, s1apbuf, S1AP_NON_UE_SIGNALLING);
-                if (rv != OGS_OK) {
-                    ogs_error("s1ap_send_to_enb() failed");
-                    return rv;
-                }
+                if (rv != OGS_OK)
+                    ogs_error("[%s] s1ap_send_to_enb() failed [eNB-ID:0x%x]",
+                            mme_ue->imsi_bcd, enb->enb_id);
             }
         }
     }
-
-    /* Start T3413 */
-    ogs_timer_start(mme_ue->t3413.timer,
-            mme_timer_cfg(MME_TIMER_T3413)->duration);
-
-    return OGS_OK;
 }
 
 int s1ap_send_mme_configuration_transfer(
@@ -30,6 +30,7 @@ static void lksctp_accept_handler(short when, ogs_socket_t fd, void *data);
 
 void s1ap_accept_handler(ogs_sock_t *sock);
 void s1ap_recv_handler(ogs_sock_t *sock);
+static int s1ap_recv_message(ogs_sock_t *sock, ogs_pkbuf_t *rcvbuf);
 
 ogs_sock_t *s1ap_server(ogs_socknode_t *node)
 {
@@ -121,6 +122,30 @@ void s1ap_accept_handler(ogs_sock_t *sock)
 }
 
 void s1ap_recv_handler(ogs_sock_t *sock)
+{
+    ogs_pkbuf_t *rcvbuf;
+    int i;
+
+    ogs_assert(sock);
+
+    /*
+     * Drain up to OGS_SCTP_MAX_RECV_BATCH messages per wakeup. The scratch
+     * buffer is shared by the whole batch and each S1AP message is
+     * copied into a buffer of its own size before being queued.
+     */
+    rcvbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
+    ogs_assert(rcvbuf);
+    ogs_pkbuf_put(rcvbuf, OGS_MAX_SDU_LEN);
+
+    for (i = 0; i < OGS_SCTP_MAX_RECV_BATCH; i++) {
+        if (s1ap_recv_message(sock, rcvbuf) != OGS_OK)
+            break;
+    }
+
+    ogs_pkbuf_free(rcvbuf);
+}
+
+static int s1ap_recv_message(ogs_sock_t *sock, ogs_pkbuf_t *rcvbuf)
 {
     ogs_pkbuf_t *pkbuf;
     int size;
@@ -128,24 +153,23 @@ void s1ap_recv_handler(ogs_sock_t *sock)
     ogs_sockaddr_t from;
     ogs_sctp_info_t sinfo;
     int flags = 0;
+    int rv = OGS_OK;
 
     ogs_assert(sock);
+    ogs_assert(rcvbuf);
 
-    pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
-    ogs_assert(pkbuf);
-    ogs_pkbuf_put(pkbuf, OGS_MAX_SDU_LEN);
     size = ogs_sctp_recvmsg(
-            sock, pkbuf->data, pkbuf->len, &from, &sinfo, &flags);
+            sock, rcvbuf->data, rcvbuf->len, &from, &sinfo, &flags);
     if (size < 0 || size >= OGS_MAX_SDU_LEN) {
-        ogs_error("ogs_sctp_recvmsg(%d) failed(%d:%s)",
-                size, errno, strerror(errno));
-        ogs_pkbuf_free(pkbuf);
-        return;
+        if (size >= 0 || ogs_socket_errno != OGS_EAGAIN)
+            ogs_error("ogs_sctp_recvmsg(%d) failed(%d:%s)",
+                    size, errno, strerror(errno));
+        return OGS_ERROR;
     }
 
     if (flags & MSG_NOTIFICATION) {
         union sctp_notification *not =
-            (union sctp_notification *)pkbuf->data;
+            (union sctp_notification *)rcvbuf->data;
 
         switch(not->sn_header.sn_type) {
         case SCTP_ASSOC_CHANGE :
@@ -182,6 +206,7 @@ void s1ap_recv_handler(ogs_sock_t *sock)
 
                 s1ap_event_push(MME_EVENT_S1AP_LO_CONNREFUSED,
                         sock, addr, NULL, 0, 0);
+                rv = OGS_DONE;
             }
             break;
 
@@ -197,6 +222,7 @@ void s1ap_recv_handler(ogs_sock_t *sock)
 
             s1ap_event_push(MME_EVENT_S1AP_LO_CONNREFUSED,
                     sock, addr, NULL, 0, 0);
+            rv = OGS_DONE;
             break;
 
         case SCTP_SEND_FAILED :
@@ -231,14 +257,15 @@ void s1ap_recv_handler(ogs_sock_t *sock)
             break;
         }
     } else if (flags & MSG_EOR) {
-        ogs_pkbuf_trim(pkbuf, size);
+        pkbuf = ogs_pkbuf_alloc(NULL, size);
+        ogs_assert(pkbuf);
+        ogs_pkbuf_put_data(pkbuf, rcvbuf->data, size);
 
         addr = ogs_calloc(1, sizeof(ogs_sockaddr_t));
         ogs_assert(addr);
         memcpy(addr, &from, sizeof(ogs_sockaddr_t));
 
         s1ap_event_push(MME_EVENT_S1AP_MESSAGE, sock, addr, pkbuf, 0, 0);
-        return;
     } else {
         if (ogs_socket_errno != OGS_EAGAIN) {
             ogs_fatal("ogs_sctp_recvmsg(%d) failed(%d:%s-0x%x)",
@@ -248,7 +275,8 @@ void s1ap_recv_handler(ogs_sock_t *sock)
             ogs_error("ogs_sctp_recvmsg(%d) failed(%d:%s-0x%x)",
                     size, errno, strerror(errno), flags);
         }
+        rv = OGS_ERROR;
     }
 
-    ogs_pkbuf_free(pkbuf);
+    return rv;
 }
@@ -50,6 +50,7 @@ void s1ap_state_operational(ogs_fsm_t *s, mme_event_t *e)
     ogs_pkbuf_t *pkbuf = NULL;
 
     S1AP_S1AP_PDU_t *pdu = NULL;
+    ogs_s1ap_lazy_message_t *lazy = NULL;
     S1AP_InitiatingMessage_t *initiatingMessage = NULL;
     S1AP_SuccessfulOutcome_t *successfulOutcome = NULL;
     S1AP_UnsuccessfulOutcome_t *unsuccessfulOutcome = NULL;
@@ -68,6 +69,27 @@ void s1ap_state_operational(ogs_fsm_t *s, mme_event_t *e)
     case OGS_FSM_EXIT_SIG:
         break;
     case MME_EVENT_S1AP_MESSAGE:
+        lazy = e->s1ap_lazy_message;
+        if (lazy) {
+            /* Only sent by mme_state_operational() after S1 Setup */
+            ogs_assert(enb->state.s1_setup_success);
+            ogs_assert(lazy->h.present == S1AP_S1AP_PDU_PR_initiatingMessage);
+
+            switch (lazy->h.procedureCode) {
+            case S1AP_ProcedureCode_id_uplinkNASTransport :
+                s1ap_handle_uplink_nas_transport_lazy(enb, lazy);
+                break;
+            case S1AP_ProcedureCode_id_UEContextReleaseRequest:
+                s1ap_handle_ue_context_release_request_lazy(enb, lazy);
+                break;
+            default:
+                ogs_error("Not implemented(lazy, proc:%d)",
+                        (int)lazy->h.procedureCode);
+                break;
+            }
+            break;
+        }
+
         pdu = e->s1ap_message;
         ogs_assert(pdu);
 
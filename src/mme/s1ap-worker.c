@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2024 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "mme-context.h"
+#include "s1ap-worker.h"
+
+static ogs_worker_t *worker = NULL;
+
+static void s1ap_worker_decode(void *data);
+static void s1ap_worker_event_free(void *data);
+
+int s1ap_worker_open(int num_of_worker)
+{
+    ogs_assert(worker == NULL);
+
+    if (num_of_worker <= 0)
+        return OGS_OK;
+
+    worker = ogs_worker_create("S1AP", num_of_worker,
+            s1ap_worker_decode, s1ap_worker_event_free);
+    if (!worker)
+        return OGS_ERROR;
+
+    return OGS_OK;
+}
+
+void s1ap_worker_close(void)
+{
+    if (!worker)
+        return;
+
+    ogs_worker_destroy(worker);
+    worker = NULL;
+}
+
+bool s1ap_worker_enabled(void)
+{
+    return worker != NULL;
+}
+
+int s1ap_worker_push(mme_event_t *e)
+{
+    int klen = sizeof(ogs_sockaddr_t);
+
+    ogs_assert(e);
+    ogs_assert(e->addr);
+    ogs_assert(worker);
+
+    return ogs_worker_push(worker,
+            ogs_hashfunc_default((const char *)e->addr, &klen), e);
+}
+
+/*
+ * On success, e->s1ap_message holds the decoded PDU, which the main loop
+ * releases after dispatching. Messages that the main loop handles with
+ * ogs_s1ap_lazy_decode() are passed through untouched, as are messages
+ * that fail to decode so that the main loop can report the error.
+ */
+static void s1ap_worker_decode(void *data)
+{
+    mme_event_t *e = data;
+    ogs_s1ap_lazy_message_t lazy;
+    ogs_s1ap_message_t *message = NULL;
+    int rv;
+
+    ogs_assert(e);
+
+    if (e->id != MME_EVENT_S1AP_MESSAGE)
+        return;
+
+    ogs_assert(e->pkbuf);
+
+    rv = ogs_s1ap_lazy_decode(&lazy, e->pkbuf);
+    if (rv == OGS_OK &&
+        lazy.h.present == S1AP_S1AP_PDU_PR_initiatingMessage &&
+        (lazy.h.procedureCode == S1AP_ProcedureCode_id_uplinkNASTransport ||
+         lazy.h.procedureCode ==
+            S1AP_ProcedureCode_id_UEContextReleaseRequest))
+        return;
+
+    message = ogs_calloc(1, sizeof(*message));
+    ogs_assert(message);
+
+    rv = ogs_s1ap_decode(message, e->pkbuf);
+    if (rv != OGS_OK) {
+        ogs_s1ap_free(message);
+        ogs_free(message);
+        return;
+    }
+
+    e->s1ap_message = message;
+}
+
+static void s1ap_worker_event_free(void *data)
+{
+    mme_event_t *e = data;
+
+    ogs_assert(e);
+
+    if (e->s1ap_message) {
+        ogs_s1ap_free(e->s1ap_message);
+        ogs_free(e->s1ap_message);
+    }
+    if (e->addr)
+        ogs_free(e->addr);
+    if (e->pkbuf)
+        ogs_pkbuf_free(e->pkbuf);
+    mme_event_free(e);
+}
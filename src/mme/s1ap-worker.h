@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2024 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef S1AP_WORKER_H
+#define S1AP_WORKER_H
+
+#include "mme-event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * S1AP worker threads take the ASN.1 decoding of incoming S1AP-PDUs off
+ * the MME main loop. SCTP events are sharded by eNB association, so all
+ * messages of one eNB (and therefore of every UE served by it) are
+ * handled by the same worker and reach the main loop in arrival order.
+ * All MME context (eNB, eNB-UE, MME-UE) stays owned by the main loop.
+ */
+int s1ap_worker_open(int num_of_worker);
+void s1ap_worker_close(void);
+
+bool s1ap_worker_enabled(void);
+int s1ap_worker_push(mme_event_t *e);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* S1AP_WORKER_H */
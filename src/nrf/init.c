@@ -89,11 +89,18 @@ void nrf_terminate(void)
     ogs_sbi_context_final();
 }
 
+static const char *nrf_prof_event_name(void *event)
+{
+    return nrf_event_get_name(event);
+}
+
 static void nrf_main(void *data)
 {
     ogs_fsm_t nrf_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            nrf_prof_event_name);
     ogs_fsm_init(&nrf_sm, nrf_state_initial, nrf_state_final, 0);
 
     for ( ;; ) {
@@ -113,10 +120,14 @@ static void nrf_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            nrf_event_t *e = NULL;
+            nrf_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -125,9 +136,11 @@ static void nrf_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&nrf_sm, e);
-            ogs_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&nrf_sm, e[i]);
+                ogs_event_free(e[i]);
+            }
         }
     }
 done:
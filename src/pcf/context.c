@@ -42,9 +42,9 @@ void pcf_context_init(void)
     ogs_log_install_domain(&__ogs_dbi_domain, "dbi", ogs_core()->log.level);
     ogs_log_install_domain(&__pcf_log_domain, "pcf", ogs_core()->log.level);
 
-    ogs_pool_init(&pcf_ue_pool, ogs_global_conf()->max.ue);
-    ogs_pool_init(&pcf_sess_pool, ogs_app()->pool.sess);
-    ogs_pool_init(&pcf_app_pool, ogs_app()->pool.sess);
+    ogs_pool_init_elastic(&pcf_ue_pool, ogs_global_conf()->max.ue);
+    ogs_pool_init_elastic(&pcf_sess_pool, ogs_app()->pool.sess);
+    ogs_pool_init_elastic(&pcf_app_pool, ogs_app()->pool.sess);
 
     ogs_list_init(&self.pcf_ue_list);
 
@@ -47,6 +47,9 @@ int pcf_initialize(void)
     rv = ogs_metrics_context_parse_config(APP_NAME);
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_app_reload_add("metrics", ogs_metrics_context_reload_config);
+    if (rv != OGS_OK) return rv;
+
     rv = pcf_context_parse_config();
     if (rv != OGS_OK) return rv;
 
@@ -112,11 +115,18 @@ void pcf_terminate(void)
     pcf_metrics_final();
 }
 
+static const char *pcf_prof_event_name(void *event)
+{
+    return pcf_event_get_name(event);
+}
+
 static void pcf_main(void *data)
 {
     ogs_fsm_t pcf_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            pcf_prof_event_name);
     ogs_fsm_init(&pcf_sm, pcf_state_initial, pcf_state_final, 0);
 
     for ( ;; ) {
@@ -136,10 +146,14 @@ static void pcf_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            pcf_event_t *e = NULL;
+            pcf_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -148,9 +162,11 @@ static void pcf_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&pcf_sm, e);
-            ogs_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&pcf_sm, e[i]);
+                ogs_event_free(e[i]);
+            }
         }
     }
 done:
@@ -47,6 +47,9 @@ int pcrf_initialize(void)
     rv = ogs_metrics_context_parse_config(APP_NAME);
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_app_reload_add("metrics", ogs_metrics_context_reload_config);
+    if (rv != OGS_OK) return rv;
+
     rv = pcrf_context_parse_config();
     if (rv != OGS_OK) return rv;
 
@@ -89,11 +92,18 @@ void pcrf_terminate(void)
     return;
 }
 
+static const char *pcrf_prof_event_name(void *event)
+{
+    return pcrf_event_get_name(event);
+}
+
 static void pcrf_main(void *data)
 {
     ogs_fsm_t pcrf_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            pcrf_prof_event_name);
     ogs_fsm_init(&pcrf_sm, pcrf_state_initial, pcrf_state_final, 0);
 
     for ( ;; ) {
@@ -113,10 +123,14 @@ static void pcrf_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            pcrf_event_t *e = NULL;
+            pcrf_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -125,9 +139,11 @@ static void pcrf_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&pcrf_sm, e);
-            pcrf_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&pcrf_sm, e[i]);
+                pcrf_event_free(e[i]);
+            }
         }
     }
 done:
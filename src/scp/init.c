@@ -93,11 +93,18 @@ void scp_terminate(void)
     ogs_sbi_context_final();
 }
 
+static const char *scp_prof_event_name(void *event)
+{
+    return scp_event_get_name(event);
+}
+
 static void scp_main(void *data)
 {
     ogs_fsm_t scp_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            scp_prof_event_name);
     ogs_fsm_init(&scp_sm, scp_state_initial, scp_state_final, 0);
 
     for ( ;; ) {
@@ -117,10 +124,14 @@ static void scp_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            scp_event_t *e = NULL;
+            scp_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -129,9 +140,11 @@ static void scp_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&scp_sm, e);
-            ogs_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&scp_sm, e[i]);
+                ogs_event_free(e[i]);
+            }
         }
     }
 done:
@@ -49,14 +49,14 @@ void sgwc_context_init(void)
 
     ogs_log_install_domain(&__sgwc_log_domain, "sgwc", ogs_core()->log.level);
 
-    ogs_pool_init(&sgwc_bearer_pool, ogs_app()->pool.bearer);
-    ogs_pool_init(&sgwc_tunnel_pool, ogs_app()->pool.tunnel);
+    ogs_pool_init_elastic(&sgwc_bearer_pool, ogs_app()->pool.bearer);
+    ogs_pool_init_elastic(&sgwc_tunnel_pool, ogs_app()->pool.tunnel);
 
-    ogs_pool_init(&sgwc_ue_pool, ogs_global_conf()->max.ue);
+    ogs_pool_init_elastic(&sgwc_ue_pool, ogs_global_conf()->max.ue);
     ogs_pool_init(&sgwc_s11_teid_pool, ogs_global_conf()->max.ue);
     ogs_pool_random_id_generate(&sgwc_s11_teid_pool);
 
-    ogs_pool_init(&sgwc_sess_pool, ogs_app()->pool.sess);
+    ogs_pool_init_elastic(&sgwc_sess_pool, ogs_app()->pool.sess);
     ogs_pool_init(&sgwc_sxa_seid_pool, ogs_app()->pool.sess);
     ogs_pool_random_id_generate(&sgwc_sxa_seid_pool);
 
@@ -43,7 +43,7 @@ void sgwu_context_init(void)
     ogs_pfcp_self()->up_function_features_len = 2;
 
     ogs_list_init(&self.sess_list);
-    ogs_pool_init(&sgwu_sess_pool, ogs_app()->pool.sess);
+    ogs_pool_init_elastic(&sgwu_sess_pool, ogs_app()->pool.sess);
     ogs_pool_init(&sgwu_sxa_seid_pool, ogs_app()->pool.sess);
     ogs_pool_random_id_generate(&sgwu_sxa_seid_pool);
 
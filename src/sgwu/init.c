@@ -93,11 +93,18 @@ void sgwu_terminate(void)
     sgwu_event_final();
 }
 
+static const char *sgwu_prof_event_name(void *event)
+{
+    return sgwu_event_get_name(event);
+}
+
 static void sgwu_main(void *data)
 {
     ogs_fsm_t sgwu_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            sgwu_prof_event_name);
     ogs_fsm_init(&sgwu_sm, sgwu_state_initial, sgwu_state_final, 0);
 
     for ( ;; ) {
@@ -117,10 +124,14 @@ static void sgwu_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            sgwu_event_t *e = NULL;
+            sgwu_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -129,9 +140,11 @@ static void sgwu_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&sgwu_sm, e);
-            sgwu_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&sgwu_sm, e[i]);
+                sgwu_event_free(e[i]);
+            }
         }
     }
 done:
@@ -316,7 +316,8 @@ int sgwu_pfcp_send_session_report_request(
         return OGS_ERROR;
     }
 
-    sxabuf = ogs_pfcp_build_session_report_request(h.type, report);
+    sxabuf = ogs_pfcp_build_session_report_request(
+            h.type, sess->pfcp_node, report);
     if (!sxabuf) {
         ogs_error("ogs_pfcp_build_session_report_request() failed");
         return OGS_ERROR;
@@ -265,6 +265,11 @@ void sgwu_sxa_handle_session_modification_request(
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
         goto cleanup;
 
+    ogs_pfcp_handle_update_bar(&sess->pfcp, &req->update_bar,
+                &cause_value, &offending_ie_value);
+    if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
+        goto cleanup;
+
     ogs_pfcp_handle_remove_bar(&sess->pfcp, &req->remove_bar,
             &cause_value, &offending_ie_value);
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
@@ -42,6 +42,10 @@ static int num_of_smf_sess = 0;
 static void stats_add_smf_session(void);
 static void stats_remove_smf_session(smf_sess_t *sess);
 
+static ogs_pfcp_ue_ip_t *ue_ip_alloc(
+        uint8_t *cause_value, int family, const char *dnn, uint8_t *addr);
+static void ue_ip_free(ogs_pfcp_ue_ip_t *ue_ip);
+
 int smf_ctf_config_init(smf_ctf_config_t *ctf_config)
 {
     ctf_config->enabled = SMF_CTF_ENABLED_AUTO;
@@ -81,13 +85,17 @@ void smf_context_init(void)
     ogs_log_install_domain(&__smf_log_domain, "smf", ogs_core()->log.level);
     ogs_log_install_domain(&__gsm_log_domain, "gsm", ogs_core()->log.level);
 
+    /* Load and Overload Control Information from the UPFs are used */
+    ogs_pfcp_self()->cp_function_features.load = 1;
+    ogs_pfcp_self()->cp_function_features.ovrl = 1;
+
     ogs_pool_init(&smf_gtp_node_pool, ogs_app()->pool.nf);
-    ogs_pool_init(&smf_ue_pool, ogs_global_conf()->max.ue);
-    ogs_pool_init(&smf_bearer_pool, ogs_app()->pool.bearer);
-    ogs_pool_init(&smf_pf_pool,
+    ogs_pool_init_elastic(&smf_ue_pool, ogs_global_conf()->max.ue);
+    ogs_pool_init_elastic(&smf_bearer_pool, ogs_app()->pool.bearer);
+    ogs_pool_init_elastic(&smf_pf_pool,
             ogs_app()->pool.bearer * OGS_MAX_NUM_OF_FLOW_IN_BEARER);
 
-    ogs_pool_init(&smf_sess_pool, ogs_app()->pool.sess);
+    ogs_pool_init_elastic(&smf_sess_pool, ogs_app()->pool.sess);
     ogs_pool_init(&smf_n4_seid_pool, ogs_app()->pool.sess);
     ogs_pool_random_id_generate(&smf_n4_seid_pool);
 
@@ -541,6 +549,9 @@ int smf_context_parse_config(void)
                             YAML_SCALAR_NODE);
                     self.mtu = atoi(ogs_yaml_iter_value(&smf_iter));
                     ogs_assert(self.mtu);
+                } else if (!strcmp(smf_key, "sbi_worker")) {
+                    const char *v = ogs_yaml_iter_value(&smf_iter);
+                    if (v) self.num_of_sbi_worker = atoi(v);
                 } else if (!strcmp(smf_key, "p-cscf")) {
                     ogs_yaml_iter_t p_cscf_iter;
                     ogs_yaml_iter_recurse(&smf_iter, &p_cscf_iter);
@@ -1140,67 +1151,82 @@ static bool compare_ue_info(ogs_pfcp_node_t *node, smf_sess_t *sess)
     return false;
 }
 
-static ogs_pfcp_node_t *selected_upf_node(
-        ogs_pfcp_node_t *current, smf_sess_t *sess)
+/*
+ * Smooth weighted round-robin over the associated UPFs, see
+ * ogs_pfcp_node_rr_offer(). UPFs matching the UE location or DNN are
+ * preferred over the rest. An overloaded UPF turns away the share of
+ * new sessions given by its Overload Reduction Metric; they go to
+ * another UPF if any.
+ */
+static ogs_pfcp_node_t *selected_upf_node(smf_sess_t *sess, bool *throttled)
 {
-    ogs_pfcp_node_t *next, *node;
+    ogs_pfcp_node_t *node, *selected = NULL;
+    ogs_pfcp_node_rr_t rr;
+    int pass;
+    char buf[OGS_ADDRSTRLEN];
 
-    ogs_assert(current);
     ogs_assert(sess);
+    ogs_assert(throttled);
 
-    /* continue search from current position */
-    next = ogs_list_next(current);
-    for (node = next; node; node = ogs_list_next(node)) {
-        if (OGS_FSM_CHECK(&node->sm, smf_pfcp_state_associated) &&
-            compare_ue_info(node, sess) == true) return node;
-    }
-    /* cyclic search from top to current position */
-    for (node = ogs_list_first(&ogs_pfcp_self()->pfcp_peer_list);
-            node != next; node = ogs_list_next(node)) {
-        if (OGS_FSM_CHECK(&node->sm, smf_pfcp_state_associated) &&
-            compare_ue_info(node, sess) == true) return node;
-    }
-
-    if (ogs_global_conf()->parameter.no_pfcp_rr_select == 0) {
-        /* continue search from current position */
-        next = ogs_list_next(current);
-        for (node = next; node; node = ogs_list_next(node)) {
-            if (OGS_FSM_CHECK(&node->sm, smf_pfcp_state_associated))
-                return node;
-        }
-        /* cyclic search from top to current position */
-        for (node = ogs_list_first(&ogs_pfcp_self()->pfcp_peer_list);
-                node != next; node = ogs_list_next(node)) {
-            if (OGS_FSM_CHECK(&node->sm, smf_pfcp_state_associated))
-                return node;
+    *throttled = false;
+    memset(&rr, 0, sizeof(rr));
+
+    for (pass = 0; pass < 2 && !rr.selected; pass++) {
+        if (pass == 1 && ogs_global_conf()->parameter.no_pfcp_rr_select)
+            break;
+
+        ogs_list_for_each(&ogs_pfcp_self()->pfcp_peer_list, node) {
+            if (!OGS_FSM_CHECK(&node->sm, smf_pfcp_state_associated))
+                continue;
+            if (pass == 0 && compare_ue_info(node, sess) == false)
+                continue;
+
+            if (ogs_pfcp_node_throttled(node)) {
+                smf_metrics_inst_by_upf_add(OGS_ADDR(&node->addr, buf),
+                        SMF_METR_CTR_UPF_THROTTLED, 1);
+                *throttled = true;
+                continue;
+            }
+
+            ogs_pfcp_node_rr_offer(&rr, node);
         }
     }
 
+    selected = ogs_pfcp_node_rr_select(&rr);
+    if (selected) {
+        *throttled = false;
+
+        smf_metrics_inst_by_upf_add(OGS_ADDR(&selected->addr, buf),
+                SMF_METR_CTR_UPF_SELECTED, 1);
+        return selected;
+    }
+
+    if (*throttled)
+        return NULL;
+
     ogs_error("No UPFs are PFCP associated that are suited to RR");
     return ogs_list_first(&ogs_pfcp_self()->pfcp_peer_list);
 }
 
-void smf_sess_select_upf(smf_sess_t *sess)
+bool smf_sess_select_upf(smf_sess_t *sess)
 {
     char buf[OGS_ADDRSTRLEN];
+    ogs_pfcp_node_t *node = NULL;
+    bool throttled = false;
 
     ogs_assert(sess);
 
-    /*
-     * When used for the first time, if last node is set,
-     * the search is performed from the first UPF in a round-robin manner.
-     */
-    if (ogs_pfcp_self()->pfcp_node == NULL)
-        ogs_pfcp_self()->pfcp_node =
-            ogs_list_last(&ogs_pfcp_self()->pfcp_peer_list);
-
     /* setup GTP session with selected UPF */
-    ogs_pfcp_self()->pfcp_node =
-        selected_upf_node(ogs_pfcp_self()->pfcp_node, sess);
-    ogs_assert(ogs_pfcp_self()->pfcp_node);
-    OGS_SETUP_PFCP_NODE(sess, ogs_pfcp_self()->pfcp_node);
-    ogs_debug("UE using UPF on IP[%s]",
-            OGS_ADDR(&ogs_pfcp_self()->pfcp_node->addr, buf));
+    node = selected_upf_node(sess, &throttled);
+    if (!node) {
+        ogs_warn("New session throttled by UPF overload control");
+        return false;
+    }
+
+    OGS_SETUP_PFCP_NODE(sess, node);
+    ogs_debug("UE using UPF on IP[%s]", OGS_ADDR(&node->addr, buf));
+
+    return true;
 }
 
 smf_sess_t *smf_sess_add_by_apn(smf_ue_t *smf_ue, char *apn, uint8_t rat_type)
@@ -1579,16 +1605,16 @@ uint8_t smf_sess_set_ue_ip(smf_sess_t *sess)
     if (sess->ipv4) {
         ogs_hash_set(smf_self()->ipv4_hash,
                 sess->ipv4->addr, OGS_IPV4_LEN, NULL);
-        ogs_pfcp_ue_ip_free(sess->ipv4);
+        ue_ip_free(sess->ipv4);
     }
     if (sess->ipv6) {
         ogs_hash_set(smf_self()->ipv6_hash,
                 sess->ipv6->addr, OGS_IPV6_DEFAULT_PREFIX_LEN >> 3, NULL);
-        ogs_pfcp_ue_ip_free(sess->ipv6);
+        ue_ip_free(sess->ipv6);
     }
 
     if (sess->session.session_type == OGS_PDU_SESSION_TYPE_IPV4) {
-        sess->ipv4 = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET,
+        sess->ipv4 = ue_ip_alloc(&cause_value, AF_INET,
                 sess->session.name, (uint8_t *)&sess->session.ue_ip.addr);
         if (!sess->ipv4) {
             ogs_error("ogs_pfcp_ue_ip_alloc() failed[%d]", cause_value);
@@ -1598,7 +1624,7 @@ uint8_t smf_sess_set_ue_ip(smf_sess_t *sess)
         ogs_hash_set(smf_self()->ipv4_hash,
                 sess->ipv4->addr, OGS_IPV4_LEN, sess);
     } else if (sess->session.session_type == OGS_PDU_SESSION_TYPE_IPV6) {
-        sess->ipv6 = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET6,
+        sess->ipv6 = ue_ip_alloc(&cause_value, AF_INET6,
                 sess->session.name, sess->session.ue_ip.addr6);
         if (!sess->ipv6) {
             ogs_error("ogs_pfcp_ue_ip_alloc() failed[%d]", cause_value);
@@ -1613,13 +1639,13 @@ uint8_t smf_sess_set_ue_ip(smf_sess_t *sess)
         ogs_hash_set(smf_self()->ipv6_hash,
                 sess->ipv6->addr, OGS_IPV6_DEFAULT_PREFIX_LEN >> 3, sess);
     } else if (sess->session.session_type == OGS_PDU_SESSION_TYPE_IPV4V6) {
-        sess->ipv4 = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET,
+        sess->ipv4 = ue_ip_alloc(&cause_value, AF_INET,
                 sess->session.name, (uint8_t *)&sess->session.ue_ip.addr);
         if (!sess->ipv4) {
             ogs_error("ogs_pfcp_ue_ip_alloc() failed[%d]", cause_value);
             return cause_value;
         }
-        sess->ipv6 = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET6,
+        sess->ipv6 = ue_ip_alloc(&cause_value, AF_INET6,
                 sess->session.name, sess->session.ue_ip.addr6);
         if (!sess->ipv6) {
             ogs_error("ogs_pfcp_ue_ip_alloc() failed[%d]", cause_value);
@@ -1627,7 +1653,7 @@ uint8_t smf_sess_set_ue_ip(smf_sess_t *sess)
             if (sess->ipv4) {
                 ogs_hash_set(smf_self()->ipv4_hash,
                         sess->ipv4->addr, OGS_IPV4_LEN, NULL);
-                ogs_pfcp_ue_ip_free(sess->ipv4);
+                ue_ip_free(sess->ipv4);
                 sess->ipv4 = NULL;
             }
             return cause_value;
@@ -1719,12 +1745,12 @@ void smf_sess_remove(smf_sess_t *sess)
 
     if (sess->ipv4) {
         ogs_hash_set(self.ipv4_hash, sess->ipv4->addr, OGS_IPV4_LEN, NULL);
-        ogs_pfcp_ue_ip_free(sess->ipv4);
+        ue_ip_free(sess->ipv4);
     }
     if (sess->ipv6) {
         ogs_hash_set(self.ipv6_hash,
                 sess->ipv6->addr, OGS_IPV6_DEFAULT_PREFIX_LEN >> 3, NULL);
-        ogs_pfcp_ue_ip_free(sess->ipv6);
+        ue_ip_free(sess->ipv6);
     }
 
     if (sess->paging.n1n2message_location) {
@@ -2654,6 +2680,7 @@ void smf_bearer_tft_update(smf_bearer_t *bearer)
 {
     smf_pf_t *pf = NULL;
     ogs_pfcp_pdr_t *dl_pdr = NULL, *ul_pdr = NULL;
+    ogs_pfcp_pdr_flow_t *flow = NULL;
 
     ogs_assert(bearer);
 
@@ -2667,25 +2694,22 @@ void smf_bearer_tft_update(smf_bearer_t *bearer)
 
     ogs_list_for_each(&bearer->pf_list, pf) {
         if (pf->direction == OGS_FLOW_DOWNLINK_ONLY) {
-            dl_pdr->flow[dl_pdr->num_of_flow].fd = 1;
-            dl_pdr->flow[dl_pdr->num_of_flow].description =
-                pf->flow_description;
-            dl_pdr->num_of_flow++;
+            flow = ogs_pfcp_pdr_flow_add(dl_pdr);
+            flow->fd = 1;
+            flow->description = pf->flow_description;
         } else if (pf->direction == OGS_FLOW_UPLINK_ONLY) {
-            ul_pdr->flow[ul_pdr->num_of_flow].fd = 1;
-            ul_pdr->flow[ul_pdr->num_of_flow].description =
-                pf->flow_description;
-            ul_pdr->num_of_flow++;
+            flow = ogs_pfcp_pdr_flow_add(ul_pdr);
+            flow->fd = 1;
+            flow->description = pf->flow_description;
         } else if (pf->direction == OGS_FLOW_BIDIRECTIONAL) {
-            dl_pdr->flow[dl_pdr->num_of_flow].fd = 1;
-            dl_pdr->flow[dl_pdr->num_of_flow].description =
-                pf->flow_description;
-            dl_pdr->flow[dl_pdr->num_of_flow].bid = 1;
-            dl_pdr->flow[dl_pdr->num_of_flow].sdf_filter_id = pf->sdf_filter_id;
-            dl_pdr->num_of_flow++;
-            ul_pdr->flow[ul_pdr->num_of_flow].bid = 1;
-            ul_pdr->flow[ul_pdr->num_of_flow].sdf_filter_id = pf->sdf_filter_id;
-            ul_pdr->num_of_flow++;
+            flow = ogs_pfcp_pdr_flow_add(dl_pdr);
+            flow->fd = 1;
+            flow->description = pf->flow_description;
+            flow->bid = 1;
+            flow->sdf_filter_id = pf->sdf_filter_id;
+            flow = ogs_pfcp_pdr_flow_add(ul_pdr);
+            flow->bid = 1;
+            flow->sdf_filter_id = pf->sdf_filter_id;
         } else {
             ogs_fatal("Unsupported direction [%d]", pf->direction);
             ogs_assert_if_reached();
@@ -3200,6 +3224,56 @@ static void stats_remove_smf_session(smf_sess_t *sess)
     ogs_info("[Removed] Number of SMF-Sessions is now %d", num_of_smf_sess);
 }
 
+void smf_ue_ip_pool_update_metrics(ogs_pfcp_subnet_t *subnet)
+{
+    char *addr = NULL;
+    char buf[OGS_ADDRSTRLEN+4];
+
+    ogs_assert(subnet);
+
+    if (subnet->family == AF_INET)
+        addr = ogs_ipv4_to_string(subnet->sub.sub[0]);
+    else if (subnet->family == AF_INET6)
+        addr = ogs_ipv6addr_to_string((uint8_t *)subnet->sub.sub);
+    else
+        return;
+    ogs_assert(addr);
+
+    ogs_snprintf(buf, sizeof(buf), "%s/%d", addr, subnet->prefixlen);
+    ogs_free(addr);
+
+    smf_metrics_inst_by_subnet_set(subnet->dnn, buf,
+            SMF_METR_GAUGE_UE_IP_POOL_CAPACITY, subnet->pool.capacity);
+    smf_metrics_inst_by_subnet_set(subnet->dnn, buf,
+            SMF_METR_GAUGE_UE_IP_POOL_INUSE,
+            subnet->pool.capacity - subnet->pool.avail +
+            subnet->pool.num_of_static);
+}
+
+static ogs_pfcp_ue_ip_t *ue_ip_alloc(
+        uint8_t *cause_value, int family, const char *dnn, uint8_t *addr)
+{
+    ogs_pfcp_ue_ip_t *ue_ip = NULL;
+
+    ue_ip = ogs_pfcp_ue_ip_alloc(cause_value, family, dnn, addr);
+    if (ue_ip)
+        smf_ue_ip_pool_update_metrics(ue_ip->subnet);
+
+    return ue_ip;
+}
+
+static void ue_ip_free(ogs_pfcp_ue_ip_t *ue_ip)
+{
+    ogs_pfcp_subnet_t *subnet = NULL;
+
+    ogs_assert(ue_ip);
+    subnet = ue_ip->subnet;
+    ogs_assert(subnet);
+
+    ogs_pfcp_ue_ip_free(ue_ip);
+    smf_ue_ip_pool_update_metrics(subnet);
+}
+
 int smf_instance_get_load(void)
 {
     return (((ogs_pool_size(&smf_sess_pool) -
@@ -93,6 +93,8 @@ typedef struct smf_context_s {
 
     uint16_t        mtu;            /* MTU to advertise in PCO */
 
+    int             num_of_sbi_worker; /* SBI Parsing Threads */
+
     struct  {
         const char *integrity_protection_indication;
         const char *confidentiality_protection_indication;
@@ -241,6 +243,7 @@ typedef struct smf_sess_s {
         uint32_t gy_cca_term_err; /* Gy CCA RXed error code */
         bool s6b_str_in_flight; /* Waiting for S6B CCA */
         uint32_t s6b_sta_err; /* S6B CCA RXed error code */
+        ogs_time_t establishment_start; /* Entry into initial state */
     } sm_data;
 
     bool            epc;            /**< EPC or 5GC */
@@ -537,7 +540,7 @@ smf_sess_t *smf_sess_add_by_apn(smf_ue_t *smf_ue, char *apn, uint8_t rat_type);
 smf_sess_t *smf_sess_add_by_sbi_message(ogs_sbi_message_t *message);
 smf_sess_t *smf_sess_add_by_psi(smf_ue_t *smf_ue, uint8_t psi);
 
-void smf_sess_select_upf(smf_sess_t *sess);
+bool smf_sess_select_upf(smf_sess_t *sess);
 uint8_t smf_sess_set_ue_ip(smf_sess_t *sess);
 void smf_sess_set_paging_n1n2message_location(
         smf_sess_t *sess, char *n1n2message_location);
@@ -619,6 +622,7 @@ int smf_maximum_integrity_protected_data_rate_uplink_value2enum(
         const char *value);
 int smf_maximum_integrity_protected_data_rate_downlink_value2enum(
         const char *value);
+void smf_ue_ip_pool_update_metrics(ogs_pfcp_subnet_t *subnet);
 int smf_instance_get_load(void);
 
 #ifdef __cplusplus
@@ -282,7 +282,8 @@ uint8_t smf_gn_handle_create_pdp_context_request(
     }
 
     /* Select PGW based on UE Location Information */
-    smf_sess_select_upf(sess);
+    if (smf_sess_select_upf(sess) == false)
+        return OGS_GTP1_CAUSE_NO_RESOURCES_AVAILABLE;
 
     /* Check if selected PGW is associated with SMF */
     ogs_assert(sess->pfcp_node);
@@ -194,6 +194,7 @@ void smf_gsm_state_initial(ogs_fsm_t *s, smf_event_t *e)
         sess->sm_data.s6b_aaa_err = ER_DIAMETER_SUCCESS;
         sess->sm_data.gx_cca_init_err = ER_DIAMETER_SUCCESS;
         sess->sm_data.gy_cca_init_err = ER_DIAMETER_SUCCESS;
+        sess->sm_data.establishment_start = ogs_get_monotonic_time();
         break;
 
     case OGS_FSM_EXIT_SIG:
@@ -755,6 +756,11 @@ void smf_gsm_state_wait_pfcp_establishment(ogs_fsm_t *s, smf_event_t *e)
                 smf_namf_comm_send_n1_n2_message_transfer(sess, &param);
             }
 
+            smf_metrics_inst_global_add(
+                    SMF_METR_GLOB_HIST_SM_PDU_SESSION_CREATION_TIME,
+                    ogs_time_to_msec(ogs_get_monotonic_time() -
+                        sess->sm_data.establishment_start));
+
             OGS_FSM_TRAN(s, smf_gsm_state_operational);
             break;
 
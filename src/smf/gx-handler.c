@@ -42,6 +42,7 @@ uint32_t smf_gx_handle_cca_initial_request(
     ogs_pfcp_pdr_t *cp2up_pdr = NULL;
     ogs_pfcp_pdr_t *up2cp_pdr = NULL;
     ogs_pfcp_far_t *up2cp_far = NULL;
+    ogs_pfcp_pdr_flow_t *flow = NULL;
 
     ogs_assert(sess);
     ogs_assert(gx_message);
@@ -162,10 +163,9 @@ uint32_t smf_gx_handle_cca_initial_request(
             &ul_pdr->ue_ip_addr, &ul_pdr->ue_ip_addr_len));
 
     /* Set UE-to-CP Flow-Description and Outer-Header-Creation */
-    up2cp_pdr->flow[up2cp_pdr->num_of_flow].fd = 1;
-    up2cp_pdr->flow[up2cp_pdr->num_of_flow].description =
-        (char *)"permit out 58 from ff02::2/128 to assigned";
-    up2cp_pdr->num_of_flow++;
+    flow = ogs_pfcp_pdr_flow_add(up2cp_pdr);
+    flow->fd = 1;
+    flow->description = (char *)"permit out 58 from ff02::2/128 to assigned";
 
     ogs_assert(OGS_OK ==
         ogs_pfcp_ip_to_outer_header_creation(
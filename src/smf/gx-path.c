@@ -1080,8 +1080,6 @@ out:
             OGS_SESSION_DATA_FREE(&gx_message->session_data);
             ogs_free(gx_message);
             ogs_event_free(e);
-        } else {
-            ogs_pollset_notify(ogs_app()->pollset);
         }
     } else {
         OGS_SESSION_DATA_FREE(&gx_message->session_data);
@@ -1326,8 +1324,6 @@ static int smf_gx_rar_cb( struct msg **msg, struct avp *avp,
         OGS_SESSION_DATA_FREE(&gx_message->session_data);
         ogs_free(gx_message);
         ogs_event_free(e);
-    } else {
-        ogs_pollset_notify(ogs_app()->pollset);
     }
 
     /* Set the Auth-Application-Id AVP */
@@ -1209,8 +1209,6 @@ out:
             ogs_error("ogs_queue_push() failed:%d", (int)rv);
             ogs_free(gy_message);
             ogs_event_free(e);
-        } else {
-            ogs_pollset_notify(ogs_app()->pollset);
         }
     } else {
         ogs_free(gy_message);
@@ -1338,8 +1336,6 @@ static int smf_gy_rar_cb( struct msg **msg, struct avp *avp,
         ogs_error("ogs_queue_push() failed:%d", (int)rv);
         ogs_free(gy_message);
         ogs_event_free(e);
-    } else {
-        ogs_pollset_notify(ogs_app()->pollset);
     }
 
     /* Set the Auth-Application-Id AVP */
@@ -29,9 +29,24 @@ static void smf_main(void *data);
 
 static int initialized = 0;
 
+static int reload_session(const char *local)
+{
+    int rv;
+    ogs_pfcp_subnet_t *subnet = NULL;
+
+    rv = ogs_pfcp_context_reload_subnet(local, NULL);
+    if (rv != OGS_OK) return rv;
+
+    ogs_list_for_each(&ogs_pfcp_self()->subnet_list, subnet)
+        smf_ue_ip_pool_update_metrics(subnet);
+
+    return OGS_OK;
+}
+
 int smf_initialize(void)
 {
     int rv;
+    ogs_pfcp_subnet_t *subnet = NULL;
 
 #define APP_NAME "smf"
     rv = ogs_app_parse_local_conf(APP_NAME);
@@ -67,12 +82,21 @@ int smf_initialize(void)
     rv = ogs_metrics_context_parse_config(APP_NAME);
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_app_reload_add("metrics", ogs_metrics_context_reload_config);
+    if (rv != OGS_OK) return rv;
+
     rv = smf_context_parse_config();
     if (rv != OGS_OK) return rv;
 
     rv = ogs_pfcp_ue_pool_generate();
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_app_reload_add("session", reload_session);
+    if (rv != OGS_OK) return rv;
+
+    ogs_list_for_each(&ogs_pfcp_self()->subnet_list, subnet)
+        smf_ue_ip_pool_update_metrics(subnet);
+
     ogs_metrics_context_open(ogs_metrics_self());
 
     rv = smf_fd_init();
@@ -84,6 +108,9 @@ int smf_initialize(void)
     rv = smf_pfcp_open();
     if (rv != 0) return OGS_ERROR;
 
+    rv = ogs_sbi_worker_open(smf_self()->num_of_sbi_worker);
+    if (rv != OGS_OK) return OGS_ERROR;
+
     rv = smf_sbi_open();
     if (rv != 0) return OGS_ERROR;
 
@@ -127,6 +154,8 @@ void smf_terminate(void)
 
     smf_gtp_close();
     smf_pfcp_close();
+    /* Answers the requests left in the workers while the server is open */
+    ogs_sbi_worker_close();
     smf_sbi_close();
 
     ogs_metrics_context_close(ogs_metrics_self());
@@ -145,11 +174,18 @@ void smf_terminate(void)
     smf_metrics_final();
 }
 
+static const char *smf_prof_event_name(void *event)
+{
+    return smf_event_get_name(event);
+}
+
 static void smf_main(void *data)
 {
     ogs_fsm_t smf_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            smf_prof_event_name);
     ogs_fsm_init(&smf_sm, smf_state_initial, smf_state_final, 0);
 
     for ( ;; ) {
@@ -169,10 +205,14 @@ static void smf_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            smf_event_t *e = NULL;
+            smf_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -181,9 +221,11 @@ static void smf_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&smf_sm, e);
-            ogs_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&smf_sm, e[i]);
+                ogs_event_free(e[i]);
+            }
         }
     }
 done:
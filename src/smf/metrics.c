@@ -10,6 +10,7 @@ typedef struct smf_metrics_spec_def_s {
     int initial_val;
     unsigned int num_labels;
     const char **labels;
+    ogs_metrics_histogram_params_t histogram_params;
 } smf_metrics_spec_def_t;
 
 /* Helper generic functions: */
@@ -40,7 +41,7 @@ static int smf_metrics_init_spec(ogs_metrics_context_t *ctx,
         dst[i] = ogs_metrics_spec_new(ctx, src[i].type,
                 src[i].name, src[i].description,
                 src[i].initial_val, src[i].num_labels, src[i].labels,
-                NULL);
+                &src[i].histogram_params);
     }
     return OGS_OK;
 }
@@ -126,6 +127,18 @@ smf_metrics_spec_def_t smf_metrics_spec_def_global[_SMF_METR_GLOB_MAX] = {
     .name = "gtp_peers_active",
     .description = "Active GTP peers",
 },
+/* Global Histograms: */
+[SMF_METR_GLOB_HIST_SM_PDU_SESSION_CREATION_TIME] = {
+    .type = OGS_METRICS_METRIC_TYPE_HISTOGRAM,
+    .name = "fivegs_smffunction_sm_pdusessioncreationtime",
+    .description = "Time of PDU session establishment procedure",
+    .histogram_params = {
+        .type = OGS_METRICS_HISTOGRAM_BUCKET_TYPE_EXPONENTIAL,
+        .count = 8,
+        .exp.start = 10,
+        .exp.factor = 2,
+    },
+},
 };
 int smf_metrics_init_inst_global(void)
 {
@@ -483,6 +496,335 @@ int smf_metrics_free_inst_by_cause(ogs_metrics_inst_t **inst)
     return smf_metrics_free_inst(inst, _SMF_METR_BY_CAUSE_MAX);
 }
 
+/* BY SUBNET */
+const char *labels_subnet[] = {
+    "dnn",
+    "subnet"
+};
+
+#define SMF_METR_BY_SUBNET_GAUGE_ENTRY(_id, _name, _desc) \
+    [_id] = { \
+        .type = OGS_METRICS_METRIC_TYPE_GAUGE, \
+        .name = _name, \
+        .description = _desc, \
+        .num_labels = OGS_ARRAY_SIZE(labels_subnet), \
+        .labels = labels_subnet, \
+    },
+ogs_metrics_spec_t *smf_metrics_spec_by_subnet[_SMF_METR_BY_SUBNET_MAX];
+ogs_hash_t *metrics_hash_by_subnet = NULL;  /* hash table for SUBNET labels */
+smf_metrics_spec_def_t smf_metrics_spec_def_by_subnet
+            [_SMF_METR_BY_SUBNET_MAX] = {
+/* Gauges: */
+SMF_METR_BY_SUBNET_GAUGE_ENTRY(
+    SMF_METR_GAUGE_UE_IP_POOL_CAPACITY,
+    "ue_ip_pool_capacity",
+    "Number of UE IP addresses in the pool of the subnet")
+SMF_METR_BY_SUBNET_GAUGE_ENTRY(
+    SMF_METR_GAUGE_UE_IP_POOL_INUSE,
+    "ue_ip_pool_inuse",
+    "Number of UE IP addresses allocated from the subnet")
+};
+void smf_metrics_init_by_subnet(void);
+typedef struct smf_metric_key_by_subnet_s {
+    char                        dnn[OGS_MAX_DNN_LEN+1];
+    char                        subnet[OGS_ADDRSTRLEN+4];
+    smf_metric_type_by_subnet_t t;
+} smf_metric_key_by_subnet_t;
+
+void smf_metrics_init_by_subnet(void)
+{
+    metrics_hash_by_subnet = ogs_hash_make();
+    ogs_assert(metrics_hash_by_subnet);
+}
+
+void smf_metrics_inst_by_subnet_set(
+        const char *dnn, const char *subnet,
+        smf_metric_type_by_subnet_t t, int val)
+{
+    ogs_metrics_inst_t *metrics = NULL;
+    smf_metric_key_by_subnet_t *subnet_key;
+
+    ogs_assert(dnn);
+    ogs_assert(subnet);
+
+    subnet_key = ogs_calloc(1, sizeof(*subnet_key));
+    ogs_assert(subnet_key);
+
+    ogs_cpystrn(subnet_key->dnn, dnn, sizeof(subnet_key->dnn));
+    ogs_cpystrn(subnet_key->subnet, subnet, sizeof(subnet_key->subnet));
+    subnet_key->t = t;
+
+    metrics = ogs_hash_get(metrics_hash_by_subnet,
+            subnet_key, sizeof(*subnet_key));
+
+    if (!metrics) {
+        metrics = ogs_metrics_inst_new(smf_metrics_spec_by_subnet[t],
+                smf_metrics_spec_def_by_subnet->num_labels,
+                (const char *[]){ subnet_key->dnn, subnet_key->subnet });
+
+        ogs_assert(metrics);
+        ogs_hash_set(metrics_hash_by_subnet,
+                subnet_key, sizeof(*subnet_key), metrics);
+    } else {
+        ogs_free(subnet_key);
+    }
+
+    ogs_metrics_inst_set(metrics, val);
+}
+
+/* BY UPF */
+const char *labels_upf[] = {
+    "upf"
+};
+
+#define SMF_METR_BY_UPF_CTR_ENTRY(_id, _name, _desc) \
+    [_id] = { \
+        .type = OGS_METRICS_METRIC_TYPE_COUNTER, \
+        .name = _name, \
+        .description = _desc, \
+        .num_labels = OGS_ARRAY_SIZE(labels_upf), \
+        .labels = labels_upf, \
+    },
+#define SMF_METR_BY_UPF_GAUGE_ENTRY(_id, _name, _desc) \
+    [_id] = { \
+        .type = OGS_METRICS_METRIC_TYPE_GAUGE, \
+        .name = _name, \
+        .description = _desc, \
+        .num_labels = OGS_ARRAY_SIZE(labels_upf), \
+        .labels = labels_upf, \
+    },
+ogs_metrics_spec_t *smf_metrics_spec_by_upf[_SMF_METR_BY_UPF_MAX];
+smf_metrics_spec_def_t smf_metrics_spec_def_by_upf[_SMF_METR_BY_UPF_MAX] = {
+/* Counters: */
+SMF_METR_BY_UPF_CTR_ENTRY(
+    SMF_METR_CTR_UPF_SELECTED,
+    "upf_selected",
+    "Number of new sessions assigned to the UPF")
+SMF_METR_BY_UPF_CTR_ENTRY(
+    SMF_METR_CTR_UPF_THROTTLED,
+    "upf_throttled",
+    "Number of new sessions turned away by the UPF overload control")
+/* Gauges: */
+SMF_METR_BY_UPF_GAUGE_ENTRY(
+    SMF_METR_GAUGE_UPF_LOAD,
+    "upf_load",
+    "Load Metric last reported by the UPF")
+SMF_METR_BY_UPF_GAUGE_ENTRY(
+    SMF_METR_GAUGE_UPF_OVERLOAD_REDUCTION,
+    "upf_overload_reduction",
+    "Overload Reduction Metric last reported by the UPF")
+};
+static ogs_metrics_inst_t *smf_metrics_inst_by_upf(
+        const char *upf, smf_metric_type_by_upf_t t)
+{
+    ogs_assert(upf);
+
+    return ogs_metrics_inst_find_or_add(smf_metrics_spec_by_upf[t],
+            smf_metrics_spec_def_by_upf[t].num_labels,
+            (const char *[]){ upf });
+}
+
+void smf_metrics_inst_by_upf_add(
+        const char *upf, smf_metric_type_by_upf_t t, int val)
+{
+    ogs_metrics_inst_add(smf_metrics_inst_by_upf(upf, t), val);
+}
+
+void smf_metrics_inst_by_upf_set(
+        const char *upf, smf_metric_type_by_upf_t t, int val)
+{
+    ogs_metrics_inst_set(smf_metrics_inst_by_upf(upf, t), val);
+}
+
+static ogs_metrics_peer_t *smf_metrics_pfcp_peer(ogs_pfcp_node_t *node)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_assert(node);
+
+    if (!node->metrics)
+        node->metrics = ogs_metrics_peer_find_or_add(
+                OGS_ADDR(&node->addr, buf));
+
+    return node->metrics;
+}
+
+static void smf_metrics_pfcp_node_collect(ogs_pfcp_node_t *node)
+{
+    ogs_metrics_peer_xact_stats_t stats;
+
+    ogs_assert(node);
+
+    stats.local = node->xact_stats.local;
+    stats.remote = node->xact_stats.remote;
+    stats.retransmitted = node->xact_stats.retransmitted;
+    stats.duplicated = node->xact_stats.duplicated;
+
+    ogs_metrics_peer_xact_update(smf_metrics_pfcp_peer(node),
+            OGS_METRICS_PEER_XACT_PFCP, &stats);
+}
+
+static ogs_metrics_peer_t *smf_metrics_gtp_peer(ogs_gtp_node_t *gnode)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_assert(gnode);
+
+    if (!gnode->metrics)
+        gnode->metrics = ogs_metrics_peer_find_or_add(
+                OGS_ADDR(&gnode->addr, buf));
+
+    return gnode->metrics;
+}
+
+static void smf_metrics_gtp_node_collect(ogs_gtp_node_t *gnode)
+{
+    ogs_metrics_peer_xact_stats_t stats;
+
+    ogs_assert(gnode);
+
+    stats.local = gnode->xact_stats.local;
+    stats.remote = gnode->xact_stats.remote;
+    stats.retransmitted = gnode->xact_stats.retransmitted;
+    stats.duplicated = gnode->xact_stats.duplicated;
+
+    ogs_metrics_peer_xact_update(smf_metrics_gtp_peer(gnode),
+            OGS_METRICS_PEER_XACT_GTP, &stats);
+}
+
+/*
+ * The transaction counters live in the nodes and are only copied here
+ * when the metrics are scraped.
+ */
+static void smf_metrics_collect(void)
+{
+    ogs_pfcp_node_t *node = NULL;
+    ogs_gtp_node_t *gnode = NULL;
+
+    ogs_list_for_each(&ogs_pfcp_self()->pfcp_peer_list, node)
+        smf_metrics_pfcp_node_collect(node);
+    ogs_list_for_each(&smf_self()->sgw_s5c_list, gnode)
+        smf_metrics_gtp_node_collect(gnode);
+}
+
+static void smf_metrics_pfcp_xact_rtt(ogs_pfcp_xact_t *xact, ogs_time_t rtt)
+{
+    ogs_metrics_peer_t *peer = NULL;
+    ogs_metrics_inst_t *inst = NULL;
+
+    ogs_assert(xact);
+    ogs_assert(xact->node);
+
+    peer = smf_metrics_pfcp_peer(xact->node);
+
+    inst = ogs_metrics_peer_hist_find(peer,
+            OGS_METRICS_PEER_HIST_PFCP_XACT_TIME, xact->seq[0].type, NULL);
+    if (!inst) {
+        char type[4];
+
+        ogs_snprintf(type, sizeof(type), "%d", xact->seq[0].type);
+        inst = ogs_metrics_peer_hist_add(peer,
+                OGS_METRICS_PEER_HIST_PFCP_XACT_TIME,
+                xact->seq[0].type, NULL, type);
+    }
+    if (inst)
+        ogs_metrics_inst_add(inst, ogs_time_to_msec(rtt));
+}
+
+static void smf_metrics_gtp_xact_rtt(ogs_gtp_xact_t *xact, ogs_time_t rtt)
+{
+    ogs_metrics_peer_t *peer = NULL;
+    ogs_metrics_inst_t *inst = NULL;
+    uint32_t id;
+
+    ogs_assert(xact);
+    ogs_assert(xact->gnode);
+
+    peer = smf_metrics_gtp_peer(xact->gnode);
+    id = (xact->gtp_version << 8) | xact->seq[0].type;
+
+    inst = ogs_metrics_peer_hist_find(peer,
+            OGS_METRICS_PEER_HIST_GTP_XACT_TIME, id, NULL);
+    if (!inst) {
+        char type[8];
+
+        ogs_snprintf(type, sizeof(type), "v%d/%d",
+                xact->gtp_version, xact->seq[0].type);
+        inst = ogs_metrics_peer_hist_add(peer,
+                OGS_METRICS_PEER_HIST_GTP_XACT_TIME, id, NULL, type);
+    }
+    if (inst)
+        ogs_metrics_inst_add(inst, ogs_time_to_msec(rtt));
+}
+
+static ogs_metrics_peer_t *smf_metrics_sbi_peer(ogs_sbi_client_t *client)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_assert(client);
+
+    if (!client->metrics) {
+        if (client->fqdn)
+            client->metrics = ogs_metrics_peer_find_or_add(client->fqdn);
+        else if (client->addr)
+            client->metrics = ogs_metrics_peer_find_or_add(
+                    OGS_ADDR(client->addr, buf));
+        else if (client->addr6)
+            client->metrics = ogs_metrics_peer_find_or_add(
+                    OGS_ADDR(client->addr6, buf));
+    }
+
+    return client->metrics;
+}
+
+static uint32_t smf_metrics_sbi_method_id(const char *method)
+{
+    static const char *methods[] = {
+        OGS_SBI_HTTP_METHOD_DELETE,
+        OGS_SBI_HTTP_METHOD_GET,
+        OGS_SBI_HTTP_METHOD_PATCH,
+        OGS_SBI_HTTP_METHOD_POST,
+        OGS_SBI_HTTP_METHOD_PUT,
+        OGS_SBI_HTTP_METHOD_OPTIONS,
+    };
+    uint32_t i;
+
+    for (i = 0; i < OGS_ARRAY_SIZE(methods); i++)
+        if (strcmp(method, methods[i]) == 0)
+            return i + 1;
+
+    return 0;
+}
+
+static void smf_metrics_sbi_client_rtt(ogs_sbi_client_t *client,
+        const char *service, const char *method, ogs_time_t rtt)
+{
+    ogs_metrics_peer_t *peer = NULL;
+    ogs_metrics_inst_t *inst = NULL;
+    uint32_t id;
+
+    ogs_assert(client);
+    ogs_assert(method);
+
+    peer = smf_metrics_sbi_peer(client);
+    if (!peer)
+        return;
+
+    id = smf_metrics_sbi_method_id(method);
+    inst = ogs_metrics_peer_hist_find(peer,
+            OGS_METRICS_PEER_HIST_SBI_CLIENT_TIME, id, service);
+    if (!inst) {
+        char procedure[64];
+
+        ogs_snprintf(procedure, sizeof(procedure), "%s %s",
+                method, service ? service : "unknown");
+        inst = ogs_metrics_peer_hist_add(peer,
+                OGS_METRICS_PEER_HIST_SBI_CLIENT_TIME, id, service, procedure);
+    }
+    if (inst)
+        ogs_metrics_inst_add(inst, ogs_time_to_msec(rtt));
+}
+
 void smf_metrics_init(void)
 {
     ogs_metrics_context_t *ctx = ogs_metrics_self();
@@ -500,17 +842,37 @@ void smf_metrics_init(void)
             smf_metrics_spec_def_by_5qi, _SMF_METR_BY_5QI_MAX);
     smf_metrics_init_spec(ctx, smf_metrics_spec_by_cause,
             smf_metrics_spec_def_by_cause, _SMF_METR_BY_CAUSE_MAX);
+    smf_metrics_init_spec(ctx, smf_metrics_spec_by_subnet,
+            smf_metrics_spec_def_by_subnet, _SMF_METR_BY_SUBNET_MAX);
+    smf_metrics_init_spec(ctx, smf_metrics_spec_by_upf,
+            smf_metrics_spec_def_by_upf, _SMF_METR_BY_UPF_MAX);
 
     smf_metrics_init_inst_global();
     smf_metrics_init_by_slice();
     smf_metrics_init_by_5qi();
     smf_metrics_init_by_cause();
+    smf_metrics_init_by_subnet();
+
+    ogs_metrics_peer_hist_init(OGS_METRICS_PEER_HIST_PFCP_XACT_TIME);
+    ogs_metrics_peer_hist_init(OGS_METRICS_PEER_HIST_GTP_XACT_TIME);
+    ogs_metrics_peer_hist_init(OGS_METRICS_PEER_HIST_SBI_CLIENT_TIME);
+    ogs_pfcp_xact_set_rtt_cb(smf_metrics_pfcp_xact_rtt);
+    ogs_gtp_xact_set_rtt_cb(smf_metrics_gtp_xact_rtt);
+    ogs_sbi_client_set_rtt_cb(smf_metrics_sbi_client_rtt);
+
+    ogs_metrics_peer_xact_init(OGS_METRICS_PEER_XACT_PFCP);
+    ogs_metrics_peer_xact_init(OGS_METRICS_PEER_XACT_GTP);
+    ctx->collect = smf_metrics_collect;
 }
 
 void smf_metrics_final(void)
 {
     ogs_hash_index_t *hi;
 
+    ogs_pfcp_xact_set_rtt_cb(NULL);
+    ogs_gtp_xact_set_rtt_cb(NULL);
+    ogs_sbi_client_set_rtt_cb(NULL);
+
     if (metrics_hash_by_slice) {
         for (hi = ogs_hash_first(metrics_hash_by_slice); hi; hi = ogs_hash_next(hi)) {
             smf_metric_key_by_slice_t *key =
@@ -556,6 +918,20 @@ void smf_metrics_final(void)
         }
         ogs_hash_destroy(metrics_hash_by_cause);
     }
+    if (metrics_hash_by_subnet) {
+        for (hi = ogs_hash_first(metrics_hash_by_subnet);
+                hi; hi = ogs_hash_next(hi)) {
+            smf_metric_key_by_subnet_t *key =
+                (smf_metric_key_by_subnet_t *)ogs_hash_this_key(hi);
+
+            ogs_hash_set(metrics_hash_by_subnet, key, sizeof(*key), NULL);
+
+            ogs_free(key);
+            /* don't free val (metric itself) -
+             * it will be free'd by ogs_metrics_context_final() */
+        }
+        ogs_hash_destroy(metrics_hash_by_subnet);
+    }
 
     ogs_metrics_context_final();
 }
@@ -24,6 +24,7 @@ typedef enum smf_metric_type_global_s {
     SMF_METR_GLOB_GAUGE_GTP1_PDPCTXS_ACTIVE,
     SMF_METR_GLOB_GAUGE_GTP2_SESSIONS_ACTIVE,
     SMF_METR_GLOB_GAUGE_GTP_PEERS_ACTIVE,
+    SMF_METR_GLOB_HIST_SM_PDU_SESSION_CREATION_TIME,
     _SMF_METR_GLOB_MAX,
 } smf_metric_type_global_t;
 extern ogs_metrics_inst_t *smf_metrics_inst_global[_SMF_METR_GLOB_MAX];
@@ -96,6 +97,31 @@ typedef enum smf_metric_type_by_cause_s {
 
 void smf_metrics_inst_by_cause_add(
     int cause, smf_metric_type_by_cause_t t, int val);
+
+/* BY SUBNET */
+typedef enum smf_metric_type_by_subnet_s {
+    SMF_METR_GAUGE_UE_IP_POOL_CAPACITY = 0,
+    SMF_METR_GAUGE_UE_IP_POOL_INUSE,
+    _SMF_METR_BY_SUBNET_MAX,
+} smf_metric_type_by_subnet_t;
+
+void smf_metrics_inst_by_subnet_set(
+    const char *dnn, const char *subnet,
+    smf_metric_type_by_subnet_t t, int val);
+
+/* BY UPF */
+typedef enum smf_metric_type_by_upf_s {
+    SMF_METR_CTR_UPF_SELECTED = 0,
+    SMF_METR_CTR_UPF_THROTTLED,
+    SMF_METR_GAUGE_UPF_LOAD,
+    SMF_METR_GAUGE_UPF_OVERLOAD_REDUCTION,
+    _SMF_METR_BY_UPF_MAX,
+} smf_metric_type_by_upf_t;
+
+void smf_metrics_inst_by_upf_add(
+    const char *upf, smf_metric_type_by_upf_t t, int val);
+void smf_metrics_inst_by_upf_set(
+    const char *upf, smf_metric_type_by_upf_t t, int val);
 void smf_metrics_init(void);
 void smf_metrics_final(void);
 
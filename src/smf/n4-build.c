@@ -42,6 +42,9 @@ ogs_pkbuf_t *smf_n4_build_session_establishment_request(
     ogs_pfcp_user_id_t user_id;
     char user_id_buf[sizeof(ogs_pfcp_user_id_t)];
 
+    ogs_pfcp_fq_csid_t fq_csid;
+    char fq_csid_buf[OGS_PFCP_MAX_FQ_CSID_LEN];
+
     ogs_debug("Session Establishment Request");
     ogs_assert(sess);
     smf_ue = smf_ue_find_by_id(sess->smf_ue_id);
@@ -79,6 +82,19 @@ ogs_pkbuf_t *smf_n4_build_session_establishment_request(
     req->cp_f_seid.data = &f_seid;
     req->cp_f_seid.len = len;
 
+    /* PGW-C/SMF FQ-CSID */
+    ogs_assert(sess->pfcp_node);
+    sess->pfcp.csid.local = sess->pfcp_node->csid;
+    rv = ogs_pfcp_sockaddr_to_fq_csid(&fq_csid, sess->pfcp.csid.local);
+    if (rv != OGS_OK) {
+        ogs_error("ogs_pfcp_sockaddr_to_fq_csid() failed");
+        ogs_free(pfcp_message);
+        return NULL;
+    }
+    req->pgw_c_smf_fq_csid.presence = 1;
+    ogs_pfcp_build_fq_csid(&req->pgw_c_smf_fq_csid,
+            &fq_csid, fq_csid_buf, sizeof(fq_csid_buf));
+
     ogs_pfcp_pdrbuf_init();
 
     /* Create PDR */
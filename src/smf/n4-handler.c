@@ -142,6 +142,28 @@ static int sbi_status_from_pfcp(uint8_t pfcp_cause)
 
 /* Returns OGS_PFCP_CAUSE_REQUEST_ACCEPTED on success,
  * other cause value on failure */
+/* Keeps the UPF's CSID to match a later PFCP Session Set Deletion */
+static void handle_upf_fq_csid(smf_sess_t *sess, ogs_pfcp_tlv_fq_csid_t *tlv)
+{
+    ogs_pfcp_fq_csid_t fq_csid;
+
+    ogs_assert(sess);
+    ogs_assert(tlv);
+
+    sess->pfcp.csid.remote = 0;
+
+    if (tlv->presence == 0)
+        return;
+
+    if (ogs_pfcp_parse_fq_csid(&fq_csid, tlv) == 0 ||
+        fq_csid.num_of_csid == 0) {
+        ogs_error("Invalid UPF FQ-CSID");
+        return;
+    }
+
+    sess->pfcp.csid.remote = fq_csid.csid[0];
+}
+
 uint8_t smf_5gc_n4_handle_session_establishment_response(
         smf_sess_t *sess, ogs_pfcp_xact_t *xact,
         ogs_pfcp_session_establishment_response_t *rsp)
@@ -235,6 +257,8 @@ uint8_t smf_5gc_n4_handle_session_establishment_response(
     ogs_assert(up_f_seid);
     sess->upf_n4_seid = be64toh(up_f_seid->seid);
 
+    handle_upf_fq_csid(sess, &rsp->pgw_u_sgw_u__upf_fq_csid);
+
     return OGS_PFCP_CAUSE_REQUEST_ACCEPTED;
 }
 
@@ -827,6 +851,9 @@ uint8_t smf_epc_n4_handle_session_establishment_response(
     up_f_seid = rsp->up_f_seid.data;
     ogs_assert(up_f_seid);
     sess->upf_n4_seid = be64toh(up_f_seid->seid);
+
+    handle_upf_fq_csid(sess, &rsp->pgw_u_sgw_u__upf_fq_csid);
+
     return OGS_PFCP_CAUSE_REQUEST_ACCEPTED;
 }
 
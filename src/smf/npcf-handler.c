@@ -285,6 +285,7 @@ bool smf_npcf_smpolicycontrol_handle_create(
     ogs_pfcp_pdr_t *cp2up_pdr = NULL;
     ogs_pfcp_pdr_t *up2cp_pdr = NULL;
     ogs_pfcp_far_t *up2cp_far = NULL;
+    ogs_pfcp_pdr_flow_t *flow = NULL;
     ogs_pfcp_qer_t *qer = NULL;
 
     OpenAPI_sm_policy_decision_t *SmPolicyDecision = NULL;
@@ -473,7 +474,10 @@ bool smf_npcf_smpolicycontrol_handle_create(
      *********************************************************************/
 
     /* Select UPF based on UE Location Information */
-    smf_sess_select_upf(sess);
+    if (smf_sess_select_upf(sess) == false) {
+        ogs_error("[%s:%d] UPF overloaded", smf_ue->supi, sess->psi);
+        return false;
+    }
 
     /* Check if selected UPF is associated with SMF */
     ogs_assert(sess->pfcp_node);
@@ -588,10 +592,9 @@ bool smf_npcf_smpolicycontrol_handle_create(
         sess->ipv6 ? OGS_INET6_NTOP(&sess->ipv6->addr, buf2) : "");
 
     /* Set UE-to-CP Flow-Description and Outer-Header-Creation */
-    up2cp_pdr->flow[up2cp_pdr->num_of_flow].fd = 1;
-    up2cp_pdr->flow[up2cp_pdr->num_of_flow].description =
-        (char *)"permit out 58 from ff02::2/128 to assigned";
-    up2cp_pdr->num_of_flow++;
+    flow = ogs_pfcp_pdr_flow_add(up2cp_pdr);
+    flow->fd = 1;
+    flow->description = (char *)"permit out 58 from ff02::2/128 to assigned";
 
     ogs_assert(OGS_OK ==
         ogs_pfcp_ip_to_outer_header_creation(
@@ -208,6 +208,32 @@ void smf_pfcp_close(void)
     ogs_socknode_remove_all(&ogs_pfcp_self()->pfcp_list6);
 }
 
+/*
+ * Accounts for one re-established session of the PFCP restoration
+ * started by pfcp_restoration(), and reports how long the UPF took
+ * to recover once all of them have been answered.
+ */
+void smf_pfcp_restoration_progress(ogs_pfcp_node_t *node, bool accepted)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_assert(node);
+
+    if (node->restoration.pending == 0)
+        return;
+
+    if (accepted == false)
+        node->restoration.failed++;
+
+    if (--node->restoration.pending == 0)
+        ogs_info("[%s] PFCP restoration of %d sessions took %lld ms "
+                "(%d failed)",
+                OGS_ADDR(&node->addr, buf), node->restoration.total,
+                (long long)ogs_time_to_msec(
+                    ogs_get_monotonic_time() - node->restoration.started),
+                node->restoration.failed);
+}
+
 static void sess_5gc_timeout(ogs_pfcp_xact_t *xact, void *data)
 {
     ogs_pool_id_t sess_id = OGS_INVALID_POOL_ID;
@@ -244,6 +270,9 @@ static void sess_5gc_timeout(ogs_pfcp_xact_t *xact, void *data)
     case OGS_PFCP_SESSION_ESTABLISHMENT_REQUEST_TYPE:
         ogs_warn("No PFCP session establishment response");
 
+        if (xact->create_flags & OGS_PFCP_CREATE_RESTORATION_INDICATION)
+            smf_pfcp_restoration_progress(xact->node, false);
+
         e = smf_event_new(SMF_EVT_N4_TIMER);
         ogs_assert(e);
         e->sess_id = sess->id;
@@ -343,6 +372,8 @@ static void sess_epc_timeout(ogs_pfcp_xact_t *xact, void *data)
     switch (type) {
     case OGS_PFCP_SESSION_ESTABLISHMENT_REQUEST_TYPE:
         ogs_warn("No PFCP session establishment response");
+        if (xact->create_flags & OGS_PFCP_CREATE_RESTORATION_INDICATION)
+            smf_pfcp_restoration_progress(xact->node, false);
         break;
     case OGS_PFCP_SESSION_MODIFICATION_REQUEST_TYPE:
         ogs_error("No PFCP session modification response");
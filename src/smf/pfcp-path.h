@@ -59,6 +59,8 @@ int smf_epc_pfcp_send_session_deletion_request(
 
 int smf_epc_pfcp_send_deactivation(smf_sess_t *sess, uint8_t gtp_cause);
 
+void smf_pfcp_restoration_progress(ogs_pfcp_node_t *node, bool accepted);
+
 int smf_pfcp_send_session_report_response(
         ogs_pfcp_xact_t *xact, smf_sess_t *sess, uint8_t cause);
 
@@ -24,6 +24,11 @@
 
 static void pfcp_restoration(ogs_pfcp_node_t *node);
 static void reselect_upf(ogs_pfcp_node_t *node);
+static bool release_session(smf_sess_t *sess);
+static void handle_session_set_deletion_request(ogs_pfcp_node_t *node,
+        ogs_pfcp_xact_t *xact, ogs_pfcp_session_set_deletion_request_t *req);
+static void handle_session_set_deletion_response(ogs_pfcp_node_t *node,
+        ogs_pfcp_xact_t *xact, ogs_pfcp_session_set_deletion_response_t *rsp);
 static void node_timeout(ogs_pfcp_xact_t *xact, void *data);
 
 void smf_pfcp_state_initial(ogs_fsm_t *s, smf_event_t *e)
@@ -177,6 +182,29 @@ void smf_pfcp_state_will_associate(ogs_fsm_t *s, smf_event_t *e)
     }
 }
 
+static void handle_load_control(ogs_pfcp_node_t *node,
+        ogs_pfcp_tlv_load_control_information_t *load,
+        ogs_pfcp_tlv_overload_control_information_t *overload)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_assert(node);
+    ogs_assert(load);
+    ogs_assert(overload);
+
+    if (load->presence) {
+        ogs_pfcp_cp_handle_load_control_information(node, load);
+        smf_metrics_inst_by_upf_set(OGS_ADDR(&node->addr, buf),
+                SMF_METR_GAUGE_UPF_LOAD, node->load.metric);
+    }
+    if (overload->presence) {
+        ogs_pfcp_cp_handle_overload_control_information(node, overload);
+        smf_metrics_inst_by_upf_set(OGS_ADDR(&node->addr, buf),
+                SMF_METR_GAUGE_UPF_OVERLOAD_REDUCTION,
+                node->overload.expires ? node->overload.reduction : 0);
+    }
+}
+
 void smf_pfcp_state_associated(ogs_fsm_t *s, smf_event_t *e)
 {
     char buf[OGS_ADDRSTRLEN];
@@ -209,9 +237,16 @@ void smf_pfcp_state_associated(ogs_fsm_t *s, smf_event_t *e)
             ogs_pfcp_send_heartbeat_request(node, node_timeout));
 
         if (node->restoration_required == true) {
+            /* The UPF has restarted and lost the stale sessions as well */
+            node->num_of_stale_csid = 0;
+
             pfcp_restoration(node);
             node->restoration_required = false;
             ogs_error("PFCP restoration");
+        } else if (node->num_of_stale_csid) {
+            ogs_assert(OGS_OK ==
+                ogs_pfcp_cp_send_session_set_deletion_request(
+                    node, node_timeout));
         }
         break;
     case OGS_FSM_EXIT_SIG:
@@ -312,6 +347,17 @@ void smf_pfcp_state_associated(ogs_fsm_t *s, smf_event_t *e)
         case OGS_PFCP_SESSION_ESTABLISHMENT_RESPONSE_TYPE:
             if (!message->h.seid_presence) ogs_error("No SEID");
 
+            handle_load_control(node,
+                    &message->pfcp_session_establishment_response.load_control_information,
+                    &message->pfcp_session_establishment_response.overload_control_information);
+
+            if (xact->create_flags & OGS_PFCP_CREATE_RESTORATION_INDICATION)
+                smf_pfcp_restoration_progress(node,
+                    message->pfcp_session_establishment_response.
+                        cause.presence &&
+                    message->pfcp_session_establishment_response.cause.u8 ==
+                        OGS_PFCP_CAUSE_REQUEST_ACCEPTED);
+
             if (!sess) {
                 ogs_gtp_xact_t *gtp_xact =
                     ogs_gtp_xact_find_by_id(xact->assoc_xact_id);
@@ -336,6 +382,10 @@ void smf_pfcp_state_associated(ogs_fsm_t *s, smf_event_t *e)
         case OGS_PFCP_SESSION_MODIFICATION_RESPONSE_TYPE:
             if (!message->h.seid_presence) ogs_error("No SEID");
 
+            handle_load_control(node,
+                    &message->pfcp_session_modification_response.load_control_information,
+                    &message->pfcp_session_modification_response.overload_control_information);
+
             if (xact->epc)
                 smf_epc_n4_handle_session_modification_response(
                     sess, xact, e->gtp2_message,
@@ -348,6 +398,10 @@ void smf_pfcp_state_associated(ogs_fsm_t *s, smf_event_t *e)
         case OGS_PFCP_SESSION_DELETION_RESPONSE_TYPE:
             if (!message->h.seid_presence) ogs_error("No SEID");
 
+            handle_load_control(node,
+                    &message->pfcp_session_deletion_response.load_control_information,
+                    &message->pfcp_session_deletion_response.overload_control_information);
+
             if (!sess) {
                 ogs_gtp_xact_t *gtp_xact =
                     ogs_gtp_xact_find_by_id(xact->assoc_xact_id);
@@ -372,6 +426,10 @@ void smf_pfcp_state_associated(ogs_fsm_t *s, smf_event_t *e)
         case OGS_PFCP_SESSION_REPORT_REQUEST_TYPE:
             if (!message->h.seid_presence) ogs_error("No SEID");
 
+            handle_load_control(node,
+                    &message->pfcp_session_report_request.load_control_information,
+                    &message->pfcp_session_report_request.overload_control_information);
+
             if (!sess) {
                     ogs_error("No Session");
                     ogs_pfcp_send_error_message(xact, 0,
@@ -382,6 +440,16 @@ void smf_pfcp_state_associated(ogs_fsm_t *s, smf_event_t *e)
             ogs_fsm_dispatch(&sess->sm, e);
             break;
 
+        case OGS_PFCP_SESSION_SET_DELETION_REQUEST_TYPE:
+            handle_session_set_deletion_request(node, xact,
+                    &message->pfcp_session_set_deletion_request);
+            break;
+
+        case OGS_PFCP_SESSION_SET_DELETION_RESPONSE_TYPE:
+            handle_session_set_deletion_response(node, xact,
+                    &message->pfcp_session_set_deletion_response);
+            break;
+
         default:
             ogs_error("Not implemented PFCP message type[%d]",
                     message->h.type);
@@ -467,6 +535,19 @@ static void pfcp_restoration(ogs_pfcp_node_t *node)
     char buf1[OGS_ADDRSTRLEN];
     char buf2[OGS_ADDRSTRLEN];
 
+    node->restoration.started = ogs_get_monotonic_time();
+    node->restoration.total = 0;
+    node->restoration.failed = 0;
+
+    ogs_list_for_each(&smf_self()->smf_ue_list, smf_ue) {
+        smf_sess_t *sess = NULL;
+
+        ogs_list_for_each(&smf_ue->sess_list, sess)
+            if (node == sess->pfcp_node)
+                node->restoration.total++;
+    }
+    node->restoration.pending = node->restoration.total;
+
     ogs_list_for_each(&smf_self()->smf_ue_list, smf_ue) {
         smf_sess_t *sess = NULL;
         ogs_assert(smf_ue);
@@ -504,7 +585,6 @@ static void pfcp_restoration(ogs_pfcp_node_t *node)
 
 static void reselect_upf(ogs_pfcp_node_t *node)
 {
-    int r;
     smf_ue_t *smf_ue = NULL;
     ogs_pfcp_node_t *iter = NULL;
 
@@ -527,41 +607,151 @@ static void reselect_upf(ogs_pfcp_node_t *node)
         return;
     }
 
+    /*
+     * The sessions are released without telling the UPF. Retire the CSID
+     * they were given so that the UPF can remove them all at once with
+     * a PFCP Session Set Deletion when it comes back.
+     */
+    if (node->num_of_stale_csid < OGS_PFCP_MAX_NUM_OF_CSID)
+        node->stale_csid[node->num_of_stale_csid++] = node->csid;
+    else
+        ogs_warn("Too many stale CSIDs [%d]", node->num_of_stale_csid);
+    node->csid = ogs_pfcp_csid_next();
+
     ogs_list_for_each(&smf_self()->smf_ue_list, smf_ue) {
         smf_sess_t *sess = NULL, *next_sess = NULL;
 
         ogs_list_for_each_safe(&smf_ue->sess_list, next_sess, sess) {
+            if (node == sess->pfcp_node)
+                release_session(sess);
+        }
+    }
+}
 
-            if (node == sess->pfcp_node) {
-                if (sess->epc) {
-                    ogs_error("[%s:%s] EPC restoration is not implemented",
-                            smf_ue->imsi_bcd, sess->session.name);
-                } else {
-                    if (PCF_SM_POLICY_ASSOCIATED(sess)) {
-                        smf_npcf_smpolicycontrol_param_t param;
-
-                        ogs_info("[%s:%d] SMF-initiated Deletion",
-                                smf_ue->supi, sess->psi);
-                        ogs_assert(sess->sm_context_ref);
-                        memset(&param, 0, sizeof(param));
-                        r = smf_sbi_discover_and_send(
-                                OGS_SBI_SERVICE_TYPE_NPCF_SMPOLICYCONTROL, NULL,
-                                smf_npcf_smpolicycontrol_build_delete,
-                                sess, NULL,
-                                OGS_PFCP_DELETE_TRIGGER_SMF_INITIATED,
-                                &param);
-                        ogs_expect(r == OGS_OK);
-                        ogs_assert(r != OGS_ERROR);
-                    } else {
-                        ogs_error("[%s:%d] No PolicyAssociationId. "
-                                "Forcibly remove SESSION",
-                                smf_ue->supi, sess->psi);
-                        SMF_SESS_CLEAR(sess);
-                    }
-                }
-            }
+/* Returns false if the session is kept, as EPC sessions are */
+static bool release_session(smf_sess_t *sess)
+{
+    int r;
+    smf_ue_t *smf_ue = NULL;
+
+    ogs_assert(sess);
+    smf_ue = smf_ue_find_by_id(sess->smf_ue_id);
+    ogs_assert(smf_ue);
+
+    if (sess->epc) {
+        ogs_error("[%s:%s] EPC restoration is not implemented",
+                smf_ue->imsi_bcd, sess->session.name);
+        return false;
+    } else {
+        if (PCF_SM_POLICY_ASSOCIATED(sess)) {
+            smf_npcf_smpolicycontrol_param_t param;
+
+            ogs_info("[%s:%d] SMF-initiated Deletion",
+                    smf_ue->supi, sess->psi);
+            ogs_assert(sess->sm_context_ref);
+            memset(&param, 0, sizeof(param));
+            r = smf_sbi_discover_and_send(
+                    OGS_SBI_SERVICE_TYPE_NPCF_SMPOLICYCONTROL, NULL,
+                    smf_npcf_smpolicycontrol_build_delete,
+                    sess, NULL,
+                    OGS_PFCP_DELETE_TRIGGER_SMF_INITIATED,
+                    &param);
+            ogs_expect(r == OGS_OK);
+            ogs_assert(r != OGS_ERROR);
+        } else {
+            ogs_error("[%s:%d] No PolicyAssociationId. "
+                    "Forcibly remove SESSION",
+                    smf_ue->supi, sess->psi);
+            SMF_SESS_CLEAR(sess);
         }
     }
+
+    return true;
+}
+
+/*
+ * TS 29.244 7.4.6: the UPF has lost the sessions of a PDN Connection Set,
+ * so release every session with the UPF that was given one of its CSIDs.
+ */
+static void handle_session_set_deletion_request(ogs_pfcp_node_t *node,
+        ogs_pfcp_xact_t *xact, ogs_pfcp_session_set_deletion_request_t *req)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_pfcp_fq_csid_t fq_csid[OGS_PFCP_MAX_NUM_OF_FQ_CSID];
+    int num_of_fq_csid = 0, num_of_sess = 0, i;
+    ogs_time_t started;
+    uint8_t cause;
+
+    smf_ue_t *smf_ue = NULL;
+
+    ogs_assert(node);
+    ogs_assert(xact);
+    ogs_assert(req);
+
+    started = ogs_get_monotonic_time();
+
+    cause = ogs_pfcp_handle_session_set_deletion_request(
+            req, fq_csid, &num_of_fq_csid);
+    if (cause != OGS_PFCP_CAUSE_REQUEST_ACCEPTED) {
+        ogs_pfcp_send_error_message(xact, 0,
+                OGS_PFCP_SESSION_SET_DELETION_RESPONSE_TYPE, cause, 0);
+        return;
+    }
+
+    ogs_list_for_each(&smf_self()->smf_ue_list, smf_ue) {
+        smf_sess_t *sess = NULL, *next_sess = NULL;
+
+        ogs_list_for_each_safe(&smf_ue->sess_list, next_sess, sess) {
+            if (node != sess->pfcp_node || sess->pfcp.csid.remote == 0)
+                continue;
+
+            for (i = 0; i < num_of_fq_csid; i++)
+                if (ogs_pfcp_fq_csid_match(
+                            &fq_csid[i], sess->pfcp.csid.remote))
+                    break;
+
+            if (i < num_of_fq_csid && release_session(sess) == true)
+                num_of_sess++;
+        }
+    }
+
+    ogs_assert(OGS_OK ==
+        ogs_pfcp_send_session_set_response(xact,
+            OGS_PFCP_SESSION_SET_DELETION_RESPONSE_TYPE,
+            OGS_PFCP_CAUSE_REQUEST_ACCEPTED));
+
+    ogs_info("[%s] PFCP Session Set Deletion released %d sessions in %lld ms",
+            OGS_ADDR(&node->addr, buf), num_of_sess,
+            (long long)ogs_time_to_msec(ogs_get_monotonic_time() - started));
+}
+
+static void handle_session_set_deletion_response(ogs_pfcp_node_t *node,
+        ogs_pfcp_xact_t *xact, ogs_pfcp_session_set_deletion_response_t *rsp)
+{
+    char buf[OGS_ADDRSTRLEN];
+    ogs_time_t tx_time;
+
+    ogs_assert(node);
+    ogs_assert(xact);
+    ogs_assert(rsp);
+
+    tx_time = xact->tx_time;
+    ogs_pfcp_xact_commit(xact);
+
+    if (rsp->cause.presence == 0 ||
+        rsp->cause.u8 != OGS_PFCP_CAUSE_REQUEST_ACCEPTED) {
+        ogs_error("[%s] PFCP Session Set Deletion rejected [%d]",
+                OGS_ADDR(&node->addr, buf),
+                rsp->cause.presence ? rsp->cause.u8 : 0);
+        return;
+    }
+
+    ogs_info("[%s] PFCP Session Set Deletion of %d CSIDs took %lld ms",
+            OGS_ADDR(&node->addr, buf), node->num_of_stale_csid,
+            (long long)ogs_time_to_msec(ogs_time_cached() - tx_time));
+
+    node->num_of_stale_csid = 0;
 }
 
 static void node_timeout(ogs_pfcp_xact_t *xact, void *data)
@@ -589,6 +779,10 @@ static void node_timeout(ogs_pfcp_xact_t *xact, void *data)
         break;
     case OGS_PFCP_ASSOCIATION_SETUP_REQUEST_TYPE:
         break;
+    case OGS_PFCP_SESSION_SET_DELETION_REQUEST_TYPE:
+        /* The stale CSIDs are sent again on the next association */
+        ogs_warn("No PFCP Session Set Deletion Response");
+        break;
     default:
         ogs_error("Not implemented [type:%d]", type);
         break;
@@ -259,7 +259,8 @@ uint8_t smf_s5c_handle_create_session_request(
     ogs_nas_to_plmn_id(&sess->serving_plmn_id, req->serving_network.data);
 
     /* Select PGW based on UE Location Information */
-    smf_sess_select_upf(sess);
+    if (smf_sess_select_upf(sess) == false)
+        return OGS_GTP2_CAUSE_APN_CONGESTION;
 
     /* Check if selected PGW is associated with SMF */
     ogs_assert(sess->pfcp_node);
@@ -472,8 +472,6 @@ static void smf_s6b_aaa_cb(void *data, struct msg **msg)
         ogs_error("ogs_queue_push() failed:%d", (int)ret);
         ogs_free(s6b_message);
         ogs_event_free(e);
-    } else {
-        ogs_pollset_notify(ogs_app()->pollset);
     }
 
     /* Free the message */
@@ -771,8 +769,6 @@ static void smf_s6b_sta_cb(void *data, struct msg **msg)
             ogs_error("ogs_queue_push() failed:%d", (int)rv);
             ogs_free(s6b_message);
             ogs_event_free(e);
-        } else {
-            ogs_pollset_notify(ogs_app()->pollset);
         }
     } else {
         ogs_free(s6b_message);
@@ -467,19 +467,31 @@ void smf_state_operational(ogs_fsm_t *s, smf_event_t *e)
         stream = ogs_sbi_stream_find_by_id(stream_id);
         if (!stream) {
             ogs_error("STREAM has already been removed [%d]", stream_id);
+            if (e->h.sbi.message) {
+                ogs_sbi_message_free(e->h.sbi.message);
+                ogs_free(e->h.sbi.message);
+                e->h.sbi.message = NULL;
+            }
             break;
         }
 
-        rv = ogs_sbi_parse_request(&sbi_message, sbi_request);
-        if (rv != OGS_OK) {
-            /* 'sbi_message' buffer is released in ogs_sbi_parse_request() */
-            ogs_error("cannot parse HTTP sbi_message");
-            ogs_assert(true ==
-                ogs_sbi_server_send_error(
-                    stream, OGS_SBI_HTTP_STATUS_BAD_REQUEST,
-                    NULL, "cannot parse HTTP sbi_message", NULL,
-                    NULL));
-            break;
+        if (e->h.sbi.message) {
+            /* Already parsed by an SBI worker thread */
+            memcpy(&sbi_message, e->h.sbi.message, sizeof(sbi_message));
+            ogs_free(e->h.sbi.message);
+            e->h.sbi.message = NULL;
+        } else {
+            rv = ogs_sbi_parse_request(&sbi_message, sbi_request);
+            if (rv != OGS_OK) {
+                /* 'sbi_message' buffer is released in ogs_sbi_parse_request() */
+                ogs_error("cannot parse HTTP sbi_message");
+                ogs_assert(true ==
+                    ogs_sbi_server_send_error(
+                        stream, OGS_SBI_HTTP_STATUS_BAD_REQUEST,
+                        NULL, "cannot parse HTTP sbi_message", NULL,
+                        NULL));
+                break;
+            }
         }
 
         SWITCH(sbi_message.h.service.name)
@@ -691,12 +703,20 @@ void smf_state_operational(ogs_fsm_t *s, smf_event_t *e)
 
         sbi_response = e->h.sbi.response;
         ogs_assert(sbi_response);
-        rv = ogs_sbi_parse_response(&sbi_message, sbi_response);
-        if (rv != OGS_OK) {
-            ogs_error("cannot parse HTTP response");
-            ogs_sbi_message_free(&sbi_message);
-            ogs_sbi_response_free(sbi_response);
-            break;
+
+        if (e->h.sbi.message) {
+            /* Already parsed by an SBI worker thread */
+            memcpy(&sbi_message, e->h.sbi.message, sizeof(sbi_message));
+            ogs_free(e->h.sbi.message);
+            e->h.sbi.message = NULL;
+        } else {
+            rv = ogs_sbi_parse_response(&sbi_message, sbi_response);
+            if (rv != OGS_OK) {
+                ogs_error("cannot parse HTTP response");
+                ogs_sbi_message_free(&sbi_message);
+                ogs_sbi_response_free(sbi_response);
+                break;
+            }
         }
 
         SWITCH(sbi_message.h.service.name)
@@ -40,8 +40,8 @@ void udm_context_init(void)
 
     ogs_log_install_domain(&__udm_log_domain, "udm", ogs_core()->log.level);
 
-    ogs_pool_init(&udm_ue_pool, ogs_global_conf()->max.ue);
-    ogs_pool_init(&udm_sess_pool, ogs_app()->pool.sess);
+    ogs_pool_init_elastic(&udm_ue_pool, ogs_global_conf()->max.ue);
+    ogs_pool_init_elastic(&udm_sess_pool, ogs_app()->pool.sess);
 #define MAX_NUM_OF_UDM_SDM_SUBSCRIPTIONS_PER_UE 4
     max_num_of_udm_sdm_subscriptions = ogs_global_conf()->max.ue *
             MAX_NUM_OF_UDM_SDM_SUBSCRIPTIONS_PER_UE;
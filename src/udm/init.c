@@ -91,11 +91,18 @@ void udm_terminate(void)
     ogs_sbi_context_final();
 }
 
+static const char *udm_prof_event_name(void *event)
+{
+    return udm_event_get_name(event);
+}
+
 static void udm_main(void *data)
 {
     ogs_fsm_t udm_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            udm_prof_event_name);
     ogs_fsm_init(&udm_sm, udm_state_initial, udm_state_final, 0);
 
     for ( ;; ) {
@@ -115,10 +122,14 @@ static void udm_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            udm_event_t *e = NULL;
+            udm_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -127,9 +138,11 @@ static void udm_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&udm_sm, e);
-            ogs_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&udm_sm, e[i]);
+                ogs_event_free(e[i]);
+            }
         }
     }
 done:
@@ -96,11 +96,18 @@ void udr_terminate(void)
     ogs_sbi_context_final();
 }
 
+static const char *udr_prof_event_name(void *event)
+{
+    return udr_event_get_name(event);
+}
+
 static void udr_main(void *data)
 {
     ogs_fsm_t udr_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            udr_prof_event_name);
     ogs_fsm_init(&udr_sm, udr_state_initial, udr_state_final, 0);
 
     for ( ;; ) {
@@ -120,10 +127,14 @@ static void udr_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            udr_event_t *e = NULL;
+            udr_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -132,9 +143,11 @@ static void udr_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&udr_sm, e);
-            ogs_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&udr_sm, e[i]);
+                ogs_event_free(e[i]);
+            }
         }
     }
 done:
@@ -154,7 +154,7 @@ bool udr_nudr_dr_handle_subscription_authentication(
                     sqn_ms, sizeof(sqn_ms));
             sqn = ogs_buffer_to_uint64(sqn_ms, OGS_SQN_LEN);
 
-            rv = ogs_dbi_update_sqn(supi, sqn);
+            rv = ogs_dbi_update_sqn(supi, (sqn + 32) & OGS_MAX_SQN);
             if (rv != OGS_OK) {
                 ogs_fatal("[%s] Cannot update SQN", supi);
                 ogs_assert(true ==
@@ -164,16 +164,6 @@ bool udr_nudr_dr_handle_subscription_authentication(
                 return false;
             }
 
-            rv = ogs_dbi_increment_sqn(supi);
-            if (rv != OGS_OK) {
-                ogs_fatal("[%s] Cannot increment SQN", supi);
-                ogs_assert(true ==
-                    ogs_sbi_server_send_error(stream,
-                        OGS_SBI_HTTP_STATUS_INTERNAL_SERVER_ERROR,
-                        recvmsg, "Cannot increment SQN", supi, NULL));
-                return false;
-            }
-
             memset(&sendmsg, 0, sizeof(sendmsg));
 
             response = ogs_sbi_build_response(
@@ -211,7 +201,7 @@ bool udr_nudr_dr_handle_subscription_authentication(
             }
 
             memset(&sendmsg, 0, sizeof(sendmsg));
-            rv = ogs_dbi_increment_sqn(supi);
+            rv = ogs_dbi_auth_info_increment_sqn(supi, &auth_info);
             if (rv != OGS_OK) {
                 ogs_fatal("[%s] Cannot increment SQN", supi);
                 ogs_assert(true ==
@@ -0,0 +1,704 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "checkpoint.h"
+#include "n4-handler.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * The checkpoint keeps the sessions in a file mapped into memory,
+ * normally on tmpfs, so that they survive a restart of the UPF:
+ *
+ *   header | area 0 | area 1
+ *
+ * A session is saved as the PFCP Session Establishment Request that
+ * installs its current rules, with the TEIDs, UE addresses and SEIDs
+ * the UPF holds. A record is appended to the active area whenever the
+ * session changes, and a DEL record when it is removed. When the area
+ * is full, the latest record of each session is copied to the other
+ * area, which becomes the active one.
+ *
+ * At startup the sessions are installed again once the GTP-U sockets
+ * are open and before the UPF thread starts polling them, so
+ * forwarding resumes with the first packet. A restored session belongs
+ * to no SMF until its SMF restores it with a Session Establishment
+ * Request or sends a request on it, and only the SMF whose address is
+ * in the F-SEID may claim it. Those still unclaimed when
+ * upf.checkpoint.reconcile expires are removed. Usage reports of an
+ * unclaimed session stay pending until it is claimed.
+ *
+ * Only the rules are saved, not the counters: the volume and duration
+ * measured by the URRs and the quota consumed so far start again from
+ * zero, so the usage of the last period before the restart is not
+ * reported.
+ */
+
+#define CHECKPOINT_MAGIC        "OGSUPFCP"
+#define CHECKPOINT_MAGIC_LEN    8
+#define CHECKPOINT_VERSION      1
+#define CHECKPOINT_HEADER_SIZE  4096
+
+/* Only the host that wrote the file reads it, so it is in host order */
+typedef struct checkpoint_header_s {
+    char        magic[CHECKPOINT_MAGIC_LEN];
+    uint32_t    version;
+    uint32_t    active;         /* Area the records are appended to */
+    uint64_t    size;           /* Bytes of each area */
+    uint64_t    used[2];        /* Bytes of complete records */
+    uint64_t    generation;     /* Number of compactions */
+} checkpoint_header_t;
+
+typedef enum {
+    CHECKPOINT_RECORD_PUT = 1,
+    CHECKPOINT_RECORD_DEL,
+} checkpoint_record_op_e;
+
+typedef struct checkpoint_record_s {
+    uint32_t    len;            /* Without the padding */
+    uint32_t    checksum;       /* Everything after this field */
+    uint64_t    upf_n4_seid;
+    uint8_t     op;
+    uint8_t     spare[7];
+    /* PUT: Session Establishment Request without the PFCP header */
+} checkpoint_record_t;
+
+#define RECORD_SIZE(__len) (((size_t)(__len) + 7) & ~(size_t)7)
+
+static struct {
+    int fd;
+    checkpoint_header_t *header;
+    size_t length;
+    bool disabled;
+
+    ogs_pfcp_message_t *message;
+    ogs_timer_t *t_reconcile;
+} checkpoint = { .fd = -1 };
+
+static uint8_t *area_of(checkpoint_header_t *header, int area)
+{
+    return (uint8_t *)header + CHECKPOINT_HEADER_SIZE + area * header->size;
+}
+
+static uint32_t record_checksum(checkpoint_record_t *record)
+{
+    int klen = record->len - offsetof(checkpoint_record_t, upf_n4_seid);
+    return ogs_hashfunc_default((const char *)&record->upf_n4_seid, &klen);
+}
+
+static bool record_valid(checkpoint_record_t *record, size_t avail)
+{
+    if (avail < sizeof(*record) || record->len < sizeof(*record) ||
+        RECORD_SIZE(record->len) > avail)
+        return false;
+    if (record->op != CHECKPOINT_RECORD_PUT &&
+        record->op != CHECKPOINT_RECORD_DEL)
+        return false;
+
+    return record->checksum == record_checksum(record);
+}
+
+/* Returns the offset of the record, or -1 if the area is full */
+static ssize_t write_record(int area, uint64_t upf_n4_seid,
+        uint8_t op, const void *data, size_t len)
+{
+    checkpoint_header_t *header = checkpoint.header;
+    checkpoint_record_t *record = NULL;
+    size_t offset = header->used[area];
+    size_t size = RECORD_SIZE(sizeof(*record) + len);
+
+    if (size > header->size - offset)
+        return -1;
+
+    record = (checkpoint_record_t *)(area_of(header, area) + offset);
+    record->upf_n4_seid = upf_n4_seid;
+    record->op = op;
+    memset(record->spare, 0, sizeof(record->spare));
+    if (len)
+        memcpy(record + 1, data, len);
+    record->len = sizeof(*record) + len;
+    record->checksum = record_checksum(record);
+
+    /* A record counts only once it is complete */
+    header->used[area] = offset + size;
+
+    return offset;
+}
+
+/* Copies the latest record of each session to the inactive area */
+static bool compact(void)
+{
+    checkpoint_header_t *header = checkpoint.header;
+    int from = header->active, to = !header->active;
+    upf_sess_t *sess = NULL;
+
+    header->used[to] = 0;
+
+    ogs_list_for_each(&upf_self()->sess_list, sess) {
+        checkpoint_record_t *record = NULL;
+        size_t size;
+
+        if (!sess->checkpoint.saved)
+            continue;
+
+        record = (checkpoint_record_t *)
+            (area_of(header, from) + sess->checkpoint.offset);
+        size = RECORD_SIZE(record->len);
+        if (size > header->size - header->used[to])
+            return false;
+
+        memcpy(area_of(header, to) + header->used[to], record, size);
+        sess->checkpoint.offset = header->used[to];
+        header->used[to] += size;
+    }
+
+    header->generation++;
+    header->active = to;
+
+    return true;
+}
+
+static void disable(void)
+{
+    ogs_error("upf.checkpoint.size is too small, checkpoint disabled");
+
+    /* What is left is no longer complete, so it must not be restored */
+    memset(checkpoint.header->magic, 0, CHECKPOINT_MAGIC_LEN);
+    checkpoint.disabled = true;
+}
+
+static void append(upf_sess_t *sess, uint8_t op, ogs_pkbuf_t *pkbuf)
+{
+    checkpoint_header_t *header = checkpoint.header;
+    ssize_t offset;
+
+    offset = write_record(header->active, sess->upf_n4_seid, op,
+            pkbuf ? pkbuf->data : NULL, pkbuf ? pkbuf->len : 0);
+    if (offset < 0) {
+        if (compact() == false) {
+            disable();
+            return;
+        }
+        offset = write_record(header->active, sess->upf_n4_seid, op,
+                pkbuf ? pkbuf->data : NULL, pkbuf ? pkbuf->len : 0);
+        if (offset < 0) {
+            disable();
+            return;
+        }
+    }
+
+    sess->checkpoint.saved = (op == CHECKPOINT_RECORD_PUT);
+    sess->checkpoint.offset = offset;
+}
+
+/*
+ * The UPF does not keep the Flow Descriptions it was given, so they
+ * are encoded again from the compiled rules. An uplink rule had its
+ * source and destination swapped, which is undone first.
+ */
+static void build_sdf_filter(ogs_pfcp_tlv_create_pdr_t *message,
+        ogs_pfcp_pdr_t *pdr, void **buf)
+{
+    ogs_pfcp_rule_t *rule = NULL;
+    int j = 0;
+
+    ogs_list_for_each(&pdr->rule_list, rule) {
+        ogs_pfcp_sdf_filter_t sdf_filter;
+        ogs_ipfw_rule_t ipfw;
+        char *flow_description = NULL;
+        int len;
+
+        if (j == OGS_MAX_NUM_OF_FLOW_IN_PDR)
+            break;
+
+        if (pdr->src_if == OGS_PFCP_INTERFACE_ACCESS)
+            ogs_ipfw_copy_and_swap(&ipfw, &rule->ipfw);
+        else
+            memcpy(&ipfw, &rule->ipfw, sizeof(ipfw));
+
+        flow_description = ogs_ipfw_encode_flow_description(&ipfw);
+        if (!flow_description) {
+            ogs_error("Cannot encode the rule of PDR[%d]", pdr->id);
+            continue;
+        }
+
+        memset(&sdf_filter, 0, sizeof(sdf_filter));
+        sdf_filter.fd = 1;
+        sdf_filter.flow_description = flow_description;
+        sdf_filter.flow_description_len = strlen(flow_description);
+        if (rule->bid) {
+            sdf_filter.bid = 1;
+            sdf_filter.sdf_filter_id = rule->sdf_filter_id;
+        }
+
+        len = sizeof(ogs_pfcp_sdf_filter_t) +
+                sdf_filter.flow_description_len;
+
+        message->pdi.sdf_filter[j].presence = 1;
+        buf[j] = ogs_calloc(1, len);
+        ogs_assert(buf[j]);
+        ogs_pfcp_build_sdf_filter(&message->pdi.sdf_filter[j],
+                &sdf_filter, buf[j], len);
+
+        ogs_free(flow_description);
+        j++;
+    }
+}
+
+static ogs_pkbuf_t *build_session(upf_sess_t *sess)
+{
+    ogs_pfcp_message_t *pfcp_message = checkpoint.message;
+    ogs_pfcp_session_establishment_request_t *req = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    ogs_pfcp_pdr_t *pdr = NULL;
+    ogs_pfcp_far_t *far = NULL;
+    ogs_pfcp_urr_t *urr = NULL;
+    ogs_pfcp_qer_t *qer = NULL;
+    int i, j;
+
+    ogs_ip_t *ip = NULL;
+    ogs_pfcp_f_seid_t f_seid;
+    ogs_pfcp_f_teid_t f_teid[OGS_MAX_NUM_OF_PDR];
+    void *sdf_filter[OGS_MAX_NUM_OF_PDR][OGS_MAX_NUM_OF_FLOW_IN_PDR];
+    ogs_pfcp_sereq_flags_t sereq_flags;
+    char apn_dnn[OGS_MAX_DNN_LEN+1];
+
+    ogs_pfcp_fq_csid_t fq_csid;
+    char fq_csid_buf[OGS_PFCP_MAX_FQ_CSID_LEN];
+
+    ogs_assert(sess);
+    ogs_assert(pfcp_message);
+
+    /* ogs_pfcp_build_create_far() needs the BAR of a buffering FAR */
+    ogs_list_for_each(&sess->pfcp.far_list, far) {
+        if ((far->apply_action & OGS_PFCP_APPLY_ACTION_BUFF) &&
+            !sess->pfcp.bar)
+            return NULL;
+    }
+
+    req = &pfcp_message->pfcp_session_establishment_request;
+    memset(req, 0, sizeof(*req));
+    memset(sdf_filter, 0, sizeof(sdf_filter));
+
+    /* CP F-SEID */
+    ip = &sess->smf_n4_f_seid.ip;
+    memset(&f_seid, 0, sizeof(f_seid));
+    f_seid.ipv4 = ip->ipv4;
+    f_seid.ipv6 = ip->ipv6;
+    f_seid.seid = htobe64(sess->smf_n4_f_seid.seid);
+    if (ip->ipv4 && ip->ipv6) {
+        f_seid.both.addr = ip->addr;
+        memcpy(f_seid.both.addr6, ip->addr6, OGS_IPV6_LEN);
+    } else if (ip->ipv4) {
+        f_seid.addr = ip->addr;
+    } else {
+        memcpy(f_seid.addr6, ip->addr6, OGS_IPV6_LEN);
+    }
+    req->cp_f_seid.presence = 1;
+    req->cp_f_seid.data = &f_seid;
+    req->cp_f_seid.len = 1 + sizeof(f_seid.seid) + ip->len;
+
+    /* PGW-C/SMF FQ-CSID */
+    if (sess->pfcp.csid.remote) {
+        memset(&fq_csid, 0, sizeof(fq_csid));
+        if (ip->ipv4) {
+            fq_csid.node_id_type = OGS_PFCP_FQ_CSID_NODE_ID_IPV4;
+            fq_csid.addr = ip->addr;
+        } else {
+            fq_csid.node_id_type = OGS_PFCP_FQ_CSID_NODE_ID_IPV6;
+            memcpy(fq_csid.addr6, ip->addr6, OGS_IPV6_LEN);
+        }
+        fq_csid.csid[fq_csid.num_of_csid++] = sess->pfcp.csid.remote;
+
+        req->pgw_c_smf_fq_csid.presence = 1;
+        ogs_pfcp_build_fq_csid(&req->pgw_c_smf_fq_csid,
+                &fq_csid, fq_csid_buf, sizeof(fq_csid_buf));
+    }
+
+    ogs_pfcp_pdrbuf_init();
+
+    /* Create PDR */
+    i = 0;
+    ogs_list_for_each(&sess->pfcp.pdr_list, pdr) {
+        if (!pdr->far)
+            continue;
+
+        ogs_pfcp_build_create_pdr(&req->create_pdr[i], i, pdr);
+        build_sdf_filter(&req->create_pdr[i], pdr, sdf_filter[i]);
+
+        /* The UPF chose the TEID, so it is saved as a given one */
+        if (pdr->f_teid_len) {
+            memcpy(&f_teid[i], &pdr->f_teid, pdr->f_teid_len);
+            f_teid[i].ch = 0;
+            f_teid[i].chid = 0;
+            f_teid[i].teid = htobe32(pdr->f_teid.teid);
+            req->create_pdr[i].pdi.local_f_teid.data = &f_teid[i];
+        }
+        i++;
+    }
+
+    /* Create FAR */
+    i = 0;
+    ogs_list_for_each(&sess->pfcp.far_list, far) {
+        ogs_pfcp_build_create_far(&req->create_far[i], i, far);
+        i++;
+    }
+
+    /* Create URR */
+    i = 0;
+    ogs_list_for_each(&sess->pfcp.urr_list, urr) {
+        ogs_pfcp_build_create_urr(&req->create_urr[i], i, urr);
+        i++;
+    }
+
+    /* Create QER */
+    i = 0;
+    ogs_list_for_each(&sess->pfcp.qer_list, qer) {
+        ogs_pfcp_build_create_qer(&req->create_qer[i], i, qer);
+        i++;
+    }
+
+    /* Create BAR */
+    if (sess->pfcp.bar)
+        ogs_pfcp_build_create_bar(&req->create_bar, sess->pfcp.bar);
+
+    /* PDN Type */
+    if (sess->ipv4 || sess->ipv6) {
+        req->pdn_type.presence = 1;
+        if (sess->ipv4 && sess->ipv6)
+            req->pdn_type.u8 = OGS_PDU_SESSION_TYPE_IPV4V6;
+        else if (sess->ipv4)
+            req->pdn_type.u8 = OGS_PDU_SESSION_TYPE_IPV4;
+        else
+            req->pdn_type.u8 = OGS_PDU_SESSION_TYPE_IPV6;
+    }
+
+    /* APN/DNN */
+    if (sess->apn_dnn) {
+        req->apn_dnn.presence = 1;
+        req->apn_dnn.len = ogs_fqdn_build(
+                apn_dnn, sess->apn_dnn, strlen(sess->apn_dnn));
+        req->apn_dnn.data = apn_dnn;
+    }
+
+    /* The TEIDs are taken over as they are */
+    sereq_flags.value = 0;
+    sereq_flags.restoration_indication = 1;
+    req->pfcpsereq_flags.presence = 1;
+    req->pfcpsereq_flags.u8 = sereq_flags.value;
+
+    pfcp_message->h.type = OGS_PFCP_SESSION_ESTABLISHMENT_REQUEST_TYPE;
+    pkbuf = ogs_pfcp_build_msg(pfcp_message);
+    ogs_expect(pkbuf);
+
+    ogs_pfcp_pdrbuf_clear();
+    for (i = 0; i < OGS_MAX_NUM_OF_PDR; i++)
+        for (j = 0; j < OGS_MAX_NUM_OF_FLOW_IN_PDR; j++)
+            if (sdf_filter[i][j])
+                ogs_free(sdf_filter[i][j]);
+
+    return pkbuf;
+}
+
+static upf_sess_t *restore_session(checkpoint_record_t *record)
+{
+    ogs_pfcp_session_establishment_request_t *req = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+    ogs_pfcp_f_seid_t *f_seid = NULL;
+    upf_sess_t *sess = NULL;
+    size_t len = record->len - sizeof(*record);
+
+    pkbuf = ogs_pkbuf_alloc(NULL, len);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put_data(pkbuf, record + 1, len);
+
+    req = &checkpoint.message->pfcp_session_establishment_request;
+    memset(req, 0, sizeof(*req));
+
+    if (ogs_tlv_parse_msg(req,
+            &ogs_pfcp_msg_desc_pfcp_session_establishment_request,
+            pkbuf, OGS_TLV_MODE_T2_L2) != OGS_OK) {
+        ogs_error("Invalid record [UP:0x%llx]",
+                (unsigned long long)record->upf_n4_seid);
+        goto out;
+    }
+
+    f_seid = req->cp_f_seid.data;
+    if (req->cp_f_seid.presence == 0 || f_seid == NULL) {
+        ogs_error("No CP F-SEID [UP:0x%llx]",
+                (unsigned long long)record->upf_n4_seid);
+        goto out;
+    }
+    f_seid->seid = be64toh(f_seid->seid);
+
+    sess = upf_sess_restore(f_seid, record->upf_n4_seid);
+    if (sess && upf_n4_restore_session(sess, req) == false)
+        sess = NULL;
+
+out:
+    ogs_pkbuf_free(pkbuf);
+
+    return sess;
+}
+
+/* Installs the latest PUT record of each session, in their order */
+static void restore(checkpoint_header_t *header, int *restored, int *failed)
+{
+    uint8_t *area = area_of(header, header->active);
+    size_t used = header->used[header->active];
+    size_t offset;
+    checkpoint_record_t *record = NULL;
+    ogs_hash_t *latest = NULL;
+    upf_sess_t *sess = NULL;
+
+    latest = ogs_hash_make();
+    ogs_assert(latest);
+
+    for (offset = 0; offset < used; offset += RECORD_SIZE(record->len)) {
+        record = (checkpoint_record_t *)(area + offset);
+        if (record_valid(record, used - offset) == false) {
+            ogs_warn("Checkpoint ends with an invalid record at %zu", offset);
+            header->used[header->active] = used = offset;
+            break;
+        }
+        ogs_hash_set(latest, &record->upf_n4_seid,
+                sizeof(record->upf_n4_seid), record);
+    }
+
+    upf_sess_restore_start();
+
+    for (offset = 0; offset < used; offset += RECORD_SIZE(record->len)) {
+        record = (checkpoint_record_t *)(area + offset);
+        if (record->op != CHECKPOINT_RECORD_PUT ||
+            ogs_hash_get(latest, &record->upf_n4_seid,
+                sizeof(record->upf_n4_seid)) != record)
+            continue;
+
+        sess = restore_session(record);
+        if (!sess) {
+            (*failed)++;
+            continue;
+        }
+
+        sess->checkpoint.saved = true;
+        sess->checkpoint.offset = offset;
+        (*restored)++;
+    }
+
+    upf_sess_restore_stop();
+
+    ogs_hash_destroy(latest);
+}
+
+static bool header_valid(checkpoint_header_t *header, size_t length)
+{
+    if (memcmp(header->magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_LEN) != 0)
+        return false;
+    if (header->version != CHECKPOINT_VERSION) {
+        ogs_warn("Checkpoint version %d is not supported",
+                (int)header->version);
+        return false;
+    }
+    if (header->active > 1 ||
+        header->size > (length - CHECKPOINT_HEADER_SIZE) / 2 ||
+        header->used[0] > header->size || header->used[1] > header->size) {
+        ogs_warn("Invalid checkpoint header");
+        return false;
+    }
+
+    return true;
+}
+
+static void reconcile_expire(void *data)
+{
+    upf_sess_t *sess = NULL, *next = NULL;
+    int num_of_sess = 0;
+
+    ogs_list_for_each_safe(&upf_self()->sess_list, next, sess) {
+        if (sess->pfcp_node)
+            continue;
+
+        upf_n4_remove_session(sess);
+        num_of_sess++;
+    }
+
+    if (num_of_sess)
+        ogs_warn("Removed %d restored sessions no SMF has claimed",
+                num_of_sess);
+}
+
+int upf_checkpoint_open(void)
+{
+    const char *path = upf_self()->checkpoint.path;
+    size_t size = upf_self()->checkpoint.size;
+    size_t length = CHECKPOINT_HEADER_SIZE + 2 * size;
+    checkpoint_header_t *header = NULL;
+    struct stat st;
+    int restored = 0, failed = 0;
+    ogs_time_t started;
+    upf_sess_t *sess = NULL;
+    int rv;
+
+    if (!path)
+        return OGS_OK;
+
+    checkpoint.message = ogs_calloc(1, sizeof(*checkpoint.message));
+    ogs_assert(checkpoint.message);
+
+    checkpoint.fd = open(path, O_RDWR|O_CREAT|O_CLOEXEC, 0600);
+    if (checkpoint.fd < 0 || fstat(checkpoint.fd, &st) != 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                "Cannot open checkpoint '%s'", path);
+        return OGS_ERROR;
+    }
+
+    if (st.st_size > CHECKPOINT_HEADER_SIZE) {
+        header = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE,
+                MAP_SHARED, checkpoint.fd, 0);
+        if (header == MAP_FAILED) {
+            ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                    "mmap(%s) failed", path);
+            return OGS_ERROR;
+        }
+
+        if (header_valid(header, st.st_size) == true) {
+            started = ogs_get_monotonic_time();
+            restore(header, &restored, &failed);
+            ogs_info("Restored %d sessions from '%s' in %lld ms "
+                    "(%d failed)", restored, path,
+                    (long long)ogs_time_to_msec(
+                        ogs_get_monotonic_time() - started), failed);
+
+            if (header->size == size && (size_t)st.st_size == length) {
+                checkpoint.header = header;
+                checkpoint.length = length;
+
+                /* Drop the records of the sessions that failed */
+                if (failed && compact() == false)
+                    disable();
+            }
+        }
+
+        if (!checkpoint.header)
+            munmap(header, st.st_size);
+    }
+
+    /* A new file, or the layout of the old one has changed */
+    if (!checkpoint.header) {
+        if (ftruncate(checkpoint.fd, 0) != 0 ||
+            ftruncate(checkpoint.fd, length) != 0) {
+            ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                    "ftruncate(%s) failed", path);
+            return OGS_ERROR;
+        }
+        /* Running out of tmpfs would raise SIGBUS on a later write */
+        rv = posix_fallocate(checkpoint.fd, 0, length);
+        if (rv != 0) {
+            ogs_log_message(OGS_LOG_ERROR, rv,
+                    "Cannot reserve %zu bytes for '%s'", length, path);
+            return OGS_ERROR;
+        }
+
+        header = mmap(NULL, length, PROT_READ|PROT_WRITE,
+                MAP_SHARED, checkpoint.fd, 0);
+        if (header == MAP_FAILED) {
+            ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                    "mmap(%s) failed", path);
+            return OGS_ERROR;
+        }
+
+        memset(header, 0, CHECKPOINT_HEADER_SIZE);
+        header->version = CHECKPOINT_VERSION;
+        header->size = size;
+        memcpy(header->magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_LEN);
+
+        checkpoint.header = header;
+        checkpoint.length = length;
+
+        ogs_list_for_each(&upf_self()->sess_list, sess) {
+            sess->checkpoint.saved = false;
+            upf_checkpoint_update(sess);
+        }
+    }
+
+    if (restored) {
+        checkpoint.t_reconcile = ogs_timer_add(
+                ogs_app()->timer_mgr, reconcile_expire, NULL);
+        ogs_assert(checkpoint.t_reconcile);
+        ogs_timer_start(checkpoint.t_reconcile,
+                upf_self()->checkpoint.reconcile);
+    }
+
+    return OGS_OK;
+}
+
+void upf_checkpoint_close(void)
+{
+    if (checkpoint.t_reconcile) {
+        ogs_timer_delete(checkpoint.t_reconcile);
+        checkpoint.t_reconcile = NULL;
+    }
+    if (checkpoint.header) {
+        munmap(checkpoint.header, checkpoint.length);
+        checkpoint.header = NULL;
+    }
+    if (checkpoint.fd >= 0) {
+        close(checkpoint.fd);
+        checkpoint.fd = -1;
+    }
+    if (checkpoint.message) {
+        ogs_free(checkpoint.message);
+        checkpoint.message = NULL;
+    }
+}
+
+void upf_checkpoint_update(upf_sess_t *sess)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    ogs_assert(sess);
+
+    if (!checkpoint.header || checkpoint.disabled)
+        return;
+
+    pkbuf = build_session(sess);
+    if (!pkbuf) {
+        if (sess->checkpoint.saved)
+            append(sess, CHECKPOINT_RECORD_DEL, NULL);
+        return;
+    }
+
+    append(sess, CHECKPOINT_RECORD_PUT, pkbuf);
+    ogs_pkbuf_free(pkbuf);
+}
+
+void upf_checkpoint_remove(upf_sess_t *sess)
+{
+    ogs_assert(sess);
+
+    if (!checkpoint.header || checkpoint.disabled)
+        return;
+
+    if (sess->checkpoint.saved)
+        append(sess, CHECKPOINT_RECORD_DEL, NULL);
+}
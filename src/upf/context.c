@@ -18,6 +18,7 @@
  */
 
 #include "context.h"
+#include "checkpoint.h"
 #include "pfcp-path.h"
 
 static upf_context_t self;
@@ -26,13 +27,23 @@ int __upf_log_domain;
 
 static OGS_POOL(upf_sess_pool, upf_sess_t);
 static OGS_POOL(upf_n4_seid_pool, ogs_pool_id_t);
+static OGS_POOL(upf_urr_acc_pool, upf_sess_urr_acc_t);
 
 static int context_initialized = 0;
 
 static void upf_sess_urr_acc_remove_all(upf_sess_t *sess);
+static void upf_sess_urr_acc_report(upf_sess_t *sess,
+        upf_sess_urr_acc_t *urr_acc);
+static void report_pending_unlink(upf_sess_t *sess);
+static void report_pending_update(upf_sess_t *sess);
+static void urr_wheel_tick(void *data);
+static void report_flush(void *data);
+static void load_update(void *data);
 
 void upf_context_init(void)
 {
+    int i;
+
     ogs_assert(context_initialized == 0);
 
     /* Initialize UPF context */
@@ -49,7 +60,9 @@ void upf_context_init(void)
     ogs_pfcp_self()->up_function_features_len = 4;
 
     ogs_list_init(&self.sess_list);
-    ogs_pool_init(&upf_sess_pool, ogs_app()->pool.sess);
+    ogs_pool_init_elastic(&upf_sess_pool, ogs_app()->pool.sess);
+    ogs_pool_init_elastic(&upf_urr_acc_pool,
+            ogs_app()->pool.sess * OGS_MAX_NUM_OF_URR);
     ogs_pool_init(&upf_n4_seid_pool, ogs_app()->pool.sess);
     ogs_pool_random_id_generate(&upf_n4_seid_pool);
 
@@ -64,6 +77,21 @@ void upf_context_init(void)
     self.ipv6_hash = ogs_hash_make();
     ogs_assert(self.ipv6_hash);
 
+    for (i = 0; i < UPF_URR_WHEEL_SIZE; i++)
+        ogs_list_init(&self.urr_wheel.slot[i]);
+    self.urr_wheel.t_tick = ogs_timer_add(
+            ogs_app()->timer_mgr, urr_wheel_tick, NULL);
+    ogs_assert(self.urr_wheel.t_tick);
+
+    ogs_list_init(&self.report.pending_list);
+    self.report.t_flush = ogs_timer_add(
+            ogs_app()->timer_mgr, report_flush, NULL);
+    ogs_assert(self.report.t_flush);
+
+    self.load.t_update = ogs_timer_add(
+            ogs_app()->timer_mgr, load_update, NULL);
+    ogs_assert(self.load.t_update);
+
     context_initialized = 1;
 }
 
@@ -82,6 +110,10 @@ void upf_context_final(void)
 
     upf_sess_remove_all();
 
+    ogs_timer_delete(self.urr_wheel.t_tick);
+    ogs_timer_delete(self.report.t_flush);
+    ogs_timer_delete(self.load.t_update);
+
     ogs_assert(self.upf_n4_seid_hash);
     ogs_hash_destroy(self.upf_n4_seid_hash);
     ogs_assert(self.smf_n4_seid_hash);
@@ -97,8 +129,12 @@ void upf_context_final(void)
     free_upf_route_trie_node(self.ipv6_framed_routes);
 
     ogs_pool_final(&upf_sess_pool);
+    ogs_pool_final(&upf_urr_acc_pool);
     ogs_pool_final(&upf_n4_seid_pool);
 
+    if (self.checkpoint.path)
+        ogs_free(self.checkpoint.path);
+
     context_initialized = 0;
 }
 
@@ -109,11 +145,35 @@ upf_context_t *upf_self(void)
 
 static int upf_context_prepare(void)
 {
+    self.report.jitter = ogs_time_from_sec(UPF_DEFAULT_REPORT_JITTER);
+    self.report.window = UPF_DEFAULT_REPORT_WINDOW;
+
+    self.load.interval = ogs_time_from_sec(UPF_DEFAULT_LOAD_INTERVAL);
+    self.load.overload_threshold = UPF_DEFAULT_OVERLOAD_THRESHOLD;
+    self.load.overload_validity =
+        ogs_time_from_sec(UPF_DEFAULT_OVERLOAD_VALIDITY);
+
+    self.checkpoint.size =
+        (size_t)ogs_app()->pool.sess * UPF_CHECKPOINT_SIZE_PER_SESS;
+    self.checkpoint.reconcile =
+        ogs_time_from_sec(UPF_DEFAULT_CHECKPOINT_RECONCILE);
+
     return OGS_OK;
 }
 
 static int upf_context_validation(void)
 {
+    if (self.load.overload_threshold < 0 ||
+        self.load.overload_threshold >= 100) {
+        ogs_error("upf.load.overload must be below 100 in '%s'",
+                ogs_app()->file);
+        return OGS_ERROR;
+    }
+    if (self.checkpoint.path && self.checkpoint.reconcile <= 0) {
+        ogs_error("upf.checkpoint.reconcile must be positive in '%s'",
+                ogs_app()->file);
+        return OGS_ERROR;
+    }
     if (ogs_list_first(&ogs_gtp_self()->gtpu_list) == NULL) {
         ogs_error("No upf.gtpu.address in '%s'", ogs_app()->file);
         return OGS_ERROR;
@@ -125,6 +185,52 @@ static int upf_context_validation(void)
     return OGS_OK;
 }
 
+static void parse_report_conf(ogs_yaml_iter_t *upf_iter)
+{
+    ogs_yaml_iter_t report_iter;
+
+    ogs_yaml_iter_recurse(upf_iter, &report_iter);
+    while (ogs_yaml_iter_next(&report_iter)) {
+        const char *report_key = ogs_yaml_iter_key(&report_iter);
+        ogs_assert(report_key);
+        if (!strcmp(report_key, "jitter")) {
+            const char *v = ogs_yaml_iter_value(&report_iter);
+            if (v)
+                self.report.jitter = ogs_time_from_sec(atoi(v));
+        } else if (!strcmp(report_key, "window")) {
+            const char *v = ogs_yaml_iter_value(&report_iter);
+            if (v)
+                self.report.window = atoi(v);
+        } else
+            ogs_warn("unknown key `%s`", report_key);
+    }
+}
+
+static void parse_load_conf(ogs_yaml_iter_t *upf_iter)
+{
+    ogs_yaml_iter_t load_iter;
+
+    ogs_yaml_iter_recurse(upf_iter, &load_iter);
+    while (ogs_yaml_iter_next(&load_iter)) {
+        const char *load_key = ogs_yaml_iter_key(&load_iter);
+        ogs_assert(load_key);
+        if (!strcmp(load_key, "interval")) {
+            const char *v = ogs_yaml_iter_value(&load_iter);
+            if (v)
+                self.load.interval = ogs_time_from_sec(atoi(v));
+        } else if (!strcmp(load_key, "overload")) {
+            const char *v = ogs_yaml_iter_value(&load_iter);
+            if (v)
+                self.load.overload_threshold = atoi(v);
+        } else if (!strcmp(load_key, "validity")) {
+            const char *v = ogs_yaml_iter_value(&load_iter);
+            if (v)
+                self.load.overload_validity = ogs_time_from_sec(atoi(v));
+        } else
+            ogs_warn("unknown key `%s`", load_key);
+    }
+}
+
 int upf_context_parse_config(void)
 {
     int rv;
@@ -159,6 +265,41 @@ int upf_context_parse_config(void)
                     /* handle config in pfcp library */
                 } else if (!strcmp(upf_key, "metrics")) {
                     /* handle config in metrics library */
+                } else if (!strcmp(upf_key, "report")) {
+                    parse_report_conf(&upf_iter);
+                } else if (!strcmp(upf_key, "load")) {
+                    parse_load_conf(&upf_iter);
+                } else if (!strcmp(upf_key, "checkpoint")) {
+                    ogs_yaml_iter_t checkpoint_iter;
+                    ogs_yaml_iter_recurse(&upf_iter, &checkpoint_iter);
+                    while (ogs_yaml_iter_next(&checkpoint_iter)) {
+                        const char *checkpoint_key =
+                            ogs_yaml_iter_key(&checkpoint_iter);
+                        ogs_assert(checkpoint_key);
+                        if (!strcmp(checkpoint_key, "path")) {
+                            const char *v =
+                                ogs_yaml_iter_value(&checkpoint_iter);
+                            if (v) {
+                                if (self.checkpoint.path)
+                                    ogs_free(self.checkpoint.path);
+                                self.checkpoint.path = ogs_strdup(v);
+                                ogs_assert(self.checkpoint.path);
+                            }
+                        } else if (!strcmp(checkpoint_key, "size")) {
+                            const char *v =
+                                ogs_yaml_iter_value(&checkpoint_iter);
+                            if (v && atoi(v) > 0)
+                                self.checkpoint.size =
+                                    (size_t)atoi(v) * 1024 * 1024;
+                        } else if (!strcmp(checkpoint_key, "reconcile")) {
+                            const char *v =
+                                ogs_yaml_iter_value(&checkpoint_iter);
+                            if (v)
+                                self.checkpoint.reconcile =
+                                    ogs_time_from_sec(atoi(v));
+                        } else
+                            ogs_warn("unknown key `%s`", checkpoint_key);
+                    }
                 } else
                     ogs_warn("unknown key `%s`", upf_key);
             }
@@ -171,6 +312,70 @@ int upf_context_parse_config(void)
     return OGS_OK;
 }
 
+/* Usage report pacing and load control taken from a reloaded file */
+int upf_context_reload_config(const char *local)
+{
+    yaml_document_t *document = NULL;
+    ogs_yaml_iter_t root_iter;
+    int idx = 0;
+    ogs_time_t jitter = self.report.jitter;
+    int window = self.report.window;
+    ogs_time_t interval = self.load.interval;
+    int overload_threshold = self.load.overload_threshold;
+    ogs_time_t overload_validity = self.load.overload_validity;
+
+    ogs_assert(local);
+
+    document = ogs_app()->document;
+    ogs_assert(document);
+
+    self.report.jitter = ogs_time_from_sec(UPF_DEFAULT_REPORT_JITTER);
+    self.report.window = UPF_DEFAULT_REPORT_WINDOW;
+    self.load.interval = ogs_time_from_sec(UPF_DEFAULT_LOAD_INTERVAL);
+    self.load.overload_threshold = UPF_DEFAULT_OVERLOAD_THRESHOLD;
+    self.load.overload_validity =
+        ogs_time_from_sec(UPF_DEFAULT_OVERLOAD_VALIDITY);
+
+    ogs_yaml_iter_init(&root_iter, document);
+    while (ogs_yaml_iter_next(&root_iter)) {
+        const char *root_key = ogs_yaml_iter_key(&root_iter);
+        ogs_assert(root_key);
+        if ((!strcmp(root_key, local)) &&
+            (idx++ == ogs_app()->config_section_id)) {
+            ogs_yaml_iter_t upf_iter;
+            ogs_yaml_iter_recurse(&root_iter, &upf_iter);
+            while (ogs_yaml_iter_next(&upf_iter)) {
+                const char *upf_key = ogs_yaml_iter_key(&upf_iter);
+                ogs_assert(upf_key);
+                if (!strcmp(upf_key, "report"))
+                    parse_report_conf(&upf_iter);
+                else if (!strcmp(upf_key, "load"))
+                    parse_load_conf(&upf_iter);
+            }
+        }
+    }
+
+    if (self.load.overload_threshold < 0 ||
+        self.load.overload_threshold >= 100) {
+        ogs_error("upf.load.overload must be below 100 in '%s'",
+                ogs_app()->file);
+
+        self.report.jitter = jitter;
+        self.report.window = window;
+        self.load.interval = interval;
+        self.load.overload_threshold = overload_threshold;
+        self.load.overload_validity = overload_validity;
+
+        return OGS_ERROR;
+    }
+
+    /* Picks up the new interval, or stops when it is now 0 */
+    upf_load_stop();
+    upf_load_start();
+
+    return OGS_OK;
+}
+
 upf_sess_t *upf_sess_add(ogs_pfcp_f_seid_t *cp_f_seid)
 {
     upf_sess_t *sess = NULL;
@@ -216,10 +421,8 @@ int upf_sess_remove(upf_sess_t *sess)
 {
     ogs_assert(sess);
 
-    upf_sess_urr_acc_remove_all(sess);
-
     ogs_list_remove(&self.sess_list, sess);
-    ogs_pfcp_sess_clear(&sess->pfcp);
+    upf_sess_clear(sess);
 
     ogs_hash_set(self.upf_n4_seid_hash, &sess->upf_n4_seid,
             sizeof(sess->upf_n4_seid), NULL);
@@ -229,31 +432,47 @@ int upf_sess_remove(upf_sess_t *sess)
     ogs_hash_set(self.smf_n4_f_seid_hash, &sess->smf_n4_f_seid,
             sizeof(sess->smf_n4_f_seid), NULL);
 
+    upf_checkpoint_remove(sess);
+
+    ogs_pfcp_pool_final(&sess->pfcp);
+
+    if (sess->apn_dnn)
+        ogs_free(sess->apn_dnn);
+
+    ogs_pool_free(&upf_n4_seid_pool, sess->upf_n4_seid_node);
+    ogs_pool_id_free(&upf_sess_pool, sess);
+    upf_metrics_inst_global_dec(UPF_METR_GLOB_GAUGE_UPF_SESSIONNBR);
+
+    ogs_info("[Removed] Number of UPF-sessions is now %d",
+            ogs_list_count(&self.sess_list));
+
+    return OGS_OK;
+}
+
+/* Releases the rules and UE addresses, but keeps the session */
+void upf_sess_clear(upf_sess_t *sess)
+{
+    ogs_assert(sess);
+
+    upf_sess_urr_acc_remove_all(sess);
+    report_pending_unlink(sess);
+
+    ogs_pfcp_sess_clear(&sess->pfcp);
+
     if (sess->ipv4) {
         ogs_hash_set(self.ipv4_hash, sess->ipv4->addr, OGS_IPV4_LEN, NULL);
         ogs_pfcp_ue_ip_free(sess->ipv4);
+        sess->ipv4 = NULL;
     }
     if (sess->ipv6) {
         ogs_hash_set(self.ipv6_hash,
                 sess->ipv6->addr, OGS_IPV6_DEFAULT_PREFIX_LEN >> 3, NULL);
         ogs_pfcp_ue_ip_free(sess->ipv6);
+        sess->ipv6 = NULL;
     }
 
     upf_sess_set_ue_ipv4_framed_routes(sess, NULL);
     upf_sess_set_ue_ipv6_framed_routes(sess, NULL);
-
-    ogs_pfcp_pool_final(&sess->pfcp);
-
-    ogs_pool_free(&upf_n4_seid_pool, sess->upf_n4_seid_node);
-    ogs_pool_id_free(&upf_sess_pool, sess);
-    if (sess->apn_dnn)
-        ogs_free(sess->apn_dnn);
-    upf_metrics_inst_global_dec(UPF_METR_GLOB_GAUGE_UPF_SESSIONNBR);
-
-    ogs_info("[Removed] Number of UPF-sessions is now %d",
-            ogs_list_count(&self.sess_list));
-
-    return OGS_OK;
 }
 
 void upf_sess_remove_all(void)
@@ -265,6 +484,19 @@ void upf_sess_remove_all(void)
     }
 }
 
+/* Moves the session to another SMF of the same SMF set */
+void upf_sess_set_smf_n4_ip(upf_sess_t *sess, ogs_ip_t *ip)
+{
+    ogs_assert(sess);
+    ogs_assert(ip);
+
+    ogs_hash_set(self.smf_n4_f_seid_hash, &sess->smf_n4_f_seid,
+            sizeof(sess->smf_n4_f_seid), NULL);
+    memcpy(&sess->smf_n4_f_seid.ip, ip, sizeof(*ip));
+    ogs_hash_set(self.smf_n4_f_seid_hash, &sess->smf_n4_f_seid,
+            sizeof(sess->smf_n4_f_seid), sess);
+}
+
 upf_sess_t *upf_sess_find_by_smf_n4_seid(uint64_t seid)
 {
     return ogs_hash_get(self.smf_n4_seid_hash, &seid, sizeof(seid));
@@ -358,6 +590,81 @@ upf_sess_t *upf_sess_find_by_id(ogs_pool_id_t id)
     return ogs_pool_find_by_id(&upf_sess_pool, id);
 }
 
+/*
+ * A restored session keeps the UPF-N4-SEID its SMF knows it by. The
+ * SEID pool is shuffled, so seid_node[] tells which node holds a SEID;
+ * it only exists while the checkpoint is being restored.
+ */
+static ogs_pool_id_t **seid_node;
+
+void upf_sess_restore_start(void)
+{
+    int i;
+
+    ogs_assert(!seid_node);
+    seid_node = ogs_calloc(upf_n4_seid_pool.size + 1, sizeof(*seid_node));
+    ogs_assert(seid_node);
+
+    for (i = 0; i < upf_n4_seid_pool.size; i++)
+        seid_node[upf_n4_seid_pool.array[i]] = &upf_n4_seid_pool.array[i];
+}
+
+void upf_sess_restore_stop(void)
+{
+    ogs_assert(seid_node);
+    ogs_free(seid_node);
+    seid_node = NULL;
+}
+
+upf_sess_t *upf_sess_restore(
+        ogs_pfcp_f_seid_t *cp_f_seid, uint64_t upf_n4_seid)
+{
+    upf_sess_t *sess = NULL;
+    ogs_pool_id_t *node = NULL, *other = NULL;
+
+    ogs_assert(seid_node);
+    ogs_assert(cp_f_seid);
+
+    if (upf_n4_seid == 0 || upf_n4_seid > upf_n4_seid_pool.size) {
+        ogs_error("UPF-N4-SEID[0x%llx] out of range",
+                (unsigned long long)upf_n4_seid);
+        return NULL;
+    }
+    if (upf_sess_find_by_upf_n4_seid(upf_n4_seid) ||
+        upf_sess_find_by_smf_n4_f_seid(cp_f_seid)) {
+        ogs_error("Session has already been restored [UP:0x%llx CP:0x%llx]",
+                (unsigned long long)upf_n4_seid,
+                (unsigned long long)cp_f_seid->seid);
+        return NULL;
+    }
+
+    sess = upf_sess_add(cp_f_seid);
+    ogs_assert(sess);
+
+    /*
+     * No session holds the SEID, so the node it is in is still free
+     * and can take the SEID the new session was given instead.
+     */
+    node = sess->upf_n4_seid_node;
+    other = seid_node[upf_n4_seid];
+    if (other != node) {
+        ogs_hash_set(self.upf_n4_seid_hash, &sess->upf_n4_seid,
+                sizeof(sess->upf_n4_seid), NULL);
+
+        *other = *node;
+        seid_node[*other] = other;
+        *node = upf_n4_seid;
+        seid_node[*node] = node;
+
+        sess->upf_n4_seid = upf_n4_seid;
+        ogs_hash_set(self.upf_n4_seid_hash, &sess->upf_n4_seid,
+                sizeof(sess->upf_n4_seid), sess);
+    }
+    sess->restored = true;
+
+    return sess;
+}
+
 upf_sess_t *upf_sess_add_by_message(ogs_pfcp_message_t *message)
 {
     upf_sess_t *sess = NULL;
@@ -680,11 +987,49 @@ uint8_t upf_sess_set_ue_ipv6_framed_routes(upf_sess_t *sess,
     return cause_value;
 }
 
+static upf_sess_urr_acc_t *urr_acc_find(
+        upf_sess_t *sess, ogs_pfcp_urr_id_t id)
+{
+    upf_sess_urr_acc_t *urr_acc = NULL;
+
+    ogs_list_for_each_entry(&sess->urr_acc_list, urr_acc, sess_node)
+        if (urr_acc->id == id)
+            return urr_acc;
+
+    return NULL;
+}
+
+/* A session only has a few URRs, so the list stays short */
+static upf_sess_urr_acc_t *urr_acc_find_or_add(
+        upf_sess_t *sess, const ogs_pfcp_urr_t *urr)
+{
+    upf_sess_urr_acc_t *urr_acc = urr_acc_find(sess, urr->id);
+
+    if (urr_acc)
+        return urr_acc;
+
+    ogs_pool_alloc(&upf_urr_acc_pool, &urr_acc);
+    if (!urr_acc) {
+        ogs_error("urr_acc_pool() failed");
+        return NULL;
+    }
+    memset(urr_acc, 0, sizeof(*urr_acc));
+
+    urr_acc->sess = sess;
+    urr_acc->id = urr->id;
+    ogs_list_add(&sess->urr_acc_list, &urr_acc->sess_node);
+
+    return urr_acc;
+}
+
 void upf_sess_urr_acc_add(upf_sess_t *sess, ogs_pfcp_urr_t *urr, size_t size, bool is_uplink)
 {
-    upf_sess_urr_acc_t *urr_acc = &sess->urr_acc[urr->id];
+    upf_sess_urr_acc_t *urr_acc = urr_acc_find_or_add(sess, urr);
     uint64_t vol;
 
+    if (!urr_acc)
+        return;
+
     /* Increment total & ul octets + pkts */
     urr_acc->total_octets += size;
     urr_acc->total_pkts++;
@@ -696,36 +1041,35 @@ void upf_sess_urr_acc_add(upf_sess_t *sess, ogs_pfcp_urr_t *urr, size_t size, bo
         urr_acc->dl_pkts++;
     }
 
-    urr_acc->time_of_last_packet = ogs_time_now();
+    /* Monotonic, converted to UTC only when a report is built */
+    urr_acc->time_of_last_packet = ogs_time_cached();
     if (urr_acc->time_of_first_packet == 0)
         urr_acc->time_of_first_packet = urr_acc->time_of_last_packet;
 
-    /* generate report if volume threshold/quota is reached */
+    /* queue a report if volume threshold/quota is reached */
     vol = urr_acc->total_octets - urr_acc->last_report.total_octets;
     if ((urr->rep_triggers.volume_quota && urr->vol_quota.tovol && vol >= urr->vol_quota.total_volume) ||
         (urr->rep_triggers.volume_threshold && urr->vol_threshold.tovol && vol >= urr->vol_threshold.total_volume)) {
-        ogs_pfcp_user_plane_report_t report;
-        memset(&report, 0, sizeof(report));
-        upf_sess_urr_acc_fill_usage_report(sess, urr, &report, 0);
-        report.num_of_usage_report = 1;
-        upf_sess_urr_acc_snapshot(sess, urr);
-
-        ogs_assert(OGS_OK ==
-            upf_pfcp_send_session_report_request(sess, &report));
-        /* Start new report period/iteration: */
-        upf_sess_urr_acc_timers_setup(sess, urr);
+        upf_sess_urr_acc_report(sess, urr_acc);
     }
 }
 
 /* report struct must be memzeroed before first use of this function.
- * report->num_of_usage_report must be set by the caller */
-void upf_sess_urr_acc_fill_usage_report(upf_sess_t *sess, const ogs_pfcp_urr_t *urr,
+ * report->num_of_usage_report must be set by the caller.
+ * Returns false, leaving the report untouched, if the URR has no
+ * measurement and none can be allocated */
+bool upf_sess_urr_acc_fill_usage_report(upf_sess_t *sess, const ogs_pfcp_urr_t *urr,
                                   ogs_pfcp_user_plane_report_t *report, unsigned int idx)
 {
-    upf_sess_urr_acc_t *urr_acc = &sess->urr_acc[urr->id];
+    upf_sess_urr_acc_t *urr_acc = urr_acc_find_or_add(sess, urr);
     ogs_time_t last_report_timestamp;
     ogs_time_t now;
 
+    if (!urr_acc) {
+        ogs_error("[URR:%d] No measurement, usage report skipped", urr->id);
+        return false;
+    }
+
     now = ogs_time_now(); /* we need UTC for start_time and end_time */
 
     if (urr_acc->last_report.timestamp)
@@ -755,8 +1099,10 @@ void upf_sess_urr_acc_fill_usage_report(upf_sess_t *sess, const ogs_pfcp_urr_t *
     if (now >= last_report_timestamp)
         report->usage_report[idx].dur_measurement = ((now - last_report_timestamp) + (OGS_USEC_PER_SEC/2)) / OGS_USEC_PER_SEC; /* FIXME: should use MONOTONIC here */
     /* else memset sets it to 0 */
-    report->usage_report[idx].time_of_first_packet = ogs_time_to_ntp32(urr_acc->time_of_first_packet); /* TODO: First since last report? */
-    report->usage_report[idx].time_of_last_packet = ogs_time_to_ntp32(urr_acc->time_of_last_packet);
+    if (urr_acc->time_of_first_packet) {
+        report->usage_report[idx].time_of_first_packet = ogs_time_to_ntp32(ogs_time_from_monotonic(urr_acc->time_of_first_packet)); /* TODO: First since last report? */
+        report->usage_report[idx].time_of_last_packet = ogs_time_to_ntp32(ogs_time_from_monotonic(urr_acc->time_of_last_packet));
+    }
 
     /* Time triggers: */
     if (urr->quota_validity_time > 0 &&
@@ -776,11 +1122,18 @@ void upf_sess_urr_acc_fill_usage_report(upf_sess_t *sess, const ogs_pfcp_urr_t *
     if (urr->rep_triggers.volume_threshold && urr->vol_threshold.tovol &&
             report->usage_report[idx].vol_measurement.total_volume >= urr->vol_threshold.total_volume)
         report->usage_report[idx].rep_trigger.volume_threshold = 1;
+
+    return true;
 }
 
 void upf_sess_urr_acc_snapshot(upf_sess_t *sess, ogs_pfcp_urr_t *urr)
 {
-    upf_sess_urr_acc_t *urr_acc = &sess->urr_acc[urr->id];
+    upf_sess_urr_acc_t *urr_acc = urr_acc_find_or_add(sess, urr);
+
+    if (!urr_acc) {
+        ogs_error("[URR:%d] No measurement to snapshot", urr->id);
+        return;
+    }
     urr_acc->last_report.total_octets = urr_acc->total_octets;
     urr_acc->last_report.dl_octets = urr_acc->dl_octets;
     urr_acc->last_report.ul_octets = urr_acc->ul_octets;
@@ -788,97 +1141,347 @@ void upf_sess_urr_acc_snapshot(upf_sess_t *sess, ogs_pfcp_urr_t *urr)
     urr_acc->last_report.dl_pkts = urr_acc->dl_pkts;
     urr_acc->last_report.ul_pkts = urr_acc->ul_pkts;
     urr_acc->last_report.timestamp = ogs_time_now();
+
+    /* The measurement is reported now, not in a Session Report Request */
+    if (urr_acc->report_pending) {
+        urr_acc->report_pending = false;
+        report_pending_update(sess);
+    }
 }
 
-static void upf_sess_urr_acc_timers_cb(void *data)
+/*
+ * Time-based reporting (Quota Validity Time, Time Quota, Time Threshold)
+ *
+ * URRs sit on a hashed timing wheel with one-second slots rather than
+ * owning up to three timers each; the tick timer only runs while the
+ * wheel is not empty. Each period is stretched by a random jitter so
+ * URRs installed together do not all expire on the same tick.
+ */
+static void urr_wheel_unschedule(upf_sess_urr_acc_t *urr_acc)
 {
-    ogs_pfcp_urr_t *urr = (ogs_pfcp_urr_t *)data;
-    ogs_pfcp_user_plane_report_t report;
-    ogs_pfcp_sess_t *pfcp_sess = urr->sess;
-    upf_sess_t *sess = UPF_SESS(pfcp_sess);
+    if (!urr_acc->scheduled)
+        return;
 
-    ogs_info("upf_time_threshold_cb() triggered! urr=%p", urr);
+    ogs_list_remove(&self.urr_wheel.slot[urr_acc->slot], urr_acc);
+    urr_acc->scheduled = false;
 
-    if (urr->rep_triggers.quota_validity_time ||
-        urr->rep_triggers.time_quota ||
-        urr->rep_triggers.time_threshold) {
-        memset(&report, 0, sizeof(report));
-        upf_sess_urr_acc_fill_usage_report(sess, urr, &report, 0);
-        report.num_of_usage_report = 1;
-        upf_sess_urr_acc_snapshot(sess, urr);
+    ogs_assert(self.urr_wheel.count);
+    if (--self.urr_wheel.count == 0)
+        ogs_timer_stop(self.urr_wheel.t_tick);
+}
 
-        ogs_assert(OGS_OK ==
-            upf_pfcp_send_session_report_request(sess, &report));
+static void urr_wheel_schedule(upf_sess_t *sess,
+        upf_sess_urr_acc_t *urr_acc, ogs_time_t period)
+{
+    ogs_time_t jitter;
+    uint64_t ticks;
+
+    urr_wheel_unschedule(urr_acc);
+
+    /* Bounded so that short periods stay accurate */
+    jitter = ogs_min(self.report.jitter, period / 16);
+    if (jitter > 0)
+        period += ogs_random32() % (jitter + 1);
+
+    /* The first tick comes within a second, so add one to never be early */
+    ticks = (period + OGS_USEC_PER_SEC - 1) / OGS_USEC_PER_SEC + 1;
+
+    urr_acc->sess = sess;
+    urr_acc->slot = (self.urr_wheel.current + ticks) % UPF_URR_WHEEL_SIZE;
+    urr_acc->rounds = (ticks - 1) / UPF_URR_WHEEL_SIZE;
+    urr_acc->scheduled = true;
+    ogs_list_add(&self.urr_wheel.slot[urr_acc->slot], urr_acc);
+
+    if (self.urr_wheel.count++ == 0)
+        ogs_timer_start(self.urr_wheel.t_tick, ogs_time_from_sec(1));
+}
+
+static void urr_wheel_tick(void *data)
+{
+    ogs_list_t *slot = NULL;
+    upf_sess_urr_acc_t *urr_acc = NULL, *next_urr_acc = NULL;
+
+    self.urr_wheel.current = (self.urr_wheel.current + 1) % UPF_URR_WHEEL_SIZE;
+    slot = &self.urr_wheel.slot[self.urr_wheel.current];
+
+    ogs_list_for_each_safe(slot, next_urr_acc, urr_acc) {
+        upf_sess_t *sess = urr_acc->sess;
+
+        if (urr_acc->rounds) {
+            urr_acc->rounds--;
+            continue;
+        }
+
+        urr_wheel_unschedule(urr_acc);
+
+        /* The URR may have been removed by a Session Modification */
+        if (!ogs_pfcp_urr_find(&sess->pfcp, urr_acc->id))
+            continue;
+
+        upf_sess_urr_acc_report(sess, urr_acc);
     }
-    /* Start new report period/iteration: */
-    upf_sess_urr_acc_timers_setup(sess, urr);
+
+    if (self.urr_wheel.count)
+        ogs_timer_start(self.urr_wheel.t_tick, ogs_time_from_sec(1));
 }
 
-static void upf_sess_urr_acc_validity_time_setup(upf_sess_t *sess, ogs_pfcp_urr_t *urr)
+/*
+ * Volume and time triggers only mark the URR. All pending reports of a
+ * session are sent together in one Session Report Request when the
+ * flush timer fires at the end of the current loop iteration.
+ */
+static void upf_sess_urr_acc_report(upf_sess_t *sess,
+        upf_sess_urr_acc_t *urr_acc)
 {
-    upf_sess_urr_acc_t *urr_acc = &sess->urr_acc[urr->id];
+    urr_acc->report_pending = true;
 
-    ogs_debug("Installing URR Quota Validity Time timer");
-    urr_acc->reporting_enabled = true;
-    if (!urr_acc->t_validity_time)
-        urr_acc->t_validity_time = ogs_timer_add(ogs_app()->timer_mgr,
-                                        upf_sess_urr_acc_timers_cb, urr);
-    ogs_timer_start(urr_acc->t_validity_time,
-            ogs_time_from_sec(urr->quota_validity_time));
+    if (sess->report.pending)
+        return;
+
+    /*
+     * The flush timer is armed whenever the list is not empty. A zero
+     * duration is refused by ogs_timer_start(); one microsecond has
+     * already elapsed when the timers of this iteration are expired.
+     */
+    if (!ogs_list_first(&self.report.pending_list))
+        ogs_timer_start(self.report.t_flush, 1);
+
+    sess->report.pending = true;
+    ogs_list_add(&self.report.pending_list, &sess->report.lnode);
 }
 
-static void upf_sess_urr_acc_time_quota_setup(upf_sess_t *sess, ogs_pfcp_urr_t *urr)
+static void report_pending_unlink(upf_sess_t *sess)
 {
-    upf_sess_urr_acc_t *urr_acc = &sess->urr_acc[urr->id];
+    if (!sess->report.pending)
+        return;
 
-    ogs_debug("Installing URR Time Quota timer");
-    urr_acc->reporting_enabled = true;
-    if (!urr_acc->t_time_quota)
-        urr_acc->t_time_quota = ogs_timer_add(ogs_app()->timer_mgr,
-                                        upf_sess_urr_acc_timers_cb, urr);
-    ogs_timer_start(urr_acc->t_time_quota, ogs_time_from_sec(urr->time_quota));
+    ogs_list_remove(&self.report.pending_list, &sess->report.lnode);
+    sess->report.pending = false;
 }
 
-static void upf_sess_urr_acc_time_threshold_setup(upf_sess_t *sess, ogs_pfcp_urr_t *urr)
+/* Drops the session from the pending list once no URR is left to report */
+static void report_pending_update(upf_sess_t *sess)
 {
-    upf_sess_urr_acc_t *urr_acc = &sess->urr_acc[urr->id];
+    upf_sess_urr_acc_t *urr_acc = NULL;
 
-    ogs_debug("Installing URR Time Threshold timer");
-    urr_acc->reporting_enabled = true;
-    if (!urr_acc->t_time_threshold)
-        urr_acc->t_time_threshold = ogs_timer_add(ogs_app()->timer_mgr,
-                                        upf_sess_urr_acc_timers_cb, urr);
-    ogs_timer_start(urr_acc->t_time_threshold,
-            ogs_time_from_sec(urr->time_threshold));
+    if (!sess->report.pending)
+        return;
+
+    ogs_list_for_each_entry(&sess->urr_acc_list, urr_acc, sess_node) {
+        if (urr_acc->report_pending)
+            return;
+    }
+
+    report_pending_unlink(sess);
+}
+
+static bool report_window_full(upf_sess_t *sess)
+{
+    ogs_pfcp_node_t *node = sess->pfcp_node;
+
+    if (!node || self.report.window <= 0)
+        return false;
+
+    return node->xact_stats.local >= self.report.window;
+}
+
+/* ogs_pfcp_session_report_request_t carries at most 8 Usage Reports */
+#define MAX_USAGE_REPORT_PER_REQUEST 8
+
+static void send_pending_usage_report(upf_sess_t *sess)
+{
+    ogs_pfcp_user_plane_report_t report;
+    ogs_pfcp_urr_t *urr = NULL;
+    unsigned int num_of_reports = 0;
+    bool more = false;
+
+    memset(&report, 0, sizeof(report));
+    ogs_list_for_each(&sess->pfcp.urr_list, urr) {
+        upf_sess_urr_acc_t *urr_acc = urr_acc_find(sess, urr->id);
+
+        if (!urr_acc || !urr_acc->report_pending)
+            continue;
+        if (num_of_reports == MAX_USAGE_REPORT_PER_REQUEST) {
+            more = true;
+            break;
+        }
+
+        if (upf_sess_urr_acc_fill_usage_report(
+                    sess, urr, &report, num_of_reports) == false)
+            continue;
+        num_of_reports++;
+        upf_sess_urr_acc_snapshot(sess, urr);
+
+        /* Start new report period/iteration: */
+        upf_sess_urr_acc_timers_setup(sess, urr);
+    }
+
+    if (!more)
+        report_pending_unlink(sess);
+
+    if (num_of_reports) {
+        report.num_of_usage_report = num_of_reports;
+        ogs_assert(OGS_OK ==
+            upf_pfcp_send_session_report_request(sess, &report));
+    }
+}
+
+static void report_flush(void *data)
+{
+    ogs_lnode_t *lnode = NULL, *next = NULL;
+
+    for (lnode = ogs_list_first(&self.report.pending_list);
+            lnode; lnode = next) {
+        upf_sess_t *sess = ogs_container_of(lnode, upf_sess_t, report.lnode);
+        next = ogs_list_next(lnode);
+
+        /*
+         * A restored session keeps its usage pending until the SMF claims
+         * it; taking the snapshot now would lose it for charging.
+         */
+        if (!sess->pfcp_node)
+            continue;
+
+        while (sess->report.pending && !report_window_full(sess))
+            send_pending_usage_report(sess);
+    }
+
+    /*
+     * Sessions of a peer at its window wait for responses to come back,
+     * unclaimed sessions for their SMF
+     */
+    if (ogs_list_first(&self.report.pending_list))
+        ogs_timer_start(self.report.t_flush,
+                ogs_time_from_msec(UPF_REPORT_RETRY_INTERVAL));
 }
 
 void upf_sess_urr_acc_timers_setup(upf_sess_t *sess, ogs_pfcp_urr_t *urr)
 {
-    upf_sess_urr_acc_t *urr_acc = &sess->urr_acc[urr->id];
+    upf_sess_urr_acc_t *urr_acc = urr_acc_find_or_add(sess, urr);
+    ogs_time_t period = 0;
+
+    if (!urr_acc)
+        return;
+
     urr_acc->time_start = ogs_time_ntp32_now();
+
+    /* Any expiry starts a new period for all of them */
     if (urr->rep_triggers.quota_validity_time && urr->quota_validity_time > 0)
-        upf_sess_urr_acc_validity_time_setup(sess, urr);
+        period = ogs_time_from_sec(urr->quota_validity_time);
     if (urr->rep_triggers.time_quota && urr->time_quota > 0)
-        upf_sess_urr_acc_time_quota_setup(sess, urr);
+        period = period ? ogs_min(period, ogs_time_from_sec(urr->time_quota)) :
+                ogs_time_from_sec(urr->time_quota);
     if (urr->rep_triggers.time_threshold && urr->time_threshold > 0)
-        upf_sess_urr_acc_time_threshold_setup(sess, urr);
+        period = period ?
+                ogs_min(period, ogs_time_from_sec(urr->time_threshold)) :
+                ogs_time_from_sec(urr->time_threshold);
+
+    if (!period) {
+        urr_wheel_unschedule(urr_acc);
+        return;
+    }
+
+    ogs_debug("Installing URR time-based reporting [%lld sec]",
+            (long long)ogs_time_sec(period));
+    urr_acc->reporting_enabled = true;
+    urr_wheel_schedule(sess, urr_acc, period);
+}
+
+void upf_sess_urr_acc_remove(upf_sess_t *sess, ogs_pfcp_urr_id_t id)
+{
+    upf_sess_urr_acc_t *urr_acc = urr_acc_find(sess, id);
+
+    if (!urr_acc)
+        return;
+
+    urr_wheel_unschedule(urr_acc);
+    ogs_list_remove(&sess->urr_acc_list, &urr_acc->sess_node);
+    ogs_pool_free(&upf_urr_acc_pool, urr_acc);
+
+    report_pending_update(sess);
 }
 
 static void upf_sess_urr_acc_remove_all(upf_sess_t *sess)
 {
-    unsigned int i;
-    for (i = 0; i < OGS_ARRAY_SIZE(sess->urr_acc); i++) {
-        if (sess->urr_acc[i].t_time_threshold) {
-            ogs_timer_delete(sess->urr_acc[i].t_time_threshold);
-            sess->urr_acc[i].t_time_threshold = NULL;
-        }
-        if (sess->urr_acc[i].t_validity_time) {
-            ogs_timer_delete(sess->urr_acc[i].t_validity_time);
-            sess->urr_acc[i].t_validity_time = NULL;
-        }
-        if (sess->urr_acc[i].t_time_quota) {
-            ogs_timer_delete(sess->urr_acc[i].t_time_quota);
-            sess->urr_acc[i].t_time_quota = NULL;
-        }
+    ogs_lnode_t *lnode = NULL;
+
+    while ((lnode = ogs_list_first(&sess->urr_acc_list)) != NULL) {
+        upf_sess_urr_acc_t *urr_acc =
+            ogs_container_of(lnode, upf_sess_urr_acc_t, sess_node);
+        upf_sess_urr_acc_remove(sess, urr_acc->id);
+    }
+}
+
+void upf_load_start(void)
+{
+    if (self.load.interval > 0)
+        ogs_timer_start(self.load.t_update, self.load.interval);
+}
+
+void upf_load_stop(void)
+{
+    ogs_timer_stop(self.load.t_update);
+}
+
+static uint32_t next_sequence(uint32_t sequence)
+{
+    /* Zero is kept for "nothing advertised yet" */
+    return sequence + 1 ? sequence + 1 : 1;
+}
+
+/*
+ * The Load Metric is the larger of the session pool occupancy and the
+ * share of time the event loop, which also forwards the GTP-U traffic,
+ * spent busy since the last update. Above the overload threshold the
+ * SMF is asked to cut new traffic in proportion to the excess.
+ */
+static void load_update(void *data)
+{
+    ogs_pfcp_context_t *pfcp = ogs_pfcp_self();
+    ogs_prof_t *prof = ogs_pollset_prof(ogs_app()->pollset);
+    ogs_time_t now = ogs_get_monotonic_time();
+    uint64_t sessions, busy = 0;
+    uint8_t metric, reduction = 0;
+
+    sessions = (uint64_t)ogs_list_count(&self.sess_list) * 100 /
+        ogs_max(ogs_app()->pool.sess, 1);
+
+    if (prof) {
+        ogs_prof_stat_t iteration;
+
+        ogs_prof_read(&iteration, &prof->iteration);
+        if (self.load.time && now > self.load.time)
+            busy = (iteration.total - self.load.busy) /
+                ((uint64_t)(now - self.load.time) * 10);
+        self.load.busy = iteration.total;
+    }
+    self.load.time = now;
+
+    metric = ogs_min(ogs_max(sessions, busy), 100);
+    if (!pfcp->load.sequence || metric != pfcp->load.metric) {
+        pfcp->load.metric = metric;
+        pfcp->load.sequence = next_sequence(pfcp->load.sequence);
+    }
+
+    if (self.load.overload_threshold &&
+        metric >= self.load.overload_threshold)
+        reduction = ogs_max(1,
+                (metric - self.load.overload_threshold) * 100 /
+                (100 - self.load.overload_threshold));
+
+    /* Refresh the information well before the SMF lets it expire */
+    if (reduction != pfcp->overload.reduction ||
+        (reduction &&
+         now - self.load.refreshed >= self.load.overload_validity / 2)) {
+        if (!reduction != !pfcp->overload.reduction)
+            ogs_warn("%s overload [load:%d%%]",
+                    reduction ? "Entering" : "Leaving", metric);
+
+        pfcp->overload.reduction = reduction;
+        pfcp->overload.validity = reduction ? self.load.overload_validity : 0;
+        pfcp->overload.sequence = next_sequence(pfcp->overload.sequence);
+        self.load.refreshed = now;
     }
+
+    ogs_timer_start(self.load.t_update, self.load.interval);
 }
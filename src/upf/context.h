@@ -47,6 +47,17 @@ extern int __upf_log_domain;
 
 struct upf_route_trie_node;
 
+#define UPF_DEFAULT_REPORT_JITTER 2         /* seconds */
+#define UPF_DEFAULT_REPORT_WINDOW 64
+#define UPF_REPORT_RETRY_INTERVAL 100       /* msec */
+
+#define UPF_DEFAULT_LOAD_INTERVAL 1         /* seconds */
+#define UPF_DEFAULT_OVERLOAD_THRESHOLD 80   /* Load Metric */
+#define UPF_DEFAULT_OVERLOAD_VALIDITY 10    /* seconds */
+
+#define UPF_DEFAULT_CHECKPOINT_RECONCILE 60 /* seconds */
+#define UPF_CHECKPOINT_SIZE_PER_SESS 2048   /* bytes */
+
 typedef struct upf_context_s {
     ogs_hash_t *upf_n4_seid_hash;   /* hash table (UPF-N4-SEID) */
     ogs_hash_t *smf_n4_seid_hash;   /* hash table (SMF-N4-SEID) */
@@ -60,6 +71,41 @@ typedef struct upf_context_s {
     struct upf_route_trie_node *ipv6_framed_routes;
 
     ogs_list_t sess_list;
+
+    /* Time-based usage reporting */
+#define UPF_URR_WHEEL_SIZE 1024                 /* slots of one second */
+    struct {
+        ogs_timer_t *t_tick;
+        ogs_list_t slot[UPF_URR_WHEEL_SIZE];
+        unsigned int current;
+        unsigned int count;
+    } urr_wheel;
+
+    struct {
+        ogs_time_t jitter;          /* Maximum delay added to a period */
+        int window;                 /* Outstanding requests per PFCP peer */
+        ogs_list_t pending_list;    /* Sessions with usage reports to send */
+        ogs_timer_t *t_flush;
+    } report;
+
+    /* Load and Overload Control Information advertised to the SMF */
+    struct {
+        ogs_time_t interval;        /* 0: disabled */
+        int overload_threshold;     /* 0: overload control disabled */
+        ogs_time_t overload_validity;
+        ogs_timer_t *t_update;
+
+        uint64_t busy;              /* Loop busy time at the last update */
+        ogs_time_t time;            /* Time of the last update */
+        ogs_time_t refreshed;       /* Overload information last refreshed */
+    } load;
+
+    /* Session state kept across a restart, see checkpoint.c */
+    struct {
+        char *path;                 /* NULL: disabled */
+        size_t size;                /* Bytes of each of the two areas */
+        ogs_time_t reconcile;       /* Time given to the SMF to restore */
+    } checkpoint;
 } upf_context_t;
 
 /* trie mapping from IP framed routes to session. */
@@ -71,11 +117,16 @@ struct upf_route_trie_node {
 
 /* Accounting: */
 typedef struct upf_sess_urr_acc_s {
+    ogs_lnode_t lnode; /* A node of upf_self()->urr_wheel.slot[] */
+    ogs_lnode_t sess_node; /* A node of sess->urr_acc_list */
+    upf_sess_t *sess;
+    ogs_pfcp_urr_id_t id;
     bool reporting_enabled;
-    ogs_timer_t *t_validity_time; /* Quota Validity Time expiration handler */
-    ogs_timer_t *t_time_quota; /* Time Quota expiration handler */
-    ogs_timer_t *t_time_threshold; /* Time Threshold expiration handler */
-    uint32_t time_start; /* When t_time_* started */
+    bool scheduled; /* Linked into the timing wheel */
+    unsigned int slot;
+    unsigned int rounds; /* Wheel revolutions left before expiry */
+    bool report_pending; /* Included in the next Session Report Request */
+    uint32_t time_start; /* When the current report period started */
     ogs_pfcp_urr_ur_seqn_t report_seqn; /* Next seqn to use when reporting */
     uint64_t total_octets;
     uint64_t ul_octets;
@@ -83,8 +134,8 @@ typedef struct upf_sess_urr_acc_s {
     uint64_t total_pkts;
     uint64_t ul_pkts;
     uint64_t dl_pkts;
-    ogs_time_t time_of_first_packet;
-    ogs_time_t time_of_last_packet;
+    ogs_time_t time_of_first_packet; /* Monotonic */
+    ogs_time_t time_of_last_packet; /* Monotonic */
     /* Snapshot of measurement when last report was sent: */
     struct {
         uint64_t total_octets;
@@ -121,8 +172,20 @@ typedef struct upf_sess_s {
     char            *gx_sid;            /* Gx Session ID */
     ogs_pfcp_node_t *pfcp_node;
 
+    /* Restored from the checkpoint, pfcp_node is NULL until claimed */
+    bool            restored;
+    struct {
+        bool        saved;
+        size_t      offset;             /* Latest record in the checkpoint */
+    } checkpoint;
+
     /* Accounting: */
-    upf_sess_urr_acc_t urr_acc[OGS_MAX_NUM_OF_URR]; /* FIXME: This probably needs to be mved to a hashtable or alike */
+    struct {
+        ogs_lnode_t lnode; /* A node of upf_self()->report.pending_list */
+        bool pending;
+    } report;
+    /* Allocated the first time a URR is used, freed with the URR */
+    ogs_list_t      urr_acc_list;
     char            *apn_dnn;            /* APN/DNN Item */
 } upf_sess_t;
 
@@ -131,12 +194,18 @@ void upf_context_final(void);
 upf_context_t *upf_self(void);
 
 int upf_context_parse_config(void);
+int upf_context_reload_config(const char *local);
+
+void upf_load_start(void);
+void upf_load_stop(void);
 
 upf_sess_t *upf_sess_add_by_message(ogs_pfcp_message_t *message);
 
 upf_sess_t *upf_sess_add(ogs_pfcp_f_seid_t *f_seid);
 int upf_sess_remove(upf_sess_t *sess);
+void upf_sess_clear(upf_sess_t *sess);
 void upf_sess_remove_all(void);
+void upf_sess_set_smf_n4_ip(upf_sess_t *sess, ogs_ip_t *ip);
 upf_sess_t *upf_sess_find_by_smf_n4_seid(uint64_t seid);
 upf_sess_t *upf_sess_find_by_smf_n4_f_seid(ogs_pfcp_f_seid_t *f_seid);
 upf_sess_t *upf_sess_find_by_upf_n4_seid(uint64_t seid);
@@ -144,6 +213,11 @@ upf_sess_t *upf_sess_find_by_ipv4(uint32_t addr);
 upf_sess_t *upf_sess_find_by_ipv6(uint32_t *addr6);
 upf_sess_t *upf_sess_find_by_id(ogs_pool_id_t id);
 
+void upf_sess_restore_start(void);
+void upf_sess_restore_stop(void);
+upf_sess_t *upf_sess_restore(
+        ogs_pfcp_f_seid_t *cp_f_seid, uint64_t upf_n4_seid);
+
 uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
         uint8_t session_type, ogs_pfcp_pdr_t *pdr);
 uint8_t upf_sess_set_ue_ipv4_framed_routes(upf_sess_t *sess,
@@ -152,10 +226,11 @@ uint8_t upf_sess_set_ue_ipv6_framed_routes(upf_sess_t *sess,
         char *framed_routes[]);
 
 void upf_sess_urr_acc_add(upf_sess_t *sess, ogs_pfcp_urr_t *urr, size_t size, bool is_uplink);
-void upf_sess_urr_acc_fill_usage_report(upf_sess_t *sess, const ogs_pfcp_urr_t *urr,
+bool upf_sess_urr_acc_fill_usage_report(upf_sess_t *sess, const ogs_pfcp_urr_t *urr,
                                         ogs_pfcp_user_plane_report_t *report, unsigned int idx);
 void upf_sess_urr_acc_snapshot(upf_sess_t *sess, ogs_pfcp_urr_t *urr);
 void upf_sess_urr_acc_timers_setup(upf_sess_t *sess, ogs_pfcp_urr_t *urr);
+void upf_sess_urr_acc_remove(upf_sess_t *sess, ogs_pfcp_urr_id_t id);
 
 #ifdef __cplusplus
 }
@@ -51,6 +51,7 @@ void upf_event_init(void)
 
     ogs_app()->pollset = ogs_pollset_create(ogs_app()->pool.socket);
     ogs_assert(ogs_app()->pollset);
+    ogs_queue_set_notify(ogs_app()->queue, ogs_app()->pollset);
 #endif
 }
 
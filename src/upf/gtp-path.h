@@ -31,6 +31,7 @@ int upf_gtp_init(void);
 void upf_gtp_final(void);
 
 int upf_gtp_open(void);
+int upf_gtp_setup_subnet(ogs_pfcp_subnet_t *subnet);
 void upf_gtp_close(void);
 
 #ifdef __cplusplus
@@ -21,12 +21,18 @@
 #include "gtp-path.h"
 #include "pfcp-path.h"
 #include "metrics.h"
+#include "checkpoint.h"
 
 static ogs_thread_t *thread;
 static void upf_main(void *data);
 
 static int initialized = 0;
 
+static int reload_session(const char *local)
+{
+    return ogs_pfcp_context_reload_subnet(local, upf_gtp_setup_subnet);
+}
+
 int upf_initialize(void)
 {
     int rv;
@@ -60,9 +66,19 @@ int upf_initialize(void)
     rv = ogs_metrics_context_parse_config(APP_NAME);
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_app_reload_add("metrics", ogs_metrics_context_reload_config);
+    if (rv != OGS_OK) return rv;
+
     rv = upf_context_parse_config();
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_app_reload_add("session", reload_session);
+    if (rv != OGS_OK) return rv;
+    rv = ogs_app_reload_add("report", upf_context_reload_config);
+    if (rv != OGS_OK) return rv;
+    rv = ogs_app_reload_add("load", upf_context_reload_config);
+    if (rv != OGS_OK) return rv;
+
     rv = ogs_pfcp_ue_pool_generate();
     if (rv != OGS_OK) return rv;
 
@@ -74,6 +90,9 @@ int upf_initialize(void)
     rv = upf_gtp_open();
     if (rv != OGS_OK) return rv;
 
+    rv = upf_checkpoint_open();
+    if (rv != OGS_OK) return rv;
+
     thread = ogs_thread_create(upf_main, NULL);
     if (!thread) return OGS_ERROR;
 
@@ -90,6 +109,9 @@ void upf_terminate(void)
 
     ogs_thread_destroy(thread);
 
+    /* Sessions removed from here on are kept in the checkpoint */
+    upf_checkpoint_close();
+
     upf_pfcp_close();
     upf_gtp_close();
 
@@ -108,11 +130,18 @@ void upf_terminate(void)
     upf_metrics_final();
 }
 
+static const char *upf_prof_event_name(void *event)
+{
+    return upf_event_get_name(event);
+}
+
 static void upf_main(void *data)
 {
     ogs_fsm_t upf_sm;
     int rv;
 
+    ogs_prof_set_event_name(ogs_pollset_prof(ogs_app()->pollset),
+            upf_prof_event_name);
     ogs_fsm_init(&upf_sm, upf_state_initial, upf_state_final, 0);
 
     for ( ;; ) {
@@ -132,10 +161,14 @@ static void upf_main(void *data)
          */
         ogs_timer_mgr_expire(ogs_app()->timer_mgr);
 
+        /* SIGHUP asks for the configuration to be read again */
+        ogs_app_reload_check();
+
         for ( ;; ) {
-            upf_event_t *e = NULL;
+            upf_event_t *e[OGS_QUEUE_MAX_BATCH];
+            unsigned int i, num = OGS_QUEUE_MAX_BATCH;
 
-            rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
+            rv = ogs_queue_trypop_batch(ogs_app()->queue, (void**)e, &num);
             ogs_assert(rv != OGS_ERROR);
 
             if (rv == OGS_DONE)
@@ -144,9 +177,11 @@ static void upf_main(void *data)
             if (rv == OGS_RETRY)
                 break;
 
-            ogs_assert(e);
-            ogs_fsm_dispatch(&upf_sm, e);
-            upf_event_free(e);
+            for (i = 0; i < num; i++) {
+                ogs_assert(e[i]);
+                ogs_fsm_dispatch(&upf_sm, e[i]);
+                upf_event_free(e[i]);
+            }
         }
     }
 done:
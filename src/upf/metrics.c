@@ -76,12 +76,32 @@ upf_metrics_spec_def_t upf_metrics_spec_def_global[_UPF_METR_GLOB_MAX] = {
     .name = "fivegs_upffunction_sm_n4sessionreportsucc",
     .description = "Number of successful N4 session reports",
 },
+[UPF_METR_GLOB_CTR_DL_BUFFER_DROPPED] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "upf_dl_buffer_dropped",
+    .description = "Downlink packets dropped by a buffering limit",
+},
+[UPF_METR_GLOB_CTR_DL_BUFFER_EXPIRED] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "upf_dl_buffer_expired",
+    .description = "Buffered downlink packets discarded after the maximum duration",
+},
 /* Global Gauges: */
 [UPF_METR_GLOB_GAUGE_UPF_SESSIONNBR] = {
     .type = OGS_METRICS_METRIC_TYPE_GAUGE,
     .name = "fivegs_upffunction_upf_sessionnbr",
     .description = "Active Sessions",
 },
+[UPF_METR_GLOB_GAUGE_DL_BUFFER_BYTES] = {
+    .type = OGS_METRICS_METRIC_TYPE_GAUGE,
+    .name = "upf_dl_buffer_bytes",
+    .description = "Bytes of buffered downlink data",
+},
+[UPF_METR_GLOB_GAUGE_DL_BUFFER_PACKETS] = {
+    .type = OGS_METRICS_METRIC_TYPE_GAUGE,
+    .name = "upf_dl_buffer_packets",
+    .description = "Buffered downlink packets",
+},
 };
 int upf_metrics_init_inst_global(void)
 {
@@ -316,6 +336,61 @@ int upf_metrics_free_inst_by_dnn(ogs_metrics_inst_t **inst)
     return upf_metrics_free_inst(inst, _UPF_METR_BY_DNN_MAX);
 }
 
+static ogs_metrics_peer_t *upf_metrics_pfcp_peer(ogs_pfcp_node_t *node)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_assert(node);
+
+    if (!node->metrics)
+        node->metrics = ogs_metrics_peer_find_or_add(
+                OGS_ADDR(&node->addr, buf));
+
+    return node->metrics;
+}
+
+static void upf_metrics_pfcp_node_collect(ogs_pfcp_node_t *node)
+{
+    ogs_metrics_peer_xact_stats_t stats;
+
+    ogs_assert(node);
+
+    stats.local = node->xact_stats.local;
+    stats.remote = node->xact_stats.remote;
+    stats.retransmitted = node->xact_stats.retransmitted;
+    stats.duplicated = node->xact_stats.duplicated;
+
+    ogs_metrics_peer_xact_update(upf_metrics_pfcp_peer(node),
+            OGS_METRICS_PEER_XACT_PFCP, &stats);
+}
+
+/*
+ * The buffering and transaction counters live in the PFCP context and
+ * are only copied here when the metrics are scraped, keeping the data
+ * plane untouched.
+ */
+static void upf_metrics_collect(void)
+{
+    static uint64_t dropped = 0, expired = 0;
+    ogs_pfcp_context_t *pfcp = ogs_pfcp_self();
+    ogs_pfcp_node_t *node = NULL;
+
+    upf_metrics_inst_global_add(UPF_METR_GLOB_CTR_DL_BUFFER_DROPPED,
+            pfcp->buffer.dropped - dropped);
+    dropped = pfcp->buffer.dropped;
+    upf_metrics_inst_global_add(UPF_METR_GLOB_CTR_DL_BUFFER_EXPIRED,
+            pfcp->buffer.expired - expired);
+    expired = pfcp->buffer.expired;
+
+    upf_metrics_inst_global_set(UPF_METR_GLOB_GAUGE_DL_BUFFER_BYTES,
+            pfcp->buffer.bytes);
+    upf_metrics_inst_global_set(UPF_METR_GLOB_GAUGE_DL_BUFFER_PACKETS,
+            pfcp->buffer.packets);
+
+    ogs_list_for_each(&pfcp->pfcp_peer_list, node)
+        upf_metrics_pfcp_node_collect(node);
+}
+
 void upf_metrics_init(void)
 {
     ogs_metrics_context_t *ctx = ogs_metrics_self();
@@ -334,6 +409,9 @@ void upf_metrics_init(void)
     upf_metrics_init_by_qfi();
     upf_metrics_init_by_cause();
     upf_metrics_init_by_dnn();
+
+    ogs_metrics_peer_xact_init(OGS_METRICS_PEER_XACT_PFCP);
+    ctx->collect = upf_metrics_collect;
 }
 
 void upf_metrics_final(void)
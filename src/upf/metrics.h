@@ -14,7 +14,11 @@ typedef enum upf_metric_type_global_s {
     UPF_METR_GLOB_CTR_SM_N4SESSIONESTABREQ,
     UPF_METR_GLOB_CTR_SM_N4SESSIONREPORT,
     UPF_METR_GLOB_CTR_SM_N4SESSIONREPORTSUCC,
+    UPF_METR_GLOB_CTR_DL_BUFFER_DROPPED,
+    UPF_METR_GLOB_CTR_DL_BUFFER_EXPIRED,
     UPF_METR_GLOB_GAUGE_UPF_SESSIONNBR,
+    UPF_METR_GLOB_GAUGE_DL_BUFFER_BYTES,
+    UPF_METR_GLOB_GAUGE_DL_BUFFER_PACKETS,
     _UPF_METR_GLOB_MAX,
 } upf_metric_type_global_t;
 extern ogs_metrics_inst_t *upf_metrics_inst_global[_UPF_METR_GLOB_MAX];
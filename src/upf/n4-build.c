@@ -31,6 +31,8 @@ ogs_pkbuf_t *upf_n4_build_session_establishment_response(uint8_t type,
 
     ogs_pfcp_node_id_t node_id;
     ogs_pfcp_f_seid_t f_seid;
+    ogs_pfcp_fq_csid_t fq_csid;
+    char fq_csid_buf[OGS_PFCP_MAX_FQ_CSID_LEN];
     int len = 0;
 
     ogs_debug("Session Establishment Response");
@@ -60,6 +62,15 @@ ogs_pkbuf_t *upf_n4_build_session_establishment_response(uint8_t type,
     rsp->up_f_seid.data = &f_seid;
     rsp->up_f_seid.len = len;
 
+    /* PGW-U/SGW-U/UPF FQ-CSID */
+    if (sess->pfcp.csid.local &&
+        ogs_pfcp_sockaddr_to_fq_csid(
+            &fq_csid, sess->pfcp.csid.local) == OGS_OK) {
+        rsp->pgw_u_sgw_u__upf_fq_csid.presence = 1;
+        ogs_pfcp_build_fq_csid(&rsp->pgw_u_sgw_u__upf_fq_csid,
+                &fq_csid, fq_csid_buf, sizeof(fq_csid_buf));
+    }
+
     ogs_pfcp_pdrbuf_init();
 
     /* Created PDR */
@@ -69,6 +80,12 @@ ogs_pkbuf_t *upf_n4_build_session_establishment_response(uint8_t type,
         if (pdr_presence == true) j++;
     }
 
+    /* Load/Overload Control Information */
+    ogs_pfcp_build_load_control_information(
+            &rsp->load_control_information, sess->pfcp_node);
+    ogs_pfcp_build_overload_control_information(
+            &rsp->overload_control_information, sess->pfcp_node);
+
     pfcp_message->h.type = type;
     pkbuf = ogs_pfcp_build_msg(pfcp_message);
     ogs_expect(pkbuf);
@@ -111,6 +128,12 @@ ogs_pkbuf_t *upf_n4_build_session_modification_response(uint8_t type,
         if (pdr_presence == true) j++;
     }
 
+    /* Load/Overload Control Information */
+    ogs_pfcp_build_load_control_information(
+            &rsp->load_control_information, sess->pfcp_node);
+    ogs_pfcp_build_overload_control_information(
+            &rsp->overload_control_information, sess->pfcp_node);
+
     pfcp_message->h.type = type;
     pkbuf = ogs_pfcp_build_msg(pfcp_message);
     ogs_expect(pkbuf);
@@ -132,7 +155,9 @@ ogs_pkbuf_t *upf_n4_build_session_deletion_response(uint8_t type,
     memset(&report, 0, sizeof(report));
     ogs_list_for_each(&sess->pfcp.urr_list, urr) {
         ogs_assert(num_of_reports < OGS_ARRAY_SIZE(report.usage_report));
-        upf_sess_urr_acc_fill_usage_report(sess, urr, &report, num_of_reports);
+        if (upf_sess_urr_acc_fill_usage_report(
+                    sess, urr, &report, num_of_reports) == false)
+            continue;
         report.usage_report[num_of_reports].rep_trigger.termination_report = 1;
         num_of_reports++;
         upf_sess_urr_acc_snapshot(sess, urr);
@@ -140,5 +165,5 @@ ogs_pkbuf_t *upf_n4_build_session_deletion_response(uint8_t type,
     report.num_of_usage_report = num_of_reports;
 
     return ogs_pfcp_build_session_deletion_response(type, OGS_PFCP_CAUSE_REQUEST_ACCEPTED,
-                                                    &report);
+                                                    sess->pfcp_node, &report);
 }
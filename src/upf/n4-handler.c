@@ -21,6 +21,7 @@
 #include "pfcp-path.h"
 #include "gtp-path.h"
 #include "n4-handler.h"
+#include "checkpoint.h"
 
 static void upf_n4_handle_create_urr(upf_sess_t *sess, ogs_pfcp_tlv_create_urr_t *create_urr_arr,
                               uint8_t *cause_value, uint8_t *offending_ie_value)
@@ -43,40 +44,76 @@ static void upf_n4_handle_create_urr(upf_sess_t *sess, ogs_pfcp_tlv_create_urr_t
     }
 }
 
-void upf_n4_handle_session_establishment_request(
-        upf_sess_t *sess, ogs_pfcp_xact_t *xact,
+/*
+ * The CP function sends its FQ-CSID in the slot of its role, but a single
+ * FQ-CSID is always decoded into the first slot, so take the first one
+ * present.
+ */
+static void handle_fq_csid(upf_sess_t *sess,
         ogs_pfcp_session_establishment_request_t *req)
+{
+    ogs_pfcp_tlv_fq_csid_t *slot[] = {
+        &req->sgw_c_fq_csid, &req->mme_fq_csid, &req->pgw_c_smf_fq_csid,
+        &req->epdg_fq_csid, &req->twan_fq_csid,
+    };
+    ogs_pfcp_fq_csid_t fq_csid;
+    int i;
+
+    ogs_assert(sess);
+
+    /* A restored session has no PFCP node until the SMF claims it */
+    sess->pfcp.csid.local = sess->pfcp_node ? sess->pfcp_node->csid : 0;
+    sess->pfcp.csid.remote = 0;
+
+    for (i = 0; i < OGS_ARRAY_SIZE(slot); i++) {
+        if (slot[i]->presence == 0)
+            continue;
+
+        if (ogs_pfcp_parse_fq_csid(&fq_csid, slot[i]) == 0 ||
+            fq_csid.num_of_csid == 0) {
+            ogs_error("Invalid FQ-CSID");
+            return;
+        }
+
+        sess->pfcp.csid.remote = fq_csid.csid[0];
+        return;
+    }
+}
+
+void upf_n4_remove_session(upf_sess_t *sess)
+{
+    ogs_pfcp_qer_t *qer = NULL;
+
+    ogs_assert(sess);
+
+    ogs_list_for_each(&sess->pfcp.qer_list, qer) {
+        upf_metrics_inst_by_dnn_add(sess->apn_dnn,
+                UPF_METR_GAUGE_UPF_QOSFLOWS, -1);
+    }
+    upf_sess_remove(sess);
+}
+
+/*
+ * Installs the rules of a Session Establishment Request. The restore
+ * of the checkpoint replays the request it saved through here as well.
+ */
+static uint8_t install_session(upf_sess_t *sess,
+        ogs_pfcp_session_establishment_request_t *req,
+        ogs_pfcp_pdr_t **created_pdr, int *num_of_created_pdr,
+        bool *restoration_indication, uint8_t *offending_ie_value)
 {
     ogs_pfcp_pdr_t *pdr = NULL;
     ogs_pfcp_far_t *far = NULL;
-    ogs_pfcp_pdr_t *created_pdr[OGS_MAX_NUM_OF_PDR];
-    int num_of_created_pdr = 0;
     uint8_t cause_value = 0;
-    uint8_t offending_ie_value = 0;
     int i;
 
     ogs_pfcp_sereq_flags_t sereq_flags;
-    bool restoration_indication = false;
-
-    upf_metrics_inst_global_inc(UPF_METR_GLOB_CTR_SM_N4SESSIONESTABREQ);
 
-    ogs_assert(xact);
+    ogs_assert(sess);
     ogs_assert(req);
 
-    ogs_debug("Session Establishment Request");
-
     cause_value = OGS_PFCP_CAUSE_REQUEST_ACCEPTED;
 
-    if (!sess) {
-        ogs_error("No Context");
-        ogs_pfcp_send_error_message(xact, 0,
-                OGS_PFCP_SESSION_ESTABLISHMENT_RESPONSE_TYPE,
-                OGS_PFCP_CAUSE_MANDATORY_IE_MISSING, 0);
-        upf_metrics_inst_by_cause_add(OGS_PFCP_CAUSE_MANDATORY_IE_MISSING,
-                UPF_METR_CTR_SM_N4SESSIONESTABFAIL, 1);
-        return;
-    }
-
     memset(&sereq_flags, 0, sizeof(sereq_flags));
     if (req->pfcpsereq_flags.presence == 1)
         sereq_flags.value = req->pfcpsereq_flags.u8;
@@ -84,25 +121,25 @@ void upf_n4_handle_session_establishment_request(
     for (i = 0; i < OGS_MAX_NUM_OF_PDR; i++) {
         created_pdr[i] = ogs_pfcp_handle_create_pdr(&sess->pfcp,
                 &req->create_pdr[i], &sereq_flags,
-                &cause_value, &offending_ie_value);
+                &cause_value, offending_ie_value);
         if (created_pdr[i] == NULL)
             break;
     }
-    num_of_created_pdr = i;
+    *num_of_created_pdr = i;
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
-        goto cleanup;
+        return cause_value;
 
     for (i = 0; i < OGS_MAX_NUM_OF_FAR; i++) {
         if (ogs_pfcp_handle_create_far(&sess->pfcp, &req->create_far[i],
-                    &cause_value, &offending_ie_value) == NULL)
+                    &cause_value, offending_ie_value) == NULL)
             break;
     }
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
-        goto cleanup;
+        return cause_value;
 
-    upf_n4_handle_create_urr(sess, &req->create_urr[0], &cause_value, &offending_ie_value);
+    upf_n4_handle_create_urr(sess, &req->create_urr[0], &cause_value, offending_ie_value);
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
-        goto cleanup;
+        return cause_value;
 
     if (req->apn_dnn.presence) {
         char apn_dnn[OGS_MAX_DNN_LEN+1];
@@ -110,8 +147,7 @@ void upf_n4_handle_session_establishment_request(
         if (ogs_fqdn_parse(apn_dnn, req->apn_dnn.data,
             ogs_min(req->apn_dnn.len, OGS_MAX_DNN_LEN)) <= 0) {
             ogs_error("Invalid APN");
-            cause_value = OGS_PFCP_CAUSE_MANDATORY_IE_INCORRECT;
-            goto cleanup;
+            return OGS_PFCP_CAUSE_MANDATORY_IE_INCORRECT;
         }
 
         if (sess->apn_dnn)
@@ -122,43 +158,44 @@ void upf_n4_handle_session_establishment_request(
 
     for (i = 0; i < OGS_MAX_NUM_OF_QER; i++) {
         if (ogs_pfcp_handle_create_qer(&sess->pfcp, &req->create_qer[i],
-                    &cause_value, &offending_ie_value) == NULL)
+                    &cause_value, offending_ie_value) == NULL)
             break;
         upf_metrics_inst_by_dnn_add(sess->apn_dnn,
                 UPF_METR_GAUGE_UPF_QOSFLOWS, 1);
     }
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
-        goto cleanup;
+        return cause_value;
 
     ogs_pfcp_handle_create_bar(&sess->pfcp, &req->create_bar,
-                &cause_value, &offending_ie_value);
+                &cause_value, offending_ie_value);
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
-        goto cleanup;
+        return cause_value;
 
     /* Setup GTP Node */
     ogs_list_for_each(&sess->pfcp.far_list, far) {
         if (OGS_ERROR == ogs_pfcp_setup_far_gtpu_node(far)) {
             ogs_fatal("CHECK CONFIGURATION: upf.gtpu");
             ogs_fatal("ogs_pfcp_setup_far_gtpu_node() failed");
-            goto cleanup;
+            return OGS_PFCP_CAUSE_SYSTEM_FAILURE;
         }
         if (far->gnode)
             ogs_pfcp_far_f_teid_hash_set(far);
     }
 
     /* PFCPSEReq-Flags */
+    *restoration_indication = false;
     if (sereq_flags.restoration_indication == 1) {
-        for (i = 0; i < num_of_created_pdr; i++) {
+        for (i = 0; i < *num_of_created_pdr; i++) {
             pdr = created_pdr[i];
             ogs_assert(pdr);
 
             if (pdr->f_teid_len)
                 ogs_pfcp_pdr_swap_teid(pdr);
         }
-        restoration_indication = true;
+        *restoration_indication = true;
     }
 
-    for (i = 0; i < num_of_created_pdr; i++) {
+    for (i = 0; i < *num_of_created_pdr; i++) {
         pdr = created_pdr[i];
         ogs_assert(pdr);
 
@@ -167,7 +204,7 @@ void upf_n4_handle_session_establishment_request(
             if (req->pdn_type.presence == 1) {
                 cause_value = upf_sess_set_ue_ip(sess, req->pdn_type.u8, pdr);
                 if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
-                    goto cleanup;
+                    return cause_value;
             } else {
                 ogs_error("No PDN Type");
             }
@@ -178,7 +215,7 @@ void upf_n4_handle_session_establishment_request(
                 upf_sess_set_ue_ipv4_framed_routes(sess,
                         pdr->ipv4_framed_routes);
             if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
-                goto cleanup;
+                return cause_value;
         }
 
         if (pdr->ipv6_framed_routes) {
@@ -186,15 +223,71 @@ void upf_n4_handle_session_establishment_request(
                 upf_sess_set_ue_ipv6_framed_routes(sess,
                         pdr->ipv6_framed_routes);
             if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
-                goto cleanup;
+                return cause_value;
         }
 
         /* Setup UPF-N3-TEID & QFI Hash */
         if (pdr->f_teid_len)
             ogs_pfcp_object_teid_hash_set(
-                    OGS_PFCP_OBJ_SESS_TYPE, pdr, restoration_indication);
+                    OGS_PFCP_OBJ_SESS_TYPE, pdr, *restoration_indication);
     }
 
+    handle_fq_csid(sess, req);
+
+    return OGS_PFCP_CAUSE_REQUEST_ACCEPTED;
+}
+
+void upf_n4_handle_session_establishment_request(
+        upf_sess_t *sess, ogs_pfcp_xact_t *xact,
+        ogs_pfcp_session_establishment_request_t *req)
+{
+    ogs_pfcp_pdr_t *pdr = NULL;
+    ogs_pfcp_qer_t *qer = NULL;
+    ogs_pfcp_pdr_t *created_pdr[OGS_MAX_NUM_OF_PDR];
+    int num_of_created_pdr = 0;
+    uint8_t cause_value = 0;
+    uint8_t offending_ie_value = 0;
+
+    bool restoration_indication = false;
+
+    upf_metrics_inst_global_inc(UPF_METR_GLOB_CTR_SM_N4SESSIONESTABREQ);
+
+    ogs_assert(xact);
+    ogs_assert(req);
+
+    ogs_debug("Session Establishment Request");
+
+    if (!sess) {
+        ogs_error("No Context");
+        ogs_pfcp_send_error_message(xact, 0,
+                OGS_PFCP_SESSION_ESTABLISHMENT_RESPONSE_TYPE,
+                OGS_PFCP_CAUSE_MANDATORY_IE_MISSING, 0);
+        upf_metrics_inst_by_cause_add(OGS_PFCP_CAUSE_MANDATORY_IE_MISSING,
+                UPF_METR_CTR_SM_N4SESSIONESTABFAIL, 1);
+        return;
+    }
+
+    /*
+     * The SMF restores a session the UPF had restored from its checkpoint.
+     * The rules the SMF sends replace the restored ones.
+     */
+    if (sess->restored) {
+        ogs_list_for_each(&sess->pfcp.qer_list, qer) {
+            upf_metrics_inst_by_dnn_add(sess->apn_dnn,
+                    UPF_METR_GAUGE_UPF_QOSFLOWS, -1);
+        }
+        upf_sess_clear(sess);
+        sess->restored = false;
+    }
+
+    cause_value = install_session(sess, req,
+            created_pdr, &num_of_created_pdr,
+            &restoration_indication, &offending_ie_value);
+    if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
+        goto cleanup;
+
+    upf_checkpoint_update(sess);
+
     /* Send Buffered Packet to gNB/SGW */
     ogs_list_for_each(&sess->pfcp.pdr_list, pdr) {
         if (pdr->src_if == OGS_PFCP_INTERFACE_CORE) { /* Downlink */
@@ -223,6 +316,38 @@ cleanup:
             cause_value, offending_ie_value);
 }
 
+/*
+ * Installs a session saved in the checkpoint. No SMF has claimed it yet,
+ * so nothing is sent. A session that cannot be installed is removed.
+ */
+bool upf_n4_restore_session(upf_sess_t *sess,
+        ogs_pfcp_session_establishment_request_t *req)
+{
+    ogs_pfcp_pdr_t *created_pdr[OGS_MAX_NUM_OF_PDR];
+    int num_of_created_pdr = 0;
+    uint8_t cause_value = 0;
+    uint8_t offending_ie_value = 0;
+
+    bool restoration_indication = false;
+
+    ogs_assert(sess);
+    ogs_assert(req);
+
+    cause_value = install_session(sess, req,
+            created_pdr, &num_of_created_pdr,
+            &restoration_indication, &offending_ie_value);
+    if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED) {
+        ogs_error("Cannot restore F-SEID[UP:0x%lx CP:0x%lx] "
+                "[Cause:%d IE:%d]",
+                (long)sess->upf_n4_seid, (long)sess->smf_n4_f_seid.seid,
+                cause_value, offending_ie_value);
+        upf_n4_remove_session(sess);
+        return false;
+    }
+
+    return true;
+}
+
 void upf_n4_handle_session_modification_request(
         upf_sess_t *sess, ogs_pfcp_xact_t *xact,
         ogs_pfcp_session_modification_request_t *req)
@@ -336,6 +461,7 @@ void upf_n4_handle_session_modification_request(
         if (ogs_pfcp_handle_remove_urr(&sess->pfcp, &req->remove_urr[i],
                 &cause_value, &offending_ie_value) == false)
             break;
+        upf_sess_urr_acc_remove(sess, req->remove_urr[i].urr_id.u32);
     }
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
         goto cleanup;
@@ -373,6 +499,11 @@ void upf_n4_handle_session_modification_request(
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
         goto cleanup;
 
+    ogs_pfcp_handle_update_bar(&sess->pfcp, &req->update_bar,
+                &cause_value, &offending_ie_value);
+    if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
+        goto cleanup;
+
     ogs_pfcp_handle_remove_bar(&sess->pfcp, &req->remove_bar,
             &cause_value, &offending_ie_value);
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
@@ -405,6 +536,8 @@ void upf_n4_handle_session_modification_request(
         }
     }
 
+    upf_checkpoint_update(sess);
+
     if (ogs_pfcp_self()->up_function_features.ftup == 0)
         ogs_assert(OGS_OK ==
             upf_pfcp_send_session_modification_response(
@@ -417,6 +550,7 @@ void upf_n4_handle_session_modification_request(
 
 cleanup:
     ogs_pfcp_sess_clear(&sess->pfcp);
+    upf_checkpoint_update(sess);
     ogs_pfcp_send_error_message(xact, sess ? sess->smf_n4_f_seid.seid : 0,
             OGS_PFCP_SESSION_MODIFICATION_RESPONSE_TYPE,
             cause_value, offending_ie_value);
@@ -426,8 +560,6 @@ void upf_n4_handle_session_deletion_request(
         upf_sess_t *sess, ogs_pfcp_xact_t *xact,
         ogs_pfcp_session_deletion_request_t *req)
 {
-    ogs_pfcp_qer_t *qer = NULL;
-
     ogs_assert(xact);
     ogs_assert(req);
 
@@ -441,12 +573,203 @@ void upf_n4_handle_session_deletion_request(
         return;
     }
     upf_pfcp_send_session_deletion_response(xact, sess);
+    upf_n4_remove_session(sess);
+}
 
-    ogs_list_for_each(&sess->pfcp.qer_list, qer) {
-        upf_metrics_inst_by_dnn_add(sess->apn_dnn,
-                UPF_METR_GAUGE_UPF_QOSFLOWS, -1);
+/*
+ * TS 29.244 7.4.6: remove every session established by the peer with
+ * one of the CSIDs of the request.
+ */
+void upf_n4_handle_session_set_deletion_request(
+        ogs_pfcp_node_t *node, ogs_pfcp_xact_t *xact,
+        ogs_pfcp_session_set_deletion_request_t *req)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_pfcp_fq_csid_t fq_csid[OGS_PFCP_MAX_NUM_OF_FQ_CSID];
+    int num_of_fq_csid = 0, num_of_sess = 0, i;
+    ogs_time_t started;
+    uint8_t cause;
+
+    upf_sess_t *sess = NULL, *next_sess = NULL;
+
+    ogs_assert(node);
+    ogs_assert(xact);
+    ogs_assert(req);
+
+    ogs_debug("Session Set Deletion Request");
+
+    started = ogs_get_monotonic_time();
+
+    cause = ogs_pfcp_handle_session_set_deletion_request(
+            req, fq_csid, &num_of_fq_csid);
+    if (cause != OGS_PFCP_CAUSE_REQUEST_ACCEPTED) {
+        ogs_pfcp_send_error_message(xact, 0,
+                OGS_PFCP_SESSION_SET_DELETION_RESPONSE_TYPE, cause, 0);
+        return;
     }
-    upf_sess_remove(sess);
+
+    ogs_list_for_each_safe(&upf_self()->sess_list, next_sess, sess) {
+        if (node != sess->pfcp_node || sess->pfcp.csid.remote == 0)
+            continue;
+
+        for (i = 0; i < num_of_fq_csid; i++)
+            if (ogs_pfcp_fq_csid_match(&fq_csid[i], sess->pfcp.csid.remote))
+                break;
+
+        if (i < num_of_fq_csid) {
+            upf_n4_remove_session(sess);
+            num_of_sess++;
+        }
+    }
+
+    ogs_assert(OGS_OK ==
+        ogs_pfcp_send_session_set_response(xact,
+            OGS_PFCP_SESSION_SET_DELETION_RESPONSE_TYPE,
+            OGS_PFCP_CAUSE_REQUEST_ACCEPTED));
+
+    ogs_info("[%s] PFCP Session Set Deletion removed %d sessions in %lld ms",
+            OGS_ADDR(&node->addr, buf), num_of_sess,
+            (long long)ogs_time_to_msec(ogs_get_monotonic_time() - started));
+}
+
+/*
+ * 8.2.163 Alternative SMF IP Address
+ *
+ * Bit 1 of octet 5 is V6 and bit 2 is V4, followed by
+ * the IPv4 address and then the IPv6 address.
+ */
+static bool parse_alternative_smf_ip_address(
+        ogs_ip_t *ip, ogs_pfcp_tlv_alternative_smf_ip_address_t *tlv)
+{
+    unsigned char *p = tlv->data;
+    int size = 1;
+
+    memset(ip, 0, sizeof(*ip));
+
+    if (tlv->len < 1)
+        return false;
+
+    ip->ipv6 = p[0] & 0x01;
+    ip->ipv4 = (p[0] >> 1) & 0x01;
+
+    if (tlv->len != 1 + (ip->ipv4 ? OGS_IPV4_LEN : 0) +
+            (ip->ipv6 ? OGS_IPV6_LEN : 0))
+        return false;
+
+    if (ip->ipv4) {
+        memcpy(&ip->addr, p + size, OGS_IPV4_LEN);
+        size += OGS_IPV4_LEN;
+        ip->len += OGS_IPV4_LEN;
+    }
+    if (ip->ipv6) {
+        memcpy(ip->addr6, p + size, OGS_IPV6_LEN);
+        ip->len += OGS_IPV6_LEN;
+    }
+
+    return ip->ipv4 || ip->ipv6;
+}
+
+static ogs_pfcp_node_t *find_node_by_ip(ogs_ip_t *ip)
+{
+    ogs_pfcp_node_t *node = NULL;
+
+    ogs_list_for_each(&ogs_pfcp_self()->pfcp_peer_list, node) {
+        if (ip->ipv4 && node->addr.ogs_sa_family == AF_INET &&
+            node->addr.sin.sin_addr.s_addr == ip->addr)
+            return node;
+        if (ip->ipv6 && node->addr.ogs_sa_family == AF_INET6 &&
+            memcmp(node->addr.sin6.sin6_addr.s6_addr,
+                ip->addr6, OGS_IPV6_LEN) == 0)
+            return node;
+    }
+
+    return NULL;
+}
+
+/*
+ * TS 29.244 7.4.7: hand the sessions of a PDN Connection Set over
+ * to an alternative SMF of the same SMF set.
+ */
+void upf_n4_handle_session_set_modification_request(
+        ogs_pfcp_node_t *node, ogs_pfcp_xact_t *xact,
+        ogs_pfcp_session_set_modification_request_t *req)
+{
+    char buf1[OGS_ADDRSTRLEN];
+    char buf2[OGS_ADDRSTRLEN];
+
+    ogs_pfcp_tlv_pfcp_session_change_info_t *info = NULL;
+    ogs_pfcp_fq_csid_t fq_csid;
+    ogs_pfcp_node_t *alternative = NULL;
+    ogs_ip_t ip;
+    int num_of_sess = 0;
+
+    upf_sess_t *sess = NULL;
+
+    ogs_assert(node);
+    ogs_assert(xact);
+    ogs_assert(req);
+
+    ogs_debug("Session Set Modification Request");
+
+    info = &req->pfcp_session_change_info;
+    if (req->node_id.presence == 0 || info->presence == 0) {
+        ogs_error("No Node ID or PFCP Session Change Info");
+        ogs_pfcp_send_error_message(xact, 0,
+                OGS_PFCP_SESSION_SET_MODIFICATION_RESPONSE_TYPE,
+                OGS_PFCP_CAUSE_MANDATORY_IE_MISSING, 0);
+        return;
+    }
+
+    if (info->pgw_c_smf_fq_csid.presence == 0 ||
+        info->alternative_smf_pgw_c_ip_address.presence == 0) {
+        ogs_error("No FQ-CSID or Alternative SMF IP Address");
+        ogs_pfcp_send_error_message(xact, 0,
+                OGS_PFCP_SESSION_SET_MODIFICATION_RESPONSE_TYPE,
+                OGS_PFCP_CAUSE_CONDITIONAL_IE_MISSING, 0);
+        return;
+    }
+
+    if (ogs_pfcp_parse_fq_csid(&fq_csid, &info->pgw_c_smf_fq_csid) == 0 ||
+        parse_alternative_smf_ip_address(
+            &ip, &info->alternative_smf_pgw_c_ip_address) == false) {
+        ogs_error("Invalid PFCP Session Change Info");
+        ogs_pfcp_send_error_message(xact, 0,
+                OGS_PFCP_SESSION_SET_MODIFICATION_RESPONSE_TYPE,
+                OGS_PFCP_CAUSE_MANDATORY_IE_INCORRECT, 0);
+        return;
+    }
+
+    /* The alternative SMF shall have its own PFCP association */
+    alternative = find_node_by_ip(&ip);
+    if (!alternative ||
+        !OGS_FSM_CHECK(&alternative->sm, upf_pfcp_state_associated)) {
+        ogs_error("No PFCP association with the alternative SMF");
+        ogs_pfcp_send_error_message(xact, 0,
+                OGS_PFCP_SESSION_SET_MODIFICATION_RESPONSE_TYPE,
+                OGS_PFCP_CAUSE_NO_ESTABLISHED_PFCP_ASSOCIATION, 0);
+        return;
+    }
+
+    ogs_list_for_each(&upf_self()->sess_list, sess) {
+        if (node != sess->pfcp_node || sess->pfcp.csid.remote == 0 ||
+            ogs_pfcp_fq_csid_match(&fq_csid, sess->pfcp.csid.remote) == false)
+            continue;
+
+        upf_sess_set_smf_n4_ip(sess, &ip);
+        OGS_SETUP_PFCP_NODE(sess, alternative);
+        upf_checkpoint_update(sess);
+        num_of_sess++;
+    }
+
+    ogs_assert(OGS_OK ==
+        ogs_pfcp_send_session_set_response(xact,
+            OGS_PFCP_SESSION_SET_MODIFICATION_RESPONSE_TYPE,
+            OGS_PFCP_CAUSE_REQUEST_ACCEPTED));
+
+    ogs_info("[%s] PFCP Session Set Modification moved %d sessions to [%s]",
+            OGS_ADDR(&node->addr, buf1), num_of_sess,
+            OGS_ADDR(&alternative->addr, buf2));
 }
 
 void upf_n4_handle_session_report_response(
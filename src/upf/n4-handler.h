@@ -35,11 +35,21 @@ void upf_n4_handle_session_modification_request(
 void upf_n4_handle_session_deletion_request(
         upf_sess_t *sess, ogs_pfcp_xact_t *xact,
         ogs_pfcp_session_deletion_request_t *req);
+void upf_n4_handle_session_set_deletion_request(
+        ogs_pfcp_node_t *node, ogs_pfcp_xact_t *xact,
+        ogs_pfcp_session_set_deletion_request_t *req);
+void upf_n4_handle_session_set_modification_request(
+        ogs_pfcp_node_t *node, ogs_pfcp_xact_t *xact,
+        ogs_pfcp_session_set_modification_request_t *req);
 
 void upf_n4_handle_session_report_response(
         upf_sess_t *sess, ogs_pfcp_xact_t *xact,
         ogs_pfcp_session_report_response_t *rsp);
 
+bool upf_n4_restore_session(upf_sess_t *sess,
+        ogs_pfcp_session_establishment_request_t *req);
+void upf_n4_remove_session(upf_sess_t *sess);
+
 #ifdef __cplusplus
 }
 #endif
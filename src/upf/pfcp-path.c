@@ -154,6 +154,8 @@ int upf_pfcp_open(void)
 
     OGS_SETUP_PFCP_SERVER;
 
+    upf_load_start();
+
     return OGS_OK;
 }
 
@@ -161,6 +163,8 @@ void upf_pfcp_close(void)
 {
     ogs_pfcp_node_t *pfcp_node = NULL;
 
+    upf_load_stop();
+
     ogs_list_for_each(&ogs_pfcp_self()->pfcp_peer_list, pfcp_node)
         pfcp_node_fsm_fini(pfcp_node);
 
@@ -310,6 +314,17 @@ int upf_pfcp_send_session_report_request(
     ogs_assert(sess);
     ogs_assert(report);
 
+    /*
+     * A restored session has no SMF to report to until it is claimed.
+     * report_flush() keeps its usage reports pending; the event reports
+     * of the GTP-U path have nobody to go to and are dropped.
+     */
+    if (!sess->pfcp_node) {
+        ogs_debug("No PFCP node for F-SEID[UP:0x%lx CP:0x%lx]",
+                (long)sess->upf_n4_seid, (long)sess->smf_n4_f_seid.seid);
+        return OGS_OK;
+    }
+
     memset(&h, 0, sizeof(ogs_pfcp_header_t));
     h.type = OGS_PFCP_SESSION_REPORT_REQUEST_TYPE;
     h.seid = sess->smf_n4_f_seid.seid;
@@ -321,7 +336,8 @@ int upf_pfcp_send_session_report_request(
         return OGS_ERROR;
     }
 
-    n4buf = ogs_pfcp_build_session_report_request(h.type, report);
+    n4buf = ogs_pfcp_build_session_report_request(
+            h.type, sess->pfcp_node, report);
     if (!n4buf) {
         ogs_error("ogs_pfcp_build_session_report_request() failed");
         return OGS_ERROR;
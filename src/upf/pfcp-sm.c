@@ -26,6 +26,7 @@
 #include "n4-handler.h"
 
 static void pfcp_restoration(ogs_pfcp_node_t *node);
+static bool sess_owned_by(upf_sess_t *sess, ogs_pfcp_node_t *node);
 static void node_timeout(ogs_pfcp_xact_t *xact, void *data);
 
 void upf_pfcp_state_initial(ogs_fsm_t *s, upf_event_t *e)
@@ -210,6 +211,19 @@ void upf_pfcp_state_associated(ogs_fsm_t *s, upf_event_t *e)
         if (message->h.seid_presence && message->h.seid != 0)
             sess = upf_sess_find_by_upf_n4_seid(message->h.seid);
 
+        /* The SMF still using a restored session claims it */
+        if (sess && !sess->pfcp_node) {
+            if (sess_owned_by(sess, node)) {
+                OGS_SETUP_PFCP_NODE(sess, node);
+            } else {
+                ogs_error("Restored session not owned by [%s]:%d "
+                        "[UP-SEID:0x%lx]",
+                        OGS_ADDR(&node->addr, buf), OGS_PORT(&node->addr),
+                        (long)sess->upf_n4_seid);
+                sess = NULL;
+            }
+        }
+
         switch (message->h.type) {
         case OGS_PFCP_HEARTBEAT_REQUEST_TYPE:
             ogs_expect(true ==
@@ -299,6 +313,14 @@ void upf_pfcp_state_associated(ogs_fsm_t *s, upf_event_t *e)
             upf_n4_handle_session_report_response(
                 sess, xact, &message->pfcp_session_report_response);
             break;
+        case OGS_PFCP_SESSION_SET_DELETION_REQUEST_TYPE:
+            upf_n4_handle_session_set_deletion_request(
+                node, xact, &message->pfcp_session_set_deletion_request);
+            break;
+        case OGS_PFCP_SESSION_SET_MODIFICATION_REQUEST_TYPE:
+            upf_n4_handle_session_set_modification_request(
+                node, xact, &message->pfcp_session_set_modification_request);
+            break;
         default:
             ogs_error("Not implemented PFCP message type[%d]",
                     message->h.type);
@@ -350,6 +372,27 @@ void upf_pfcp_state_exception(ogs_fsm_t *s, upf_event_t *e)
     }
 }
 
+/* The F-SEID the SMF gave at establishment names the node it lives on */
+static bool sess_owned_by(upf_sess_t *sess, ogs_pfcp_node_t *node)
+{
+    ogs_ip_t *ip = NULL;
+
+    ogs_assert(sess);
+    ogs_assert(node);
+
+    ip = &sess->smf_n4_f_seid.ip;
+
+    switch (node->addr.ogs_sa_family) {
+    case AF_INET:
+        return ip->ipv4 && ip->addr == node->addr.sin.sin_addr.s_addr;
+    case AF_INET6:
+        return ip->ipv6 && memcmp(ip->addr6,
+                node->addr.sin6.sin6_addr.s6_addr, OGS_IPV6_LEN) == 0;
+    default:
+        return false;
+    }
+}
+
 static void pfcp_restoration(ogs_pfcp_node_t *node)
 {
     upf_sess_t *sess = NULL, *next = NULL;
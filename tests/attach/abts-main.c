@@ -29,6 +29,7 @@ abts_suite *test_ue_context(abts_suite *suite);
 abts_suite *test_reset(abts_suite *suite);
 abts_suite *test_issues(abts_suite *suite);
 abts_suite *test_crash(abts_suite *suite);
+abts_suite *test_bulk(abts_suite *suite);
 
 const struct testlist {
     abts_suite *(*func)(abts_suite *suite);
@@ -43,6 +44,7 @@ const struct testlist {
     {test_reset},
     {test_issues},
     {test_crash},
+    {test_bulk},
     {NULL},
 };
 
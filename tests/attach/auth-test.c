@@ -514,11 +514,128 @@ static void test1_func(abts_case *tc, void *data)
     test_ue_remove(test_ue);
 }
 
+#define NUM_OF_SQN_THREAD 4
+#define NUM_OF_SQN_INCREMENT 16
+#define NUM_OF_SQN (NUM_OF_SQN_THREAD * NUM_OF_SQN_INCREMENT)
+
+static char *sqn_supi;
+static uint64_t sqn_seen[NUM_OF_SQN];
+
+static void sqn_func(void *data)
+{
+    int i, base = OGS_POINTER_TO_UINT(data) * NUM_OF_SQN_INCREMENT;
+    ogs_dbi_auth_info_t auth_info;
+
+    for (i = 0; i < NUM_OF_SQN_INCREMENT; i++) {
+        ogs_assert(OGS_OK ==
+                ogs_dbi_auth_info_increment_sqn(sqn_supi, &auth_info));
+        sqn_seen[base + i] = auth_info.sqn;
+    }
+}
+
+static int sqn_compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void test2_func(abts_case *tc, void *data)
+{
+    ogs_nas_5gs_mobile_identity_suci_t mobile_identity_suci;
+    test_ue_t *test_ue = NULL;
+    ogs_dbi_auth_info_t auth_info;
+    ogs_thread_t *thread[NUM_OF_SQN_THREAD];
+    uint64_t start = OGS_MAX_SQN - 100, sqn;
+    bson_t *doc = NULL;
+    int i;
+
+    memset(&mobile_identity_suci, 0, sizeof(mobile_identity_suci));
+
+    mobile_identity_suci.h.supi_format = OGS_NAS_5GS_SUPI_FORMAT_IMSI;
+    mobile_identity_suci.h.type = OGS_NAS_5GS_MOBILE_IDENTITY_SUCI;
+    mobile_identity_suci.routing_indicator1 = 0;
+    mobile_identity_suci.routing_indicator2 = 0xf;
+    mobile_identity_suci.routing_indicator3 = 0xf;
+    mobile_identity_suci.routing_indicator4 = 0xf;
+    mobile_identity_suci.protection_scheme_id = OGS_PROTECTION_SCHEME_NULL;
+    mobile_identity_suci.home_network_pki_value = 0;
+
+    test_ue = test_ue_add_by_suci(&mobile_identity_suci, "3746000007");
+    ogs_assert(test_ue);
+
+    test_ue->k_string = "465b5ce8b199b49faa5f0a2ee238a6bc";
+    test_ue->opc_string = "e8ed289deba952e4283b54e88e6183ca";
+
+    /********** Insert Subscriber in Database */
+    doc = BCON_NEW(
+            "imsi", BCON_UTF8(test_ue->imsi),
+            "security", "{",
+                "k", BCON_UTF8(test_ue->k_string),
+                "opc", BCON_UTF8(test_ue->opc_string),
+                "amf", BCON_UTF8("8000"),
+                "sqn", BCON_INT64(start),
+            "}");
+    ABTS_PTR_NOTNULL(tc, doc);
+    ABTS_INT_EQUAL(tc, OGS_OK, test_db_insert_ue(test_ue, doc));
+
+    sqn_supi = ogs_msprintf("%s-%s", OGS_ID_SUPI_TYPE_IMSI, test_ue->imsi);
+    ogs_assert(sqn_supi);
+
+    /* The vector uses the SQN from before the advance */
+    ABTS_INT_EQUAL(tc, OGS_OK,
+            ogs_dbi_auth_info_increment_sqn(sqn_supi, &auth_info));
+    ABTS_TRUE(tc, auth_info.sqn == start);
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_dbi_auth_info(sqn_supi, &auth_info));
+    ABTS_TRUE(tc, auth_info.sqn == start + 32);
+
+    /* Concurrent AIRs across the 48-bit wrap each get their own SQN */
+    for (i = 0; i < NUM_OF_SQN_THREAD; i++) {
+        thread[i] = ogs_thread_create(sqn_func, OGS_UINT_TO_POINTER(i));
+        ogs_assert(thread[i]);
+    }
+    for (i = 0; i < NUM_OF_SQN_THREAD; i++)
+        ogs_thread_destroy(thread[i]);
+
+    qsort(sqn_seen, NUM_OF_SQN, sizeof(sqn_seen[0]), sqn_compare);
+    for (i = 0; i < NUM_OF_SQN; i++)
+        ABTS_TRUE(tc, sqn_seen[i] <= OGS_MAX_SQN);
+    for (i = 1; i < NUM_OF_SQN; i++)
+        ABTS_TRUE(tc, sqn_seen[i - 1] != sqn_seen[i]);
+
+    sqn = (start + 32 * (NUM_OF_SQN + 1)) & OGS_MAX_SQN;
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_dbi_auth_info(sqn_supi, &auth_info));
+    ABTS_TRUE(tc, auth_info.sqn == sqn);
+
+    /* Re-synchronization takes SQN_MS even when it is behind */
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_dbi_update_sqn(sqn_supi, 0x1000));
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_dbi_auth_info(sqn_supi, &auth_info));
+    ABTS_TRUE(tc, auth_info.sqn == 0x1000);
+
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_dbi_update_sqn(sqn_supi, 0x800));
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_dbi_auth_info(sqn_supi, &auth_info));
+    ABTS_TRUE(tc, auth_info.sqn == 0x800);
+
+    /* SQN_MS + 32 wrapped past OGS_MAX_SQN */
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_dbi_update_sqn(sqn_supi, OGS_MAX_SQN));
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_dbi_update_sqn(sqn_supi,
+                (OGS_MAX_SQN + 32) & OGS_MAX_SQN));
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_dbi_auth_info(sqn_supi, &auth_info));
+    ABTS_TRUE(tc, auth_info.sqn == 31);
+
+    ogs_free(sqn_supi);
+
+    /********** Remove Subscriber in Database */
+    ABTS_INT_EQUAL(tc, OGS_OK, test_db_remove_ue(test_ue));
+
+    test_ue_remove(test_ue);
+}
+
 abts_suite *test_auth(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
     abts_run_test(suite, test1_func, NULL);
+    abts_run_test(suite, test2_func, NULL);
 
     return suite;
 }
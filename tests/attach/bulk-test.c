@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "test-common.h"
+
+#define BULK_K1 "465b5ce8b199b49faa5f0a2ee238a6bc"
+#define BULK_K2 "00112233445566778899aabbccddeeff"
+#define BULK_OPC "e8ed289deba952e4283b54e88e6183ca"
+
+static const char *bulk_imsi[] = {
+    "999709000000001", "999709000000002",
+    "999709000000003", "999709000000004",
+};
+
+static bson_t *bulk_document(const char *imsi, const char *k)
+{
+    bson_t *doc = NULL;
+
+    if (imsi)
+        doc = BCON_NEW(
+                "imsi", BCON_UTF8(imsi),
+                "security", "{",
+                    "k", BCON_UTF8(k),
+                    "opc", BCON_UTF8(BULK_OPC),
+                    "amf", BCON_UTF8("8000"),
+                    "sqn", BCON_INT64(64),
+                "}");
+    else
+        doc = BCON_NEW(
+                "security", "{",
+                    "k", BCON_UTF8(k),
+                "}");
+    ogs_assert(doc);
+
+    return doc;
+}
+
+static void bulk_remove(void)
+{
+    bson_t *query = NULL;
+    bson_error_t error;
+    int i;
+
+    for (i = 0; i < OGS_ARRAY_SIZE(bulk_imsi); i++) {
+        query = BCON_NEW("imsi", BCON_UTF8(bulk_imsi[i]));
+        ogs_assert(query);
+        ogs_assert(mongoc_collection_remove(ogs_dbi_subscriber_collection(),
+                MONGOC_REMOVE_SINGLE_REMOVE, query, NULL, &error));
+        bson_destroy(query);
+    }
+}
+
+static void bulk_destroy(bson_t **doc, int num)
+{
+    int i;
+
+    for (i = 0; i < num; i++)
+        bson_destroy(doc[i]);
+}
+
+static bool bulk_k_equal(const char *imsi, const char *k)
+{
+    ogs_dbi_auth_info_t auth_info;
+    uint8_t expected[OGS_KEY_LEN];
+    char *supi = NULL;
+    int rv;
+
+    supi = ogs_msprintf("%s-%s", OGS_ID_SUPI_TYPE_IMSI, imsi);
+    ogs_assert(supi);
+    rv = ogs_dbi_auth_info(supi, &auth_info);
+    ogs_free(supi);
+
+    if (rv != OGS_OK)
+        return false;
+
+    ogs_hex_from_string(k, expected, sizeof(expected));
+    return memcmp(auth_info.k, expected, sizeof(expected)) == 0;
+}
+
+static void test1_func(abts_case *tc, void *data)
+{
+    ogs_dbi_bulk_csv_t csv;
+    char *field[8];
+    char line[256];
+    bson_t *doc = NULL;
+    bson_iter_t iter, child;
+    char errmsg[OGS_DBI_BULK_MAX_MESSAGE_LEN];
+    int n;
+
+    /* Quoted fields keep commas and an escaped quote */
+    strcpy(line, " a , \"b,c\" ,\"d\"\"e\",");
+    n = ogs_dbi_bulk_csv_split(line, field, OGS_ARRAY_SIZE(field));
+    ABTS_INT_EQUAL(tc, 4, n);
+    ABTS_STR_EQUAL(tc, "a", field[0]);
+    ABTS_STR_EQUAL(tc, "b,c", field[1]);
+    ABTS_STR_EQUAL(tc, "d\"e", field[2]);
+    ABTS_STR_EQUAL(tc, "", field[3]);
+
+    /* No more fields than asked for */
+    strcpy(line, "1,2,3");
+    ABTS_INT_EQUAL(tc, 2, ogs_dbi_bulk_csv_split(line, field, 2));
+
+    /* imsi, k and one of opc/op are required */
+    strcpy(line, "imsi,k,amf");
+    ABTS_INT_EQUAL(tc, OGS_ERROR, ogs_dbi_bulk_csv_header(&csv, line));
+
+    strcpy(line, "IMSI, k ,unknown,op,msisdn,sd\r\n");
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_dbi_bulk_csv_header(&csv, line));
+    ABTS_INT_EQUAL(tc, 0, csv.column[OGS_DBI_BULK_CSV_IMSI]);
+    ABTS_INT_EQUAL(tc, 1, csv.column[OGS_DBI_BULK_CSV_K]);
+    ABTS_INT_EQUAL(tc, -1, csv.column[OGS_DBI_BULK_CSV_OPC]);
+    ABTS_INT_EQUAL(tc, 3, csv.column[OGS_DBI_BULK_CSV_OP]);
+    ABTS_INT_EQUAL(tc, 4, csv.column[OGS_DBI_BULK_CSV_MSISDN]);
+    ABTS_INT_EQUAL(tc, 5, csv.column[OGS_DBI_BULK_CSV_SD]);
+
+    strcpy(line, "999700000000001," BULK_K1 ",x," BULK_OPC
+            ",\"0100;  ;0200\",0000ff");
+    doc = ogs_dbi_bulk_csv_document(&csv, line, errmsg, sizeof(errmsg));
+    ABTS_PTR_NOTNULL(tc, doc);
+    if (doc) {
+        ABTS_TRUE(tc, bson_iter_init_find(&iter, doc, "imsi"));
+        ABTS_STR_EQUAL(tc, "999700000000001", bson_iter_utf8(&iter, NULL));
+
+        /* Empty msisdn entries are skipped */
+        ABTS_TRUE(tc, bson_iter_init_find(&iter, doc, "msisdn"));
+        bson_iter_recurse(&iter, &child);
+        ABTS_TRUE(tc, bson_iter_next(&child));
+        ABTS_STR_EQUAL(tc, "0100", bson_iter_utf8(&child, NULL));
+        ABTS_TRUE(tc, bson_iter_next(&child));
+        ABTS_STR_EQUAL(tc, "0200", bson_iter_utf8(&child, NULL));
+        ABTS_TRUE(tc, !bson_iter_next(&child));
+
+        ABTS_TRUE(tc, bson_iter_init(&iter, doc));
+        ABTS_TRUE(tc, bson_iter_find_descendant(&iter, "slice.0.sd", &child));
+        ABTS_STR_EQUAL(tc, "0000ff", bson_iter_utf8(&child, NULL));
+
+        /* op is given, so opc is null and amf takes the default */
+        ABTS_TRUE(tc, bson_iter_init(&iter, doc));
+        ABTS_TRUE(tc, bson_iter_find_descendant(
+                    &iter, OGS_SECURITY_STRING "." OGS_OPC_STRING, &child));
+        ABTS_TRUE(tc, BSON_ITER_HOLDS_NULL(&child));
+        ABTS_TRUE(tc, bson_iter_init(&iter, doc));
+        ABTS_TRUE(tc, bson_iter_find_descendant(
+                    &iter, OGS_SECURITY_STRING "." OGS_AMF_STRING, &child));
+        ABTS_STR_EQUAL(tc, "8000", bson_iter_utf8(&child, NULL));
+
+        bson_destroy(doc);
+    }
+
+    strcpy(line, "999700000000001,1234,x," BULK_OPC);
+    doc = ogs_dbi_bulk_csv_document(&csv, line, errmsg, sizeof(errmsg));
+    ABTS_PTR_EQUAL(tc, NULL, doc);
+    ABTS_STR_EQUAL(tc, "Invalid k", errmsg);
+
+    strcpy(line, "," BULK_K1 ",x," BULK_OPC);
+    doc = ogs_dbi_bulk_csv_document(&csv, line, errmsg, sizeof(errmsg));
+    ABTS_PTR_EQUAL(tc, NULL, doc);
+    ABTS_STR_EQUAL(tc, "Invalid imsi", errmsg);
+}
+
+static void test2_func(abts_case *tc, void *data)
+{
+    ogs_dbi_bulk_result_t result;
+    bson_t *doc[3];
+    bson_oid_t oid;
+
+    /* Duplicates are detected by the unique imsi index */
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_dbi_subscriber_index_init());
+    bulk_remove();
+
+    /* A document without imsi fails alone */
+    doc[0] = bulk_document(bulk_imsi[0], BULK_K1);
+    doc[1] = bulk_document(NULL, BULK_K1);
+    doc[2] = bulk_document(bulk_imsi[1], BULK_K1);
+    ABTS_INT_EQUAL(tc, OGS_ERROR,
+            ogs_dbi_subscriber_bulk_write(doc, 3, false, &result));
+    ABTS_INT_EQUAL(tc, 2, result.inserted);
+    ABTS_INT_EQUAL(tc, 0, result.upserted);
+    ABTS_INT_EQUAL(tc, 0, result.matched);
+    ABTS_INT_EQUAL(tc, 1, result.failed);
+    ABTS_INT_EQUAL(tc, 1, result.num_of_error);
+    ABTS_INT_EQUAL(tc, 1, result.error[0].index);
+    ABTS_STR_EQUAL(tc, "No imsi", result.error[0].message);
+    bulk_destroy(doc, 3);
+
+    /*
+     * The duplicate is the first queued operation but the second
+     * document, and is reported at its position in the batch.
+     */
+    doc[0] = bulk_document(NULL, BULK_K1);
+    doc[1] = bulk_document(bulk_imsi[0], BULK_K1);
+    doc[2] = bulk_document(bulk_imsi[2], BULK_K1);
+    ABTS_INT_EQUAL(tc, OGS_ERROR,
+            ogs_dbi_subscriber_bulk_write(doc, 3, false, &result));
+    ABTS_INT_EQUAL(tc, 1, result.inserted);
+    ABTS_INT_EQUAL(tc, 2, result.failed);
+    ABTS_INT_EQUAL(tc, 2, result.num_of_error);
+    ABTS_INT_EQUAL(tc, 0, result.error[0].index);
+    ABTS_INT_EQUAL(tc, 1, result.error[1].index);
+    ABTS_INT_EQUAL(tc, 11000, result.error[1].code);
+    bulk_destroy(doc, 3);
+
+    /* Nothing to queue at all */
+    doc[0] = bulk_document(NULL, BULK_K1);
+    ABTS_INT_EQUAL(tc, OGS_ERROR,
+            ogs_dbi_subscriber_bulk_write(doc, 1, true, &result));
+    ABTS_INT_EQUAL(tc, 1, result.failed);
+    ABTS_INT_EQUAL(tc, 1, result.num_of_error);
+    bulk_destroy(doc, 1);
+
+    /*
+     * Upsert replaces an existing subscriber even if the document
+     * carries another _id, e.g. from an export of another database.
+     */
+    doc[0] = bulk_document(bulk_imsi[0], BULK_K2);
+    bson_oid_init(&oid, NULL);
+    BSON_APPEND_OID(doc[0], "_id", &oid);
+    doc[1] = bulk_document(bulk_imsi[3], BULK_K2);
+    ABTS_INT_EQUAL(tc, OGS_OK,
+            ogs_dbi_subscriber_bulk_write(doc, 2, true, &result));
+    ABTS_INT_EQUAL(tc, 0, result.inserted);
+    ABTS_INT_EQUAL(tc, 1, result.upserted);
+    ABTS_INT_EQUAL(tc, 1, result.matched);
+    ABTS_INT_EQUAL(tc, 0, result.failed);
+    ABTS_INT_EQUAL(tc, 0, result.num_of_error);
+    bulk_destroy(doc, 2);
+
+    ABTS_TRUE(tc, bulk_k_equal(bulk_imsi[0], BULK_K2));
+    ABTS_TRUE(tc, bulk_k_equal(bulk_imsi[1], BULK_K1));
+    ABTS_TRUE(tc, bulk_k_equal(bulk_imsi[2], BULK_K1));
+    ABTS_TRUE(tc, bulk_k_equal(bulk_imsi[3], BULK_K2));
+
+    bulk_remove();
+}
+
+abts_suite *test_bulk(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, test1_func, NULL);
+    abts_run_test(suite, test2_func, NULL);
+
+    return suite;
+}
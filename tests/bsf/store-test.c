@@ -0,0 +1,383 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "bsf/binding-store.h"
+#include "core/abts.h"
+
+static uint8_t record[BSF_BINDING_RECORD_MAX_LEN];
+
+static bsf_sess_t *sess_add(char *ipv4addr)
+{
+    bsf_sess_t *sess = bsf_sess_add_by_ip_address(ipv4addr, NULL);
+    ogs_assert(sess);
+
+    sess->dnn = ogs_strdup("internet");
+    ogs_assert(sess->dnn);
+
+    return sess;
+}
+
+/* A binding that only exists as the source of a record */
+static size_t record_build(uint8_t op, char *binding_id, char *ipv4addr,
+        uint64_t generation, uint32_t origin)
+{
+    bsf_sess_t sess;
+
+    memset(&sess, 0, sizeof(sess));
+    sess.binding_id = binding_id;
+    sess.ipv4addr_string = ipv4addr;
+    sess.dnn = (char *)"internet";
+    sess.stamp.generation = generation;
+    sess.stamp.origin = origin;
+
+    return bsf_binding_record_build(op, &sess, record, sizeof(record));
+}
+
+/* A binding survives the round trip through a record */
+static void store_test1(abts_case *tc, void *data)
+{
+    bsf_sess_t *sess = NULL;
+    char *binding_id = NULL;
+    size_t len, record_len;
+
+    sess = sess_add((char *)"10.45.0.1");
+    sess->supi = ogs_strdup("imsi-999700000000001");
+    sess->s_nssai.sst = 1;
+    sess->s_nssai.sd.v = 0x010203;
+    sess->pcf_fqdn = ogs_strdup("pcf.localdomain");
+    sess->num_of_pcf_ip = 1;
+    sess->pcf_ip[0].addr = ogs_strdup("127.0.0.13");
+    sess->pcf_ip[0].is_port = true;
+    sess->pcf_ip[0].port = 7777;
+    sess->ipv4_frame_route_list = OpenAPI_list_create();
+    OpenAPI_list_add(sess->ipv4_frame_route_list, ogs_strdup("10.46.0.0/16"));
+    sess->stamp.generation = 5;
+    sess->stamp.origin = 7;
+
+    binding_id = ogs_strdup(sess->binding_id);
+
+    len = bsf_binding_record_build(BSF_BINDING_RECORD_PUT,
+            sess, record, sizeof(record));
+    ABTS_TRUE(tc, len > BSF_BINDING_RECORD_HEADER_LEN);
+    ABTS_INT_EQUAL(tc, 0, bsf_binding_record_build(
+                BSF_BINDING_RECORD_PUT, sess, record, 16));
+
+    /* Incomplete, complete and corrupted */
+    len = bsf_binding_record_build(BSF_BINDING_RECORD_PUT,
+            sess, record, sizeof(record));
+    ABTS_INT_EQUAL(tc, 0, bsf_binding_record_parse(record, 4, &record_len));
+    ABTS_INT_EQUAL(tc, 0,
+            bsf_binding_record_parse(record, len - 1, &record_len));
+    ABTS_INT_EQUAL(tc, 1, bsf_binding_record_parse(record, len, &record_len));
+    ABTS_INT_EQUAL(tc, len, record_len);
+    record[len - 1] ^= 0xff;
+    ABTS_INT_EQUAL(tc, -1, bsf_binding_record_parse(record, len, &record_len));
+    record[len - 1] ^= 0xff;
+
+    bsf_sess_remove(sess);
+    ABTS_PTR_EQUAL(tc, NULL, bsf_sess_find_by_binding_id(binding_id));
+
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_apply(record, len));
+    sess = bsf_sess_find_by_binding_id(binding_id);
+    ABTS_PTR_NOTNULL(tc, sess);
+    ABTS_PTR_EQUAL(tc, sess, bsf_sess_find_by_ipv4addr((char *)"10.45.0.1"));
+    ABTS_STR_EQUAL(tc, "imsi-999700000000001", sess->supi);
+    ABTS_STR_EQUAL(tc, "internet", sess->dnn);
+    ABTS_INT_EQUAL(tc, 1, sess->s_nssai.sst);
+    ABTS_INT_EQUAL(tc, 0x010203, sess->s_nssai.sd.v);
+    ABTS_STR_EQUAL(tc, "pcf.localdomain", sess->pcf_fqdn);
+    ABTS_INT_EQUAL(tc, 1, sess->num_of_pcf_ip);
+    ABTS_STR_EQUAL(tc, "127.0.0.13", sess->pcf_ip[0].addr);
+    ABTS_INT_EQUAL(tc, 7777, sess->pcf_ip[0].port);
+    ABTS_PTR_NOTNULL(tc, sess->ipv4_frame_route_list);
+    ABTS_INT_EQUAL(tc, 1, sess->ipv4_frame_route_list->count);
+    ABTS_TRUE(tc, sess->stamp.generation == 5);
+    ABTS_INT_EQUAL(tc, 7, sess->stamp.origin);
+
+    /* The same record again changes nothing */
+    ABTS_INT_EQUAL(tc, OGS_DONE, bsf_binding_store_apply(record, len));
+    ABTS_PTR_EQUAL(tc, sess, bsf_sess_find_by_binding_id(binding_id));
+
+    bsf_sess_remove(sess);
+    ogs_free(binding_id);
+}
+
+/* Conflicting records resolve by stamp, whatever the order */
+static void store_test2(abts_case *tc, void *data)
+{
+    bsf_sess_t *sess = NULL;
+    size_t len;
+
+    len = record_build(BSF_BINDING_RECORD_PUT,
+            (char *)"a", (char *)"10.45.0.1", 5, 7);
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_apply(record, len));
+
+    /* The same UE address from another instance */
+    len = record_build(BSF_BINDING_RECORD_PUT,
+            (char *)"b", (char *)"10.45.0.1", 4, 9);
+    ABTS_INT_EQUAL(tc, OGS_DONE, bsf_binding_store_apply(record, len));
+    len = record_build(BSF_BINDING_RECORD_PUT,
+            (char *)"b", (char *)"10.45.0.1", 5, 6);
+    ABTS_INT_EQUAL(tc, OGS_DONE, bsf_binding_store_apply(record, len));
+    sess = bsf_sess_find_by_ipv4addr((char *)"10.45.0.1");
+    ABTS_PTR_NOTNULL(tc, sess);
+    ABTS_STR_EQUAL(tc, "a", sess->binding_id);
+
+    /* The origin breaks a tie */
+    len = record_build(BSF_BINDING_RECORD_PUT,
+            (char *)"b", (char *)"10.45.0.1", 5, 8);
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_apply(record, len));
+    sess = bsf_sess_find_by_ipv4addr((char *)"10.45.0.1");
+    ABTS_PTR_NOTNULL(tc, sess);
+    ABTS_STR_EQUAL(tc, "b", sess->binding_id);
+    ABTS_PTR_EQUAL(tc, NULL, bsf_sess_find_by_binding_id((char *)"a"));
+
+    /* A delete older than the binding is dropped */
+    len = record_build(BSF_BINDING_RECORD_DEL, (char *)"b", NULL, 4, 9);
+    ABTS_INT_EQUAL(tc, OGS_DONE, bsf_binding_store_apply(record, len));
+    ABTS_PTR_NOTNULL(tc, bsf_sess_find_by_binding_id((char *)"b"));
+    len = record_build(BSF_BINDING_RECORD_DEL, (char *)"b", NULL, 6, 1);
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_apply(record, len));
+    ABTS_PTR_EQUAL(tc, NULL, bsf_sess_find_by_binding_id((char *)"b"));
+
+    /* A binding needs a UE address */
+    len = record_build(BSF_BINDING_RECORD_PUT, (char *)"c", NULL, 7, 1);
+    ABTS_INT_EQUAL(tc, OGS_ERROR, bsf_binding_store_apply(record, len));
+
+    ABTS_INT_EQUAL(tc, 0, ogs_list_count(&bsf_self()->sess_list));
+}
+
+static bool file_exists(const char *dir, const char *name)
+{
+    char path[OGS_MAX_FILEPATH_LEN];
+    struct stat st;
+
+    ogs_snprintf(path, sizeof(path), "%s/%s", dir, name);
+    return stat(path, &st) == 0;
+}
+
+static void dir_remove(const char *dir)
+{
+    char path[OGS_MAX_FILEPATH_LEN];
+    DIR *d = NULL;
+    struct dirent *entry = NULL;
+
+    d = opendir(dir);
+    ogs_assert(d);
+    while ((entry = readdir(d))) {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+            continue;
+        ogs_snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        unlink(path);
+    }
+    closedir(d);
+    rmdir(dir);
+}
+
+/* Bindings are restored from the logs and the snapshot */
+static void store_test3(abts_case *tc, void *data)
+{
+    char dir[] = "/tmp/bsf-store-XXXXXX";
+    char path[OGS_MAX_FILEPATH_LEN];
+    char *binding_id[3];
+    bsf_sess_t *sess[3], *restored = NULL;
+    size_t len;
+    FILE *fp = NULL;
+    int i;
+
+    ABTS_PTR_NOTNULL(tc, mkdtemp(dir));
+
+    bsf_self()->store.path = ogs_strdup(dir);
+    bsf_self()->store.flush_interval = ogs_time_from_msec(1);
+    bsf_self()->store.snapshot_threshold = 0;
+
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_open());
+
+    sess[0] = sess_add((char *)"10.45.0.1");
+    sess[1] = sess_add((char *)"10.45.0.2");
+    sess[2] = sess_add((char *)"10.45.0.3");
+    for (i = 0; i < 3; i++) {
+        bsf_binding_store_put(sess[i]);
+        binding_id[i] = ogs_strdup(sess[i]->binding_id);
+    }
+    bsf_binding_store_del(sess[1]);
+    bsf_sess_remove(sess[1]);
+
+    bsf_binding_store_close();
+    bsf_sess_remove_all();
+
+    /* The log ends in half a record, as if the BSF stopped mid-write */
+    len = record_build(BSF_BINDING_RECORD_PUT,
+            (char *)"torn", (char *)"10.45.0.9", 100, 1);
+    ogs_snprintf(path, sizeof(path), "%s/binding.0.log", dir);
+    fp = fopen(path, "a");
+    ABTS_PTR_NOTNULL(tc, fp);
+    ABTS_INT_EQUAL(tc, 1, fwrite(record, len / 2, 1, fp));
+    fclose(fp);
+
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_open());
+    ABTS_INT_EQUAL(tc, 2, ogs_list_count(&bsf_self()->sess_list));
+    ABTS_PTR_NOTNULL(tc, bsf_sess_find_by_binding_id(binding_id[0]));
+    ABTS_PTR_EQUAL(tc, NULL, bsf_sess_find_by_binding_id(binding_id[1]));
+    restored = bsf_sess_find_by_binding_id(binding_id[2]);
+    ABTS_PTR_NOTNULL(tc, restored);
+    ABTS_PTR_EQUAL(tc, NULL, bsf_sess_find_by_ipv4addr((char *)"10.45.0.9"));
+
+    /* New local stamps stay ahead of the restored ones */
+    sess[1] = sess_add((char *)"10.45.0.4");
+    bsf_binding_store_put(sess[1]);
+    ABTS_TRUE(tc, sess[1]->stamp.generation > restored->stamp.generation);
+
+    /* The next flush starts a snapshot, which replaces the logs */
+    bsf_self()->store.snapshot_threshold = 1;
+    ogs_msleep(5);
+    ogs_timer_mgr_expire(ogs_app()->timer_mgr);
+    bsf_binding_store_close();
+
+    ABTS_TRUE(tc, file_exists(dir, "binding.snapshot"));
+    ABTS_TRUE(tc, !file_exists(dir, "binding.0.log"));
+
+    bsf_sess_remove_all();
+
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_open());
+    ABTS_INT_EQUAL(tc, 3, ogs_list_count(&bsf_self()->sess_list));
+    ABTS_PTR_NOTNULL(tc, bsf_sess_find_by_binding_id(binding_id[0]));
+    ABTS_PTR_NOTNULL(tc, bsf_sess_find_by_binding_id(binding_id[2]));
+    ABTS_PTR_NOTNULL(tc, bsf_sess_find_by_ipv4addr((char *)"10.45.0.4"));
+    bsf_binding_store_close();
+
+    bsf_sess_remove_all();
+    for (i = 0; i < 3; i++)
+        ogs_free(binding_id[i]);
+
+    dir_remove(dir);
+    ogs_free(bsf_self()->store.path);
+    bsf_self()->store.path = NULL;
+}
+
+/* A deleted binding leaves a tombstone while replicating */
+static void store_test4(abts_case *tc, void *data)
+{
+    char dir[] = "/tmp/bsf-store-XXXXXX";
+    bsf_binding_tombstone_t *tombstone = NULL;
+    bsf_sess_t *sess = NULL;
+    char *binding_id = NULL;
+    size_t len;
+
+    ABTS_PTR_NOTNULL(tc, mkdtemp(dir));
+
+    bsf_self()->store.path = ogs_strdup(dir);
+    bsf_self()->store.flush_interval = ogs_time_from_msec(1);
+    bsf_self()->store.snapshot_threshold = 0;
+    bsf_self()->replication.num_of_peer = 1;
+    bsf_self()->replication.tombstone_retention = ogs_time_from_sec(60);
+
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_open());
+
+    len = record_build(BSF_BINDING_RECORD_PUT,
+            (char *)"a", (char *)"10.45.0.1", 5, 7);
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_apply(record, len));
+    len = record_build(BSF_BINDING_RECORD_DEL, (char *)"a", NULL, 6, 1);
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_apply(record, len));
+    ABTS_PTR_EQUAL(tc, NULL, bsf_sess_find_by_binding_id((char *)"a"));
+
+    /* A peer that missed the delete cannot bring the binding back */
+    len = record_build(BSF_BINDING_RECORD_PUT,
+            (char *)"a", (char *)"10.45.0.1", 5, 7);
+    ABTS_INT_EQUAL(tc, OGS_DONE, bsf_binding_store_apply(record, len));
+    ABTS_PTR_EQUAL(tc, NULL, bsf_sess_find_by_binding_id((char *)"a"));
+    len = record_build(BSF_BINDING_RECORD_DEL, (char *)"a", NULL, 6, 1);
+    ABTS_INT_EQUAL(tc, OGS_DONE, bsf_binding_store_apply(record, len));
+
+    /* A delete arriving first is remembered too */
+    len = record_build(BSF_BINDING_RECORD_DEL, (char *)"b", NULL, 3, 1);
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_apply(record, len));
+    len = record_build(BSF_BINDING_RECORD_PUT,
+            (char *)"b", (char *)"10.45.0.2", 2, 1);
+    ABTS_INT_EQUAL(tc, OGS_DONE, bsf_binding_store_apply(record, len));
+    len = record_build(BSF_BINDING_RECORD_PUT,
+            (char *)"b", (char *)"10.45.0.2", 4, 1);
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_apply(record, len));
+    ABTS_PTR_NOTNULL(tc, bsf_sess_find_by_binding_id((char *)"b"));
+
+    /* A local delete, whose tombstone is sent to the peers */
+    sess = sess_add((char *)"10.45.0.3");
+    bsf_binding_store_put(sess);
+    binding_id = ogs_strdup(sess->binding_id);
+    bsf_binding_store_del(sess);
+    bsf_sess_remove(sess);
+
+    ABTS_INT_EQUAL(tc, 2, ogs_list_count(bsf_binding_tombstone_list()));
+    tombstone = ogs_list_last(bsf_binding_tombstone_list());
+    ABTS_STR_EQUAL(tc, binding_id, tombstone->binding_id);
+    len = bsf_binding_tombstone_record_build(
+            tombstone, record, sizeof(record));
+    ABTS_INT_EQUAL(tc, BSF_BINDING_RECORD_DEL,
+            record[BSF_BINDING_RECORD_HEADER_LEN]);
+
+    /* Tombstones survive a restart, through the snapshot */
+    bsf_self()->store.snapshot_threshold = 1;
+    ogs_msleep(5);
+    ogs_timer_mgr_expire(ogs_app()->timer_mgr);
+    bsf_binding_store_close();
+    bsf_sess_remove_all();
+    ABTS_TRUE(tc, file_exists(dir, "binding.snapshot"));
+    ABTS_TRUE(tc, !file_exists(dir, "binding.0.log"));
+
+    bsf_self()->store.snapshot_threshold = 0;
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_open());
+    ABTS_INT_EQUAL(tc, 1, ogs_list_count(&bsf_self()->sess_list));
+    ABTS_INT_EQUAL(tc, 2, ogs_list_count(bsf_binding_tombstone_list()));
+    len = record_build(BSF_BINDING_RECORD_PUT,
+            (char *)"a", (char *)"10.45.0.1", 5, 7);
+    ABTS_INT_EQUAL(tc, OGS_DONE, bsf_binding_store_apply(record, len));
+
+    /* and expire after the retention */
+    bsf_self()->replication.tombstone_retention = ogs_time_from_msec(1);
+    ogs_msleep(5);
+    ogs_timer_mgr_expire(ogs_app()->timer_mgr);
+    ABTS_INT_EQUAL(tc, 0, ogs_list_count(bsf_binding_tombstone_list()));
+    ABTS_INT_EQUAL(tc, OGS_OK, bsf_binding_store_apply(record, len));
+
+    bsf_binding_store_close();
+    bsf_sess_remove_all();
+    ogs_free(binding_id);
+
+    bsf_self()->replication.num_of_peer = 0;
+    bsf_self()->replication.tombstone_retention = 0;
+
+    dir_remove(dir);
+    ogs_free(bsf_self()->store.path);
+    bsf_self()->store.path = NULL;
+}
+
+abts_suite *test_store(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, store_test1, NULL);
+    abts_run_test(suite, store_test2, NULL);
+    abts_run_test(suite, store_test3, NULL);
+    abts_run_test(suite, store_test4, NULL);
+
+    return suite;
+}
@@ -34,6 +34,7 @@ abts_suite *test_thread(abts_suite *suite);
 abts_suite *test_socket(abts_suite *suite);
 abts_suite *test_queue(abts_suite *suite);
 abts_suite *test_poll(abts_suite *suite);
+abts_suite *test_prof(abts_suite *suite);
 abts_suite *test_tlv(abts_suite *suite);
 abts_suite *test_fsm(abts_suite *suite);
 abts_suite *test_hash(abts_suite *suite);
@@ -56,6 +57,7 @@ const struct testlist {
     {test_socket},
     {test_queue},
     {test_poll},
+    {test_prof},
     {test_tlv},
     {test_fsm},
     {test_hash},
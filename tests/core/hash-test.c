@@ -386,6 +386,42 @@ static void hash_count_5(abts_case *tc, void *data)
     ogs_hash_destroy(h);
 }
 
+static void hash_stat_test(abts_case *tc, void *data)
+{
+    ogs_hash_t *h = NULL;
+    ogs_hash_stat_t stat;
+
+    h = ogs_hash_make();
+    ABTS_PTR_NOTNULL(tc, h);
+
+    /* Only named hashes keep statistics */
+    ogs_hash_set(h, "key1", OGS_HASH_KEY_STRING, "value1");
+    ogs_hash_get(h, "key1", OGS_HASH_KEY_STRING);
+    ogs_hash_stat(h, &stat);
+    ABTS_PTR_EQUAL(tc, NULL, stat.name);
+    ABTS_INT_EQUAL(tc, 0, stat.lookups);
+
+    ogs_hash_set_name(h, "test");
+    ogs_hash_set(h, "key2", OGS_HASH_KEY_STRING, "value2");
+    ABTS_STR_EQUAL(tc, "value1", ogs_hash_get(h, "key1", OGS_HASH_KEY_STRING));
+    ABTS_PTR_EQUAL(tc, NULL, ogs_hash_get(h, "key3", OGS_HASH_KEY_STRING));
+
+    /* Setting the same value again is not a replacement */
+    ogs_hash_set(h, "key2", OGS_HASH_KEY_STRING, "value2");
+    ogs_hash_set(h, "key2", OGS_HASH_KEY_STRING, "value3");
+
+    ogs_hash_stat(h, &stat);
+    ABTS_STR_EQUAL(tc, "test", stat.name);
+    ABTS_INT_EQUAL(tc, 2, stat.count);
+    ABTS_INT_EQUAL(tc, 16, stat.buckets);
+    ABTS_INT_EQUAL(tc, 2, stat.lookups);
+    ABTS_INT_EQUAL(tc, 1, stat.hits);
+    ABTS_TRUE(tc, stat.probes >= 3);
+    ABTS_INT_EQUAL(tc, 1, stat.replaced);
+
+    ogs_hash_destroy(h);
+}
+
 abts_suite *test_hash(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -406,6 +442,7 @@ abts_suite *test_hash(abts_suite *suite)
     abts_run_test(suite, hash_clear_test, NULL);
     abts_run_test(suite, hash_traverse, NULL);
     abts_run_test(suite, summation_test, NULL);
+    abts_run_test(suite, hash_stat_test, NULL);
 
     return suite;
 }
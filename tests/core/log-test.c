@@ -103,11 +103,137 @@ static void test_basic(abts_case *tc, void *data)
 #endif
 }
 
+#if !defined(_WIN32)
+#define ASYNC_NUM_OF_RECORD 1000
+
+static void async_func(void *data)
+{
+    int i;
+
+    for (i = 0; i < ASYNC_NUM_OF_RECORD; i++)
+        ogs_info("async worker record %d", i);
+}
+
+#define ASYNC_NUM_OF_THREAD 64
+
+static void async_exit_func(void *data)
+{
+    ogs_info("async exiting thread record");
+}
+
+static int count_lines(const char *path)
+{
+    FILE *fp;
+    int c, lines = 0;
+
+    fp = fopen(path, "r");
+    if (!fp)
+        return -1;
+    while ((c = fgetc(fp)) != EOF)
+        if (c == '\n')
+            lines++;
+    fclose(fp);
+
+    return lines;
+}
+
+static void test_async(abts_case *tc, void *data)
+{
+    int i, rv, fd, saved_stderr, lines;
+    int core_id = ogs_log_get_domain_id("core");
+    ogs_log_level_e core_level = ogs_log_get_domain_level(core_id);
+    char path[] = "/tmp/ogs-log-test-XXXXXX";
+    FILE *null = NULL;
+    ogs_log_t *log = NULL;
+    ogs_thread_t *thread = NULL;
+    ogs_log_async_stats_t stats;
+
+    fd = mkstemp(path);
+    ABTS_TRUE(tc, fd >= 0);
+    close(fd);
+
+    /* Keep the records off the test output */
+    fflush(stderr);
+    saved_stderr = dup(STDERR_FILENO);
+    ABTS_TRUE(tc, saved_stderr >= 0);
+    null = fopen("/dev/null", "w");
+    ABTS_PTR_NOTNULL(tc, null);
+    dup2(fileno(null), STDERR_FILENO);
+    fclose(null);
+
+    log = ogs_log_add_file(path);
+    ABTS_PTR_NOTNULL(tc, log);
+    ogs_log_set_domain_level(core_id, OGS_LOG_INFO);
+
+    /* Nothing is dropped below DEBUG */
+    rv = ogs_log_async_start(0, OGS_LOG_DEBUG);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_TRUE(tc, ogs_log_async_is_running());
+    lines = count_lines(path);
+
+    thread = ogs_thread_create(async_func, NULL);
+    ABTS_PTR_NOTNULL(tc, thread);
+    for (i = 0; i < ASYNC_NUM_OF_RECORD; i++)
+        ogs_info("async main record %d", i);
+    ogs_debug("filtered out");
+    ogs_thread_destroy(thread);
+
+    /* The ring of an exited thread is freed once it is drained */
+    for (i = 0; i < ASYNC_NUM_OF_THREAD; i++) {
+        thread = ogs_thread_create(async_exit_func, NULL);
+        ABTS_PTR_NOTNULL(tc, thread);
+        ogs_thread_destroy(thread);
+    }
+    for (i = 0; i < 50; i++) {
+        ogs_log_async_get_stats(&stats);
+        if (stats.rings <= 1)
+            break;
+        ogs_msleep(20);
+    }
+    ABTS_INT_EQUAL(tc, 1, stats.rings);
+
+    ogs_log_async_stop();
+    ABTS_TRUE(tc, !ogs_log_async_is_running());
+
+    ogs_log_async_get_stats(&stats);
+    ABTS_INT_EQUAL(tc, 0, stats.dropped);
+    ABTS_INT_EQUAL(tc, 2 * ASYNC_NUM_OF_RECORD + ASYNC_NUM_OF_THREAD,
+            stats.written + stats.overflow);
+    ABTS_INT_EQUAL(tc, 2 * ASYNC_NUM_OF_RECORD + ASYNC_NUM_OF_THREAD,
+            count_lines(path) - lines);
+
+    /* INFO records may be dropped on a full ring */
+    rv = ogs_log_async_start(0, OGS_LOG_INFO);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    lines = count_lines(path);
+    for (i = 0; i < ASYNC_NUM_OF_RECORD * 10; i++)
+        ogs_info("async drop record %d", i);
+    ogs_warn("async warn record");
+    ogs_log_async_stop();
+
+    ogs_log_async_get_stats(&stats);
+    ABTS_TRUE(tc, stats.written + stats.dropped + stats.overflow >=
+            ASYNC_NUM_OF_RECORD * 10 + 1);
+    ABTS_INT_EQUAL(tc, stats.written + stats.overflow,
+            count_lines(path) - lines);
+
+    ogs_log_set_domain_level(core_id, core_level);
+    ogs_log_remove(log);
+    unlink(path);
+
+    dup2(saved_stderr, STDERR_FILENO);
+    close(saved_stderr);
+}
+#endif
+
 abts_suite *test_log(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
     abts_run_test(suite, test_basic, NULL);
+#if !defined(_WIN32)
+    abts_run_test(suite, test_async, NULL);
+#endif
 
     return suite;
 }
@@ -657,6 +657,91 @@ static void test8_func(abts_case *tc, void *data)
     ogs_pollset_destroy(pollset);
 }
 
+#define TEST9_NUM 300
+static int test9_received;
+
+static void test9_handler(ogs_socket_t fd,
+        ogs_pkbuf_t *pkbuf, ogs_sockaddr_t *from, void *data)
+{
+    abts_case *tc = data;
+    char buf[OGS_ADDRSTRLEN];
+
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    ABTS_INT_EQUAL(tc, strlen(DATASTR) + 1, pkbuf->len);
+    ABTS_INT_EQUAL(tc, test9_received % 256,
+            ((uint8_t *)pkbuf->data)[strlen(DATASTR)]);
+    ABTS_TRUE(tc, memcmp(pkbuf->data, DATASTR, strlen(DATASTR)) == 0);
+    ABTS_TRUE(tc, ogs_pkbuf_headroom(pkbuf) >= 16);
+    ABTS_STR_EQUAL(tc, "127.0.0.1", OGS_ADDR(from, buf));
+
+    /* Headroom must be usable, e.g. for pushing a tunnel header */
+    ogs_pkbuf_push(pkbuf, 16);
+    ogs_pkbuf_pull(pkbuf, 16);
+
+    ogs_pkbuf_free(pkbuf);
+
+    test9_received++;
+}
+
+static void test9_func(abts_case *tc, void *data)
+{
+    int rv, i;
+    ssize_t size;
+    ogs_sock_t *udp, *client;
+    ogs_sockaddr_t *addr;
+    ogs_poll_t *poll;
+    char str[sizeof(DATASTR)];
+    ogs_pollset_t *pollset = ogs_pollset_create(512);
+    ABTS_PTR_NOTNULL(tc, pollset);
+
+    rv = ogs_getaddrinfo(&addr, AF_INET, "127.0.0.1", PORT, AI_PASSIVE);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    udp = ogs_udp_server(addr, NULL);
+    ABTS_PTR_NOTNULL(tc, udp);
+    client = ogs_udp_client(addr, NULL);
+    ABTS_PTR_NOTNULL(tc, client);
+
+    poll = ogs_pollset_add_recv(pollset, udp->fd,
+            NULL, OGS_MAX_PKT_LEN, 16, test9_handler, tc);
+    ABTS_PTR_NOTNULL(tc, poll);
+
+    /* More datagrams than buffers provided to the kernel at once */
+    memcpy(str, DATASTR, strlen(DATASTR));
+    test9_received = 0;
+    for (i = 0; i < TEST9_NUM; i++) {
+        str[strlen(DATASTR)] = i % 256;
+        size = ogs_send(client->fd, str, strlen(DATASTR) + 1, 0);
+        ABTS_INT_EQUAL(tc, strlen(DATASTR) + 1, size);
+
+        if ((i % 100) == 99) {
+            while (test9_received <= i) {
+                rv = ogs_pollset_poll(pollset, ogs_time_from_msec(1000));
+                ABTS_INT_EQUAL(tc, OGS_OK, rv);
+                if (rv != OGS_OK)
+                    break;
+            }
+        }
+    }
+    ABTS_INT_EQUAL(tc, TEST9_NUM, test9_received);
+
+    ogs_pollset_remove(poll);
+
+    size = ogs_send(client->fd, str, strlen(DATASTR) + 1, 0);
+    ABTS_INT_EQUAL(tc, strlen(DATASTR) + 1, size);
+
+    rv = ogs_pollset_poll(pollset, ogs_time_from_msec(100));
+    ABTS_INT_EQUAL(tc, OGS_TIMEUP, rv);
+    ABTS_INT_EQUAL(tc, TEST9_NUM, test9_received);
+
+    ogs_sock_destroy(client);
+    ogs_sock_destroy(udp);
+
+    rv = ogs_freeaddrinfo(addr);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    ogs_pollset_destroy(pollset);
+}
+
 abts_suite *test_poll(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -672,6 +757,7 @@ abts_suite *test_poll(abts_suite *suite)
     abts_run_test(suite, test6_func, NULL);
     abts_run_test(suite, test7_func, NULL);
     abts_run_test(suite, test8_func, NULL);
+    abts_run_test(suite, test9_func, NULL);
 
     return suite;
 }
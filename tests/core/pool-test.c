@@ -228,6 +228,85 @@ static void test3_func(abts_case *tc, void *data)
     ogs_pool_final(&testpool);
 }
 
+typedef struct {
+    int m1;
+    char m2[40];
+} elastic_node_t;
+
+#define SIZE_OF_EPOOL 200
+
+static OGS_POOL(epool, elastic_node_t);
+
+static void test4_func(abts_case *tc, void *data)
+{
+    elastic_node_t *node[SIZE_OF_EPOOL+1];
+    ogs_pool_stat_t stat;
+    int i, index;
+
+    ogs_pool_init_elastic(&epool, SIZE_OF_EPOOL);
+    ABTS_INT_EQUAL(tc, SIZE_OF_EPOOL, ogs_pool_size(&epool));
+    ABTS_INT_EQUAL(tc, SIZE_OF_EPOOL, ogs_pool_avail(&epool));
+
+    ogs_pool_elastic_stat(epool.elastic, &stat);
+    ABTS_STR_EQUAL(tc, "epool", stat.name);
+    ABTS_INT_EQUAL(tc, SIZE_OF_EPOOL, stat.size);
+    ABTS_INT_EQUAL(tc, 0, stat.committed);
+    ABTS_TRUE(tc, stat.object_size >= sizeof(elastic_node_t));
+
+    /* Memory is committed one slab at a time */
+    ogs_pool_alloc(&epool, &node[0]);
+    ABTS_PTR_NOTNULL(tc, node[0]);
+    ABTS_INT_EQUAL(tc, 1, ogs_pool_index(&epool, node[0]));
+    ogs_pool_elastic_stat(epool.elastic, &stat);
+    ABTS_INT_EQUAL(tc, 1, stat.used);
+    ABTS_INT_EQUAL(tc, 64, stat.committed);
+
+    for (i = 1; i < SIZE_OF_EPOOL; i++) {
+        ogs_pool_alloc(&epool, &node[i]);
+        ABTS_PTR_NOTNULL(tc, node[i]);
+        ABTS_INT_EQUAL(tc, i + 1, ogs_pool_index(&epool, node[i]));
+        memset(node[i], 0xff, sizeof(elastic_node_t));
+    }
+    ogs_pool_alloc(&epool, &node[SIZE_OF_EPOOL]);
+    ABTS_PTR_EQUAL(tc, NULL, node[SIZE_OF_EPOOL]);
+    ABTS_INT_EQUAL(tc, 0, ogs_pool_avail(&epool));
+
+    ogs_pool_elastic_stat(epool.elastic, &stat);
+    ABTS_INT_EQUAL(tc, SIZE_OF_EPOOL, stat.used);
+    ABTS_INT_EQUAL(tc, SIZE_OF_EPOOL, stat.committed);
+
+    for (i = 0; i < SIZE_OF_EPOOL; i++)
+        ABTS_PTR_EQUAL(tc, node[i], ogs_pool_find(&epool, i + 1));
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pool_find(&epool, 0));
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pool_find(&epool, SIZE_OF_EPOOL + 1));
+
+    /* Empty slabs are released but one slab's worth is kept free */
+    for (i = 64; i < SIZE_OF_EPOOL; i++)
+        ogs_pool_free(&epool, node[i]);
+    ABTS_INT_EQUAL(tc, SIZE_OF_EPOOL - 64, ogs_pool_avail(&epool));
+    ogs_pool_elastic_stat(epool.elastic, &stat);
+    ABTS_INT_EQUAL(tc, 64, stat.used);
+    ABTS_INT_EQUAL(tc, 2 * 64, stat.committed);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pool_find(&epool, 65));
+
+    /* Objects are reused from the lowest slab first */
+    ogs_pool_free(&epool, node[10]);
+    index = 11;
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pool_find(&epool, index));
+    ogs_pool_alloc(&epool, &node[10]);
+    ABTS_INT_EQUAL(tc, index, ogs_pool_index(&epool, node[10]));
+    ABTS_PTR_EQUAL(tc, node[10], ogs_pool_find(&epool, index));
+
+    for (i = 0; i < 64; i++)
+        ogs_pool_free(&epool, node[i]);
+    ABTS_INT_EQUAL(tc, SIZE_OF_EPOOL, ogs_pool_avail(&epool));
+    ogs_pool_elastic_stat(epool.elastic, &stat);
+    ABTS_INT_EQUAL(tc, 0, stat.used);
+    ABTS_TRUE(tc, stat.committed <= 2 * 64);
+
+    ogs_pool_final(&epool);
+}
+
 abts_suite *test_pool(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -235,6 +314,7 @@ abts_suite *test_pool(abts_suite *suite)
     abts_run_test(suite, test1_func, NULL);
     abts_run_test(suite, test2_func, NULL);
     abts_run_test(suite, test3_func, NULL);
+    abts_run_test(suite, test4_func, NULL);
 
     return suite;
 }
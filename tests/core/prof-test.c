@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-core.h"
+#include "core/abts.h"
+
+static ogs_prof_entry_t *find_entry(ogs_prof_entry_t *table, uintptr_t key)
+{
+    int i;
+
+    for (i = 0; i < OGS_PROF_MAX_ENTRY; i++)
+        if (table[i].key == key)
+            return &table[i];
+
+    return NULL;
+}
+
+static int test1_called = 0;
+
+static void test1_handler(short when, ogs_socket_t fd, void *data)
+{
+    char buf[16];
+
+    ogs_read(fd, buf, sizeof(buf));
+    test1_called++;
+}
+
+static void test1_func(abts_case *tc, void *data)
+{
+    int rv;
+    ssize_t size;
+    ogs_socket_t fd[2];
+    ogs_poll_t *poll;
+    ogs_prof_t *prof;
+    ogs_prof_entry_t *entry;
+    ogs_pollset_t *pollset = ogs_pollset_create(512);
+    ABTS_PTR_NOTNULL(tc, pollset);
+
+    prof = ogs_pollset_prof(pollset);
+    ABTS_PTR_NOTNULL(tc, prof);
+
+    rv = ogs_socketpair(AF_SOCKPAIR, SOCK_STREAM, 0, fd);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    poll = ogs_pollset_add(pollset, OGS_POLLIN, fd[1], test1_handler, NULL);
+    ABTS_PTR_NOTNULL(tc, poll);
+
+    size = ogs_write(fd[0], "x", 1);
+    ABTS_INT_EQUAL(tc, 1, size);
+
+    test1_called = 0;
+    rv = ogs_pollset_poll(pollset, ogs_time_from_msec(100));
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc, 1, test1_called);
+    ABTS_PTR_EQUAL(tc, prof, ogs_prof_current());
+
+    entry = find_entry(prof->poll, (uintptr_t)test1_handler);
+    ABTS_PTR_NOTNULL(tc, entry);
+    ABTS_INT_EQUAL(tc, 1, entry->stat.count);
+
+    /* The first iteration completes when the loop polls again */
+    ABTS_INT_EQUAL(tc, 0, prof->iteration.count);
+    ogs_pollset_poll(pollset, 0);
+    ABTS_INT_EQUAL(tc, 1, prof->iteration.count);
+    ABTS_TRUE(tc, prof->iteration.total >= entry->stat.total);
+
+    ogs_pollset_remove(poll);
+    ogs_closesocket(fd[0]);
+    ogs_closesocket(fd[1]);
+
+    ogs_pollset_destroy(pollset);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_prof_current());
+}
+
+enum {
+    TEST2_OUTER_SIG = OGS_FSM_USER_SIG,
+    TEST2_INNER_SIG,
+};
+
+typedef struct test2_event_s {
+    int id;
+} test2_event_t;
+
+typedef struct test2_sm_s {
+    ogs_fsm_t fsm;
+    struct test2_sm_s *inner;
+} test2_sm_t;
+
+static void test2_state_final(test2_sm_t *sm, test2_event_t *e);
+
+static void test2_state_initial(test2_sm_t *sm, test2_event_t *e)
+{
+    OGS_FSM_TRAN(sm, &test2_state_final);
+}
+
+static void test2_state_final(test2_sm_t *sm, test2_event_t *e)
+{
+    test2_event_t inner;
+
+    if (e->id == TEST2_OUTER_SIG && sm->inner) {
+        inner.id = TEST2_INNER_SIG;
+        ogs_fsm_dispatch(&sm->inner->fsm, &inner);
+    }
+}
+
+static const char *test2_event_name(void *event)
+{
+    test2_event_t *e = event;
+
+    return e->id == TEST2_OUTER_SIG ? "OUTER" : "INNER";
+}
+
+static void test2_func(abts_case *tc, void *data)
+{
+    ogs_prof_t prof;
+    ogs_prof_entry_t *entry;
+    test2_sm_t outer, inner;
+    test2_event_t e;
+
+    memset(&prof, 0, sizeof(prof));
+    ogs_prof_set_event_name(&prof, test2_event_name);
+
+    memset(&outer, 0, sizeof(outer));
+    memset(&inner, 0, sizeof(inner));
+    outer.inner = &inner;
+    ogs_fsm_init(&outer, test2_state_initial, NULL, NULL);
+    ogs_fsm_init(&inner, test2_state_initial, NULL, NULL);
+
+    ogs_prof_set_current(&prof);
+
+    e.id = TEST2_OUTER_SIG;
+    ogs_fsm_dispatch(&outer, &e);
+    ogs_fsm_dispatch(&outer, &e);
+
+    ogs_prof_set_current(NULL);
+
+    ABTS_INT_EQUAL(tc, 0, prof.fsm_depth);
+
+    /* Only the outermost dispatch is accounted per event */
+    entry = find_entry(prof.event, TEST2_OUTER_SIG + 1);
+    ABTS_PTR_NOTNULL(tc, entry);
+    ABTS_INT_EQUAL(tc, 2, entry->stat.count);
+    ABTS_STR_EQUAL(tc, "OUTER", entry->name);
+    ABTS_PTR_EQUAL(tc, NULL, find_entry(prof.event, TEST2_INNER_SIG + 1));
+
+    /* State handlers are accounted at every depth */
+    entry = find_entry(prof.state, (uintptr_t)test2_state_final);
+    ABTS_PTR_NOTNULL(tc, entry);
+    ABTS_INT_EQUAL(tc, 4, entry->stat.count);
+}
+
+static void test3_func(abts_case *tc, void *data)
+{
+    int i, rv;
+    void *ptr;
+    ogs_prof_t prof;
+    ogs_queue_t *queue;
+    ogs_timer_mgr_t *timer_mgr;
+    ogs_timer_t *timer;
+
+    memset(&prof, 0, sizeof(prof));
+    ogs_prof_set_current(&prof);
+
+    queue = ogs_queue_create(16);
+    ABTS_PTR_NOTNULL(tc, queue);
+    for (i = 0; i < 5; i++) {
+        rv = ogs_queue_push(queue, &prof);
+        ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    }
+    while (ogs_queue_trypop(queue, &ptr) == OGS_OK);
+    ABTS_INT_EQUAL(tc, 5, prof.queue_depth_max);
+    ogs_queue_destroy(queue);
+
+    timer_mgr = ogs_timer_mgr_create(4);
+    ABTS_PTR_NOTNULL(tc, timer_mgr);
+    timer = ogs_timer_add(timer_mgr, NULL, NULL);
+    ABTS_PTR_NOTNULL(tc, timer);
+    ogs_timer_start(timer, ogs_time_from_msec(1));
+    ogs_msleep(20);
+    ogs_timer_mgr_expire(timer_mgr);
+    ABTS_INT_EQUAL(tc, 1, prof.timer_lag.count);
+    ABTS_TRUE(tc, prof.timer_lag.max >= 10 * 1000 * 1000);
+    ogs_timer_delete(timer);
+    ogs_timer_mgr_destroy(timer_mgr);
+
+    ogs_prof_set_current(NULL);
+}
+
+abts_suite *test_prof(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, test1_func, NULL);
+    abts_run_test(suite, test2_func, NULL);
+    abts_run_test(suite, test3_func, NULL);
+
+    return suite;
+}
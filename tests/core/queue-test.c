@@ -166,12 +166,98 @@ static void test_queue_timeout(abts_case *tc, void *data)
     ogs_queue_destroy(q);
 }
 
+#define BATCH_PRODUCERS     4
+#define BATCH_ITEMS         20000
+
+static ogs_queue_t *batch_queue;
+
+static void batch_producer(void *data)
+{
+    uintptr_t base = (uintptr_t)data;
+    uintptr_t i;
+    int rv;
+
+    for (i = 0; i < BATCH_ITEMS; i++) {
+        rv = ogs_queue_push(batch_queue, (void *)(base + i + 1));
+        ogs_assert(rv == OGS_OK);
+    }
+}
+
+static void test_queue_batch(abts_case *tc, void *data)
+{
+    unsigned int i, num, total = 0;
+    int rv;
+    void *value[OGS_QUEUE_MAX_BATCH];
+    uint8_t *seen;
+    ogs_pollset_t *pollset;
+    ogs_thread_t *producer_thread[BATCH_PRODUCERS];
+
+    seen = ogs_calloc(1, BATCH_PRODUCERS * BATCH_ITEMS);
+    ABTS_PTR_NOTNULL(tc, seen);
+
+    pollset = ogs_pollset_create(16);
+    ABTS_PTR_NOTNULL(tc, pollset);
+
+    batch_queue = ogs_queue_create(QUEUE_SIZE);
+    ABTS_PTR_NOTNULL(tc, batch_queue);
+    ogs_queue_set_notify(batch_queue, pollset);
+
+    for (i = 0; i < BATCH_PRODUCERS; i++) {
+        producer_thread[i] = ogs_thread_create(batch_producer,
+                (void *)(uintptr_t)(i * BATCH_ITEMS));
+        ABTS_PTR_NOTNULL(tc, producer_thread[i]);
+    }
+
+    /* The consumer only sleeps in the pollset, like an NF main loop */
+    while (total < BATCH_PRODUCERS * BATCH_ITEMS) {
+        rv = ogs_pollset_poll(pollset, ogs_time_from_sec(5));
+        ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+        for ( ;; ) {
+            num = OGS_QUEUE_MAX_BATCH;
+            rv = ogs_queue_trypop_batch(batch_queue, value, &num);
+            if (rv == OGS_RETRY)
+                break;
+            ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+            for (i = 0; i < num; i++) {
+                uintptr_t v = (uintptr_t)value[i] - 1;
+                ABTS_TRUE(tc, v < BATCH_PRODUCERS * BATCH_ITEMS);
+                ABTS_INT_EQUAL(tc, 0, seen[v]);
+                seen[v] = 1;
+            }
+            total += num;
+        }
+    }
+    ABTS_INT_EQUAL(tc, 0, ogs_queue_size(batch_queue));
+
+    for (i = 0; i < BATCH_PRODUCERS; i++) {
+        ogs_thread_destroy(producer_thread[i]);
+    }
+
+    for (i = 0; i < QUEUE_SIZE; i++) {
+        rv = ogs_queue_trypush(batch_queue, NULL);
+        ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    }
+    rv = ogs_queue_trypush(batch_queue, NULL);
+    ABTS_INT_EQUAL(tc, OGS_RETRY, rv);
+    ABTS_INT_EQUAL(tc, 1, ogs_queue_dropped(batch_queue));
+
+    rv = ogs_queue_term(batch_queue);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    ogs_queue_destroy(batch_queue);
+    ogs_pollset_destroy(pollset);
+    ogs_free(seen);
+}
+
 abts_suite *test_queue(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
     abts_run_test(suite, test_queue_producer_consumer, NULL);
     abts_run_test(suite, test_queue_timeout, NULL);
+    abts_run_test(suite, test_queue_batch, NULL);
 
     return suite;
 }
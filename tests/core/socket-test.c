@@ -424,6 +424,51 @@ static void test8_func(abts_case *tc, void *data)
     ABTS_INT_EQUAL(tc, OGS_OK, rv);
 }
 
+#define TEST9_NUM 100
+
+static void test9_func(abts_case *tc, void *data)
+{
+    int rv, i;
+    ogs_sock_t *server, *client;
+    ssize_t size;
+    ogs_sockaddr_t sa;
+    ogs_sockaddr_t *addr;
+    ogs_pkbuf_t *pkbuf[TEST9_NUM];
+    char str[STRLEN];
+
+    rv = ogs_getaddrinfo(&addr, AF_INET, "127.0.0.1", PORT, 0);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    server = ogs_udp_server(addr, NULL);
+    ABTS_PTR_NOTNULL(tc, server);
+
+    client = ogs_sock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ABTS_PTR_NOTNULL(tc, client);
+
+    for (i = 0; i < TEST9_NUM; i++) {
+        pkbuf[i] = ogs_pkbuf_alloc(NULL, sizeof(int) + i);
+        ABTS_PTR_NOTNULL(tc, pkbuf[i]);
+        ogs_pkbuf_put_data(pkbuf[i], &i, sizeof(int));
+        ogs_pkbuf_put(pkbuf[i], i);
+    }
+
+    rv = ogs_udp_sendmmsg(client->fd, pkbuf, TEST9_NUM, 0, addr);
+    ABTS_INT_EQUAL(tc, TEST9_NUM, rv);
+
+    /* Datagram boundaries and order are kept */
+    for (i = 0; i < TEST9_NUM; i++) {
+        size = ogs_recvfrom(server->fd, str, STRLEN, 0, &sa);
+        ABTS_INT_EQUAL(tc, sizeof(int) + i, size);
+        ABTS_INT_EQUAL(tc, i, *(int *)str);
+        ogs_pkbuf_free(pkbuf[i]);
+    }
+
+    ogs_sock_destroy(client);
+    ogs_sock_destroy(server);
+
+    rv = ogs_freeaddrinfo(addr);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+}
+
 abts_suite *test_socket(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -436,6 +481,7 @@ abts_suite *test_socket(abts_suite *suite)
     abts_run_test(suite, test6_func, NULL);
     abts_run_test(suite, test7_func, NULL);
     abts_run_test(suite, test8_func, NULL);
+    abts_run_test(suite, test9_func, NULL);
 
     return suite;
 }
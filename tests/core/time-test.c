@@ -100,6 +100,60 @@ static void test_imp_gmt(abts_case *tc, void *data)
     ABTS_TRUE(tc, now == imp);
 }
 
+static ogs_time_t cached1, cached2;
+
+static void cached_handler(short when, ogs_socket_t fd, void *data)
+{
+    char buf[16];
+
+    ogs_read(fd, buf, sizeof(buf));
+
+    cached1 = ogs_time_cached();
+    ogs_msleep(10);
+    cached2 = ogs_time_cached();
+}
+
+static void test_cached(abts_case *tc, void *data)
+{
+    int rv;
+    ogs_socket_t fd[2];
+    ogs_poll_t *poll;
+    ogs_time_t before, t1, t2, diff;
+    ogs_pollset_t *pollset = ogs_pollset_create(512);
+    ABTS_PTR_NOTNULL(tc, pollset);
+
+    rv = ogs_socketpair(AF_SOCKPAIR, SOCK_STREAM, 0, fd);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    poll = ogs_pollset_add(pollset, OGS_POLLIN, fd[1], cached_handler, NULL);
+    ABTS_PTR_NOTNULL(tc, poll);
+
+    before = ogs_get_monotonic_time();
+    ABTS_INT_EQUAL(tc, 1, ogs_write(fd[0], "x", 1));
+    rv = ogs_pollset_poll(pollset, ogs_time_from_msec(100));
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    /* One reading for the whole handler */
+    ABTS_TRUE(tc, cached1 >= before);
+    ABTS_TRUE(tc, cached1 == cached2);
+
+    /* Refreshed when the pollset returns */
+    ABTS_TRUE(tc, ogs_time_cached() >= cached1 + ogs_time_from_msec(10));
+
+    ogs_pollset_remove(poll);
+    ogs_closesocket(fd[0]);
+    ogs_closesocket(fd[1]);
+    ogs_pollset_destroy(pollset);
+
+    /* Without a pollset the clock is read directly */
+    t1 = ogs_time_cached();
+    ogs_msleep(10);
+    t2 = ogs_time_cached();
+    ABTS_TRUE(tc, t2 >= t1 + ogs_time_from_msec(10));
+
+    diff = ogs_time_now() - ogs_time_from_monotonic(ogs_get_monotonic_time());
+    ABTS_TRUE(tc, diff >= 0 && diff < ogs_time_from_msec(10));
+}
+
 abts_suite *test_time(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -109,6 +163,7 @@ abts_suite *test_time(abts_suite *suite)
     abts_run_test(suite, test_get_gmt, NULL);
     abts_run_test(suite, test_get_lt, NULL);
     abts_run_test(suite, test_imp_gmt, NULL);
+    abts_run_test(suite, test_cached, NULL);
 
     return suite;
 }
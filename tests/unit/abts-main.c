@@ -17,7 +17,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-#include "ogs-core.h"
+#include "ogs-pfcp.h"
 #include "core/abts.h"
 
 extern int __ogs_s1ap_domain;
@@ -37,6 +37,10 @@ abts_suite *test_ngap_message(abts_suite *suite);
 abts_suite *test_sbi_message(abts_suite *suite);
 abts_suite *test_security(abts_suite *suite);
 abts_suite *test_crash(abts_suite *suite);
+abts_suite *test_pfcp_context(abts_suite *suite);
+abts_suite *test_metrics(abts_suite *suite);
+abts_suite *test_paging(abts_suite *suite);
+abts_suite *test_reload(abts_suite *suite);
 
 const struct testlist {
     abts_suite *(*func)(abts_suite *suite);
@@ -49,11 +53,17 @@ const struct testlist {
     {test_sbi_message},
     {test_security},
     {test_crash},
+    {test_pfcp_context},
+    {test_metrics},
+    {test_paging},
+    {test_reload},
     {NULL},
 };
 
 static void terminate(void)
 {
+    ogs_pfcp_context_final();
+
     ogs_sbi_message_final();
 
     ogs_pkbuf_default_destroy();
@@ -102,6 +112,10 @@ int main(int argc, const char *const argv[])
 
     ogs_sbi_message_init(32, 32);
 
+    ogs_app()->pool.nf = 4;
+    ogs_app()->pool.sess = 64;
+    ogs_pfcp_context_init();
+
     ogs_log_install_domain(&__ogs_s1ap_domain, "s1ap", OGS_LOG_ERROR);
     ogs_log_install_domain(&__ogs_ngap_domain, "ngap", OGS_LOG_ERROR);
     ogs_log_install_domain(&__ogs_nas_domain, "nas", OGS_LOG_ERROR);
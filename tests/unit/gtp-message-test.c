@@ -313,11 +313,104 @@ static void gtp_message_test1(abts_case *tc, void *data)
     ogs_pkbuf_free(pkbuf);
 }
 
+static ogs_pkbuf_t *gtp_message_test2_payload(void)
+{
+    const char *_payload = "4500001c00000000 4001000000000000";
+    char hexbuf[OGS_HUGE_LEN];
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, OGS_GTPV1U_5GC_HEADER_LEN+16);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_reserve(pkbuf, OGS_GTPV1U_5GC_HEADER_LEN);
+    ogs_pkbuf_put_data(pkbuf,
+        ogs_hex_from_string(_payload, hexbuf, sizeof(hexbuf)), 16);
+
+    return pkbuf;
+}
+
+static void gtp_message_test2(abts_case *tc, void *data)
+{
+    int rv, i;
+    /* G-PDU with PDU Session Container(QFI:9) */
+    const char *_header = "34ff001812345678 0000008501000900";
+    char hexbuf[OGS_HUGE_LEN];
+    uint8_t expected[OGS_GTPV1U_5GC_HEADER_LEN+16];
+    uint8_t received[OGS_MAX_PKT_LEN];
+    ssize_t size;
+
+    ogs_gtp2_header_desc_t header_desc;
+    ogs_gtp2_encap_t encap;
+    ogs_gtp_node_t gnode;
+    ogs_sockaddr_t *addr = NULL;
+    ogs_sockaddr_t from;
+    ogs_sock_t *server = NULL;
+    ogs_pkbuf_t *pkbuf[2];
+
+    memset(&header_desc, 0, sizeof(header_desc));
+    header_desc.type = OGS_GTPU_MSGTYPE_GPDU;
+    header_desc.teid = 0x12345678;
+    header_desc.pdu_type =
+        OGS_GTP2_EXTENSION_HEADER_PDU_TYPE_DL_PDU_SESSION_INFORMATION;
+    header_desc.qos_flow_identifier = 9;
+
+    rv = ogs_gtp2_build_encap(&encap, &header_desc);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_TRUE(tc, encap.valid);
+    ABTS_INT_EQUAL(tc, OGS_GTPV1U_5GC_HEADER_LEN, encap.len);
+
+    rv = ogs_getaddrinfo(&addr, AF_INET, "127.0.0.1", 2152+1000, 0);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    server = ogs_udp_server(addr, NULL);
+    ABTS_PTR_NOTNULL(tc, server);
+
+    memset(&gnode, 0, sizeof(gnode));
+    memcpy(&gnode.addr, addr, sizeof(gnode.addr));
+    gnode.sock = ogs_sock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ABTS_PTR_NOTNULL(tc, gnode.sock);
+
+    /* Reference : header built per packet */
+    rv = ogs_gtp2_send_user_plane(
+            &gnode, &header_desc, gtp_message_test2_payload());
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    size = ogs_recvfrom(server->fd, expected, sizeof(expected), 0, &from);
+    ABTS_INT_EQUAL(tc, OGS_GTPV1U_5GC_HEADER_LEN+16, size);
+    ABTS_TRUE(tc, memcmp(expected,
+        ogs_hex_from_string(_header, hexbuf, sizeof(hexbuf)),
+        OGS_GTPV1U_5GC_HEADER_LEN) == 0);
+
+    /* Cached header */
+    rv = ogs_gtp2_send_user_plane_encap(
+            &gnode, &encap, gtp_message_test2_payload());
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    size = ogs_recvfrom(server->fd, received, sizeof(received), 0, &from);
+    ABTS_INT_EQUAL(tc, sizeof(expected), size);
+    ABTS_TRUE(tc, memcmp(received, expected, sizeof(expected)) == 0);
+
+    /* Cached header, batch */
+    pkbuf[0] = gtp_message_test2_payload();
+    pkbuf[1] = gtp_message_test2_payload();
+    rv = ogs_gtp2_send_user_plane_encap_batch(&gnode, &encap, pkbuf, 2);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    for (i = 0; i < 2; i++) {
+        size = ogs_recvfrom(server->fd, received, sizeof(received), 0, &from);
+        ABTS_INT_EQUAL(tc, sizeof(expected), size);
+        ABTS_TRUE(tc, memcmp(received, expected, sizeof(expected)) == 0);
+    }
+
+    ogs_sock_destroy(gnode.sock);
+    ogs_sock_destroy(server);
+    ogs_freeaddrinfo(addr);
+}
+
 abts_suite *test_gtp_message(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
     abts_run_test(suite, gtp_message_test1, NULL);
+    abts_run_test(suite, gtp_message_test2, NULL);
 
     return suite;
 }
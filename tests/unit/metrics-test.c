@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-app.h"
+#include "ogs-metrics.h"
+#include "core/abts.h"
+
+#define NUM_OF_THREAD_OBSERVE 1000
+
+static ogs_metrics_inst_t *thread_inst;
+
+static void observe_func(void *data)
+{
+    int i;
+
+    for (i = 0; i < NUM_OF_THREAD_OBSERVE; i++)
+        ogs_metrics_inst_add(thread_inst, 100);
+}
+
+static void metrics_test1(abts_case *tc, void *data)
+{
+    ogs_metrics_spec_t *spec = NULL;
+    ogs_metrics_inst_t *inst = NULL, *inst2 = NULL;
+    ogs_metrics_histogram_params_t params;
+    ogs_thread_t *thread = NULL;
+    const char *labels[] = { "peer", "procedure" };
+    char *out = NULL;
+
+    if (!ogs_app()->metrics.max_specs)
+        ogs_app()->metrics.max_specs = 8;
+    ogs_metrics_context_init();
+
+    memset(&params, 0, sizeof(params));
+    params.type = OGS_METRICS_HISTOGRAM_BUCKET_TYPE_EXPONENTIAL;
+    params.count = 4;
+    params.exp.start = 1;
+    params.exp.factor = 2;
+
+    spec = ogs_metrics_spec_new(ogs_metrics_self(),
+            OGS_METRICS_METRIC_TYPE_HISTOGRAM,
+            "test_xact_time", "Test round-trip time", 0,
+            OGS_ARRAY_SIZE(labels), labels, &params);
+    ABTS_PTR_NOTNULL(tc, spec);
+
+    /* The same label values always map to the same instance */
+    inst = ogs_metrics_inst_find_or_add(spec, OGS_ARRAY_SIZE(labels),
+            (const char *[]){ "10.0.0.1", "a\"b\\c" });
+    ABTS_PTR_NOTNULL(tc, inst);
+    inst2 = ogs_metrics_inst_find_or_add(spec, OGS_ARRAY_SIZE(labels),
+            (const char *[]){ "10.0.0.1", "a\"b\\c" });
+    ABTS_PTR_EQUAL(tc, inst, inst2);
+    inst2 = ogs_metrics_inst_find_or_add(spec, OGS_ARRAY_SIZE(labels),
+            (const char *[]){ "10.0.0.2", "a\"b\\c" });
+    ABTS_TRUE(tc, inst != inst2);
+
+    ogs_metrics_inst_add(inst, 1);
+    ogs_metrics_inst_add(inst, 3);
+
+    thread_inst = inst;
+    thread = ogs_thread_create(observe_func, NULL);
+    ABTS_PTR_NOTNULL(tc, thread);
+    ogs_thread_destroy(thread);
+
+    out = ogs_metrics_context_render();
+    if (out) {
+        ABTS_PTR_NOTNULL(tc, strstr(out,
+            "# TYPE test_xact_time histogram\n"));
+        ABTS_PTR_NOTNULL(tc, strstr(out,
+            "test_xact_time_bucket{peer=\"10.0.0.1\","
+            "procedure=\"a\\\"b\\\\c\",le=\"1\"} 1\n"));
+        ABTS_PTR_NOTNULL(tc, strstr(out,
+            "test_xact_time_bucket{peer=\"10.0.0.1\","
+            "procedure=\"a\\\"b\\\\c\",le=\"4\"} 2\n"));
+        ABTS_PTR_NOTNULL(tc, strstr(out,
+            "test_xact_time_bucket{peer=\"10.0.0.1\","
+            "procedure=\"a\\\"b\\\\c\",le=\"8\"} 2\n"));
+        ABTS_PTR_NOTNULL(tc, strstr(out,
+            "test_xact_time_bucket{peer=\"10.0.0.1\","
+            "procedure=\"a\\\"b\\\\c\",le=\"+Inf\"} 1002\n"));
+        ABTS_PTR_NOTNULL(tc, strstr(out,
+            "test_xact_time_sum{peer=\"10.0.0.1\","
+            "procedure=\"a\\\"b\\\\c\"} 100004\n"));
+        ABTS_PTR_NOTNULL(tc, strstr(out,
+            "test_xact_time_count{peer=\"10.0.0.1\","
+            "procedure=\"a\\\"b\\\\c\"} 1002\n"));
+
+        /* An instance without observations still renders empty buckets */
+        ABTS_PTR_NOTNULL(tc, strstr(out,
+            "test_xact_time_count{peer=\"10.0.0.2\","
+            "procedure=\"a\\\"b\\\\c\"} 0\n"));
+
+        free(out);
+    }
+
+    ogs_metrics_context_final();
+}
+
+static void metrics_test2(abts_case *tc, void *data)
+{
+    ogs_metrics_peer_t *peer = NULL;
+    ogs_metrics_inst_t *inst = NULL;
+    ogs_metrics_peer_xact_stats_t stats;
+    char *out = NULL;
+
+    if (!ogs_app()->metrics.max_specs)
+        ogs_app()->metrics.max_specs = 8;
+    ogs_metrics_context_init();
+
+    ogs_metrics_peer_xact_init(OGS_METRICS_PEER_XACT_PFCP);
+
+    /* The peer is resolved once and shared by every node with its name */
+    peer = ogs_metrics_peer_find_or_add("10.0.0.1");
+    ABTS_PTR_NOTNULL(tc, peer);
+    ABTS_PTR_EQUAL(tc, peer, ogs_metrics_peer_find_or_add("10.0.0.1"));
+    ABTS_TRUE(tc, peer != ogs_metrics_peer_find_or_add("10.0.0.2"));
+
+    memset(&stats, 0, sizeof(stats));
+    stats.local = 2;
+    stats.retransmitted = 5;
+    ogs_metrics_peer_xact_update(peer, OGS_METRICS_PEER_XACT_PFCP, &stats);
+
+    /* A re-created node starts from zero again */
+    stats.retransmitted = 1;
+    stats.duplicated = 1;
+    ogs_metrics_peer_xact_update(peer, OGS_METRICS_PEER_XACT_PFCP, &stats);
+
+    /* Not declared, so nothing is exported */
+    ogs_metrics_peer_xact_update(peer, OGS_METRICS_PEER_XACT_GTP, &stats);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_metrics_peer_hist_add(peer,
+                OGS_METRICS_PEER_HIST_PFCP_XACT_TIME, 50, NULL, "50"));
+
+    /* The histogram of a procedure is resolved once per peer */
+    ogs_metrics_peer_hist_init(OGS_METRICS_PEER_HIST_PFCP_XACT_TIME);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_metrics_peer_hist_find(peer,
+                OGS_METRICS_PEER_HIST_PFCP_XACT_TIME, 50, NULL));
+    inst = ogs_metrics_peer_hist_add(peer,
+            OGS_METRICS_PEER_HIST_PFCP_XACT_TIME, 50, NULL, "50");
+    ABTS_PTR_NOTNULL(tc, inst);
+    ABTS_PTR_EQUAL(tc, inst, ogs_metrics_peer_hist_find(peer,
+                OGS_METRICS_PEER_HIST_PFCP_XACT_TIME, 50, NULL));
+    ABTS_PTR_EQUAL(tc, NULL, ogs_metrics_peer_hist_find(peer,
+                OGS_METRICS_PEER_HIST_PFCP_XACT_TIME, 50, "nsmf"));
+    ABTS_TRUE(tc, inst != ogs_metrics_peer_hist_add(peer,
+                OGS_METRICS_PEER_HIST_PFCP_XACT_TIME, 50, "nsmf", "50 nsmf"));
+    ogs_metrics_inst_add(inst, 3);
+
+    out = ogs_metrics_context_render();
+    if (out) {
+        ABTS_PTR_NOTNULL(tc, strstr(out,
+            "# TYPE pfcp_xact_retransmitted counter\n"));
+        ABTS_PTR_EQUAL(tc, NULL, strstr(out, "gtp_xact_retransmitted"));
+        ABTS_PTR_NOTNULL(tc, strstr(out,
+            "pfcp_xact_time_count{peer=\"10.0.0.1\","
+            "procedure=\"50\"} 1\n"));
+
+        free(out);
+    }
+
+    ogs_metrics_context_final();
+}
+
+abts_suite *test_metrics(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, metrics_test1, NULL);
+    abts_run_test(suite, metrics_test2, NULL);
+
+    return suite;
+}
@@ -372,6 +372,132 @@ static void ngap_message_test5_issues2934(abts_case *tc, void *data)
     ogs_pkbuf_free(ngapbuf);
 }
 
+static void ngap_message_test6_lazy(abts_case *tc, void *data)
+{
+    const char *payload =
+        "7e005c00 0d0199f9 07f0ff00 00000020"
+        "3190";
+    ogs_pkbuf_t *gmmbuf = NULL;
+    ogs_pkbuf_t *ngapbuf = NULL;
+    char hexbuf[OGS_HUGE_LEN];
+    int rv;
+
+    ogs_ngap_lazy_message_t message;
+    ogs_asn_ie_view_t *ie = NULL;
+    NGAP_NAS_PDU_t NAS_PDU;
+    NGAP_UserLocationInformation_t UserLocationInformation;
+
+    gmmbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
+    ogs_assert(gmmbuf);
+    ogs_pkbuf_put_data(gmmbuf,
+            ogs_hex_from_string(payload, hexbuf, sizeof(hexbuf)), 18);
+
+    ngapbuf = build_uplink_nas_transport(0x10203, 0x123456789a, gmmbuf);
+    ABTS_PTR_NOTNULL(tc, ngapbuf);
+
+    rv = ogs_ngap_lazy_decode(&message, ngapbuf);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc, NGAP_NGAP_PDU_PR_initiatingMessage, message.h.present);
+    ABTS_INT_EQUAL(tc, NGAP_ProcedureCode_id_UplinkNASTransport,
+            message.h.procedureCode);
+    ABTS_INT_EQUAL(tc, NGAP_Criticality_ignore, message.h.criticality);
+    ABTS_INT_EQUAL(tc, 4, message.h.num_of_ie);
+
+    ABTS_TRUE(tc, message.amf_ue_ngap_id_presence);
+    ABTS_TRUE(tc, 0x123456789a == message.amf_ue_ngap_id);
+    ABTS_TRUE(tc, message.ran_ue_ngap_id_presence);
+    ABTS_TRUE(tc, 0x10203 == message.ran_ue_ngap_id);
+
+    ie = ogs_ngap_lazy_find_ie(&message, NGAP_ProtocolIE_ID_id_NAS_PDU);
+    ABTS_PTR_NOTNULL(tc, ie);
+    rv = ogs_asn_lazy_get_OCTET_STRING(ie, &NAS_PDU);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc, 18, NAS_PDU.size);
+    ABTS_TRUE(tc, NAS_PDU.buf > ngapbuf->data &&
+            NAS_PDU.buf + NAS_PDU.size <= ngapbuf->tail);
+    ABTS_TRUE(tc, memcmp(NAS_PDU.buf,
+            ogs_hex_from_string(payload, hexbuf, sizeof(hexbuf)), 18) == 0);
+
+    rv = ogs_ngap_lazy_decode_ie(&message,
+            NGAP_ProtocolIE_ID_id_UserLocationInformation,
+            &asn_DEF_NGAP_UserLocationInformation,
+            &UserLocationInformation, sizeof(UserLocationInformation));
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc,
+            NGAP_UserLocationInformation_PR_userLocationInformationNR,
+            UserLocationInformation.present);
+    ogs_asn_free(&asn_DEF_NGAP_UserLocationInformation,
+            &UserLocationInformation);
+
+    rv = ogs_ngap_lazy_decode_ie(&message,
+            NGAP_ProtocolIE_ID_id_Cause,
+            &asn_DEF_NGAP_UserLocationInformation,
+            &UserLocationInformation, sizeof(UserLocationInformation));
+    ABTS_INT_EQUAL(tc, OGS_ERROR, rv);
+
+    /* Truncated PDU must be rejected, not over-read */
+    ngapbuf->len -= 5;
+    rv = ogs_ngap_lazy_decode(&message, ngapbuf);
+    ABTS_INT_EQUAL(tc, OGS_ERROR, rv);
+
+    ogs_pkbuf_free(ngapbuf);
+}
+
+static void ngap_message_test7_lazy_benchmark(abts_case *tc, void *data)
+{
+    const char *payload =
+        "7e005c00 0d0199f9 07f0ff00 00000020"
+        "3190";
+    ogs_pkbuf_t *gmmbuf = NULL;
+    ogs_pkbuf_t *ngapbuf = NULL;
+    char hexbuf[OGS_HUGE_LEN];
+    int i, rv;
+
+    ogs_ngap_message_t message;
+    ogs_ngap_lazy_message_t lazy;
+    ogs_asn_ie_view_t *ie = NULL;
+    NGAP_NAS_PDU_t NAS_PDU;
+
+    ogs_time_t start, full_time, lazy_time;
+
+#define NGAP_BENCHMARK_COUNT 10000
+
+    gmmbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
+    ogs_assert(gmmbuf);
+    ogs_pkbuf_put_data(gmmbuf,
+            ogs_hex_from_string(payload, hexbuf, sizeof(hexbuf)), 18);
+
+    ngapbuf = build_uplink_nas_transport(1, 2, gmmbuf);
+    ABTS_PTR_NOTNULL(tc, ngapbuf);
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < NGAP_BENCHMARK_COUNT; i++) {
+        rv = ogs_ngap_decode(&message, ngapbuf);
+        ogs_ngap_free(&message);
+        if (rv != OGS_OK)
+            break;
+    }
+    full_time = ogs_get_monotonic_time() - start;
+    ABTS_INT_EQUAL(tc, NGAP_BENCHMARK_COUNT, i);
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < NGAP_BENCHMARK_COUNT; i++) {
+        rv = ogs_ngap_lazy_decode(&lazy, ngapbuf);
+        if (rv != OGS_OK)
+            break;
+        ie = ogs_ngap_lazy_find_ie(&lazy, NGAP_ProtocolIE_ID_id_NAS_PDU);
+        if (!ie || ogs_asn_lazy_get_OCTET_STRING(ie, &NAS_PDU) != OGS_OK)
+            break;
+    }
+    lazy_time = ogs_get_monotonic_time() - start;
+    ABTS_INT_EQUAL(tc, NGAP_BENCHMARK_COUNT, i);
+
+    ogs_info("UplinkNASTransport x %d : full %lldus, lazy %lldus",
+            NGAP_BENCHMARK_COUNT, (long long)full_time, (long long)lazy_time);
+
+    ogs_pkbuf_free(ngapbuf);
+}
+
 abts_suite *test_ngap_message(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -383,6 +509,8 @@ abts_suite *test_ngap_message(abts_suite *suite)
     abts_run_test(suite, ngap_message_test3, NULL);
     abts_run_test(suite, ngap_message_test4, NULL);
     abts_run_test(suite, ngap_message_test5_issues2934, NULL);
+    abts_run_test(suite, ngap_message_test6_lazy, NULL);
+    abts_run_test(suite, ngap_message_test7_lazy_benchmark, NULL);
 
     return suite;
 }
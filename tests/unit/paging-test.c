@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-app.h"
+#include "core/abts.h"
+
+typedef struct test_ue_s {
+    int id;
+    ogs_paging_ue_t paging_ue;
+} test_ue_t;
+
+static int flush_count;
+
+static void test_flush(void *data)
+{
+    flush_count++;
+}
+
+static void make_tai(ogs_eps_tai_t *tai, uint16_t tac)
+{
+    memset(tai, 0, sizeof(*tai));
+    ogs_plmn_id_build(&tai->plmn_id, 1, 1, 2);
+    tai->tac = tac;
+}
+
+static void paging_test1(abts_case *tc, void *data)
+{
+    ogs_timer_mgr_t *timer_mgr = NULL;
+    ogs_paging_index_t index;
+    ogs_paging_area_t *area1 = NULL, *area2 = NULL;
+    ogs_paging_member_t *member = NULL;
+    ogs_list_t node1_list, node2_list;
+    int node1 = 1, node2 = 2;
+    ogs_eps_tai_t tai;
+    int count;
+
+    timer_mgr = ogs_timer_mgr_create(8);
+    ABTS_PTR_NOTNULL(tc, timer_mgr);
+
+    ogs_paging_index_init(&index, timer_mgr, test_flush);
+    ogs_list_init(&node1_list);
+    ogs_list_init(&node2_list);
+
+    /* A TAI listed twice links the node only once */
+    make_tai(&tai, 1);
+    ogs_paging_node_add(&index, &node1_list, &node1, &tai, sizeof(tai));
+    ogs_paging_node_add(&index, &node1_list, &node1, &tai, sizeof(tai));
+    ogs_paging_node_add(&index, &node2_list, &node2, &tai, sizeof(tai));
+    make_tai(&tai, 2);
+    ogs_paging_node_add(&index, &node1_list, &node1, &tai, sizeof(tai));
+
+    ABTS_INT_EQUAL(tc, 2, ogs_list_count(&node1_list));
+    ABTS_INT_EQUAL(tc, 1, ogs_list_count(&node2_list));
+
+    make_tai(&tai, 1);
+    area1 = ogs_paging_area_find(&index, &tai, sizeof(tai));
+    ABTS_PTR_NOTNULL(tc, area1);
+    ABTS_INT_EQUAL(tc, 2, ogs_list_count(&area1->node_list));
+    member = ogs_list_first(&area1->node_list);
+    ABTS_PTR_EQUAL(tc, &node1, member->node);
+    member = ogs_list_next(member);
+    ABTS_PTR_EQUAL(tc, &node2, member->node);
+
+    make_tai(&tai, 2);
+    area2 = ogs_paging_area_find(&index, &tai, sizeof(tai));
+    ABTS_PTR_NOTNULL(tc, area2);
+    ABTS_INT_EQUAL(tc, 1, ogs_list_count(&area2->node_list));
+
+    make_tai(&tai, 3);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_paging_area_find(&index, &tai, sizeof(tai)));
+
+    /* Re-indexing node1 keeps the area that node2 still serves */
+    ogs_paging_node_clear(&index, &node1_list);
+    ABTS_INT_EQUAL(tc, 0, ogs_list_count(&node1_list));
+
+    make_tai(&tai, 1);
+    area1 = ogs_paging_area_find(&index, &tai, sizeof(tai));
+    ABTS_PTR_NOTNULL(tc, area1);
+    ABTS_INT_EQUAL(tc, 1, ogs_list_count(&area1->node_list));
+    member = ogs_list_first(&area1->node_list);
+    ABTS_PTR_EQUAL(tc, &node2, member->node);
+
+    make_tai(&tai, 2);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_paging_area_find(&index, &tai, sizeof(tai)));
+
+    ogs_paging_node_clear(&index, &node2_list);
+    make_tai(&tai, 1);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_paging_area_find(&index, &tai, sizeof(tai)));
+
+    count = 0;
+    {
+        ogs_hash_index_t *hi = NULL;
+        for (hi = ogs_hash_first(index.area_hash); hi; hi = ogs_hash_next(hi))
+            count++;
+    }
+    ABTS_INT_EQUAL(tc, 0, count);
+
+    ogs_paging_index_final(&index);
+    ogs_timer_mgr_destroy(timer_mgr);
+}
+
+static void paging_test2(abts_case *tc, void *data)
+{
+    ogs_timer_mgr_t *timer_mgr = NULL;
+    ogs_paging_index_t index;
+    ogs_paging_area_t *area1 = NULL, *area2 = NULL, *area = NULL;
+    ogs_paging_ue_t *ue = NULL;
+    ogs_list_t node1_list, node2_list;
+    int node1 = 1, node2 = 2;
+    test_ue_t ue1, ue2, ue3, *test_ue = NULL;
+    ogs_eps_tai_t tai;
+
+    timer_mgr = ogs_timer_mgr_create(8);
+    ABTS_PTR_NOTNULL(tc, timer_mgr);
+
+    ogs_paging_index_init(&index, timer_mgr, test_flush);
+    ogs_list_init(&node1_list);
+    ogs_list_init(&node2_list);
+
+    make_tai(&tai, 1);
+    ogs_paging_node_add(&index, &node1_list, &node1, &tai, sizeof(tai));
+    area1 = ogs_paging_area_find(&index, &tai, sizeof(tai));
+    ABTS_PTR_NOTNULL(tc, area1);
+    make_tai(&tai, 2);
+    ogs_paging_node_add(&index, &node2_list, &node2, &tai, sizeof(tai));
+    area2 = ogs_paging_area_find(&index, &tai, sizeof(tai));
+    ABTS_PTR_NOTNULL(tc, area2);
+
+    memset(&ue1, 0, sizeof(ue1));
+    ue1.id = 1;
+    memset(&ue2, 0, sizeof(ue2));
+    ue2.id = 2;
+    memset(&ue3, 0, sizeof(ue3));
+    ue3.id = 3;
+
+    /* The first UE arms the flush timer */
+    ABTS_TRUE(tc, !index.t_flush->running);
+    ogs_paging_ue_queue(&index, area1, &ue1.paging_ue);
+    ABTS_TRUE(tc, index.t_flush->running);
+
+    /* A UE paged twice is queued once */
+    ogs_paging_ue_queue(&index, area1, &ue1.paging_ue);
+    ogs_paging_ue_queue(&index, area1, &ue2.paging_ue);
+    ogs_paging_ue_queue(&index, area2, &ue3.paging_ue);
+    ABTS_INT_EQUAL(tc, 2, ogs_list_count(&area1->ue_list));
+    ABTS_INT_EQUAL(tc, 1, ogs_list_count(&area2->ue_list));
+    ABTS_INT_EQUAL(tc, 2, ogs_list_count(&index.pending_list));
+
+    /* A UE removed before the flush is not paged */
+    ogs_paging_ue_dequeue(&ue2.paging_ue);
+    ABTS_PTR_EQUAL(tc, NULL, ue2.paging_ue.area);
+    ABTS_INT_EQUAL(tc, 1, ogs_list_count(&area1->ue_list));
+
+    /* The flush timer fires once for the iteration */
+    flush_count = 0;
+    ogs_msleep(1);
+    ogs_timer_mgr_expire(timer_mgr);
+    ABTS_INT_EQUAL(tc, 1, flush_count);
+
+    area = ogs_paging_pending_pop(&index);
+    ABTS_PTR_EQUAL(tc, area1, area);
+    ABTS_TRUE(tc, !area->pending);
+    ue = ogs_paging_ue_pop(area);
+    ABTS_PTR_EQUAL(tc, &ue1.paging_ue, ue);
+    test_ue = ogs_container_of(ue, test_ue_t, paging_ue);
+    ABTS_INT_EQUAL(tc, 1, test_ue->id);
+    ABTS_PTR_EQUAL(tc, NULL, ue1.paging_ue.area);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_paging_ue_pop(area));
+
+    /* A UE can be queued again once it has been popped */
+    ogs_paging_ue_queue(&index, area1, &ue1.paging_ue);
+    ABTS_PTR_EQUAL(tc, area1, ue1.paging_ue.area);
+    ABTS_INT_EQUAL(tc, 2, ogs_list_count(&index.pending_list));
+
+    /* Removing the last node of an area drops the pages queued there */
+    ogs_paging_node_clear(&index, &node2_list);
+    ABTS_PTR_EQUAL(tc, NULL, ue3.paging_ue.area);
+    ABTS_INT_EQUAL(tc, 1, ogs_list_count(&index.pending_list));
+
+    area = ogs_paging_pending_pop(&index);
+    ABTS_PTR_EQUAL(tc, area1, area);
+    ABTS_PTR_EQUAL(tc, &ue1.paging_ue, ogs_paging_ue_pop(area));
+    ABTS_PTR_EQUAL(tc, NULL, ogs_paging_pending_pop(&index));
+
+    ogs_paging_node_clear(&index, &node1_list);
+
+    ogs_paging_index_final(&index);
+    ogs_timer_mgr_destroy(timer_mgr);
+}
+
+abts_suite *test_paging(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, paging_test1, NULL);
+    abts_run_test(suite, paging_test2, NULL);
+
+    return suite;
+}
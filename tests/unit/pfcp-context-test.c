@@ -0,0 +1,925 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-pfcp.h"
+#include "core/abts.h"
+
+#define NUM_OF_TEST_SESS    64
+
+/*
+ * Rules memory budget of a typical 5GC session on the UP-Function:
+ * UL/DL/CP PDRs and FARs, one URR and one QER.
+ */
+#define MAX_BYTES_PER_SESS  4096
+
+static ogs_pfcp_sess_t sess[NUM_OF_TEST_SESS];
+
+static void sum_rule_pool(const ogs_pool_stat_t *stat, void *data)
+{
+    size_t *bytes = data;
+
+    if (strncmp(stat->name, "ogs_pfcp_", 9) == 0 &&
+        strcmp(stat->name, "ogs_pfcp_sess_pool") != 0)
+        *bytes += (size_t)stat->used * stat->object_size;
+}
+
+static void add_rules(ogs_pfcp_sess_t *s)
+{
+    ogs_pfcp_pdr_t *pdr = NULL;
+    ogs_pfcp_far_t *far = NULL;
+    ogs_pfcp_urr_t *urr = NULL;
+    ogs_pfcp_qer_t *qer = NULL;
+    int i;
+
+    urr = ogs_pfcp_urr_add(s);
+    ogs_assert(urr);
+    qer = ogs_pfcp_qer_add(s);
+    ogs_assert(qer);
+
+    for (i = 0; i < 4; i++) {
+        pdr = ogs_pfcp_pdr_add(s);
+        ogs_assert(pdr);
+        far = ogs_pfcp_far_add(s);
+        ogs_assert(far);
+
+        pdr->far = far;
+        pdr->qer = qer;
+        pdr->urr[pdr->num_of_urr++] = urr;
+    }
+}
+
+static void pfcp_context_test1(abts_case *tc, void *data)
+{
+    size_t bytes = 0;
+    int i;
+
+    for (i = 0; i < NUM_OF_TEST_SESS; i++) {
+        ogs_pfcp_pool_init(&sess[i]);
+        add_rules(&sess[i]);
+    }
+
+    ogs_pool_elastic_stat_all(sum_rule_pool, &bytes);
+    bytes = bytes / NUM_OF_TEST_SESS + sizeof(ogs_pfcp_sess_t);
+    ABTS_TRUE(tc, bytes <= MAX_BYTES_PER_SESS);
+
+    for (i = 0; i < NUM_OF_TEST_SESS; i++) {
+        ogs_pfcp_sess_clear(&sess[i]);
+        ogs_pfcp_pool_final(&sess[i]);
+    }
+
+    bytes = 0;
+    ogs_pool_elastic_stat_all(sum_rule_pool, &bytes);
+    ABTS_INT_EQUAL(tc, 0, bytes);
+}
+
+static void pfcp_context_test2(abts_case *tc, void *data)
+{
+    ogs_pfcp_pdr_t *pdr[OGS_MAX_NUM_OF_PDR+1];
+    ogs_pfcp_pdr_flow_t *flow = NULL;
+    int i;
+
+    ogs_pfcp_pool_init(&sess[0]);
+
+    for (i = 0; i < OGS_MAX_NUM_OF_PDR; i++) {
+        pdr[i] = ogs_pfcp_pdr_add(&sess[0]);
+        ABTS_PTR_NOTNULL(tc, pdr[i]);
+        ABTS_INT_EQUAL(tc, i + 1, pdr[i]->id);
+        ABTS_PTR_EQUAL(tc, NULL, pdr[i]->flow);
+    }
+    pdr[i] = ogs_pfcp_pdr_add(&sess[0]);
+    ABTS_PTR_EQUAL(tc, NULL, pdr[i]);
+
+    /* A released ID is handed out again only after the others */
+    ogs_pfcp_pdr_remove(pdr[2]);
+    ogs_pfcp_pdr_remove(pdr[OGS_MAX_NUM_OF_PDR-1]);
+    pdr[2] = ogs_pfcp_pdr_add(&sess[0]);
+    ABTS_INT_EQUAL(tc, 3, pdr[2]->id);
+    pdr[OGS_MAX_NUM_OF_PDR-1] = ogs_pfcp_pdr_add(&sess[0]);
+    ABTS_INT_EQUAL(tc, OGS_MAX_NUM_OF_PDR, pdr[OGS_MAX_NUM_OF_PDR-1]->id);
+
+    /* The ID given by the peer does not leak the local one */
+    pdr[0]->id = 1000;
+    ogs_pfcp_pdr_remove(pdr[0]);
+    pdr[0] = ogs_pfcp_pdr_add(&sess[0]);
+    ABTS_INT_EQUAL(tc, 1, pdr[0]->id);
+
+    flow = ogs_pfcp_pdr_flow_add(pdr[1]);
+    ABTS_PTR_NOTNULL(tc, flow);
+    flow->fd = 1;
+    flow->description = (char *)"permit out ip from any to assigned";
+    ABTS_INT_EQUAL(tc, 1, pdr[1]->num_of_flow);
+    ABTS_PTR_EQUAL(tc, flow, &pdr[1]->flow[0]);
+
+    ogs_pfcp_sess_clear(&sess[0]);
+    ABTS_INT_EQUAL(tc, 0, sess[0].pdr_id.used);
+    ogs_pfcp_pool_final(&sess[0]);
+}
+
+static void pfcp_context_test3(abts_case *tc, void *data)
+{
+    ogs_pfcp_fq_csid_t fq_csid, parsed;
+    ogs_tlv_octet_t octet;
+    char buf[OGS_PFCP_MAX_FQ_CSID_LEN];
+    uint16_t csid;
+    int i;
+
+    memset(&fq_csid, 0, sizeof(fq_csid));
+    fq_csid.node_id_type = OGS_PFCP_FQ_CSID_NODE_ID_IPV4;
+    fq_csid.addr = htobe32(0x0a000001);
+    fq_csid.csid[fq_csid.num_of_csid++] = 1;
+    fq_csid.csid[fq_csid.num_of_csid++] = 0x1234;
+
+    ABTS_INT_EQUAL(tc, 9,
+            ogs_pfcp_build_fq_csid(&octet, &fq_csid, buf, sizeof(buf)));
+    ABTS_INT_EQUAL(tc, 0x02, buf[0]);
+    ABTS_INT_EQUAL(tc, 0x12, buf[7]);
+    ABTS_INT_EQUAL(tc, 0x34, buf[8]);
+
+    ABTS_INT_EQUAL(tc, 9, ogs_pfcp_parse_fq_csid(&parsed, &octet));
+    ABTS_INT_EQUAL(tc, OGS_PFCP_FQ_CSID_NODE_ID_IPV4, parsed.node_id_type);
+    ABTS_INT_EQUAL(tc, fq_csid.addr, parsed.addr);
+    ABTS_INT_EQUAL(tc, 2, parsed.num_of_csid);
+    ABTS_TRUE(tc, ogs_pfcp_fq_csid_match(&parsed, 0x1234));
+    ABTS_TRUE(tc, !ogs_pfcp_fq_csid_match(&parsed, 2));
+
+    /* A truncated FQ-CSID is not decoded */
+    octet.len = 7;
+    ABTS_INT_EQUAL(tc, 0, ogs_pfcp_parse_fq_csid(&parsed, &octet));
+
+    /* CSID 0 is never handed out */
+    for (i = 0; i <= 0xffff; i++) {
+        csid = ogs_pfcp_csid_next();
+        if (csid == 0)
+            break;
+    }
+    ABTS_INT_EQUAL(tc, 0x10000, i);
+}
+
+static void get_xact_stat(const ogs_hash_stat_t *stat, void *data)
+{
+    if (strcmp(stat->name, "pfcp_xact") == 0)
+        memcpy(data, stat, sizeof(*stat));
+}
+
+static ogs_pfcp_xact_t *receive(ogs_pfcp_node_t *node,
+        uint8_t type, uint32_t xid, int expected)
+{
+    ogs_pfcp_header_t h;
+    ogs_pfcp_xact_t *xact = NULL;
+
+    memset(&h, 0, sizeof(h));
+    h.type = type;
+    h.sqn = OGS_PFCP_XID_TO_SQN(xid);
+
+    ogs_assert(ogs_pfcp_xact_receive(node, &h, &xact) == expected);
+    return xact;
+}
+
+static void pfcp_context_test4(abts_case *tc, void *data)
+{
+    ogs_sockaddr_t *addr = NULL;
+    ogs_pfcp_node_t *node1 = NULL, *node2 = NULL;
+    ogs_pfcp_xact_t *local = NULL, *remote1 = NULL, *remote2 = NULL, *xact;
+    ogs_pfcp_header_t h;
+    ogs_pkbuf_t *pkbuf = NULL;
+    ogs_hash_stat_t stat;
+    uint64_t lookups, hits;
+    int timer_mgr = 0;
+
+    if (!ogs_app()->timer_mgr) {
+        ogs_app()->timer_mgr = ogs_timer_mgr_create(64);
+        timer_mgr = 1;
+    }
+    if (!ogs_local_conf()->time.message.pfcp.t1_holding_duration) {
+        ogs_local_conf()->time.message.pfcp.t1_response_duration =
+            ogs_time_from_sec(3);
+        ogs_local_conf()->time.message.pfcp.t1_holding_duration =
+            ogs_time_from_sec(9);
+    }
+    ogs_app()->pool.xact = 16;
+    ogs_pfcp_xact_init();
+
+    ABTS_INT_EQUAL(tc, OGS_OK,
+            ogs_getaddrinfo(&addr, AF_INET, "127.0.0.2", OGS_PFCP_UDP_PORT, 0));
+    node1 = ogs_pfcp_node_new(addr);
+    ABTS_PTR_NOTNULL(tc, node1);
+    memcpy(&node1->addr, addr, sizeof(node1->addr));
+    ABTS_INT_EQUAL(tc, OGS_OK,
+            ogs_getaddrinfo(&addr, AF_INET, "127.0.0.3", OGS_PFCP_UDP_PORT, 0));
+    node2 = ogs_pfcp_node_new(addr);
+    ABTS_PTR_NOTNULL(tc, node2);
+    memcpy(&node2->addr, addr, sizeof(node2->addr));
+
+    memset(&stat, 0, sizeof(stat));
+    ogs_hash_stat_all(get_xact_stat, &stat);
+    ABTS_STR_EQUAL(tc, "pfcp_xact", stat.name);
+    ABTS_INT_EQUAL(tc, 0, stat.count);
+    lookups = stat.lookups;
+    hits = stat.hits;
+
+    /* A response finds the local transaction by its xid */
+    local = ogs_pfcp_xact_local_create(node1, NULL, NULL);
+    ABTS_PTR_NOTNULL(tc, local);
+    memset(&h, 0, sizeof(h));
+    h.type = OGS_PFCP_HEARTBEAT_REQUEST_TYPE;
+    pkbuf = ogs_pkbuf_alloc(NULL, OGS_PFCP_HEADER_LEN + 8);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_reserve(pkbuf, OGS_PFCP_HEADER_LEN);
+    ogs_pkbuf_put(pkbuf, 8);
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_pfcp_xact_update_tx(local, &h, pkbuf));
+
+    xact = receive(node1,
+            OGS_PFCP_HEARTBEAT_RESPONSE_TYPE, local->xid, OGS_OK);
+    ABTS_PTR_EQUAL(tc, local, xact);
+
+    /* The same xid from the peer or from another node is another key */
+    remote1 = receive(node1,
+            OGS_PFCP_HEARTBEAT_REQUEST_TYPE, local->xid, OGS_OK);
+    ABTS_PTR_NOTNULL(tc, remote1);
+    ABTS_TRUE(tc, remote1 != local);
+    remote2 = receive(node2,
+            OGS_PFCP_HEARTBEAT_REQUEST_TYPE, local->xid, OGS_OK);
+    ABTS_PTR_NOTNULL(tc, remote2);
+    ABTS_TRUE(tc, remote2 != remote1);
+
+    /* A retransmitted request finds the transaction it started */
+    xact = receive(node2,
+            OGS_PFCP_HEARTBEAT_REQUEST_TYPE, local->xid, OGS_RETRY);
+    ABTS_PTR_EQUAL(tc, NULL, xact);
+    ABTS_INT_EQUAL(tc, 1, node2->xact_stats.duplicated);
+
+    ogs_hash_stat_all(get_xact_stat, &stat);
+    ABTS_INT_EQUAL(tc, 3, stat.count);
+    ABTS_INT_EQUAL(tc, 4, stat.lookups - lookups);
+    ABTS_INT_EQUAL(tc, 2, stat.hits - hits);
+    ABTS_INT_EQUAL(tc, 0, stat.replaced);
+
+    /* Removal only drops its own entry */
+    ogs_pfcp_xact_delete(remote2);
+    ogs_hash_stat_all(get_xact_stat, &stat);
+    ABTS_INT_EQUAL(tc, 2, stat.count);
+    ABTS_INT_EQUAL(tc, 0, node2->xact_stats.remote);
+
+    lookups = stat.lookups;
+    hits = stat.hits;
+    remote2 = receive(node2,
+            OGS_PFCP_HEARTBEAT_REQUEST_TYPE, local->xid, OGS_OK);
+    ABTS_PTR_NOTNULL(tc, remote2);
+    ogs_hash_stat_all(get_xact_stat, &stat);
+    ABTS_INT_EQUAL(tc, 1, stat.lookups - lookups);
+    ABTS_INT_EQUAL(tc, 0, stat.hits - hits);
+    ABTS_INT_EQUAL(tc, 3, stat.count);
+
+    ogs_pfcp_node_free(node1);
+    ogs_pfcp_node_free(node2);
+
+    ogs_hash_stat_all(get_xact_stat, &stat);
+    ABTS_INT_EQUAL(tc, 0, stat.count);
+
+    ogs_pfcp_xact_final();
+    if (timer_mgr) {
+        ogs_timer_mgr_destroy(ogs_app()->timer_mgr);
+        ogs_app()->timer_mgr = NULL;
+    }
+}
+
+#define NUM_OF_TEST_UE_IP (OGS_PFCP_UE_IP_CHUNK_BITS * 2 + 100)
+
+static ogs_pfcp_ue_ip_t *ue_ip[NUM_OF_TEST_UE_IP+1];
+
+static void pfcp_context_test5(abts_case *tc, void *data)
+{
+    ogs_pfcp_subnet_t *subnet = NULL, *subnet6 = NULL;
+    ogs_pfcp_ue_ip_t *static_ip = NULL, *ip6 = NULL;
+    uint8_t cause_value;
+    uint8_t addr[16];
+    uint32_t expected;
+    int pool_sess = ogs_app()->pool.sess;
+    int i;
+
+    subnet = ogs_pfcp_subnet_add("10.45.0.1", "16", NULL, "test", "ogstun");
+    ABTS_PTR_NOTNULL(tc, subnet);
+    subnet6 = ogs_pfcp_subnet_add(
+            "2001:db8:cafe::1", "48", NULL, "test", "ogstun");
+    ABTS_PTR_NOTNULL(tc, subnet6);
+
+    ogs_app()->pool.sess = NUM_OF_TEST_UE_IP;
+    ogs_pfcp_ue_pool_generate();
+    ogs_app()->pool.sess = pool_sess;
+
+    /* Only the chunk holding the network/gateway addresses is allocated */
+    ABTS_INT_EQUAL(tc, NUM_OF_TEST_UE_IP, subnet->pool.capacity);
+    ABTS_INT_EQUAL(tc, NUM_OF_TEST_UE_IP, subnet->pool.avail);
+    ABTS_INT_EQUAL(tc, 3, subnet->pool.num_of_chunk);
+    ABTS_PTR_NOTNULL(tc, subnet->pool.chunk[0]);
+    ABTS_PTR_EQUAL(tc, NULL, subnet->pool.chunk[1]);
+    ABTS_PTR_EQUAL(tc, NULL, subnet->pool.chunk[2]);
+
+    /* Dynamic addresses skip the network and gateway addresses */
+    memset(addr, 0, sizeof(addr));
+    for (i = 0; i < NUM_OF_TEST_UE_IP; i++) {
+        ue_ip[i] = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET, "test", addr);
+        ABTS_PTR_NOTNULL(tc, ue_ip[i]);
+        ABTS_PTR_EQUAL(tc, subnet, ue_ip[i]->subnet);
+        ABTS_TRUE(tc, ue_ip[i]->static_ip == false);
+        ABTS_INT_EQUAL(tc, 0x0a2d0002 + i, be32toh(ue_ip[i]->addr[0]));
+    }
+    ABTS_INT_EQUAL(tc, 0, subnet->pool.avail);
+    ABTS_TRUE(tc, (subnet->pool.chunk_full[0] & 0x7) == 0x7);
+
+    /* Exhaustion */
+    cause_value = 0;
+    ue_ip[i] = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET, "test", addr);
+    ABTS_PTR_EQUAL(tc, NULL, ue_ip[i]);
+    ABTS_INT_EQUAL(tc, OGS_PFCP_CAUSE_NO_RESOURCES_AVAILABLE, cause_value);
+
+    /* A freed address is handed out again */
+    expected = be32toh(ue_ip[5000]->addr[0]);
+    ogs_pfcp_ue_ip_free(ue_ip[5000]);
+    ABTS_INT_EQUAL(tc, 1, subnet->pool.avail);
+    ABTS_TRUE(tc, (subnet->pool.chunk_full[0] & 0x2) == 0);
+    ue_ip[5000] = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET, "test", addr);
+    ABTS_PTR_NOTNULL(tc, ue_ip[5000]);
+    ABTS_INT_EQUAL(tc, expected, be32toh(ue_ip[5000]->addr[0]));
+
+    /* A static address in the range takes its bit */
+    ogs_pfcp_ue_ip_free(ue_ip[100]);
+    memset(addr, 0, sizeof(addr));
+    *(uint32_t *)addr = ue_ip[100 - 1]->addr[0];
+    static_ip = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET, "test", addr);
+    ABTS_PTR_EQUAL(tc, NULL, static_ip);
+    ABTS_INT_EQUAL(tc, OGS_PFCP_CAUSE_REQUEST_REJECTED, cause_value);
+
+    *(uint32_t *)addr = htobe32(0x0a2d0002 + 100);
+    ue_ip[100] = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET, "test", addr);
+    ABTS_PTR_NOTNULL(tc, ue_ip[100]);
+    ABTS_TRUE(tc, ue_ip[100]->static_ip == true);
+    ABTS_INT_EQUAL(tc, 100 + 2, ue_ip[100]->index);
+    ABTS_INT_EQUAL(tc, 0, subnet->pool.avail);
+
+    static_ip = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET, "test", addr);
+    ABTS_PTR_EQUAL(tc, NULL, static_ip);
+    ABTS_INT_EQUAL(tc, OGS_PFCP_CAUSE_REQUEST_REJECTED, cause_value);
+
+    /* A static address out of the range does not use the bitmap */
+    *(uint32_t *)addr = htobe32(0x0a2dff01);
+    static_ip = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET, "test", addr);
+    ABTS_PTR_NOTNULL(tc, static_ip);
+    ABTS_INT_EQUAL(tc, OGS_PFCP_UE_IP_NO_INDEX, static_ip->index);
+    ABTS_INT_EQUAL(tc, 1, subnet->pool.num_of_static);
+    ABTS_PTR_EQUAL(tc, NULL,
+            ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET, "test", addr));
+    ABTS_INT_EQUAL(tc, OGS_PFCP_CAUSE_REQUEST_REJECTED, cause_value);
+    ogs_pfcp_ue_ip_free(static_ip);
+    ABTS_INT_EQUAL(tc, 0, subnet->pool.num_of_static);
+    static_ip = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET, "test", addr);
+    ABTS_PTR_NOTNULL(tc, static_ip);
+    ogs_pfcp_ue_ip_free(static_ip);
+
+    /* An emptied chunk is given back */
+    for (i = OGS_PFCP_UE_IP_CHUNK_BITS; i < OGS_PFCP_UE_IP_CHUNK_BITS * 2; i++)
+        ogs_pfcp_ue_ip_free(ue_ip[i - 2]);
+    ABTS_PTR_EQUAL(tc, NULL, subnet->pool.chunk[1]);
+    ABTS_INT_EQUAL(tc, OGS_PFCP_UE_IP_CHUNK_BITS, subnet->pool.avail);
+
+    for (i = 0; i < NUM_OF_TEST_UE_IP; i++) {
+        if (i >= OGS_PFCP_UE_IP_CHUNK_BITS - 2 &&
+            i < OGS_PFCP_UE_IP_CHUNK_BITS * 2 - 2)
+            continue;
+        ogs_pfcp_ue_ip_free(ue_ip[i]);
+    }
+    ABTS_INT_EQUAL(tc, NUM_OF_TEST_UE_IP, subnet->pool.avail);
+    ABTS_PTR_EQUAL(tc, NULL, subnet->pool.chunk[2]);
+
+    /* IPv6 hands out a /64 prefix per address */
+    memset(addr, 0, sizeof(addr));
+    ip6 = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET6, "test", addr);
+    ABTS_PTR_NOTNULL(tc, ip6);
+    ABTS_PTR_EQUAL(tc, subnet6, ip6->subnet);
+    ABTS_INT_EQUAL(tc, 0x20010db8, be32toh(ip6->addr[0]));
+    ABTS_INT_EQUAL(tc, 0xcafe0001, be32toh(ip6->addr[1]));
+    ogs_pfcp_ue_ip_free(ip6);
+
+    ogs_pfcp_subnet_remove(subnet);
+    ogs_pfcp_subnet_remove(subnet6);
+    ogs_pfcp_dev_remove_all();
+}
+
+static ogs_pkbuf_t *buffer_packet(unsigned int size, unsigned int len)
+{
+    ogs_pkbuf_t *pkbuf = ogs_pkbuf_alloc(NULL, size);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put(pkbuf, len);
+    memset(pkbuf->data, len & 0xff, len);
+
+    return pkbuf;
+}
+
+static void pfcp_context_test6(abts_case *tc, void *data)
+{
+    ogs_pfcp_far_t *far[2];
+    ogs_pfcp_bar_t *bar = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+    uint64_t max_bytes = ogs_pfcp_self()->buffer.max_bytes;
+    uint32_t session_bytes = ogs_pfcp_self()->buffer.session_bytes;
+    uint32_t session_packets = ogs_pfcp_self()->buffer.session_packets;
+    ogs_time_t duration = ogs_pfcp_self()->buffer.duration;
+    uint64_t dropped = ogs_pfcp_self()->buffer.dropped;
+    uint64_t expired = ogs_pfcp_self()->buffer.expired;
+    bool clustered;
+    int i;
+
+    ogs_pfcp_self()->buffer.max_bytes = 1500;
+    ogs_pfcp_self()->buffer.session_bytes = 1000;
+    ogs_pfcp_self()->buffer.session_packets = 4;
+    ogs_pfcp_self()->buffer.duration = ogs_time_from_sec(30);
+
+    for (i = 0; i < 2; i++) {
+        ogs_pfcp_pool_init(&sess[i]);
+        far[i] = ogs_pfcp_far_add(&sess[i]);
+        ABTS_PTR_NOTNULL(tc, far[i]);
+    }
+
+    /* The per-session packet limit applies without a BAR */
+    for (i = 0; i < 4; i++)
+        ABTS_TRUE(tc, ogs_pfcp_far_buffer_push(far[0], buffer_packet(128, 100)));
+    ABTS_TRUE(tc, !ogs_pfcp_far_buffer_push(far[0], buffer_packet(128, 100)));
+    ABTS_INT_EQUAL(tc, 4, far[0]->num_of_buffered_packet);
+    ABTS_INT_EQUAL(tc, 400, far[0]->buffered_bytes);
+    ABTS_INT_EQUAL(tc, 4, sess[0].buffer.packets);
+    ABTS_INT_EQUAL(tc, dropped + 1, ogs_pfcp_self()->buffer.dropped);
+
+    /* The Suggested Buffering Packets Count of the BAR takes over */
+    bar = ogs_pfcp_bar_new(&sess[0]);
+    ABTS_PTR_NOTNULL(tc, bar);
+    bar->suggested_buffering_packets_count = 6;
+    ABTS_TRUE(tc, ogs_pfcp_far_buffer_push(far[0], buffer_packet(128, 100)));
+    ABTS_TRUE(tc, ogs_pfcp_far_buffer_push(far[0], buffer_packet(128, 100)));
+    ABTS_TRUE(tc, !ogs_pfcp_far_buffer_push(far[0], buffer_packet(128, 100)));
+    ABTS_INT_EQUAL(tc, 6, far[0]->num_of_buffered_packet);
+
+    /* The per-session byte limit */
+    bar->suggested_buffering_packets_count = 100;
+    ABTS_TRUE(tc, !ogs_pfcp_far_buffer_push(far[0], buffer_packet(512, 401)));
+    ABTS_TRUE(tc, ogs_pfcp_far_buffer_push(far[0], buffer_packet(512, 400)));
+    ABTS_INT_EQUAL(tc, 1000, sess[0].buffer.bytes);
+    ABTS_INT_EQUAL(tc, dropped + 3, ogs_pfcp_self()->buffer.dropped);
+
+    /* The budget shared by all sessions */
+    ABTS_TRUE(tc, ogs_pfcp_far_buffer_push(far[1], buffer_packet(1024, 500)));
+    ABTS_TRUE(tc, !ogs_pfcp_far_buffer_push(far[1], buffer_packet(128, 1)));
+    ABTS_INT_EQUAL(tc, 1500, ogs_pfcp_self()->buffer.bytes);
+    ABTS_INT_EQUAL(tc, 8, ogs_pfcp_self()->buffer.packets);
+    ABTS_INT_EQUAL(tc, dropped + 4, ogs_pfcp_self()->buffer.dropped);
+
+    /* A packet in a large cluster is copied into a smaller one */
+    pkbuf = ogs_pfcp_far_buffer_pop(far[1]);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    ogs_pkbuf_free(pkbuf);
+    pkbuf = buffer_packet(8192, 100);
+    clustered = pkbuf->cluster != NULL;
+    ABTS_TRUE(tc, ogs_pfcp_far_buffer_push(far[1], pkbuf));
+    pkbuf = ogs_list_first(&far[1]->buffered_list);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    ABTS_INT_EQUAL(tc, 100, pkbuf->len);
+    if (clustered) {
+        ABTS_TRUE(tc, pkbuf->end - pkbuf->head < 8192);
+        ABTS_TRUE(tc,
+                ogs_pkbuf_headroom(pkbuf) >= OGS_GTPV1U_5GC_HEADER_LEN);
+    }
+
+    /* Packets come out in arrival order */
+    pkbuf = ogs_pfcp_far_buffer_pop(far[0]);
+    ABTS_INT_EQUAL(tc, 100, pkbuf->len);
+    ogs_pkbuf_free(pkbuf);
+    for (i = 0; i < 5; i++) {
+        pkbuf = ogs_pfcp_far_buffer_pop(far[0]);
+        ogs_pkbuf_free(pkbuf);
+    }
+    pkbuf = ogs_pfcp_far_buffer_pop(far[0]);
+    ABTS_INT_EQUAL(tc, 400, pkbuf->len);
+    ogs_pkbuf_free(pkbuf);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pfcp_far_buffer_pop(far[0]));
+    ABTS_INT_EQUAL(tc, 0, sess[0].buffer.packets);
+    ABTS_INT_EQUAL(tc, 0, sess[0].buffer.bytes);
+
+    /* Packets older than the buffering duration are discarded */
+    ogs_pfcp_far_buffer_expire(far[1], ogs_get_monotonic_time());
+    ABTS_INT_EQUAL(tc, 1, far[1]->num_of_buffered_packet);
+    ogs_pfcp_far_buffer_expire(far[1], ogs_get_monotonic_time() +
+            ogs_pfcp_self()->buffer.duration + 1);
+    ABTS_INT_EQUAL(tc, 0, far[1]->num_of_buffered_packet);
+    ABTS_INT_EQUAL(tc, expired + 1, ogs_pfcp_self()->buffer.expired);
+
+    ABTS_TRUE(tc, ogs_pfcp_far_buffer_push(far[1], buffer_packet(128, 10)));
+    for (i = 0; i < 2; i++) {
+        ogs_pfcp_sess_clear(&sess[i]);
+        ogs_pfcp_pool_final(&sess[i]);
+    }
+    ABTS_INT_EQUAL(tc, 0, ogs_pfcp_self()->buffer.bytes);
+    ABTS_INT_EQUAL(tc, 0, ogs_pfcp_self()->buffer.packets);
+
+    ogs_pfcp_self()->buffer.max_bytes = max_bytes;
+    ogs_pfcp_self()->buffer.session_bytes = session_bytes;
+    ogs_pfcp_self()->buffer.session_packets = session_packets;
+    ogs_pfcp_self()->buffer.duration = duration;
+}
+
+static ogs_pfcp_session_report_request_t *report_round_trip(
+        ogs_pfcp_node_t *node, ogs_pkbuf_t **pkbuf,
+        ogs_pfcp_message_t **message)
+{
+    ogs_pfcp_user_plane_report_t report;
+    ogs_pfcp_header_t *h = NULL;
+
+    memset(&report, 0, sizeof(report));
+    *pkbuf = ogs_pfcp_build_session_report_request(
+            OGS_PFCP_SESSION_REPORT_REQUEST_TYPE, node, &report);
+    ogs_assert(*pkbuf);
+
+    h = ogs_pkbuf_push(*pkbuf, OGS_PFCP_HEADER_LEN);
+    ogs_assert(h);
+    memset(h, 0, OGS_PFCP_HEADER_LEN);
+    h->seid_presence = 1;
+    h->type = OGS_PFCP_SESSION_REPORT_REQUEST_TYPE;
+
+    /* The parsed IEs point into the packet */
+    *message = ogs_pfcp_parse_msg(*pkbuf);
+    ogs_assert(*message);
+
+    return &(*message)->pfcp_session_report_request;
+}
+
+static void pfcp_context_test7(abts_case *tc, void *data)
+{
+    ogs_pfcp_context_t saved = *ogs_pfcp_self();
+    ogs_sockaddr_t *addr = NULL;
+    ogs_pfcp_node_t *up = NULL, *cp = NULL;
+    ogs_pfcp_session_report_request_t *req = NULL;
+    ogs_pfcp_message_t *message = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+    ogs_time_t now;
+
+    /* Timer IE units */
+    ABTS_INT_EQUAL(tc, 60, ogs_pfcp_timer_to_sec(ogs_pfcp_timer_from_sec(60)));
+    ABTS_INT_EQUAL(tc, (2 << 5) | 6, ogs_pfcp_timer_from_sec(3600));
+    ABTS_INT_EQUAL(tc, 3600,
+            ogs_pfcp_timer_to_sec(ogs_pfcp_timer_from_sec(3600)));
+    ABTS_INT_EQUAL(tc, 7 << 5,
+            ogs_pfcp_timer_from_sec(OGS_PFCP_TIMER_INFINITE));
+    ABTS_TRUE(tc, ogs_pfcp_timer_to_sec(7 << 5) == OGS_PFCP_TIMER_INFINITE);
+    ABTS_INT_EQUAL(tc, 3 * 60, ogs_pfcp_timer_to_sec((5 << 5) | 3));
+
+    /* 'up' is the SMF seen from the UPF, 'cp' the UPF seen from the SMF */
+    ABTS_INT_EQUAL(tc, OGS_OK,
+            ogs_getaddrinfo(&addr, AF_INET, "127.0.0.4", OGS_PFCP_UDP_PORT, 0));
+    up = ogs_pfcp_node_new(addr);
+    ABTS_PTR_NOTNULL(tc, up);
+    ABTS_INT_EQUAL(tc, OGS_OK,
+            ogs_getaddrinfo(&addr, AF_INET, "127.0.0.5", OGS_PFCP_UDP_PORT, 0));
+    cp = ogs_pfcp_node_new(addr);
+    ABTS_PTR_NOTNULL(tc, cp);
+
+    ogs_pfcp_self()->cp_function_features.load = 1;
+    ogs_pfcp_self()->cp_function_features.ovrl = 1;
+    ogs_pfcp_self()->load.sequence = 0;
+    ogs_pfcp_self()->overload.sequence = 0;
+
+    /* Nothing is advertised before the first sample */
+    req = report_round_trip(up, &pkbuf, &message);
+    ABTS_INT_EQUAL(tc, 0, req->load_control_information.presence);
+    ABTS_INT_EQUAL(tc, 0, req->overload_control_information.presence);
+    ogs_pfcp_message_free(message);
+    ogs_pkbuf_free(pkbuf);
+
+    ogs_pfcp_self()->load.sequence = 5;
+    ogs_pfcp_self()->load.metric = 40;
+    ogs_pfcp_self()->overload.sequence = 3;
+    ogs_pfcp_self()->overload.reduction = 30;
+    ogs_pfcp_self()->overload.validity = ogs_time_from_sec(60);
+
+    now = ogs_get_monotonic_time();
+    req = report_round_trip(up, &pkbuf, &message);
+    ABTS_INT_EQUAL(tc, 1, req->load_control_information.presence);
+    ABTS_INT_EQUAL(tc, 1, req->overload_control_information.presence);
+    ABTS_INT_EQUAL(tc, 1,
+            req->overload_control_information.
+                overload_control_information_flags.presence);
+    ogs_pfcp_cp_handle_load_control_information(
+            cp, &req->load_control_information);
+    ogs_pfcp_cp_handle_overload_control_information(
+            cp, &req->overload_control_information);
+    ogs_pfcp_message_free(message);
+    ogs_pkbuf_free(pkbuf);
+
+    ABTS_INT_EQUAL(tc, 5, cp->load.sequence);
+    ABTS_INT_EQUAL(tc, 40, cp->load.metric);
+    ABTS_INT_EQUAL(tc, 3, cp->overload.sequence);
+    ABTS_INT_EQUAL(tc, 30, cp->overload.reduction);
+    ABTS_TRUE(tc, cp->overload.expires >= now + ogs_time_from_sec(60));
+    ABTS_TRUE(tc, ogs_pfcp_node_overloaded(cp));
+
+    /* A sequence number the peer has seen is not sent again */
+    req = report_round_trip(up, &pkbuf, &message);
+    ABTS_INT_EQUAL(tc, 0, req->load_control_information.presence);
+    ABTS_INT_EQUAL(tc, 0, req->overload_control_information.presence);
+    ogs_pfcp_message_free(message);
+    ogs_pkbuf_free(pkbuf);
+
+    /* The SMF discards information older than what it has */
+    ogs_pfcp_self()->load.sequence = 4;
+    ogs_pfcp_self()->load.metric = 90;
+    req = report_round_trip(up, &pkbuf, &message);
+    ABTS_INT_EQUAL(tc, 1, req->load_control_information.presence);
+    ogs_pfcp_cp_handle_load_control_information(
+            cp, &req->load_control_information);
+    ogs_pfcp_message_free(message);
+    ogs_pkbuf_free(pkbuf);
+    ABTS_INT_EQUAL(tc, 5, cp->load.sequence);
+    ABTS_INT_EQUAL(tc, 40, cp->load.metric);
+
+    /* A zero Overload Reduction Metric ends the overload */
+    ogs_pfcp_self()->overload.sequence = 4;
+    ogs_pfcp_self()->overload.reduction = 0;
+    req = report_round_trip(up, &pkbuf, &message);
+    ABTS_INT_EQUAL(tc, 1, req->overload_control_information.presence);
+    ogs_pfcp_cp_handle_overload_control_information(
+            cp, &req->overload_control_information);
+    ogs_pfcp_message_free(message);
+    ogs_pkbuf_free(pkbuf);
+    ABTS_INT_EQUAL(tc, 4, cp->overload.sequence);
+    ABTS_TRUE(tc, cp->overload.expires == 0);
+    ABTS_TRUE(tc, !ogs_pfcp_node_overloaded(cp));
+
+    /* Nothing is sent to a peer without the LOAD/OVRL features */
+    ogs_pfcp_self()->cp_function_features.load = 0;
+    ogs_pfcp_self()->cp_function_features.ovrl = 0;
+    ogs_pfcp_self()->load.sequence = 6;
+    ogs_pfcp_self()->overload.sequence = 5;
+    req = report_round_trip(up, &pkbuf, &message);
+    ABTS_INT_EQUAL(tc, 0, req->load_control_information.presence);
+    ABTS_INT_EQUAL(tc, 0, req->overload_control_information.presence);
+    ogs_pfcp_message_free(message);
+    ogs_pkbuf_free(pkbuf);
+
+    ogs_pfcp_node_free(up);
+    ogs_pfcp_node_free(cp);
+
+    ogs_pfcp_self()->cp_function_features = saved.cp_function_features;
+    ogs_pfcp_self()->load = saved.load;
+    ogs_pfcp_self()->overload = saved.overload;
+}
+
+#define NUM_OF_TEST_NODE 3
+
+static ogs_pfcp_node_t *select_node(ogs_pfcp_node_t **node, int num)
+{
+    ogs_pfcp_node_rr_t rr;
+    int i;
+
+    memset(&rr, 0, sizeof(rr));
+    for (i = 0; i < num; i++)
+        if (!ogs_pfcp_node_throttled(node[i]))
+            ogs_pfcp_node_rr_offer(&rr, node[i]);
+
+    return ogs_pfcp_node_rr_select(&rr);
+}
+
+static void pfcp_context_test8(abts_case *tc, void *data)
+{
+    ogs_sockaddr_t *addr = NULL;
+    ogs_pfcp_node_t *node[NUM_OF_TEST_NODE];
+    int count[NUM_OF_TEST_NODE];
+    char host[OGS_ADDRSTRLEN];
+    int i, j;
+
+    for (i = 0; i < NUM_OF_TEST_NODE; i++) {
+        ogs_snprintf(host, sizeof(host), "127.0.1.%d", i + 1);
+        ABTS_INT_EQUAL(tc, OGS_OK,
+                ogs_getaddrinfo(&addr, AF_INET, host, OGS_PFCP_UDP_PORT, 0));
+        node[i] = ogs_pfcp_node_new(addr);
+        ABTS_PTR_NOTNULL(tc, node[i]);
+    }
+
+    /* Equal weights are visited in turn */
+    for (i = 0; i < NUM_OF_TEST_NODE * 2; i++)
+        ABTS_PTR_EQUAL(tc, node[i % NUM_OF_TEST_NODE],
+                select_node(node, NUM_OF_TEST_NODE));
+
+    /* The share follows the headroom left by the Load Metric */
+    for (i = 0; i < NUM_OF_TEST_NODE; i++)
+        node[i]->weight = 0;
+    node[1]->load.metric = 50;
+    node[2]->load.metric = 100;
+    memset(count, 0, sizeof(count));
+    for (i = 0; i < 101 + 51 + 1; i++) {
+        ogs_pfcp_node_t *selected = select_node(node, NUM_OF_TEST_NODE);
+        for (j = 0; j < NUM_OF_TEST_NODE; j++)
+            if (selected == node[j])
+                count[j]++;
+    }
+    ABTS_INT_EQUAL(tc, 101, count[0]);
+    ABTS_INT_EQUAL(tc, 51, count[1]);
+    ABTS_INT_EQUAL(tc, 1, count[2]);
+
+    /* ... and the configured capacity */
+    for (i = 0; i < NUM_OF_TEST_NODE; i++) {
+        node[i]->weight = 0;
+        node[i]->load.metric = 0;
+    }
+    node[0]->capacity = 300;
+    memset(count, 0, sizeof(count));
+    for (i = 0; i < 5; i++) {
+        ogs_pfcp_node_t *selected = select_node(node, NUM_OF_TEST_NODE);
+        for (j = 0; j < NUM_OF_TEST_NODE; j++)
+            if (selected == node[j])
+                count[j]++;
+    }
+    ABTS_INT_EQUAL(tc, 3, count[0]);
+    ABTS_INT_EQUAL(tc, 1, count[1]);
+    ABTS_INT_EQUAL(tc, 1, count[2]);
+    node[0]->capacity = OGS_PFCP_DEFAULT_CAPACITY;
+
+    /* A full Overload Reduction Metric turns away every new session */
+    node[0]->overload.reduction = 100;
+    node[0]->overload.expires = OGS_INFINITE_TIME;
+    for (i = 0; i < 10; i++) {
+        ABTS_TRUE(tc, ogs_pfcp_node_throttled(node[0]));
+        ABTS_TRUE(tc, select_node(node, NUM_OF_TEST_NODE) != node[0]);
+    }
+    ABTS_PTR_EQUAL(tc, NULL, select_node(node, 1));
+
+    /* ... until its Period-Of-Validity runs out */
+    node[0]->overload.expires = ogs_get_monotonic_time() - 1;
+    ABTS_TRUE(tc, !ogs_pfcp_node_throttled(node[0]));
+    ABTS_TRUE(tc, node[0]->overload.expires == 0);
+    ABTS_PTR_EQUAL(tc, node[0], select_node(node, 1));
+
+    /* A zero metric never throttles */
+    node[0]->overload.reduction = 0;
+    node[0]->overload.expires = OGS_INFINITE_TIME;
+    ABTS_TRUE(tc, !ogs_pfcp_node_overloaded(node[0]));
+
+    for (i = 0; i < NUM_OF_TEST_NODE; i++)
+        ogs_pfcp_node_free(node[i]);
+}
+
+#define TEST_SUBNET_A \
+    "    - subnet: 10.45.0.0/16\n" \
+    "      gateway: 10.45.0.1\n" \
+    "      dnn: a\n" \
+    "      dev: ogstun\n"
+#define TEST_SUBNET_C \
+    "    - subnet: 10.47.0.0/16\n" \
+    "      gateway: 10.47.0.1\n" \
+    "      dnn: c\n" \
+    "      dev: ogstun\n"
+#define TEST_SUBNET_D \
+    "    - subnet: 10.48.0.0/16\n" \
+    "      gateway: 10.48.0.1\n" \
+    "      dnn: d\n" \
+    "      dev: ogstun9\n"
+
+static int setup_calls;
+static const char *setup_refused;
+
+static int setup_subnet(ogs_pfcp_subnet_t *subnet)
+{
+    setup_calls++;
+
+    if (setup_refused && !strcmp(subnet->dnn, setup_refused))
+        return OGS_ERROR;
+
+    return OGS_OK;
+}
+
+static int reload_subnet(const char *session)
+{
+    char path[] = "/tmp/pfcp-context-test-XXXXXX";
+    char *text = NULL;
+    void *document = ogs_app()->document;
+    int fd, rv;
+
+    fd = mkstemp(path);
+    ogs_assert(fd >= 0);
+    if (session)
+        text = ogs_msprintf("upf:\n  session:\n%s", session);
+    else
+        text = ogs_msprintf("upf:\n  time: {}\n");
+    ogs_assert(text);
+    ogs_assert(write(fd, text, strlen(text)) == strlen(text));
+    close(fd);
+    ogs_free(text);
+
+    ogs_app()->document = ogs_yaml_document_load(path);
+    ogs_assert(ogs_app()->document);
+    unlink(path);
+
+    rv = ogs_pfcp_context_reload_subnet("upf", setup_subnet);
+
+    ogs_yaml_document_free(ogs_app()->document);
+    ogs_app()->document = document;
+
+    return rv;
+}
+
+static void pfcp_context_test9(abts_case *tc, void *data)
+{
+    ogs_pfcp_subnet_t *a = NULL, *b = NULL, *c = NULL;
+    ogs_pfcp_ue_ip_t *ip = NULL;
+    ogs_pfcp_dev_t *dev = NULL;
+    uint8_t cause_value;
+    uint8_t addr[16];
+
+    a = ogs_pfcp_subnet_add("10.45.0.0", "16", "10.45.0.1", "a", "ogstun");
+    ABTS_PTR_NOTNULL(tc, a);
+    b = ogs_pfcp_subnet_add("10.46.0.0", "16", "10.46.0.1", "b", "ogstun");
+    ABTS_PTR_NOTNULL(tc, b);
+    ogs_pfcp_ue_pool_generate();
+    dev = ogs_pfcp_dev_find_by_ifname("ogstun");
+    ABTS_PTR_NOTNULL(tc, dev);
+
+    memset(addr, 0, sizeof(addr));
+    ip = ogs_pfcp_ue_ip_alloc(&cause_value, AF_INET, "a", addr);
+    ABTS_PTR_NOTNULL(tc, ip);
+
+    /* An unchanged subnet keeps its pool, only the new one is set up */
+    setup_calls = 0;
+    ABTS_INT_EQUAL(tc, OGS_OK, reload_subnet(TEST_SUBNET_A TEST_SUBNET_C));
+    ABTS_INT_EQUAL(tc, 1, setup_calls);
+    ABTS_INT_EQUAL(tc, 2, ogs_list_count(&ogs_pfcp_self()->subnet_list));
+    ABTS_PTR_EQUAL(tc, a, ogs_list_first(&ogs_pfcp_self()->subnet_list));
+    ABTS_PTR_EQUAL(tc, a, ip->subnet);
+    ABTS_INT_EQUAL(tc, 1, a->pool.capacity - a->pool.avail);
+    c = ogs_list_last(&ogs_pfcp_self()->subnet_list);
+    ABTS_STR_EQUAL(tc, "c", c->dnn);
+    ABTS_PTR_EQUAL(tc, dev, c->dev);
+    ABTS_TRUE(tc, c->pool.capacity > 0);
+
+    /* A subnet with addresses in use cannot go away */
+    setup_calls = 0;
+    ABTS_INT_EQUAL(tc, OGS_ERROR, reload_subnet(TEST_SUBNET_C));
+    ABTS_INT_EQUAL(tc, 0, setup_calls);
+    ABTS_INT_EQUAL(tc, 2, ogs_list_count(&ogs_pfcp_self()->subnet_list));
+    ABTS_PTR_EQUAL(tc, a, ogs_list_first(&ogs_pfcp_self()->subnet_list));
+    ABTS_PTR_EQUAL(tc, c, ogs_list_last(&ogs_pfcp_self()->subnet_list));
+
+    /* A refused subnet rolls back the reload, with the dev it added */
+    setup_calls = 0;
+    setup_refused = "d";
+    ABTS_INT_EQUAL(tc, OGS_ERROR,
+            reload_subnet(TEST_SUBNET_A TEST_SUBNET_C TEST_SUBNET_D));
+    setup_refused = NULL;
+    ABTS_INT_EQUAL(tc, 1, setup_calls);
+    ABTS_INT_EQUAL(tc, 2, ogs_list_count(&ogs_pfcp_self()->subnet_list));
+    ABTS_PTR_EQUAL(tc, a, ogs_list_first(&ogs_pfcp_self()->subnet_list));
+    ABTS_PTR_EQUAL(tc, c, ogs_list_last(&ogs_pfcp_self()->subnet_list));
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pfcp_dev_find_by_ifname("ogstun9"));
+    ABTS_PTR_EQUAL(tc, a, ip->subnet);
+
+    /* No session subnet left at all is refused as well */
+    ABTS_INT_EQUAL(tc, OGS_ERROR, reload_subnet(NULL));
+    ABTS_INT_EQUAL(tc, 2, ogs_list_count(&ogs_pfcp_self()->subnet_list));
+
+    /* Once its addresses are released it is dropped */
+    ogs_pfcp_ue_ip_free(ip);
+    ABTS_INT_EQUAL(tc, OGS_OK, reload_subnet(TEST_SUBNET_C));
+    ABTS_INT_EQUAL(tc, 1, ogs_list_count(&ogs_pfcp_self()->subnet_list));
+    ABTS_PTR_EQUAL(tc, c, ogs_list_first(&ogs_pfcp_self()->subnet_list));
+
+    ogs_pfcp_subnet_remove_all();
+    ogs_pfcp_dev_remove_all();
+}
+
+abts_suite *test_pfcp_context(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, pfcp_context_test1, NULL);
+    abts_run_test(suite, pfcp_context_test2, NULL);
+    abts_run_test(suite, pfcp_context_test3, NULL);
+    abts_run_test(suite, pfcp_context_test4, NULL);
+    abts_run_test(suite, pfcp_context_test5, NULL);
+    abts_run_test(suite, pfcp_context_test6, NULL);
+    abts_run_test(suite, pfcp_context_test7, NULL);
+    abts_run_test(suite, pfcp_context_test8, NULL);
+    abts_run_test(suite, pfcp_context_test9, NULL);
+
+    return suite;
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-app.h"
+#include "core/abts.h"
+
+static char path[] = "/tmp/reload-test-XXXXXX";
+
+static int report_calls;
+static int report_rv;
+
+static int reload_report(const char *local)
+{
+    report_calls++;
+
+    return report_rv;
+}
+
+static void write_config(int ue, int foo, const char *address,
+        const char *duration, int window)
+{
+    FILE *fp = NULL;
+
+    fp = fopen(path, "w");
+    ogs_assert(fp);
+    fprintf(fp,
+            "global:\n"
+            "  max:\n"
+            "    ue: %d\n"
+            "smf:\n"
+            "  foo: %d\n"
+            "upf:\n"
+            "  pfcp:\n"
+            "    server:\n"
+            "      - address: %s\n"
+            "  time:\n"
+            "    message:\n"
+            "      duration: %s\n"
+            "  report:\n"
+            "    window: %d\n",
+            ue, foo, address, duration, window);
+    fclose(fp);
+}
+
+static void reload(abts_case *tc,
+        int rv, int applied, int failed, int restart)
+{
+    int result[3];
+
+    ABTS_INT_EQUAL(tc, rv, ogs_app_reload());
+    ogs_app_reload_result(&result[0], &result[1], &result[2]);
+    ABTS_INT_EQUAL(tc, applied, result[0]);
+    ABTS_INT_EQUAL(tc, failed, result[1]);
+    ABTS_INT_EQUAL(tc, restart, result[2]);
+}
+
+/* Only a change of a registered key is applied, others need a restart */
+static void reload_test1(abts_case *tc, void *data)
+{
+    write_config(64, 1, "127.0.0.7", "2000", 4);
+    ogs_app()->document = ogs_yaml_document_load(path);
+    ogs_assert(ogs_app()->document);
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_app_reload_init());
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_app_reload_add("report", reload_report));
+
+    report_calls = 0;
+    report_rv = OGS_OK;
+
+    reload(tc, OGS_OK, 0, 0, 0);
+    ABTS_INT_EQUAL(tc, 0, report_calls);
+
+    /* The section of another NF sharing the file is not ours */
+    write_config(64, 2, "127.0.0.7", "2000", 4);
+    reload(tc, OGS_OK, 0, 0, 0);
+
+    write_config(64, 2, "127.0.0.7", "2000", 8);
+    reload(tc, OGS_OK, 1, 0, 0);
+    ABTS_INT_EQUAL(tc, 1, report_calls);
+
+    write_config(64, 2, "127.0.0.7", "3000", 8);
+    reload(tc, OGS_OK, 1, 0, 0);
+    ABTS_INT_EQUAL(tc, 1, report_calls);
+    ABTS_TRUE(tc, ogs_local_conf()->time.message.duration ==
+            ogs_time_from_msec(3000));
+
+    write_config(128, 2, "127.0.0.8", "3000", 8);
+    reload(tc, OGS_OK, 0, 0, 2);
+
+    /* Restart-only changes are compared with what was loaded at startup */
+    write_config(128, 2, "127.0.0.7", "3000", 8);
+    reload(tc, OGS_OK, 0, 0, 1);
+    write_config(64, 2, "127.0.0.7", "3000", 8);
+    reload(tc, OGS_OK, 0, 0, 0);
+    ABTS_INT_EQUAL(tc, 1, report_calls);
+
+    ogs_app_reload_final();
+    ogs_yaml_document_free(ogs_app()->document);
+    ogs_app()->document = NULL;
+}
+
+/* A failed handler keeps the running value and is tried again */
+static void reload_test2(abts_case *tc, void *data)
+{
+    FILE *fp = NULL;
+
+    write_config(64, 1, "127.0.0.7", "2000", 4);
+    ogs_app()->document = ogs_yaml_document_load(path);
+    ogs_assert(ogs_app()->document);
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_app_reload_init());
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_app_reload_add("report", reload_report));
+
+    report_calls = 0;
+    report_rv = OGS_ERROR;
+    write_config(64, 1, "127.0.0.7", "2000", 8);
+    reload(tc, OGS_ERROR, 0, 1, 0);
+    ABTS_INT_EQUAL(tc, 1, report_calls);
+    reload(tc, OGS_ERROR, 0, 1, 0);
+    ABTS_INT_EQUAL(tc, 2, report_calls);
+
+    report_rv = OGS_OK;
+    reload(tc, OGS_OK, 1, 0, 0);
+    ABTS_INT_EQUAL(tc, 3, report_calls);
+    reload(tc, OGS_OK, 0, 0, 0);
+    ABTS_INT_EQUAL(tc, 3, report_calls);
+
+    write_config(64, 1, "127.0.0.7", "1500", 8);
+    reload(tc, OGS_OK, 1, 0, 0);
+    ABTS_TRUE(tc, ogs_local_conf()->time.message.duration ==
+            ogs_time_from_msec(1500));
+
+    write_config(64, 1, "127.0.0.7", "0", 8);
+    reload(tc, OGS_ERROR, 0, 1, 0);
+    ABTS_TRUE(tc, ogs_local_conf()->time.message.duration ==
+            ogs_time_from_msec(1500));
+
+    /* A file that cannot be parsed changes nothing */
+    fp = fopen(path, "w");
+    ogs_assert(fp);
+    fputs("upf: [\n", fp);
+    fclose(fp);
+    ABTS_INT_EQUAL(tc, OGS_ERROR, ogs_app_reload());
+    ABTS_TRUE(tc, ogs_local_conf()->time.message.duration ==
+            ogs_time_from_msec(1500));
+
+    ogs_app_reload_final();
+    ogs_yaml_document_free(ogs_app()->document);
+    ogs_app()->document = NULL;
+}
+
+static void write_logger(const char *level)
+{
+    FILE *fp = NULL;
+
+    fp = fopen(path, "w");
+    ogs_assert(fp);
+    fprintf(fp,
+            "logger:\n"
+            "  level: %s\n"
+            "  domain: app\n"
+            "upf:\n"
+            "  report:\n"
+            "    window: 4\n",
+            level);
+    fclose(fp);
+}
+
+/* The logger keeps its own copy once the reloaded document is freed */
+static void reload_test3(abts_case *tc, void *data)
+{
+    const char *level = ogs_app()->logger.level;
+    const char *domain = ogs_app()->logger.domain;
+
+    write_logger("error");
+    ogs_app()->document = ogs_yaml_document_load(path);
+    ogs_assert(ogs_app()->document);
+    ABTS_INT_EQUAL(tc, OGS_OK, ogs_app_reload_init());
+
+    write_logger("warn");
+    reload(tc, OGS_OK, 1, 0, 0);
+    ABTS_STR_EQUAL(tc, "warn", ogs_app()->logger.level);
+    ABTS_STR_EQUAL(tc, "app", ogs_app()->logger.domain);
+
+    write_logger("fatal");
+    reload(tc, OGS_OK, 1, 0, 0);
+    ABTS_STR_EQUAL(tc, "fatal", ogs_app()->logger.level);
+
+    /* Rolled back to the values of the freed document */
+    write_logger("bogus");
+    reload(tc, OGS_ERROR, 0, 1, 0);
+    ABTS_STR_EQUAL(tc, "fatal", ogs_app()->logger.level);
+    ABTS_STR_EQUAL(tc, "app", ogs_app()->logger.domain);
+
+    ogs_app_reload_final();
+    ABTS_PTR_EQUAL(tc, level, ogs_app()->logger.level);
+    ABTS_PTR_EQUAL(tc, domain, ogs_app()->logger.domain);
+    ogs_yaml_document_free(ogs_app()->document);
+    ogs_app()->document = NULL;
+
+    ogs_log_config_domain("app", "error");
+}
+
+abts_suite *test_reload(abts_suite *suite)
+{
+    const char *file = ogs_app()->file;
+    const char *local = ogs_app()->local;
+    int fd;
+
+    suite = ADD_SUITE(suite)
+
+    fd = mkstemp(path);
+    ogs_assert(fd >= 0);
+    close(fd);
+
+    ogs_app()->file = path;
+    ogs_app()->local = "upf";
+
+    abts_run_test(suite, reload_test1, NULL);
+    abts_run_test(suite, reload_test2, NULL);
+    abts_run_test(suite, reload_test3, NULL);
+
+    ogs_app()->file = file;
+    ogs_app()->local = local;
+
+    unlink(path);
+
+    return suite;
+}
@@ -1330,6 +1330,59 @@ static void s1ap_message_test10(abts_case *tc, void *data)
     ogs_pkbuf_free(s1apbuf);
 }
 
+static void s1ap_message_test11(abts_case *tc, void *data)
+{
+    /* InitialUE(Attach Request) */
+    const char *payload =
+        "000c406f000006000800020001001a00"
+        "3c3b17df675aa8050741020bf600f110"
+        "000201030003e605f070000010000502"
+        "15d011d15200f11030395c0a003103e5"
+        "e0349011035758a65d0100e0c1004300"
+        "060000f1103039006440080000f1108c"
+        "3378200086400130004b00070000f110"
+        "000201";
+
+    ogs_s1ap_lazy_message_t message;
+    ogs_asn_ie_view_t *ie = NULL;
+    S1AP_NAS_PDU_t NAS_PDU;
+    S1AP_TAI_t TAI;
+    ogs_pkbuf_t *pkbuf;
+    int result;
+    char hexbuf[OGS_HUGE_LEN];
+
+    pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put_data(pkbuf,
+            ogs_hex_from_string(payload, hexbuf, sizeof(hexbuf)), 115);
+
+    result = ogs_s1ap_lazy_decode(&message, pkbuf);
+    ABTS_INT_EQUAL(tc, 0, result);
+    ABTS_INT_EQUAL(tc, S1AP_S1AP_PDU_PR_initiatingMessage, message.h.present);
+    ABTS_INT_EQUAL(tc, S1AP_ProcedureCode_id_initialUEMessage,
+            message.h.procedureCode);
+    ABTS_INT_EQUAL(tc, 6, message.h.num_of_ie);
+    ABTS_TRUE(tc, message.enb_ue_s1ap_id_presence);
+    ABTS_INT_EQUAL(tc, 1, message.enb_ue_s1ap_id);
+    ABTS_TRUE(tc, !message.mme_ue_s1ap_id_presence);
+
+    ie = ogs_s1ap_lazy_find_ie(&message, S1AP_ProtocolIE_ID_id_NAS_PDU);
+    ABTS_PTR_NOTNULL(tc, ie);
+    result = ogs_asn_lazy_get_OCTET_STRING(ie, &NAS_PDU);
+    ABTS_INT_EQUAL(tc, 0, result);
+    ABTS_INT_EQUAL(tc, 59, NAS_PDU.size);
+    ABTS_INT_EQUAL(tc, 0x17, NAS_PDU.buf[0]);
+
+    result = ogs_s1ap_lazy_decode_ie(&message, S1AP_ProtocolIE_ID_id_TAI,
+            &asn_DEF_S1AP_TAI, &TAI, sizeof(TAI));
+    ABTS_INT_EQUAL(tc, 0, result);
+    ABTS_INT_EQUAL(tc, 3, TAI.pLMNidentity.size);
+    ABTS_INT_EQUAL(tc, 2, TAI.tAC.size);
+    ogs_asn_free(&asn_DEF_S1AP_TAI, &TAI);
+
+    ogs_pkbuf_free(pkbuf);
+}
+
 abts_suite *test_s1ap_message(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -1346,6 +1399,7 @@ abts_suite *test_s1ap_message(abts_suite *suite)
     abts_run_test(suite, s1ap_message_test8, NULL);
     abts_run_test(suite, s1ap_message_test9, NULL);
     abts_run_test(suite, s1ap_message_test10, NULL);
+    abts_run_test(suite, s1ap_message_test11, NULL);
 
     return suite;
 }
@@ -0,0 +1,440 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "upf/context.h"
+#include "upf/checkpoint.h"
+#include "upf/n4-handler.h"
+#include "core/abts.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#define NUM_OF_SESS 8
+
+/* The start of the file and of a record, as laid out in checkpoint.c */
+typedef struct header_s {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    active;
+    uint64_t    size;
+    uint64_t    used[2];
+    uint64_t    generation;
+} header_t;
+
+#define HEADER_SIZE 4096
+#define RECORD_HEADER_SIZE 24
+#define RECORD_SIZE(__len) (((size_t)(__len) + 7) & ~(size_t)7)
+
+static char path[] = "/tmp/upf-checkpoint-XXXXXX";
+static ogs_sock_t gtpu_sock;
+
+static struct {
+    uint64_t upf_n4_seid;
+    uint64_t smf_n4_seid;
+    uint32_t ue_ip;
+    uint32_t teid;
+} saved[NUM_OF_SESS];
+
+static void context_start(size_t size)
+{
+    ogs_gtp_context_init(OGS_MAX_NUM_OF_GTPU_RESOURCE);
+    ogs_pfcp_context_init();
+    upf_context_init();
+
+    ogs_gtp_self()->gtpu_port = OGS_GTPV1_U_UDP_PORT;
+    ogs_gtp_self()->gtpu_sock = &gtpu_sock;
+    ogs_assert(OGS_OK == ogs_getaddrinfo(&ogs_gtp_self()->gtpu_addr,
+                AF_INET, "127.0.0.7", OGS_GTPV1_U_UDP_PORT, 0));
+    ogs_assert(ogs_pfcp_subnet_add(
+                "10.45.0.0", "16", "10.45.0.1", "internet", "ogstun"));
+    ogs_assert(OGS_OK == ogs_pfcp_ue_pool_generate());
+
+    upf_self()->checkpoint.path = ogs_strdup(path);
+    ogs_assert(upf_self()->checkpoint.path);
+    upf_self()->checkpoint.size = size;
+    upf_self()->checkpoint.reconcile = ogs_time_from_sec(60);
+}
+
+/* Sessions removed after the checkpoint is closed are kept in it */
+static void context_stop(void)
+{
+    upf_checkpoint_close();
+
+    upf_context_final();
+    ogs_pfcp_context_final();
+
+    ogs_freeaddrinfo(ogs_gtp_self()->gtpu_addr);
+    ogs_gtp_self()->gtpu_addr = NULL;
+    ogs_gtp_context_final();
+}
+
+static upf_sess_t *establish(int i)
+{
+    ogs_pfcp_session_establishment_request_t req;
+    ogs_pfcp_f_seid_t f_seid;
+    ogs_pfcp_f_teid_t f_teid;
+    ogs_pfcp_ue_ip_addr_t ue_ip;
+    ogs_pfcp_outer_header_creation_t ohc;
+    uint8_t dnn[] = "\x08internet";
+    uint8_t ohr = 0;
+    upf_sess_t *sess = NULL;
+    ogs_pfcp_pdr_t *pdr = NULL;
+
+    memset(&req, 0, sizeof(req));
+
+    memset(&f_seid, 0, sizeof(f_seid));
+    f_seid.ipv4 = 1;
+    f_seid.seid = 0x1000 + i;
+    f_seid.addr = htobe32(0x7f000004);
+
+    memset(&f_teid, 0, sizeof(f_teid));
+    f_teid.ipv4 = 1;
+    f_teid.ch = 1;
+
+    req.create_pdr[0].presence = 1;
+    req.create_pdr[0].pdr_id.presence = 1;
+    req.create_pdr[0].pdr_id.u16 = 1;
+    req.create_pdr[0].precedence.presence = 1;
+    req.create_pdr[0].precedence.u32 = 100;
+    req.create_pdr[0].pdi.presence = 1;
+    req.create_pdr[0].pdi.network_instance.presence = 1;
+    req.create_pdr[0].pdi.network_instance.data = dnn;
+    req.create_pdr[0].pdi.network_instance.len = sizeof(dnn) - 1;
+    req.create_pdr[0].pdi.source_interface.presence = 1;
+    req.create_pdr[0].pdi.source_interface.u8 = OGS_PFCP_INTERFACE_ACCESS;
+    req.create_pdr[0].pdi.local_f_teid.presence = 1;
+    req.create_pdr[0].pdi.local_f_teid.data = &f_teid;
+    req.create_pdr[0].pdi.local_f_teid.len = 1;
+    req.create_pdr[0].outer_header_removal.presence = 1;
+    req.create_pdr[0].outer_header_removal.data = &ohr;
+    req.create_pdr[0].outer_header_removal.len = 1;
+    req.create_pdr[0].far_id.presence = 1;
+    req.create_pdr[0].far_id.u32 = 1;
+
+    memset(&ue_ip, 0, sizeof(ue_ip));
+    ue_ip.ipv4 = 1;
+    ue_ip.sd = OGS_PFCP_UE_IP_DST;
+    ue_ip.addr = htobe32(0x0a2d0000 + 10 + i);
+
+    req.create_pdr[1].presence = 1;
+    req.create_pdr[1].pdr_id.presence = 1;
+    req.create_pdr[1].pdr_id.u16 = 2;
+    req.create_pdr[1].precedence.presence = 1;
+    req.create_pdr[1].precedence.u32 = 100;
+    req.create_pdr[1].pdi.presence = 1;
+    req.create_pdr[1].pdi.network_instance.presence = 1;
+    req.create_pdr[1].pdi.network_instance.data = dnn;
+    req.create_pdr[1].pdi.network_instance.len = sizeof(dnn) - 1;
+    req.create_pdr[1].pdi.source_interface.presence = 1;
+    req.create_pdr[1].pdi.source_interface.u8 = OGS_PFCP_INTERFACE_CORE;
+    req.create_pdr[1].pdi.ue_ip_address.presence = 1;
+    req.create_pdr[1].pdi.ue_ip_address.data = &ue_ip;
+    req.create_pdr[1].pdi.ue_ip_address.len = OGS_IPV4_LEN + 1;
+    req.create_pdr[1].far_id.presence = 1;
+    req.create_pdr[1].far_id.u32 = 2;
+
+    req.create_far[0].presence = 1;
+    req.create_far[0].far_id.presence = 1;
+    req.create_far[0].far_id.u32 = 1;
+    req.create_far[0].apply_action.presence = 1;
+    req.create_far[0].apply_action.u16 = OGS_PFCP_APPLY_ACTION_FORW;
+    req.create_far[0].forwarding_parameters.presence = 1;
+    req.create_far[0].forwarding_parameters.
+        destination_interface.presence = 1;
+    req.create_far[0].forwarding_parameters.
+        destination_interface.u8 = OGS_PFCP_INTERFACE_CORE;
+
+    memset(&ohc, 0, sizeof(ohc));
+    ohc.gtpu4 = 1;
+    ohc.teid = htobe32(0x200 + i);
+    ohc.addr = htobe32(0x7f000002);
+
+    req.create_far[1].presence = 1;
+    req.create_far[1].far_id.presence = 1;
+    req.create_far[1].far_id.u32 = 2;
+    req.create_far[1].apply_action.presence = 1;
+    req.create_far[1].apply_action.u16 = OGS_PFCP_APPLY_ACTION_FORW;
+    req.create_far[1].forwarding_parameters.presence = 1;
+    req.create_far[1].forwarding_parameters.
+        destination_interface.presence = 1;
+    req.create_far[1].forwarding_parameters.
+        destination_interface.u8 = OGS_PFCP_INTERFACE_ACCESS;
+    req.create_far[1].forwarding_parameters.
+        outer_header_creation.presence = 1;
+    req.create_far[1].forwarding_parameters.
+        outer_header_creation.data = &ohc;
+    req.create_far[1].forwarding_parameters.
+        outer_header_creation.len = 10;
+
+    req.pdn_type.presence = 1;
+    req.pdn_type.u8 = OGS_PDU_SESSION_TYPE_IPV4;
+    req.apn_dnn.presence = 1;
+    req.apn_dnn.data = dnn;
+    req.apn_dnn.len = sizeof(dnn) - 1;
+
+    sess = upf_sess_add(&f_seid);
+    ogs_assert(sess);
+    ogs_assert(true == upf_n4_restore_session(sess, &req));
+    upf_checkpoint_update(sess);
+
+    saved[i].upf_n4_seid = sess->upf_n4_seid;
+    saved[i].smf_n4_seid = sess->smf_n4_f_seid.seid;
+    saved[i].ue_ip = sess->ipv4->addr[0];
+    ogs_list_for_each(&sess->pfcp.pdr_list, pdr) {
+        if (pdr->f_teid_len)
+            saved[i].teid = pdr->f_teid.teid;
+    }
+    ogs_assert(saved[i].teid);
+
+    return sess;
+}
+
+static bool restored(abts_case *tc, int i)
+{
+    upf_sess_t *sess = NULL;
+    ogs_pfcp_pdr_t *pdr = NULL;
+    ogs_pfcp_far_t *far = NULL;
+    int num_of_pdr = 0, num_of_ohc = 0;
+
+    sess = upf_sess_find_by_upf_n4_seid(saved[i].upf_n4_seid);
+    if (!sess)
+        return false;
+
+    ABTS_TRUE(tc, sess->restored);
+    ABTS_PTR_EQUAL(tc, NULL, sess->pfcp_node);
+    ABTS_TRUE(tc, sess->smf_n4_f_seid.seid == saved[i].smf_n4_seid);
+    ABTS_PTR_NOTNULL(tc, sess->ipv4);
+    ABTS_INT_EQUAL(tc, saved[i].ue_ip, sess->ipv4->addr[0]);
+    ABTS_PTR_EQUAL(tc, sess, upf_sess_find_by_ipv4(saved[i].ue_ip));
+
+    ogs_list_for_each(&sess->pfcp.pdr_list, pdr) {
+        num_of_pdr++;
+        if (pdr->f_teid_len) {
+            ABTS_INT_EQUAL(tc, saved[i].teid, pdr->f_teid.teid);
+            ABTS_PTR_NOTNULL(tc, ogs_pfcp_object_find_by_teid(saved[i].teid));
+        }
+    }
+    ABTS_INT_EQUAL(tc, 2, num_of_pdr);
+
+    ogs_list_for_each(&sess->pfcp.far_list, far) {
+        if (far->outer_header_creation_len) {
+            num_of_ohc++;
+            ABTS_INT_EQUAL(tc, 0x200 + i, far->outer_header_creation.teid);
+            ABTS_PTR_NOTNULL(tc, far->gnode);
+        }
+    }
+    ABTS_INT_EQUAL(tc, 1, num_of_ohc);
+
+    return true;
+}
+
+static void read_header(header_t *header)
+{
+    int fd = open(path, O_RDONLY);
+
+    ogs_assert(fd >= 0);
+    ogs_assert(pread(fd, header, sizeof(*header), 0) == sizeof(*header));
+    close(fd);
+}
+
+/* The sessions come back with their SEIDs, TEIDs and UE addresses */
+static void checkpoint_test1(abts_case *tc, void *data)
+{
+    upf_sess_t *sess = NULL;
+    int i;
+
+    context_start(64 * 1024);
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_checkpoint_open());
+    for (i = 0; i < NUM_OF_SESS; i++)
+        establish(i);
+
+    /* A removed session is not restored */
+    sess = upf_sess_find_by_upf_n4_seid(saved[0].upf_n4_seid);
+    ABTS_PTR_NOTNULL(tc, sess);
+    upf_n4_remove_session(sess);
+    context_stop();
+
+    context_start(64 * 1024);
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_checkpoint_open());
+    ABTS_INT_EQUAL(tc, NUM_OF_SESS - 1,
+            ogs_list_count(&upf_self()->sess_list));
+    ABTS_TRUE(tc, !restored(tc, 0));
+    for (i = 1; i < NUM_OF_SESS; i++)
+        ABTS_TRUE(tc, restored(tc, i));
+    context_stop();
+
+    unlink(path);
+}
+
+/* A full area is compacted into the other one */
+static void checkpoint_test2(abts_case *tc, void *data)
+{
+    upf_sess_t *sess = NULL;
+    header_t header;
+    int i;
+
+    context_start(16 * 1024);
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_checkpoint_open());
+    for (i = 0; i < NUM_OF_SESS; i++)
+        establish(i);
+
+    for (i = 0; i < 100; i++) {
+        ogs_list_for_each(&upf_self()->sess_list, sess)
+            upf_checkpoint_update(sess);
+    }
+
+    read_header(&header);
+    ABTS_TRUE(tc, memcmp(header.magic, "OGSUPFCP", 8) == 0);
+    ABTS_TRUE(tc, header.generation > 0);
+    ABTS_TRUE(tc, header.used[header.active] <= header.size);
+    context_stop();
+
+    context_start(16 * 1024);
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_checkpoint_open());
+    ABTS_INT_EQUAL(tc, NUM_OF_SESS, ogs_list_count(&upf_self()->sess_list));
+    for (i = 0; i < NUM_OF_SESS; i++)
+        ABTS_TRUE(tc, restored(tc, i));
+    context_stop();
+
+    unlink(path);
+}
+
+/* A torn record ends the checkpoint; the ones before it are restored */
+static void checkpoint_test3(abts_case *tc, void *data)
+{
+    header_t header;
+    uint32_t len;
+    uint8_t byte;
+    off_t area, offset, last = 0;
+    int fd;
+
+    context_start(64 * 1024);
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_checkpoint_open());
+    establish(0);
+    establish(1);
+    context_stop();
+
+    read_header(&header);
+    area = HEADER_SIZE + header.active * header.size;
+
+    fd = open(path, O_RDWR);
+    ogs_assert(fd >= 0);
+    for (offset = 0; offset < header.used[header.active];
+            offset += RECORD_SIZE(len)) {
+        ogs_assert(pread(fd, &len, sizeof(len), area + offset) ==
+                sizeof(len));
+        last = offset;
+    }
+    ogs_assert(pread(fd, &byte, 1, area + last + RECORD_HEADER_SIZE) == 1);
+    byte ^= 0xff;
+    ogs_assert(pwrite(fd, &byte, 1, area + last + RECORD_HEADER_SIZE) == 1);
+    close(fd);
+
+    context_start(64 * 1024);
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_checkpoint_open());
+    ABTS_INT_EQUAL(tc, 1, ogs_list_count(&upf_self()->sess_list));
+    ABTS_TRUE(tc, restored(tc, 0));
+    ABTS_TRUE(tc, !restored(tc, 1));
+
+    read_header(&header);
+    ABTS_INT_EQUAL(tc, last, header.used[header.active]);
+    context_stop();
+
+    unlink(path);
+}
+
+/* Sessions no SMF has claimed are removed when reconcile expires */
+static void checkpoint_test4(abts_case *tc, void *data)
+{
+    ogs_pfcp_node_t node;
+    upf_sess_t *sess = NULL;
+    int i;
+
+    context_start(64 * 1024);
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_checkpoint_open());
+    for (i = 0; i < NUM_OF_SESS; i++)
+        establish(i);
+    context_stop();
+
+    context_start(64 * 1024);
+    upf_self()->checkpoint.reconcile = 1;
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_checkpoint_open());
+    ABTS_INT_EQUAL(tc, NUM_OF_SESS, ogs_list_count(&upf_self()->sess_list));
+
+    memset(&node, 0, sizeof(node));
+    for (i = 0; i < NUM_OF_SESS; i += 2) {
+        sess = upf_sess_find_by_upf_n4_seid(saved[i].upf_n4_seid);
+        ABTS_PTR_NOTNULL(tc, sess);
+        sess->pfcp_node = &node;
+    }
+
+    ogs_usleep(1000);
+    ogs_timer_mgr_expire(ogs_app()->timer_mgr);
+
+    ABTS_INT_EQUAL(tc, NUM_OF_SESS / 2,
+            ogs_list_count(&upf_self()->sess_list));
+    for (i = 0; i < NUM_OF_SESS; i++) {
+        sess = upf_sess_find_by_upf_n4_seid(saved[i].upf_n4_seid);
+        if (i % 2 == 0) {
+            ABTS_PTR_NOTNULL(tc, sess);
+            sess->pfcp_node = NULL;
+        } else {
+            ABTS_PTR_EQUAL(tc, NULL, sess);
+        }
+    }
+    context_stop();
+
+    /* The removal was saved as well */
+    context_start(64 * 1024);
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_checkpoint_open());
+    ABTS_INT_EQUAL(tc, NUM_OF_SESS / 2,
+            ogs_list_count(&upf_self()->sess_list));
+    context_stop();
+
+    unlink(path);
+}
+
+abts_suite *test_checkpoint(abts_suite *suite)
+{
+    int fd;
+
+    suite = ADD_SUITE(suite)
+
+    /* The contexts of main() are restarted by every test */
+    upf_context_final();
+    ogs_pfcp_context_final();
+    ogs_gtp_context_final();
+
+    fd = mkstemp(path);
+    ogs_assert(fd >= 0);
+    close(fd);
+
+    abts_run_test(suite, checkpoint_test1, NULL);
+    abts_run_test(suite, checkpoint_test2, NULL);
+    abts_run_test(suite, checkpoint_test3, NULL);
+    abts_run_test(suite, checkpoint_test4, NULL);
+
+    unlink(path);
+
+    ogs_gtp_context_init(OGS_MAX_NUM_OF_GTPU_RESOURCE);
+    ogs_pfcp_context_init();
+    upf_context_init();
+
+    return suite;
+}
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "upf/context.h"
+#include "core/abts.h"
+
+static upf_sess_t sess;
+
+static void wheel_tick(int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        upf_self()->urr_wheel.t_tick->cb(upf_self()->urr_wheel.t_tick->data);
+}
+
+static upf_sess_urr_acc_t *urr_acc_of(upf_sess_t *s, ogs_pfcp_urr_id_t id)
+{
+    upf_sess_urr_acc_t *urr_acc = NULL;
+
+    ogs_list_for_each_entry(&s->urr_acc_list, urr_acc, sess_node) {
+        if (urr_acc->id == id)
+            return urr_acc;
+    }
+
+    return NULL;
+}
+
+static ogs_pfcp_urr_t *time_threshold_urr(upf_sess_t *s, uint32_t sec)
+{
+    ogs_pfcp_urr_t *urr = ogs_pfcp_urr_add(&s->pfcp);
+    ogs_assert(urr);
+
+    urr->rep_triggers.time_threshold = 1;
+    urr->time_threshold = sec;
+    upf_sess_urr_acc_timers_setup(s, urr);
+
+    return urr;
+}
+
+static void sess_setup(upf_sess_t *s)
+{
+    memset(s, 0, sizeof(*s));
+    ogs_pfcp_pool_init(&s->pfcp);
+    ogs_list_init(&s->urr_acc_list);
+}
+
+static void sess_teardown(upf_sess_t *s)
+{
+    ogs_pfcp_urr_t *urr = NULL, *next_urr = NULL;
+
+    ogs_list_for_each_safe(&s->pfcp.urr_list, next_urr, urr) {
+        upf_sess_urr_acc_remove(s, urr->id);
+        ogs_pfcp_urr_remove(urr);
+    }
+    ogs_pfcp_sess_clear(&s->pfcp);
+    ogs_pfcp_pool_final(&s->pfcp);
+}
+
+/* URRs expire on the wheel and their reports are coalesced */
+static void report_test1(abts_case *tc, void *data)
+{
+    ogs_pfcp_urr_t *urr1 = NULL, *urr2 = NULL, *urr3 = NULL;
+    upf_sess_urr_acc_t *acc1 = NULL, *acc2 = NULL, *acc3 = NULL;
+
+    upf_self()->report.jitter = 0;
+    upf_self()->report.window = 0;
+
+    sess_setup(&sess);
+
+    urr1 = time_threshold_urr(&sess, 2);
+    urr2 = time_threshold_urr(&sess, 3);
+    urr3 = time_threshold_urr(&sess, UPF_URR_WHEEL_SIZE + 5);
+    acc1 = urr_acc_of(&sess, urr1->id);
+    acc2 = urr_acc_of(&sess, urr2->id);
+    acc3 = urr_acc_of(&sess, urr3->id);
+    ABTS_PTR_NOTNULL(tc, acc1);
+    ABTS_PTR_NOTNULL(tc, acc2);
+    ABTS_PTR_NOTNULL(tc, acc3);
+    ABTS_INT_EQUAL(tc, 3, upf_self()->urr_wheel.count);
+    ABTS_TRUE(tc, upf_self()->urr_wheel.t_tick->running);
+    ABTS_INT_EQUAL(tc, 1, acc3->rounds);
+
+    /* The first tick comes within a second, so expiry is never early */
+    wheel_tick(2);
+    ABTS_TRUE(tc, !acc1->report_pending);
+    ABTS_TRUE(tc, !sess.report.pending);
+
+    wheel_tick(1);
+    ABTS_TRUE(tc, acc1->report_pending);
+    ABTS_TRUE(tc, !acc2->report_pending);
+    ABTS_TRUE(tc, sess.report.pending);
+    ABTS_INT_EQUAL(tc, 1, ogs_list_count(&upf_self()->report.pending_list));
+    ABTS_TRUE(tc, upf_self()->report.t_flush->running);
+
+    /* A second report of the same session does not queue it again */
+    wheel_tick(1);
+    ABTS_TRUE(tc, acc2->report_pending);
+    ABTS_INT_EQUAL(tc, 1, ogs_list_count(&upf_self()->report.pending_list));
+    ABTS_INT_EQUAL(tc, 1, upf_self()->urr_wheel.count);
+
+    /* A period longer than the wheel takes more than one revolution */
+    wheel_tick(UPF_URR_WHEEL_SIZE);
+    ABTS_TRUE(tc, !acc3->report_pending);
+    wheel_tick(1);
+    ABTS_TRUE(tc, !acc3->report_pending);
+    wheel_tick(1);
+    ABTS_TRUE(tc, acc3->report_pending);
+    ABTS_INT_EQUAL(tc, 0, upf_self()->urr_wheel.count);
+    ABTS_TRUE(tc, !upf_self()->urr_wheel.t_tick->running);
+
+    /*
+     * A measurement reported outside of the Session Report Request
+     * is no longer pending; the session leaves the list with the last one.
+     */
+    upf_sess_urr_acc_snapshot(&sess, urr1);
+    ABTS_TRUE(tc, !acc1->report_pending);
+    ABTS_TRUE(tc, sess.report.pending);
+    upf_sess_urr_acc_snapshot(&sess, urr2);
+    ABTS_TRUE(tc, sess.report.pending);
+
+    /* So does removing the last pending URR */
+    upf_sess_urr_acc_remove(&sess, urr3->id);
+    ogs_pfcp_urr_remove(urr3);
+    ABTS_TRUE(tc, !sess.report.pending);
+    ABTS_INT_EQUAL(tc, 0, ogs_list_count(&upf_self()->report.pending_list));
+
+    sess_teardown(&sess);
+    ogs_timer_stop(upf_self()->report.t_flush);
+}
+
+/* A peer at its window keeps the session queued */
+static void report_test2(abts_case *tc, void *data)
+{
+    ogs_pfcp_node_t node;
+    ogs_pfcp_urr_t *urr = NULL;
+    upf_sess_urr_acc_t *acc = NULL;
+
+    upf_self()->report.jitter = 0;
+    upf_self()->report.window = 2;
+
+    sess_setup(&sess);
+    memset(&node, 0, sizeof(node));
+    node.xact_stats.local = 2;
+    sess.pfcp_node = &node;
+
+    urr = time_threshold_urr(&sess, 1);
+    acc = urr_acc_of(&sess, urr->id);
+    ABTS_PTR_NOTNULL(tc, acc);
+
+    wheel_tick(2);
+    ABTS_TRUE(tc, acc->report_pending);
+    ABTS_TRUE(tc, sess.report.pending);
+
+    upf_self()->report.t_flush->cb(upf_self()->report.t_flush->data);
+    ABTS_TRUE(tc, acc->report_pending);
+    ABTS_TRUE(tc, sess.report.pending);
+    ABTS_TRUE(tc, upf_self()->report.t_flush->running);
+
+    /* A Session Deletion reports the usage and drops the pending one */
+    upf_sess_urr_acc_snapshot(&sess, urr);
+    ABTS_TRUE(tc, !sess.report.pending);
+
+    sess_teardown(&sess);
+    ogs_timer_stop(upf_self()->report.t_flush);
+
+    upf_self()->report.window = UPF_DEFAULT_REPORT_WINDOW;
+}
+
+/* Jitter stretches a period by at most a sixteenth */
+static void report_test3(abts_case *tc, void *data)
+{
+    ogs_pfcp_urr_t *urr = NULL;
+    upf_sess_urr_acc_t *acc = NULL;
+    int i;
+
+    upf_self()->report.jitter = ogs_time_from_sec(60);
+
+    sess_setup(&sess);
+    urr = time_threshold_urr(&sess, 32);
+    acc = urr_acc_of(&sess, urr->id);
+    ABTS_PTR_NOTNULL(tc, acc);
+
+    for (i = 0; i < 32 && !acc->report_pending; i++)
+        wheel_tick(1);
+    ABTS_TRUE(tc, !acc->report_pending);
+    for (i = 0; i < 3 && !acc->report_pending; i++)
+        wheel_tick(1);
+    ABTS_TRUE(tc, acc->report_pending);
+
+    upf_sess_urr_acc_snapshot(&sess, urr);
+    sess_teardown(&sess);
+    ogs_timer_stop(upf_self()->report.t_flush);
+
+    upf_self()->report.jitter = 0;
+}
+
+/* A restored session keeps its usage until an SMF claims it */
+static void report_test4(abts_case *tc, void *data)
+{
+    ogs_pfcp_urr_t *urr = NULL;
+    upf_sess_urr_acc_t *acc = NULL;
+
+    upf_self()->report.jitter = 0;
+
+    sess_setup(&sess);
+    sess.restored = true;
+
+    urr = time_threshold_urr(&sess, 1);
+    acc = urr_acc_of(&sess, urr->id);
+    ABTS_PTR_NOTNULL(tc, acc);
+
+    wheel_tick(2);
+    ABTS_TRUE(tc, acc->report_pending);
+
+    upf_self()->report.t_flush->cb(upf_self()->report.t_flush->data);
+    ABTS_TRUE(tc, acc->report_pending);
+    ABTS_TRUE(tc, sess.report.pending);
+    ABTS_INT_EQUAL(tc, 1, ogs_list_count(&upf_self()->report.pending_list));
+    ABTS_TRUE(tc, upf_self()->report.t_flush->running);
+
+    upf_sess_urr_acc_snapshot(&sess, urr);
+    ABTS_TRUE(tc, !sess.report.pending);
+
+    sess_teardown(&sess);
+    ogs_timer_stop(upf_self()->report.t_flush);
+}
+
+abts_suite *test_report(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, report_test1, NULL);
+    abts_run_test(suite, report_test2, NULL);
+    abts_run_test(suite, report_test3, NULL);
+    abts_run_test(suite, report_test4, NULL);
+
+    return suite;
+}